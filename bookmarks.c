@@ -1,5 +1,6 @@
 /* See LICENSE file for license and copyright information */
 
+#include <stdlib.h>
 #include <string.h>
 #include "bookmarks.h"
 #include "database.h"
@@ -8,13 +9,48 @@
 #include <girara/datastructures.h>
 #include <girara/utils.h>
 
-static int
-bookmark_compare_find(const void* item, const void* data)
+/* the lookup structures are built from the list when they are needed */
+static GHashTable*
+bookmarks_get_ids(zathura_t* zathura)
+{
+  if (zathura->bookmarks.ids == NULL) {
+    zathura->bookmarks.ids = g_hash_table_new(g_str_hash, g_str_equal);
+    GIRARA_LIST_FOREACH(zathura->bookmarks.bookmarks, zathura_bookmark_t*, iter, bookmark)
+    g_hash_table_insert(zathura->bookmarks.ids, bookmark->id, bookmark);
+    GIRARA_LIST_FOREACH_END(zathura->bookmarks.bookmarks, zathura_bookmark_t*, iter, bookmark);
+  }
+
+  return zathura->bookmarks.ids;
+}
+
+static GPtrArray*
+bookmarks_get_pages(zathura_t* zathura)
 {
-  const zathura_bookmark_t* bookmark = item;
-  const char* id = data;
+  if (zathura->bookmarks.pages == NULL) {
+    GPtrArray* pages = g_ptr_array_sized_new(girara_list_size(zathura->bookmarks.bookmarks));
+    GIRARA_LIST_FOREACH(zathura->bookmarks.bookmarks, zathura_bookmark_t*, iter, bookmark)
+    g_ptr_array_add(pages, bookmark);
+    GIRARA_LIST_FOREACH_END(zathura->bookmarks.bookmarks, zathura_bookmark_t*, iter, bookmark);
+
+    zathura_bookmarks_sort_by_page((zathura_bookmark_t**) pages->pdata, pages->len);
+    zathura->bookmarks.pages = pages;
+  }
 
-  return g_strcmp0(bookmark->id, id);
+  return zathura->bookmarks.pages;
+}
+
+static void
+bookmarks_invalidate(zathura_t* zathura, bool ids)
+{
+  if (ids == true && zathura->bookmarks.ids != NULL) {
+    g_hash_table_destroy(zathura->bookmarks.ids);
+    zathura->bookmarks.ids = NULL;
+  }
+
+  if (zathura->bookmarks.pages != NULL) {
+    g_ptr_array_free(zathura->bookmarks.pages, TRUE);
+    zathura->bookmarks.pages = NULL;
+  }
 }
 
 zathura_bookmark_t*
@@ -23,8 +59,8 @@ zathura_bookmark_add(zathura_t* zathura, const gchar* id, unsigned int page)
   g_return_val_if_fail(zathura && zathura->document && zathura->bookmarks.bookmarks, NULL);
   g_return_val_if_fail(id, NULL);
 
-  zathura_bookmark_t* old = girara_list_find(zathura->bookmarks.bookmarks, bookmark_compare_find, id);
-  if (old != NULL) {
+  GHashTable* ids = bookmarks_get_ids(zathura);
+  if (g_hash_table_lookup(ids, id) != NULL) {
     return NULL;
   }
 
@@ -32,6 +68,8 @@ zathura_bookmark_add(zathura_t* zathura, const gchar* id, unsigned int page)
   bookmark->id = g_strdup(id);
   bookmark->page = page;
   girara_list_append(zathura->bookmarks.bookmarks, bookmark);
+  g_hash_table_insert(ids, bookmark->id, bookmark);
+  bookmarks_invalidate(zathura, false);
 
   if (zathura->database != NULL) {
     const char* path = zathura_document_get_path(zathura->document);
@@ -61,6 +99,8 @@ zathura_bookmark_remove(zathura_t* zathura, const gchar* id)
     }
   }
 
+  g_hash_table_remove(bookmarks_get_ids(zathura), bookmark->id);
+  bookmarks_invalidate(zathura, false);
   girara_list_remove(zathura->bookmarks.bookmarks, bookmark);
 
   return true;
@@ -72,7 +112,26 @@ zathura_bookmark_get(zathura_t* zathura, const gchar* id)
   g_return_val_if_fail(zathura && zathura->bookmarks.bookmarks, NULL);
   g_return_val_if_fail(id, NULL);
 
-  return girara_list_find(zathura->bookmarks.bookmarks, bookmark_compare_find, id);
+  return g_hash_table_lookup(bookmarks_get_ids(zathura), id);
+}
+
+void
+zathura_bookmark_set_page(zathura_t* zathura, zathura_bookmark_t* bookmark, unsigned int page)
+{
+  g_return_if_fail(zathura && bookmark);
+
+  bookmark->page = page;
+  bookmarks_invalidate(zathura, false);
+}
+
+zathura_bookmark_t*
+zathura_bookmark_find(zathura_t* zathura, unsigned int page, bool forward)
+{
+  g_return_val_if_fail(zathura && zathura->bookmarks.bookmarks, NULL);
+
+  GPtrArray* pages = bookmarks_get_pages(zathura);
+  return zathura_bookmarks_find_page((zathura_bookmark_t**) pages->pdata,
+      pages->len, page, forward);
 }
 
 void
@@ -101,12 +160,78 @@ zathura_bookmarks_load(zathura_t* zathura, const gchar* file)
     return false;
   }
 
+  bookmarks_invalidate(zathura, true);
   girara_list_free(zathura->bookmarks.bookmarks);
   zathura->bookmarks.bookmarks = bookmarks;
 
   return true;
 }
 
+void
+zathura_bookmarks_free(zathura_t* zathura)
+{
+  g_return_if_fail(zathura);
+
+  bookmarks_invalidate(zathura, true);
+  if (zathura->bookmarks.bookmarks != NULL) {
+    girara_list_free(zathura->bookmarks.bookmarks);
+    zathura->bookmarks.bookmarks = NULL;
+  }
+}
+
+static int
+bookmarks_compare_pages(const void* a, const void* b)
+{
+  const zathura_bookmark_t* lhs = *(zathura_bookmark_t* const*) a;
+  const zathura_bookmark_t* rhs = *(zathura_bookmark_t* const*) b;
+
+  if (lhs->page != rhs->page) {
+    return lhs->page < rhs->page ? -1 : 1;
+  }
+
+  return g_strcmp0(lhs->id, rhs->id);
+}
+
+void
+zathura_bookmarks_sort_by_page(zathura_bookmark_t** bookmarks, unsigned int n)
+{
+  if (bookmarks == NULL || n < 2) {
+    return;
+  }
+
+  qsort(bookmarks, n, sizeof(zathura_bookmark_t*), bookmarks_compare_pages);
+}
+
+zathura_bookmark_t*
+zathura_bookmarks_find_page(zathura_bookmark_t** bookmarks, unsigned int n,
+    unsigned int page, bool forward)
+{
+  if (bookmarks == NULL || n == 0) {
+    return NULL;
+  }
+
+  /* the first bookmark after the page, or the first on the page when looking
+   * backward */
+  unsigned int lower = 0;
+  unsigned int upper = n;
+  while (lower < upper) {
+    const unsigned int middle = lower + (upper - lower) / 2;
+    const bool before = forward == true ? bookmarks[middle]->page <= page :
+      bookmarks[middle]->page < page;
+    if (before == true) {
+      lower = middle + 1;
+    } else {
+      upper = middle;
+    }
+  }
+
+  if (forward == true) {
+    return lower < n ? bookmarks[lower] : NULL;
+  }
+
+  return lower > 0 ? bookmarks[lower - 1] : NULL;
+}
+
 int
 zathura_bookmarks_compare(zathura_bookmark_t* lhs, zathura_bookmark_t* rhs)
 {
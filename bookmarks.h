@@ -39,6 +39,24 @@ bool zathura_bookmark_remove(zathura_t* zathura, const gchar* id);
  */
 zathura_bookmark_t* zathura_bookmark_get(zathura_t* zathura, const gchar* id);
 
+/**
+ * Move a bookmark to another page.
+ * @param zathura The zathura instance.
+ * @param bookmark The bookmark instance.
+ * @param page The bookmark's new page.
+ */
+void zathura_bookmark_set_page(zathura_t* zathura, zathura_bookmark_t* bookmark, unsigned int page);
+
+/**
+ * Get the closest bookmark after or before a page. The bookmarks are
+ * sorted by page once and then found by binary search.
+ * @param zathura The zathura instance.
+ * @param page The page (starting at 1, like the pages of bookmarks).
+ * @param forward Look for a bookmark after the page instead of before it.
+ * @return The bookmark instance if it exists or NULL otherwise.
+ */
+zathura_bookmark_t* zathura_bookmark_find(zathura_t* zathura, unsigned int page, bool forward);
+
 /**
  * Free a bookmark instance.
  * @param bookmark The bookmark instance.
@@ -53,6 +71,30 @@ void zathura_bookmark_free(zathura_bookmark_t* bookmark);
  */
 bool zathura_bookmarks_load(zathura_t* zathura, const gchar* file);
 
+/**
+ * Free the bookmarks and their lookup structures.
+ * @param zathura The zathura instance.
+ */
+void zathura_bookmarks_free(zathura_t* zathura);
+
+/**
+ * Sort bookmarks by page and, on the same page, by id.
+ * @param bookmarks The bookmarks.
+ * @param n Number of bookmarks.
+ */
+void zathura_bookmarks_sort_by_page(zathura_bookmark_t** bookmarks, unsigned int n);
+
+/**
+ * Get the closest bookmark after or before a page by binary search.
+ * @param bookmarks Bookmarks sorted by zathura_bookmarks_sort_by_page.
+ * @param n Number of bookmarks.
+ * @param page The page.
+ * @param forward Look for a bookmark after the page instead of before it.
+ * @return The first bookmark after the page or the last before it, or NULL.
+ */
+zathura_bookmark_t* zathura_bookmarks_find_page(zathura_bookmark_t** bookmarks,
+    unsigned int n, unsigned int page, bool forward);
+
 /**
  * Compare two bookmarks.
  * @param lhs a bookmark
@@ -8,17 +8,22 @@
 #include <gtk/gtk.h>
 #include <string.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "callbacks.h"
 #include "links.h"
 #include "zathura.h"
 #include "render.h"
 #include "document.h"
+#include "document-index.h"
 #include "utils.h"
 #include "shortcuts.h"
 #include "page-widget.h"
 #include "page.h"
 #include "adjustment.h"
+#include "prefetch.h"
+#include "scroll.h"
+#include "server.h"
 
 gboolean
 cb_destroy(GtkWidget* UNUSED(widget), zathura_t* zathura)
@@ -27,6 +32,12 @@ cb_destroy(GtkWidget* UNUSED(widget), zathura_t* zathura)
     document_close(zathura, false);
   }
 
+  /* the other windows of a server stay open */
+  if (zathura != NULL && zathura->server != NULL) {
+    zathura_server_close(zathura->server, zathura);
+    return TRUE;
+  }
+
   gtk_main_quit();
   return TRUE;
 }
@@ -48,6 +59,22 @@ cb_buffer_changed(girara_session_t* session)
   }
 }
 
+/* hides a page; its surface is released if the page cache has evicted it
+ * while the page was visible */
+static void
+page_hide(zathura_t* zathura, zathura_page_t* page)
+{
+  if (zathura_page_get_visibility(page) == false) {
+    return;
+  }
+
+  zathura_page_set_visibility(page, false);
+  GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
+  if (page_widget != NULL) {
+    zathura_page_widget_release_uncached(ZATHURA_PAGE(page_widget));
+  }
+}
+
 void
 cb_view_vadjustment_value_changed(GtkAdjustment* GIRARA_UNUSED(adjustment), gpointer data)
 {
@@ -56,6 +83,8 @@ cb_view_vadjustment_value_changed(GtkAdjustment* GIRARA_UNUSED(adjustment), gpoi
     return;
   }
 
+  const gint64 start = g_get_monotonic_time();
+
   GtkAdjustment* view_vadjustment = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(zathura->ui.session->gtk.view));
   GtkAdjustment* view_hadjustment = gtk_scrolled_window_get_hadjustment(GTK_SCROLLED_WINDOW(zathura->ui.session->gtk.view));
 
@@ -77,27 +106,63 @@ cb_view_vadjustment_value_changed(GtkAdjustment* GIRARA_UNUSED(adjustment), gpoi
     .height = (2 * page_padding) + 1
   };
 
-  unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
   double scale = zathura_document_get_scale(zathura->document);
 
+  /* attach the widgets of the pages around the view */
+  page_widget_update_view(zathura);
+
+  /* pages are positioned relative to the widget containing them */
+  int origin_x = 0;
+  int origin_y = 0;
+  gtk_widget_translate_coordinates(zathura->ui.page_widget,
+                                   zathura->ui.session->gtk.view, 0, 0, &origin_x, &origin_y);
+
+  /* only the pages in the rows intersecting the view can be visible */
+  unsigned int first = 0;
+  unsigned int last  = 0;
+  const bool in_view = zathura_page_layout_get_pages_in_range(zathura->ui.layout.pages,
+      -origin_y, view_rect.height, &first, &last);
+
+  /* hide the pages that left the view */
+  if (zathura->ui.layout.visible.valid == true) {
+    for (unsigned int page_id = zathura->ui.layout.visible.first;
+        page_id <= zathura->ui.layout.visible.last; page_id++) {
+      if (in_view == false || page_id < first || page_id > last) {
+        page_hide(zathura, zathura_document_get_page(zathura->document, page_id));
+      }
+    }
+  }
+
+  zathura->ui.layout.visible.valid = in_view;
+  zathura->ui.layout.visible.first = first;
+  zathura->ui.layout.visible.last  = last;
+
   bool updated = false;
   /* find page that fits */
-  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+  for (unsigned int page_id = first; in_view == true && page_id <= last; page_id++) {
     zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
 
     GdkRectangle page_rect = {
       .width  = zathura_page_get_width(page)  * scale,
       .height = zathura_page_get_height(page) * scale
     };
+    unsigned int page_x = 0;
+    unsigned int page_y = 0;
+    zathura_page_layout_get_page_position(zathura->ui.layout.pages, page_id, &page_x, &page_y);
+    page_rect.x = origin_x + (int) page_x;
+    page_rect.y = origin_y + (int) page_y;
     GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
-    gtk_widget_translate_coordinates(page_widget,
-                                     zathura->ui.session->gtk.view, 0, 0, &page_rect.x, &page_rect.y);
 
     if (gdk_rectangle_intersect(&view_rect, &page_rect, NULL) == TRUE) {
       if (zathura_page_get_visibility(page) == false) {
+	page_load(zathura, page_id);
 	zathura_page_set_visibility(page, true);
 	zathura_page_widget_update_view_time(ZATHURA_PAGE(page_widget));
-	zathura_page_cache_add(zathura, zathura_page_get_index(page));
+	zathura_page_cache_key_t key;
+	render_get_cache_key(zathura, page, &key);
+	zathura_page_cache_touch(zathura->page_cache, &key);
+	/* the render thread might have dropped the page while it was hidden */
+	gtk_widget_queue_draw(page_widget);
       }
       if (zathura->global.update_page_number == true && updated == false
           && gdk_rectangle_intersect(&center, &page_rect, NULL) == TRUE) {
@@ -105,11 +170,28 @@ cb_view_vadjustment_value_changed(GtkAdjustment* GIRARA_UNUSED(adjustment), gpoi
         updated = true;
       }
     } else {
-      zathura_page_set_visibility(page, false);
+      page_hide(zathura, page);
     }
   }
 
+  /* render the pages that are likely to be shown next */
+  prefetch_schedule(zathura);
+
   statusbar_page_number_update(zathura);
+
+  zathura_stats_add(zathura->stats, ZATHURA_STAT_SCROLL, g_get_monotonic_time() - start);
+}
+
+void
+cb_view_adjustment_value_changed(GtkAdjustment* GIRARA_UNUSED(adjustment), gpointer data)
+{
+  zathura_t* zathura = data;
+  if (zathura == NULL || zathura->document == NULL) {
+    return;
+  }
+
+  /* scroll events and animation steps arriving within a frame are coalesced */
+  scroll_update_view(zathura);
 }
 
 void
@@ -162,6 +244,9 @@ cb_view_vadjustment_changed(GtkAdjustment* adjustment, gpointer data)
 
   double ratio = zathura_adjustment_get_ratio(zathura->ui.vadjustment);
   zathura_adjustment_set_value_from_ratio(adjustment, ratio);
+
+  /* the view might have grown */
+  page_widget_update_view(zathura);
 }
 
 void
@@ -260,7 +345,7 @@ cb_index_row_activated(GtkTreeView* tree_view, GtkTreePath* path,
 
   if(gtk_tree_model_get_iter(model, &iter, path)) {
     zathura_index_element_t* index_element;
-    gtk_tree_model_get(model, &iter, 2, &index_element, -1);
+    gtk_tree_model_get(model, &iter, DOCUMENT_INDEX_COLUMN_ELEMENT, &index_element, -1);
 
     if (index_element == NULL) {
       return;
@@ -276,6 +361,18 @@ cb_index_row_activated(GtkTreeView* tree_view, GtkTreePath* path,
   g_object_unref(model);
 }
 
+gboolean
+cb_index_row_test_expand(GtkTreeView* tree_view, GtkTreeIter* iter,
+    GtkTreePath* UNUSED(path), void* UNUSED(data))
+{
+  if (tree_view == NULL || iter == NULL) {
+    return FALSE;
+  }
+
+  document_index_expand(gtk_tree_view_get_model(tree_view), iter);
+  return FALSE;
+}
+
 typedef enum zathura_link_action_e
 {
   ZATHURA_LINK_ACTION_FOLLOW,
@@ -359,23 +456,100 @@ cb_sc_display_link(GtkEntry* entry, girara_session_t* session)
   return handle_link(entry, session, ZATHURA_LINK_ACTION_DISPLAY);
 }
 
+static bool
+file_monitor_stat(const char* path, gint64* size, gint64* mtime)
+{
+  GStatBuf buf;
+  if (g_stat(path, &buf) != 0) {
+    return false;
+  }
+
+  *size  = buf.st_size;
+  *mtime = buf.st_mtime;
+  return true;
+}
+
+static gboolean
+file_monitor_reload(gpointer data)
+{
+  zathura_t* zathura = data;
+  const char* path   = zathura->file_monitor.file_path;
+  if (path == NULL) {
+    zathura->file_monitor.reload_timeout = 0;
+    return FALSE;
+  }
+
+  /* the file might have been removed before being written again */
+  gint64 size  = 0;
+  gint64 mtime = 0;
+  if (file_monitor_stat(path, &size, &mtime) == false) {
+    girara_debug("'%s' is not accessible, waiting for it to be recreated", path);
+    zathura->file_monitor.reload_timeout = 0;
+    return FALSE;
+  }
+
+  /* wait until the file stopped changing */
+  if (size != zathura->file_monitor.size || mtime != zathura->file_monitor.mtime ||
+      zathura->file_monitor.reloading == true) {
+    zathura->file_monitor.size  = size;
+    zathura->file_monitor.mtime = mtime;
+    return TRUE;
+  }
+
+  zathura->file_monitor.reload_timeout = 0;
+  zathura->file_monitor.reloading      = true;
+  document_reload(zathura);
+  zathura->file_monitor.reloading      = false;
+
+  girara_debug("reloaded '%s' %.1f ms after the last change", path,
+               (g_get_monotonic_time() - zathura->file_monitor.last_change) / 1000.0);
+
+  return FALSE;
+}
+
 void
 cb_file_monitor(GFileMonitor* monitor, GFile* file, GFile* UNUSED(other_file), GFileMonitorEvent event, girara_session_t* session)
 {
   g_return_if_fail(monitor  != NULL);
   g_return_if_fail(file     != NULL);
   g_return_if_fail(session  != NULL);
+  g_return_if_fail(session->global.data != NULL);
+  zathura_t* zathura = session->global.data;
 
   switch (event) {
+    case G_FILE_MONITOR_EVENT_CHANGED:
     case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
     case G_FILE_MONITOR_EVENT_CREATED:
-      gdk_threads_enter();
-      sc_reload(session, NULL, NULL, 0);
-      gdk_threads_leave();
       break;
     default:
       return;
   }
+
+  if (zathura->file_monitor.file_path == NULL) {
+    return;
+  }
+
+  /* remember the state of the file; it is reloaded once it did not change
+   * for reload-delay milliseconds */
+  zathura->file_monitor.last_change = g_get_monotonic_time();
+  if (file_monitor_stat(zathura->file_monitor.file_path,
+        &zathura->file_monitor.size, &zathura->file_monitor.mtime) == false) {
+    zathura->file_monitor.size  = -1;
+    zathura->file_monitor.mtime = -1;
+  }
+
+  int reload_delay = 0;
+  girara_setting_get(session, "reload-delay", &reload_delay);
+  if (reload_delay < 0) {
+    reload_delay = 0;
+  }
+
+  /* coalesce with a pending reload */
+  if (zathura->file_monitor.reload_timeout != 0) {
+    g_source_remove(zathura->file_monitor.reload_timeout);
+  }
+  zathura->file_monitor.reload_timeout = gdk_threads_add_timeout(reload_delay,
+      file_monitor_reload, zathura);
 }
 
 static gboolean
@@ -425,6 +599,11 @@ cb_password_dialog(GtkEntry* entry, zathura_password_dialog_info_t* dialog)
     return false;
   }
 
+  /* the document of a tab that could not be opened has been shown again */
+  if (dialog->zathura->document != NULL) {
+    document_close(dialog->zathura, false);
+  }
+
   /* try to open document again */
   if (document_open(dialog->zathura, dialog->path, input,
                     ZATHURA_PAGE_NUMBER_UNSPECIFIED) == false) {
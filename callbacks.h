@@ -12,7 +12,8 @@
 #include "zathura.h"
 
 /**
- * Quits the current zathura session
+ * Quits the current zathura session. A window of a server is closed and the
+ * server keeps running until its last window has been closed.
  *
  * @param widget The gtk window of zathura
  * @param zathura Correspondending zathura session
@@ -36,6 +37,16 @@ void cb_buffer_changed(girara_session_t* session);
  */
 void cb_view_vadjustment_value_changed(GtkAdjustment *adjustment, gpointer data);
 
+/**
+ * This function gets called when the value of the horizontal or vertical
+ * scrollbars changes. The visible pages are updated once per frame by
+ * cb_view_vadjustment_value_changed.
+ *
+ * @param adjustment The adjustment of the page view
+ * @param data The zathura session
+ */
+void cb_view_adjustment_value_changed(GtkAdjustment *adjustment, gpointer data);
+
 /**
  * This function gets called when the bounds or the page_size of the horizontal
  * scrollbar change (e.g. when the zoom level is changed).
@@ -118,6 +129,18 @@ void cb_first_page_column_value_changed(girara_session_t* session, const char* n
 void cb_index_row_activated(GtkTreeView* tree_view, GtkTreePath* path,
     GtkTreeViewColumn* column, void* zathura);
 
+/**
+ * Called before an index element is expanded; adds its children to the model
+ *
+ * @param tree_view Tree view
+ * @param iter The element
+ * @param path Path
+ * @param data NULL
+ * @return false, so that the element is expanded
+ */
+gboolean cb_index_row_test_expand(GtkTreeView* tree_view, GtkTreeIter* iter,
+    GtkTreePath* path, void* data);
+
 /**
  * Called when input has been passed to the sc_follow dialog
  *
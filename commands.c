@@ -18,6 +18,9 @@
 #include "plugin.h"
 #include "internal.h"
 #include "render.h"
+#include "search.h"
+#include "export.h"
+#include "tabs.h"
 
 #include <girara/session.h>
 #include <girara/settings.h>
@@ -45,7 +48,7 @@ cmd_bookmark_create(girara_session_t* session, girara_list_t* argument_list)
   const char* bookmark_name = girara_list_nth(argument_list, 0);
   zathura_bookmark_t* bookmark = zathura_bookmark_get(zathura, bookmark_name);
   if (bookmark != NULL) {
-    bookmark->page = zathura_document_get_current_page_number(zathura->document) + 1;
+    zathura_bookmark_set_page(zathura, bookmark, zathura_document_get_current_page_number(zathura->document) + 1);
     girara_notify(session, GIRARA_INFO, _("Bookmark successfuly updated: %s"), bookmark_name);
     return true;
   }
@@ -120,11 +123,11 @@ cmd_close(girara_session_t* session, girara_list_t* UNUSED(argument_list))
   g_return_val_if_fail(session != NULL, false);
   g_return_val_if_fail(session->global.data != NULL, false);
   zathura_t* zathura = session->global.data;
-  if (zathura->document == NULL) {
+  if (zathura->document == NULL && tab_count(zathura) == 0) {
     return true;
   }
 
-  document_close(zathura, false);
+  tab_close(zathura);
 
   return true;
 }
@@ -236,6 +239,28 @@ cmd_open(girara_session_t* session, girara_list_t* argument_list)
   return true;
 }
 
+bool
+cmd_tabopen(girara_session_t* session, girara_list_t* argument_list)
+{
+  g_return_val_if_fail(session != NULL, false);
+  g_return_val_if_fail(session->global.data != NULL, false);
+  zathura_t* zathura = session->global.data;
+
+  const int argc = girara_list_size(argument_list);
+  if (argc > 2) {
+    girara_notify(session, GIRARA_ERROR, _("Too many arguments."));
+    return false;
+  } else if (argc == 0) {
+    girara_notify(session, GIRARA_ERROR, _("No arguments given."));
+    return false;
+  }
+
+  tab_open(zathura, girara_list_nth(argument_list, 0),
+           (argc == 2) ? girara_list_nth(argument_list, 1) : NULL);
+
+  return true;
+}
+
 bool
 cmd_quit(girara_session_t* session, girara_list_t* UNUSED(argument_list))
 {
@@ -339,15 +364,9 @@ cmd_search(girara_session_t* session, const char* input, girara_argument_t* argu
     return false;
   }
 
-  bool firsthit = true;
-  zathura_error_t error = ZATHURA_ERROR_OK;
-
   /* set search direction */
   zathura->global.search_direction = argument->n;
 
-  unsigned int number_of_pages     = zathura_document_get_number_of_pages(zathura->document);
-  unsigned int current_page_number = zathura_document_get_current_page_number(zathura->document);
-
   /* reset search highlighting */
   bool nohlsearch = false;
   girara_setting_get(session, "nohlsearch", &nohlsearch);
@@ -356,47 +375,72 @@ cmd_search(girara_session_t* session, const char* input, girara_argument_t* argu
     document_draw_search_results(zathura, true);
   }
 
-  /* search pages */
-  for (unsigned int page_id = 0; page_id < number_of_pages; ++page_id) {
-    unsigned int index = (page_id + current_page_number) % number_of_pages;
-    zathura_page_t* page = zathura_document_get_page(zathura->document, index);
-    if (page == NULL) {
-      continue;
-    }
+  /* search pages in the background; the results show up as they are found */
+  bool incremental = false;
+  girara_setting_get(session, "incremental-search", &incremental);
+  if (incremental == true) {
+    return search_start_delayed(zathura, input, argument->n);
+  }
 
-    GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
-    g_object_set(page_widget, "draw-links", FALSE, NULL);
+  return search_start(zathura, input, argument->n);
+}
 
-    render_lock(zathura->sync.render_thread);
-    girara_list_t* result = zathura_page_search_text(page, input, &error);
-    render_unlock(zathura->sync.render_thread);
+/* largest scale pages are exported at */
+#define EXPORT_MAX_SCALE 10.0
 
-    if (result == NULL || girara_list_size(result) == 0) {
-      girara_list_free(result);
-      g_object_set(page_widget, "search-results", NULL, NULL);
+/* :export pages <range> <directory> [--scale=<scale>] */
+static bool
+cmd_export_pages(zathura_t* zathura, girara_list_t* argument_list)
+{
+  girara_session_t* session = zathura->ui.session;
 
-      if (error == ZATHURA_ERROR_NOT_IMPLEMENTED) {
-        break;
-      } else {
-        continue;
-      }
-    }
+  const size_t number_of_arguments = girara_list_size(argument_list);
+  if (number_of_arguments != 3 && number_of_arguments != 4) {
+    girara_notify(session, GIRARA_ERROR, _("Invalid number of arguments given."));
+    return false;
+  }
 
-    g_object_set(page_widget, "search-results", result, NULL);
-    if (firsthit == true) {
-      if (page_id != 0) {
-        page_set_delayed(zathura, zathura_page_get_index(page));
-      }
-      if (argument->n == BACKWARD) {
-        /* start at bottom hit in page */
-        g_object_set(page_widget, "search-current", girara_list_size(result) - 1, NULL);
-      } else {
-        g_object_set(page_widget, "search-current", 0, NULL);
-      }
-      firsthit = false;
+  const char* range     = girara_list_nth(argument_list, 1);
+  const char* directory = girara_list_nth(argument_list, 2);
+  if (range == NULL || directory == NULL) {
+    return false;
+  }
+
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  unsigned int first = 0;
+  unsigned int last  = 0;
+  if (export_parse_page_range(range, number_of_pages, &first, &last) == false) {
+    girara_notify(session, GIRARA_ERROR, _("Invalid page range '%s'."), range);
+    return false;
+  }
+
+  double scale = 1.0;
+  if (number_of_arguments == 4) {
+    const char* option = girara_list_nth(argument_list, 3);
+    char* end = NULL;
+    if (option != NULL && strncmp(option, "--scale=", strlen("--scale=")) == 0) {
+      scale = g_ascii_strtod(option + strlen("--scale="), &end);
+    }
+    if (end == NULL || *end != '\0' || end == option + strlen("--scale=") ||
+        scale <= 0.0 || scale > EXPORT_MAX_SCALE) {
+      girara_notify(session, GIRARA_ERROR, _("Invalid scale '%s'."), option);
+      return false;
     }
   }
 
+  char* export_path = girara_fix_path(directory);
+  if (export_path == NULL) {
+    return false;
+  }
+
+  if (export_pages_start(zathura, first, last, export_path, scale) == false) {
+    girara_notify(session, GIRARA_ERROR, _("Couldn't export pages to '%s'."), export_path);
+    g_free(export_path);
+    return false;
+  }
+
+  g_free(export_path);
+
   return true;
 }
 
@@ -411,6 +455,12 @@ cmd_export(girara_session_t* session, girara_list_t* argument_list)
     return false;
   }
 
+  /* rasterized pages */
+  if (girara_list_size(argument_list) > 0 &&
+      g_strcmp0(girara_list_nth(argument_list, 0), "pages") == 0) {
+    return cmd_export_pages(zathura, argument_list);
+  }
+
   if (girara_list_size(argument_list) != 2) {
     girara_notify(session, GIRARA_ERROR, _("Invalid number of arguments given."));
     return false;
@@ -571,3 +621,56 @@ cmd_version(girara_session_t* session, girara_list_t* UNUSED(argument_list))
 
   return true;
 }
+
+bool
+cmd_stats(girara_session_t* session, girara_list_t* argument_list)
+{
+  g_return_val_if_fail(session != NULL, false);
+  g_return_val_if_fail(session->global.data != NULL, false);
+  zathura_t* zathura = session->global.data;
+
+  const size_t number_of_arguments = girara_list_size(argument_list);
+  const char* action = number_of_arguments > 0 ? girara_list_nth(argument_list, 0) : NULL;
+
+  if (number_of_arguments == 1 && g_strcmp0(action, "reset") == 0) {
+    zathura_stats_reset(zathura->stats);
+    girara_notify(session, GIRARA_INFO, _("Statistics have been reset."));
+    return true;
+  } else if (number_of_arguments > 0 && (number_of_arguments != 2 || g_strcmp0(action, "json") != 0)) {
+    girara_notify(session, GIRARA_ERROR, _("Invalid number of arguments given."));
+    return false;
+  }
+
+  zathura_page_cache_statistics_t cache;
+  zathura_page_cache_get_statistics(zathura->page_cache, &cache);
+  zathura_surface_pool_statistics_t pool;
+  zathura_surface_pool_get_statistics(zathura->surface_pool, &pool);
+
+  /* display the statistics */
+  if (number_of_arguments == 0) {
+    char* string = zathura_stats_to_string(zathura->stats, &cache, &pool);
+    girara_notify(session, GIRARA_INFO, "%s", string);
+    g_free(string);
+    return true;
+  }
+
+  /* write them to a file */
+  char* path = girara_fix_path(girara_list_nth(argument_list, 1));
+  if (path == NULL) {
+    return false;
+  }
+
+  char* json = zathura_stats_to_json(zathura->stats, &cache, &pool);
+  GError* error = NULL;
+  const bool written = g_file_set_contents(path, json, -1, &error) == TRUE;
+  if (written == true) {
+    girara_notify(session, GIRARA_INFO, _("Wrote statistics to '%s'."), path);
+  } else {
+    girara_notify(session, GIRARA_ERROR, _("Could not write statistics to '%s': %s"), path, error->message);
+    g_error_free(error);
+  }
+  g_free(json);
+  g_free(path);
+
+  return written;
+}
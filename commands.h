@@ -78,6 +78,15 @@ bool cmd_hlsearch(girara_session_t* session, girara_list_t* argument_list);
  */
 bool cmd_open(girara_session_t* session, girara_list_t* argument_list);
 
+/**
+ * Opens a document file in a new tab
+ *
+ * @param session The used girara session
+ * @param argument_list List of passed arguments
+ * @return true if no error occured
+ */
+bool cmd_tabopen(girara_session_t* session, girara_list_t* argument_list);
+
 /**
  * Print the current file
  *
@@ -169,4 +178,14 @@ bool cmd_offset(girara_session_t* session, girara_list_t* argument_list);
  */
 bool cmd_version(girara_session_t* session, girara_list_t* argument_list);
 
+/**
+ * Shows render and UI latency statistics, resets them ("reset") or writes
+ * them to a file as JSON ("json <file>")
+ *
+ * @param session The used girara session
+ * @param argument_list List of passed arguments
+ * @return true if no error occured
+ */
+bool cmd_stats(girara_session_t* session, girara_list_t* argument_list);
+
 #endif // COMMANDS_H
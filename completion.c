@@ -19,82 +19,56 @@
 #include <girara/utils.h>
 #include <girara/datastructures.h>
 
-static int
-compare_case_insensitive(const char* str1, const char* str2)
+/* directories of this many completions are kept */
+#define DIR_CACHE_SIZE 8
+
+static bool
+dir_cache_filter_supported(const char* path, void* data)
 {
-  char* ustr1 = g_utf8_casefold(str1, -1);
-  char* ustr2 = g_utf8_casefold(str2, -1);
-  int res = g_utf8_collate(ustr1, ustr2);
-  g_free(ustr1);
-  g_free(ustr2);
-  return res;
+  return file_valid_extension(data, path);
 }
 
 static girara_list_t*
 list_files(zathura_t* zathura, const char* current_path, const char* current_file,
-           unsigned int current_file_length, bool is_dir, bool check_file_ext)
+           bool is_dir, bool check_file_ext)
 {
   if (zathura == NULL || zathura->ui.session == NULL || current_path == NULL) {
     return NULL;
   }
 
-  /* read directory */
-  GDir* dir = g_dir_open(current_path, 0, NULL);
-  if (dir == NULL) {
-    return NULL;
+  if (zathura->dir_cache == NULL) {
+    zathura->dir_cache = zathura_dir_cache_new(DIR_CACHE_SIZE, dir_cache_filter_supported, zathura);
   }
 
-  girara_list_t* res = girara_sorted_list_new2((girara_compare_function_t)compare_case_insensitive,
-                       (girara_free_function_t)g_free);
-
   bool show_hidden = false;
   girara_setting_get(zathura->ui.session, "show-hidden", &show_hidden);
   bool show_directories = true;
   girara_setting_get(zathura->ui.session, "show-directories", &show_directories);
 
-  /* read files */
-  char* name = NULL;
-  while ((name = (char*) g_dir_read_name(dir)) != NULL) {
-    char* e_name   = g_filename_display_name(name);
-    if (e_name == NULL) {
-      goto error_free;
-    }
-
-    size_t e_length = strlen(e_name);
-
-    if (show_hidden == false && e_name[0] == '.') {
-      g_free(e_name);
-      continue;
-    }
+  /* the directory is read once and listed from the cache while typing */
+  char* directory = g_strdup(current_path);
+  const size_t length = strlen(directory);
+  if (length > 1 && directory[length - 1] == '/') {
+    directory[length - 1] = '\0';
+  }
 
-    if ((current_file_length > e_length) || strncmp(current_file, e_name, current_file_length)) {
-      g_free(e_name);
-      continue;
-    }
+  girara_list_t* names = zathura_dir_cache_list(zathura->dir_cache, directory,
+      current_file, show_hidden, show_directories, check_file_ext);
+  g_free(directory);
+  if (names == NULL) {
+    return NULL;
+  }
 
-    char* tmp = "/";
-    if (is_dir == true || g_strcmp0(current_path, "/") == 0) {
-      tmp = "";
-    };
-
-    char* full_path = g_strdup_printf("%s%s%s", current_path, tmp, e_name);
-
-    if (g_file_test(full_path, G_FILE_TEST_IS_DIR) == true) {
-      if (show_directories == false) {
-        g_free(e_name);
-        g_free(full_path);
-        continue;
-      }
-      girara_list_append(res, full_path);
-    } else if (check_file_ext == false || file_valid_extension(zathura, full_path) == true) {
-      girara_list_append(res, full_path);
-    } else {
-      g_free(full_path);
-    }
-    g_free(e_name);
+  const char* separator = "/";
+  if (is_dir == true || g_strcmp0(current_path, "/") == 0) {
+    separator = "";
   }
 
-  g_dir_close(dir);
+  girara_list_t* res = girara_list_new2((girara_free_function_t) g_free);
+  GIRARA_LIST_FOREACH(names, const char*, iter, name)
+  girara_list_append(res, g_strdup_printf("%s%s%s", current_path, separator, name));
+  GIRARA_LIST_FOREACH_END(names, const char*, iter, name);
+  girara_list_free(names);
 
   if (girara_list_size(res) == 1) {
     char* path = girara_list_nth(res, 0);
@@ -106,10 +80,6 @@ list_files(zathura_t* zathura, const char* current_path, const char* current_fil
   }
 
   return res;
-
-error_free:
-  girara_list_free(res);
-  return NULL;
 }
 
 static girara_completion_t*
@@ -168,12 +138,11 @@ list_files_for_cc(zathura_t* zathura, const char* input, bool check_file_ext)
   g_free(tmp);
 
   /* get current file */
-  gchar* current_file     = is_dir ? "" : basename(path);
-  int current_file_length = strlen(current_file);
+  gchar* current_file = is_dir ? "" : basename(path);
 
   /* read directory */
   if (g_file_test(current_path, G_FILE_TEST_IS_DIR) == TRUE) {
-    girara_list_t* names = list_files(zathura, current_path, current_file, current_file_length, is_dir, check_file_ext);
+    girara_list_t* names = list_files(zathura, current_path, current_file, is_dir, check_file_ext);
     if (!names) {
       goto error_free;
     }
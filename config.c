@@ -2,6 +2,7 @@
 
 #include "config.h"
 #include "commands.h"
+#include "database-plain.h"
 #include "completion.h"
 #include "callbacks.h"
 #include "shortcuts.h"
@@ -33,6 +34,23 @@ cb_jumplist_change(girara_session_t* session, const char* name,
   }
 }
 
+static bool
+page_cache_filter_recolored(const zathura_page_cache_key_t* key, void* UNUSED(data))
+{
+  return key->recolor != 0;
+}
+
+static void
+recolor_colors_change(zathura_t* zathura)
+{
+  /* surfaces recolored with the old colors are outdated, but the
+   * un-recolored ones can be recolored again without the plugin */
+  zathura_page_cache_remove_matching(zathura->page_cache, page_cache_filter_recolored, NULL);
+  if (zathura->global.recolor == true) {
+    render_all(zathura);
+  }
+}
+
 static void
 cb_color_change(girara_session_t* session, const char* name,
                 girara_setting_type_t UNUSED(type), void* value, void* UNUSED(data))
@@ -50,8 +68,10 @@ cb_color_change(girara_session_t* session, const char* name,
     gdk_color_parse(string_value, &(zathura->ui.colors.highlight_color_active));
   } else if (g_strcmp0(name, "recolor-darkcolor") == 0) {
     gdk_color_parse(string_value, &(zathura->ui.colors.recolor_dark_color));
+    recolor_colors_change(zathura);
   } else if (g_strcmp0(name, "recolor-lightcolor") == 0) {
     gdk_color_parse(string_value, &(zathura->ui.colors.recolor_light_color));
+    recolor_colors_change(zathura);
   } else if (g_strcmp0(name, "render-loading-bg") == 0) {
     gdk_color_parse(string_value, &(zathura->ui.colors.render_loading_bg));
   } else if (g_strcmp0(name, "render-loading-fg") == 0) {
@@ -61,6 +81,30 @@ cb_color_change(girara_session_t* session, const char* name,
   render_all(zathura);
 }
 
+static void
+cb_draw_setting_changed(girara_session_t* session, const char* name,
+                        girara_setting_type_t UNUSED(type), void* value, void* UNUSED(data))
+{
+  g_return_if_fail(value != NULL);
+  g_return_if_fail(session != NULL);
+  g_return_if_fail(session->global.data != NULL);
+  g_return_if_fail(name != NULL);
+  zathura_t* zathura = session->global.data;
+
+  /* the page widgets read these on every draw */
+  if (g_strcmp0(name, "highlight-transparency") == 0) {
+    zathura->ui.highlight_transparency = *(float*) value;
+  } else if (g_strcmp0(name, "render-loading") == 0) {
+    zathura->ui.render_loading = *(bool*) value;
+  } else if (g_strcmp0(name, "upload-pages") == 0) {
+    zathura->ui.upload_pages = *(bool*) value;
+  }
+
+  if (zathura->ui.page_widget != NULL) {
+    gtk_widget_queue_draw(zathura->ui.page_widget);
+  }
+}
+
 static void
 cb_page_padding_changed(girara_session_t* session, const char* UNUSED(name),
                         girara_setting_type_t UNUSED(type), void* value, void* UNUSED(data))
@@ -71,15 +115,8 @@ cb_page_padding_changed(girara_session_t* session, const char* UNUSED(name),
   zathura_t* zathura = session->global.data;
 
   int val = *(int*) value;
-  if (GTK_IS_TABLE(zathura->ui.page_widget) == TRUE) {
-#if (GTK_MAJOR_VERSION == 3)
-    gtk_grid_set_row_spacing(GTK_GRID(zathura->ui.page_widget), val);
-    gtk_grid_set_column_spacing(GTK_GRID(zathura->ui.page_widget), val);
-#else
-    gtk_table_set_row_spacings(GTK_TABLE(zathura->ui.page_widget), val);
-    gtk_table_set_col_spacings(GTK_TABLE(zathura->ui.page_widget), val);
-#endif
-  }
+  zathura_page_layout_set_padding(zathura->ui.layout.pages, MAX(val, 0));
+  page_widget_update_layout(zathura);
 }
 
 static void
@@ -137,6 +174,8 @@ config_load_default(zathura_t* zathura)
 
   /* zathura settings */
   girara_setting_add(gsession, "database",              "plain",      STRING, true,  _("Database backend"),        NULL, NULL);
+  int_value = ZATHURA_PLAINDATABASE_HISTORY_LIMIT;
+  girara_setting_add(gsession, "history-limit",         &int_value,   INT,    true,  _("Number of documents whose position is remembered"), NULL, NULL);
   int_value = 10;
   girara_setting_add(gsession, "zoom-step",             &int_value,   INT,    false, _("Zoom step"),               NULL, NULL);
   int_value = 1;
@@ -155,8 +194,34 @@ config_load_default(zathura_t* zathura)
   girara_setting_add(gsession, "zoom-min",              &int_value,   INT,    false, _("Zoom minimum"), NULL, NULL);
   int_value = 1000;
   girara_setting_add(gsession, "zoom-max",              &int_value,   INT,    false, _("Zoom maximum"), NULL, NULL);
+  int_value = 150;
+  girara_setting_add(gsession, "zoom-render-delay",     &int_value,   INT,    false, _("Time in milliseconds after the last zoom step until pages are rendered"), NULL, NULL);
+  int_value = 150;
+  girara_setting_add(gsession, "smooth-scroll-duration", &int_value,  INT,    false, _("Duration in milliseconds of animated scrolling"), NULL, NULL);
   int_value = ZATHURA_PAGE_CACHE_DEFAULT_SIZE;
   girara_setting_add(gsession, "page-cache-size",       &int_value,   INT,    true,  _("Maximum number of pages to keep in the cache"), NULL, NULL);
+  int_value = ZATHURA_PAGE_CACHE_DEFAULT_MEMORY;
+  girara_setting_add(gsession, "page-cache-memory",     &int_value,   INT,    true,  _("Maximum amount of memory in MiB used by the page cache"), NULL, NULL);
+  int_value = 64;
+  girara_setting_add(gsession, "readahead-size",        &int_value,   INT,    false, _("Maximum size in MiB of documents that are read ahead when they are opened"), NULL, NULL);
+  int_value = 10;
+  girara_setting_add(gsession, "memory-pressure-threshold", &int_value, INT,  true, _("Memory pressure in percent at which memory of hidden pages is released"), NULL, NULL);
+  int_value = ZATHURA_SURFACE_POOL_DEFAULT_MEMORY;
+  girara_setting_add(gsession, "surface-pool-memory",   &int_value,   INT,    true,  _("Maximum amount of memory in MiB kept for reusing surfaces"), NULL, NULL);
+  int_value = 1;
+  girara_setting_add(gsession, "render-threads",        &int_value,   INT,    true,  _("Number of threads used for rendering"), NULL, NULL);
+  int_value = 0;
+  girara_setting_add(gsession, "render-tile-size",      &int_value,   INT,    true,  _("Size of the tiles large pages are rendered in"), NULL, NULL);
+  int_value = 256;
+  girara_setting_add(gsession, "render-cache-size",     &int_value,   INT,    true,  _("Maximum amount of disk space in MiB used by the render cache"), NULL, NULL);
+  int_value = 0;
+  girara_setting_add(gsession, "stats-interval",        &int_value,   INT,    true,  _("Interval in seconds in which statistics are logged (0 to disable)"), NULL, NULL);
+  int_value = 128;
+  girara_setting_add(gsession, "thumbnail-size",        &int_value,   INT,    true,  _("Size of the thumbnails shown instead of small pages"), NULL, NULL);
+  int_value = 2;
+  girara_setting_add(gsession, "prefetch-pages",        &int_value,   INT,    false, _("Number of pages to render before they are shown"), NULL, NULL);
+  int_value = 300;
+  girara_setting_add(gsession, "reload-delay",          &int_value,   INT,    false, _("Time in milliseconds the file has to stay unchanged before it is reloaded"), NULL, NULL);
   int_value = 20;
   girara_setting_add(gsession, "jumplist-size",         &int_value,   INT,    false, _("Number of positions to remember in the jumplist"), cb_jumplist_change, NULL);
 
@@ -182,6 +247,10 @@ config_load_default(zathura_t* zathura)
   bool_value = false;
   girara_setting_add(gsession, "scroll-page-aware",      &bool_value,  BOOLEAN, false, _("Page aware scrolling"), NULL, NULL);
   bool_value = false;
+  girara_setting_add(gsession, "smooth-scroll",          &bool_value,  BOOLEAN, false, _("Animate scrolling"), NULL, NULL);
+  bool_value = false;
+  girara_setting_add(gsession, "kinetic-scroll",         &bool_value,  BOOLEAN, false, _("Keep the view moving after dragging it"), NULL, NULL);
+  bool_value = false;
   girara_setting_add(gsession, "advance-pages-per-row",  &bool_value,  BOOLEAN, false, _("Advance number of pages per row"), NULL, NULL);
   bool_value = false;
   girara_setting_add(gsession, "zoom-center",            &bool_value,  BOOLEAN, false, _("Horizontally centered zoom"), NULL, NULL);
@@ -189,11 +258,25 @@ config_load_default(zathura_t* zathura)
   girara_setting_add(gsession, "link-hadjust",           &bool_value,  BOOLEAN, false, _("Align link target to the left"), NULL, NULL);
   bool_value = true;
   girara_setting_add(gsession, "search-hadjust",         &bool_value,  BOOLEAN, false, _("Center result horizontally"), NULL, NULL);
+  bool_value = false;
+  girara_setting_add(gsession, "search-text-index",      &bool_value,  BOOLEAN, false, _("Keep an index of the document's text to speed up searches"), NULL, NULL);
   float_value = 0.5;
-  girara_setting_add(gsession, "highlight-transparency", &float_value, FLOAT,   false, _("Transparency for highlighting"), NULL, NULL);
+  girara_setting_add(gsession, "highlight-transparency", &float_value, FLOAT,   false, _("Transparency for highlighting"), cb_draw_setting_changed, NULL);
+  zathura->ui.highlight_transparency = float_value;
+  bool_value = true;
+  girara_setting_add(gsession, "render-loading",         &bool_value,  BOOLEAN, false, _("Render 'Loading ...'"), cb_draw_setting_changed, NULL);
+  zathura->ui.render_loading = bool_value;
   bool_value = true;
-  girara_setting_add(gsession, "render-loading",         &bool_value,  BOOLEAN, false, _("Render 'Loading ...'"), NULL, NULL);
+  girara_setting_add(gsession, "render-preview",         &bool_value,  BOOLEAN, true,  _("Show a low resolution preview while a page is rendered"), NULL, NULL);
+  bool_value = false;
+  girara_setting_add(gsession, "render-cache",           &bool_value,  BOOLEAN, true,  _("Keep rendered pages on disk"), NULL, NULL);
+  bool_value = true;
+  girara_setting_add(gsession, "thumbnail-cache",        &bool_value,  BOOLEAN, true,  _("Keep the thumbnails of documents on disk"), NULL, NULL);
+  bool_value = true;
+  girara_setting_add(gsession, "upload-pages",           &bool_value,  BOOLEAN, false, _("Keep rendered pages on the display server"), cb_draw_setting_changed, NULL);
+  zathura->ui.upload_pages = bool_value;
   girara_setting_add(gsession, "adjust-open",            "best-fit",   STRING,  false, _("Adjust to when opening file"), NULL, NULL);
+  girara_setting_add(gsession, "prefetch-direction",     "scroll",     STRING,  false, _("Direction in which pages are rendered before they are shown"), NULL, NULL);
   bool_value = false;
   girara_setting_add(gsession, "show-hidden",            &bool_value,  BOOLEAN, false, _("Show hidden files and directories"), NULL, NULL);
   bool_value = true;
@@ -240,6 +323,11 @@ config_load_default(zathura_t* zathura)
   girara_shortcut_add(gsession, 0,                0,                  "G",  sc_goto,                     NORMAL,     BOTTOM,          NULL);
   girara_shortcut_add(gsession, 0,                0,                  "G",  sc_goto,                     FULLSCREEN, BOTTOM,          NULL);
 
+  girara_shortcut_add(gsession, 0,                0,                  "gt", sc_switch_tab,               NORMAL,     NEXT,            NULL);
+  girara_shortcut_add(gsession, 0,                0,                  "gT", sc_switch_tab,               NORMAL,     PREVIOUS,        NULL);
+  girara_shortcut_add(gsession, 0,                0,                  "gb", sc_navigate_bookmarks,       NORMAL,     NEXT,            NULL);
+  girara_shortcut_add(gsession, 0,                0,                  "gB", sc_navigate_bookmarks,       NORMAL,     PREVIOUS,        NULL);
+
   girara_shortcut_add(gsession, 0,                GDK_KEY_m,          NULL, sc_mark_add,                 NORMAL,     0,               NULL);
   girara_shortcut_add(gsession, 0,                GDK_KEY_apostrophe, NULL, sc_mark_evaluate,            NORMAL,     0,               NULL);
 
@@ -384,6 +472,7 @@ config_load_default(zathura_t* zathura)
   girara_inputbar_command_add(gsession, "open",       "o",    cmd_open,            cc_open,      _("Open document"));
   girara_inputbar_command_add(gsession, "quit",       "q",    cmd_quit,            NULL,         _("Close zathura"));
   girara_inputbar_command_add(gsession, "print",      NULL,   cmd_print,           NULL,         _("Print document"));
+  girara_inputbar_command_add(gsession, "tabopen",    "t",    cmd_tabopen,         cc_open,      _("Open document in a new tab"));
   girara_inputbar_command_add(gsession, "write",      NULL,   cmd_save,            cc_write,     _("Save document"));
   girara_inputbar_command_add(gsession, "write!",     NULL,   cmd_savef,           cc_write,     _("Save document (and force overwriting)"));
   girara_inputbar_command_add(gsession, "export",     NULL,   cmd_export,          cc_export,    _("Save attachments"));
@@ -393,6 +482,7 @@ config_load_default(zathura_t* zathura)
   girara_inputbar_command_add(gsession, "nohlsearch", "nohl", cmd_nohlsearch,      NULL,         _("Don't highlight current search results"));
   girara_inputbar_command_add(gsession, "hlsearch",   NULL,   cmd_hlsearch,        NULL,         _("Highlight current search results"));
   girara_inputbar_command_add(gsession, "version",    NULL,   cmd_version,         NULL,         _("Show version information"));
+  girara_inputbar_command_add(gsession, "stats",      NULL,   cmd_stats,           NULL,         _("Show render statistics"));
 
   girara_special_command_add(gsession, '/', cmd_search, inc_search, FORWARD,  NULL);
   girara_special_command_add(gsession, '?', cmd_search, inc_search, BACKWARD, NULL);
@@ -409,6 +499,7 @@ config_load_default(zathura_t* zathura)
   girara_shortcut_mapping_add(gsession, "bisect",            sc_bisect);
   girara_shortcut_mapping_add(gsession, "navigate",          sc_navigate);
   girara_shortcut_mapping_add(gsession, "navigate_index",    sc_navigate_index);
+  girara_shortcut_mapping_add(gsession, "navigate_bookmarks", sc_navigate_bookmarks);
   girara_shortcut_mapping_add(gsession, "print",             sc_print);
   girara_shortcut_mapping_add(gsession, "quit",              sc_quit);
   girara_shortcut_mapping_add(gsession, "recolor",           sc_recolor);
@@ -417,6 +508,7 @@ config_load_default(zathura_t* zathura)
   girara_shortcut_mapping_add(gsession, "scroll",            sc_scroll);
   girara_shortcut_mapping_add(gsession, "search",            sc_search);
   girara_shortcut_mapping_add(gsession, "toggle_fullscreen", sc_toggle_fullscreen);
+  girara_shortcut_mapping_add(gsession, "toggle_overview",   sc_toggle_overview);
   girara_shortcut_mapping_add(gsession, "toggle_index",      sc_toggle_index);
   girara_shortcut_mapping_add(gsession, "toggle_inputbar",   girara_sc_toggle_inputbar);
   girara_shortcut_mapping_add(gsession, "toggle_page_mode",  sc_toggle_page_mode);
@@ -14,19 +14,16 @@
 #include <girara/input-history.h>
 
 #include "database-plain.h"
+#include "history-store.h"
 
 #define BOOKMARKS "bookmarks"
 #define HISTORY "history"
 #define INPUT_HISTORY "input-history"
 
-#define KEY_PAGE "page"
-#define KEY_OFFSET "offset"
-#define KEY_SCALE "scale"
-#define KEY_ROTATE "rotate"
-#define KEY_PAGES_PER_ROW "pages-per-row"
-#define KEY_FIRST_PAGE_COLUMN "first-page-column"
-#define KEY_POSITION_X "position-x"
-#define KEY_POSITION_Y "position-y"
+/* seconds changes are kept in memory before they are written */
+#define FLUSH_DELAY 2
+/* the input history is compacted after this many appended lines */
+#define INPUT_HISTORY_COMPACT_INTERVAL 256
 
 #ifdef __GNU__
 #include <sys/file.h>
@@ -64,8 +61,17 @@ static girara_list_t* plain_io_read(GiraraInputHistoryIO* db);
 
 /* forward declaration */
 static bool zathura_db_check_file(const char* path);
+static char* zathura_db_read_file(const char* path);
+static bool zathura_db_write_file(const char* path, const char* content, gsize length);
 static GKeyFile* zathura_db_read_key_file_from_file(const char* path);
 static void zathura_db_write_key_file_to_file(const char* file, GKeyFile* key_file);
+static bool zathura_db_read_history(const char* path, zathura_history_store_t* history);
+static void zathura_db_merge_pending(GKeyFile* pending, GKeyFile* key_file, GHashTable* groups);
+static void plain_schedule_flush(zathura_database_t* db);
+static void plain_changed(zathura_database_t* db, GHashTable* groups, const char* name);
+static void plain_flush(zathura_database_t* db);
+static girara_list_t* plain_io_compact(const char* content, unsigned int* redundant);
+static void plain_io_rewrite(const char* path);
 static void cb_zathura_db_watch_file(GFileMonitor* monitor, GFile* file, GFile*
                                      other_file, GFileMonitorEvent event, zathura_database_t* database);
 
@@ -75,10 +81,16 @@ typedef struct zathura_plaindatabase_private_s {
   GFileMonitor* bookmark_monitor;
 
   char* history_path;
-  GKeyFile* history;
+  zathura_history_store_t* history;
   GFileMonitor* history_monitor;
 
   char* input_history_path;
+  unsigned int input_history_appended; /**< Lines appended since the last compaction */
+
+  /* groups with changes that have not been written yet; the history keeps
+   * track of its own changes */
+  GHashTable* bookmarks_changed;
+  guint flush_source; /**< Source that writes the changes */
 } zathura_plaindatabase_private_t;
 
 #define ZATHURA_PLAINDATABASE_GET_PRIVATE(obj) \
@@ -150,6 +162,9 @@ zathura_plaindatabase_init(ZathuraPlainDatabase* db)
   priv->history_monitor       = NULL;
   priv->history               = NULL;
   priv->input_history_path    = NULL;
+  priv->input_history_appended = 0;
+  priv->bookmarks_changed     = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  priv->flush_source          = 0;
 }
 
 zathura_database_t*
@@ -221,8 +236,8 @@ plain_db_init(ZathuraPlainDatabase* db, const char* dir)
     db
   );
 
-  priv->history = zathura_db_read_key_file_from_file(priv->history_path);
-  if (priv->history == NULL) {
+  priv->history = zathura_history_store_new(ZATHURA_PLAINDATABASE_HISTORY_LIMIT);
+  if (zathura_db_read_history(priv->history_path, priv->history) == false) {
     goto error_free;
   }
 
@@ -259,10 +274,8 @@ error_free:
     priv->history_monitor = NULL;
   }
 
-  if (priv->history != NULL) {
-    g_key_file_free(priv->history);
-    priv->history = NULL;
-  }
+  zathura_history_store_free(priv->history);
+  priv->history = NULL;
 
   /* input history */
   g_free(priv->input_history_path);
@@ -289,6 +302,10 @@ plain_finalize(GObject* object)
   ZathuraPlainDatabase* db = ZATHURA_PLAINDATABASE(object);
   zathura_plaindatabase_private_t* priv = ZATHURA_PLAINDATABASE_GET_PRIVATE(db);
 
+  /* write the changes that are still pending */
+  plain_flush(ZATHURA_DATABASE(db));
+  g_hash_table_destroy(priv->bookmarks_changed);
+
   /* bookmarks */
   g_free(priv->bookmark_path);
 
@@ -307,9 +324,7 @@ plain_finalize(GObject* object)
     g_object_unref(priv->history_monitor);
   }
 
-  if (priv->history != NULL) {
-    g_key_file_free(priv->history);
-  }
+  zathura_history_store_free(priv->history);
 
   /* input history */
   g_free(priv->input_history_path);
@@ -329,10 +344,9 @@ plain_add_bookmark(zathura_database_t* db, const char* file,
 
   char* name = prepare_filename(file);
   g_key_file_set_integer(priv->bookmarks, name, bookmark->id, bookmark->page);
+  plain_changed(db, priv->bookmarks_changed, name);
   g_free(name);
 
-  zathura_db_write_key_file_to_file(priv->bookmark_path, priv->bookmarks);
-
   return true;
 }
 
@@ -349,7 +363,7 @@ plain_remove_bookmark(zathura_database_t* db, const char* file, const char*
   if (g_key_file_has_group(priv->bookmarks, name) == TRUE) {
     g_key_file_remove_group(priv->bookmarks, name, NULL);
 
-    zathura_db_write_key_file_to_file(priv->bookmark_path, priv->bookmarks);
+    plain_changed(db, priv->bookmarks_changed, name);
     g_free(name);
 
     return true;
@@ -410,29 +424,11 @@ plain_set_fileinfo(zathura_database_t* db, const char* file, zathura_fileinfo_t*
   }
 
   char* name = prepare_filename(file);
-
-  g_key_file_set_integer(priv->history, name, KEY_PAGE,   file_info->current_page);
-  g_key_file_set_integer(priv->history, name, KEY_OFFSET, file_info->page_offset);
-
-  char* tmp = g_strdup_printf("%f", file_info->scale);
-  g_key_file_set_string (priv->history, name, KEY_SCALE, tmp);
-  g_free(tmp);
-
-  g_key_file_set_integer(priv->history, name, KEY_ROTATE,            file_info->rotation);
-  g_key_file_set_integer(priv->history, name, KEY_PAGES_PER_ROW,     file_info->pages_per_row);
-  g_key_file_set_integer(priv->history, name, KEY_FIRST_PAGE_COLUMN, file_info->first_page_column);
-
-  tmp = g_strdup_printf("%f", file_info->position_x);
-  g_key_file_set_string(priv->history,  name, KEY_POSITION_X, tmp);
-  g_free(tmp);
-
-  tmp = g_strdup_printf("%f", file_info->position_y);
-  g_key_file_set_string(priv->history,  name, KEY_POSITION_Y, tmp);
-  g_free(tmp);
-
+  zathura_history_store_set(priv->history, name, file_info,
+      g_get_real_time() / G_USEC_PER_SEC);
   g_free(name);
 
-  zathura_db_write_key_file_to_file(priv->history_path, priv->history);
+  plain_schedule_flush(db);
 
   return true;
 }
@@ -451,38 +447,19 @@ plain_get_fileinfo(zathura_database_t* db, const char* file, zathura_fileinfo_t*
   }
 
   char* name = prepare_filename(file);
-  if (g_key_file_has_group(priv->history, name) == FALSE) {
-    g_free(name);
-    return false;
-  }
-
-  file_info->current_page      = g_key_file_get_integer(priv->history, name, KEY_PAGE, NULL);
-  file_info->page_offset       = g_key_file_get_integer(priv->history, name, KEY_OFFSET, NULL);
-  file_info->rotation          = g_key_file_get_integer(priv->history, name, KEY_ROTATE, NULL);
-  file_info->pages_per_row     = g_key_file_get_integer(priv->history, name, KEY_PAGES_PER_ROW, NULL);
-  file_info->first_page_column = g_key_file_get_integer(priv->history, name, KEY_FIRST_PAGE_COLUMN, NULL);
-
-  char* scale_string = g_key_file_get_string(priv->history, name, KEY_SCALE, NULL);
-  if (scale_string != NULL) {
-    file_info->scale  = strtod(scale_string, NULL);
-    g_free(scale_string);
-  }
-
-  char* position_x_string = g_key_file_get_string(priv->history, name, KEY_POSITION_X, NULL);
-  if (position_x_string != NULL) {
-    file_info->position_x = strtod(position_x_string, NULL);
-    g_free(position_x_string);
-  }
+  const bool found = zathura_history_store_get(priv->history, name, file_info);
+  g_free(name);
 
-  char* position_y_string = g_key_file_get_string(priv->history, name, KEY_POSITION_Y, NULL);
-  if (position_y_string != NULL) {
-    file_info->position_y = strtod(position_y_string, NULL);
-    g_free(position_y_string);
-  }
+  return found;
+}
 
-  g_free(name);
+void
+zathura_plaindatabase_set_history_limit(zathura_database_t* db, unsigned int limit)
+{
+  g_return_if_fail(ZATHURA_IS_PLAINDATABASE(db));
+  zathura_plaindatabase_private_t* priv = ZATHURA_PLAINDATABASE_GET_PRIVATE(db);
 
-  return true;
+  zathura_history_store_set_limit(priv->history, limit);
 }
 
 static bool
@@ -506,8 +483,8 @@ zathura_db_check_file(const char* path)
   return true;
 }
 
-static GKeyFile*
-zathura_db_read_key_file_from_file(const char* path)
+static char*
+zathura_db_read_file(const char* path)
 {
   if (path == NULL) {
     return NULL;
@@ -519,19 +496,55 @@ zathura_db_read_key_file_from_file(const char* path)
     return NULL;
   }
 
-  GKeyFile* key_file = g_key_file_new();
-  if (key_file == NULL) {
-    fclose(file);
-    return NULL;
-  }
-
   /* read config file */
   file_lock_set(fileno(file), F_WRLCK);
   char* content = girara_file_read2(file);
   file_lock_set(fileno(file), F_UNLCK);
   fclose(file);
+
+  return content;
+}
+
+/* the content is written to a temporary file that replaces the file, so
+ * readers see either the old or the new content */
+static bool
+zathura_db_write_file(const char* path, const char* content, gsize length)
+{
+  GError* error = NULL;
+  if (g_file_set_contents(path, content, length, &error) == FALSE) {
+    girara_error("Failed to write to %s: %s", path, error->message);
+    g_error_free(error);
+    return false;
+  }
+
+  return true;
+}
+
+static bool
+zathura_db_read_history(const char* path, zathura_history_store_t* history)
+{
+  char* content = zathura_db_read_file(path);
+  if (content == NULL) {
+    return false;
+  }
+
+  zathura_history_store_load(history, content);
+  free(content);
+
+  return true;
+}
+
+static GKeyFile*
+zathura_db_read_key_file_from_file(const char* path)
+{
+  char* content = zathura_db_read_file(path);
   if (content == NULL) {
-    g_key_file_free(key_file);
+    return NULL;
+  }
+
+  GKeyFile* key_file = g_key_file_new();
+  if (key_file == NULL) {
+    free(content);
     return NULL;
   }
 
@@ -573,27 +586,98 @@ zathura_db_write_key_file_to_file(const char* file, GKeyFile* key_file)
     return;
   }
 
-  gchar* content = g_key_file_to_data(key_file, NULL, NULL);
+  gsize length = 0;
+  gchar* content = g_key_file_to_data(key_file, &length, NULL);
   if (content == NULL) {
     return;
   }
 
-  /* open file */
-  int fd = open(file, O_RDWR);
-  if (fd == -1) {
-    g_free(content);
-    return;
+  zathura_db_write_file(file, content, length);
+  g_free(content);
+}
+
+/* copies the groups with pending changes from one key file to another */
+static void
+zathura_db_merge_pending(GKeyFile* pending, GKeyFile* key_file, GHashTable* groups)
+{
+  GHashTableIter iter;
+  gpointer group = NULL;
+  g_hash_table_iter_init(&iter, groups);
+  while (g_hash_table_iter_next(&iter, &group, NULL) == TRUE) {
+    g_key_file_remove_group(key_file, group, NULL);
+    if (g_key_file_has_group(pending, group) == FALSE) {
+      continue;
+    }
+
+    gsize length = 0;
+    char** keys = g_key_file_get_keys(pending, group, &length, NULL);
+    for (gsize i = 0; i < length; i++) {
+      char* value = g_key_file_get_value(pending, group, keys[i], NULL);
+      if (value != NULL) {
+        g_key_file_set_value(key_file, group, keys[i], value);
+      }
+      g_free(value);
+    }
+    g_strfreev(keys);
   }
+}
+
+static gboolean
+cb_plain_flush(gpointer data)
+{
+  zathura_database_t* db = data;
+  zathura_plaindatabase_private_t* priv = ZATHURA_PLAINDATABASE_GET_PRIVATE(db);
+
+  priv->flush_source = 0;
+  plain_flush(db);
+
+  return FALSE;
+}
 
-  file_lock_set(fd, F_WRLCK);
-  if (write(fd, content, strlen(content)) == 0) {
-    girara_error("Failed to write to %s", file);
+/* changes are batched and written after a short delay instead of rewriting
+ * the file for every change */
+static void
+plain_schedule_flush(zathura_database_t* db)
+{
+  zathura_plaindatabase_private_t* priv = ZATHURA_PLAINDATABASE_GET_PRIVATE(db);
+
+  if (priv->flush_source == 0) {
+    priv->flush_source = g_timeout_add_seconds(FLUSH_DELAY, cb_plain_flush, db);
   }
-  file_lock_set(fd, F_UNLCK);
+}
 
-  close(fd);
+/* remembers a changed group */
+static void
+plain_changed(zathura_database_t* db, GHashTable* groups, const char* name)
+{
+  g_hash_table_add(groups, g_strdup(name));
+  plain_schedule_flush(db);
+}
 
-  g_free(content);
+static void
+plain_flush(zathura_database_t* db)
+{
+  zathura_plaindatabase_private_t* priv = ZATHURA_PLAINDATABASE_GET_PRIVATE(db);
+
+  if (priv->flush_source != 0) {
+    g_source_remove(priv->flush_source);
+    priv->flush_source = 0;
+  }
+
+  if (g_hash_table_size(priv->bookmarks_changed) != 0) {
+    zathura_db_write_key_file_to_file(priv->bookmark_path, priv->bookmarks);
+    g_hash_table_remove_all(priv->bookmarks_changed);
+  }
+
+  if (zathura_history_store_is_dirty(priv->history) == true) {
+    gsize length = 0;
+    char* content = zathura_history_store_to_data(priv->history, &length);
+    /* the entries are written again with the next flush if this one failed */
+    if (zathura_db_write_file(priv->history_path, content, length) == true) {
+      zathura_history_store_mark_written(priv->history);
+    }
+    g_free(content);
+  }
 }
 
 static void
@@ -609,24 +693,105 @@ cb_zathura_db_watch_file(GFileMonitor* UNUSED(monitor), GFile* file, GFile* UNUS
     return;
   }
 
+  /* changes that have not been written yet are kept */
   zathura_plaindatabase_private_t* priv = ZATHURA_PLAINDATABASE_GET_PRIVATE(database);
   if (priv->bookmark_path && strcmp(priv->bookmark_path, path) == 0) {
+    GKeyFile* bookmarks = zathura_db_read_key_file_from_file(priv->bookmark_path);
     if (priv->bookmarks != NULL) {
+      if (bookmarks != NULL) {
+        zathura_db_merge_pending(priv->bookmarks, bookmarks, priv->bookmarks_changed);
+      }
       g_key_file_free(priv->bookmarks);
     }
 
-    priv->bookmarks = zathura_db_read_key_file_from_file(priv->bookmark_path);
+    priv->bookmarks = bookmarks;
   } else if (priv->history_path && strcmp(priv->history_path, path) == 0) {
+    /* only entries that have changed are parsed again */
     if (priv->history != NULL) {
-      g_key_file_free(priv->history);
+      zathura_db_read_history(priv->history_path, priv->history);
     }
-
-    priv->history = zathura_db_read_key_file_from_file(priv->history_path);
   }
 
   g_free(path);
 }
 
+/* returns the valid lines of the input history; lines that occur more than
+ * once are only kept at their last position */
+static girara_list_t*
+plain_io_compact(const char* content, unsigned int* redundant)
+{
+  girara_list_t* res = girara_list_new2(g_free);
+  if (redundant != NULL) {
+    *redundant = 0;
+  }
+  if (content == NULL) {
+    return res;
+  }
+
+  char** tmp = g_strsplit(content, "\n", 0);
+  GHashTable* seen = g_hash_table_new(g_str_hash, g_str_equal);
+  GPtrArray* lines = g_ptr_array_new();
+  const guint length = g_strv_length(tmp);
+  for (guint i = length; i > 0; --i) {
+    char* line = tmp[i - 1];
+    if (strlen(line) == 0 || strchr(":/", line[0]) == NULL) {
+      continue;
+    }
+    if (g_hash_table_contains(seen, line) == TRUE) {
+      if (redundant != NULL) {
+        ++*redundant;
+      }
+      continue;
+    }
+    g_hash_table_add(seen, line);
+    g_ptr_array_add(lines, line);
+  }
+
+  for (guint i = lines->len; i > 0; --i) {
+    girara_list_append(res, g_strdup(g_ptr_array_index(lines, i - 1)));
+  }
+
+  g_ptr_array_free(lines, TRUE);
+  g_hash_table_destroy(seen);
+  g_strfreev(tmp);
+
+  return res;
+}
+
+/* writes the input history without the lines that occur more than once; the
+ * file is rewritten in place, since other instances append to it through the
+ * same inode */
+static void
+plain_io_rewrite(const char* path)
+{
+  FILE* file = fopen(path, "r+");
+  if (file == NULL) {
+    return;
+  }
+
+  /* locked like for appending, while the file is rewritten */
+  file_lock_set(fileno(file), F_WRLCK);
+  char* content = girara_file_read2(file);
+  girara_list_t* lines = plain_io_compact(content, NULL);
+  free(content);
+
+  GString* compacted = g_string_new(NULL);
+  GIRARA_LIST_FOREACH(lines, const char*, iter, line)
+  g_string_append_printf(compacted, "%s\n", line);
+  GIRARA_LIST_FOREACH_END(lines, const char*, iter, line);
+  girara_list_free(lines);
+
+  rewind(file);
+  if (fwrite(compacted->str, 1, compacted->len, file) != compacted->len ||
+      fflush(file) != 0 || ftruncate(fileno(file), compacted->len) != 0) {
+    girara_error("Failed to write to %s", path);
+  }
+  g_string_free(compacted, TRUE);
+
+  file_lock_set(fileno(file), F_UNLCK);
+  fclose(file);
+}
+
 static girara_list_t*
 plain_io_read(GiraraInputHistoryIO* db)
 {
@@ -644,17 +809,15 @@ plain_io_read(GiraraInputHistoryIO* db)
   file_lock_set(fileno(file), F_UNLCK);
   fclose(file);
 
-  girara_list_t* res = girara_list_new2(g_free);
-  char** tmp = g_strsplit(content, "\n", 0);
-  for (size_t i = 0; tmp[i] != NULL; ++i) {
-    if (strlen(tmp[i]) == 0 || strchr(":/", tmp[i][0]) == NULL) {
-      continue;
-    }
-    girara_list_append(res, g_strdup(tmp[i]));
-  }
-  g_strfreev(tmp);
+  unsigned int redundant = 0;
+  girara_list_t* res = plain_io_compact(content, &redundant);
   free(content);
 
+  /* lines are only appended, so the file is compacted once in a while */
+  if (redundant >= INPUT_HISTORY_COMPACT_INTERVAL) {
+    plain_io_rewrite(priv->input_history_path);
+  }
+
   return res;
 }
 
@@ -666,36 +829,21 @@ plain_io_append(GiraraInputHistoryIO* db, const char* input)
   zathura_plaindatabase_private_t* priv = ZATHURA_PLAINDATABASE_GET_PRIVATE(db);
 
   /* open file */
-  FILE* file = fopen(priv->input_history_path, "r+");
+  FILE* file = fopen(priv->input_history_path, "a");
   if (file == NULL) {
     return;
   }
 
-  /* read input history file */
+  /* earlier occurrences of the line are dropped when the history is read or
+   * compacted */
   file_lock_set(fileno(file), F_WRLCK);
-  char* content = girara_file_read2(file);
-
-  rewind(file);
-  if (ftruncate(fileno(file), 0) != 0) {
-    free(content);
-    file_lock_set(fileno(file), F_UNLCK);
-    fclose(file);
-    return;
-  }
-
-  char** tmp = g_strsplit(content, "\n", 0);
-  free(content);
-
-  /* write input history file */
-  for (size_t i = 0; tmp[i] != NULL; ++i) {
-    if (strlen(tmp[i]) == 0 || strchr(":/", tmp[i][0]) == NULL || strcmp(tmp[i], input) == 0) {
-      continue;
-    }
-    fprintf(file, "%s\n", tmp[i]);
-  }
-  g_strfreev(tmp);
   fprintf(file, "%s\n", input);
-
+  fflush(file);
   file_lock_set(fileno(file), F_UNLCK);
   fclose(file);
+
+  if (++priv->input_history_appended >= INPUT_HISTORY_COMPACT_INTERVAL) {
+    priv->input_history_appended = 0;
+    plain_io_rewrite(priv->input_history_path);
+  }
 }
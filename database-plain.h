@@ -40,4 +40,18 @@ GType zathura_plaindatabase_get_type(void);
  */
 zathura_database_t* zathura_plaindatabase_new(const char* dir);
 
+/**
+ * Default number of documents whose file information is remembered
+ */
+#define ZATHURA_PLAINDATABASE_HISTORY_LIMIT 10000
+
+/**
+ * Sets the maximum number of documents whose file information is remembered.
+ * The least recently closed documents are forgotten first.
+ *
+ * @param db The database instance
+ * @param limit Maximum number of documents (0 for no limit)
+ */
+void zathura_plaindatabase_set_history_limit(zathura_database_t* db, unsigned int limit);
+
 #endif
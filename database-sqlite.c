@@ -30,9 +30,47 @@ static void sqlite_set_property(GObject* object, guint prop_id,
                                 const GValue* value, GParamSpec* pspec);
 static void sqlite_io_append(GiraraInputHistoryIO* db, const char*);
 static girara_list_t* sqlite_io_read(GiraraInputHistoryIO* db);
+static void sqlite_begin_transaction(zathura_database_t* db);
+static void sqlite_end_transaction(zathura_database_t* db);
+
+/**
+ * Statements that are prepared once and kept for the lifetime of the session
+ */
+typedef enum statement_e {
+  STATEMENT_BOOKMARK_ADD,
+  STATEMENT_BOOKMARK_REMOVE,
+  STATEMENT_BOOKMARK_SELECT,
+  STATEMENT_FILEINFO_SET,
+  STATEMENT_FILEINFO_GET,
+  STATEMENT_HISTORY_SET,
+  STATEMENT_HISTORY_GET,
+  STATEMENT_N
+} statement_t;
+
+static const char* const SQL_STATEMENTS[STATEMENT_N] = {
+  [STATEMENT_BOOKMARK_ADD] =
+    "REPLACE INTO bookmarks (file, id, page) VALUES (?, ?, ?);",
+  [STATEMENT_BOOKMARK_REMOVE] =
+    "DELETE FROM bookmarks WHERE file = ? AND id = ?;",
+  [STATEMENT_BOOKMARK_SELECT] =
+    "SELECT id, page FROM bookmarks WHERE file = ?;",
+  [STATEMENT_FILEINFO_SET] =
+    "REPLACE INTO fileinfo (file, page, offset, scale, rotation, pages_per_row, first_page_column, position_x, position_y) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);",
+  [STATEMENT_FILEINFO_GET] =
+    "SELECT page, offset, scale, rotation, pages_per_row, first_page_column, position_x, position_y FROM fileinfo WHERE file = ?;",
+  [STATEMENT_HISTORY_SET] =
+    "REPLACE INTO history (line, time) VALUES (?, DATETIME('now'));",
+  [STATEMENT_HISTORY_GET] =
+    "SELECT line FROM history ORDER BY time",
+};
+
+/* milliseconds to wait for another instance that is writing */
+#define BUSY_TIMEOUT 1000
 
 typedef struct zathura_sqldatabase_private_s {
   sqlite3* session;
+  sqlite3_stmt* statements[STATEMENT_N]; /**< Prepared statements (NULL if not prepared yet) */
+  unsigned int transaction; /**< Depth of nested transactions */
 } zathura_sqldatabase_private_t;
 
 #define ZATHURA_SQLDATABASE_GET_PRIVATE(obj) \
@@ -52,6 +90,8 @@ zathura_database_interface_init(ZathuraDatabaseInterface* iface)
   iface->load_bookmarks  = sqlite_load_bookmarks;
   iface->set_fileinfo    = sqlite_set_fileinfo;
   iface->get_fileinfo    = sqlite_get_fileinfo;
+  iface->begin_transaction = sqlite_begin_transaction;
+  iface->end_transaction   = sqlite_end_transaction;
 }
 
 static void
@@ -83,6 +123,10 @@ zathura_sqldatabase_init(ZathuraSQLDatabase* db)
 {
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
   priv->session = NULL;
+  for (unsigned int i = 0; i < STATEMENT_N; i++) {
+    priv->statements[i] = NULL;
+  }
+  priv->transaction = 0;
 }
 
 zathura_database_t*
@@ -106,6 +150,12 @@ sqlite_finalize(GObject* object)
   ZathuraSQLDatabase* db = ZATHURA_SQLDATABASE(object);
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
   if (priv->session) {
+    if (priv->transaction != 0) {
+      sqlite3_exec(priv->session, "COMMIT;", NULL, 0, NULL);
+    }
+    for (unsigned int i = 0; i < STATEMENT_N; i++) {
+      sqlite3_finalize(priv->statements[i]);
+    }
     sqlite3_close(priv->session);
   }
 
@@ -152,12 +202,24 @@ sqlite_db_init(ZathuraSQLDatabase* db, const char* path)
     "line TEXT,"
     "PRIMARY KEY(line));";
 
+  /* the write-ahead log needs fewer syncs than the rollback journal;
+   * committed transactions survive crashes of zathura, but might be lost on
+   * a power failure */
+  static const char SQL_PRAGMAS[] =
+    "PRAGMA journal_mode = WAL;"
+    "PRAGMA synchronous = NORMAL;";
+
   sqlite3* session = NULL;
   if (sqlite3_open(path, &session) != SQLITE_OK) {
     girara_error("Could not open database: %s\n", path);
     return;
   }
 
+  sqlite3_busy_timeout(session, BUSY_TIMEOUT);
+  if (sqlite3_exec(session, SQL_PRAGMAS, NULL, 0, NULL) != SQLITE_OK) {
+    girara_warning("Failed to enable the write-ahead log: %s", sqlite3_errmsg(session));
+  }
+
   if (sqlite3_exec(session, SQL_BOOKMARK_INIT, NULL, 0, NULL) != SQLITE_OK) {
     girara_error("Failed to initialize database: %s\n", path);
     sqlite3_close(session);
@@ -234,16 +296,62 @@ prepare_statement(sqlite3* session, const char* statement)
   return pp_stmt;
 }
 
+/* returns the cached statement, which is prepared on first use */
+static sqlite3_stmt*
+get_statement(zathura_sqldatabase_private_t* priv, statement_t statement)
+{
+  if (priv->statements[statement] == NULL) {
+    priv->statements[statement] = prepare_statement(priv->session, SQL_STATEMENTS[statement]);
+  }
+
+  return priv->statements[statement];
+}
+
+/* resets the statement for the next use; the bound values might not be valid
+ * anymore */
+static void
+release_statement(sqlite3_stmt* stmt)
+{
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+}
+
+static void
+sqlite_begin_transaction(zathura_database_t* db)
+{
+  zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
+  if (priv->session == NULL) {
+    return;
+  }
+
+  if (priv->transaction++ == 0 &&
+      sqlite3_exec(priv->session, "BEGIN IMMEDIATE;", NULL, 0, NULL) != SQLITE_OK) {
+    girara_warning("Failed to begin transaction: %s", sqlite3_errmsg(priv->session));
+  }
+}
+
+static void
+sqlite_end_transaction(zathura_database_t* db)
+{
+  zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
+  if (priv->session == NULL || priv->transaction == 0) {
+    return;
+  }
+
+  if (--priv->transaction == 0 && sqlite3_get_autocommit(priv->session) == 0 &&
+      sqlite3_exec(priv->session, "COMMIT;", NULL, 0, NULL) != SQLITE_OK) {
+    girara_error("Failed to commit transaction: %s", sqlite3_errmsg(priv->session));
+    sqlite3_exec(priv->session, "ROLLBACK;", NULL, 0, NULL);
+  }
+}
+
 static bool
 sqlite_add_bookmark(zathura_database_t* db, const char* file,
                     zathura_bookmark_t* bookmark)
 {
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
 
-  static const char SQL_BOOKMARK_ADD[] =
-    "REPLACE INTO bookmarks (file, id, page) VALUES (?, ?, ?);";
-
-  sqlite3_stmt* stmt = prepare_statement(priv->session, SQL_BOOKMARK_ADD);
+  sqlite3_stmt* stmt = get_statement(priv, STATEMENT_BOOKMARK_ADD);
   if (stmt == NULL) {
     return false;
   }
@@ -251,13 +359,13 @@ sqlite_add_bookmark(zathura_database_t* db, const char* file,
   if (sqlite3_bind_text(stmt, 1, file, -1, NULL) != SQLITE_OK ||
       sqlite3_bind_text(stmt, 2, bookmark->id, -1, NULL) != SQLITE_OK ||
       sqlite3_bind_int(stmt, 3, bookmark->page) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     girara_error("Failed to bind arguments.");
     return false;
   }
 
   int res = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  release_statement(stmt);
 
   return (res == SQLITE_DONE) ? true : false;
 }
@@ -268,23 +376,20 @@ sqlite_remove_bookmark(zathura_database_t* db, const char* file, const char*
 {
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
 
-  static const char SQL_BOOKMARK_ADD[] =
-    "DELETE FROM bookmarks WHERE file = ? AND id = ?;";
-
-  sqlite3_stmt* stmt = prepare_statement(priv->session, SQL_BOOKMARK_ADD);
+  sqlite3_stmt* stmt = get_statement(priv, STATEMENT_BOOKMARK_REMOVE);
   if (stmt == NULL) {
     return false;
   }
 
   if (sqlite3_bind_text(stmt, 1, file, -1, NULL) != SQLITE_OK ||
       sqlite3_bind_text(stmt, 2, id, -1, NULL) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     girara_error("Failed to bind arguments.");
     return false;
   }
 
   int res = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  release_statement(stmt);
 
   return (res == SQLITE_DONE) ? true : false;
 }
@@ -294,16 +399,13 @@ sqlite_load_bookmarks(zathura_database_t* db, const char* file)
 {
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
 
-  static const char SQL_BOOKMARK_SELECT[] =
-    "SELECT id, page FROM bookmarks WHERE file = ?;";
-
-  sqlite3_stmt* stmt = prepare_statement(priv->session, SQL_BOOKMARK_SELECT);
+  sqlite3_stmt* stmt = get_statement(priv, STATEMENT_BOOKMARK_SELECT);
   if (stmt == NULL) {
     return NULL;
   }
 
   if (sqlite3_bind_text(stmt, 1, file, -1, NULL) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     girara_error("Failed to bind arguments.");
     return NULL;
   }
@@ -320,7 +422,7 @@ sqlite_load_bookmarks(zathura_database_t* db, const char* file)
     girara_list_append(result, bookmark);
   }
 
-  sqlite3_finalize(stmt);
+  release_statement(stmt);
 
   return result;
 }
@@ -335,10 +437,7 @@ sqlite_set_fileinfo(zathura_database_t* db, const char* file,
 
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
 
-  static const char SQL_FILEINFO_SET[] =
-    "REPLACE INTO fileinfo (file, page, offset, scale, rotation, pages_per_row, first_page_column, position_x, position_y) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);";
-
-  sqlite3_stmt* stmt = prepare_statement(priv->session, SQL_FILEINFO_SET);
+  sqlite3_stmt* stmt = get_statement(priv, STATEMENT_FILEINFO_SET);
   if (stmt == NULL) {
     return false;
   }
@@ -352,13 +451,13 @@ sqlite_set_fileinfo(zathura_database_t* db, const char* file,
       sqlite3_bind_int(stmt,    7, file_info->first_page_column) != SQLITE_OK ||
       sqlite3_bind_double(stmt, 8, file_info->position_x)        != SQLITE_OK ||
       sqlite3_bind_double(stmt, 9, file_info->position_y)        != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     girara_error("Failed to bind arguments.");
     return false;
   }
 
   int res = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  release_statement(stmt);
 
   return (res == SQLITE_DONE) ? true : false;
 }
@@ -373,22 +472,19 @@ sqlite_get_fileinfo(zathura_database_t* db, const char* file,
 
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
 
-  static const char SQL_FILEINFO_GET[] =
-    "SELECT page, offset, scale, rotation, pages_per_row, first_page_column, position_x, position_y FROM fileinfo WHERE file = ?;";
-
-  sqlite3_stmt* stmt = prepare_statement(priv->session, SQL_FILEINFO_GET);
+  sqlite3_stmt* stmt = get_statement(priv, STATEMENT_FILEINFO_GET);
   if (stmt == NULL) {
     return false;
   }
 
   if (sqlite3_bind_text(stmt, 1, file, -1, NULL) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     girara_error("Failed to bind arguments.");
     return false;
   }
 
   if (sqlite3_step(stmt) != SQLITE_ROW) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     girara_info("No info for file %s available.", file);
     return false;
   }
@@ -402,7 +498,7 @@ sqlite_get_fileinfo(zathura_database_t* db, const char* file,
   file_info->position_x        = sqlite3_column_double(stmt, 6);
   file_info->position_y        = sqlite3_column_double(stmt, 7);
 
-  sqlite3_finalize(stmt);
+  release_statement(stmt);
 
   return true;
 }
@@ -410,40 +506,34 @@ sqlite_get_fileinfo(zathura_database_t* db, const char* file,
 static void
 sqlite_io_append(GiraraInputHistoryIO* db, const char* input)
 {
-  static const char SQL_HISTORY_SET[] =
-    "REPLACE INTO history (line, time) VALUES (?, DATETIME('now'));";
-
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
-  sqlite3_stmt* stmt = prepare_statement(priv->session, SQL_HISTORY_SET);
+  sqlite3_stmt* stmt = get_statement(priv, STATEMENT_HISTORY_SET);
   if (stmt == NULL) {
     return;
   }
 
   if (sqlite3_bind_text(stmt, 1, input, -1, NULL) != SQLITE_OK) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     girara_error("Failed to bind arguments.");
     return;
   }
 
   sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  release_statement(stmt);
 }
 
 static girara_list_t*
 sqlite_io_read(GiraraInputHistoryIO* db)
 {
-  static const char SQL_HISTORY_GET[] =
-    "SELECT line FROM history ORDER BY time";
-
   zathura_sqldatabase_private_t* priv = ZATHURA_SQLDATABASE_GET_PRIVATE(db);
-  sqlite3_stmt* stmt = prepare_statement(priv->session, SQL_HISTORY_GET);
+  sqlite3_stmt* stmt = get_statement(priv, STATEMENT_HISTORY_GET);
   if (stmt == NULL) {
     return NULL;
   }
 
   girara_list_t* list = girara_list_new2((girara_free_function_t) g_free);
   if (list == NULL) {
-    sqlite3_finalize(stmt);
+    release_statement(stmt);
     return NULL;
   }
 
@@ -451,6 +541,6 @@ sqlite_io_read(GiraraInputHistoryIO* db)
     girara_list_append(list, g_strdup((const char*) sqlite3_column_text(stmt, 0)));
   }
 
-  sqlite3_finalize(stmt);
+  release_statement(stmt);
   return list;
 }
@@ -52,3 +52,25 @@ zathura_db_get_fileinfo(zathura_database_t* db, const char* file,
 
   return ZATHURA_DATABASE_GET_INTERFACE(db)->get_fileinfo(db, file, file_info);
 }
+
+void
+zathura_db_begin_transaction(zathura_database_t* db)
+{
+  g_return_if_fail(ZATHURA_IS_DATABASE(db));
+
+  ZathuraDatabaseInterface* iface = ZATHURA_DATABASE_GET_INTERFACE(db);
+  if (iface->begin_transaction != NULL) {
+    iface->begin_transaction(db);
+  }
+}
+
+void
+zathura_db_end_transaction(zathura_database_t* db)
+{
+  g_return_if_fail(ZATHURA_IS_DATABASE(db));
+
+  ZathuraDatabaseInterface* iface = ZATHURA_DATABASE_GET_INTERFACE(db);
+  if (iface->end_transaction != NULL) {
+    iface->end_transaction(db);
+  }
+}
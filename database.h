@@ -46,6 +46,11 @@ struct _ZathuraDatabaseInterface
   bool (*set_fileinfo)(ZathuraDatabase* db, const char* file, zathura_fileinfo_t* file_info);
 
   bool (*get_fileinfo)(ZathuraDatabase* db, const char* file, zathura_fileinfo_t* file_info);
+
+  /* optional */
+  void (*begin_transaction)(ZathuraDatabase* db);
+
+  void (*end_transaction)(ZathuraDatabase* db);
 };
 
 GType zathura_database_get_type(void);
@@ -103,4 +108,21 @@ bool zathura_db_set_fileinfo(zathura_database_t* db, const char* file,
 bool zathura_db_get_fileinfo(zathura_database_t* db, const char* file,
     zathura_fileinfo_t* file_info);
 
+/**
+ * Start grouping changes, so that they are written together in a single
+ * transaction once zathura_db_end_transaction has been called. Calls can be
+ * nested.
+ *
+ * @param db The database instance
+ */
+void zathura_db_begin_transaction(zathura_database_t* db);
+
+/**
+ * Write the changes made since the matching call of
+ * zathura_db_begin_transaction.
+ *
+ * @param db The database instance
+ */
+void zathura_db_end_transaction(zathura_database_t* db);
+
 #endif // DATABASE_H
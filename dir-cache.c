@@ -0,0 +1,305 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gio/gio.h>
+#include <girara/datastructures.h>
+#include <girara/utils.h>
+
+#include "dir-cache.h"
+#include "internal.h"
+
+/**
+ * An entry of a directory
+ */
+typedef struct dir_entry_s {
+  char* name; /**< Display name of the entry */
+  unsigned int rank; /**< Position of the entry in case insensitive order */
+  gint8 is_dir; /**< The entry is a directory (-1 if it has not been checked yet) */
+  gint8 accepted; /**< Result of the filter (-1 if it has not been called yet) */
+} dir_entry_t;
+
+/**
+ * The entries of a directory
+ */
+typedef struct dir_listing_s {
+  char* path; /**< Path of the directory */
+  dir_entry_t* entries; /**< Entries sorted by name */
+  unsigned int n_entries; /**< Number of entries */
+  GFileMonitor* monitor; /**< Monitor that invalidates the listing (or NULL) */
+  zathura_dir_cache_t* cache; /**< The cache the listing belongs to */
+} dir_listing_t;
+
+struct zathura_dir_cache_s {
+  GHashTable* listings; /**< path -> dir_listing_t */
+  GQueue lru; /**< Listings, most recently used first */
+  unsigned int max_directories; /**< Number of directories that are kept */
+  zathura_dir_cache_filter_t filter; /**< Decides whether a file is listed */
+  void* data; /**< Custom data of the filter */
+};
+
+static void
+dir_listing_free(void* data)
+{
+  dir_listing_t* listing = data;
+  if (listing == NULL) {
+    return;
+  }
+
+  if (listing->monitor != NULL) {
+    g_signal_handlers_disconnect_matched(listing->monitor, G_SIGNAL_MATCH_DATA,
+        0, 0, NULL, NULL, listing);
+    g_file_monitor_cancel(listing->monitor);
+    g_object_unref(listing->monitor);
+  }
+
+  for (unsigned int i = 0; i < listing->n_entries; i++) {
+    g_free(listing->entries[i].name);
+  }
+  g_free(listing->entries);
+  g_free(listing->path);
+  g_free(listing);
+}
+
+static void
+cb_dir_listing_changed(GFileMonitor* UNUSED(monitor), GFile* UNUSED(file),
+    GFile* UNUSED(other_file), GFileMonitorEvent event, gpointer data)
+{
+  dir_listing_t* listing = data;
+
+  if (event == G_FILE_MONITOR_EVENT_CREATED || event == G_FILE_MONITOR_EVENT_DELETED ||
+      event == G_FILE_MONITOR_EVENT_MOVED || event == G_FILE_MONITOR_EVENT_ATTRIBUTE_CHANGED) {
+    zathura_dir_cache_invalidate(listing->cache, listing->path);
+  }
+}
+
+static int
+compare_entry_names(const void* a, const void* b)
+{
+  const dir_entry_t* entry_a = a;
+  const dir_entry_t* entry_b = b;
+
+  return strcmp(entry_a->name, entry_b->name);
+}
+
+typedef struct dir_sort_key_s {
+  char* key; /**< Collation key of the casefolded name */
+  unsigned int index; /**< Index of the entry */
+} dir_sort_key_t;
+
+static int
+compare_sort_keys(const void* a, const void* b)
+{
+  const dir_sort_key_t* key_a = a;
+  const dir_sort_key_t* key_b = b;
+
+  return strcmp(key_a->key, key_b->key);
+}
+
+static int
+compare_entry_ranks(const void* a, const void* b)
+{
+  const dir_entry_t* entry_a = *(dir_entry_t* const*) a;
+  const dir_entry_t* entry_b = *(dir_entry_t* const*) b;
+
+  return (entry_a->rank > entry_b->rank) - (entry_a->rank < entry_b->rank);
+}
+
+static dir_listing_t*
+dir_listing_read(zathura_dir_cache_t* cache, const char* path)
+{
+  GDir* dir = g_dir_open(path, 0, NULL);
+  if (dir == NULL) {
+    return NULL;
+  }
+
+  GArray* entries = g_array_new(FALSE, FALSE, sizeof(dir_entry_t));
+  const char* name = NULL;
+  while ((name = g_dir_read_name(dir)) != NULL) {
+    dir_entry_t entry = { g_filename_display_name(name), 0, -1, -1 };
+    g_array_append_val(entries, entry);
+  }
+  g_dir_close(dir);
+
+  dir_listing_t* listing = g_malloc0(sizeof(dir_listing_t));
+  listing->path      = g_strdup(path);
+  listing->cache     = cache;
+  listing->n_entries = entries->len;
+  listing->entries   = (dir_entry_t*) g_array_free(entries, FALSE);
+
+  qsort(listing->entries, listing->n_entries, sizeof(dir_entry_t), compare_entry_names);
+
+  /* the case insensitive order is computed once instead of collating the
+   * names whenever they are listed */
+  dir_sort_key_t* keys = g_malloc_n(MAX(listing->n_entries, 1), sizeof(dir_sort_key_t));
+  for (unsigned int i = 0; i < listing->n_entries; i++) {
+    char* folded  = g_utf8_casefold(listing->entries[i].name, -1);
+    keys[i].key   = g_utf8_collate_key(folded, -1);
+    keys[i].index = i;
+    g_free(folded);
+  }
+  qsort(keys, listing->n_entries, sizeof(dir_sort_key_t), compare_sort_keys);
+  for (unsigned int i = 0; i < listing->n_entries; i++) {
+    listing->entries[keys[i].index].rank = i;
+    g_free(keys[i].key);
+  }
+  g_free(keys);
+
+  GFile* file = g_file_new_for_path(path);
+  listing->monitor = g_file_monitor_directory(file, G_FILE_MONITOR_NONE, NULL, NULL);
+  g_object_unref(file);
+  if (listing->monitor != NULL) {
+    g_signal_connect(listing->monitor, "changed", G_CALLBACK(cb_dir_listing_changed), listing);
+  }
+
+  girara_debug("read %u entries of '%s'", listing->n_entries, path);
+
+  return listing;
+}
+
+static dir_listing_t*
+dir_cache_get_listing(zathura_dir_cache_t* cache, const char* path)
+{
+  dir_listing_t* listing = g_hash_table_lookup(cache->listings, path);
+  if (listing != NULL) {
+    g_queue_remove(&cache->lru, listing);
+    g_queue_push_head(&cache->lru, listing);
+    return listing;
+  }
+
+  listing = dir_listing_read(cache, path);
+  if (listing == NULL) {
+    return NULL;
+  }
+
+  g_hash_table_insert(cache->listings, listing->path, listing);
+  g_queue_push_head(&cache->lru, listing);
+
+  /* forget the directories that have not been listed for the longest time */
+  while (g_queue_get_length(&cache->lru) > cache->max_directories) {
+    dir_listing_t* oldest = g_queue_pop_tail(&cache->lru);
+    g_hash_table_remove(cache->listings, oldest->path);
+  }
+
+  return listing;
+}
+
+zathura_dir_cache_t*
+zathura_dir_cache_new(unsigned int max_directories,
+    zathura_dir_cache_filter_t filter, void* data)
+{
+  zathura_dir_cache_t* cache = g_malloc0(sizeof(zathura_dir_cache_t));
+  cache->listings        = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, dir_listing_free);
+  cache->max_directories = MAX(max_directories, 1);
+  cache->filter          = filter;
+  cache->data            = data;
+  g_queue_init(&cache->lru);
+
+  return cache;
+}
+
+void
+zathura_dir_cache_free(zathura_dir_cache_t* cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  g_queue_clear(&cache->lru);
+  g_hash_table_destroy(cache->listings);
+  g_free(cache);
+}
+
+girara_list_t*
+zathura_dir_cache_list(zathura_dir_cache_t* cache, const char* path, const char*
+    prefix, bool show_hidden, bool show_directories, bool filter_files)
+{
+  if (cache == NULL || path == NULL || prefix == NULL) {
+    return NULL;
+  }
+
+  dir_listing_t* listing = dir_cache_get_listing(cache, path);
+  if (listing == NULL) {
+    return NULL;
+  }
+
+  /* the first entry that is not smaller than the prefix */
+  unsigned int lower = 0;
+  unsigned int upper = listing->n_entries;
+  while (lower < upper) {
+    const unsigned int middle = lower + (upper - lower) / 2;
+    if (strcmp(listing->entries[middle].name, prefix) < 0) {
+      lower = middle + 1;
+    } else {
+      upper = middle;
+    }
+  }
+
+  const size_t prefix_length = strlen(prefix);
+  GPtrArray* matches = g_ptr_array_new();
+  for (unsigned int i = lower; i < listing->n_entries; i++) {
+    dir_entry_t* entry = &listing->entries[i];
+    if (strncmp(entry->name, prefix, prefix_length) != 0) {
+      break;
+    }
+
+    if (show_hidden == false && entry->name[0] == '.') {
+      continue;
+    }
+
+    /* directories and supported files are only looked at once */
+    char* full_path = NULL;
+    if (entry->is_dir == -1) {
+      full_path = g_build_filename(path, entry->name, NULL);
+      entry->is_dir = g_file_test(full_path, G_FILE_TEST_IS_DIR) == TRUE ? 1 : 0;
+    }
+
+    bool listed = false;
+    if (entry->is_dir == 1) {
+      listed = show_directories;
+    } else if (filter_files == false || cache->filter == NULL) {
+      listed = true;
+    } else {
+      if (entry->accepted == -1) {
+        if (full_path == NULL) {
+          full_path = g_build_filename(path, entry->name, NULL);
+        }
+        entry->accepted = cache->filter(full_path, cache->data) == true ? 1 : 0;
+      }
+      listed = entry->accepted == 1;
+    }
+    g_free(full_path);
+
+    if (listed == true) {
+      g_ptr_array_add(matches, entry);
+    }
+  }
+
+  g_ptr_array_sort(matches, compare_entry_ranks);
+
+  girara_list_t* names = girara_list_new2(g_free);
+  for (unsigned int i = 0; i < matches->len; i++) {
+    const dir_entry_t* entry = g_ptr_array_index(matches, i);
+    girara_list_append(names, g_strdup(entry->name));
+  }
+  g_ptr_array_free(matches, TRUE);
+
+  return names;
+}
+
+void
+zathura_dir_cache_invalidate(zathura_dir_cache_t* cache, const char* path)
+{
+  if (cache == NULL || path == NULL) {
+    return;
+  }
+
+  dir_listing_t* listing = g_hash_table_lookup(cache->listings, path);
+  if (listing == NULL) {
+    return;
+  }
+
+  girara_debug("'%s' has changed", path);
+  g_queue_remove(&cache->lru, listing);
+  g_hash_table_remove(cache->listings, path);
+}
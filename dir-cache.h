@@ -0,0 +1,66 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef DIR_CACHE_H
+#define DIR_CACHE_H
+
+#include <stdbool.h>
+#include <girara/types.h>
+
+typedef struct zathura_dir_cache_s zathura_dir_cache_t;
+
+/**
+ * Decides whether a file is listed
+ *
+ * @param path Path of the file
+ * @param data Custom data
+ * @return true if the file is listed
+ */
+typedef bool (*zathura_dir_cache_filter_t)(const char* path, void* data);
+
+/**
+ * Creates a cache of directory listings. Every directory is read once and
+ * monitored afterwards, so that it is only read again once it has changed.
+ *
+ * @param max_directories Number of directories that are kept
+ * @param filter Function that decides whether a file is listed (or NULL);
+ *   its result is cached with the file
+ * @param data Custom data that is passed to the filter
+ * @return The cache
+ */
+zathura_dir_cache_t* zathura_dir_cache_new(unsigned int max_directories,
+    zathura_dir_cache_filter_t filter, void* data);
+
+/**
+ * Frees the cache
+ *
+ * @param cache The cache
+ */
+void zathura_dir_cache_free(zathura_dir_cache_t* cache);
+
+/**
+ * Lists the entries of a directory whose names start with a prefix. The
+ * entries are found by binary search over the names and are returned in
+ * case insensitive order.
+ *
+ * @param cache The cache
+ * @param path Path of the directory
+ * @param prefix Prefix of the names
+ * @param show_hidden List entries whose names start with a dot
+ * @param show_directories List directories
+ * @param filter_files Only list the files the filter of the cache accepts
+ * @return List of the names (char*) or NULL if the directory cannot be read
+ */
+girara_list_t* zathura_dir_cache_list(zathura_dir_cache_t* cache, const char*
+    path, const char* prefix, bool show_hidden, bool show_directories, bool
+    filter_files);
+
+/**
+ * Forgets the listing of a directory, so that it is read again when it is
+ * needed next time. This happens whenever the directory changes.
+ *
+ * @param cache The cache
+ * @param path Path of the directory
+ */
+void zathura_dir_cache_invalidate(zathura_dir_cache_t* cache, const char* path);
+
+#endif // DIR_CACHE_H
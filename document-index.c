@@ -0,0 +1,274 @@
+/* See LICENSE file for license and copyright information */
+
+#include <glib/gi18n.h>
+#include <girara/datastructures.h>
+#include <girara/utils.h>
+
+#include "glib-compat.h"
+#include "document-index.h"
+#include "document.h"
+#include "links.h"
+#include "render.h"
+#include "shortcuts.h"
+
+/* interval in milliseconds in which the thread is checked */
+#define DOCUMENT_INDEX_CHECK_INTERVAL 100
+
+/**
+ * An index that is generated in the background
+ */
+struct document_index_job_s {
+  zathura_t* zathura; /**< Zathura object */
+  zathura_document_t* document; /**< The document */
+  bool serialize; /**< Plugin requires calls to be serialized */
+  GThread* thread; /**< Thread that generates the index */
+  guint timeout; /**< Source that checks whether the thread has finished */
+  gint64 start; /**< Time the job has been started */
+  girara_tree_node_t* tree; /**< The index once it has been generated */
+  gint done; /**< Set by the thread when it has finished */
+  bool show; /**< Show the index once it has been generated */
+};
+
+/* the model keeps the whole index; the rows only point into it */
+static const char* DOCUMENT_INDEX_DATA = "zathura-document-index";
+
+static void
+document_index_free_elements(girara_tree_node_t* tree)
+{
+  girara_list_t* list = girara_node_get_children(tree);
+  GIRARA_LIST_FOREACH(list, girara_tree_node_t*, iter, node)
+  zathura_index_element_free(girara_node_get_data(node));
+  document_index_free_elements(node);
+  GIRARA_LIST_FOREACH_END(list, girara_tree_node_t*, iter, node);
+}
+
+void
+document_index_free(girara_tree_node_t* tree)
+{
+  if (tree == NULL) {
+    return;
+  }
+
+  document_index_free_elements(tree);
+  girara_node_free(tree);
+}
+
+/* appends the children of the node; entries with children get an empty
+ * placeholder row, so that they can be expanded */
+static void
+document_index_build(GtkTreeStore* store, GtkTreeIter* parent, girara_tree_node_t* tree)
+{
+  girara_list_t* list = girara_node_get_children(tree);
+  GIRARA_LIST_FOREACH(list, girara_tree_node_t*, iter, node)
+  zathura_index_element_t* index_element = girara_node_get_data(node);
+
+  zathura_link_type_t type     = zathura_link_get_type(index_element->link);
+  zathura_link_target_t target = zathura_link_get_target(index_element->link);
+
+  gchar* description = NULL;
+  if (type == ZATHURA_LINK_GOTO_DEST) {
+    description = g_strdup_printf("Page %d", target.page_number + 1);
+  } else {
+    description = g_strdup(target.value);
+  }
+
+  GtkTreeIter tree_iter;
+  gtk_tree_store_append(store, &tree_iter, parent);
+  gtk_tree_store_set(store, &tree_iter,
+      DOCUMENT_INDEX_COLUMN_TITLE, index_element->title,
+      DOCUMENT_INDEX_COLUMN_TARGET, description,
+      DOCUMENT_INDEX_COLUMN_ELEMENT, index_element,
+      DOCUMENT_INDEX_COLUMN_NODE, node, -1);
+  g_free(description);
+
+  if (girara_node_get_num_children(node) > 0) {
+    GtkTreeIter placeholder;
+    gtk_tree_store_append(store, &placeholder, &tree_iter);
+  }
+  GIRARA_LIST_FOREACH_END(list, girara_tree_node_t*, iter, node);
+}
+
+GtkTreeModel*
+document_index_model_new(girara_tree_node_t* tree)
+{
+  if (tree == NULL) {
+    return NULL;
+  }
+
+  GtkTreeStore* store = gtk_tree_store_new(DOCUMENT_INDEX_N_COLUMNS,
+      G_TYPE_STRING, G_TYPE_STRING, G_TYPE_POINTER, G_TYPE_POINTER);
+  if (store == NULL) {
+    document_index_free(tree);
+    return NULL;
+  }
+
+  g_object_set_data_full(G_OBJECT(store), DOCUMENT_INDEX_DATA, tree,
+      (GDestroyNotify) document_index_free);
+  document_index_build(store, NULL, tree);
+
+  return GTK_TREE_MODEL(store);
+}
+
+void
+document_index_expand(GtkTreeModel* model, GtkTreeIter* iter)
+{
+  if (model == NULL || iter == NULL) {
+    return;
+  }
+
+  GtkTreeIter child;
+  if (gtk_tree_model_iter_children(model, &child, iter) == FALSE) {
+    return;
+  }
+
+  /* only the placeholder has no node */
+  girara_tree_node_t* child_node = NULL;
+  gtk_tree_model_get(model, &child, DOCUMENT_INDEX_COLUMN_NODE, &child_node, -1);
+  if (child_node != NULL) {
+    return;
+  }
+
+  girara_tree_node_t* node = NULL;
+  gtk_tree_model_get(model, iter, DOCUMENT_INDEX_COLUMN_NODE, &node, -1);
+  if (node == NULL) {
+    return;
+  }
+
+  GtkTreeStore* store = GTK_TREE_STORE(model);
+  gtk_tree_store_remove(store, &child);
+  document_index_build(store, iter, node);
+}
+
+static gpointer
+document_index_job_run(gpointer data)
+{
+  document_index_job_t* job = data;
+  render_thread_t* render_thread = job->zathura->sync.render_thread;
+
+  if (job->serialize == true) {
+    render_lock(render_thread);
+  }
+  job->tree = zathura_document_index_generate(job->document, NULL);
+  if (job->serialize == true) {
+    render_unlock(render_thread);
+  }
+
+  g_atomic_int_set(&job->done, 1);
+  return NULL;
+}
+
+static void
+document_index_job_free(document_index_job_t* job)
+{
+  if (job->timeout != 0) {
+    g_source_remove(job->timeout);
+  }
+  if (job->thread != NULL) {
+    g_thread_join(job->thread);
+  }
+
+  document_index_free(job->tree);
+  g_free(job);
+}
+
+static gboolean
+document_index_job_check(gpointer data)
+{
+  document_index_job_t* job = data;
+  zathura_t* zathura        = job->zathura;
+
+  if (g_atomic_int_get(&job->done) == 0) {
+    return TRUE;
+  }
+
+  g_thread_join(job->thread);
+  job->thread  = NULL;
+  job->timeout = 0;
+
+  girara_debug("generated the index in the background in %.1f ms",
+               (g_get_monotonic_time() - job->start) / 1000.0);
+
+  /* the index has been asked for in the meantime */
+  if (job->show == true) {
+    job->show = false;
+    sc_toggle_index(zathura->ui.session, NULL, NULL, 0);
+  }
+
+  return FALSE;
+}
+
+void
+document_index_start(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->document == NULL) {
+    return;
+  }
+
+  document_index_cancel(zathura);
+
+  document_index_job_t* job = g_malloc0(sizeof(document_index_job_t));
+  job->zathura   = zathura;
+  job->document  = zathura->document;
+  job->serialize = render_is_serialized(zathura->sync.render_thread);
+  job->start     = g_get_monotonic_time();
+
+  job->thread = thread_new("document-index", document_index_job_run, job);
+  if (job->thread == NULL) {
+    /* the index is generated on demand */
+    g_free(job);
+    return;
+  }
+
+  job->timeout = gdk_threads_add_timeout(DOCUMENT_INDEX_CHECK_INTERVAL,
+      document_index_job_check, job);
+  zathura->sync.index_job = job;
+}
+
+girara_tree_node_t*
+document_index_take(zathura_t* zathura, bool* pending)
+{
+  if (pending != NULL) {
+    *pending = false;
+  }
+
+  if (zathura == NULL || zathura->document == NULL) {
+    return NULL;
+  }
+
+  document_index_job_t* job = zathura->sync.index_job;
+  if (job == NULL) {
+    render_lock(zathura->sync.render_thread);
+    girara_tree_node_t* tree = zathura_document_index_generate(zathura->document, NULL);
+    render_unlock(zathura->sync.render_thread);
+    return tree;
+  }
+
+  if (job->timeout != 0) {
+    if (pending != NULL) {
+      *pending = true;
+    }
+    job->show = true;
+    return NULL;
+  }
+
+  girara_tree_node_t* tree = job->tree;
+  job->tree = NULL;
+  zathura->sync.index_job = NULL;
+  document_index_job_free(job);
+
+  return tree;
+}
+
+void
+document_index_cancel(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->sync.index_job == NULL) {
+    return;
+  }
+
+  document_index_job_t* job = zathura->sync.index_job;
+  zathura->sync.index_job = NULL;
+
+  /* waits for the plugin to finish */
+  document_index_job_free(job);
+}
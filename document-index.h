@@ -0,0 +1,76 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef DOCUMENT_INDEX_H
+#define DOCUMENT_INDEX_H
+
+#include <stdbool.h>
+#include <gtk/gtk.h>
+#include <girara/types.h>
+
+#include "zathura.h"
+
+/**
+ * Columns of the tree model of the index
+ */
+enum {
+  DOCUMENT_INDEX_COLUMN_TITLE, /**< Title of the entry (markup) */
+  DOCUMENT_INDEX_COLUMN_TARGET, /**< Description of the link target */
+  DOCUMENT_INDEX_COLUMN_ELEMENT, /**< The zathura_index_element_t */
+  DOCUMENT_INDEX_COLUMN_NODE, /**< The girara_tree_node_t of the entry */
+  DOCUMENT_INDEX_N_COLUMNS
+};
+
+/**
+ * Creates the tree model of the index. Only the top level of the index is
+ * added; the children of an entry are added by document_index_expand once it
+ * is expanded. The model takes ownership of the index and frees it with all
+ * its elements once it is destroyed.
+ *
+ * @param tree The index as generated by the plugin
+ * @return The tree model
+ */
+GtkTreeModel* document_index_model_new(girara_tree_node_t* tree);
+
+/**
+ * Adds the children of an entry to the tree model if they have not been added
+ * yet.
+ *
+ * @param model The tree model
+ * @param iter The entry
+ */
+void document_index_expand(GtkTreeModel* model, GtkTreeIter* iter);
+
+/**
+ * Frees an index and the index elements of its entries.
+ *
+ * @param tree The index
+ */
+void document_index_free(girara_tree_node_t* tree);
+
+/**
+ * Starts generating the index of the document in the background. Plugins
+ * that are not thread-safe are only called while the render lock is held.
+ *
+ * @param zathura The zathura session
+ */
+void document_index_start(zathura_t* zathura);
+
+/**
+ * Takes the index of the document. If it is still being generated, the index
+ * is shown once it is available.
+ *
+ * @param zathura The zathura session
+ * @param pending Will be set to true if the index is still being generated
+ * @return The index (free with document_index_free) or NULL if the document
+ *   does not have an index or it is still being generated
+ */
+girara_tree_node_t* document_index_take(zathura_t* zathura, bool* pending);
+
+/**
+ * Cancels generating the index and waits for the thread.
+ *
+ * @param zathura The zathura session
+ */
+void document_index_cancel(zathura_t* zathura);
+
+#endif // DOCUMENT_INDEX_H
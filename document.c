@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #ifdef WITH_MAGIC
 #include <magic.h>
 #endif
@@ -31,7 +32,29 @@
 #include "plugin.h"
 
 /** Read a most GT_MAX_READ bytes before falling back to file. */
-static const size_t GT_MAX_READ = 1 << 16;
+#define GT_MAX_READ (1 << 16)
+/** Bytes read to recognize the common formats by their header. */
+#define GT_SNIFF_READ 64
+/** Number of files whose detected type is remembered. */
+#define GT_CACHE_SIZE 64
+
+/**
+ * Detected type of a file
+ */
+typedef struct guess_type_entry_s {
+  gint64 mtime; /**< Modification time of the file */
+  gint64 size; /**< Size of the file */
+  char* content_type; /**< Detected type */
+} guess_type_entry_t;
+
+G_LOCK_DEFINE_STATIC(guess_type_cache);
+static GHashTable* guess_type_cache = NULL;
+
+#ifdef WITH_MAGIC
+G_LOCK_DEFINE_STATIC(magic);
+static magic_t magic_cookie = NULL;
+static bool magic_failed = false;
+#endif
 
 static const gchar* guess_type(const char* path);
 
@@ -64,6 +87,15 @@ struct zathura_document_s {
 zathura_document_t*
 zathura_document_open(zathura_plugin_manager_t* plugin_manager, const char*
                       path, const char* password, zathura_error_t* error)
+{
+  return zathura_document_open_with_progress(plugin_manager, path, password,
+      error, NULL, NULL);
+}
+
+zathura_document_t*
+zathura_document_open_with_progress(zathura_plugin_manager_t* plugin_manager,
+    const char* path, const char* password, zathura_error_t* error,
+    zathura_document_open_progress_t progress, void* data)
 {
   if (path == NULL) {
     return NULL;
@@ -144,13 +176,26 @@ zathura_document_open(zathura_plugin_manager_t* plugin_manager, const char*
     goto error_free;
   }
 
+  /* Only the first page is read now; the other pages start out with its size
+   * and are loaded when they are needed or in the background. */
   for (unsigned int page_id = 0; page_id < document->number_of_pages; page_id++) {
-    zathura_page_t* page = zathura_page_new(document, page_id, NULL);
+    zathura_page_t* page = NULL;
+    if (page_id == 0) {
+      page = zathura_page_new(document, page_id, NULL);
+    } else {
+      page = zathura_page_new_placeholder(document, page_id,
+          zathura_page_get_width(document->pages[0]),
+          zathura_page_get_height(document->pages[0]));
+    }
     if (page == NULL) {
       goto error_free;
     }
 
     document->pages[page_id] = page;
+
+    if (progress != NULL) {
+      progress(page_id + 1, document->number_of_pages, data);
+    }
   }
 
   return document;
@@ -511,48 +556,128 @@ zathura_document_get_information(zathura_document_t* document, zathura_error_t*
   return result;
 }
 
+static bool
+sniff_is_image_name(const char* name, size_t length)
+{
+  static const char* extensions[] = {
+    ".jpg", ".jpeg", ".png", ".gif", ".webp", ".bmp"
+  };
+
+  for (size_t idx = 0; idx < LENGTH(extensions); ++idx) {
+    const size_t extension_length = strlen(extensions[idx]);
+    if (length > extension_length &&
+        g_ascii_strncasecmp(name + length - extension_length, extensions[idx], extension_length) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+const char*
+zathura_document_sniff_type(const void* data, size_t length)
+{
+  if (data == NULL) {
+    return NULL;
+  }
+
+  const char* header = data;
+  if (length >= 5 && memcmp(header, "%PDF-", 5) == 0) {
+    return "application/pdf";
+  } else if (length >= 4 && memcmp(header, "%!PS", 4) == 0) {
+    return "application/postscript";
+  } else if (length >= 15 && memcmp(header, "AT&TFORM", 8) == 0 &&
+      memcmp(header + 12, "DJV", 3) == 0) {
+    return "image/vnd.djvu";
+  } else if (length >= 30 && memcmp(header, "PK\x03\x04", 4) == 0) {
+    /* only archives starting with an image are comic books; EPUB, OOXML, XPS
+     * and the other zip based formats are left to libmagic */
+    const size_t name_length = (unsigned char) header[26] | ((unsigned char) header[27] << 8);
+    if (name_length <= length - 30 && sniff_is_image_name(header + 30, name_length) == true) {
+      return "application/zip";
+    }
+  }
+
+  return NULL;
+}
+
 static const gchar*
-guess_type(const char* path)
+guess_type_sniff(const char* path)
 {
-  const gchar* content_type = NULL;
-#ifdef WITH_MAGIC
-  const char* mime_type = NULL;
+  FILE* f = fopen(path, "rb");
+  if (f == NULL) {
+    return NULL;
+  }
+
+  char header[GT_SNIFF_READ];
+  const size_t length = fread(header, 1, sizeof(header), f);
+  fclose(f);
 
-  /* creat magic cookie */
-  const int flags =
-    MAGIC_MIME_TYPE |
-    MAGIC_SYMLINK |
-    MAGIC_NO_CHECK_APPTYPE |
-    MAGIC_NO_CHECK_CDF |
-    MAGIC_NO_CHECK_ELF |
-    MAGIC_NO_CHECK_ENCODING;
-  magic_t magic = magic_open(flags);
-  if (magic == NULL) {
-    girara_debug("failed creating the magic cookie");
-    goto cleanup;
+  const char* content_type = zathura_document_sniff_type(header, length);
+  if (content_type == NULL) {
+    return NULL;
   }
 
-  /* ... and load mime database */
-  if (magic_load(magic, NULL) < 0) {
-    girara_debug("failed loading the magic database: %s", magic_error(magic));
-    goto cleanup;
+  girara_debug("header detected filetype: %s", content_type);
+  return g_strdup(content_type);
+}
+
+#ifdef WITH_MAGIC
+static const gchar*
+guess_type_magic(const char* path)
+{
+  const gchar* content_type = NULL;
+
+  /* the cookie is created once and kept for the lifetime of the process */
+  G_LOCK(magic);
+  if (magic_cookie == NULL && magic_failed == false) {
+    const int flags =
+      MAGIC_MIME_TYPE |
+      MAGIC_SYMLINK |
+      MAGIC_NO_CHECK_APPTYPE |
+      MAGIC_NO_CHECK_CDF |
+      MAGIC_NO_CHECK_ELF |
+      MAGIC_NO_CHECK_ENCODING;
+    magic_cookie = magic_open(flags);
+    if (magic_cookie == NULL) {
+      girara_debug("failed creating the magic cookie");
+      magic_failed = true;
+    } else if (magic_load(magic_cookie, NULL) < 0) {
+      /* ... and load mime database */
+      girara_debug("failed loading the magic database: %s", magic_error(magic_cookie));
+      magic_close(magic_cookie);
+      magic_cookie = NULL;
+      magic_failed = true;
+    }
   }
 
-  /* get the mime type */
-  mime_type = magic_file(magic, path);
-  if (mime_type == NULL) {
-    girara_debug("failed guessing filetype: %s", magic_error(magic));
-    goto cleanup;
+  if (magic_cookie != NULL) {
+    /* get the mime type */
+    const char* mime_type = magic_file(magic_cookie, path);
+    if (mime_type == NULL) {
+      girara_debug("failed guessing filetype: %s", magic_error(magic_cookie));
+    } else {
+      girara_debug("magic detected filetype: %s", mime_type);
+      content_type = g_strdup(mime_type);
+    }
   }
+  G_UNLOCK(magic);
 
-  girara_debug("magic detected filetype: %s", mime_type);
-  content_type = g_strdup(mime_type);
+  return content_type;
+}
+#endif /*WITH_MAGIC*/
 
-cleanup:
-  if (magic != NULL) {
-    magic_close(magic);
+static const gchar*
+guess_type_detect(const char* path)
+{
+  /* the common formats are recognized by their first bytes */
+  const gchar* content_type = guess_type_sniff(path);
+  if (content_type != NULL) {
+    return content_type;
   }
 
+#ifdef WITH_MAGIC
+  content_type = guess_type_magic(path);
   if (content_type != NULL) {
     return content_type;
   }
@@ -576,15 +701,14 @@ cleanup:
   }
 
   const int fd = fileno(f);
-  guchar* content = NULL;
+  guchar* content = g_malloc(GT_MAX_READ);
   size_t length = 0u;
   ssize_t bytes_read = -1;
   while (uncertain == TRUE && length < GT_MAX_READ && bytes_read != 0) {
     g_free((void*)content_type);
     content_type = NULL;
 
-    content = g_realloc(content, length + BUFSIZ);
-    bytes_read = read(fd, content + length, BUFSIZ);
+    bytes_read = read(fd, content + length, MIN(BUFSIZ, GT_MAX_READ - length));
     if (bytes_read == -1) {
       break;
     }
@@ -632,6 +756,60 @@ cleanup:
   return out;
 }
 
+static void
+guess_type_entry_free(gpointer data)
+{
+  guess_type_entry_t* entry = data;
+
+  g_free(entry->content_type);
+  g_free(entry);
+}
+
+static const gchar*
+guess_type(const char* path)
+{
+  /* files that have not changed since their type has been detected (e.g. on
+   * reloads) are not looked at again */
+  GStatBuf info;
+  const bool known = g_stat(path, &info) == 0;
+  if (known == true) {
+    G_LOCK(guess_type_cache);
+    guess_type_entry_t* entry = guess_type_cache == NULL ? NULL :
+      g_hash_table_lookup(guess_type_cache, path);
+    char* content_type = NULL;
+    if (entry != NULL && entry->mtime == info.st_mtime && entry->size == info.st_size) {
+      content_type = g_strdup(entry->content_type);
+    }
+    G_UNLOCK(guess_type_cache);
+
+    if (content_type != NULL) {
+      girara_debug("cached filetype: %s", content_type);
+      return content_type;
+    }
+  }
+
+  const gchar* content_type = guess_type_detect(path);
+  if (content_type == NULL || known == false) {
+    return content_type;
+  }
+
+  guess_type_entry_t* entry = g_malloc0(sizeof(guess_type_entry_t));
+  entry->mtime        = info.st_mtime;
+  entry->size         = info.st_size;
+  entry->content_type = g_strdup(content_type);
+
+  G_LOCK(guess_type_cache);
+  if (guess_type_cache == NULL) {
+    guess_type_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, guess_type_entry_free);
+  } else if (g_hash_table_size(guess_type_cache) >= GT_CACHE_SIZE) {
+    g_hash_table_remove_all(guess_type_cache);
+  }
+  g_hash_table_replace(guess_type_cache, g_strdup(path), entry);
+  G_UNLOCK(guess_type_cache);
+
+  return content_type;
+}
+
 zathura_plugin_t*
 zathura_document_get_plugin(zathura_document_t* document)
 {
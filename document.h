@@ -21,6 +21,45 @@ zathura_document_t* zathura_document_open(zathura_plugin_manager_t*
     plugin_manager, const char* path, const char* password, zathura_error_t*
     error);
 
+/**
+ * Reports the progress of opening a document
+ *
+ * @param pages_read Number of pages that have been read
+ * @param number_of_pages Number of pages of the document
+ * @param data Custom data
+ */
+typedef void (*zathura_document_open_progress_t)(unsigned int pages_read,
+    unsigned int number_of_pages, void* data);
+
+/**
+ * Open the document and report the progress while the pages are read. This
+ * function may be called from any thread, the progress function is called
+ * from the calling thread.
+ *
+ * @param plugin_manager The plugin manager
+ * @param path Path to the document
+ * @param password Password of the document or NULL
+ * @param error Optional error parameter
+ * @param progress Function that is called after each page (or NULL)
+ * @param data Custom data that is passed to the progress function
+ * @return The document object
+ */
+zathura_document_t* zathura_document_open_with_progress(zathura_plugin_manager_t*
+    plugin_manager, const char* path, const char* password, zathura_error_t*
+    error, zathura_document_open_progress_t progress, void* data);
+
+/**
+ * Recognizes the common document formats (PDF, PostScript, DjVu and comic
+ * books) by the first bytes of a file. Zip archives are only reported if
+ * their first entry is an image, all other zip based formats are left to
+ * libmagic.
+ *
+ * @param data The beginning of the file
+ * @param length Number of bytes in data
+ * @return The mime type or NULL if the format is not recognized
+ */
+const char* zathura_document_sniff_type(const void* data, size_t length);
+
 /**
  * Free the document
  *
@@ -0,0 +1,446 @@
+/* See LICENSE file for license and copyright information */
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <girara/session.h>
+#include <girara/settings.h>
+#include <girara/statusbar.h>
+#include <girara/utils.h>
+
+#include "glib-compat.h"
+#include "export.h"
+#include "document.h"
+#include "page.h"
+#include "render.h"
+
+/* interval in milliseconds in which the progress is shown */
+#define EXPORT_UPDATE_INTERVAL 250
+
+/**
+ * A rasterized page waiting for its encoding
+ */
+typedef struct export_image_s {
+  unsigned int page; /**< The page index */
+  cairo_surface_t* surface; /**< The rasterized page or NULL to stop the encoder */
+} export_image_t;
+
+/**
+ * An export that is running in the background
+ */
+struct export_job_s {
+  zathura_t* zathura; /**< Zathura object */
+  char* directory; /**< The directory the images are written to */
+  double scale; /**< The scale the pages are rasterized at */
+  unsigned int first; /**< The index of the first page */
+  unsigned int count; /**< Number of pages to export */
+  unsigned int number_of_pages; /**< Number of pages of the document */
+  bool serialize; /**< Whether the render lock has to be held */
+  GThread** rasterizers; /**< Threads rasterizing the pages */
+  unsigned int number_of_rasterizers; /**< Number of rasterizing threads */
+  GThread** encoders; /**< Threads encoding the rasterized pages */
+  unsigned int number_of_encoders; /**< Number of encoding threads */
+  gint next; /**< Position of the next page to rasterize */
+  gint cancelled; /**< Set when the threads should stop */
+  gint rasterizing; /**< Number of rasterizing threads that are still running */
+  gint encoding; /**< Number of encoding threads that are still running */
+  gint written; /**< Number of written images */
+  gint failed; /**< Number of pages that could not be exported */
+  GAsyncQueue* tokens; /**< One token per rasterized page that may be kept */
+  GAsyncQueue* images; /**< Rasterized pages waiting for their encoding */
+  guint source; /**< Source that shows the progress */
+};
+
+bool
+export_parse_page_range(const char* range, unsigned int number_of_pages,
+    unsigned int* first, unsigned int* last)
+{
+  if (range == NULL || first == NULL || last == NULL || number_of_pages == 0) {
+    return false;
+  }
+
+  if (g_strcmp0(range, "all") == 0) {
+    *first = 0;
+    *last  = number_of_pages - 1;
+    return true;
+  }
+
+  char* end = NULL;
+  errno = 0;
+  const unsigned long start = strtoul(range, &end, 10);
+  if (end == range || errno != 0 || range[0] == '-' || range[0] == '+') {
+    return false;
+  }
+
+  unsigned long stop = start;
+  if (*end == '-') {
+    const char* input = end + 1;
+    if (*input == '\0') {
+      stop = number_of_pages;
+    } else {
+      stop = strtoul(input, &end, 10);
+      if (end == input || errno != 0 || input[0] == '-' || input[0] == '+') {
+        return false;
+      }
+    }
+  }
+
+  if (*end != '\0' || start == 0 || stop < start || stop > number_of_pages) {
+    return false;
+  }
+
+  *first = start - 1;
+  *last  = stop - 1;
+
+  return true;
+}
+
+char*
+export_page_file_name(const char* directory, unsigned int page, unsigned int
+    number_of_pages)
+{
+  if (directory == NULL) {
+    return NULL;
+  }
+
+  const int digits = snprintf(NULL, 0, "%u", MAX(number_of_pages, 1));
+  char* name = g_strdup_printf("page-%0*u.png", digits, page + 1);
+  char* file = g_build_filename(directory, name, NULL);
+  g_free(name);
+
+  return file;
+}
+
+/* rasterizes the page without recoloring it */
+static cairo_surface_t*
+export_rasterize(export_job_t* job, zathura_page_t* page)
+{
+  const double width  = ceil(zathura_page_get_width(page) * job->scale);
+  const double height = ceil(zathura_page_get_height(page) * job->scale);
+
+  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+
+  cairo_surface_flush(surface);
+  memset(cairo_image_surface_get_data(surface), 0xFF,
+      (size_t) cairo_image_surface_get_stride(surface) * (size_t) height);
+
+  const zathura_render_target_t target = {
+    .data   = cairo_image_surface_get_data(surface),
+    .format = CAIRO_FORMAT_RGB24,
+    .width  = width,
+    .height = height,
+    .stride = cairo_image_surface_get_stride(surface),
+    .scale  = job->scale,
+    .x      = 0,
+    .y      = 0
+  };
+
+  zathura_t* zathura = job->zathura;
+  if (job->serialize == true) {
+    render_lock(zathura->sync.render_thread);
+  }
+  const zathura_error_t error = zathura_page_render_region(page, &target);
+  if (job->serialize == true) {
+    render_unlock(zathura->sync.render_thread);
+  }
+
+  if (error != ZATHURA_ERROR_OK) {
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+  cairo_surface_mark_dirty(surface);
+
+  return surface;
+}
+
+static void
+export_stop_encoders(export_job_t* job)
+{
+  for (unsigned int i = 0; i < job->number_of_encoders; i++) {
+    g_async_queue_push(job->images, g_malloc0(sizeof(export_image_t)));
+  }
+}
+
+static gpointer
+export_rasterizer(gpointer data)
+{
+  export_job_t* job  = data;
+  zathura_t* zathura = job->zathura;
+
+  for (;;) {
+    /* wait until one of the rasterized pages has been encoded */
+    g_async_queue_pop(job->tokens);
+    if (g_atomic_int_get(&job->cancelled) != 0) {
+      break;
+    }
+
+    const gint position = g_atomic_int_add(&job->next, 1);
+    if (position < 0 || (unsigned int) position >= job->count) {
+      break;
+    }
+
+    const unsigned int page_id = job->first + position;
+    zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
+    cairo_surface_t* surface = page != NULL ? export_rasterize(job, page) : NULL;
+    if (surface == NULL) {
+      girara_error("Rasterizing page %u for the export failed", page_id + 1);
+      g_atomic_int_inc(&job->failed);
+      g_async_queue_push(job->tokens, GINT_TO_POINTER(1));
+      continue;
+    }
+
+    export_image_t* image = g_malloc0(sizeof(export_image_t));
+    image->page    = page_id;
+    image->surface = surface;
+    g_async_queue_push(job->images, image);
+  }
+
+  /* the last rasterizer lets the encoders finish */
+  if (g_atomic_int_dec_and_test(&job->rasterizing) == TRUE) {
+    export_stop_encoders(job);
+  }
+
+  return NULL;
+}
+
+static gpointer
+export_encoder(gpointer data)
+{
+  export_job_t* job = data;
+
+  for (;;) {
+    export_image_t* image = g_async_queue_pop(job->images);
+    if (image->surface == NULL) {
+      g_free(image);
+      break;
+    }
+
+    if (g_atomic_int_get(&job->cancelled) == 0) {
+      char* file = export_page_file_name(job->directory, image->page, job->number_of_pages);
+      if (cairo_surface_write_to_png(image->surface, file) == CAIRO_STATUS_SUCCESS) {
+        g_atomic_int_inc(&job->written);
+      } else {
+        girara_error("Couldn't write page %u to '%s'", image->page + 1, file);
+        g_atomic_int_inc(&job->failed);
+      }
+      g_free(file);
+    }
+
+    cairo_surface_destroy(image->surface);
+    g_free(image);
+    g_async_queue_push(job->tokens, GINT_TO_POINTER(1));
+  }
+
+  g_atomic_int_add(&job->encoding, -1);
+  return NULL;
+}
+
+static void
+export_job_free(export_job_t* job)
+{
+  g_atomic_int_set(&job->cancelled, 1);
+
+  /* wake up the rasterizers waiting for a token */
+  for (unsigned int i = 0; i < job->number_of_rasterizers; i++) {
+    g_async_queue_push(job->tokens, GINT_TO_POINTER(1));
+  }
+  for (unsigned int i = 0; i < job->number_of_rasterizers; i++) {
+    if (job->rasterizers[i] != NULL) {
+      g_thread_join(job->rasterizers[i]);
+    }
+  }
+
+  /* the encoders might not have been stopped if no rasterizer has started */
+  export_stop_encoders(job);
+  for (unsigned int i = 0; i < job->number_of_encoders; i++) {
+    if (job->encoders[i] != NULL) {
+      g_thread_join(job->encoders[i]);
+    }
+  }
+
+  if (job->source != 0) {
+    g_source_remove(job->source);
+  }
+
+  export_image_t* image = NULL;
+  while ((image = g_async_queue_try_pop(job->images)) != NULL) {
+    if (image->surface != NULL) {
+      cairo_surface_destroy(image->surface);
+    }
+    g_free(image);
+  }
+  g_async_queue_unref(job->images);
+  g_async_queue_unref(job->tokens);
+
+  g_free(job->rasterizers);
+  g_free(job->encoders);
+  g_free(job->directory);
+  g_free(job);
+}
+
+static void
+export_reset_statusbar(zathura_t* zathura)
+{
+  if (zathura->document == NULL || zathura->ui.statusbar.file == NULL) {
+    return;
+  }
+
+  const char* file_path = zathura_document_get_path(zathura->document);
+  if (file_path != NULL) {
+    girara_statusbar_item_set_text(zathura->ui.session,
+                                   zathura->ui.statusbar.file, file_path);
+  }
+}
+
+static gboolean
+export_update(gpointer data)
+{
+  export_job_t* job  = data;
+  zathura_t* zathura = job->zathura;
+
+  const unsigned int written = g_atomic_int_get(&job->written);
+  const unsigned int failed  = g_atomic_int_get(&job->failed);
+
+  /* the encoders decrement the counter after their last image is written */
+  if (g_atomic_int_get(&job->encoding) != 0) {
+    if (zathura->ui.statusbar.file != NULL) {
+      char* text = g_strdup_printf(_("Exporting pages (%u of %u) ..."),
+                                   written + failed, job->count);
+      girara_statusbar_item_set_text(zathura->ui.session,
+                                     zathura->ui.statusbar.file, text);
+      g_free(text);
+    }
+    return TRUE;
+  }
+
+  /* the source is destroyed once this function returns */
+  job->source = 0;
+  zathura->sync.export_job = NULL;
+
+  export_reset_statusbar(zathura);
+  if (failed == 0) {
+    girara_notify(zathura->ui.session, GIRARA_INFO,
+                  _("Wrote %u pages to '%s'."), written, job->directory);
+  } else {
+    girara_notify(zathura->ui.session, GIRARA_ERROR,
+                  _("Couldn't export %u of %u pages to '%s'."), failed,
+                  job->count, job->directory);
+  }
+
+  export_job_free(job);
+
+  return FALSE;
+}
+
+bool
+export_pages_start(zathura_t* zathura, unsigned int first, unsigned int last,
+    const char* directory, double scale)
+{
+  if (zathura == NULL || zathura->document == NULL || directory == NULL ||
+      scale <= 0.0 || last < first) {
+    return false;
+  }
+
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  if (last >= number_of_pages) {
+    return false;
+  }
+
+  if (g_mkdir_with_parents(directory, 0755) != 0) {
+    girara_error("Couldn't create directory '%s': %s", directory, g_strerror(errno));
+    return false;
+  }
+
+  export_pages_cancel(zathura);
+
+  export_job_t* job    = g_malloc0(sizeof(export_job_t));
+  job->zathura         = zathura;
+  job->directory       = g_strdup(directory);
+  job->scale           = scale;
+  job->first           = first;
+  job->count           = last - first + 1;
+  job->number_of_pages = number_of_pages;
+  job->tokens          = g_async_queue_new();
+  job->images          = g_async_queue_new();
+
+  /* only rasterize pages in parallel if the plugin allows it; encoding does
+   * not involve the plugin */
+  int threads = 1;
+  girara_setting_get(zathura->ui.session, "render-threads", &threads);
+  threads = CLAMP(threads, 1, (int) job->count);
+
+  job->serialize = render_is_serialized(zathura->sync.render_thread);
+  job->number_of_rasterizers = job->serialize == true ? 1 : threads;
+  job->number_of_encoders    = threads;
+
+  /* at most this many rasterized pages are kept in memory */
+  const unsigned int tokens = job->number_of_rasterizers + job->number_of_encoders;
+  for (unsigned int i = 0; i < tokens; i++) {
+    g_async_queue_push(job->tokens, GINT_TO_POINTER(1));
+  }
+
+  job->encoders = g_malloc0_n(job->number_of_encoders, sizeof(GThread*));
+  unsigned int encoders = 0;
+  for (unsigned int i = 0; i < job->number_of_encoders; i++) {
+    g_atomic_int_inc(&job->encoding);
+    job->encoders[i] = thread_new("export-encode", export_encoder, job);
+    if (job->encoders[i] == NULL) {
+      g_atomic_int_add(&job->encoding, -1);
+    } else {
+      ++encoders;
+    }
+  }
+
+  job->rasterizers = g_malloc0_n(job->number_of_rasterizers, sizeof(GThread*));
+  unsigned int rasterizers = 0;
+  if (encoders != 0) {
+    g_atomic_int_set(&job->rasterizing, job->number_of_rasterizers);
+    for (unsigned int i = 0; i < job->number_of_rasterizers; i++) {
+      job->rasterizers[i] = thread_new("export-raster", export_rasterizer, job);
+      if (job->rasterizers[i] == NULL) {
+        if (g_atomic_int_dec_and_test(&job->rasterizing) == TRUE) {
+          export_stop_encoders(job);
+        }
+      } else {
+        ++rasterizers;
+      }
+    }
+  }
+
+  if (rasterizers == 0) {
+    girara_error("could not create export threads");
+    export_job_free(job);
+    return false;
+  }
+
+  job->source = gdk_threads_add_timeout(EXPORT_UPDATE_INTERVAL, export_update, job);
+  zathura->sync.export_job = job;
+
+  girara_debug("exporting pages %u to %u at scale %.2f with %u rasterizing and "
+               "%u encoding thread(s)", first + 1, last + 1, scale,
+               rasterizers, encoders);
+
+  return true;
+}
+
+void
+export_pages_cancel(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->sync.export_job == NULL) {
+    return;
+  }
+
+  export_job_t* job = zathura->sync.export_job;
+  zathura->sync.export_job = NULL;
+
+  girara_debug("cancelling the export to '%s'", job->directory);
+  export_job_free(job);
+  export_reset_statusbar(zathura);
+}
@@ -0,0 +1,62 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdbool.h>
+
+#include "zathura.h"
+
+/**
+ * Parses a range of pages. Allowed are a single page ("7"), a closed range
+ * ("10-500"), an open range ("10-" up to the last page) and "all". Page
+ * numbers start at 1.
+ *
+ * @param range The range
+ * @param number_of_pages Number of pages of the document
+ * @param first Will be set to the index of the first page
+ * @param last Will be set to the index of the last page
+ * @return true if the range is valid and within the document
+ */
+bool export_parse_page_range(const char* range, unsigned int number_of_pages,
+    unsigned int* first, unsigned int* last);
+
+/**
+ * Returns the file a page is exported to. The page numbers are padded to the
+ * same length, so that the files sort in page order.
+ *
+ * @param directory The directory of the export
+ * @param page The index of the page
+ * @param number_of_pages Number of pages of the document
+ * @return The file name (free with g_free)
+ */
+char* export_page_file_name(const char* directory, unsigned int page,
+    unsigned int number_of_pages);
+
+/**
+ * Starts exporting a range of pages as PNG images in the background. Pages
+ * are rasterized by several threads if the plugin declares
+ * ZATHURA_PLUGIN_CAPABILITY_THREAD_SAFE_RENDER and encoded by separate
+ * threads. Only a bounded number of rasterized pages wait for their encoding
+ * at any time. The progress is shown in the statusbar. An export that is
+ * still running is cancelled.
+ *
+ * @param zathura The zathura session
+ * @param first The index of the first page
+ * @param last The index of the last page
+ * @param directory The directory the images are written to
+ * @param scale The scale the pages are rasterized at
+ * @return true if the export has been started
+ */
+bool export_pages_start(zathura_t* zathura, unsigned int first, unsigned int
+    last, const char* directory, double scale);
+
+/**
+ * Cancels the running export and waits for its threads. Images that have
+ * already been written are kept.
+ *
+ * @param zathura The zathura session
+ */
+void export_pages_cancel(zathura_t* zathura);
+
+#endif // EXPORT_H
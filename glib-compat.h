@@ -20,6 +20,28 @@
 #define mutex_free(m) g_mutex_clear((m))
 #endif
 
+/* GCond can be embedded starting with glib 2.32 */
+#if !GLIB_CHECK_VERSION(2, 31, 0)
+#define cond GCond*
+#define cond_init(c) (*(c) = g_cond_new())
+#define cond_wait(c, m) g_cond_wait(*(c), g_static_mutex_get_mutex((m)))
+#define cond_broadcast(c) g_cond_broadcast(*(c))
+#define cond_free(c) g_cond_free(*(c))
+#else
+#define cond GCond
+#define cond_init(c) g_cond_init((c))
+#define cond_wait(c, m) g_cond_wait((c), (m))
+#define cond_broadcast(c) g_cond_broadcast((c))
+#define cond_free(c) g_cond_clear((c))
+#endif
+
+/* g_thread_new appeared in 2.32 */
+#if !GLIB_CHECK_VERSION(2, 31, 0)
+#define thread_new(name, func, data) g_thread_create((func), (data), TRUE, NULL)
+#else
+#define thread_new(name, func, data) g_thread_new((name), (func), (data))
+#endif
+
 /* g_get_real_time appeared in 2.28 */
 #if !GLIB_CHECK_VERSION(2, 27, 0)
 inline static gint64 g_get_real_time(void)
@@ -0,0 +1,403 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "history-store.h"
+
+#define KEY_PAGE "page"
+#define KEY_OFFSET "offset"
+#define KEY_SCALE "scale"
+#define KEY_ROTATE "rotate"
+#define KEY_PAGES_PER_ROW "pages-per-row"
+#define KEY_FIRST_PAGE_COLUMN "first-page-column"
+#define KEY_POSITION_X "position-x"
+#define KEY_POSITION_Y "position-y"
+#define KEY_TIME "time"
+
+/**
+ * File information of a document
+ */
+typedef struct history_entry_s {
+  char* name; /**< Name of the group */
+  char* block; /**< The group as it is written to the file */
+  gint64 time; /**< Time the entry has been stored (0 if unknown) */
+  unsigned int order; /**< Position in the file, to order entries without a time */
+  zathura_fileinfo_t file_info; /**< The file information */
+  bool has_scale; /**< The scale has been stored */
+  bool has_position_x; /**< The horizontal position has been stored */
+  bool has_position_y; /**< The vertical position has been stored */
+} history_entry_t;
+
+struct zathura_history_store_s {
+  GHashTable* entries; /**< Entries by their name */
+  GHashTable* pending; /**< Names of the entries that have not been written yet */
+  unsigned int limit; /**< Maximum number of entries (0 for no limit) */
+  unsigned int order; /**< Position given to the next entry */
+};
+
+static void
+history_entry_free(history_entry_t* entry)
+{
+  g_free(entry->name);
+  g_free(entry->block);
+  g_free(entry);
+}
+
+static GHashTable*
+history_entries_new(void)
+{
+  return g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+      (GDestroyNotify) history_entry_free);
+}
+
+/* builds the group in the key file format */
+static void
+history_entry_serialize(history_entry_t* entry)
+{
+  const zathura_fileinfo_t* info = &entry->file_info;
+
+  GString* block = g_string_new(NULL);
+  g_string_append_printf(block, "[%s]\n", entry->name);
+  g_string_append_printf(block, KEY_PAGE "=%d\n", (int) info->current_page);
+  g_string_append_printf(block, KEY_OFFSET "=%d\n", (int) info->page_offset);
+  if (entry->has_scale == true) {
+    g_string_append_printf(block, KEY_SCALE "=%f\n", info->scale);
+  }
+  g_string_append_printf(block, KEY_ROTATE "=%d\n", (int) info->rotation);
+  g_string_append_printf(block, KEY_PAGES_PER_ROW "=%d\n", (int) info->pages_per_row);
+  g_string_append_printf(block, KEY_FIRST_PAGE_COLUMN "=%d\n", (int) info->first_page_column);
+  if (entry->has_position_x == true) {
+    g_string_append_printf(block, KEY_POSITION_X "=%f\n", info->position_x);
+  }
+  if (entry->has_position_y == true) {
+    g_string_append_printf(block, KEY_POSITION_Y "=%f\n", info->position_y);
+  }
+  g_string_append_printf(block, KEY_TIME "=%" G_GINT64_FORMAT "\n", entry->time);
+
+  g_free(entry->block);
+  entry->block = g_string_free(block, FALSE);
+}
+
+/* parses the keys of a group; unknown keys are ignored */
+static void
+history_entry_parse(history_entry_t* entry, char** lines, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    char* separator = strchr(lines[i], '=');
+    if (lines[i][0] == '#' || separator == NULL) {
+      continue;
+    }
+
+    char* key = g_strstrip(g_strndup(lines[i], separator - lines[i]));
+    const char* value = separator + 1;
+    zathura_fileinfo_t* info = &entry->file_info;
+
+    if (strcmp(key, KEY_PAGE) == 0) {
+      info->current_page = strtol(value, NULL, 10);
+    } else if (strcmp(key, KEY_OFFSET) == 0) {
+      info->page_offset = strtol(value, NULL, 10);
+    } else if (strcmp(key, KEY_SCALE) == 0) {
+      info->scale = strtod(value, NULL);
+      entry->has_scale = true;
+    } else if (strcmp(key, KEY_ROTATE) == 0) {
+      info->rotation = strtol(value, NULL, 10);
+    } else if (strcmp(key, KEY_PAGES_PER_ROW) == 0) {
+      info->pages_per_row = strtol(value, NULL, 10);
+    } else if (strcmp(key, KEY_FIRST_PAGE_COLUMN) == 0) {
+      info->first_page_column = strtol(value, NULL, 10);
+    } else if (strcmp(key, KEY_POSITION_X) == 0) {
+      info->position_x = strtod(value, NULL);
+      entry->has_position_x = true;
+    } else if (strcmp(key, KEY_POSITION_Y) == 0) {
+      info->position_y = strtod(value, NULL);
+      entry->has_position_y = true;
+    } else if (strcmp(key, KEY_TIME) == 0) {
+      entry->time = g_ascii_strtoll(value, NULL, 10);
+    }
+
+    g_free(key);
+  }
+}
+
+static gint
+history_entry_compare(gconstpointer a, gconstpointer b)
+{
+  const history_entry_t* entry_a = *(history_entry_t* const*) a;
+  const history_entry_t* entry_b = *(history_entry_t* const*) b;
+
+  if (entry_a->time != entry_b->time) {
+    return entry_a->time < entry_b->time ? -1 : 1;
+  }
+  if (entry_a->order != entry_b->order) {
+    return entry_a->order < entry_b->order ? -1 : 1;
+  }
+
+  return 0;
+}
+
+/* returns the entries from the least to the most recently stored one */
+static GPtrArray*
+history_store_sorted(zathura_history_store_t* store)
+{
+  GPtrArray* entries = g_ptr_array_sized_new(g_hash_table_size(store->entries));
+
+  GHashTableIter iter;
+  gpointer value = NULL;
+  g_hash_table_iter_init(&iter, store->entries);
+  while (g_hash_table_iter_next(&iter, NULL, &value) == TRUE) {
+    g_ptr_array_add(entries, value);
+  }
+  g_ptr_array_sort(entries, history_entry_compare);
+
+  return entries;
+}
+
+static void
+history_store_enforce_limit(zathura_history_store_t* store)
+{
+  if (store->limit == 0 || g_hash_table_size(store->entries) <= store->limit) {
+    return;
+  }
+
+  GPtrArray* entries = history_store_sorted(store);
+  const guint excess = entries->len - store->limit;
+  for (guint i = 0; i < excess; i++) {
+    history_entry_t* entry = g_ptr_array_index(entries, i);
+    g_hash_table_remove(store->pending, entry->name);
+    g_hash_table_remove(store->entries, entry->name);
+  }
+  g_ptr_array_free(entries, TRUE);
+}
+
+zathura_history_store_t*
+zathura_history_store_new(unsigned int limit)
+{
+  zathura_history_store_t* store = g_malloc0(sizeof(zathura_history_store_t));
+  store->entries = history_entries_new();
+  store->pending = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  store->limit   = limit;
+
+  return store;
+}
+
+void
+zathura_history_store_free(zathura_history_store_t* store)
+{
+  if (store == NULL) {
+    return;
+  }
+
+  g_hash_table_destroy(store->pending);
+  g_hash_table_destroy(store->entries);
+  g_free(store);
+}
+
+void
+zathura_history_store_set_limit(zathura_history_store_t* store, unsigned int limit)
+{
+  if (store == NULL) {
+    return;
+  }
+
+  store->limit = limit;
+  history_store_enforce_limit(store);
+}
+
+/* adds a group read from the file; entries whose text is unchanged are taken
+ * from the previous entries without parsing them again */
+static void
+history_store_add_group(zathura_history_store_t* store, GHashTable* previous,
+    char** lines, size_t n)
+{
+  char* close = strrchr(lines[0], ']');
+  if (close == NULL) {
+    return;
+  }
+  char* name = g_strndup(lines[0] + 1, close - lines[0] - 1);
+
+  /* blank lines separate the groups */
+  while (n > 1 && lines[n - 1][0] == '\0') {
+    --n;
+  }
+
+  GString* text = g_string_new(NULL);
+  for (size_t i = 0; i < n; i++) {
+    g_string_append_printf(text, "%s\n", lines[i]);
+  }
+  char* block = g_string_free(text, FALSE);
+
+  /* the same document might be listed twice; the last one wins */
+  g_hash_table_remove(store->entries, name);
+
+  history_entry_t* entry = g_hash_table_lookup(previous, name);
+  if (entry != NULL && strcmp(entry->block, block) == 0) {
+    g_hash_table_steal(previous, name);
+    g_free(block);
+    g_free(name);
+  } else {
+    entry = g_malloc0(sizeof(history_entry_t));
+    entry->name  = name;
+    entry->block = block;
+    history_entry_parse(entry, lines + 1, n - 1);
+  }
+
+  entry->order = store->order++;
+  g_hash_table_insert(store->entries, entry->name, entry);
+}
+
+void
+zathura_history_store_load(zathura_history_store_t* store, const char* content)
+{
+  if (store == NULL || content == NULL) {
+    return;
+  }
+
+  GHashTable* previous = store->entries;
+  store->entries = history_entries_new();
+  store->order   = 0;
+
+  char** lines = g_strsplit(content, "\n", 0);
+  size_t start = 0;
+  bool group   = false;
+  for (size_t i = 0; ; i++) {
+    const bool end = lines[i] == NULL;
+    if (end == true || lines[i][0] == '[') {
+      if (group == true) {
+        history_store_add_group(store, previous, lines + start, i - start);
+      }
+      if (end == true) {
+        break;
+      }
+      start = i;
+      group = true;
+    }
+  }
+  g_strfreev(lines);
+
+  /* entries that have not been written yet are kept */
+  GHashTableIter iter;
+  gpointer name = NULL;
+  g_hash_table_iter_init(&iter, store->pending);
+  while (g_hash_table_iter_next(&iter, &name, NULL) == TRUE) {
+    history_entry_t* entry = g_hash_table_lookup(previous, name);
+    if (entry != NULL) {
+      g_hash_table_steal(previous, name);
+      entry->order = store->order++;
+      g_hash_table_replace(store->entries, entry->name, entry);
+    }
+  }
+
+  g_hash_table_destroy(previous);
+  history_store_enforce_limit(store);
+}
+
+char*
+zathura_history_store_to_data(zathura_history_store_t* store, gsize* length)
+{
+  if (store == NULL) {
+    return NULL;
+  }
+
+  GPtrArray* entries = history_store_sorted(store);
+  GString* content = g_string_new(NULL);
+  for (guint i = 0; i < entries->len; i++) {
+    history_entry_t* entry = g_ptr_array_index(entries, i);
+    if (i != 0) {
+      g_string_append_c(content, '\n');
+    }
+    g_string_append(content, entry->block);
+  }
+  g_ptr_array_free(entries, TRUE);
+
+  if (length != NULL) {
+    *length = content->len;
+  }
+
+  return g_string_free(content, FALSE);
+}
+
+void
+zathura_history_store_mark_written(zathura_history_store_t* store)
+{
+  if (store == NULL) {
+    return;
+  }
+
+  g_hash_table_remove_all(store->pending);
+}
+
+bool
+zathura_history_store_is_dirty(zathura_history_store_t* store)
+{
+  return store != NULL && g_hash_table_size(store->pending) != 0;
+}
+
+void
+zathura_history_store_set(zathura_history_store_t* store, const char* name,
+    const zathura_fileinfo_t* file_info, gint64 time)
+{
+  if (store == NULL || name == NULL || file_info == NULL) {
+    return;
+  }
+
+  history_entry_t* entry = g_hash_table_lookup(store->entries, name);
+  if (entry == NULL) {
+    entry = g_malloc0(sizeof(history_entry_t));
+    entry->name = g_strdup(name);
+    g_hash_table_insert(store->entries, entry->name, entry);
+  }
+
+  entry->file_info      = *file_info;
+  entry->time           = time;
+  entry->order          = store->order++;
+  entry->has_scale      = true;
+  entry->has_position_x = true;
+  entry->has_position_y = true;
+  history_entry_serialize(entry);
+
+  g_hash_table_add(store->pending, g_strdup(name));
+  history_store_enforce_limit(store);
+}
+
+bool
+zathura_history_store_get(zathura_history_store_t* store, const char* name,
+    zathura_fileinfo_t* file_info)
+{
+  if (store == NULL || name == NULL || file_info == NULL) {
+    return false;
+  }
+
+  history_entry_t* entry = g_hash_table_lookup(store->entries, name);
+  if (entry == NULL) {
+    return false;
+  }
+
+  const zathura_fileinfo_t* info = &entry->file_info;
+  file_info->current_page      = info->current_page;
+  file_info->page_offset       = info->page_offset;
+  file_info->rotation          = info->rotation;
+  file_info->pages_per_row     = info->pages_per_row;
+  file_info->first_page_column = info->first_page_column;
+  if (entry->has_scale == true) {
+    file_info->scale = info->scale;
+  }
+  if (entry->has_position_x == true) {
+    file_info->position_x = info->position_x;
+  }
+  if (entry->has_position_y == true) {
+    file_info->position_y = info->position_y;
+  }
+
+  return true;
+}
+
+unsigned int
+zathura_history_store_size(zathura_history_store_t* store)
+{
+  if (store == NULL) {
+    return 0;
+  }
+
+  return g_hash_table_size(store->entries);
+}
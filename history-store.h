@@ -0,0 +1,107 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+#include "database.h"
+
+typedef struct zathura_history_store_s zathura_history_store_t;
+
+/**
+ * Creates a new store for the file information of the plain database. The
+ * entries are kept in a hash table by their name. The store reads and writes
+ * the key file format of the history file.
+ *
+ * @param limit Maximum number of entries (0 for no limit)
+ * @return The store
+ */
+zathura_history_store_t* zathura_history_store_new(unsigned int limit);
+
+/**
+ * Frees the store
+ *
+ * @param store The store
+ */
+void zathura_history_store_free(zathura_history_store_t* store);
+
+/**
+ * Sets the maximum number of entries. The least recently stored entries are
+ * dropped if there are more.
+ *
+ * @param store The store
+ * @param limit Maximum number of entries (0 for no limit)
+ */
+void zathura_history_store_set_limit(zathura_history_store_t* store, unsigned int limit);
+
+/**
+ * Replaces the entries with the content of the history file. Only entries
+ * whose text has changed are parsed again. Entries that have been stored
+ * since the store has been written last are kept.
+ *
+ * @param store The store
+ * @param content The content of the history file
+ */
+void zathura_history_store_load(zathura_history_store_t* store, const char* content);
+
+/**
+ * Returns the content of the history file. The entries are not marked as
+ * written, since writing the content might fail.
+ *
+ * @param store The store
+ * @param length Will be set to the length of the content (or NULL)
+ * @return The content (free with g_free)
+ */
+char* zathura_history_store_to_data(zathura_history_store_t* store, gsize* length);
+
+/**
+ * Marks all entries as written once the content returned by
+ * zathura_history_store_to_data has been saved.
+ *
+ * @param store The store
+ */
+void zathura_history_store_mark_written(zathura_history_store_t* store);
+
+/**
+ * Checks whether entries have been stored since the store has been written
+ * last
+ *
+ * @param store The store
+ * @return true if there are changes to write
+ */
+bool zathura_history_store_is_dirty(zathura_history_store_t* store);
+
+/**
+ * Stores the file information of a document
+ *
+ * @param store The store
+ * @param name The name of the entry
+ * @param file_info The file information
+ * @param time The time the information has been stored at (in seconds)
+ */
+void zathura_history_store_set(zathura_history_store_t* store, const char* name,
+    const zathura_fileinfo_t* file_info, gint64 time);
+
+/**
+ * Looks up the file information of a document. The scale and the position
+ * are left untouched if they have not been stored.
+ *
+ * @param store The store
+ * @param name The name of the entry
+ * @param file_info Will be set to the file information
+ * @return true if the entry exists
+ */
+bool zathura_history_store_get(zathura_history_store_t* store, const char* name,
+    zathura_fileinfo_t* file_info);
+
+/**
+ * Returns the number of entries
+ *
+ * @param store The store
+ * @return The number of entries
+ */
+unsigned int zathura_history_store_size(zathura_history_store_t* store);
+
+#endif // HISTORY_STORE_H
@@ -9,6 +9,8 @@
 
 #include "zathura.h"
 #include "utils.h"
+#include "server.h"
+#include "tabs.h"
 
 /* main function */
 int
@@ -40,10 +42,16 @@ main(int argc, char* argv[])
   gchar* loglevel       = NULL;
   gchar* password       = NULL;
   gchar* synctex_editor = NULL;
+  gchar* synctex_fwd    = NULL;
+  gchar* replay_file    = NULL;
+  int memory_limit      = 0;
   bool forkback         = false;
   bool print_version    = false;
   bool synctex          = false;
+  bool server_mode      = false;
+  bool tabs             = false;
   int page_number       = ZATHURA_PAGE_NUMBER_UNSPECIFIED;
+  char** local_argv     = NULL;
 
 #if (GTK_MAJOR_VERSION == 3)
   Window embed = 0;
@@ -63,6 +71,11 @@ main(int argc, char* argv[])
     { "version",                'v', 0, G_OPTION_ARG_NONE,     &print_version,  _("Print version information"),                         NULL },
     { "synctex",                's', 0, G_OPTION_ARG_NONE,     &synctex,        _("Enable synctex support"),                            NULL },
     { "synctex-editor-command", 'x', 0, G_OPTION_ARG_STRING,   &synctex_editor, _("Synctex editor (forwarded to the synctex command)"), "cmd" },
+    { "synctex-forward",        '\0',0, G_OPTION_ARG_STRING,   &synctex_fwd,    _("Move to given synctex position"),                    "position" },
+    { "replay",                 '\0',0, G_OPTION_ARG_FILENAME, &replay_file,    _("Replay recorded events and report the view latency"), "file" },
+    { "server",                 '\0',0, G_OPTION_ARG_NONE,     &server_mode,    _("Open the documents in a running instance or become one"), NULL },
+    { "tabs",                   '\0',0, G_OPTION_ARG_NONE,     &tabs,           _("Open the documents in tabs of one window"),          NULL },
+    { "memory-limit",           '\0',0, G_OPTION_ARG_INT,      &memory_limit,   _("Amount of memory in MiB zathura should not exceed"), "MiB" },
     { NULL, '\0', 0, 0, NULL, NULL, NULL }
   };
 
@@ -100,17 +113,63 @@ main(int argc, char* argv[])
     girara_set_debug_level(GIRARA_ERROR);
   }
 
+  /* Let a running server open the documents */
+  char* socket_path = NULL;
+  if (server_mode == true && print_version == false) {
+    socket_path = zathura_server_socket_path();
+    if (synctex_fwd != NULL && argc > 1) {
+      if (zathura_server_forward_synctex(socket_path, argv[1], synctex_fwd) == true) {
+        g_free(socket_path);
+        zathura_free(zathura);
+        return 0;
+      }
+    } else {
+      char** rejected = NULL;
+      if (zathura_server_forward(socket_path, argv + 1, password,
+            page_number > 0 ? page_number - 1 : page_number, &rejected) == true) {
+        g_strfreev(rejected);
+        g_free(socket_path);
+        zathura_free(zathura);
+        return 0;
+      }
+
+      /* only the documents the server has not opened are opened here */
+      if (rejected != NULL) {
+        if (argc > 1 && (rejected[0] == NULL || g_strcmp0(rejected[0], argv[1]) != 0)) {
+          password    = NULL;
+          page_number = ZATHURA_PAGE_NUMBER_UNSPECIFIED;
+        }
+
+        const unsigned int count = g_strv_length(rejected);
+        local_argv    = g_malloc0_n(count + 2, sizeof(char*));
+        local_argv[0] = g_strdup(argv[0]);
+        for (unsigned int i = 0; i < count; i++) {
+          local_argv[i + 1] = rejected[i];
+        }
+        g_free(rejected);
+
+        argc = count + 1;
+        argv = local_argv;
+      }
+    }
+  }
+
   zathura_set_xid(zathura, embed);
   zathura_set_config_dir(zathura, config_dir);
   zathura_set_data_dir(zathura, data_dir);
   zathura_set_plugin_dir(zathura, plugin_path);
   zathura_set_synctex_editor_command(zathura, synctex_editor);
+  zathura_set_synctex_forward(zathura, synctex_fwd);
+  zathura_set_replay_file(zathura, replay_file);
+  zathura_set_memory_limit(zathura, memory_limit);
   zathura_set_argv(zathura, argv);
 
   /* Init zathura */
   if(zathura_init(zathura) == false) {
     girara_error("Could not initialize zathura.");
     zathura_free(zathura);
+    g_free(socket_path);
+    g_strfreev(local_argv);
     return -1;
   }
 
@@ -124,10 +183,19 @@ main(int argc, char* argv[])
       fprintf(stdout, "%s\n", string);
     }
     zathura_free(zathura);
+    g_free(socket_path);
+    g_strfreev(local_argv);
 
     return 0;
   }
 
+  /* Become the server of further instances */
+  zathura_server_t* server = NULL;
+  if (socket_path != NULL) {
+    server = zathura_server_new(zathura, socket_path);
+    g_free(socket_path);
+  }
+
   /* open document if passed */
   if (argc > 1) {
     if (page_number > 0)
@@ -136,6 +204,16 @@ main(int argc, char* argv[])
 
     /* open additional files */
     for (int i = 2; i < argc; i++) {
+      if (tabs == true) {
+        tab_add(zathura, argv[i], password);
+        continue;
+      }
+
+      if (server != NULL) {
+        zathura_server_open(server, argv[i], NULL, ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+        continue;
+      }
+
       char* new_argv[] = {
         *(zathura->global.arguments),
         argv[i],
@@ -152,7 +230,12 @@ main(int argc, char* argv[])
   gdk_threads_leave();
 
   /* free zathura */
-  zathura_free(zathura);
+  if (server != NULL) {
+    zathura_server_free(server);
+  } else {
+    zathura_free(zathura);
+  }
+  g_strfreev(local_argv);
 
   return 0;
 }
@@ -0,0 +1,234 @@
+/* See LICENSE file for license and copyright information */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <girara/settings.h>
+#include <girara/utils.h>
+
+#include "memory-monitor.h"
+#include "document.h"
+#include "page.h"
+#include "page-widget.h"
+#include "prefetch.h"
+
+/* interval in milliseconds in which the memory is checked */
+#define MEMORY_MONITOR_INTERVAL 2000
+
+/* time in microseconds between two sheddings caused by memory pressure */
+#define MEMORY_SHED_COOLDOWN (10 * G_USEC_PER_SEC)
+
+/* smallest budget of the page cache in bytes if the memory limit is exceeded */
+#define MEMORY_MIN_CACHE (16 * 1024 * 1024)
+
+#define MEMORY_PRESSURE_FILE "/proc/pressure/memory"
+#define MEMORY_STATM_FILE "/proc/self/statm"
+
+bool
+zathura_memory_parse_pressure(const char* content, double* avg10)
+{
+  if (content == NULL || avg10 == NULL) {
+    return false;
+  }
+
+  /* some avg10=0.00 avg60=0.00 avg300=0.00 total=0 */
+  const char* line = content;
+  while (line != NULL && *line != '\0') {
+    if (strncmp(line, "some ", strlen("some ")) == 0) {
+      const char* value = strstr(line, "avg10=");
+      const char* end   = strchr(line, '\n');
+      if (value == NULL || (end != NULL && value > end)) {
+        return false;
+      }
+
+      char* number_end = NULL;
+      const double share = g_ascii_strtod(value + strlen("avg10="), &number_end);
+      if (number_end == value + strlen("avg10=") || share < 0.0) {
+        return false;
+      }
+
+      *avg10 = share;
+      return true;
+    }
+
+    line = strchr(line, '\n');
+    if (line != NULL) {
+      ++line;
+    }
+  }
+
+  return false;
+}
+
+bool
+zathura_memory_parse_statm(const char* content, size_t page_size, size_t* rss)
+{
+  if (content == NULL || rss == NULL) {
+    return false;
+  }
+
+  /* size resident shared text lib data dt */
+  char* end = NULL;
+  g_ascii_strtoull(content, &end, 10);
+  if (end == content || *end != ' ') {
+    return false;
+  }
+
+  const char* input = end + 1;
+  const guint64 resident = g_ascii_strtoull(input, &end, 10);
+  if (end == input) {
+    return false;
+  }
+
+  *rss = (size_t) resident * page_size;
+  return true;
+}
+
+static bool
+memory_filter_hidden(const zathura_page_cache_key_t* key, void* data)
+{
+  zathura_t* zathura = data;
+  if (key->document != zathura->tabs.id) {
+    /* the pages of the other tabs are not shown at all */
+    return true;
+  }
+
+  zathura_page_t* page = zathura_document_get_page(zathura->document, key->page);
+
+  return page == NULL || zathura_page_get_visibility(page) == false;
+}
+
+void
+memory_shed(zathura_t* zathura)
+{
+  if (zathura == NULL) {
+    return;
+  }
+
+  zathura_page_cache_statistics_t before;
+  zathura_page_cache_get_statistics(zathura->page_cache, &before);
+
+  /* pages that might be shown next are not worth the memory */
+  prefetch_cancel(zathura);
+  zathura_surface_pool_clear(zathura->surface_pool);
+
+  if (zathura->document == NULL || zathura->pages == NULL) {
+    return;
+  }
+
+  zathura_page_cache_remove_matching(zathura->page_cache, memory_filter_hidden, zathura);
+
+  /* the widgets of hidden pages might still show a surface or a preview */
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+    zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
+    if (page == NULL || zathura_page_get_visibility(page) == true) {
+      continue;
+    }
+
+    GtkWidget* widget = zathura_page_get_widget(zathura, page);
+    if (widget != NULL) {
+      zathura_page_widget_update_surface(ZATHURA_PAGE(widget), NULL, NULL);
+      zathura_page_widget_abort_render_request(ZATHURA_PAGE(widget));
+    }
+  }
+
+  zathura_page_cache_statistics_t after;
+  zathura_page_cache_get_statistics(zathura->page_cache, &after);
+  girara_debug("released %" G_GSIZE_FORMAT " KiB of the page cache",
+               (before.bytes - after.bytes) / 1024);
+}
+
+static gboolean
+memory_monitor_check(gpointer data)
+{
+  zathura_t* zathura = data;
+  const gint64 now = g_get_monotonic_time();
+
+  /* a hard limit is enforced every time */
+  if (zathura->memory.limit != 0) {
+    char* content = NULL;
+    size_t rss = 0;
+    if (g_file_get_contents(MEMORY_STATM_FILE, &content, NULL, NULL) == TRUE &&
+        zathura_memory_parse_statm(content, sysconf(_SC_PAGESIZE), &rss) == true &&
+        rss > zathura->memory.limit) {
+      girara_debug("using %" G_GSIZE_FORMAT " MiB of %" G_GSIZE_FORMAT " MiB",
+                   rss / 1024 / 1024, zathura->memory.limit / 1024 / 1024);
+      memory_shed(zathura);
+      zathura->memory.last_shed = now;
+
+      /* renderings of the visible pages alone are too large, so the cache
+       * has to keep less */
+      zathura_page_cache_statistics_t cache;
+      zathura_page_cache_get_statistics(zathura->page_cache, &cache);
+      if (cache.max_bytes > MEMORY_MIN_CACHE) {
+        const size_t max_bytes = MAX(cache.max_bytes / 2, MEMORY_MIN_CACHE);
+        girara_warning("memory limit exceeded, reducing the page cache to %"
+                       G_GSIZE_FORMAT " MiB", max_bytes / 1024 / 1024);
+        zathura_page_cache_set_max_bytes(zathura->page_cache, max_bytes);
+      }
+    }
+    g_free(content);
+  }
+
+  if (zathura->memory.threshold > 0 && now - zathura->memory.last_shed >= MEMORY_SHED_COOLDOWN) {
+    char* content = NULL;
+    double avg10 = 0.0;
+    if (g_file_get_contents(MEMORY_PRESSURE_FILE, &content, NULL, NULL) == TRUE &&
+        zathura_memory_parse_pressure(content, &avg10) == true &&
+        avg10 >= zathura->memory.threshold) {
+      girara_debug("memory pressure of %.2f%%, releasing memory", avg10);
+      memory_shed(zathura);
+      zathura->memory.last_shed = now;
+    }
+    g_free(content);
+  }
+
+  return TRUE;
+}
+
+void
+memory_monitor_start(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->memory.source != 0) {
+    return;
+  }
+
+  int threshold = 0;
+  girara_setting_get(zathura->ui.session, "memory-pressure-threshold", &threshold);
+  zathura->memory.threshold = MAX(threshold, 0);
+
+  /* PSI is only available on Linux 4.20 and later */
+  if (zathura->memory.threshold > 0 &&
+      g_file_test(MEMORY_PRESSURE_FILE, G_FILE_TEST_EXISTS) == FALSE) {
+    girara_debug("%s is not available, memory pressure is not watched", MEMORY_PRESSURE_FILE);
+    zathura->memory.threshold = 0;
+  }
+
+  if (zathura->memory.limit != 0) {
+    zathura_page_cache_statistics_t cache;
+    zathura_page_cache_get_statistics(zathura->page_cache, &cache);
+    if (cache.max_bytes > zathura->memory.limit / 2) {
+      zathura_page_cache_set_max_bytes(zathura->page_cache, zathura->memory.limit / 2);
+    }
+  }
+
+  if (zathura->memory.threshold == 0 && zathura->memory.limit == 0) {
+    return;
+  }
+
+  zathura->memory.last_shed = g_get_monotonic_time() - MEMORY_SHED_COOLDOWN;
+  zathura->memory.source = gdk_threads_add_timeout(MEMORY_MONITOR_INTERVAL,
+      memory_monitor_check, zathura);
+}
+
+void
+memory_monitor_stop(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->memory.source == 0) {
+    return;
+  }
+
+  g_source_remove(zathura->memory.source);
+  zathura->memory.source = 0;
+}
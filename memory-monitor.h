@@ -0,0 +1,57 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "zathura.h"
+
+/**
+ * Reads the share of time tasks were stalled on memory in the last ten
+ * seconds from the contents of /proc/pressure/memory.
+ *
+ * @param content The contents of the file
+ * @param avg10 Will be set to the share in percent
+ * @return true if the contents could be parsed
+ */
+bool zathura_memory_parse_pressure(const char* content, double* avg10);
+
+/**
+ * Reads the resident set size from the contents of /proc/self/statm.
+ *
+ * @param content The contents of the file
+ * @param page_size The size of a memory page in bytes
+ * @param rss Will be set to the resident set size in bytes
+ * @return true if the contents could be parsed
+ */
+bool zathura_memory_parse_statm(const char* content, size_t page_size, size_t* rss);
+
+/**
+ * Starts watching the memory pressure of the system and the memory used by
+ * zathura. Under pressure, or if the memory limit is exceeded, memory is
+ * released with memory_shed. With a memory limit the page cache never takes
+ * more than half of it.
+ *
+ * @param zathura The zathura session
+ */
+void memory_monitor_start(zathura_t* zathura);
+
+/**
+ * Stops watching the memory
+ *
+ * @param zathura The zathura session
+ */
+void memory_monitor_stop(zathura_t* zathura);
+
+/**
+ * Releases memory that is not needed for the current view: prefetching is
+ * stopped, recycled surface buffers are freed and the renderings, previews
+ * and thumbnails of pages that are not visible are dropped.
+ *
+ * @param zathura The zathura session
+ */
+void memory_shed(zathura_t* zathura);
+
+#endif // MEMORY_MONITOR_H
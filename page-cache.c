@@ -0,0 +1,424 @@
+/* See LICENSE file for license and copyright information */
+
+#include <string.h>
+#include <glib.h>
+#include <girara/utils.h>
+
+#include "glib-compat.h"
+#include "page-cache.h"
+
+/**
+ * Cached surface
+ */
+typedef struct page_cache_entry_s {
+  zathura_page_cache_key_t key; /**< Key of the surface */
+  cairo_surface_t* surface; /**< Cached surface */
+  size_t bytes; /**< Size of the surface in bytes */
+  GList link; /**< Position in the LRU queue */
+} page_cache_entry_t;
+
+struct zathura_page_cache_s {
+  GHashTable* entries; /**< key -> entry */
+  GQueue lru; /**< Entries, most recently used first */
+  size_t bytes; /**< Memory used by the cached surfaces */
+  size_t max_bytes; /**< Memory budget */
+  unsigned int max_entries; /**< Maximum number of surfaces */
+  unsigned int hits; /**< Number of hits */
+  unsigned int misses; /**< Number of misses */
+  unsigned int evictions; /**< Number of evictions */
+  zathura_page_cache_key_t* pinned; /**< Keys of the surfaces that are not evicted */
+  unsigned int n_pinned; /**< Number of pinned keys */
+  zathura_page_cache_evict_function_t evict; /**< Evict callback */
+  void* data; /**< Custom data for the evict callback */
+  mutex lock; /**< Lock */
+};
+
+static guint
+page_cache_key_hash(gconstpointer data)
+{
+  const zathura_page_cache_key_t* key = data;
+
+  guint hash = key->page;
+  hash = hash * 31 + g_double_hash(&key->scale);
+  hash = hash * 31 + key->recolor;
+  hash = hash * 31 + key->tile;
+  hash = hash * 31 + key->document;
+
+  return hash;
+}
+
+static gboolean
+page_cache_key_equal(gconstpointer a, gconstpointer b)
+{
+  const zathura_page_cache_key_t* key_a = a;
+  const zathura_page_cache_key_t* key_b = b;
+
+  return key_a->page == key_b->page
+    && key_a->scale == key_b->scale
+    && key_a->recolor == key_b->recolor
+    && key_a->tile == key_b->tile
+    && key_a->document == key_b->document;
+}
+
+static void
+page_cache_entry_free(page_cache_entry_t* entry)
+{
+  if (entry == NULL) {
+    return;
+  }
+
+  if (entry->surface != NULL) {
+    cairo_surface_destroy(entry->surface);
+  }
+  g_free(entry);
+}
+
+/* Unlinks the entry from the cache; the caller owns the entry afterwards. */
+static void
+page_cache_unlink(zathura_page_cache_t* cache, page_cache_entry_t* entry)
+{
+  g_queue_unlink(&cache->lru, &entry->link);
+  g_hash_table_steal(cache->entries, &entry->key);
+  cache->bytes -= entry->bytes;
+}
+
+static bool
+page_cache_is_pinned(zathura_page_cache_t* cache, const zathura_page_cache_key_t* key)
+{
+  for (unsigned int i = 0; i < cache->n_pinned; i++) {
+    if (page_cache_key_equal(&cache->pinned[i], key) == TRUE) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/* Unlinks least recently used entries until the cache fits into its budget,
+ * keeping the given number of most recently used ones and the pinned ones.
+ * Has to be called with the lock held; returns the unlinked entries. */
+static GList*
+page_cache_shrink(zathura_page_cache_t* cache, unsigned int keep)
+{
+  GList* evicted = NULL;
+  GList* iter    = cache->lru.tail;
+  unsigned int position = cache->lru.length;
+  while (iter != NULL && position > keep && (cache->bytes > cache->max_bytes ||
+        (cache->max_entries != 0 && cache->lru.length > cache->max_entries))) {
+    page_cache_entry_t* lru = iter->data;
+    iter = g_list_previous(iter);
+    --position;
+
+    if (page_cache_is_pinned(cache, &lru->key) == true) {
+      continue;
+    }
+
+    page_cache_unlink(cache, lru);
+    ++cache->evictions;
+    evicted = g_list_prepend(evicted, lru);
+  }
+
+  return evicted;
+}
+
+/* Notifies about evicted surfaces without holding the lock and frees them. */
+static void
+page_cache_notify(zathura_page_cache_t* cache, GList* evicted)
+{
+  for (GList* iter = evicted; iter != NULL; iter = g_list_next(iter)) {
+    page_cache_entry_t* lru = iter->data;
+    girara_debug("evicting page %u (scale %.2f) from the page cache",
+                 lru->key.page + 1, lru->key.scale);
+    if (cache->evict != NULL) {
+      cache->evict(&lru->key, lru->surface, cache->data);
+    }
+    page_cache_entry_free(lru);
+  }
+  g_list_free(evicted);
+}
+
+zathura_page_cache_t*
+zathura_page_cache_new(size_t max_bytes, unsigned int max_entries,
+    zathura_page_cache_evict_function_t evict, void* data)
+{
+  zathura_page_cache_t* cache = g_malloc0(sizeof(zathura_page_cache_t));
+
+  cache->entries = g_hash_table_new_full(page_cache_key_hash,
+      page_cache_key_equal, NULL, (GDestroyNotify) page_cache_entry_free);
+  if (cache->entries == NULL) {
+    g_free(cache);
+    return NULL;
+  }
+
+  g_queue_init(&cache->lru);
+  cache->max_bytes   = max_bytes;
+  cache->max_entries = max_entries;
+  cache->evict       = evict;
+  cache->data        = data;
+  mutex_init(&cache->lock);
+
+  return cache;
+}
+
+void
+zathura_page_cache_free(zathura_page_cache_t* cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  zathura_page_cache_clear(cache);
+  g_hash_table_destroy(cache->entries);
+  g_free(cache->pinned);
+  mutex_free(&cache->lock);
+  g_free(cache);
+}
+
+bool
+zathura_page_cache_add(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key, cairo_surface_t* surface)
+{
+  if (cache == NULL || key == NULL || surface == NULL) {
+    return false;
+  }
+
+  page_cache_entry_t* entry = g_malloc0(sizeof(page_cache_entry_t));
+  entry->key          = *key;
+  entry->surface      = cairo_surface_reference(surface);
+  entry->bytes        = (size_t) cairo_image_surface_get_stride(surface) *
+    cairo_image_surface_get_height(surface);
+  entry->link.data    = entry;
+
+  GList* evicted = NULL;
+
+  mutex_lock(&cache->lock);
+
+  page_cache_entry_t* old = g_hash_table_lookup(cache->entries, key);
+  if (old != NULL) {
+    page_cache_unlink(cache, old);
+    page_cache_entry_free(old);
+  }
+
+  g_hash_table_insert(cache->entries, &entry->key, entry);
+  g_queue_push_head_link(&cache->lru, &entry->link);
+  cache->bytes += entry->bytes;
+
+  /* evict least recently used surfaces, but keep the new one */
+  evicted = page_cache_shrink(cache, 1);
+
+  mutex_unlock(&cache->lock);
+
+  page_cache_notify(cache, evicted);
+
+  return true;
+}
+
+void
+zathura_page_cache_set_max_bytes(zathura_page_cache_t* cache, size_t max_bytes)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  mutex_lock(&cache->lock);
+  cache->max_bytes = max_bytes;
+  GList* evicted = page_cache_shrink(cache, 0);
+  mutex_unlock(&cache->lock);
+
+  page_cache_notify(cache, evicted);
+}
+
+void
+zathura_page_cache_pin(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* keys, unsigned int n)
+{
+  if (cache == NULL || (keys == NULL && n != 0)) {
+    return;
+  }
+
+  mutex_lock(&cache->lock);
+  g_free(cache->pinned);
+  cache->pinned = NULL;
+  if (n != 0) {
+    cache->pinned = g_malloc_n(n, sizeof(zathura_page_cache_key_t));
+    memcpy(cache->pinned, keys, n * sizeof(zathura_page_cache_key_t));
+  }
+  cache->n_pinned = n;
+
+  /* surfaces that have been kept for the old pins might not fit anymore */
+  GList* evicted = page_cache_shrink(cache, 0);
+  mutex_unlock(&cache->lock);
+
+  page_cache_notify(cache, evicted);
+}
+
+cairo_surface_t*
+zathura_page_cache_get(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key)
+{
+  if (cache == NULL || key == NULL) {
+    return NULL;
+  }
+
+  cairo_surface_t* surface = NULL;
+
+  mutex_lock(&cache->lock);
+  page_cache_entry_t* entry = g_hash_table_lookup(cache->entries, key);
+  if (entry != NULL) {
+    g_queue_unlink(&cache->lru, &entry->link);
+    g_queue_push_head_link(&cache->lru, &entry->link);
+    surface = cairo_surface_reference(entry->surface);
+    ++cache->hits;
+  } else {
+    ++cache->misses;
+  }
+  mutex_unlock(&cache->lock);
+
+  return surface;
+}
+
+bool
+zathura_page_cache_touch(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key)
+{
+  if (cache == NULL || key == NULL) {
+    return false;
+  }
+
+  mutex_lock(&cache->lock);
+  page_cache_entry_t* entry = g_hash_table_lookup(cache->entries, key);
+  if (entry != NULL) {
+    g_queue_unlink(&cache->lru, &entry->link);
+    g_queue_push_head_link(&cache->lru, &entry->link);
+  }
+  mutex_unlock(&cache->lock);
+
+  return entry != NULL;
+}
+
+bool
+zathura_page_cache_contains(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key)
+{
+  if (cache == NULL || key == NULL) {
+    return false;
+  }
+
+  mutex_lock(&cache->lock);
+  const bool contained = g_hash_table_lookup(cache->entries, key) != NULL;
+  mutex_unlock(&cache->lock);
+
+  return contained;
+}
+
+bool
+zathura_page_cache_charge(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key, cairo_surface_t* surface, size_t bytes)
+{
+  if (cache == NULL || key == NULL || surface == NULL) {
+    return false;
+  }
+
+  GList* evicted = NULL;
+
+  mutex_lock(&cache->lock);
+  page_cache_entry_t* entry = g_hash_table_lookup(cache->entries, key);
+  const bool cached = entry != NULL && entry->surface == surface;
+  if (cached == true) {
+    entry->bytes += bytes;
+    cache->bytes += bytes;
+
+    /* the charged surface is about to be drawn */
+    g_queue_unlink(&cache->lru, &entry->link);
+    g_queue_push_head_link(&cache->lru, &entry->link);
+    evicted = page_cache_shrink(cache, 1);
+  }
+  mutex_unlock(&cache->lock);
+
+  page_cache_notify(cache, evicted);
+
+  return cached;
+}
+
+static bool
+page_cache_filter_page(const zathura_page_cache_key_t* key, void* data)
+{
+  const zathura_page_cache_key_t* page = data;
+  return key->document == page->document && key->page == page->page;
+}
+
+static bool
+page_cache_filter_document(const zathura_page_cache_key_t* key, void* data)
+{
+  const unsigned int* document = data;
+  return key->document == *document;
+}
+
+void
+zathura_page_cache_remove_page(zathura_page_cache_t* cache, unsigned int
+    document, unsigned int page)
+{
+  zathura_page_cache_key_t key = { page, 0, 0, 0, document };
+  zathura_page_cache_remove_matching(cache, page_cache_filter_page, &key);
+}
+
+void
+zathura_page_cache_remove_document(zathura_page_cache_t* cache, unsigned int
+    document)
+{
+  zathura_page_cache_remove_matching(cache, page_cache_filter_document, &document);
+}
+
+void
+zathura_page_cache_remove_matching(zathura_page_cache_t* cache,
+    zathura_page_cache_filter_function_t filter, void* data)
+{
+  if (cache == NULL || filter == NULL) {
+    return;
+  }
+
+  mutex_lock(&cache->lock);
+  GList* iter = cache->lru.head;
+  while (iter != NULL) {
+    page_cache_entry_t* entry = iter->data;
+    iter = g_list_next(iter);
+
+    if (filter(&entry->key, data) == true) {
+      page_cache_unlink(cache, entry);
+      page_cache_entry_free(entry);
+    }
+  }
+  mutex_unlock(&cache->lock);
+}
+
+void
+zathura_page_cache_clear(zathura_page_cache_t* cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  mutex_lock(&cache->lock);
+  g_queue_init(&cache->lru);
+  g_hash_table_remove_all(cache->entries);
+  cache->bytes = 0;
+  mutex_unlock(&cache->lock);
+}
+
+void
+zathura_page_cache_get_statistics(zathura_page_cache_t* cache,
+    zathura_page_cache_statistics_t* statistics)
+{
+  if (cache == NULL || statistics == NULL) {
+    return;
+  }
+
+  mutex_lock(&cache->lock);
+  statistics->hits      = cache->hits;
+  statistics->misses    = cache->misses;
+  statistics->evictions = cache->evictions;
+  statistics->entries   = cache->lru.length;
+  statistics->bytes     = cache->bytes;
+  statistics->max_bytes = cache->max_bytes;
+  mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,208 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <cairo.h>
+
+typedef struct zathura_page_cache_s zathura_page_cache_t;
+
+/**
+ * Identifies a rendered surface of a page. Surfaces are rendered unrotated
+ * and rotated while painting, so the rotation is not part of the key.
+ */
+typedef struct zathura_page_cache_key_s {
+  unsigned int page; /**< Page index */
+  double scale; /**< Scale the page has been rendered at */
+  unsigned int recolor; /**< Recolor state (0 if the page is not recolored) */
+  unsigned int tile; /**< Tile number (0 if the whole page is rendered) */
+  unsigned int document; /**< Tab the page belongs to (0 without tabs) */
+} zathura_page_cache_key_t;
+
+/**
+ * Cache statistics
+ */
+typedef struct zathura_page_cache_statistics_s {
+  unsigned int hits; /**< Number of successful lookups */
+  unsigned int misses; /**< Number of failed lookups */
+  unsigned int evictions; /**< Number of evicted surfaces */
+  unsigned int entries; /**< Number of cached surfaces */
+  size_t bytes; /**< Memory used by the cached surfaces */
+  size_t max_bytes; /**< Memory budget */
+} zathura_page_cache_statistics_t;
+
+/**
+ * Called whenever a surface is evicted from the cache. The cache releases its
+ * own reference to the surface after the function has returned.
+ *
+ * @param key The key of the evicted surface
+ * @param surface The evicted surface
+ * @param data Custom data
+ */
+typedef void (*zathura_page_cache_evict_function_t)(const zathura_page_cache_key_t* key,
+    cairo_surface_t* surface, void* data);
+
+/**
+ * Decides whether a surface should be removed from the cache
+ *
+ * @param key The key of the surface
+ * @param data Custom data
+ * @return true if the surface should be removed
+ */
+typedef bool (*zathura_page_cache_filter_function_t)(const zathura_page_cache_key_t* key,
+    void* data);
+
+/**
+ * Creates a new page cache
+ *
+ * @param max_bytes Memory budget of the cache in bytes
+ * @param max_entries Maximum number of surfaces (0 for no limit)
+ * @param evict Function that is called when a surface is evicted (or NULL)
+ * @param data Custom data that is passed to the evict function
+ * @return The page cache or NULL if an error occured
+ */
+zathura_page_cache_t* zathura_page_cache_new(size_t max_bytes, unsigned int
+    max_entries, zathura_page_cache_evict_function_t evict, void* data);
+
+/**
+ * Frees the page cache and releases all surfaces. The evict function is not
+ * called.
+ *
+ * @param cache The page cache
+ */
+void zathura_page_cache_free(zathura_page_cache_t* cache);
+
+/**
+ * Adds a surface to the cache. The cache takes its own reference of the
+ * surface. An already cached surface with the same key is replaced. Least
+ * recently used surfaces are evicted until the cache fits into its budget;
+ * the surface that has just been added is never evicted.
+ *
+ * @param cache The page cache
+ * @param key The key of the surface
+ * @param surface The surface (an image surface)
+ * @return true if the surface has been added
+ */
+bool zathura_page_cache_add(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key, cairo_surface_t* surface);
+
+/**
+ * Changes the memory budget of the cache. Least recently used surfaces are
+ * evicted until the cache fits into the new budget.
+ *
+ * @param cache The page cache
+ * @param max_bytes Memory budget of the cache in bytes
+ */
+void zathura_page_cache_set_max_bytes(zathura_page_cache_t* cache, size_t max_bytes);
+
+/**
+ * Pins surfaces, so that they are never evicted to make room for other
+ * surfaces, and releases the previously pinned ones. Surfaces that are not
+ * cached yet are kept once they are added. Pinned surfaces count towards the
+ * budget but are kept even if they do not fit into it; they are still
+ * removed by the remove functions.
+ *
+ * @param cache The page cache
+ * @param keys The keys of the surfaces to pin
+ * @param n Number of keys (0 to release all pins)
+ */
+void zathura_page_cache_pin(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* keys, unsigned int n);
+
+/**
+ * Looks up a surface and marks it as recently used.
+ *
+ * @param cache The page cache
+ * @param key The key of the surface
+ * @return A new reference of the surface or NULL if it is not cached
+ */
+cairo_surface_t* zathura_page_cache_get(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key);
+
+/**
+ * Marks a surface as recently used without counting it as a lookup.
+ *
+ * @param cache The page cache
+ * @param key The key of the surface
+ * @return true if the surface is cached
+ */
+bool zathura_page_cache_touch(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key);
+
+/**
+ * Checks whether a surface is cached without marking it as recently used or
+ * counting it as a lookup.
+ *
+ * @param cache The page cache
+ * @param key The key of the surface
+ * @return true if the surface is cached
+ */
+bool zathura_page_cache_contains(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key);
+
+/**
+ * Counts memory that is used for a cached surface elsewhere, e.g. by a copy on
+ * the display server, against the budget until the surface is evicted. Least
+ * recently used surfaces are evicted until the cache fits into its budget
+ * again, but the charged surface is kept.
+ *
+ * @param cache The page cache
+ * @param key The key of the surface
+ * @param surface The surface that has to be cached under the key
+ * @param bytes Additional memory in bytes
+ * @return true if the surface is cached
+ */
+bool zathura_page_cache_charge(zathura_page_cache_t* cache, const
+    zathura_page_cache_key_t* key, cairo_surface_t* surface, size_t bytes);
+
+/**
+ * Removes all surfaces of a page from the cache. The evict function is not
+ * called.
+ *
+ * @param cache The page cache
+ * @param document The tab the page belongs to
+ * @param page The page index
+ */
+void zathura_page_cache_remove_page(zathura_page_cache_t* cache, unsigned int
+    document, unsigned int page);
+
+/**
+ * Removes all surfaces of the pages of a tab from the cache. The evict
+ * function is not called.
+ *
+ * @param cache The page cache
+ * @param document The tab
+ */
+void zathura_page_cache_remove_document(zathura_page_cache_t* cache, unsigned
+    int document);
+
+/**
+ * Removes all surfaces for which the filter function returns true. The evict
+ * function is not called.
+ *
+ * @param cache The page cache
+ * @param filter The filter function
+ * @param data Custom data that is passed to the filter function
+ */
+void zathura_page_cache_remove_matching(zathura_page_cache_t* cache,
+    zathura_page_cache_filter_function_t filter, void* data);
+
+/**
+ * Removes all surfaces from the cache. The evict function is not called.
+ *
+ * @param cache The page cache
+ */
+void zathura_page_cache_clear(zathura_page_cache_t* cache);
+
+/**
+ * Returns the statistics of the cache
+ *
+ * @param cache The page cache
+ * @param statistics Will be set to the current statistics
+ */
+void zathura_page_cache_get_statistics(zathura_page_cache_t* cache,
+    zathura_page_cache_statistics_t* statistics);
+
+#endif // PAGE_CACHE_H
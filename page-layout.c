@@ -0,0 +1,300 @@
+/* See LICENSE file for license and copyright information */
+
+#include <glib.h>
+#include <string.h>
+
+#include "page-layout.h"
+
+struct zathura_page_layout_s {
+  unsigned int number_of_pages; /**< Number of pages */
+  unsigned int* widths; /**< Widths of the pages */
+  unsigned int* heights; /**< Heights of the pages */
+  unsigned int pages_per_row; /**< Number of pages per row */
+  unsigned int first_page_column; /**< Column of the first page */
+  unsigned int padding; /**< Space between the cells */
+  unsigned int cell_width; /**< Width of a cell */
+  unsigned int cell_height; /**< Height of a cell */
+  unsigned int number_of_rows; /**< Number of rows */
+  unsigned int* row_offsets; /**< Top of each row, followed by the end of the last one */
+};
+
+static void
+page_layout_compute_cells(zathura_page_layout_t* layout)
+{
+  layout->cell_width  = 0;
+  layout->cell_height = 0;
+  for (unsigned int page = 0; page < layout->number_of_pages; page++) {
+    layout->cell_width  = MAX(layout->cell_width,  layout->widths[page]);
+    layout->cell_height = MAX(layout->cell_height, layout->heights[page]);
+  }
+}
+
+static void
+page_layout_compute_rows(zathura_page_layout_t* layout)
+{
+  const unsigned int slots = layout->number_of_pages + layout->first_page_column - 1;
+  const unsigned int number_of_rows = layout->number_of_pages == 0 ? 0 :
+    (slots + layout->pages_per_row - 1) / layout->pages_per_row;
+
+  if (number_of_rows != layout->number_of_rows || layout->row_offsets == NULL) {
+    g_free(layout->row_offsets);
+    layout->row_offsets    = g_malloc_n(number_of_rows + 1, sizeof(unsigned int));
+    layout->number_of_rows = number_of_rows;
+  }
+
+  /* prefix sums of the row heights */
+  layout->row_offsets[0] = 0;
+  for (unsigned int row = 0; row < number_of_rows; row++) {
+    layout->row_offsets[row + 1] = layout->row_offsets[row] + layout->cell_height + layout->padding;
+  }
+}
+
+zathura_page_layout_t*
+zathura_page_layout_new(void)
+{
+  zathura_page_layout_t* layout = g_malloc0(sizeof(zathura_page_layout_t));
+  layout->pages_per_row     = 1;
+  layout->first_page_column = 1;
+
+  return layout;
+}
+
+void
+zathura_page_layout_free(zathura_page_layout_t* layout)
+{
+  if (layout == NULL) {
+    return;
+  }
+
+  g_free(layout->widths);
+  g_free(layout->heights);
+  g_free(layout->row_offsets);
+  g_free(layout);
+}
+
+void
+zathura_page_layout_set_mode(zathura_page_layout_t* layout, unsigned int
+    pages_per_row, unsigned int first_page_column)
+{
+  if (layout == NULL) {
+    return;
+  }
+
+  layout->pages_per_row     = MAX(pages_per_row, 1);
+  layout->first_page_column = CLAMP(first_page_column, 1, layout->pages_per_row);
+}
+
+void
+zathura_page_layout_set_padding(zathura_page_layout_t* layout, unsigned int
+    padding)
+{
+  if (layout == NULL) {
+    return;
+  }
+
+  layout->padding = padding;
+}
+
+void
+zathura_page_layout_update(zathura_page_layout_t* layout, unsigned int
+    number_of_pages, const unsigned int* widths, const unsigned int* heights)
+{
+  if (layout == NULL || (number_of_pages != 0 && (widths == NULL || heights == NULL))) {
+    return;
+  }
+
+  if (number_of_pages != layout->number_of_pages) {
+    g_free(layout->widths);
+    g_free(layout->heights);
+    layout->widths  = g_malloc_n(number_of_pages, sizeof(unsigned int));
+    layout->heights = g_malloc_n(number_of_pages, sizeof(unsigned int));
+    layout->number_of_pages = number_of_pages;
+  }
+
+  if (number_of_pages != 0) {
+    memcpy(layout->widths,  widths,  number_of_pages * sizeof(unsigned int));
+    memcpy(layout->heights, heights, number_of_pages * sizeof(unsigned int));
+  }
+
+  page_layout_compute_cells(layout);
+  page_layout_compute_rows(layout);
+}
+
+bool
+zathura_page_layout_set_page_size(zathura_page_layout_t* layout,
+    unsigned int page, unsigned int width, unsigned int height)
+{
+  if (layout == NULL || page >= layout->number_of_pages) {
+    return false;
+  }
+
+  const unsigned int old_width  = layout->widths[page];
+  const unsigned int old_height = layout->heights[page];
+  layout->widths[page]  = width;
+  layout->heights[page] = height;
+
+  const unsigned int cell_width  = layout->cell_width;
+  const unsigned int cell_height = layout->cell_height;
+  if (width > cell_width || height > cell_height) {
+    layout->cell_width  = MAX(cell_width, width);
+    layout->cell_height = MAX(cell_height, height);
+  } else if ((old_width == cell_width && width < old_width) ||
+      (old_height == cell_height && height < old_height)) {
+    /* the page might have been the largest one */
+    page_layout_compute_cells(layout);
+  }
+
+  if (layout->cell_width == cell_width && layout->cell_height == cell_height) {
+    return false;
+  }
+
+  page_layout_compute_rows(layout);
+  return true;
+}
+
+void
+zathura_page_layout_refresh(zathura_page_layout_t* layout)
+{
+  if (layout == NULL) {
+    return;
+  }
+
+  page_layout_compute_cells(layout);
+  page_layout_compute_rows(layout);
+}
+
+bool
+zathura_page_layout_get_page_size(zathura_page_layout_t* layout,
+    unsigned int page, unsigned int* width, unsigned int* height)
+{
+  if (layout == NULL || page >= layout->number_of_pages || width == NULL || height == NULL) {
+    return false;
+  }
+
+  *width  = layout->widths[page];
+  *height = layout->heights[page];
+
+  return true;
+}
+
+unsigned int
+zathura_page_layout_get_number_of_pages(zathura_page_layout_t* layout)
+{
+  if (layout == NULL) {
+    return 0;
+  }
+
+  return layout->number_of_pages;
+}
+
+void
+zathura_page_layout_get_size(zathura_page_layout_t* layout, unsigned int*
+    width, unsigned int* height)
+{
+  if (layout == NULL || width == NULL || height == NULL) {
+    return;
+  }
+
+  if (layout->number_of_rows == 0) {
+    *width  = 0;
+    *height = 0;
+    return;
+  }
+
+  *width  = layout->pages_per_row * (layout->cell_width + layout->padding) - layout->padding;
+  *height = layout->row_offsets[layout->number_of_rows] - layout->padding;
+}
+
+bool
+zathura_page_layout_get_page_position(zathura_page_layout_t* layout,
+    unsigned int page, unsigned int* x, unsigned int* y)
+{
+  if (layout == NULL || page >= layout->number_of_pages || x == NULL || y == NULL) {
+    return false;
+  }
+
+  const unsigned int slot   = page + layout->first_page_column - 1;
+  const unsigned int row    = slot / layout->pages_per_row;
+  const unsigned int column = slot % layout->pages_per_row;
+
+  /* pages are centered in their cells */
+  *x = column * (layout->cell_width + layout->padding) +
+    (layout->cell_width - layout->widths[page]) / 2;
+  *y = layout->row_offsets[row] + (layout->cell_height - layout->heights[page]) / 2;
+
+  return true;
+}
+
+bool
+zathura_page_layout_get_pages_in_range(zathura_page_layout_t* layout,
+    int y, unsigned int height, unsigned int* first, unsigned int* last)
+{
+  if (layout == NULL || first == NULL || last == NULL || layout->number_of_rows == 0) {
+    return false;
+  }
+
+  const gint64 top    = y;
+  const gint64 bottom = top + height;
+  if (height == 0 || bottom <= 0) {
+    return false;
+  }
+
+  /* the first row that ends below the top of the range */
+  unsigned int lower = 0;
+  unsigned int upper = layout->number_of_rows;
+  while (lower < upper) {
+    const unsigned int row = lower + (upper - lower) / 2;
+    if ((gint64) layout->row_offsets[row] + layout->cell_height <= top) {
+      lower = row + 1;
+    } else {
+      upper = row;
+    }
+  }
+  const unsigned int first_row = lower;
+
+  /* the last row that starts above the bottom of the range */
+  lower = first_row;
+  upper = layout->number_of_rows;
+  while (lower < upper) {
+    const unsigned int row = lower + (upper - lower) / 2;
+    if ((gint64) layout->row_offsets[row] < bottom) {
+      lower = row + 1;
+    } else {
+      upper = row;
+    }
+  }
+
+  if (lower == first_row) {
+    return false;
+  }
+  const unsigned int last_row = lower - 1;
+
+  const unsigned int offset = layout->first_page_column - 1;
+  const unsigned int first_slot = first_row * layout->pages_per_row;
+  const unsigned int last_slot  = (last_row + 1) * layout->pages_per_row - 1;
+
+  *first = first_slot > offset ? first_slot - offset : 0;
+  *last  = MIN(last_slot - offset, layout->number_of_pages - 1);
+
+  return true;
+}
+
+bool
+zathura_page_layout_get_row_pages(unsigned int pages_per_row, unsigned int
+    first_page_column, unsigned int number_of_pages, unsigned int page,
+    unsigned int* first, unsigned int* last)
+{
+  if (page >= number_of_pages || first == NULL || last == NULL) {
+    return false;
+  }
+
+  pages_per_row = MAX(pages_per_row, 1);
+  const unsigned int offset = CLAMP(first_page_column, 1, pages_per_row) - 1;
+  const unsigned int row    = (page + offset) / pages_per_row;
+
+  /* the first row starts with empty cells */
+  *first = row == 0 ? 0 : row * pages_per_row - offset;
+  *last  = MIN((row + 1) * pages_per_row - offset, number_of_pages) - 1;
+
+  return true;
+}
@@ -0,0 +1,149 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef PAGE_LAYOUT_H
+#define PAGE_LAYOUT_H
+
+#include <stdbool.h>
+
+typedef struct zathura_page_layout_s zathura_page_layout_t;
+
+/**
+ * Creates a new page layout. Pages are placed in a grid whose cells all have
+ * the size of the largest page; each page is centered in its cell.
+ *
+ * @return The page layout
+ */
+zathura_page_layout_t* zathura_page_layout_new(void);
+
+/**
+ * Frees the page layout
+ *
+ * @param layout The page layout
+ */
+void zathura_page_layout_free(zathura_page_layout_t* layout);
+
+/**
+ * Sets the arrangement of the pages. The positions are updated on the next
+ * call of zathura_page_layout_update.
+ *
+ * @param layout The page layout
+ * @param pages_per_row Number of pages per row
+ * @param first_page_column Column of the first page (starting at 1)
+ */
+void zathura_page_layout_set_mode(zathura_page_layout_t* layout, unsigned int
+    pages_per_row, unsigned int first_page_column);
+
+/**
+ * Sets the space between the pages. The positions are updated on the next
+ * call of zathura_page_layout_update.
+ *
+ * @param layout The page layout
+ * @param padding Space between the cells in pixels
+ */
+void zathura_page_layout_set_padding(zathura_page_layout_t* layout, unsigned
+    int padding);
+
+/**
+ * Computes the positions of all pages
+ *
+ * @param layout The page layout
+ * @param number_of_pages Number of pages
+ * @param widths Widths of the pages in pixels
+ * @param heights Heights of the pages in pixels
+ */
+void zathura_page_layout_update(zathura_page_layout_t* layout, unsigned int
+    number_of_pages, const unsigned int* widths, const unsigned int* heights);
+
+/**
+ * Changes the size of a single page
+ *
+ * @param layout The page layout
+ * @param page The page index
+ * @param width The new width of the page
+ * @param height The new height of the page
+ * @return true if the cell size changed and all pages might have moved
+ */
+bool zathura_page_layout_set_page_size(zathura_page_layout_t* layout,
+    unsigned int page, unsigned int width, unsigned int height);
+
+/**
+ * Computes the positions of all pages again from the sizes that the layout
+ * already knows, e.g. after the arrangement or the padding has changed
+ *
+ * @param layout The page layout
+ */
+void zathura_page_layout_refresh(zathura_page_layout_t* layout);
+
+/**
+ * Returns the size of a page as it is known to the layout
+ *
+ * @param layout The page layout
+ * @param page The page index
+ * @param width Will be set to the width of the page
+ * @param height Will be set to the height of the page
+ * @return false if the page is not part of the layout
+ */
+bool zathura_page_layout_get_page_size(zathura_page_layout_t* layout,
+    unsigned int page, unsigned int* width, unsigned int* height);
+
+/**
+ * Returns the number of pages in the layout
+ *
+ * @param layout The page layout
+ * @return The number of pages
+ */
+unsigned int zathura_page_layout_get_number_of_pages(zathura_page_layout_t* layout);
+
+/**
+ * Returns the size of the whole layout
+ *
+ * @param layout The page layout
+ * @param width Will be set to the width in pixels
+ * @param height Will be set to the height in pixels
+ */
+void zathura_page_layout_get_size(zathura_page_layout_t* layout, unsigned
+    int* width, unsigned int* height);
+
+/**
+ * Returns the position of a page
+ *
+ * @param layout The page layout
+ * @param page The page index
+ * @param x Will be set to the left edge of the page
+ * @param y Will be set to the top edge of the page
+ * @return false if the page is not part of the layout
+ */
+bool zathura_page_layout_get_page_position(zathura_page_layout_t* layout,
+    unsigned int page, unsigned int* x, unsigned int* y);
+
+/**
+ * Returns the pages whose rows intersect with a vertical range of the layout.
+ * The rows are found by binary search over their offsets.
+ *
+ * @param layout The page layout
+ * @param y Top of the range
+ * @param height Height of the range
+ * @param first Will be set to the first page in the range
+ * @param last Will be set to the last page in the range
+ * @return false if no page lies in the range
+ */
+bool zathura_page_layout_get_pages_in_range(zathura_page_layout_t* layout,
+    int y, unsigned int height, unsigned int* first, unsigned int* last);
+
+/**
+ * Returns the pages in the row of a page. The layout itself is not needed,
+ * so that the rows can be determined outside the main thread.
+ *
+ * @param pages_per_row Number of pages per row
+ * @param first_page_column Column of the first page (starting at 1)
+ * @param number_of_pages Number of pages
+ * @param page The page
+ * @param first Will be set to the first page in the row
+ * @param last Will be set to the last page in the row
+ * @return false if the page does not exist
+ */
+bool zathura_page_layout_get_row_pages(unsigned int pages_per_row, unsigned
+    int first_page_column, unsigned int number_of_pages, unsigned int page,
+    unsigned int* first, unsigned int* last);
+
+#endif // PAGE_LAYOUT_H
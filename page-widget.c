@@ -5,6 +5,7 @@
 #include <girara/datastructures.h>
 #include <girara/session.h>
 #include <string.h>
+#include <math.h>
 #include <glib/gi18n.h>
 
 #include "glib-compat.h"
@@ -12,28 +13,57 @@
 #include "page-widget.h"
 #include "page.h"
 #include "render.h"
+#include "selection.h"
 #include "utils.h"
 #include "shortcuts.h"
 #include "synctex.h"
 
 G_DEFINE_TYPE(ZathuraPage, zathura_page_widget, GTK_TYPE_DRAWING_AREA)
 
+/**
+ * A copy on the display server that is charged to the page cache
+ */
+typedef struct upload_charge_s {
+  zathura_page_cache_key_t key; /**< What the rendered surface shows */
+  cairo_surface_t* surface; /**< The rendered surface */
+  size_t bytes; /**< Size of the copy */
+} upload_charge_t;
+
 typedef struct zathura_page_widget_private_s {
   zathura_page_t* page; /**< Page object */
   zathura_t* zathura; /**< Zathura object */
   cairo_surface_t* surface; /**< Cairo surface */
+  zathura_page_cache_key_t surface_key; /**< What the surface shows */
   bool render_requested; /**< No surface and rendering has been requested */
+  gint generation; /**< Render generation of the requests */
   gint64 last_view; /**< Last time the page has been viewed */
+  bool complete; /**< The last draw showed the rendered page */
+  bool upload_unsupported; /**< The display server does not keep surfaces */
+  GArray* uploads; /**< Copies that are charged to the page cache once the lock is released */
   mutex lock; /**< Lock */
 
+  struct {
+    GHashTable* requested; /**< Tiles that have been requested but not rendered yet */
+  } tiles;
+
+  struct {
+    cairo_surface_t* surface; /**< Low resolution surface that is shown until the page has been rendered */
+    bool requested; /**< A preview has been requested */
+  } preview;
+
   struct {
     girara_list_t* list; /**< List of links on the page */
     bool retrieved; /**< True if we already tried to retrieve the list of links */
     bool draw; /**< True if links should be drawn */
     unsigned int offset; /**< Offset to the links */
     unsigned int n; /**< Number */
+    char* font; /**< Font of the link hints or NULL */
   } links;
 
+  struct {
+    gint generation; /**< Render generation links and images have been requested in (-1 if they have not been requested) */
+  } metadata;
+
   struct {
     girara_list_t* list; /**< A list if there are search results that should be drawn */
     int current; /**< The index of the current search result */
@@ -46,6 +76,14 @@ typedef struct zathura_page_widget_private_s {
     zathura_image_t* current; /**< Image data of selected image */
   } images;
 
+  struct {
+    GArray* links; /**< Positions of the links in widget coordinates */
+    GArray* search; /**< Positions of the search results in widget coordinates */
+    double scale; /**< Scale the positions have been computed at */
+    unsigned int rotation; /**< Rotation the positions have been computed at */
+    bool valid; /**< The positions belong to the current links and search results */
+  } overlays;
+
   struct {
     zathura_rectangle_t selection; /**< Region selected with the mouse */
     struct {
@@ -62,13 +100,27 @@ static gboolean zathura_page_widget_draw(GtkWidget* widget, cairo_t* cairo);
 #if GTK_MAJOR_VERSION == 2
 static gboolean zathura_page_widget_expose(GtkWidget* widget, GdkEventExpose* event);
 #endif
+static void zathura_page_widget_dispose(GObject* object);
 static void zathura_page_widget_finalize(GObject* object);
 static void zathura_page_widget_set_property(GObject* object, guint prop_id, const GValue* value, GParamSpec* pspec);
 static void zathura_page_widget_get_property(GObject* object, guint prop_id, GValue* value, GParamSpec* pspec);
 static void zathura_page_widget_size_allocate(GtkWidget* widget, GdkRectangle* allocation);
+static bool zathura_page_widget_invalidate_surface(zathura_page_widget_private_t* priv);
+static bool zathura_page_widget_draw_tiles(zathura_page_widget_private_t* priv, GtkWidget* widget, cairo_t* cairo,
+    unsigned int tile_size);
+static void zathura_page_widget_draw_preview(zathura_page_widget_private_t* priv, GtkWidget* widget, cairo_t* cairo);
 static void redraw_rect(ZathuraPage* widget, zathura_rectangle_t* rectangle);
-static void redraw_all_rects(ZathuraPage* widget, girara_list_t* rectangles);
+static void redraw_all_rects(ZathuraPage* widget, GArray* rectangles);
+static void zathura_page_widget_update_overlays(zathura_page_widget_private_t* priv);
+static cairo_surface_t* zathura_page_widget_get_upload(zathura_page_widget_private_t* priv,
+    GtkWidget* widget, cairo_surface_t* surface, const zathura_page_cache_key_t* key);
+static void zathura_page_widget_charge_uploads(zathura_page_widget_private_t* priv);
+static void upload_init(void);
+static void upload_flush(void);
+static bool rectangle_intersects(const zathura_rectangle_t* rectangle, const zathura_rectangle_t* other);
 static void zathura_page_widget_popup_menu(GtkWidget* widget, GdkEventButton* event);
+static void zathura_page_widget_retrieve_links(zathura_page_widget_private_t* priv);
+static void zathura_page_widget_retrieve_images(zathura_page_widget_private_t* priv);
 static gboolean cb_zathura_page_widget_button_press_event(GtkWidget* widget, GdkEventButton* button);
 static gboolean cb_zathura_page_widget_button_release_event(GtkWidget* widget, GdkEventButton* button);
 static gboolean cb_zathura_page_widget_motion_notify(GtkWidget* widget, GdkEventMotion* event);
@@ -96,6 +148,8 @@ zathura_page_widget_class_init(ZathuraPageClass* class)
   /* add private members */
   g_type_class_add_private(class, sizeof(zathura_page_widget_private_t));
 
+  upload_init();
+
   /* overwrite methods */
   GtkWidgetClass* widget_class = GTK_WIDGET_CLASS(class);
 #if GTK_MAJOR_VERSION == 3
@@ -110,6 +164,7 @@ zathura_page_widget_class_init(ZathuraPageClass* class)
   widget_class->popup_menu           = cb_zathura_page_widget_popup_menu;
 
   GObjectClass* object_class = G_OBJECT_CLASS(class);
+  object_class->dispose      = zathura_page_widget_dispose;
   object_class->finalize     = zathura_page_widget_finalize;
   object_class->set_property = zathura_page_widget_set_property;
   object_class->get_property = zathura_page_widget_get_property;
@@ -144,13 +199,25 @@ zathura_page_widget_init(ZathuraPage* widget)
   priv->page             = NULL;
   priv->surface          = NULL;
   priv->render_requested = false;
+  priv->generation       = 0;
   priv->last_view        = g_get_real_time();
+  priv->complete         = false;
+  priv->tiles.requested  = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+  priv->upload_unsupported = false;
+  priv->uploads            = g_array_new(FALSE, FALSE, sizeof(upload_charge_t));
+
+  priv->preview.surface   = NULL;
+  priv->preview.requested = false;
 
   priv->links.list      = NULL;
   priv->links.retrieved = false;
   priv->links.draw      = false;
   priv->links.offset    = 0;
   priv->links.n         = 0;
+  priv->links.font      = NULL;
+
+  priv->metadata.generation = -1;
 
   priv->search.list    = NULL;
   priv->search.current = INT_MAX;
@@ -160,6 +227,12 @@ zathura_page_widget_init(ZathuraPage* widget)
   priv->images.retrieved = false;
   priv->images.current   = NULL;
 
+  priv->overlays.links    = g_array_new(FALSE, FALSE, sizeof(zathura_rectangle_t));
+  priv->overlays.search   = g_array_new(FALSE, FALSE, sizeof(zathura_rectangle_t));
+  priv->overlays.scale    = 0;
+  priv->overlays.rotation = 0;
+  priv->overlays.valid    = false;
+
   priv->mouse.selection.x1          = -1;
   priv->mouse.selection.y1          = -1;
   priv->mouse.selection_basepoint.x = -1;
@@ -180,6 +253,16 @@ zathura_page_widget_new(zathura_t* zathura, zathura_page_t* page)
   return g_object_new(ZATHURA_TYPE_PAGE, "page", page, "zathura", zathura, NULL);
 }
 
+static void
+zathura_page_widget_dispose(GObject* object)
+{
+  /* the render thread has been stopped before the widgets go away, so no more
+   * copies are released off the main loop */
+  upload_flush();
+
+  G_OBJECT_CLASS(zathura_page_widget_parent_class)->dispose(object);
+}
+
 static void
 zathura_page_widget_finalize(GObject* object)
 {
@@ -190,6 +273,10 @@ zathura_page_widget_finalize(GObject* object)
     cairo_surface_destroy(priv->surface);
   }
 
+  if (priv->preview.surface != NULL) {
+    cairo_surface_destroy(priv->preview.surface);
+  }
+
   if (priv->search.list != NULL) {
     girara_list_free(priv->search.list);
   }
@@ -197,6 +284,16 @@ zathura_page_widget_finalize(GObject* object)
   if (priv->links.list != NULL) {
     girara_list_free(priv->links.list);
   }
+  g_free(priv->links.font);
+
+  if (priv->images.list != NULL) {
+    girara_list_free(priv->images.list);
+  }
+
+  g_hash_table_destroy(priv->tiles.requested);
+  g_array_free(priv->uploads, TRUE);
+  g_array_free(priv->overlays.links, TRUE);
+  g_array_free(priv->overlays.search, TRUE);
 
   mutex_free(&(priv->lock));
 
@@ -211,60 +308,72 @@ zathura_page_widget_set_property(GObject* object, guint prop_id, const GValue* v
 
   switch (prop_id) {
     case PROP_PAGE:
-      priv->page = g_value_get_pointer(value);
+      priv->page           = g_value_get_pointer(value);
+      priv->overlays.valid = false;
       break;
     case PROP_ZATHURA:
       priv->zathura = g_value_get_pointer(value);
       break;
-    case PROP_DRAW_LINKS:
-      priv->links.draw = g_value_get_boolean(value);
+    case PROP_DRAW_LINKS: {
+      const bool draw = g_value_get_boolean(value);
+      /* pages that do not show their links are not drawn again when link
+       * hints are hidden on all pages */
+      const bool changed = draw != priv->links.draw;
+      priv->links.draw = draw;
+      /* the font is girara's setting, which does not tell zathura about
+       * changes, so it is read whenever the link hints are shown */
+      if (changed == true && draw == true) {
+        g_free(priv->links.font);
+        priv->links.font = NULL;
+        girara_setting_get(priv->zathura->ui.session, "font", &priv->links.font);
+      }
       /* get links */
       if (priv->links.draw == true && priv->links.retrieved == false) {
-        priv->links.list      = zathura_page_links_get(priv->page, NULL);
-        priv->links.retrieved = true;
-        priv->links.n         = (priv->links.list == NULL) ? 0 : girara_list_size(priv->links.list);
+        zathura_page_widget_retrieve_links(priv);
       }
 
-      if (priv->links.retrieved == true && priv->links.list != NULL) {
-        GIRARA_LIST_FOREACH(priv->links.list, zathura_link_t*, iter, link)
-        if (link != NULL) {
-          zathura_rectangle_t rectangle = recalc_rectangle(priv->page, zathura_link_get_position(link));
-          redraw_rect(pageview, &rectangle);
-        }
-        GIRARA_LIST_FOREACH_END(priv->links.list, zathura_link_t*, iter, link);
+      if (changed == true && priv->links.retrieved == true && priv->links.list != NULL) {
+        zathura_page_widget_update_overlays(priv);
+        redraw_all_rects(pageview, priv->overlays.links);
       }
       break;
+    }
     case PROP_LINKS_OFFSET:
       priv->links.offset = g_value_get_int(value);
       break;
     case PROP_SEARCH_RESULTS:
-      if (priv->search.list != NULL && priv->search.draw) {
-        redraw_all_rects(pageview, priv->search.list);
+      if (priv->search.list != NULL) {
+        if (priv->search.draw) {
+          zathura_page_widget_update_overlays(priv);
+          redraw_all_rects(pageview, priv->overlays.search);
+        }
         girara_list_free(priv->search.list);
       }
-      priv->search.list = g_value_get_pointer(value);
+      priv->search.list    = g_value_get_pointer(value);
+      priv->overlays.valid = false;
       if (priv->search.list != NULL && priv->search.draw) {
         priv->links.draw = false;
-        redraw_all_rects(pageview, priv->search.list);
+        zathura_page_widget_update_overlays(priv);
+        redraw_all_rects(pageview, priv->overlays.search);
       }
       priv->search.current = -1;
       break;
     case PROP_SEARCH_RESULTS_CURRENT: {
       g_return_if_fail(priv->search.list != NULL);
-      if (priv->search.current >= 0 && priv->search.current < (signed) girara_list_size(priv->search.list)) {
-        zathura_rectangle_t* rect = girara_list_nth(priv->search.list, priv->search.current);
-        zathura_rectangle_t rectangle = recalc_rectangle(priv->page, *rect);
-        redraw_rect(pageview, &rectangle);
+      /* only the previous and the new current result change their color */
+      zathura_page_widget_update_overlays(priv);
+      GArray* search = priv->overlays.search;
+      if (priv->search.current >= 0 && priv->search.current < (signed) search->len &&
+          priv->search.draw) {
+        redraw_rect(pageview, &g_array_index(search, zathura_rectangle_t, priv->search.current));
       }
       int val = g_value_get_int(value);
       if (val < 0) {
         priv->search.current = girara_list_size(priv->search.list);
       } else {
         priv->search.current = val;
-        zathura_rectangle_t* rect = girara_list_nth(priv->search.list, priv->search.current);
-        zathura_rectangle_t rectangle = recalc_rectangle(priv->page, *rect);
-        if (priv->search.draw) {
-          redraw_rect(pageview, &rectangle);
+        if (val < (signed) search->len && priv->search.draw) {
+          redraw_rect(pageview, &g_array_index(search, zathura_rectangle_t, val));
         }
       }
       break;
@@ -342,7 +451,48 @@ zathura_page_widget_draw(GtkWidget* widget, cairo_t* cairo)
   const unsigned int page_width  = gtk_widget_get_allocated_width(widget);
 #endif
 
-  if (priv->surface != NULL) {
+  /* large pages can be rendered in tiles */
+  unsigned int tile_size = render_get_tile_size(priv->zathura->sync.render_thread);
+  if (page_width <= tile_size && page_height <= tile_size) {
+    tile_size = 0;
+  }
+
+  /* pages that are not larger than a thumbnail, e.g. in the overview, show
+   * their thumbnail instead of being rendered */
+  const unsigned int thumbnail_size = render_get_thumbnail_size(priv->zathura->sync.render_thread);
+  const bool thumbnail = thumbnail_size != 0 && page_width <= thumbnail_size &&
+    page_height <= thumbnail_size;
+  if (thumbnail == true) {
+    tile_size = 0;
+  }
+
+  /* while zooming the old surfaces are shown scaled */
+  const bool deferred = render_is_deferred(priv->zathura->sync.render_thread);
+
+  /* the scale or the recolor state might have changed without a new
+   * allocation */
+  zathura_page_widget_invalidate_surface(priv);
+
+  /* requests of an earlier generation have been dropped by render_all */
+  const gint generation = render_get_generation(priv->zathura->sync.render_thread);
+  if (priv->generation != generation) {
+    priv->generation = generation;
+    if (priv->surface == NULL) {
+      priv->render_requested = false;
+    }
+    priv->preview.requested = false;
+    g_hash_table_remove_all(priv->tiles.requested);
+  }
+
+  /* reuse a previously rendered surface if possible */
+  if (tile_size == 0 && priv->surface == NULL && priv->render_requested == false) {
+    zathura_page_cache_key_t key;
+    render_get_cache_key(priv->zathura, priv->page, &key);
+    priv->surface     = zathura_page_cache_get(priv->zathura->page_cache, &key);
+    priv->surface_key = key;
+  }
+
+  if (priv->surface != NULL || priv->preview.surface != NULL || tile_size != 0) {
     cairo_save(cairo);
 
     unsigned int rotation = zathura_document_get_rotation(document);
@@ -362,29 +512,45 @@ zathura_page_widget_draw(GtkWidget* widget, cairo_t* cairo)
       cairo_rotate(cairo, rotation * G_PI / 180.0);
     }
 
-    cairo_set_source_surface(cairo, priv->surface, 0, 0);
-    cairo_paint(cairo);
+    if (tile_size != 0) {
+      priv->complete = zathura_page_widget_draw_tiles(priv, widget, cairo, tile_size);
+    } else if (priv->surface != NULL) {
+      cairo_set_source_surface(cairo, zathura_page_widget_get_upload(priv, widget, priv->surface, &priv->surface_key), 0, 0);
+      cairo_paint(cairo);
+      priv->complete = true;
+    } else {
+      zathura_page_widget_draw_preview(priv, widget, cairo);
+      /* a thumbnail is all that is shown of small pages */
+      priv->complete = thumbnail == true;
+    }
     cairo_restore(cairo);
 
-    /* draw rectangles */
-    char* font = NULL;
-    girara_setting_get(priv->zathura->ui.session, "font", &font);
+    /* draw rectangles; only the ones that intersect the damaged region are
+     * filled */
+    const float transparency = priv->zathura->ui.highlight_transparency;
 
-    float transparency = 0.5;
-    girara_setting_get(priv->zathura->ui.session, "highlight-transparency", &transparency);
+    double clip_x1 = 0, clip_y1 = 0, clip_x2 = 0, clip_y2 = 0;
+    cairo_clip_extents(cairo, &clip_x1, &clip_y1, &clip_x2, &clip_y2);
+    const zathura_rectangle_t clip = { clip_x1, clip_y1, clip_x2, clip_y2 };
 
-    if (font != NULL) {
-      cairo_select_font_face(cairo, font, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    const bool draw_links  = priv->links.draw == true && priv->links.n != 0;
+    const bool draw_search = priv->search.list != NULL && priv->search.draw == true;
+    if (draw_links == true || draw_search == true) {
+      zathura_page_widget_update_overlays(priv);
     }
 
-    g_free(font);
-
     /* draw links */
-    if (priv->links.draw == true && priv->links.n != 0) {
-      unsigned int link_counter = 0;
-      GIRARA_LIST_FOREACH(priv->links.list, zathura_link_t*, iter, link)
-      if (link != NULL) {
-        zathura_rectangle_t rectangle = recalc_rectangle(priv->page, zathura_link_get_position(link));
+    if (draw_links == true) {
+      if (priv->links.font != NULL) {
+        cairo_select_font_face(cairo, priv->links.font, CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+      }
+
+      for (unsigned int i = 0; i < priv->overlays.links->len; i++) {
+        const zathura_rectangle_t rectangle = g_array_index(priv->overlays.links, zathura_rectangle_t, i);
+        /* links outside of the damaged region keep their number */
+        if (rectangle_intersects(&rectangle, &clip) == false) {
+          continue;
+        }
 
         /* draw position */
         GdkColor color = priv->zathura->ui.colors.highlight_color;
@@ -397,32 +563,32 @@ zathura_page_widget_draw(GtkWidget* widget, cairo_t* cairo)
         cairo_set_source_rgba(cairo, 0, 0, 0, 1);
         cairo_set_font_size(cairo, 10);
         cairo_move_to(cairo, rectangle.x1 + 1, rectangle.y2 - 1);
-        char* link_number = g_strdup_printf("%i", priv->links.offset + ++link_counter);
+        char* link_number = g_strdup_printf("%i", priv->links.offset + i + 1);
         cairo_show_text(cairo, link_number);
         g_free(link_number);
       }
-      GIRARA_LIST_FOREACH_END(priv->links.list, zathura_link_t*, iter, link);
     }
 
     /* draw search results */
-    if (priv->search.list != NULL && priv->search.draw == true) {
-      int idx = 0;
-      GIRARA_LIST_FOREACH(priv->search.list, zathura_rectangle_t*, iter, rect)
-      zathura_rectangle_t rectangle = recalc_rectangle(priv->page, *rect);
-
-      /* draw position */
-      if (idx == priv->search.current) {
-        GdkColor color = priv->zathura->ui.colors.highlight_color_active;
-        cairo_set_source_rgba(cairo, color.red/65535.0, color.green/65535.0, color.blue/65535.0, transparency);
-      } else {
-        GdkColor color = priv->zathura->ui.colors.highlight_color;
-        cairo_set_source_rgba(cairo, color.red/65535.0, color.green/65535.0, color.blue/65535.0, transparency);
+    if (draw_search == true) {
+      for (unsigned int i = 0; i < priv->overlays.search->len; i++) {
+        const zathura_rectangle_t rectangle = g_array_index(priv->overlays.search, zathura_rectangle_t, i);
+        if (rectangle_intersects(&rectangle, &clip) == false) {
+          continue;
+        }
+
+        /* draw position */
+        if ((int) i == priv->search.current) {
+          GdkColor color = priv->zathura->ui.colors.highlight_color_active;
+          cairo_set_source_rgba(cairo, color.red/65535.0, color.green/65535.0, color.blue/65535.0, transparency);
+        } else {
+          GdkColor color = priv->zathura->ui.colors.highlight_color;
+          cairo_set_source_rgba(cairo, color.red/65535.0, color.green/65535.0, color.blue/65535.0, transparency);
+        }
+        cairo_rectangle(cairo, rectangle.x1, rectangle.y1,
+                        (rectangle.x2 - rectangle.x1), (rectangle.y2 - rectangle.y1));
+        cairo_fill(cairo);
       }
-      cairo_rectangle(cairo, rectangle.x1, rectangle.y1,
-                      (rectangle.x2 - rectangle.x1), (rectangle.y2 - rectangle.y1));
-      cairo_fill(cairo);
-      ++idx;
-      GIRARA_LIST_FOREACH_END(priv->search.list, zathura_rectangle_t*, iter, rect);
     }
     /* draw selection */
     if (priv->mouse.selection.y2 != -1 && priv->mouse.selection.x2 != -1) {
@@ -432,7 +598,16 @@ zathura_page_widget_draw(GtkWidget* widget, cairo_t* cairo)
                       (priv->mouse.selection.x2 - priv->mouse.selection.x1), (priv->mouse.selection.y2 - priv->mouse.selection.y1));
       cairo_fill(cairo);
     }
+
+    /* only the preview has been drawn so far */
+    if (tile_size == 0 && thumbnail == false && priv->surface == NULL && priv->render_requested == false &&
+        deferred == false) {
+      priv->render_requested = true;
+      render_page(priv->zathura->sync.render_thread, priv->page);
+    }
   } else {
+    priv->complete = false;
+
     /* set background color */
     if (priv->zathura->global.recolor == true) {
       GdkColor color = priv->zathura->ui.colors.recolor_light_color;
@@ -444,11 +619,8 @@ zathura_page_widget_draw(GtkWidget* widget, cairo_t* cairo)
     cairo_rectangle(cairo, 0, 0, page_width, page_height);
     cairo_fill(cairo);
 
-    bool render_loading = true;
-    girara_setting_get(priv->zathura->ui.session, "render-loading", &render_loading);
-
     /* write text */
-    if (render_loading == true) {
+    if (priv->zathura->ui.render_loading == true) {
       if (priv->zathura->global.recolor == true) {
         GdkColor color = priv->zathura->ui.colors.recolor_dark_color;
         cairo_set_source_rgb(cairo, color.red/65535.0, color.green/65535.0, color.blue/65535.0);
@@ -468,16 +640,287 @@ zathura_page_widget_draw(GtkWidget* widget, cairo_t* cairo)
       cairo_show_text(cairo, text);
     }
 
-    /* render real page */
-    if (priv->render_requested == false) {
+    /* render a preview first and the real page afterwards */
+    if (thumbnail == true) {
+      if (priv->preview.requested == false) {
+        priv->preview.requested = render_page_thumbnail(priv->zathura->sync.render_thread, priv->page);
+      }
+    } else if (priv->render_requested == false && deferred == false) {
       priv->render_requested = true;
+      if (priv->preview.requested == false) {
+        priv->preview.requested = render_page_preview(priv->zathura->sync.render_thread, priv->page);
+      }
       render_page(priv->zathura->sync.render_thread, priv->page);
     }
   }
+
+  /* report how long changing the slide took until it has been shown */
+  zathura_t* zathura = priv->zathura;
+  if (priv->complete == true && zathura->presentation.flip_start != 0 &&
+      zathura_page_get_index(priv->page) == zathura->presentation.flip_page) {
+    const gint64 duration = g_get_monotonic_time() - zathura->presentation.flip_start;
+    zathura_stats_add(zathura->stats, ZATHURA_STAT_FLIP, duration);
+    girara_debug("slide %u shown %.2f ms after it has been requested",
+        zathura->presentation.flip_page + 1, duration / 1000.0);
+    zathura->presentation.flip_start = 0;
+  }
   mutex_unlock(&(priv->lock));
+
+  zathura_page_widget_charge_uploads(priv);
   return FALSE;
 }
 
+static void
+zathura_page_widget_draw_preview(zathura_page_widget_private_t* priv, GtkWidget* widget, cairo_t* cairo)
+{
+  if (priv->preview.surface == NULL) {
+    return;
+  }
+
+  const int width  = cairo_image_surface_get_width(priv->preview.surface);
+  const int height = cairo_image_surface_get_height(priv->preview.surface);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  unsigned int page_width  = 0;
+  unsigned int page_height = 0;
+  page_calc_height_width(priv->page, &page_height, &page_width, false);
+
+  /* stretch the preview over the unrotated page */
+  cairo_save(cairo);
+  cairo_scale(cairo, (double) page_width / width, (double) page_height / height);
+  cairo_set_source_surface(cairo, zathura_page_widget_get_upload(priv, widget, priv->preview.surface, NULL), 0, 0);
+  cairo_paint(cairo);
+  cairo_restore(cairo);
+}
+
+static bool
+zathura_page_widget_draw_tiles(zathura_page_widget_private_t* priv, GtkWidget* widget, cairo_t* cairo,
+    unsigned int tile_size)
+{
+  unsigned int page_width  = 0;
+  unsigned int page_height = 0;
+  page_calc_height_width(priv->page, &page_height, &page_width, false);
+
+  /* the context is already rotated, so the clip extents are the exposed part
+   * of the unrotated page */
+  double x1, y1, x2, y2;
+  cairo_clip_extents(cairo, &x1, &y1, &x2, &y2);
+
+  const unsigned int columns = (page_width  + tile_size - 1) / tile_size;
+  const unsigned int rows    = (page_height + tile_size - 1) / tile_size;
+  const unsigned int first_column = x1 > 0 ? x1 / tile_size : 0;
+  const unsigned int first_row    = y1 > 0 ? y1 / tile_size : 0;
+  const unsigned int last_column  = x2 > 0 ? MIN(columns, ceil(x2 / tile_size)) : 0;
+  const unsigned int last_row     = y2 > 0 ? MIN(rows, ceil(y2 / tile_size)) : 0;
+
+  /* while zooming the old surfaces are shown scaled */
+  const bool deferred = render_is_deferred(priv->zathura->sync.render_thread);
+
+  /* missing tiles show the preview if there is one */
+  if (priv->preview.surface != NULL) {
+    zathura_page_widget_draw_preview(priv, widget, cairo);
+  } else if (priv->preview.requested == false && deferred == false) {
+    priv->preview.requested = render_page_preview(priv->zathura->sync.render_thread, priv->page);
+  }
+
+  zathura_page_cache_key_t key;
+  render_get_cache_key(priv->zathura, priv->page, &key);
+
+  bool complete = true;
+  for (unsigned int row = first_row; row < last_row; row++) {
+    for (unsigned int column = first_column; column < last_column; column++) {
+      key.tile = row * columns + column + 1;
+      const double x = column * tile_size;
+      const double y = row * tile_size;
+
+      cairo_surface_t* surface = NULL;
+      const bool requested = g_hash_table_lookup(priv->tiles.requested, GUINT_TO_POINTER(key.tile)) != NULL;
+      if (requested == false) {
+        surface = zathura_page_cache_get(priv->zathura->page_cache, &key);
+      }
+
+      if (surface != NULL) {
+        cairo_set_source_surface(cairo, zathura_page_widget_get_upload(priv, widget, surface, &key), x, y);
+        cairo_paint(cairo);
+        cairo_surface_destroy(surface);
+        continue;
+      }
+      complete = false;
+
+      /* placeholder until the tile has been rendered */
+      if (priv->preview.surface == NULL) {
+        GdkColor color = priv->zathura->global.recolor == true ?
+          priv->zathura->ui.colors.recolor_light_color : priv->zathura->ui.colors.render_loading_bg;
+        cairo_set_source_rgb(cairo, color.red/65535.0, color.green/65535.0, color.blue/65535.0);
+        cairo_rectangle(cairo, x, y, MIN(tile_size, page_width - x), MIN(tile_size, page_height - y));
+        cairo_fill(cairo);
+      }
+
+      if (requested == false && deferred == false) {
+        g_hash_table_insert(priv->tiles.requested, GUINT_TO_POINTER(key.tile), GUINT_TO_POINTER(key.tile));
+        render_page_tile(priv->zathura->sync.render_thread, priv->page, key.tile);
+      }
+    }
+  }
+
+  return complete;
+}
+
+/* the copy on the display server is attached to the rendered surface, so it
+ * is shared by every user of the surface and goes away with it */
+static const cairo_user_data_key_t upload_key;
+
+/* rendered surfaces are also released by the render thread, but the display
+ * connection is only used by the main loop; copies released elsewhere wait
+ * here until the main loop destroys them */
+G_LOCK_DEFINE_STATIC(upload);
+static GThread* upload_main_thread = NULL;
+static GSList* upload_pending = NULL;
+static guint upload_source = 0;
+
+static void
+upload_init(void)
+{
+  /* the class is initialized by the main loop */
+  upload_main_thread = g_thread_self();
+}
+
+static void
+upload_flush(void)
+{
+  G_LOCK(upload);
+  GSList* pending = upload_pending;
+  upload_pending  = NULL;
+  if (upload_source != 0) {
+    g_source_remove(upload_source);
+    upload_source = 0;
+  }
+  G_UNLOCK(upload);
+
+  g_slist_free_full(pending, (GDestroyNotify) cairo_surface_destroy);
+}
+
+static gboolean
+cb_upload_destroy(gpointer UNUSED(data))
+{
+  G_LOCK(upload);
+  upload_source = 0;
+  G_UNLOCK(upload);
+
+  upload_flush();
+  return FALSE;
+}
+
+static void
+upload_destroy(void* data)
+{
+  if (g_thread_self() == upload_main_thread) {
+    cairo_surface_destroy(data);
+    return;
+  }
+
+  G_LOCK(upload);
+  upload_pending = g_slist_prepend(upload_pending, data);
+  if (upload_source == 0) {
+    upload_source = gdk_threads_add_idle(cb_upload_destroy, NULL);
+  }
+  G_UNLOCK(upload);
+}
+
+/* returns the copy of a rendered surface on the display server, which is
+ * created the first time the surface is drawn and counted against the budget
+ * of the page cache; the surface itself is returned if there is no such copy
+ * or the surface is not cached under the key */
+static cairo_surface_t*
+zathura_page_widget_get_upload(zathura_page_widget_private_t* priv, GtkWidget* widget,
+    cairo_surface_t* surface, const zathura_page_cache_key_t* key)
+{
+  if (priv->zathura->ui.upload_pages == false || priv->upload_unsupported == true ||
+      key == NULL || cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE) {
+    return surface;
+  }
+
+  cairo_surface_t* upload = cairo_surface_get_user_data(surface, &upload_key);
+  if (upload != NULL) {
+    return upload;
+  }
+
+  /* visible pages keep showing surfaces that have been evicted; their copy
+   * would be thrown away after every draw */
+  if (zathura_page_cache_contains(priv->zathura->page_cache, key) == false) {
+    return surface;
+  }
+
+  GdkWindow* window = gtk_widget_get_window(widget);
+  if (window == NULL) {
+    return surface;
+  }
+
+  const int width  = cairo_image_surface_get_width(surface);
+  const int height = cairo_image_surface_get_height(surface);
+  if (width <= 0 || height <= 0) {
+    return surface;
+  }
+
+  upload = gdk_window_create_similar_surface(window, cairo_surface_get_content(surface), width, height);
+  if (cairo_surface_status(upload) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(upload);
+    return surface;
+  }
+
+  /* backends that keep surfaces in client memory would only copy the page */
+  if (cairo_surface_get_type(upload) == CAIRO_SURFACE_TYPE_IMAGE) {
+    girara_debug("display server does not keep surfaces, drawing rendered pages directly");
+    cairo_surface_destroy(upload);
+    priv->upload_unsupported = true;
+    return surface;
+  }
+
+  cairo_t* cairo = cairo_create(upload);
+  cairo_set_operator(cairo, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_surface(cairo, surface, 0, 0);
+  cairo_paint(cairo);
+  cairo_destroy(cairo);
+
+  if (cairo_surface_set_user_data(surface, &upload_key, upload, upload_destroy) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(upload);
+    return surface;
+  }
+
+  /* charging the cache might evict surfaces of this page, which takes the
+   * lock of the widget */
+  upload_charge_t charge = {
+    .key     = *key,
+    .surface = cairo_surface_reference(surface),
+    .bytes   = (size_t) cairo_image_surface_get_stride(surface) * height
+  };
+  g_array_append_val(priv->uploads, charge);
+
+  return upload;
+}
+
+/* counts the copies that have been created while drawing against the budget
+ * of the page cache; has to be called without the lock held */
+static void
+zathura_page_widget_charge_uploads(zathura_page_widget_private_t* priv)
+{
+  /* only the main loop draws, so the array is not shared */
+  for (unsigned int i = 0; i < priv->uploads->len; i++) {
+    upload_charge_t* charge = &g_array_index(priv->uploads, upload_charge_t, i);
+    if (zathura_page_cache_charge(priv->zathura->page_cache, &charge->key,
+          charge->surface, charge->bytes) == false) {
+      /* surfaces that are not cached anymore are about to go away */
+      cairo_surface_set_user_data(charge->surface, &upload_key, NULL, NULL);
+    } else {
+      zathura_stats_count(priv->zathura->stats, ZATHURA_COUNTER_SURFACE_UPLOADED);
+    }
+    cairo_surface_destroy(charge->surface);
+  }
+  g_array_set_size(priv->uploads, 0);
+}
+
 static void
 zathura_page_widget_redraw_canvas(ZathuraPage* pageview)
 {
@@ -486,16 +929,28 @@ zathura_page_widget_redraw_canvas(ZathuraPage* pageview)
 }
 
 void
-zathura_page_widget_update_surface(ZathuraPage* widget, cairo_surface_t* surface)
+zathura_page_widget_update_surface(ZathuraPage* widget, cairo_surface_t*
+    surface, const zathura_page_cache_key_t* key)
 {
   zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
   mutex_lock(&(priv->lock));
   if (priv->surface != NULL) {
-    cairo_surface_finish(priv->surface);
+    /* the surface might still be referenced by the page cache */
     cairo_surface_destroy(priv->surface);
   }
   priv->render_requested = false;
   priv->surface = surface;
+  if (surface == NULL) {
+    priv->complete = false;
+  } else if (key != NULL) {
+    priv->surface_key = *key;
+  }
+  /* the preview is not needed anymore once the page has been rendered */
+  if (surface != NULL && priv->preview.surface != NULL) {
+    cairo_surface_destroy(priv->preview.surface);
+    priv->preview.surface = NULL;
+  }
+  priv->preview.requested = false;
   mutex_unlock(&(priv->lock));
   /* force a redraw here */
   if (priv->surface != NULL) {
@@ -503,38 +958,195 @@ zathura_page_widget_update_surface(ZathuraPage* widget, cairo_surface_t* surface
   }
 }
 
+void
+zathura_page_widget_update_preview(ZathuraPage* widget, cairo_surface_t* surface)
+{
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+  mutex_lock(&(priv->lock));
+  /* the real page has been rendered already */
+  if (priv->surface != NULL) {
+    mutex_unlock(&(priv->lock));
+    if (surface != NULL) {
+      cairo_surface_destroy(surface);
+    }
+    return;
+  }
+
+  if (priv->preview.surface != NULL) {
+    cairo_surface_destroy(priv->preview.surface);
+  }
+  priv->preview.surface = surface;
+  mutex_unlock(&(priv->lock));
+
+  if (surface != NULL) {
+    zathura_page_widget_redraw_canvas(widget);
+  }
+}
+
+void
+zathura_page_widget_update_tile(ZathuraPage* widget, unsigned int tile)
+{
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+  mutex_lock(&(priv->lock));
+  g_hash_table_remove(priv->tiles.requested, GUINT_TO_POINTER(tile));
+  mutex_unlock(&(priv->lock));
+
+  zathura_page_widget_redraw_canvas(widget);
+}
+
+void
+zathura_page_widget_release_surface(ZathuraPage* widget, cairo_surface_t* surface)
+{
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+  mutex_lock(&(priv->lock));
+  if (priv->surface != NULL && priv->surface == surface) {
+    cairo_surface_destroy(priv->surface);
+    priv->surface = NULL;
+    priv->render_requested = false;
+    priv->complete = false;
+  }
+  mutex_unlock(&(priv->lock));
+}
+
+void
+zathura_page_widget_release_uncached(ZathuraPage* widget)
+{
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+  mutex_lock(&(priv->lock));
+  if (priv->surface != NULL &&
+      zathura_page_cache_contains(priv->zathura->page_cache, &priv->surface_key) == false) {
+    cairo_surface_destroy(priv->surface);
+    priv->surface = NULL;
+    priv->render_requested = false;
+    priv->complete = false;
+  }
+  mutex_unlock(&(priv->lock));
+}
+
+/* forgets the surface if it does not show the page at the current scale and
+ * recolor state anymore; has to be called with the lock held */
+static bool
+zathura_page_widget_invalidate_surface(zathura_page_widget_private_t* priv)
+{
+  if (priv->surface == NULL) {
+    return false;
+  }
+
+  zathura_page_cache_key_t key;
+  render_get_cache_key(priv->zathura, priv->page, &key);
+  if (key.scale == priv->surface_key.scale && key.recolor == priv->surface_key.recolor) {
+    return false;
+  }
+
+  /* keep showing the old surface scaled to the new size until the page has
+   * been rendered again; hidden pages do not need it */
+  if (zathura_page_get_visibility(priv->page) == true) {
+    if (priv->preview.surface != NULL) {
+      cairo_surface_destroy(priv->preview.surface);
+    }
+    priv->preview.surface = priv->surface;
+  } else {
+    cairo_surface_destroy(priv->surface);
+  }
+  priv->surface           = NULL;
+  priv->render_requested  = false;
+  priv->preview.requested = false;
+  priv->complete          = false;
+
+  /* tiles of the old scale are not needed anymore */
+  g_hash_table_remove_all(priv->tiles.requested);
+
+  return true;
+}
+
 static void
 zathura_page_widget_size_allocate(GtkWidget* widget, GdkRectangle* allocation)
 {
   GTK_WIDGET_CLASS(zathura_page_widget_parent_class)->size_allocate(widget, allocation);
-  zathura_page_widget_update_surface(ZATHURA_PAGE(widget), NULL);
+
+  /* widgets are moved, attached again and re-laid out, e.g. if the statusbar
+   * is toggled; the rendered page is only outdated if it has been rendered
+   * at another scale or recolor state */
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+  mutex_lock(&(priv->lock));
+  if (priv->surface != NULL) {
+    const bool invalidated = zathura_page_widget_invalidate_surface(priv);
+    zathura_stats_count(priv->zathura->stats, invalidated == true ?
+        ZATHURA_COUNTER_SURFACE_INVALIDATED : ZATHURA_COUNTER_SURFACE_KEPT);
+  }
+  mutex_unlock(&(priv->lock));
+}
+
+static bool
+rectangle_intersects(const zathura_rectangle_t* rectangle, const zathura_rectangle_t* other)
+{
+  return rectangle->x1 <= other->x2 && other->x1 <= rectangle->x2 &&
+    rectangle->y1 <= other->y2 && other->y1 <= rectangle->y2;
+}
+
+static void
+zathura_page_widget_update_overlays(zathura_page_widget_private_t* priv)
+{
+  zathura_document_t* document = zathura_page_get_document(priv->page);
+  const double scale          = zathura_document_get_scale(document);
+  const unsigned int rotation = zathura_document_get_rotation(document);
+
+  /* the positions only change with the lists, the scale and the rotation */
+  if (priv->overlays.valid == true && priv->overlays.scale == scale &&
+      priv->overlays.rotation == rotation) {
+    return;
+  }
+
+  g_array_set_size(priv->overlays.links, 0);
+  if (priv->links.list != NULL) {
+    GIRARA_LIST_FOREACH(priv->links.list, zathura_link_t*, iter, link)
+    if (link != NULL) {
+      zathura_rectangle_t rectangle = recalc_rectangle(priv->page, zathura_link_get_position(link));
+      g_array_append_val(priv->overlays.links, rectangle);
+    }
+    GIRARA_LIST_FOREACH_END(priv->links.list, zathura_link_t*, iter, link);
+  }
+
+  g_array_set_size(priv->overlays.search, 0);
+  if (priv->search.list != NULL) {
+    GIRARA_LIST_FOREACH(priv->search.list, zathura_rectangle_t*, iter, rect)
+    zathura_rectangle_t rectangle = recalc_rectangle(priv->page, *rect);
+    g_array_append_val(priv->overlays.search, rectangle);
+    GIRARA_LIST_FOREACH_END(priv->search.list, zathura_rectangle_t*, iter, rect);
+  }
+
+  priv->overlays.scale    = scale;
+  priv->overlays.rotation = rotation;
+  priv->overlays.valid    = true;
 }
 
 static void
 redraw_rect(ZathuraPage* widget, zathura_rectangle_t* rectangle)
 {
-  /* cause the rect to be drawn */
+  /* cause the rect to be drawn; the area covers every pixel the rectangle
+   * touches */
   GdkRectangle grect;
-  grect.x = rectangle->x1;
-  grect.y = rectangle->y1;
-  grect.width  = (rectangle->x2 + 1) - rectangle->x1;
-  grect.height = (rectangle->y2 + 1) - rectangle->y1;
+  grect.x = floor(rectangle->x1);
+  grect.y = floor(rectangle->y1);
+  grect.width  = ceil(rectangle->x2) + 1 - grect.x;
+  grect.height = ceil(rectangle->y2) + 1 - grect.y;
 #if (GTK_MAJOR_VERSION == 3)
   gtk_widget_queue_draw_area(GTK_WIDGET(widget), grect.x, grect.y, grect.width, grect.height);
 #else
-  gdk_window_invalidate_rect(gtk_widget_get_window(GTK_WIDGET(widget)), &grect, TRUE);
+  /* detached pages are drawn completely once they are attached again */
+  GdkWindow* window = gtk_widget_get_window(GTK_WIDGET(widget));
+  if (window != NULL) {
+    gdk_window_invalidate_rect(window, &grect, TRUE);
+  }
 #endif
 }
 
 static void
-redraw_all_rects(ZathuraPage* widget, girara_list_t* rectangles)
+redraw_all_rects(ZathuraPage* widget, GArray* rectangles)
 {
-  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
-
-  GIRARA_LIST_FOREACH(rectangles, zathura_rectangle_t*, iter, rect)
-  zathura_rectangle_t rectangle = recalc_rectangle(priv->page, *rect);
-  redraw_rect(widget, &rectangle);
-  GIRARA_LIST_FOREACH_END(rectangles, zathura_recantgle_t*, iter, rect);
+  for (unsigned int i = 0; i < rectangles->len; i++) {
+    redraw_rect(widget, &g_array_index(rectangles, zathura_rectangle_t, i));
+  }
 }
 
 zathura_link_t*
@@ -610,9 +1222,7 @@ cb_zathura_page_widget_button_release_event(GtkWidget* widget, GdkEventButton* b
     /* simple single click */
     /* get links */
     if (priv->links.retrieved == false) {
-      priv->links.list      = zathura_page_links_get(priv->page, NULL);
-      priv->links.retrieved = true;
-      priv->links.n         = (priv->links.list == NULL) ? 0 : girara_list_size(priv->links.list);
+      zathura_page_widget_retrieve_links(priv);
     }
 
     if (priv->links.list != NULL && priv->links.n > 0) {
@@ -645,22 +1255,7 @@ cb_zathura_page_widget_button_release_event(GtkWidget* widget, GdkEventButton* b
       tmp.y1 /= scale;
       tmp.y2 /= scale;
 
-      char* text = zathura_page_get_text(priv->page, tmp, NULL);
-      if (text != NULL) {
-        if (strlen(text) > 0) {
-          /* copy to clipboard */
-          gtk_clipboard_set_text(gtk_clipboard_get(GDK_SELECTION_PRIMARY), text, -1);
-
-
-          if (priv->page != NULL && document != NULL && priv->zathura != NULL) {
-            char* stripped_text = g_strdelimit(g_strdup(text), "\n\t\r\n", ' ');
-            girara_notify(priv->zathura->ui.session, GIRARA_INFO, _("Copied selected text to clipboard: %s"), stripped_text);
-            g_free(stripped_text);
-          }
-        }
-
-        g_free(text);
-      }
+      selection_copy(priv->zathura, priv->page, tmp);
     }
   }
 
@@ -720,8 +1315,7 @@ zathura_page_widget_popup_menu(GtkWidget* widget, GdkEventButton* event)
 #endif
 
   if (priv->images.retrieved == false) {
-    priv->images.list      = zathura_page_images_get(priv->page, NULL);
-    priv->images.retrieved = true;
+    zathura_page_widget_retrieve_images(priv);
   }
 
   if (priv->images.list == NULL) {
@@ -860,3 +1454,179 @@ zathura_page_widget_update_view_time(ZathuraPage* widget)
     priv->last_view = g_get_real_time();
   }
 }
+
+void
+zathura_page_widget_set_page(ZathuraPage* widget, zathura_page_t* page, bool changed)
+{
+  g_return_if_fail(ZATHURA_IS_PAGE(widget) == TRUE);
+  g_return_if_fail(page != NULL);
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+
+  mutex_lock(&(priv->lock));
+  priv->page = page;
+
+  /* links, images and search results belong to the old page */
+  if (priv->links.list != NULL) {
+    girara_list_free(priv->links.list);
+    priv->links.list = NULL;
+  }
+  priv->links.retrieved = false;
+  priv->links.draw      = false;
+  priv->links.n         = 0;
+
+  if (priv->images.list != NULL) {
+    girara_list_free(priv->images.list);
+    priv->images.list = NULL;
+  }
+  priv->images.retrieved = false;
+  priv->images.current   = NULL;
+  priv->metadata.generation = -1;
+
+  if (priv->search.list != NULL) {
+    girara_list_free(priv->search.list);
+    priv->search.list = NULL;
+  }
+  priv->search.current = INT_MAX;
+  priv->overlays.valid = false;
+
+  priv->mouse.selection.x1 = -1;
+  priv->mouse.selection.y1 = -1;
+  priv->mouse.selection.x2 = -1;
+  priv->mouse.selection.y2 = -1;
+
+  /* keep showing the old rendering until the page has been rendered again */
+  if (changed == true) {
+    if (priv->surface != NULL) {
+      if (priv->preview.surface != NULL) {
+        cairo_surface_destroy(priv->preview.surface);
+      }
+      priv->preview.surface = priv->surface;
+      priv->surface = NULL;
+    }
+    priv->render_requested  = false;
+    priv->preview.requested = false;
+    priv->complete          = false;
+    g_hash_table_remove_all(priv->tiles.requested);
+  }
+  mutex_unlock(&(priv->lock));
+
+  zathura_page_widget_redraw_canvas(widget);
+}
+
+void
+zathura_page_widget_abort_render_request(ZathuraPage* widget)
+{
+  g_return_if_fail(ZATHURA_IS_PAGE(widget) == TRUE);
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+
+  mutex_lock(&(priv->lock));
+  if (priv->surface == NULL) {
+    priv->render_requested = false;
+  }
+  priv->preview.requested = false;
+  /* the page is not visible anymore, so the preview is not needed */
+  if (priv->preview.surface != NULL) {
+    cairo_surface_destroy(priv->preview.surface);
+    priv->preview.surface = NULL;
+  }
+  g_hash_table_remove_all(priv->tiles.requested);
+  priv->metadata.generation = -1;
+  mutex_unlock(&(priv->lock));
+}
+
+bool
+zathura_page_widget_is_complete(ZathuraPage* widget)
+{
+  g_return_val_if_fail(ZATHURA_IS_PAGE(widget) == TRUE, false);
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+  mutex_lock(&(priv->lock));
+  const bool complete = priv->complete;
+  mutex_unlock(&(priv->lock));
+
+  return complete;
+}
+
+/* links and images are usually retrieved by the render thread once the page
+ * has been rendered; this is the fallback if they are needed before */
+static void
+zathura_page_widget_retrieve_links(zathura_page_widget_private_t* priv)
+{
+  render_thread_t* render_thread = priv->zathura->sync.render_thread;
+  const bool serialize = render_is_serialized(render_thread);
+  if (serialize == true) {
+    render_lock(render_thread);
+  }
+  priv->links.list = zathura_page_links_get(priv->page, NULL);
+  if (serialize == true) {
+    render_unlock(render_thread);
+  }
+
+  priv->links.retrieved = true;
+  priv->links.n         = (priv->links.list == NULL) ? 0 : girara_list_size(priv->links.list);
+  priv->overlays.valid  = false;
+}
+
+static void
+zathura_page_widget_retrieve_images(zathura_page_widget_private_t* priv)
+{
+  render_thread_t* render_thread = priv->zathura->sync.render_thread;
+  const bool serialize = render_is_serialized(render_thread);
+  if (serialize == true) {
+    render_lock(render_thread);
+  }
+  priv->images.list = zathura_page_images_get(priv->page, NULL);
+  if (serialize == true) {
+    render_unlock(render_thread);
+  }
+
+  priv->images.retrieved = true;
+}
+
+bool
+zathura_page_widget_request_metadata(ZathuraPage* widget, gint generation)
+{
+  g_return_val_if_fail(ZATHURA_IS_PAGE(widget) == TRUE, false);
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+
+  mutex_lock(&(priv->lock));
+  const bool request = (priv->links.retrieved == false || priv->images.retrieved == false)
+    && priv->metadata.generation != generation;
+  if (request == true) {
+    priv->metadata.generation = generation;
+  }
+  mutex_unlock(&(priv->lock));
+
+  return request;
+}
+
+void
+zathura_page_widget_update_metadata(ZathuraPage* widget, zathura_page_t* page,
+    girara_list_t* links, girara_list_t* images)
+{
+  g_return_if_fail(ZATHURA_IS_PAGE(widget) == TRUE);
+  zathura_page_widget_private_t* priv = ZATHURA_PAGE_GET_PRIVATE(widget);
+
+  mutex_lock(&(priv->lock));
+  /* the lists belong to a page that has been replaced in the meantime, or
+   * they have been retrieved on demand already */
+  if (priv->page != page || priv->links.retrieved == true) {
+    if (links != NULL) {
+      girara_list_free(links);
+    }
+  } else {
+    priv->links.list      = links;
+    priv->links.retrieved = true;
+    priv->links.n         = (links == NULL) ? 0 : girara_list_size(links);
+    priv->overlays.valid  = false;
+  }
+
+  if (priv->page != page || priv->images.retrieved == true) {
+    if (images != NULL) {
+      girara_list_free(images);
+    }
+  } else {
+    priv->images.list      = images;
+    priv->images.retrieved = true;
+  }
+  mutex_unlock(&(priv->lock));
+}
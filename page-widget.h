@@ -5,6 +5,7 @@
 
 #include <gtk/gtk.h>
 #include "document.h"
+#include "page-cache.h"
 
 /**
  * The page view widget. The widget handles all the rendering on its own. It
@@ -57,8 +58,39 @@ GtkWidget* zathura_page_widget_new(zathura_t* zathura, zathura_page_t* page);
  * thread.
  * @param widget the widget
  * @param surface the new surface
+ * @param key what the surface shows (or NULL if surface is NULL)
  */
-void zathura_page_widget_update_surface(ZathuraPage* widget, cairo_surface_t* surface);
+void zathura_page_widget_update_surface(ZathuraPage* widget, cairo_surface_t*
+    surface, const zathura_page_cache_key_t* key);
+/**
+ * Update the widget's preview, a low resolution surface that is shown scaled
+ * until the page has been rendered. The surface is dropped if the page has
+ * been rendered already. This should only be called from the render thread.
+ * @param widget the widget
+ * @param surface the preview surface
+ */
+void zathura_page_widget_update_preview(ZathuraPage* widget, cairo_surface_t* surface);
+/**
+ * Notify the widget that a tile has been rendered and added to the page cache.
+ * This should only be called from the render thread.
+ * @param widget the widget
+ * @param tile the tile
+ */
+void zathura_page_widget_update_tile(ZathuraPage* widget, unsigned int tile);
+/**
+ * Release the widget's surface if it is the given surface, e.g. because it
+ * has been evicted from the page cache.
+ * @param widget the widget
+ * @param surface the surface
+ */
+void zathura_page_widget_release_surface(ZathuraPage* widget, cairo_surface_t* surface);
+/**
+ * Release the widget's surface if the page cache does not hold it anymore.
+ * Surfaces of visible pages are kept when they are evicted, so this has to be
+ * called once the page has been hidden.
+ * @param widget the widget
+ */
+void zathura_page_widget_release_uncached(ZathuraPage* widget);
 /**
  * Draw a rectangle to mark links or search results
  * @param widget the widget
@@ -88,4 +120,58 @@ zathura_link_t* zathura_page_widget_link_get(ZathuraPage* widget, unsigned int i
  */
 void zathura_page_widget_update_view_time(ZathuraPage* widget);
 
+/**
+ * Replace the page the widget shows, e.g. after the document has been
+ * reloaded. Links, images and search results of the old page are dropped.
+ *
+ * @param widget the widget
+ * @param page the new page object
+ * @param changed true if the page's content has changed (or might have
+ *   changed) and needs to be rendered again
+ */
+void zathura_page_widget_set_page(ZathuraPage* widget, zathura_page_t* page, bool changed);
+
+/**
+ * Forget about a pending render request, e.g. because the render thread
+ * dropped the job. The page is requested again the next time it is drawn.
+ *
+ * @param widget the widget
+ */
+void zathura_page_widget_abort_render_request(ZathuraPage* widget);
+
+/**
+ * Checks whether the widget has last been drawn with the rendered page, i.e.
+ * not with "Loading...", a preview or missing tiles
+ *
+ * @param widget the widget
+ * @return true if the rendered page has been drawn
+ */
+bool zathura_page_widget_is_complete(ZathuraPage* widget);
+
+/**
+ * Checks whether the links and images of the page should be retrieved by the
+ * render thread and remembers the request. They are requested at most once
+ * per render generation, so that a request dropped by the render thread is
+ * issued again. This should only be called from the render thread.
+ *
+ * @param widget the widget
+ * @param generation the current render generation
+ * @return true if they should be retrieved
+ */
+bool zathura_page_widget_request_metadata(ZathuraPage* widget, gint generation);
+
+/**
+ * Hand the links and images retrieved by the render thread to the widget. The
+ * widget takes ownership of the lists. They are dropped if the widget shows
+ * another page by now or has retrieved them on demand already. This should
+ * only be called from the render thread.
+ *
+ * @param widget the widget
+ * @param page the page the lists have been retrieved for
+ * @param links the links (or NULL)
+ * @param images the images (or NULL)
+ */
+void zathura_page_widget_update_metadata(ZathuraPage* widget, zathura_page_t* page,
+    girara_list_t* links, girara_list_t* images);
+
 #endif
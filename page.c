@@ -1,5 +1,7 @@
 /* See LICENSE file for license and copyright information */
 
+#include <float.h>
+#include <math.h>
 #include <girara/session.h>
 #include <girara/utils.h>
 #include <glib/gi18n.h>
@@ -10,6 +12,7 @@
 #include "utils.h"
 #include "internal.h"
 #include "types.h"
+#include "glib-compat.h"
 
 struct zathura_page_s {
   double height; /**< Page height */
@@ -18,6 +21,14 @@ struct zathura_page_s {
   void* data; /**< Custom data */
   bool visible; /**< Page is visible */
   zathura_document_t* document; /**< Document */
+  bool content_hash_known; /**< The content hash has been retrieved */
+  uint64_t content_hash; /**< Hash of the page's content */
+  bool byte_range_known; /**< The byte range has been retrieved */
+  uint64_t byte_offset; /**< Offset of the page's content in the file */
+  uint64_t byte_length; /**< Length of the page's content in the file */
+  bool loaded; /**< The plugin has initialized the page */
+  bool load_failed; /**< The plugin failed to initialize the page */
+  mutex lock; /**< Lock for loading the page and its content hash */
 };
 
 zathura_page_t*
@@ -36,6 +47,9 @@ zathura_page_new(zathura_document_t* document, unsigned int index, zathura_error
   page->index    = index;
   page->visible  = false;
   page->document = document;
+  page->content_hash_known = false;
+  page->loaded   = true;
+  mutex_init(&page->lock);
 
   /* init plugin */
   zathura_plugin_t* plugin = zathura_document_get_plugin(document);
@@ -69,6 +83,66 @@ error_ret:
   return NULL;
 }
 
+zathura_page_t*
+zathura_page_new_placeholder(zathura_document_t* document, unsigned int index,
+    double width, double height)
+{
+  if (document == NULL) {
+    return NULL;
+  }
+
+  zathura_page_t* page = g_malloc0(sizeof(zathura_page_t));
+
+  page->index    = index;
+  page->visible  = false;
+  page->document = document;
+  page->width    = width;
+  page->height   = height;
+  page->loaded   = false;
+  mutex_init(&page->lock);
+
+  return page;
+}
+
+bool
+zathura_page_load(zathura_page_t* page)
+{
+  if (page == NULL || page->document == NULL) {
+    return false;
+  }
+
+  mutex_lock(&page->lock);
+  if (page->loaded == false && page->load_failed == false) {
+    zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
+    zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
+
+    if (functions->page_init != NULL && functions->page_init(page) == ZATHURA_ERROR_OK) {
+      page->loaded = true;
+    } else {
+      girara_error("could not initialize page %u", page->index + 1);
+      page->load_failed = true;
+    }
+  }
+  const bool loaded = page->loaded;
+  mutex_unlock(&page->lock);
+
+  return loaded;
+}
+
+bool
+zathura_page_is_loaded(zathura_page_t* page)
+{
+  if (page == NULL) {
+    return false;
+  }
+
+  mutex_lock(&page->lock);
+  const bool loaded = page->loaded;
+  mutex_unlock(&page->lock);
+
+  return loaded;
+}
+
 zathura_error_t
 zathura_page_free(zathura_page_t* page)
 {
@@ -77,10 +151,18 @@ zathura_page_free(zathura_page_t* page)
   }
 
   if (page->document == NULL) {
+    mutex_free(&page->lock);
     g_free(page);
     return ZATHURA_ERROR_INVALID_ARGUMENTS;
   }
 
+  /* the plugin never saw pages that have not been loaded */
+  if (page->loaded == false) {
+    mutex_free(&page->lock);
+    g_free(page);
+    return ZATHURA_ERROR_OK;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_clear == NULL) {
@@ -89,6 +171,7 @@ zathura_page_free(zathura_page_t* page)
 
   zathura_error_t error = functions->page_clear(page, page->data);
 
+  mutex_free(&page->lock);
   g_free(page);
 
   return error;
@@ -204,6 +287,13 @@ zathura_page_search_text(zathura_page_t* page, const char* text, zathura_error_t
     return NULL;
   }
 
+  if (zathura_page_load(page) == false) {
+    if (error != NULL) {
+      *error = ZATHURA_ERROR_UNKNOWN;
+    }
+    return NULL;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_search_text == NULL) {
@@ -226,6 +316,13 @@ zathura_page_links_get(zathura_page_t* page, zathura_error_t* error)
     return NULL;
   }
 
+  if (zathura_page_load(page) == false) {
+    if (error != NULL) {
+      *error = ZATHURA_ERROR_UNKNOWN;
+    }
+    return NULL;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_links_get == NULL) {
@@ -254,6 +351,13 @@ zathura_page_form_fields_get(zathura_page_t* page, zathura_error_t* error)
     return NULL;
   }
 
+  if (zathura_page_load(page) == false) {
+    if (error != NULL) {
+      *error = ZATHURA_ERROR_UNKNOWN;
+    }
+    return NULL;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_form_fields_get == NULL) {
@@ -282,6 +386,13 @@ zathura_page_images_get(zathura_page_t* page, zathura_error_t* error)
     return NULL;
   }
 
+  if (zathura_page_load(page) == false) {
+    if (error != NULL) {
+      *error = ZATHURA_ERROR_UNKNOWN;
+    }
+    return NULL;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_images_get == NULL) {
@@ -304,6 +415,13 @@ zathura_page_image_get_cairo(zathura_page_t* page, zathura_image_t* image, zathu
     return NULL;
   }
 
+  if (zathura_page_load(page) == false) {
+    if (error != NULL) {
+      *error = ZATHURA_ERROR_UNKNOWN;
+    }
+    return NULL;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_image_get_cairo == NULL) {
@@ -325,6 +443,13 @@ char* zathura_page_get_text(zathura_page_t* page, zathura_rectangle_t rectangle,
     return NULL;
   }
 
+  if (zathura_page_load(page) == false) {
+    if (error) {
+      *error = ZATHURA_ERROR_UNKNOWN;
+    }
+    return NULL;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_get_text == NULL) {
@@ -344,6 +469,10 @@ zathura_page_render(zathura_page_t* page, cairo_t* cairo, bool printing)
     return ZATHURA_ERROR_INVALID_ARGUMENTS;
   }
 
+  if (zathura_page_load(page) == false) {
+    return ZATHURA_ERROR_UNKNOWN;
+  }
+
   zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
   zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
   if (functions->page_render_cairo == NULL) {
@@ -352,3 +481,164 @@ zathura_page_render(zathura_page_t* page, cairo_t* cairo, bool printing)
 
   return functions->page_render_cairo(page, page->data, cairo, printing);
 }
+
+zathura_error_t
+zathura_page_render_region(zathura_page_t* page, const zathura_render_target_t* target)
+{
+  if (page == NULL || page->document == NULL || target == NULL || target->data == NULL ||
+      target->width == 0 || target->height == 0 || target->scale <= 0) {
+    return ZATHURA_ERROR_INVALID_ARGUMENTS;
+  }
+
+  if (zathura_page_load(page) == false) {
+    return ZATHURA_ERROR_UNKNOWN;
+  }
+
+  zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
+  zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
+  if (functions->page_render_region != NULL) {
+    return functions->page_render_region(page, page->data, target);
+  } else if (functions->page_render_cairo == NULL) {
+    return ZATHURA_ERROR_NOT_IMPLEMENTED;
+  }
+
+  /* the plugin draws into the buffer itself */
+  cairo_surface_t* surface = cairo_image_surface_create_for_data(target->data,
+      target->format, target->width, target->height, target->stride);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surface);
+    return ZATHURA_ERROR_OUT_OF_MEMORY;
+  }
+
+  cairo_t* cairo = cairo_create(surface);
+  if (target->x != 0 || target->y != 0) {
+    cairo_translate(cairo, -(double) target->x, -(double) target->y);
+  }
+  if (fabs(target->scale - 1.0f) > FLT_EPSILON) {
+    cairo_scale(cairo, target->scale, target->scale);
+  }
+
+  const zathura_error_t error = functions->page_render_cairo(page, page->data, cairo, false);
+
+  cairo_destroy(cairo);
+  cairo_surface_finish(surface);
+  cairo_surface_destroy(surface);
+
+  return error;
+}
+
+bool
+zathura_render_target_cancelled(const zathura_render_target_t* target)
+{
+  if (target == NULL || target->cancel == NULL) {
+    return false;
+  }
+
+  return g_atomic_int_get(target->cancel) != 0;
+}
+
+zathura_error_t
+zathura_page_get_content_hash(zathura_page_t* page, uint64_t* hash)
+{
+  if (page == NULL || page->document == NULL) {
+    return ZATHURA_ERROR_INVALID_ARGUMENTS;
+  }
+
+  uint64_t content_hash = 0;
+  if (zathura_page_get_cached_content_hash(page, &content_hash) == true) {
+    if (hash != NULL) {
+      *hash = content_hash;
+    }
+    return ZATHURA_ERROR_OK;
+  }
+
+  if (zathura_page_load(page) == false) {
+    return ZATHURA_ERROR_UNKNOWN;
+  }
+
+  zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
+  zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
+  if (functions->page_get_content_hash == NULL) {
+    return ZATHURA_ERROR_NOT_IMPLEMENTED;
+  }
+
+  /* several render threads might ask for the hash of the same page */
+  const zathura_error_t error = functions->page_get_content_hash(page, page->data, &content_hash);
+  if (error != ZATHURA_ERROR_OK) {
+    return error;
+  }
+
+  mutex_lock(&page->lock);
+  page->content_hash       = content_hash;
+  page->content_hash_known = true;
+  mutex_unlock(&page->lock);
+
+  if (hash != NULL) {
+    *hash = content_hash;
+  }
+  return ZATHURA_ERROR_OK;
+}
+
+bool
+zathura_page_get_cached_content_hash(zathura_page_t* page, uint64_t* hash)
+{
+  if (page == NULL || hash == NULL) {
+    return false;
+  }
+
+  mutex_lock(&page->lock);
+  const bool known = page->content_hash_known;
+  if (known == true) {
+    *hash = page->content_hash;
+  }
+  mutex_unlock(&page->lock);
+
+  return known;
+}
+
+zathura_error_t
+zathura_page_get_byte_range(zathura_page_t* page, uint64_t* offset, uint64_t* length)
+{
+  if (page == NULL || page->document == NULL || offset == NULL || length == NULL) {
+    return ZATHURA_ERROR_INVALID_ARGUMENTS;
+  }
+
+  if (page->byte_range_known == true) {
+    *offset = page->byte_offset;
+    *length = page->byte_length;
+    return ZATHURA_ERROR_OK;
+  }
+
+  if (zathura_page_load(page) == false) {
+    return ZATHURA_ERROR_UNKNOWN;
+  }
+
+  zathura_plugin_t* plugin = zathura_document_get_plugin(page->document);
+  zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
+  if (functions->page_get_byte_range == NULL) {
+    return ZATHURA_ERROR_NOT_IMPLEMENTED;
+  }
+
+  const zathura_error_t error = functions->page_get_byte_range(page, page->data,
+      &page->byte_offset, &page->byte_length);
+  if (error != ZATHURA_ERROR_OK) {
+    return error;
+  }
+
+  page->byte_range_known = true;
+  *offset = page->byte_offset;
+  *length = page->byte_length;
+  return ZATHURA_ERROR_OK;
+}
+
+bool
+zathura_page_get_cached_byte_range(zathura_page_t* page, uint64_t* offset, uint64_t* length)
+{
+  if (page == NULL || offset == NULL || length == NULL || page->byte_range_known == false) {
+    return false;
+  }
+
+  *offset = page->byte_offset;
+  *length = page->byte_length;
+  return true;
+}
@@ -5,9 +5,38 @@
 
 #include <girara/datastructures.h>
 #include <cairo.h>
+#include <stdint.h>
 
 #include "types.h"
 
+/**
+ * Pixel buffer a region of a page is rendered into
+ */
+typedef struct zathura_render_target_s
+{
+  unsigned char* data; /**< Pixels of the buffer, filled with white */
+  cairo_format_t format; /**< Format of the pixels (CAIRO_FORMAT_RGB24 or
+    CAIRO_FORMAT_ARGB32) */
+  unsigned int width; /**< Width of the buffer in pixels */
+  unsigned int height; /**< Height of the buffer in pixels */
+  unsigned int stride; /**< Number of bytes per row of the buffer */
+  double scale; /**< Scale the page is rendered at */
+  unsigned int x; /**< Left edge of the region in pixels of the scaled page */
+  unsigned int y; /**< Top edge of the region in pixels of the scaled page */
+  const int* cancel; /**< Set to a non-zero value once the render is to be
+    stopped (may be NULL, check with zathura_render_target_cancelled) */
+} zathura_render_target_t;
+
+/**
+ * Checks whether a render into the target has been cancelled. Plugins poll
+ * this during long renders, e.g. from the abort callback of their backend,
+ * and return ZATHURA_ERROR_CANCELLED once it returns true.
+ *
+ * @param target The render target
+ * @return true if the render is to be stopped
+ */
+bool zathura_render_target_cancelled(const zathura_render_target_t* target);
+
 /**
  * Get the page object
  *
@@ -19,6 +48,37 @@
 zathura_page_t* zathura_page_new(zathura_document_t* document, unsigned int
     index, zathura_error_t* error);
 
+/**
+ * Creates a page object that has not been initialized by the plugin yet. The
+ * given size is an estimate; the real size is known once the page has been
+ * loaded with zathura_page_load.
+ *
+ * @param document The document
+ * @param index Page number
+ * @param width Estimated width of the page
+ * @param height Estimated height of the page
+ * @return Page object or NULL if an error occured
+ */
+zathura_page_t* zathura_page_new_placeholder(zathura_document_t* document,
+    unsigned int index, double width, double height);
+
+/**
+ * Initializes the page with the plugin if that has not happened yet. All
+ * functions that call into the plugin load the page on their own.
+ *
+ * @param page The page object
+ * @return true if the page is loaded, false if it could not be initialized
+ */
+bool zathura_page_load(zathura_page_t* page);
+
+/**
+ * Checks whether the page has been initialized by the plugin
+ *
+ * @param page The page object
+ * @return true if the page is loaded
+ */
+bool zathura_page_is_loaded(zathura_page_t* page);
+
 /**
  * Frees the page object
  *
@@ -203,4 +263,63 @@ char* zathura_page_get_text(zathura_page_t* page, zathura_rectangle_t rectangle,
  */
 zathura_error_t zathura_page_render(zathura_page_t* page, cairo_t* cairo, bool printing);
 
+/**
+ * Renders a region of the page at a scale directly into a pixel buffer. If the
+ * plugin cannot render into buffers, it draws into the buffer with cairo.
+ *
+ * @param page The page object
+ * @param target The buffer and the region of the scaled page that is rendered
+ *   into it
+ * @return ZATHURA_ERROR_OK when no error occured, otherwise see
+ *    zathura_error_t
+ */
+zathura_error_t zathura_page_render_region(zathura_page_t* page, const zathura_render_target_t* target);
+
+/**
+ * Get a hash of the page's content. The hash is retrieved from the plugin
+ * once and remembered afterwards. Two pages with the same hash are expected
+ * to render identically.
+ *
+ * @param page The page object
+ * @param hash Set to the hash of the page (or NULL to only remember it)
+ * @return ZATHURA_ERROR_OK when no error occured, otherwise see
+ *    zathura_error_t
+ */
+zathura_error_t zathura_page_get_content_hash(zathura_page_t* page, uint64_t* hash);
+
+/**
+ * Get the hash of the page's content if it has already been retrieved with
+ * zathura_page_get_content_hash. The plugin is not asked.
+ *
+ * @param page The page object
+ * @param hash Set to the hash of the page
+ * @return true if the hash is known
+ */
+bool zathura_page_get_cached_content_hash(zathura_page_t* page, uint64_t* hash);
+
+/**
+ * Get the range of the document file that holds the page's content, as far
+ * as the plugin knows it. The range is retrieved from the plugin once and
+ * remembered afterwards.
+ *
+ * @param page The page object
+ * @param offset Set to the offset of the range in bytes
+ * @param length Set to the length of the range in bytes
+ * @return ZATHURA_ERROR_OK when no error occured, otherwise see
+ *    zathura_error_t
+ */
+zathura_error_t zathura_page_get_byte_range(zathura_page_t* page, uint64_t* offset, uint64_t* length);
+
+/**
+ * Get the range of the document file that holds the page's content if it has
+ * already been retrieved with zathura_page_get_byte_range. The plugin is not
+ * asked.
+ *
+ * @param page The page object
+ * @param offset Set to the offset of the range in bytes
+ * @param length Set to the length of the range in bytes
+ * @return true if the range is known
+ */
+bool zathura_page_get_cached_byte_range(zathura_page_t* page, uint64_t* offset, uint64_t* length);
+
 #endif // PAGE_H
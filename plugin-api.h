@@ -160,6 +160,32 @@ typedef zathura_image_buffer_t* (*zathura_plugin_page_render_t)(zathura_page_t*
  */
 typedef zathura_error_t (*zathura_plugin_page_render_cairo_t)(zathura_page_t* page, void* data, cairo_t* cairo, bool printing);
 
+/**
+ * Renders a region of the page into a pixel buffer
+ */
+typedef zathura_error_t (*zathura_plugin_page_render_region_t)(zathura_page_t* page, void* data, const zathura_render_target_t* target);
+
+/**
+ * Get a hash of the page's content
+ */
+typedef zathura_error_t (*zathura_plugin_page_get_content_hash_t)(zathura_page_t* page, void* data, uint64_t* hash);
+
+/**
+ * Get the range of the document file that holds the page's content
+ */
+typedef zathura_error_t (*zathura_plugin_page_get_byte_range_t)(zathura_page_t* page, void* data, uint64_t* offset, uint64_t* length);
+
+/**
+ * Plugin capabilities
+ */
+typedef enum zathura_plugin_capability_e {
+  ZATHURA_PLUGIN_CAPABILITY_NONE = 0, /**< No special capabilities */
+  ZATHURA_PLUGIN_CAPABILITY_THREAD_SAFE_RENDER = 1 << 0, /**< Pages of
+    the same document can be rendered concurrently */
+  ZATHURA_PLUGIN_CAPABILITY_THREAD_SAFE_TEXT = 1 << 1 /**< Pages of the
+    same document can be searched concurrently, also while pages are being
+    rendered */
+} zathura_plugin_capability_t;
 
 struct zathura_plugin_functions_s
 {
@@ -247,6 +273,32 @@ struct zathura_plugin_functions_s
    * Renders the page
    */
   zathura_plugin_page_render_cairo_t page_render_cairo;
+
+  /**
+   * Capabilities of the plugin (a combination of
+   * zathura_plugin_capability_t values)
+   */
+  unsigned int capabilities;
+
+  /**
+   * Renders a region of the page at a scale into a pixel buffer (used
+   * instead of page_render_cairo for the screen if it is set); long renders
+   * should stop with ZATHURA_ERROR_CANCELLED once
+   * zathura_render_target_cancelled returns true
+   */
+  zathura_plugin_page_render_region_t page_render_region;
+
+  /**
+   * Get the range of the document file that holds the page's content (used
+   * to read the pages the render queue is about to render ahead of time)
+   */
+  zathura_plugin_page_get_byte_range_t page_get_byte_range;
+
+  /**
+   * Get a hash of the page's content (used to detect changed pages when the
+   * document is reloaded)
+   */
+  zathura_plugin_page_get_content_hash_t page_get_content_hash;
 };
 
 
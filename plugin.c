@@ -3,7 +3,10 @@
 #include "plugin.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <sys/stat.h>
 
 #include <girara/datastructures.h>
 #include <girara/utils.h>
@@ -11,6 +14,19 @@
 #include <girara/session.h>
 #include <girara/settings.h>
 
+#include "glib-compat.h"
+
+#define GROUP_MANIFEST "manifest"
+
+#define KEY_API_VERSION "api-version"
+#define KEY_ABI_VERSION "abi-version"
+#define KEY_MTIME "mtime"
+#define KEY_SIZE "size"
+#define KEY_VALID "valid"
+#define KEY_NAME "name"
+#define KEY_CONTENT_TYPES "content-types"
+#define KEY_VERSION "version"
+
 /**
  * Document plugin structure
  */
@@ -22,6 +38,7 @@ struct zathura_plugin_s {
   char* name; /**< Name of the plugin */
   char* path; /**< Path to the plugin */
   zathura_plugin_version_t version; /**< Version information */
+  bool failed; /**< The plugin could not be opened once it has been needed */
 };
 
 /**
@@ -39,6 +56,8 @@ struct zathura_plugin_manager_s {
   girara_list_t* plugins; /**< List of plugins */
   girara_list_t* path; /**< List of plugin paths */
   girara_list_t* type_plugin_mapping; /**< List of type -> plugin mappings */
+  char* manifest; /**< File of the plugin manifest or NULL */
+  mutex lock; /**< Lock for opening plugins once they are needed */
 };
 
 typedef void (*zathura_plugin_register_service_t)(zathura_plugin_t*);
@@ -59,6 +78,7 @@ zathura_plugin_manager_new()
   plugin_manager->plugins = girara_list_new2((girara_free_function_t) zathura_plugin_free);
   plugin_manager->path    = girara_list_new2(g_free);
   plugin_manager->type_plugin_mapping = girara_list_new2((girara_free_function_t)zathura_type_plugin_mapping_free);
+  mutex_init(&plugin_manager->lock);
 
   if (plugin_manager->plugins == NULL
       || plugin_manager->path == NULL
@@ -80,6 +100,214 @@ zathura_plugin_manager_add_dir(zathura_plugin_manager_t* plugin_manager, const c
   girara_list_append(plugin_manager->path, g_strdup(dir));
 }
 
+void
+zathura_plugin_manager_set_manifest(zathura_plugin_manager_t* plugin_manager, const char* file)
+{
+  if (plugin_manager == NULL) {
+    return;
+  }
+
+  g_free(plugin_manager->manifest);
+  plugin_manager->manifest = g_strdup(file);
+}
+
+static zathura_plugin_t*
+plugin_open(const char* path)
+{
+  /* load plugin */
+  GModule* handle = g_module_open(path, G_MODULE_BIND_LOCAL);
+  if (handle == NULL) {
+    girara_error("could not load plugin %s (%s)", path, g_module_error());
+    return NULL;
+  }
+
+  /* resolve symbols and check API and ABI version*/
+  zathura_plugin_api_version_t api_version = NULL;
+  if (g_module_symbol(handle, PLUGIN_API_VERSION_FUNCTION, (gpointer*) &api_version) == FALSE ||
+      api_version == NULL) {
+    girara_error("could not find '%s' function in plugin %s", PLUGIN_API_VERSION_FUNCTION, path);
+    g_module_close(handle);
+    return NULL;
+  }
+
+  if (api_version() != ZATHURA_API_VERSION) {
+    girara_error("plugin %s has been built againt zathura with a different API version (plugin: %d, zathura: %d)",
+                 path, api_version(), ZATHURA_API_VERSION);
+    g_module_close(handle);
+    return NULL;
+  }
+
+  zathura_plugin_abi_version_t abi_version = NULL;
+  if (g_module_symbol(handle, PLUGIN_ABI_VERSION_FUNCTION, (gpointer*) &abi_version) == FALSE ||
+      abi_version == NULL) {
+    girara_error("could not find '%s' function in plugin %s", PLUGIN_ABI_VERSION_FUNCTION, path);
+    g_module_close(handle);
+    return NULL;
+  }
+
+  if (abi_version() != ZATHURA_ABI_VERSION) {
+    girara_error("plugin %s has been built againt zathura with a different ABI version (plugin: %d, zathura: %d)",
+                 path, abi_version(), ZATHURA_ABI_VERSION);
+    g_module_close(handle);
+    return NULL;
+  }
+
+  zathura_plugin_register_service_t register_service = NULL;
+  if (g_module_symbol(handle, PLUGIN_REGISTER_FUNCTION, (gpointer*) &register_service) == FALSE ||
+      register_service == NULL) {
+    girara_error("could not find '%s' function in plugin %s", PLUGIN_REGISTER_FUNCTION, path);
+    g_module_close(handle);
+    return NULL;
+  }
+
+  zathura_plugin_t* plugin = g_malloc0(sizeof(zathura_plugin_t));
+  plugin->content_types = girara_list_new2(g_free);
+  plugin->handle = handle;
+
+  register_service(plugin);
+
+  /* register functions */
+  if (plugin->register_function == NULL) {
+    girara_error("plugin has no document functions register function");
+    zathura_plugin_free(plugin);
+    return NULL;
+  }
+
+  plugin->register_function(&(plugin->functions));
+  plugin->path = g_strdup(path);
+
+  zathura_plugin_version_function_t plugin_major = NULL, plugin_minor = NULL, plugin_rev = NULL;
+  g_module_symbol(handle, PLUGIN_VERSION_MAJOR_FUNCTION,    (gpointer*) &plugin_major);
+  g_module_symbol(handle, PLUGIN_VERSION_MINOR_FUNCTION,    (gpointer*) &plugin_minor);
+  g_module_symbol(handle, PLUGIN_VERSION_REVISION_FUNCTION, (gpointer*) &plugin_rev);
+  if (plugin_major != NULL && plugin_minor != NULL && plugin_rev != NULL) {
+    plugin->version.major = plugin_major();
+    plugin->version.minor = plugin_minor();
+    plugin->version.rev   = plugin_rev();
+    girara_debug("plugin '%s': version %u.%u.%u", path,
+                 plugin->version.major, plugin->version.minor,
+                 plugin->version.rev);
+  }
+
+  return plugin;
+}
+
+static GKeyFile*
+manifest_read(const char* file)
+{
+  GKeyFile* manifest = g_key_file_new();
+  if (file == NULL || g_key_file_load_from_file(manifest, file, G_KEY_FILE_NONE, NULL) == FALSE) {
+    return manifest;
+  }
+
+  /* plugins built against an other version are opened again */
+  if (g_key_file_get_integer(manifest, GROUP_MANIFEST, KEY_API_VERSION, NULL) != ZATHURA_API_VERSION ||
+      g_key_file_get_integer(manifest, GROUP_MANIFEST, KEY_ABI_VERSION, NULL) != ZATHURA_ABI_VERSION) {
+    girara_debug("plugin manifest %s is outdated", file);
+    g_key_file_free(manifest);
+    manifest = g_key_file_new();
+  }
+
+  return manifest;
+}
+
+static zathura_plugin_t*
+manifest_get_plugin(GKeyFile* manifest, const char* path, gint64 mtime,
+    gint64 size, bool* listed)
+{
+  /* files that could not be opened are tried again, e.g. because a library
+   * they need has been installed in the meantime */
+  *listed = g_key_file_has_group(manifest, path) == TRUE &&
+    g_key_file_get_int64(manifest, path, KEY_MTIME, NULL) == mtime &&
+    g_key_file_get_int64(manifest, path, KEY_SIZE, NULL) == size &&
+    g_key_file_get_boolean(manifest, path, KEY_VALID, NULL) == TRUE;
+  if (*listed == false) {
+    return NULL;
+  }
+
+  /* the plugin is opened once a document needs it */
+  zathura_plugin_t* plugin = g_malloc0(sizeof(zathura_plugin_t));
+  plugin->content_types = girara_list_new2(g_free);
+  plugin->path = g_strdup(path);
+  plugin->name = g_key_file_get_string(manifest, path, KEY_NAME, NULL);
+
+  char** types = g_key_file_get_string_list(manifest, path, KEY_CONTENT_TYPES, NULL, NULL);
+  for (unsigned int i = 0; types != NULL && types[i] != NULL; i++) {
+    girara_list_append(plugin->content_types, g_strdup(types[i]));
+  }
+  g_strfreev(types);
+
+  gsize length = 0;
+  gint* version = g_key_file_get_integer_list(manifest, path, KEY_VERSION, &length, NULL);
+  if (version != NULL && length == 3) {
+    plugin->version.major = version[0];
+    plugin->version.minor = version[1];
+    plugin->version.rev   = version[2];
+  }
+  g_free(version);
+
+  return plugin;
+}
+
+static void
+manifest_add_plugin(GKeyFile* manifest, const char* path, gint64 mtime,
+    gint64 size, zathura_plugin_t* plugin)
+{
+  /* only plugins that have been opened successfully are listed */
+  if (plugin == NULL) {
+    return;
+  }
+
+  g_key_file_set_int64(manifest, path, KEY_MTIME, mtime);
+  g_key_file_set_int64(manifest, path, KEY_SIZE, size);
+  g_key_file_set_boolean(manifest, path, KEY_VALID, TRUE);
+
+  if (plugin->name != NULL) {
+    g_key_file_set_string(manifest, path, KEY_NAME, plugin->name);
+  }
+
+  const unsigned int number_of_types = girara_list_size(plugin->content_types);
+  const gchar** types = g_malloc0(sizeof(gchar*) * (number_of_types + 1));
+  for (unsigned int i = 0; i < number_of_types; i++) {
+    types[i] = girara_list_nth(plugin->content_types, i);
+  }
+  g_key_file_set_string_list(manifest, path, KEY_CONTENT_TYPES, types, number_of_types);
+  g_free(types);
+
+  gint version[] = { plugin->version.major, plugin->version.minor, plugin->version.rev };
+  g_key_file_set_integer_list(manifest, path, KEY_VERSION, version, 3);
+}
+
+static void
+manifest_write(const char* file, GKeyFile* manifest)
+{
+  gsize length = 0;
+  char* content = g_key_file_to_data(manifest, &length, NULL);
+  if (content == NULL) {
+    return;
+  }
+
+  /* the manifest is only written if a plugin has changed */
+  char* previous = NULL;
+  if (g_file_get_contents(file, &previous, NULL, NULL) == FALSE ||
+      g_strcmp0(previous, content) != 0) {
+    char* dir = g_path_get_dirname(file);
+    g_mkdir_with_parents(dir, 0700);
+    g_free(dir);
+
+    GError* error = NULL;
+    if (g_file_set_contents(file, content, length, &error) == FALSE) {
+      girara_error("could not save plugin manifest to '%s': %s", file, error->message);
+      g_error_free(error);
+    } else {
+      girara_debug("updated plugin manifest %s", file);
+    }
+  }
+
+  g_free(previous);
+  g_free(content);
+}
+
 void
 zathura_plugin_manager_load(zathura_plugin_manager_t* plugin_manager)
 {
@@ -87,6 +315,11 @@ zathura_plugin_manager_load(zathura_plugin_manager_t* plugin_manager)
     return;
   }
 
+  GKeyFile* manifest = manifest_read(plugin_manager->manifest);
+  GKeyFile* updated  = g_key_file_new();
+  g_key_file_set_integer(updated, GROUP_MANIFEST, KEY_API_VERSION, ZATHURA_API_VERSION);
+  g_key_file_set_integer(updated, GROUP_MANIFEST, KEY_ABI_VERSION, ZATHURA_ABI_VERSION);
+
   GIRARA_LIST_FOREACH(plugin_manager->path, char*, iter, plugindir)
   /* read all files in the plugin directory */
   GDir* dir = g_dir_open(plugindir, 0, NULL);
@@ -99,116 +332,79 @@ zathura_plugin_manager_load(zathura_plugin_manager_t* plugin_manager)
   char* name = NULL;
   while ((name = (char*) g_dir_read_name(dir)) != NULL) {
     char* path = g_build_filename(plugindir, name, NULL);
-    if (g_file_test(path, G_FILE_TEST_IS_REGULAR) == 0) {
+    GStatBuf info;
+    if (g_stat(path, &info) != 0 || S_ISREG(info.st_mode) == 0) {
       girara_debug("%s is not a regular file. Skipping.", path);
       g_free(path);
       continue;
     }
 
+    /* plugins that have not changed since the manifest has been written are
+     * not opened now */
+    bool listed = false;
     zathura_plugin_t* plugin = NULL;
-
-    /* load plugin */
-    GModule* handle = g_module_open(path, G_MODULE_BIND_LOCAL);
-    if (handle == NULL) {
-      girara_error("could not load plugin %s (%s)", path, g_module_error());
-      g_free(path);
-      continue;
-    }
-
-    /* resolve symbols and check API and ABI version*/
-    zathura_plugin_api_version_t api_version = NULL;
-    if (g_module_symbol(handle, PLUGIN_API_VERSION_FUNCTION, (gpointer*) &api_version) == FALSE ||
-        api_version == NULL) {
-      girara_error("could not find '%s' function in plugin %s", PLUGIN_API_VERSION_FUNCTION, path);
-      g_free(path);
-      g_module_close(handle);
-      continue;
-    }
-
-    if (api_version() != ZATHURA_API_VERSION) {
-      girara_error("plugin %s has been built againt zathura with a different API version (plugin: %d, zathura: %d)",
-                   path, api_version(), ZATHURA_API_VERSION);
-      g_free(path);
-      g_module_close(handle);
-      continue;
-    }
-
-    zathura_plugin_abi_version_t abi_version = NULL;
-    if (g_module_symbol(handle, PLUGIN_ABI_VERSION_FUNCTION, (gpointer*) &abi_version) == FALSE ||
-        abi_version == NULL) {
-      girara_error("could not find '%s' function in plugin %s", PLUGIN_ABI_VERSION_FUNCTION, path);
-      g_free(path);
-      g_module_close(handle);
-      continue;
+    if (plugin_manager->manifest != NULL) {
+      plugin = manifest_get_plugin(manifest, path, info.st_mtime, info.st_size, &listed);
     }
-
-    if (abi_version() != ZATHURA_ABI_VERSION) {
-      girara_error("plugin %s has been built againt zathura with a different ABI version (plugin: %d, zathura: %d)",
-                   path, abi_version(), ZATHURA_ABI_VERSION);
-      g_free(path);
-      g_module_close(handle);
-      continue;
+    if (listed == false) {
+      plugin = plugin_open(path);
     }
+    manifest_add_plugin(updated, path, info.st_mtime, info.st_size, plugin);
 
-    zathura_plugin_register_service_t register_service = NULL;
-    if (g_module_symbol(handle, PLUGIN_REGISTER_FUNCTION, (gpointer*) &register_service) == FALSE ||
-        register_service == NULL) {
-      girara_error("could not find '%s' function in plugin %s", PLUGIN_REGISTER_FUNCTION, path);
-      g_free(path);
-      g_module_close(handle);
-      continue;
-    }
-
-    plugin = g_malloc0(sizeof(zathura_plugin_t));
-    plugin->content_types = girara_list_new2(g_free);
-    plugin->handle = handle;
-
-    register_service(plugin);
-
-    /* register functions */
-    if (plugin->register_function == NULL) {
-      girara_error("plugin has no document functions register function");
+    if (plugin == NULL) {
       g_free(path);
-      g_free(plugin);
-      g_module_close(handle);
       continue;
     }
 
-    plugin->register_function(&(plugin->functions));
-    plugin->path = path;
-
     bool ret = register_plugin(plugin_manager, plugin);
     if (ret == false) {
       girara_error("could not register plugin %s", path);
       zathura_plugin_free(plugin);
+    } else if (plugin->handle == NULL) {
+      girara_debug("registered plugin %s from the manifest", path);
     } else {
       girara_debug("successfully loaded plugin %s", path);
-
-      zathura_plugin_version_function_t plugin_major = NULL, plugin_minor = NULL, plugin_rev = NULL;
-      g_module_symbol(handle, PLUGIN_VERSION_MAJOR_FUNCTION,    (gpointer*) &plugin_major);
-      g_module_symbol(handle, PLUGIN_VERSION_MINOR_FUNCTION,    (gpointer*) &plugin_minor);
-      g_module_symbol(handle, PLUGIN_VERSION_REVISION_FUNCTION, (gpointer*) &plugin_rev);
-      if (plugin_major != NULL && plugin_minor != NULL && plugin_rev != NULL) {
-        plugin->version.major = plugin_major();
-        plugin->version.minor = plugin_minor();
-        plugin->version.rev   = plugin_rev();
-        girara_debug("plugin '%s': version %u.%u.%u", path,
-                     plugin->version.major, plugin->version.minor,
-                     plugin->version.rev);
-      }
     }
+    g_free(path);
   }
   g_dir_close(dir);
   GIRARA_LIST_FOREACH_END(zathura->plugins.path, char*, iter, plugindir);
+
+  if (plugin_manager->manifest != NULL) {
+    manifest_write(plugin_manager->manifest, updated);
+  }
+
+  g_key_file_free(updated);
+  g_key_file_free(manifest);
 }
 
-zathura_plugin_t*
-zathura_plugin_manager_get_plugin(zathura_plugin_manager_t* plugin_manager, const char* type)
+static bool
+plugin_ensure_open(zathura_plugin_manager_t* plugin_manager, zathura_plugin_t* plugin)
 {
-  if (plugin_manager == NULL || plugin_manager->type_plugin_mapping == NULL || type == NULL) {
-    return NULL;
+  mutex_lock(&plugin_manager->lock);
+  if (plugin->handle == NULL && plugin->failed == false) {
+    girara_debug("opening plugin %s", plugin->path);
+    zathura_plugin_t* opened = plugin_open(plugin->path);
+    if (opened == NULL) {
+      plugin->failed = true;
+    } else {
+      plugin->register_function = opened->register_function;
+      plugin->functions         = opened->functions;
+      plugin->version           = opened->version;
+      plugin->handle            = opened->handle;
+      opened->handle            = NULL;
+      zathura_plugin_free(opened);
+    }
   }
+  const bool open = plugin->handle != NULL;
+  mutex_unlock(&plugin_manager->lock);
+
+  return open;
+}
 
+static zathura_plugin_t*
+plugin_manager_find_plugin(zathura_plugin_manager_t* plugin_manager, const char* type)
+{
   zathura_plugin_t* plugin = NULL;
   GIRARA_LIST_FOREACH(plugin_manager->type_plugin_mapping, zathura_type_plugin_mapping_t*, iter, mapping)
   if (g_content_type_equals(type, mapping->type)) {
@@ -220,6 +416,31 @@ zathura_plugin_manager_get_plugin(zathura_plugin_manager_t* plugin_manager, cons
   return plugin;
 }
 
+zathura_plugin_t*
+zathura_plugin_manager_get_plugin(zathura_plugin_manager_t* plugin_manager, const char* type)
+{
+  if (plugin_manager == NULL || plugin_manager->type_plugin_mapping == NULL || type == NULL) {
+    return NULL;
+  }
+
+  zathura_plugin_t* plugin = plugin_manager_find_plugin(plugin_manager, type);
+  if (plugin == NULL || plugin_ensure_open(plugin_manager, plugin) == false) {
+    return NULL;
+  }
+
+  return plugin;
+}
+
+bool
+zathura_plugin_manager_has_plugin(zathura_plugin_manager_t* plugin_manager, const char* type)
+{
+  if (plugin_manager == NULL || plugin_manager->type_plugin_mapping == NULL || type == NULL) {
+    return false;
+  }
+
+  return plugin_manager_find_plugin(plugin_manager, type) != NULL;
+}
+
 girara_list_t*
 zathura_plugin_manager_get_plugins(zathura_plugin_manager_t* plugin_manager)
 {
@@ -249,6 +470,8 @@ zathura_plugin_manager_free(zathura_plugin_manager_t* plugin_manager)
     girara_list_free(plugin_manager->type_plugin_mapping);
   }
 
+  g_free(plugin_manager->manifest);
+  mutex_free(&plugin_manager->lock);
   g_free(plugin_manager);
 }
 
@@ -257,7 +480,6 @@ register_plugin(zathura_plugin_manager_t* plugin_manager, zathura_plugin_t* plug
 {
   if (plugin == NULL
       || plugin->content_types == NULL
-      || plugin->register_function == NULL
       || plugin_manager == NULL
       || plugin_manager->plugins == NULL) {
     girara_error("plugin: could not register\n");
@@ -328,7 +550,9 @@ zathura_plugin_free(zathura_plugin_t* plugin)
     g_free(plugin->path);
   }
 
-  g_module_close(plugin->handle);
+  if (plugin->handle != NULL) {
+    g_module_close(plugin->handle);
+  }
   girara_list_free(plugin->content_types);
 
   g_free(plugin);
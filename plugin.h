@@ -47,14 +47,27 @@ void zathura_plugin_manager_free(zathura_plugin_manager_t* plugin_manager);
 void zathura_plugin_manager_add_dir(zathura_plugin_manager_t* plugin_manager, const char* dir);
 
 /**
- * Loads all plugins available in the previously given directories
+ * Sets the file the manifest of the plugins is kept in. The manifest lists the
+ * content types, names and versions of the plugins. Plugins whose file has not
+ * changed since the manifest has been written are registered from the
+ * manifest and only opened once a document needs them.
+ *
+ * @param plugin_manager The plugin manager
+ * @param file The file of the manifest or NULL to open all plugins at once
+ */
+void zathura_plugin_manager_set_manifest(zathura_plugin_manager_t* plugin_manager, const char* file);
+
+/**
+ * Loads all plugins available in the previously given directories and updates
+ * the manifest if one has been set
  *
  * @param plugin_manager The plugin manager
  */
 void zathura_plugin_manager_load(zathura_plugin_manager_t* plugin_manager);
 
 /**
- * Returns the (if available) associated plugin
+ * Returns the (if available) associated plugin. A plugin that has been
+ * registered from the manifest is opened first.
  *
  * @param plugin_manager The plugin manager
  * @param type The document type
@@ -62,6 +75,15 @@ void zathura_plugin_manager_load(zathura_plugin_manager_t* plugin_manager);
  */
 zathura_plugin_t* zathura_plugin_manager_get_plugin(zathura_plugin_manager_t* plugin_manager, const char* type);
 
+/**
+ * Checks if a plugin is registered for a document type without opening it
+ *
+ * @param plugin_manager The plugin manager
+ * @param type The document type
+ * @return true if a plugin is registered for the type
+ */
+bool zathura_plugin_manager_has_plugin(zathura_plugin_manager_t* plugin_manager, const char* type);
+
 /**
  * Returns a list with the plugin objects
  *
@@ -0,0 +1,350 @@
+/* See LICENSE file for license and copyright information */
+
+#include <girara/datastructures.h>
+#include <girara/utils.h>
+#include <girara/session.h>
+#include <girara/settings.h>
+
+#include "prefetch.h"
+#include "document.h"
+#include "page.h"
+#include "render.h"
+#include "utils.h"
+
+/* pages of the jumplist that are prefetched besides the predicted ones */
+#define PREFETCH_JUMPS 2
+
+unsigned int
+zathura_prefetch_predict(unsigned int first_visible, unsigned int last_visible,
+    unsigned int number_of_pages, zathura_prefetch_direction_t direction,
+    unsigned int count, unsigned int* pages)
+{
+  if (pages == NULL || first_visible > last_visible || last_visible >= number_of_pages) {
+    return 0;
+  }
+
+  unsigned int n      = 0;
+  unsigned int ahead  = 0;
+  unsigned int behind = 0;
+  while (n < count) {
+    bool added = false;
+
+    if (direction != ZATHURA_PREFETCH_BACKWARD && last_visible + ahead + 1 < number_of_pages) {
+      pages[n++] = last_visible + ++ahead;
+      added = true;
+    }
+
+    if (n < count && direction != ZATHURA_PREFETCH_FORWARD && behind < first_visible) {
+      pages[n++] = first_visible - ++behind;
+      added = true;
+    }
+
+    if (added == false) {
+      break;
+    }
+  }
+
+  return n;
+}
+
+bool
+zathura_prefetch_parse_direction(const char* name, int last_direction,
+    zathura_prefetch_direction_t* direction)
+{
+  if (name == NULL || direction == NULL) {
+    return false;
+  }
+
+  if (g_strcmp0(name, "scroll") == 0) {
+    *direction = last_direction < 0 ? ZATHURA_PREFETCH_BACKWARD : ZATHURA_PREFETCH_FORWARD;
+  } else if (g_strcmp0(name, "forward") == 0) {
+    *direction = ZATHURA_PREFETCH_FORWARD;
+  } else if (g_strcmp0(name, "both") == 0) {
+    *direction = ZATHURA_PREFETCH_BOTH;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+/* adds the pages the jumplist would go back and forward to */
+static unsigned int
+prefetch_jumplist_targets(zathura_t* zathura, unsigned int* pages)
+{
+  if (zathura->jumplist.cur == NULL) {
+    return 0;
+  }
+
+  unsigned int n = 0;
+  for (int step = -1; step <= 1; step += 2) {
+    girara_list_iterator_t* iter = girara_list_iterator_copy(zathura->jumplist.cur);
+    if (step < 0 && girara_list_iterator_has_previous(iter) == true) {
+      girara_list_iterator_previous(iter);
+    } else if (step > 0 && girara_list_iterator_has_next(iter) == true) {
+      girara_list_iterator_next(iter);
+    } else {
+      girara_list_iterator_free(iter);
+      continue;
+    }
+
+    zathura_jump_t* jump = girara_list_iterator_data(iter);
+    if (jump != NULL) {
+      pages[n++] = jump->page;
+    }
+    girara_list_iterator_free(iter);
+  }
+
+  return n;
+}
+
+static size_t
+prefetch_page_size(zathura_page_t* page)
+{
+  unsigned int width  = 0;
+  unsigned int height = 0;
+  page_calc_height_width(page, &height, &width, false);
+
+  return (size_t) cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, width) * height;
+}
+
+/* pins the current slide and its neighbours and renders the neighbours */
+static void
+prefetch_presentation(zathura_t* zathura)
+{
+  zathura_document_t* document = zathura->document;
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(document);
+  const unsigned int current = zathura_document_get_current_page_number(document);
+  const unsigned int tile_size = render_get_tile_size(zathura->sync.render_thread);
+
+  unsigned int pages[3];
+  unsigned int n = 0;
+  pages[n++] = current;
+  if (current + 1 < number_of_pages) {
+    pages[n++] = current + 1;
+  }
+  if (current > 0) {
+    pages[n++] = current - 1;
+  }
+
+  zathura_page_cache_key_t keys[3];
+  unsigned int pinned = 0;
+  for (unsigned int i = 0; i < n; i++) {
+    zathura_page_t* page = zathura_document_get_page(document, pages[i]);
+    if (page == NULL) {
+      continue;
+    }
+
+    page_load(zathura, pages[i]);
+
+    unsigned int width  = 0;
+    unsigned int height = 0;
+    page_calc_height_width(page, &height, &width, false);
+    if (tile_size != 0 && (width > tile_size || height > tile_size)) {
+      girara_debug("slide %u is rendered in tiles once it is shown", pages[i] + 1);
+      continue;
+    }
+
+    render_get_cache_key(zathura, page, &keys[pinned++]);
+    if (zathura_page_get_visibility(page) == false) {
+      render_page_prefetch(zathura->sync.render_thread, page);
+    }
+  }
+
+  zathura_page_cache_pin(zathura->page_cache, keys, pinned);
+}
+
+static gboolean
+prefetch_idle(gpointer data)
+{
+  zathura_t* zathura = data;
+  zathura->prefetch.source = 0;
+
+  /* pages would be prefetched at an intermediate zoom level; prefetching is
+   * scheduled again once the zoom gesture has settled */
+  if (zathura->document == NULL || zathura->ui.layout.visible.valid == false ||
+      render_is_deferred(zathura->sync.render_thread) == true) {
+    return FALSE;
+  }
+
+  /* slides are kept regardless of the prefetch budget */
+  if (zathura->presentation.active == true) {
+    prefetch_presentation(zathura);
+    return FALSE;
+  }
+
+  int count = 0;
+  girara_setting_get(zathura->ui.session, "prefetch-pages", &count);
+  if (count <= 0) {
+    return FALSE;
+  }
+
+  zathura_prefetch_direction_t direction = ZATHURA_PREFETCH_FORWARD;
+  char* name = NULL;
+  girara_setting_get(zathura->ui.session, "prefetch-direction", &name);
+  if (zathura_prefetch_parse_direction(name, zathura->prefetch.direction, &direction) == false) {
+    girara_warning("unknown prefetch-direction '%s', prefetching forward", name);
+  }
+  g_free(name);
+
+  zathura_document_t* document = zathura->document;
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(document);
+  const unsigned int first = zathura->ui.layout.visible.first;
+  const unsigned int last  = zathura->ui.layout.visible.last;
+
+  unsigned int* pages = g_malloc_n(count + PREFETCH_JUMPS, sizeof(unsigned int));
+  unsigned int n = zathura_prefetch_predict(first, last, number_of_pages,
+      direction, count, pages);
+  n += prefetch_jumplist_targets(zathura, pages + n);
+
+  /* leave half of the cache to the visible and the recently viewed pages */
+  zathura_page_cache_statistics_t statistics;
+  zathura_page_cache_get_statistics(zathura->page_cache, &statistics);
+  const size_t budget = statistics.max_bytes / 2;
+
+  int cache_size = 0;
+  girara_setting_get(zathura->ui.session, "page-cache-size", &cache_size);
+  const unsigned int max_entries = cache_size > 0 ? (unsigned int) cache_size / 2 : n;
+
+  size_t used = 0;
+  for (unsigned int page_id = first; page_id <= last && page_id < number_of_pages; page_id++) {
+    used += prefetch_page_size(zathura_document_get_page(document, page_id));
+  }
+
+  const unsigned int tile_size = render_get_tile_size(zathura->sync.render_thread);
+  unsigned int queued = 0;
+  for (unsigned int i = 0; i < n && queued < max_entries; i++) {
+    const unsigned int page_id = pages[i];
+    zathura_page_t* page = zathura_document_get_page(document, page_id);
+    if (page == NULL || zathura_page_get_visibility(page) == true) {
+      continue;
+    }
+
+    bool duplicate = false;
+    for (unsigned int j = 0; j < i && duplicate == false; j++) {
+      duplicate = pages[j] == page_id;
+    }
+    if (duplicate == true) {
+      continue;
+    }
+
+    /* the size of the page is only known once it has been loaded */
+    page_load(zathura, page_id);
+
+    unsigned int width  = 0;
+    unsigned int height = 0;
+    page_calc_height_width(page, &height, &width, false);
+    if (tile_size != 0 && (width > tile_size || height > tile_size)) {
+      /* tiles are only rendered once they are visible */
+      continue;
+    }
+
+    const size_t size = prefetch_page_size(page);
+    if (used + size > budget) {
+      break;
+    }
+    used += size;
+
+    if (render_page_prefetch(zathura->sync.render_thread, page) == true) {
+      ++queued;
+    }
+  }
+
+  if (queued > 0) {
+    girara_debug("prefetching %u page(s)", queued);
+  }
+
+  g_free(pages);
+  return FALSE;
+}
+
+void
+prefetch_schedule(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->document == NULL) {
+    return;
+  }
+
+  /* remember which way the reader is going, whether by scrolling, by
+   * navigating or by following links */
+  const unsigned int current = zathura_document_get_current_page_number(zathura->document);
+  if (current != zathura->prefetch.current_page) {
+    zathura->prefetch.direction    = current > zathura->prefetch.current_page ? 1 : -1;
+    zathura->prefetch.current_page = current;
+  }
+
+  if (zathura->prefetch.source == 0) {
+    zathura->prefetch.source = gdk_threads_add_idle_full(G_PRIORITY_LOW,
+        prefetch_idle, zathura, NULL);
+  }
+}
+
+void
+prefetch_range(zathura_t* zathura, unsigned int first, unsigned int last)
+{
+  if (zathura == NULL || zathura->document == NULL) {
+    return;
+  }
+
+  zathura_document_t* document = zathura->document;
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(document);
+  const unsigned int tile_size = render_get_tile_size(zathura->sync.render_thread);
+
+  unsigned int queued = 0;
+  for (unsigned int page_id = first; page_id <= last && page_id < number_of_pages; page_id++) {
+    zathura_page_t* page = zathura_document_get_page(document, page_id);
+    if (page == NULL || zathura_page_get_visibility(page) == true) {
+      continue;
+    }
+
+    page_load(zathura, page_id);
+
+    unsigned int width  = 0;
+    unsigned int height = 0;
+    page_calc_height_width(page, &height, &width, false);
+    if (tile_size != 0 && (width > tile_size || height > tile_size)) {
+      continue;
+    }
+
+    if (render_page_prefetch(zathura->sync.render_thread, page) == true) {
+      ++queued;
+    }
+  }
+
+  if (queued > 0) {
+    girara_debug("rendering %u page(s) at the scroll destination", queued);
+  }
+}
+
+void
+prefetch_set_presentation(zathura_t* zathura, bool active)
+{
+  if (zathura == NULL) {
+    return;
+  }
+
+  zathura->presentation.active     = active;
+  zathura->presentation.flip_start = 0;
+  if (active == false) {
+    zathura_page_cache_pin(zathura->page_cache, NULL, 0);
+  }
+
+  prefetch_schedule(zathura);
+}
+
+void
+prefetch_cancel(zathura_t* zathura)
+{
+  if (zathura == NULL) {
+    return;
+  }
+
+  if (zathura->prefetch.source != 0) {
+    g_source_remove(zathura->prefetch.source);
+    zathura->prefetch.source = 0;
+  }
+  zathura_page_cache_pin(zathura->page_cache, NULL, 0);
+
+  zathura->prefetch.current_page = 0;
+  zathura->prefetch.direction    = 0;
+}
@@ -0,0 +1,90 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdbool.h>
+
+#include "zathura.h"
+
+/**
+ * Direction in which pages are prefetched
+ */
+typedef enum zathura_prefetch_direction_e {
+  ZATHURA_PREFETCH_FORWARD, /**< Pages after the visible ones */
+  ZATHURA_PREFETCH_BACKWARD, /**< Pages before the visible ones */
+  ZATHURA_PREFETCH_BOTH /**< Pages on both sides, closest first */
+} zathura_prefetch_direction_t;
+
+/**
+ * Predicts the pages that are going to be shown next.
+ *
+ * @param first_visible First visible page
+ * @param last_visible Last visible page
+ * @param number_of_pages Number of pages of the document
+ * @param direction Direction in which the pages are expected
+ * @param count Maximum number of pages to predict
+ * @param pages Will be filled with the predicted pages, most likely first;
+ *   has to have room for count pages
+ * @return The number of predicted pages
+ */
+unsigned int zathura_prefetch_predict(unsigned int first_visible, unsigned int
+    last_visible, unsigned int number_of_pages, zathura_prefetch_direction_t
+    direction, unsigned int count, unsigned int* pages);
+
+/**
+ * Resolves the value of the prefetch-direction setting. "scroll" follows the
+ * direction the current page has changed in last, "forward" and "both" are
+ * used as they are.
+ *
+ * @param name The value of the setting
+ * @param last_direction Sign of the last change of the current page (0 if it
+ *   has not changed yet)
+ * @param direction Will be set to the direction
+ * @return false if the value is not known
+ */
+bool zathura_prefetch_parse_direction(const char* name, int last_direction,
+    zathura_prefetch_direction_t* direction);
+
+/**
+ * Queues the pages that are likely to be shown next for rendering once the
+ * main loop is idle. The pages around the visible ones and the targets of the
+ * jumplist are rendered into the page cache, as long as they fit into half of
+ * its budget.
+ *
+ * @param zathura The zathura session
+ */
+void prefetch_schedule(zathura_t* zathura);
+
+/**
+ * Renders a range of pages that are about to come into view, e.g. at the
+ * destination of a scroll animation. Pages that are visible already or that
+ * are rendered in tiles are skipped.
+ *
+ * @param zathura The zathura session
+ * @param first The first page
+ * @param last The last page
+ */
+void prefetch_range(zathura_t* zathura, unsigned int first, unsigned int last);
+
+/**
+ * Enables or disables presentation mode. In presentation mode the current,
+ * the next and the previous page are pinned in the page cache at the current
+ * scale and the next and the previous page are rendered ahead of time, so
+ * that changing the slide does not wait for rendering.
+ *
+ * @param zathura The zathura session
+ * @param active true to enable presentation mode
+ */
+void prefetch_set_presentation(zathura_t* zathura, bool active);
+
+/**
+ * Stops prefetching and forgets the scroll direction, e.g. when the document
+ * is closed. Pinned slides are released until presentation mode prefetches
+ * them again.
+ *
+ * @param zathura The zathura session
+ */
+void prefetch_cancel(zathura_t* zathura);
+
+#endif // PREFETCH_H
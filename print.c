@@ -4,17 +4,99 @@
 #include "document.h"
 #include "render.h"
 #include "page.h"
+#include "glib-compat.h"
 
 #include <girara/utils.h>
+#include <girara/settings.h>
 #include <girara/statusbar.h>
 
+/* number of pages that are rendered ahead and kept while printing */
+#define PRINT_RING_SIZE 4
+
+typedef enum print_slot_state_e {
+  PRINT_SLOT_FREE, /**< The slot can be used for another page */
+  PRINT_SLOT_QUEUED, /**< The page is being rendered */
+  PRINT_SLOT_READY, /**< The page has been rendered */
+  PRINT_SLOT_FAILED /**< The page could not be rendered */
+} print_slot_state_t;
+
+typedef struct print_slot_s {
+  int page; /**< Page number */
+  print_slot_state_t state; /**< State of the slot */
+  cairo_surface_t* surface; /**< Rendered page; kept for the next page */
+} print_slot_t;
+
+typedef struct print_pipeline_s {
+  zathura_t* zathura; /**< Zathura object */
+  bool raster; /**< The plugin can not render to the print surface */
+  bool cancelled; /**< The print operation has ended */
+  int last_page; /**< The last printed page or -1 */
+  GThreadPool* pool; /**< Threads rendering pages ahead */
+  print_slot_t slots[PRINT_RING_SIZE]; /**< The rendered pages */
+  mutex lock; /**< Lock for the slots */
+  cond changed; /**< Signalled when a page has been rendered */
+} print_pipeline_t;
+
 static void cb_print_draw_page(GtkPrintOperation* print_operation,
-                               GtkPrintContext* context, gint page_number, zathura_t* zathura);
+                               GtkPrintContext* context, gint page_number, print_pipeline_t* pipeline);
 static void cb_print_end(GtkPrintOperation* print_operation, GtkPrintContext*
-                         context, zathura_t* zathura);
+                         context, print_pipeline_t* pipeline);
 static void cb_print_request_page_setup(GtkPrintOperation* print_operation,
-                                        GtkPrintContext* context, gint page_number, GtkPageSetup* setup, zathura_t*
-                                        zathura);
+                                        GtkPrintContext* context, gint page_number, GtkPageSetup* setup,
+                                        print_pipeline_t* pipeline);
+
+static print_pipeline_t*
+print_pipeline_new(zathura_t* zathura)
+{
+  print_pipeline_t* pipeline = g_malloc0(sizeof(print_pipeline_t));
+  pipeline->zathura   = zathura;
+  pipeline->last_page = -1;
+  for (unsigned int i = 0; i < PRINT_RING_SIZE; i++) {
+    pipeline->slots[i].page  = -1;
+    pipeline->slots[i].state = PRINT_SLOT_FREE;
+  }
+  mutex_init(&pipeline->lock);
+  cond_init(&pipeline->changed);
+
+  return pipeline;
+}
+
+static void
+print_pipeline_stop(print_pipeline_t* pipeline)
+{
+  mutex_lock(&pipeline->lock);
+  pipeline->cancelled = true;
+  mutex_unlock(&pipeline->lock);
+
+  /* drop the pages that have not been started and wait for the others */
+  if (pipeline->pool != NULL) {
+    g_thread_pool_free(pipeline->pool, TRUE, TRUE);
+    pipeline->pool = NULL;
+  }
+
+  for (unsigned int i = 0; i < PRINT_RING_SIZE; i++) {
+    if (pipeline->slots[i].surface != NULL) {
+      cairo_surface_destroy(pipeline->slots[i].surface);
+      pipeline->slots[i].surface = NULL;
+    }
+    pipeline->slots[i].page  = -1;
+    pipeline->slots[i].state = PRINT_SLOT_FREE;
+  }
+}
+
+static void
+print_pipeline_free(gpointer data)
+{
+  print_pipeline_t* pipeline = data;
+  if (pipeline == NULL) {
+    return;
+  }
+
+  print_pipeline_stop(pipeline);
+  cond_free(&pipeline->changed);
+  mutex_free(&pipeline->lock);
+  g_free(pipeline);
+}
 
 void
 print(zathura_t* zathura)
@@ -24,6 +106,12 @@ print(zathura_t* zathura)
 
   GtkPrintOperation* print_operation = gtk_print_operation_new();
 
+  /* the pipeline lives as long as the print operation, which might outlive
+   * this function if it runs asynchronously */
+  print_pipeline_t* pipeline = print_pipeline_new(zathura);
+  g_object_set_data_full(G_OBJECT(print_operation), "zathura-print-pipeline",
+                         pipeline, print_pipeline_free);
+
   /* print operation settings */
   if (zathura->print.settings != NULL) {
     gtk_print_operation_set_print_settings(print_operation, zathura->print.settings);
@@ -40,9 +128,9 @@ print(zathura_t* zathura)
   gtk_print_operation_set_embed_page_setup(print_operation, TRUE);
 
   /* print operation signals */
-  g_signal_connect(print_operation, "draw-page",          G_CALLBACK(cb_print_draw_page),          zathura);
-  g_signal_connect(print_operation, "end-print",          G_CALLBACK(cb_print_end),                zathura);
-  g_signal_connect(print_operation, "request-page-setup", G_CALLBACK(cb_print_request_page_setup), zathura);
+  g_signal_connect(print_operation, "draw-page",          G_CALLBACK(cb_print_draw_page),          pipeline);
+  g_signal_connect(print_operation, "end-print",          G_CALLBACK(cb_print_end),                pipeline);
+  g_signal_connect(print_operation, "request-page-setup", G_CALLBACK(cb_print_request_page_setup), pipeline);
 
   /* print */
   GtkPrintOperationResult result = gtk_print_operation_run(print_operation,
@@ -68,8 +156,11 @@ print(zathura_t* zathura)
 
 static void
 cb_print_end(GtkPrintOperation* UNUSED(print_operation), GtkPrintContext*
-             UNUSED(context), zathura_t* zathura)
+             UNUSED(context), print_pipeline_t* pipeline)
 {
+  print_pipeline_stop(pipeline);
+
+  zathura_t* zathura = pipeline->zathura;
   if (zathura == NULL || zathura->ui.session == NULL || zathura->document == NULL) {
     return;
   }
@@ -82,10 +173,154 @@ cb_print_end(GtkPrintOperation* UNUSED(print_operation), GtkPrintContext*
   }
 }
 
+/* Renders the page on an image surface, reusing the given one if it has the
+ * right size. Returns the surface or NULL on failure. */
+static cairo_surface_t*
+print_render_page(zathura_t* zathura, zathura_page_t* page, cairo_surface_t* surface)
+{
+  const int page_width  = zathura_page_get_width(page);
+  const int page_height = zathura_page_get_height(page);
+
+  if (surface != NULL && (cairo_image_surface_get_width(surface) != page_width ||
+        cairo_image_surface_get_height(surface) != page_height)) {
+    cairo_surface_destroy(surface);
+    surface = NULL;
+  }
+
+  if (surface == NULL) {
+    surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, page_width, page_height);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+      cairo_surface_destroy(surface);
+      return NULL;
+    }
+  }
+
+  cairo_t* cairo = cairo_create(surface);
+  if (cairo == NULL) {
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+
+  /* Draw a white background. */
+  cairo_save(cairo);
+  cairo_set_source_rgb(cairo, 1, 1, 1);
+  cairo_rectangle(cairo, 0, 0, page_width, page_height);
+  cairo_fill(cairo);
+  cairo_restore(cairo);
+
+  const bool serialize = render_is_serialized(zathura->sync.render_thread);
+  if (serialize == true) {
+    render_lock(zathura->sync.render_thread);
+  }
+  const int err = zathura_page_render(page, cairo, true);
+  if (serialize == true) {
+    render_unlock(zathura->sync.render_thread);
+  }
+  cairo_destroy(cairo);
+
+  if (err != ZATHURA_ERROR_OK) {
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+
+  return surface;
+}
+
+static void
+print_render_job(gpointer data, gpointer user_data)
+{
+  print_pipeline_t* pipeline = user_data;
+  print_slot_t* slot = &pipeline->slots[GPOINTER_TO_UINT(data) - 1];
+
+  /* queued slots are only touched by the thread rendering them */
+  mutex_lock(&pipeline->lock);
+  const bool cancelled = pipeline->cancelled;
+  mutex_unlock(&pipeline->lock);
+
+  cairo_surface_t* surface = NULL;
+  if (cancelled == false) {
+    zathura_page_t* page = zathura_document_get_page(pipeline->zathura->document, slot->page);
+    if (page != NULL) {
+      girara_debug("printing page %d ...", slot->page);
+      surface = print_render_page(pipeline->zathura, page, slot->surface);
+      slot->surface = NULL;
+    }
+  }
+
+  mutex_lock(&pipeline->lock);
+  if (surface != NULL) {
+    slot->surface = surface;
+  }
+  slot->state = surface != NULL ? PRINT_SLOT_READY : PRINT_SLOT_FAILED;
+  cond_broadcast(&pipeline->changed);
+  mutex_unlock(&pipeline->lock);
+}
+
+static bool
+print_pipeline_start(print_pipeline_t* pipeline)
+{
+  if (pipeline->pool != NULL) {
+    return true;
+  }
+
+  /* plugins that can not render in parallel only get one thread */
+  int threads = 1;
+  if (render_is_serialized(pipeline->zathura->sync.render_thread) == false) {
+    girara_setting_get(pipeline->zathura->ui.session, "render-threads", &threads);
+    threads = CLAMP(threads, 1, PRINT_RING_SIZE);
+  }
+
+  pipeline->pool = g_thread_pool_new(print_render_job, pipeline, threads, TRUE, NULL);
+  return pipeline->pool != NULL;
+}
+
+/* Returns the slot of the page and queues the page if it has not been
+ * queued yet. If wait is false, the page is only queued if a slot is free.
+ * Has to be called with the lock held. */
+static print_slot_t*
+print_pipeline_request(print_pipeline_t* pipeline, int page_number, bool wait)
+{
+  for (;;) {
+    print_slot_t* free_slot = NULL;
+    for (unsigned int i = 0; i < PRINT_RING_SIZE; i++) {
+      print_slot_t* slot = &pipeline->slots[i];
+      if (slot->state != PRINT_SLOT_FREE && slot->page == page_number) {
+        return slot;
+      }
+      if (slot->state == PRINT_SLOT_FREE && free_slot == NULL) {
+        free_slot = slot;
+      }
+    }
+
+    /* the pages rendered ahead have not been printed; drop one if this page
+     * is needed now */
+    if (free_slot == NULL && wait == true) {
+      for (unsigned int i = 0; i < PRINT_RING_SIZE && free_slot == NULL; i++) {
+        if (pipeline->slots[i].state != PRINT_SLOT_QUEUED) {
+          free_slot = &pipeline->slots[i];
+        }
+      }
+    }
+
+    if (free_slot != NULL) {
+      free_slot->page  = page_number;
+      free_slot->state = PRINT_SLOT_QUEUED;
+      g_thread_pool_push(pipeline->pool,
+          GUINT_TO_POINTER(free_slot - pipeline->slots + 1), NULL);
+      return free_slot;
+    } else if (wait == false) {
+      return NULL;
+    }
+
+    cond_wait(&pipeline->changed, &pipeline->lock);
+  }
+}
+
 static void
 cb_print_draw_page(GtkPrintOperation* print_operation, GtkPrintContext*
-                   context, gint page_number, zathura_t* zathura)
+                   context, gint page_number, print_pipeline_t* pipeline)
 {
+  zathura_t* zathura = pipeline->zathura;
   if (context == NULL || zathura == NULL || zathura->document == NULL ||
       zathura->ui.session == NULL || zathura->ui.statusbar.file == NULL) {
     gtk_print_operation_cancel(print_operation);
@@ -106,70 +341,83 @@ cb_print_draw_page(GtkPrintOperation* print_operation, GtkPrintContext*
     return;
   }
 
+  const bool serialize = render_is_serialized(zathura->sync.render_thread);
+
   /* Try to render the page without a temporary surface. This only works with
    * plugins that support rendering to any surface.  */
-  girara_debug("printing page %d ...", page_number);
-  render_lock(zathura->sync.render_thread);
-  int err = zathura_page_render(page, cairo, true);
-  render_unlock(zathura->sync.render_thread);
-  if (err == ZATHURA_ERROR_OK) {
-    return;
-  }
+  if (pipeline->raster == false) {
+    girara_debug("printing page %d ...", page_number);
+    if (serialize == true) {
+      render_lock(zathura->sync.render_thread);
+    }
+    const int err = zathura_page_render(page, cairo, true);
+    if (serialize == true) {
+      render_unlock(zathura->sync.render_thread);
+    }
+    if (err == ZATHURA_ERROR_OK) {
+      return;
+    }
 
-  /* Try to render the page on a temporary image surface. */
-  const gdouble width = gtk_print_context_get_width(context);
-  const gdouble height = gtk_print_context_get_height(context);
+    /* all other pages are rendered on image surfaces, too */
+    pipeline->raster = true;
+  }
 
-  const double page_height = zathura_page_get_height(page);
-  const double page_width  = zathura_page_get_width(page);
-  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, page_width, page_height);
-  if (surface == NULL) {
+  /* Render the page and the following ones on temporary image surfaces in
+   * the background. */
+  if (print_pipeline_start(pipeline) == false) {
     gtk_print_operation_cancel(print_operation);
     return;
   }
 
-  cairo_t* temp_cairo = cairo_create(surface);
-  if (cairo == NULL) {
-    gtk_print_operation_cancel(print_operation);
-    cairo_surface_destroy(surface);
-    return;
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  const int direction = pipeline->last_page > page_number ? -1 : 1;
+  pipeline->last_page = page_number;
+
+  mutex_lock(&pipeline->lock);
+  print_slot_t* slot = print_pipeline_request(pipeline, page_number, true);
+  for (int i = 1; i < PRINT_RING_SIZE; i++) {
+    const int next = page_number + i * direction;
+    if (next < 0 || (unsigned int) next >= number_of_pages ||
+        print_pipeline_request(pipeline, next, false) == NULL) {
+      break;
+    }
   }
 
-  /* Draw a white background. */
-  cairo_save(temp_cairo);
-  cairo_set_source_rgb(temp_cairo, 1, 1, 1);
-  cairo_rectangle(temp_cairo, 0, 0, page_width, page_height);
-  cairo_fill(temp_cairo);
-  cairo_restore(temp_cairo);
-
-  /* Render the page to the temporary surface */
-  girara_debug("printing page %d ...", page_number);
-  render_lock(zathura->sync.render_thread);
-  err = zathura_page_render(page, temp_cairo, true);
-  render_unlock(zathura->sync.render_thread);
-  if (err != ZATHURA_ERROR_OK) {
-    cairo_destroy(temp_cairo);
-    cairo_surface_destroy(surface);
-    gtk_print_operation_cancel(print_operation);
-    return;
+  while (slot->state == PRINT_SLOT_QUEUED) {
+    cond_wait(&pipeline->changed, &pipeline->lock);
+  }
+
+  const bool rendered = slot->state == PRINT_SLOT_READY;
+  if (rendered == true) {
+    /* Rescale the page and keep the aspect ratio */
+    const gdouble width  = gtk_print_context_get_width(context);
+    const gdouble height = gtk_print_context_get_height(context);
+    const double page_height = zathura_page_get_height(page);
+    const double page_width  = zathura_page_get_width(page);
+    const gdouble scale = MIN(width / page_width, height / page_height);
+    cairo_scale(cairo, scale, scale);
+
+    /* Blit temporary surface to original cairo object. */
+    cairo_set_source_surface(cairo, slot->surface, 0.0, 0.0);
+    cairo_paint(cairo);
   }
 
-  /* Rescale the page and keep the aspect ratio */
-  const gdouble scale = MIN(width / page_width, height / page_height);
-  cairo_scale(cairo, scale, scale);
+  /* the surface is reused for one of the next pages */
+  slot->page  = -1;
+  slot->state = PRINT_SLOT_FREE;
+  mutex_unlock(&pipeline->lock);
 
-  /* Blit temporary surface to original cairo object. */
-  cairo_set_source_surface(cairo, surface, 0.0, 0.0);
-  cairo_paint(cairo);
-  cairo_destroy(temp_cairo);
-  cairo_surface_destroy(surface);
+  if (rendered == false) {
+    gtk_print_operation_cancel(print_operation);
+  }
 }
 
 static void
 cb_print_request_page_setup(GtkPrintOperation* UNUSED(print_operation),
                             GtkPrintContext* UNUSED(context), gint page_number, GtkPageSetup* setup,
-                            zathura_t* zathura)
+                            print_pipeline_t* pipeline)
 {
+  zathura_t* zathura = pipeline->zathura;
   if (zathura == NULL || zathura->document == NULL) {
     return;
   }
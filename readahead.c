@@ -0,0 +1,110 @@
+/* See LICENSE file for license and copyright information */
+
+#define _XOPEN_SOURCE 700
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <glib.h>
+#include <girara/utils.h>
+
+#include "readahead.h"
+
+struct zathura_readahead_s {
+  int fd; /**< File descriptor of the file */
+  uint64_t size; /**< Size of the file in bytes */
+};
+
+static bool
+readahead_advise(int fd, uint64_t offset, uint64_t length)
+{
+#ifdef POSIX_FADV_WILLNEED
+  return posix_fadvise(fd, offset, length, POSIX_FADV_WILLNEED) == 0;
+#else
+  (void) fd;
+  (void) offset;
+  (void) length;
+  return false;
+#endif
+}
+
+bool
+zathura_readahead_file(const char* path, uint64_t max_size)
+{
+  if (path == NULL || max_size == 0) {
+    return false;
+  }
+
+  const int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  /* the data stays in the page cache after the file has been closed */
+  bool advised = false;
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) &&
+      (uint64_t) info.st_size <= max_size) {
+    advised = readahead_advise(fd, 0, info.st_size);
+    if (advised == true) {
+      girara_debug("reading ahead '%s' (%" PRIu64 " KiB)", path,
+          (uint64_t) info.st_size / 1024);
+    }
+  }
+
+  close(fd);
+  return advised;
+}
+
+zathura_readahead_t*
+zathura_readahead_new(const char* path)
+{
+  if (path == NULL) {
+    return NULL;
+  }
+
+  const int fd = open(path, O_RDONLY);
+  if (fd == -1) {
+    return NULL;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || S_ISREG(info.st_mode) == 0) {
+    close(fd);
+    return NULL;
+  }
+
+  zathura_readahead_t* readahead = g_malloc0(sizeof(zathura_readahead_t));
+  readahead->fd   = fd;
+  readahead->size = info.st_size;
+
+  return readahead;
+}
+
+void
+zathura_readahead_free(zathura_readahead_t* readahead)
+{
+  if (readahead == NULL) {
+    return;
+  }
+
+  close(readahead->fd);
+  g_free(readahead);
+}
+
+bool
+zathura_readahead_range(zathura_readahead_t* readahead, uint64_t offset, uint64_t length)
+{
+  if (readahead == NULL || length == 0 || offset >= readahead->size) {
+    return false;
+  }
+
+  /* ranges reported by plugins might reach beyond the end of the file */
+  if (length > readahead->size - offset) {
+    length = readahead->size - offset;
+  }
+
+  return readahead_advise(readahead->fd, offset, length);
+}
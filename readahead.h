@@ -0,0 +1,48 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct zathura_readahead_s zathura_readahead_t;
+
+/**
+ * Asks the system to read a whole file into the page cache in the
+ * background, so that the many small reads of plugins do not wait for slow
+ * storage such as network file systems.
+ *
+ * @param path Path of the file
+ * @param max_size Files larger than this number of bytes are not read ahead
+ * @return true if the file is being read ahead
+ */
+bool zathura_readahead_file(const char* path, uint64_t max_size);
+
+/**
+ * Opens a file to read parts of it ahead later on
+ *
+ * @param path Path of the file
+ * @return The object or NULL if the file could not be opened
+ */
+zathura_readahead_t* zathura_readahead_new(const char* path);
+
+/**
+ * Frees the object and closes the file
+ *
+ * @param readahead The object
+ */
+void zathura_readahead_free(zathura_readahead_t* readahead);
+
+/**
+ * Asks the system to read a range of the file into the page cache in the
+ * background. The call does not wait for the data.
+ *
+ * @param readahead The object
+ * @param offset Offset of the range in bytes
+ * @param length Length of the range in bytes
+ * @return true if the range is being read ahead
+ */
+bool zathura_readahead_range(zathura_readahead_t* readahead, uint64_t offset, uint64_t length);
+
+#endif // READAHEAD_H
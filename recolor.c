@@ -0,0 +1,196 @@
+/* See LICENSE file for license and copyright information */
+
+#include <math.h>
+
+#include "recolor.h"
+
+/* RGB weights for computing lightness. Must sum to one */
+static const double a[] = {0.30, 0.59, 0.11};
+
+/* Marks unused cache entries; valid colors only use the lower 24 bits */
+#define RECOLOR_CACHE_EMPTY 0xFFFFFFFF
+
+static void
+color2double(const GdkColor* col, double* v)
+{
+  v[0] = (double) col->red / 65535.;
+  v[1] = (double) col->green / 65535.;
+  v[2] = (double) col->blue / 65535.;
+}
+
+/* Returns the maximum possible saturation for given h and l.
+   Assumes that l is in the interval l1, l2 and corrects the value to
+   force u=0 on l1 and l2 */
+static double
+colorumax(const double* h, double l, double l1, double l2)
+{
+  double u, uu, v, vv, lv;
+  if (h[0] == 0 && h[1] == 0 && h[2] == 0) {
+    return 0;
+  }
+
+  lv = (l - l1)/(l2 - l1);    /* Remap l to the whole interval 0,1 */
+  u = v = 1000000;
+  for (int k = 0; k < 3; k++) {
+    if (h[k] > 0) {
+      uu = fabs((1-l)/h[k]);
+      vv = fabs((1-lv)/h[k]);
+
+      if (uu < u) {
+        u = uu;
+      }
+      if (vv < v) {
+        v = vv;
+      }
+    } else if (h[k] < 0) {
+      uu = fabs(l/h[k]);
+      vv = fabs(lv/h[k]);
+
+      if (uu < u) {
+        u = uu;
+      }
+      if (vv < v) {
+        v = vv;
+      }
+    }
+  }
+
+  /* rescale v according to the length of the interval [l1, l2] */
+  v = fabs(l2 - l1) * v;
+
+  /* forces the returned value to be 0 on l1 and l2, trying not to distort colors too much */
+  return fmin(u, v);
+}
+
+static inline uint32_t
+pixel_to_color(const unsigned char* data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16);
+}
+
+static inline void
+color_to_pixel(uint32_t color, unsigned char* data)
+{
+  data[0] = color & 0xFF;
+  data[1] = (color >> 8) & 0xFF;
+  data[2] = (color >> 16) & 0xFF;
+}
+
+static uint32_t
+recolor_color(const zathura_recolor_t* recolor, uint32_t color)
+{
+  unsigned char data[3];
+  color_to_pixel(color, data);
+  zathura_recolor_pixel(recolor, data);
+  return pixel_to_color(data);
+}
+
+void
+zathura_recolor_init(zathura_recolor_t* recolor, const GdkColor* dark_color,
+    const GdkColor* light_color, bool keep_hue)
+{
+  if (recolor == NULL || dark_color == NULL || light_color == NULL) {
+    return;
+  }
+
+  color2double(dark_color, recolor->rgb1);
+  color2double(light_color, recolor->rgb2);
+
+  recolor->l1 = (a[0]*recolor->rgb1[0] + a[1]*recolor->rgb1[1] + a[2]*recolor->rgb1[2]);
+  recolor->l2 = (a[0]*recolor->rgb2[0] + a[1]*recolor->rgb2[1] + a[2]*recolor->rgb2[2]);
+  recolor->keep_hue = keep_hue;
+
+  /* most pixels of a page are white, black or anti-aliased shades of grey */
+  for (unsigned int v = 0; v < ZATHURA_RECOLOR_TABLE_SIZE; v++) {
+    recolor->grey[v] = recolor_color(recolor, v | (v << 8) | (v << 16));
+  }
+
+  for (unsigned int i = 0; i < ZATHURA_RECOLOR_TABLE_SIZE; i++) {
+    recolor->cache[i].color  = RECOLOR_CACHE_EMPTY;
+    recolor->cache[i].result = 0;
+  }
+}
+
+void
+zathura_recolor_pixel(const zathura_recolor_t* recolor, unsigned char* data)
+{
+  /* uses a representation of a rgb color as follows:
+     - a lightness scalar (between 0,1), which is a weighted average of r, g, b,
+     - a hue vector, which indicates a radian direction from the grey axis, inside the equal lightness plane.
+     - a saturation scalar between 0,1. It is 0 when grey, 1 when the color is in the boundary of the rgb cube.
+  */
+  const double l1 = recolor->l1;
+  const double l2 = recolor->l2;
+  const double* rgb1 = recolor->rgb1;
+  const double* rgb2 = recolor->rgb2;
+
+  double l, s, u, t;
+  double h[3];
+  double rgb[3];
+
+  /* Careful. data color components blue, green, red. */
+  rgb[0] = (double) data[2] / 256.;
+  rgb[1] = (double) data[1] / 256.;
+  rgb[2] = (double) data[0] / 256.;
+
+  /* compute h, s, l data   */
+  l = a[0]*rgb[0] + a[1]*rgb[1] + a[2]*rgb[2];
+
+  h[0] = rgb[0] - l;
+  h[1] = rgb[1] - l;
+  h[2] = rgb[2] - l;
+
+  /* u is the maximum possible saturation for given h and l. s is a rescaled saturation between 0 and 1 */
+  u = colorumax(h, l, 0, 1);
+  if (u == 0) {
+    s = 0;
+  } else {
+    s = 1/u;
+  }
+
+  /* Interpolates lightness between light and dark colors. white goes to light, and black goes to dark. */
+  t = l;
+  l = t * (l2 - l1) + l1;
+
+  if (recolor->keep_hue == true) {
+    /* adjusting lightness keeping hue of current color. white and black go to grays of same ligtness
+       as light and dark colors. */
+    u = colorumax(h, l, l1, l2);
+    data[2] = (unsigned char)round(255.*(l + s*u * h[0]));
+    data[1] = (unsigned char)round(255.*(l + s*u * h[1]));
+    data[0] = (unsigned char)round(255.*(l + s*u * h[2]));
+  } else {
+    /* Linear interpolation between dark and light with color ligtness as a parameter */
+    data[2] = (unsigned char)round(255.*(t * (rgb2[0] - rgb1[0]) + rgb1[0]));
+    data[1] = (unsigned char)round(255.*(t * (rgb2[1] - rgb1[1]) + rgb1[1]));
+    data[0] = (unsigned char)round(255.*(t * (rgb2[2] - rgb1[2]) + rgb1[2]));
+  }
+}
+
+void
+zathura_recolor_image(zathura_recolor_t* recolor, unsigned char* image,
+    unsigned int width, unsigned int height, unsigned int rowstride)
+{
+  if (recolor == NULL || image == NULL) {
+    return;
+  }
+
+  for (unsigned int y = 0; y < height; y++) {
+    unsigned char* data = image + y * rowstride;
+
+    for (unsigned int x = 0; x < width; x++, data += 4) {
+      if (data[0] == data[1] && data[1] == data[2]) {
+        color_to_pixel(recolor->grey[data[0]], data);
+        continue;
+      }
+
+      const uint32_t color = pixel_to_color(data);
+      const unsigned int index = ((color * 2654435761u) >> 24) % ZATHURA_RECOLOR_TABLE_SIZE;
+      if (recolor->cache[index].color != color) {
+        recolor->cache[index].color  = color;
+        recolor->cache[index].result = recolor_color(recolor, color);
+      }
+      color_to_pixel(recolor->cache[index].result, data);
+    }
+  }
+}
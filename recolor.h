@@ -0,0 +1,69 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef RECOLOR_H
+#define RECOLOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <gtk/gtk.h>
+
+/**
+ * Number of entries of the recolor lookup tables
+ */
+#define ZATHURA_RECOLOR_TABLE_SIZE 256
+
+/**
+ * Recolor state. Recoloring a pixel is a pure function of its color, so the
+ * results for grey pixels are precomputed and the results for other colors
+ * are remembered in a small direct-mapped cache. Since every entry is
+ * computed with zathura_recolor_pixel, the result is identical to recoloring
+ * each pixel on its own.
+ *
+ * The state is not thread-safe; every thread needs its own copy.
+ */
+typedef struct zathura_recolor_s {
+  double rgb1[3]; /**< Dark color */
+  double rgb2[3]; /**< Light color */
+  double l1; /**< Lightness of the dark color */
+  double l2; /**< Lightness of the light color */
+  bool keep_hue; /**< Keep the hue of the recolored pixels */
+  uint32_t grey[ZATHURA_RECOLOR_TABLE_SIZE]; /**< Results for grey pixels */
+  struct {
+    uint32_t color; /**< Input color */
+    uint32_t result; /**< Recolored color */
+  } cache[ZATHURA_RECOLOR_TABLE_SIZE]; /**< Results for recently seen colors */
+} zathura_recolor_t;
+
+/**
+ * Initializes the recolor state
+ *
+ * @param recolor The recolor state
+ * @param dark_color The color dark colors are mapped to
+ * @param light_color The color light colors are mapped to
+ * @param keep_hue Keep the hue of the original colors
+ */
+void zathura_recolor_init(zathura_recolor_t* recolor, const GdkColor*
+    dark_color, const GdkColor* light_color, bool keep_hue);
+
+/**
+ * Recolors a single pixel without using the lookup tables
+ *
+ * @param recolor The recolor state
+ * @param data The pixel (blue, green and red component)
+ */
+void zathura_recolor_pixel(const zathura_recolor_t* recolor, unsigned char* data);
+
+/**
+ * Recolors an image in CAIRO_FORMAT_RGB24 or CAIRO_FORMAT_ARGB32 format. The
+ * alpha component is not changed.
+ *
+ * @param recolor The recolor state
+ * @param image The image data
+ * @param width The width of the image
+ * @param height The height of the image
+ * @param rowstride The length of a row in bytes
+ */
+void zathura_recolor_image(zathura_recolor_t* recolor, unsigned char* image,
+    unsigned int width, unsigned int height, unsigned int rowstride);
+
+#endif // RECOLOR_H
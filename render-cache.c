@@ -0,0 +1,318 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <girara/utils.h>
+
+#include "glib-compat.h"
+#include "render-cache.h"
+
+#define RENDER_CACHE_MAGIC 0x3143525a /* "ZRC1" */
+#define RENDER_CACHE_SUFFIX ".surface"
+
+/**
+ * Header of a stored surface; the pixel data follows it
+ */
+typedef struct render_cache_header_s {
+  guint32 magic; /**< RENDER_CACHE_MAGIC */
+  guint32 format; /**< The cairo format */
+  guint32 width; /**< Width of the surface */
+  guint32 height; /**< Height of the surface */
+  guint32 stride; /**< Stride of the surface */
+  guint32 reserved[3]; /**< Keeps the pixel data aligned */
+} render_cache_header_t;
+
+/**
+ * A stored surface, used while cleaning up
+ */
+typedef struct render_cache_file_s {
+  char* name; /**< The file name */
+  gint64 mtime; /**< Time the surface has been used last */
+  size_t size; /**< Size of the file */
+} render_cache_file_t;
+
+struct zathura_render_cache_s {
+  char* dir; /**< Directory of the cache */
+  char* document; /**< Identifies the version of the document */
+  size_t max_bytes; /**< Budget of the directory */
+  size_t bytes; /**< Size of the stored surfaces */
+  mutex lock; /**< Lock */
+};
+
+/* distinguishes the temporary files of concurrent writers */
+static gint render_cache_counter = 0;
+
+static const cairo_user_data_key_t render_cache_mapping_key;
+
+static size_t
+render_cache_get_file_size(const char* file)
+{
+  GStatBuf info;
+  if (g_stat(file, &info) != 0) {
+    return 0;
+  }
+
+  return info.st_size;
+}
+
+static char*
+render_cache_get_file(zathura_render_cache_t* cache, const zathura_page_cache_key_t* key)
+{
+  /* the bits of the scale are used, so that equal scales always give the same
+   * name regardless of the locale */
+  guint64 scale = 0;
+  memcpy(&scale, &key->scale, MIN(sizeof(scale), sizeof(key->scale)));
+
+  char* name = g_strdup_printf("%s-%u-%016" G_GINT64_MODIFIER "x-%u" RENDER_CACHE_SUFFIX,
+      cache->document, key->page, scale, key->recolor);
+  char* file = g_build_filename(cache->dir, name, NULL);
+  g_free(name);
+
+  return file;
+}
+
+static gint
+render_cache_file_compare(gconstpointer a, gconstpointer b)
+{
+  const render_cache_file_t* file_a = a;
+  const render_cache_file_t* file_b = b;
+
+  if (file_a->mtime < file_b->mtime) {
+    return -1;
+  } else if (file_a->mtime > file_b->mtime) {
+    return 1;
+  }
+
+  return 0;
+}
+
+/* removes the least recently used surfaces until the cache fits into its
+ * budget; has to be called with the lock held */
+static void
+render_cache_cleanup(zathura_render_cache_t* cache)
+{
+  GDir* handle = g_dir_open(cache->dir, 0, NULL);
+  if (handle == NULL) {
+    return;
+  }
+
+  GArray* files = g_array_new(FALSE, FALSE, sizeof(render_cache_file_t));
+  size_t bytes = 0;
+
+  const char* name = NULL;
+  while ((name = g_dir_read_name(handle)) != NULL) {
+    if (g_str_has_suffix(name, RENDER_CACHE_SUFFIX) == FALSE) {
+      continue;
+    }
+
+    char* path = g_build_filename(cache->dir, name, NULL);
+    GStatBuf info;
+    if (g_stat(path, &info) == 0) {
+      render_cache_file_t file = { path, info.st_mtime, info.st_size };
+      g_array_append_val(files, file);
+      bytes += file.size;
+    } else {
+      g_free(path);
+    }
+  }
+  g_dir_close(handle);
+
+  g_array_sort(files, render_cache_file_compare);
+
+  unsigned int removed = 0;
+  for (guint i = 0; i < files->len; i++) {
+    render_cache_file_t* file = &g_array_index(files, render_cache_file_t, i);
+    if (bytes > cache->max_bytes && g_unlink(file->name) == 0) {
+      bytes -= file->size;
+      ++removed;
+    }
+    g_free(file->name);
+  }
+  g_array_free(files, TRUE);
+
+  cache->bytes = bytes;
+  if (removed > 0) {
+    girara_debug("removed %u surface(s) from the render cache", removed);
+  }
+}
+
+zathura_render_cache_t*
+zathura_render_cache_new(const char* dir, const char* path, gint64 mtime,
+    gint64 size, size_t max_bytes)
+{
+  if (dir == NULL || path == NULL) {
+    return NULL;
+  }
+
+  if (g_mkdir_with_parents(dir, 0700) != 0) {
+    girara_error("could not create render cache directory '%s'", dir);
+    return NULL;
+  }
+
+  /* surfaces of another version of the document are never used again and
+   * are removed once they are the least recently used ones */
+  char* identity = g_strdup_printf("%s\n%" G_GINT64_FORMAT "\n%" G_GINT64_FORMAT,
+      path, mtime, size);
+
+  zathura_render_cache_t* cache = g_malloc0(sizeof(zathura_render_cache_t));
+  cache->dir       = g_strdup(dir);
+  cache->document  = g_compute_checksum_for_string(G_CHECKSUM_SHA1, identity, -1);
+  cache->max_bytes = max_bytes;
+  mutex_init(&cache->lock);
+  g_free(identity);
+
+  mutex_lock(&cache->lock);
+  render_cache_cleanup(cache);
+  mutex_unlock(&cache->lock);
+
+  return cache;
+}
+
+void
+zathura_render_cache_free(zathura_render_cache_t* cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  mutex_free(&cache->lock);
+  g_free(cache->document);
+  g_free(cache->dir);
+  g_free(cache);
+}
+
+cairo_surface_t*
+zathura_render_cache_get(zathura_render_cache_t* cache, const
+    zathura_page_cache_key_t* key)
+{
+  if (cache == NULL || key == NULL) {
+    return NULL;
+  }
+
+  char* file = render_cache_get_file(cache, key);
+  /* the mapping is private, so that the surface can be modified without
+   * touching the file */
+  GMappedFile* mapped = g_mapped_file_new(file, TRUE, NULL);
+  if (mapped == NULL) {
+    g_free(file);
+    return NULL;
+  }
+
+  const gsize length = g_mapped_file_get_length(mapped);
+  char* contents = g_mapped_file_get_contents(mapped);
+
+  render_cache_header_t header;
+  bool valid = length >= sizeof(header);
+  if (valid == true) {
+    memcpy(&header, contents, sizeof(header));
+    valid = header.magic == RENDER_CACHE_MAGIC &&
+      (header.format == CAIRO_FORMAT_RGB24 || header.format == CAIRO_FORMAT_ARGB32) &&
+      header.width > 0 && header.height > 0 &&
+      (int) header.stride == cairo_format_stride_for_width(header.format, header.width) &&
+      length - sizeof(header) >= (gsize) header.stride * header.height;
+  }
+
+  if (valid == false) {
+    girara_debug("removing invalid surface '%s' from the render cache", file);
+    g_mapped_file_unref(mapped);
+    g_unlink(file);
+    g_free(file);
+    return NULL;
+  }
+
+  cairo_surface_t* surface = cairo_image_surface_create_for_data(
+      (unsigned char*) contents + sizeof(header), header.format, header.width,
+      header.height, header.stride);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surface);
+    g_mapped_file_unref(mapped);
+    g_free(file);
+    return NULL;
+  }
+
+  /* the mapping lives as long as the surface */
+  cairo_surface_set_user_data(surface, &render_cache_mapping_key, mapped,
+      (cairo_destroy_func_t) g_mapped_file_unref);
+
+  /* mark the surface as recently used */
+  g_utime(file, NULL);
+  g_free(file);
+
+  return surface;
+}
+
+bool
+zathura_render_cache_add(zathura_render_cache_t* cache, const
+    zathura_page_cache_key_t* key, cairo_surface_t* surface)
+{
+  if (cache == NULL || key == NULL || surface == NULL ||
+      cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE) {
+    return false;
+  }
+
+  render_cache_header_t header = {
+    .magic  = RENDER_CACHE_MAGIC,
+    .format = cairo_image_surface_get_format(surface),
+    .width  = cairo_image_surface_get_width(surface),
+    .height = cairo_image_surface_get_height(surface),
+    .stride = cairo_image_surface_get_stride(surface)
+  };
+
+  const size_t data_size = (size_t) header.stride * header.height;
+  if (data_size + sizeof(header) > cache->max_bytes) {
+    return false;
+  }
+
+  char* file = render_cache_get_file(cache, key);
+  char* tmp  = g_strdup_printf("%s.%d-%d.tmp", file, (int) getpid(),
+      g_atomic_int_add(&render_cache_counter, 1));
+
+  /* write to a temporary file first, so that readers never map a partially
+   * written surface */
+  cairo_surface_flush(surface);
+  bool stored = false;
+  FILE* stream = g_fopen(tmp, "wb");
+  if (stream != NULL) {
+    stored = fwrite(&header, sizeof(header), 1, stream) == 1 &&
+      fwrite(cairo_image_surface_get_data(surface), data_size, 1, stream) == 1;
+    stored = fclose(stream) == 0 && stored == true;
+  }
+
+  mutex_lock(&cache->lock);
+  const size_t old_size = render_cache_get_file_size(file);
+  if (stored == true && g_rename(tmp, file) != 0) {
+    stored = false;
+  }
+
+  if (stored == true) {
+    cache->bytes = cache->bytes - MIN(cache->bytes, old_size) + sizeof(header) + data_size;
+    if (cache->bytes > cache->max_bytes) {
+      render_cache_cleanup(cache);
+    }
+  } else {
+    girara_debug("could not store '%s' in the render cache", file);
+    g_unlink(tmp);
+  }
+  mutex_unlock(&cache->lock);
+
+  g_free(tmp);
+  g_free(file);
+
+  return stored;
+}
+
+size_t
+zathura_render_cache_get_size(zathura_render_cache_t* cache)
+{
+  if (cache == NULL) {
+    return 0;
+  }
+
+  mutex_lock(&cache->lock);
+  const size_t bytes = cache->bytes;
+  mutex_unlock(&cache->lock);
+
+  return bytes;
+}
@@ -0,0 +1,69 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef RENDER_CACHE_H
+#define RENDER_CACHE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <cairo.h>
+
+#include "page-cache.h"
+
+typedef struct zathura_render_cache_s zathura_render_cache_t;
+
+/**
+ * Opens the on-disk cache of rendered pages of a document. Surfaces are
+ * stored uncompressed and memory-mapped when they are read, so reading a page
+ * costs little more than the page faults of painting it. The surfaces of all
+ * documents share one directory; the least recently used ones are removed once
+ * the directory grows larger than the budget.
+ *
+ * @param dir The directory of the cache
+ * @param path Path of the document
+ * @param mtime Modification time of the document
+ * @param size Size of the document
+ * @param max_bytes Budget of the directory in bytes
+ * @return The render cache or NULL if an error occured
+ */
+zathura_render_cache_t* zathura_render_cache_new(const char* dir, const char*
+    path, gint64 mtime, gint64 size, size_t max_bytes);
+
+/**
+ * Frees the render cache. The surfaces stay on disk.
+ *
+ * @param cache The render cache
+ */
+void zathura_render_cache_free(zathura_render_cache_t* cache);
+
+/**
+ * Reads a surface. This function is thread-safe.
+ *
+ * @param cache The render cache
+ * @param key The key of the surface; the tile is ignored
+ * @return The surface or NULL if it is not cached
+ */
+cairo_surface_t* zathura_render_cache_get(zathura_render_cache_t* cache, const
+    zathura_page_cache_key_t* key);
+
+/**
+ * Stores a surface and removes the least recently used surfaces if the
+ * budget is exceeded. This function is thread-safe.
+ *
+ * @param cache The render cache
+ * @param key The key of the surface; the tile is ignored
+ * @param surface The surface (an image surface)
+ * @return true if the surface has been stored
+ */
+bool zathura_render_cache_add(zathura_render_cache_t* cache, const
+    zathura_page_cache_key_t* key, cairo_surface_t* surface);
+
+/**
+ * Returns the memory used by the stored surfaces of all documents
+ *
+ * @param cache The render cache
+ * @return The size in bytes
+ */
+size_t zathura_render_cache_get_size(zathura_render_cache_t* cache);
+
+#endif // RENDER_CACHE_H
@@ -1,6 +1,7 @@
 /* See LICENSE file for license and copyright information */
 
 #include <math.h>
+#include <string.h>
 #include <girara/datastructures.h>
 #include <girara/utils.h>
 #include <girara/session.h>
@@ -11,48 +12,580 @@
 #include "zathura.h"
 #include "document.h"
 #include "page.h"
+#include "page-layout.h"
 #include "page-widget.h"
+#include "plugin.h"
+#include "internal.h"
+#include "prefetch.h"
+#include "readahead.h"
+#include "recolor.h"
+#include "stats.h"
 #include "utils.h"
 
 static void render_job(void* data, void* user_data);
-static bool render(zathura_t* zathura, zathura_page_t* page);
+static bool render(zathura_t* zathura, zathura_page_t* page, unsigned int tile, gint generation, bool prefetch, bool grouped, const gint* cancel);
+static bool render_preview(zathura_t* zathura, zathura_page_t* page, gint generation, const gint* cancel);
+static bool render_thumbnail(zathura_t* zathura, zathura_page_t* page, gint generation, const gint* cancel);
+static void render_metadata(zathura_t* zathura, zathura_page_t* page, gint generation);
 static gint render_thread_sort(gconstpointer a, gconstpointer b, gpointer data);
 
 struct render_thread_s {
   GThreadPool* pool; /**< Pool of threads */
   mutex mutex; /**< Render lock */
   bool about_to_close; /**< Render thread is to be freed */
+  bool serialize; /**< Plugin requires pages to be rendered one at a time */
+  gint generation; /**< Current render generation */
+  unsigned int tile_size; /**< Size of the tiles (0 if tiles are not used) */
+  bool preview; /**< Render a low resolution preview before the page */
+  unsigned int thumbnail_size; /**< Pages up to this size show thumbnails (0 to disable them) */
+  GHashTable* prefetching; /**< Pages that are queued for prefetching */
+  mutex prefetch_lock; /**< Lock for prefetching */
+  bool deferred; /**< Rendering waits until a zoom gesture has settled */
+  guint deferred_source; /**< Source that ends the deferral */
+  GPtrArray* running; /**< Cancel flags of the jobs in progress */
+  mutex running_lock; /**< Lock for running */
+  unsigned int jobs; /**< Number of jobs that are queued or in progress */
+  mutex jobs_lock; /**< Lock for jobs */
+  cond jobs_done; /**< Signalled when the last job has finished */
+  unsigned int number_of_pages; /**< Number of pages of the document */
+  zathura_readahead_t* readahead; /**< Reads the queued pages from the file ahead (or NULL) */
+  unsigned int group_size; /**< Pages per row that are shown together (1 if rows are not grouped) */
+  unsigned int group_column; /**< Column of the first page */
+  unsigned int* group_queued; /**< Per page number of render jobs that are queued or running */
+  struct render_group_entry_s* group_parked; /**< Per page rendered surface that waits for its row */
+  GList* group_shows; /**< Rows that wait to be shown by the main loop */
+  mutex group_lock; /**< Lock for the row groups */
+  GList* handoffs; /**< Results that wait to be passed on by the main loop */
+  mutex handoff_lock; /**< Lock for handoffs */
 };
 
+/**
+ * A rendered page that waits for the other pages of its row
+ */
+typedef struct render_group_entry_s {
+  cairo_surface_t* surface; /**< The surface (or NULL) */
+  zathura_page_cache_key_t key; /**< What has been rendered */
+  gint generation; /**< Render generation of the job */
+} render_group_entry_t;
+
+/**
+ * The rendered pages of a row that are shown together by the main loop
+ */
+typedef struct render_group_show_s {
+  zathura_t* zathura; /**< Zathura object */
+  render_thread_t* render_thread; /**< The render thread that rendered the row */
+  render_group_entry_t* entries; /**< The surfaces of the pages of the row */
+  unsigned int first; /**< Index of the first page of the row */
+  unsigned int n; /**< Number of pages of the row */
+} render_group_show_t;
+
+/* Previews are rendered at this fraction of the page's resolution */
+#define RENDER_PREVIEW_FACTOR 4
+
+/**
+ * What a render job renders
+ */
+typedef enum render_job_type_e {
+  RENDER_JOB_PAGE, /**< The page or one of its tiles */
+  RENDER_JOB_PREVIEW, /**< A low resolution preview */
+  RENDER_JOB_PREFETCH, /**< The hidden page into the page cache */
+  RENDER_JOB_THUMBNAIL, /**< A thumbnail of the page */
+  RENDER_JOB_METADATA /**< The links and images of the rendered page */
+} render_job_type_t;
+
+/**
+ * A queued render request
+ */
+typedef struct render_job_s {
+  zathura_page_t* page; /**< Page to render */
+  unsigned int tile; /**< Tile to render (0 for the whole page) */
+  gint generation; /**< Render generation the job was queued in */
+  render_job_type_t type; /**< What to render */
+  gint64 queued; /**< Time the job has been queued */
+  bool grouped; /**< The page is shown together with the other pages of its row */
+} render_job_t;
+
+/**
+ * The result of a render job that is passed on by the main loop
+ */
+typedef struct render_handoff_s {
+  zathura_t* zathura; /**< Zathura object */
+  render_thread_t* render_thread; /**< The render thread that ran the job */
+  zathura_page_t* page; /**< The page */
+  gint generation; /**< Render generation of the job */
+  render_job_type_t type; /**< What has been rendered */
+  unsigned int tile; /**< Rendered tile (0 for the whole page) */
+  cairo_surface_t* surface; /**< Rendered surface (or NULL) */
+  zathura_page_cache_key_t key; /**< What has been rendered */
+  bool cache; /**< The surface is added to the page cache */
+  bool grouped; /**< The page is shown together with the other pages of its row */
+  cairo_surface_t* base; /**< Un-recolored surface that is added to the page cache (or NULL) */
+  zathura_page_cache_key_t base_key; /**< What the un-recolored surface shows */
+  girara_list_t* links; /**< Links of the page (or NULL) */
+  girara_list_t* images; /**< Images of the page (or NULL) */
+  gint64 queued; /**< Time the result has been handed off */
+} render_handoff_t;
+
+static bool render_queue(render_thread_t* render_thread, zathura_page_t* page, unsigned int tile, render_job_type_t type);
+static void render_job_run(render_job_t* job, zathura_t* zathura);
+
+/* asks the plugin to stop all renders in progress */
+static void
+render_cancel(render_thread_t* render_thread)
+{
+  mutex_lock(&render_thread->running_lock);
+  for (unsigned int i = 0; i < render_thread->running->len; i++) {
+    g_atomic_int_set((gint*) g_ptr_array_index(render_thread->running, i), 1);
+  }
+  mutex_unlock(&render_thread->running_lock);
+}
+
+/* every job has its own flag, so that other jobs of the same page are not
+ * affected when it starts or ends */
+static void
+render_job_set_running(render_thread_t* render_thread, gint* cancel, bool running)
+{
+  mutex_lock(&render_thread->running_lock);
+  if (running == true) {
+    g_ptr_array_add(render_thread->running, cancel);
+  } else {
+    g_ptr_array_remove_fast(render_thread->running, cancel);
+  }
+  mutex_unlock(&render_thread->running_lock);
+}
+
+static void
+render_job_free(render_thread_t* render_thread, render_job_t* job)
+{
+  if (job->type == RENDER_JOB_PREFETCH) {
+    mutex_lock(&render_thread->prefetch_lock);
+    g_hash_table_remove(render_thread->prefetching,
+        GUINT_TO_POINTER(zathura_page_get_index(job->page)));
+    mutex_unlock(&render_thread->prefetch_lock);
+  }
+
+  g_free(job);
+}
+
+/* checks whether the job has been superseded or the render thread closes */
+static bool
+render_job_is_stale(render_thread_t* render_thread, render_job_t* job)
+{
+  return render_thread->about_to_close == true ||
+    job->generation != g_atomic_int_get(&render_thread->generation);
+}
+
+/* checks whether other pages of the row are still being rendered; the group
+ * lock has to be held */
+static bool
+render_group_is_pending(render_thread_t* render_thread, unsigned int page_id,
+    unsigned int* first, unsigned int* last)
+{
+  if (zathura_page_layout_get_row_pages(render_thread->group_size,
+        render_thread->group_column, render_thread->number_of_pages, page_id,
+        first, last) == false) {
+    return false;
+  }
+
+  for (unsigned int i = *first; i <= *last; i++) {
+    if (i != page_id && render_thread->group_queued[i] > 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/* shows the surfaces that wait in the range; the GDK lock has to be held */
+static void
+render_group_show(zathura_t* zathura, render_group_entry_t* entries, unsigned
+    int first, unsigned int n)
+{
+  render_thread_t* render_thread = zathura->sync.render_thread;
+
+  for (unsigned int i = 0; i < n; i++) {
+    render_group_entry_t* entry = &entries[i];
+    if (entry->surface == NULL) {
+      continue;
+    }
+
+    if (render_thread->about_to_close == false &&
+        entry->generation == g_atomic_int_get(&render_thread->generation)) {
+      zathura_page_t* page = zathura_document_get_page(zathura->document, first + i);
+      GtkWidget* widget = zathura_page_get_widget(zathura, page);
+      zathura_page_widget_update_surface(ZATHURA_PAGE(widget), entry->surface, &entry->key);
+    } else {
+      cairo_surface_destroy(entry->surface);
+    }
+    entry->surface = NULL;
+  }
+}
+
+/* keeps a rendered page until the other pages of its row have been
+ * rendered; returns false if the page can be shown right away. It is called
+ * by the main loop, so that the pages of a row that have been queued by the
+ * same draw are always seen as pending */
+static bool
+render_group_park(render_thread_t* render_thread, zathura_page_t* page,
+    cairo_surface_t* surface, const zathura_page_cache_key_t* key, gint
+    generation, bool grouped)
+{
+  if (grouped == false || render_thread->group_queued == NULL) {
+    return false;
+  }
+
+  const unsigned int page_id = zathura_page_get_index(page);
+  unsigned int first = 0;
+  unsigned int last  = 0;
+
+  mutex_lock(&render_thread->group_lock);
+  const bool pending = render_group_is_pending(render_thread, page_id, &first, &last);
+  if (pending == true) {
+    render_group_entry_t* entry = &render_thread->group_parked[page_id];
+    if (entry->surface != NULL) {
+      cairo_surface_destroy(entry->surface);
+    }
+    entry->surface    = cairo_surface_reference(surface);
+    entry->key        = *key;
+    entry->generation = generation;
+  }
+  mutex_unlock(&render_thread->group_lock);
+
+  return pending;
+}
+
+static void
+render_group_show_free(render_group_show_t* show)
+{
+  for (unsigned int i = 0; i < show->n; i++) {
+    if (show->entries[i].surface != NULL) {
+      cairo_surface_destroy(show->entries[i].surface);
+    }
+  }
+  g_free(show->entries);
+  g_free(show);
+}
+
+static gboolean
+render_group_show_idle(gpointer data)
+{
+  render_group_show_t* show = data;
+  render_thread_t* render_thread = show->render_thread;
+
+  mutex_lock(&render_thread->group_lock);
+  render_thread->group_shows = g_list_remove(render_thread->group_shows, show);
+  mutex_unlock(&render_thread->group_lock);
+
+  render_group_show(show->zathura, show->entries, show->first, show->n);
+  render_group_show_free(show);
+
+  return FALSE;
+}
+
+/* ends a render job of a page; once no page of its row is being rendered any
+ * more, the rendered pages of the row are shown at the same time by the main
+ * loop, since render_detach waits for the workers while holding the GDK lock */
+static void
+render_group_done(zathura_t* zathura, zathura_page_t* page)
+{
+  render_thread_t* render_thread = zathura->sync.render_thread;
+  if (render_thread->group_queued == NULL) {
+    return;
+  }
+
+  const unsigned int page_id = zathura_page_get_index(page);
+  if (page_id >= render_thread->number_of_pages) {
+    return;
+  }
+
+  /* waiting surfaces are freed together with the render thread */
+  const bool closing = render_thread->about_to_close;
+
+  mutex_lock(&render_thread->group_lock);
+  if (render_thread->group_queued[page_id] > 0) {
+    --render_thread->group_queued[page_id];
+  }
+
+  unsigned int first = 0;
+  unsigned int last  = 0;
+  render_group_show_t* show = NULL;
+  if (closing == false && render_thread->group_queued[page_id] == 0 &&
+      render_group_is_pending(render_thread, page_id, &first, &last) == false) {
+    const size_t size = (last - first + 1) * sizeof(render_group_entry_t);
+    show = g_malloc0(sizeof(render_group_show_t));
+    show->zathura       = zathura;
+    show->render_thread = render_thread;
+    show->first         = first;
+    show->n             = last - first + 1;
+    show->entries       = g_malloc(size);
+    memcpy(show->entries, &render_thread->group_parked[first], size);
+    memset(&render_thread->group_parked[first], 0, size);
+    render_thread->group_shows = g_list_prepend(render_thread->group_shows, show);
+  }
+  mutex_unlock(&render_thread->group_lock);
+
+  if (show != NULL) {
+    gdk_threads_add_idle(render_group_show_idle, show);
+  }
+}
+
+static void
+render_handoff_free(render_handoff_t* handoff)
+{
+  if (handoff->surface != NULL) {
+    cairo_surface_destroy(handoff->surface);
+  }
+  if (handoff->base != NULL) {
+    cairo_surface_destroy(handoff->base);
+  }
+  if (handoff->links != NULL) {
+    girara_list_free(handoff->links);
+  }
+  if (handoff->images != NULL) {
+    girara_list_free(handoff->images);
+  }
+  g_free(handoff);
+}
+
+/* passes the result to the page widget and the page cache; the GDK lock has
+ * to be held */
+static void
+render_handoff_run(render_handoff_t* handoff)
+{
+  zathura_t* zathura = handoff->zathura;
+  GtkWidget* widget  = zathura_page_get_widget(zathura, handoff->page);
+
+  switch (handoff->type) {
+    case RENDER_JOB_PAGE:
+    case RENDER_JOB_PREFETCH:
+      /* keep the surfaces in case the zoom level or the recolor state are
+       * changed back later; tiles are only kept in the cache */
+      if (handoff->base != NULL) {
+        zathura_page_cache_add(zathura->page_cache, &handoff->base_key, handoff->base);
+      }
+      if (handoff->cache == true) {
+        zathura_page_cache_add(zathura->page_cache, &handoff->key, handoff->surface);
+      }
+
+      /* prefetched pages are taken from the cache once they are drawn */
+      if (handoff->type == RENDER_JOB_PREFETCH || widget == NULL) {
+        break;
+      }
+      if (handoff->tile != 0) {
+        zathura_page_widget_update_tile(ZATHURA_PAGE(widget), handoff->tile);
+      } else if (render_group_park(handoff->render_thread, handoff->page,
+            handoff->surface, &handoff->key, handoff->generation,
+            handoff->grouped) == false) {
+        zathura_page_widget_update_surface(ZATHURA_PAGE(widget),
+            cairo_surface_reference(handoff->surface), &handoff->key);
+      }
+
+      /* links and images are retrieved once the page is shown, so that link
+       * hints and the popup menu do not have to wait for the plugin */
+      if (zathura_page_widget_request_metadata(ZATHURA_PAGE(widget), handoff->generation) == true) {
+        render_queue(handoff->render_thread, handoff->page, 0, RENDER_JOB_METADATA);
+      }
+      break;
+    case RENDER_JOB_PREVIEW:
+    case RENDER_JOB_THUMBNAIL:
+      if (widget != NULL) {
+        zathura_page_widget_update_preview(ZATHURA_PAGE(widget),
+            cairo_surface_reference(handoff->surface));
+      }
+      break;
+    case RENDER_JOB_METADATA:
+      if (widget != NULL) {
+        zathura_page_widget_update_metadata(ZATHURA_PAGE(widget), handoff->page,
+            handoff->links, handoff->images);
+        handoff->links  = NULL;
+        handoff->images = NULL;
+      }
+      break;
+  }
+}
+
+static gboolean
+render_handoff_idle(gpointer data)
+{
+  render_handoff_t* handoff = data;
+  render_thread_t* render_thread = handoff->render_thread;
+
+  mutex_lock(&render_thread->handoff_lock);
+  render_thread->handoffs = g_list_remove(render_thread->handoffs, handoff);
+  mutex_unlock(&render_thread->handoff_lock);
+
+  /* results of superseded jobs are dropped */
+  if (render_thread->about_to_close == false &&
+      handoff->generation == g_atomic_int_get(&render_thread->generation)) {
+    render_handoff_run(handoff);
+  }
+
+  /* includes waiting for the main loop */
+  if (handoff->type != RENDER_JOB_METADATA) {
+    zathura_stats_add(handoff->zathura->stats, ZATHURA_STAT_HANDOFF,
+        g_get_monotonic_time() - handoff->queued);
+  }
+  render_handoff_free(handoff);
+
+  return FALSE;
+}
+
+/* passes the result of a job on to the main loop; workers never take the GDK
+ * lock, since render_detach waits for them while the main loop holds it */
+static void
+render_handoff(zathura_t* zathura, render_handoff_t* handoff)
+{
+  render_thread_t* render_thread = zathura->sync.render_thread;
+
+  handoff->zathura       = zathura;
+  handoff->render_thread = render_thread;
+  handoff->queued        = g_get_monotonic_time();
+
+  mutex_lock(&render_thread->handoff_lock);
+  render_thread->handoffs = g_list_prepend(render_thread->handoffs, handoff);
+  mutex_unlock(&render_thread->handoff_lock);
+
+  gdk_threads_add_idle(render_handoff_idle, handoff);
+}
+
 static void
 render_job(void* data, void* user_data)
 {
-  zathura_page_t* page = data;
+  render_job_t* job  = data;
   zathura_t* zathura = user_data;
-  if (page == NULL || zathura == NULL) {
+  if (job == NULL || zathura == NULL) {
+    g_free(job);
     return;
   }
 
-  girara_debug("rendering page %d ...", zathura_page_get_index(page) + 1);
-  if (render(zathura, page) != true) {
+  render_thread_t* render_thread = zathura->sync.render_thread;
+  render_job_run(job, zathura);
+
+  /* the document is only detached once all of its jobs have finished */
+  mutex_lock(&render_thread->jobs_lock);
+  if (--render_thread->jobs == 0) {
+    cond_broadcast(&render_thread->jobs_done);
+  }
+  mutex_unlock(&render_thread->jobs_lock);
+}
+
+static void
+render_job_run(render_job_t* job, zathura_t* zathura)
+{
+  zathura_page_t* page = job->page;
+  render_thread_t* render_thread = zathura->sync.render_thread;
+
+  /* drop jobs that have been superseded, e.g. by zooming or rotating; a new
+   * job for the page gets queued once the resized widget is drawn */
+  const bool grouped = job->grouped;
+  if (render_job_is_stale(render_thread, job) == true) {
+    girara_debug("dropping stale render job (page %d)", zathura_page_get_index(page) + 1);
+    render_job_free(render_thread, job);
+    if (grouped == true) {
+      render_group_done(zathura, page);
+    }
+    return;
+  }
+
+  /* drop jobs for pages that left the viewport; the page is requested again
+   * when it becomes visible */
+  if (job->type != RENDER_JOB_PREFETCH && zathura_page_get_visibility(page) == false) {
+    girara_debug("dropping render job for hidden page %d", zathura_page_get_index(page) + 1);
+    GtkWidget* widget = zathura_page_get_widget(zathura, page);
+    if (widget != NULL) {
+      zathura_page_widget_abort_render_request(ZATHURA_PAGE(widget));
+    }
+    g_free(job);
+    if (grouped == true) {
+      render_group_done(zathura, page);
+    }
+    return;
+  }
+
+  /* the flag stops the render once set; renders are cancelled together with
+   * bumping the generation, so the job is checked again in case that
+   * happened before the flag has been registered */
+  gint cancel = 0;
+  render_job_set_running(render_thread, &cancel, true);
+  if (render_job_is_stale(render_thread, job) == true) {
+    girara_debug("dropping cancelled render job (page %d)", zathura_page_get_index(page) + 1);
+    render_job_set_running(render_thread, &cancel, false);
+    render_job_free(render_thread, job);
+    if (grouped == true) {
+      render_group_done(zathura, page);
+    }
+    return;
+  }
+
+  const unsigned int tile = job->tile;
+  const gint generation   = job->generation;
+  const render_job_type_t type = job->type;
+  const bool prefetch     = type == RENDER_JOB_PREFETCH;
+
+  zathura_stats_add(zathura->stats, ZATHURA_STAT_QUEUE_DELAY,
+      g_get_monotonic_time() - job->queued);
+  zathura_stats_set_queue_depth(zathura->stats,
+      g_thread_pool_unprocessed(render_thread->pool));
+  render_job_free(render_thread, job);
+
+  if (type == RENDER_JOB_PREVIEW) {
+    girara_debug("rendering preview of page %d ...", zathura_page_get_index(page) + 1);
+    if (render_preview(zathura, page, generation, &cancel) != true &&
+        g_atomic_int_get(&cancel) == 0) {
+      girara_error("Rendering preview failed (page %d)\n", zathura_page_get_index(page) + 1);
+    }
+    render_job_set_running(render_thread, &cancel, false);
+    return;
+  } else if (type == RENDER_JOB_THUMBNAIL) {
+    girara_debug("rendering thumbnail of page %d ...", zathura_page_get_index(page) + 1);
+    if (render_thumbnail(zathura, page, generation, &cancel) != true &&
+        g_atomic_int_get(&cancel) == 0) {
+      girara_error("Rendering thumbnail failed (page %d)\n", zathura_page_get_index(page) + 1);
+    }
+    render_job_set_running(render_thread, &cancel, false);
+    return;
+  } else if (type == RENDER_JOB_METADATA) {
+    girara_debug("retrieving links and images of page %d ...", zathura_page_get_index(page) + 1);
+    render_metadata(zathura, page, generation);
+    render_job_set_running(render_thread, &cancel, false);
+    return;
+  }
+
+  girara_debug("%s page %d (tile %u) ...", prefetch == true ? "prefetching" :
+      "rendering", zathura_page_get_index(page) + 1, tile);
+  if (render(zathura, page, tile, generation, prefetch, grouped, &cancel) != true &&
+      g_atomic_int_get(&cancel) == 0) {
     girara_error("Rendering failed (page %d)\n", zathura_page_get_index(page) + 1);
   }
+  render_job_set_running(render_thread, &cancel, false);
+
+  if (grouped == true) {
+    render_group_done(zathura, page);
+  }
 }
 
 render_thread_t*
 render_init(zathura_t* zathura)
 {
   render_thread_t* render_thread = g_malloc0(sizeof(render_thread_t));
+  mutex_init(&render_thread->mutex);
+  mutex_init(&render_thread->group_lock);
+  mutex_init(&render_thread->handoff_lock);
+  mutex_init(&render_thread->running_lock);
+  mutex_init(&render_thread->jobs_lock);
+  cond_init(&render_thread->jobs_done);
+  mutex_init(&render_thread->prefetch_lock);
+  render_thread->running     = g_ptr_array_new();
+  render_thread->prefetching = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+  /* nothing is rendered until a document has been attached */
+  render_thread->about_to_close = true;
 
-  /* setup */
   render_thread->pool = g_thread_pool_new(render_job, zathura, 1, TRUE, NULL);
   if (render_thread->pool == NULL) {
     goto error_free;
   }
-
-  render_thread->about_to_close = false;
   g_thread_pool_set_sort_function(render_thread->pool, render_thread_sort, zathura);
-  mutex_init(&render_thread->mutex);
 
   return render_thread;
 
@@ -63,216 +596,654 @@ error_free:
 }
 
 void
-render_free(render_thread_t* render_thread)
+render_attach(render_thread_t* render_thread, zathura_t* zathura)
+{
+  if (render_thread == NULL || zathura == NULL) {
+    return;
+  }
+
+  /* setup */
+  int render_threads = 1;
+  girara_setting_get(zathura->ui.session, "render-threads", &render_threads);
+  if (render_threads < 1) {
+    render_threads = 1;
+  }
+
+  int pages_per_row = 1;
+  girara_setting_get(zathura->ui.session, "pages-per-row", &pages_per_row);
+  int first_page_column = 1;
+  girara_setting_get(zathura->ui.session, "first-page-column", &first_page_column);
+  render_thread->group_size   = MAX(pages_per_row, 1);
+  render_thread->group_column = MAX(first_page_column, 1);
+
+  /* only render pages in parallel if the plugin allows it */
+  render_thread->serialize = true;
+  bool render_region = false;
+  if (zathura->document != NULL) {
+    zathura_plugin_t* plugin = zathura_document_get_plugin(zathura->document);
+    zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
+    if (functions != NULL && (functions->capabilities & ZATHURA_PLUGIN_CAPABILITY_THREAD_SAFE_RENDER) != 0) {
+      render_thread->serialize = false;
+    }
+    render_region = functions != NULL && functions->page_render_region != NULL;
+
+    render_thread->number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+    render_thread->group_queued = g_malloc0_n(render_thread->number_of_pages, sizeof(unsigned int));
+    render_thread->group_parked = g_malloc0_n(render_thread->number_of_pages, sizeof(render_group_entry_t));
+
+    /* only plugins that know where pages are stored help reading ahead */
+    if (functions != NULL && functions->page_get_byte_range != NULL) {
+      render_thread->readahead = zathura_readahead_new(zathura_document_get_path(zathura->document));
+    }
+  }
+
+  /* plugins that size their output from the target surface would draw the
+   * whole page into every tile, so only plugins that render regions
+   * themselves get tiles */
+  int tile_size = 0;
+  girara_setting_get(zathura->ui.session, "render-tile-size", &tile_size);
+  render_thread->tile_size = (tile_size > 0 && render_region == true) ? tile_size : 0;
+
+  bool preview = true;
+  girara_setting_get(zathura->ui.session, "render-preview", &preview);
+  render_thread->preview = preview;
+
+  int thumbnail_size = 0;
+  girara_setting_get(zathura->ui.session, "thumbnail-size", &thumbnail_size);
+  render_thread->thumbnail_size = thumbnail_size > 0 ? thumbnail_size : 0;
+
+  girara_debug("using %d render thread(s), %s", render_threads,
+               render_thread->serialize == true ? "serialized" : "parallel");
+
+  g_thread_pool_set_max_threads(render_thread->pool, render_threads, NULL);
+
+  render_thread->about_to_close = false;
+}
+
+void
+render_detach(render_thread_t* render_thread)
 {
   if (render_thread == NULL) {
     return;
   }
 
   render_thread->about_to_close = true;
+  g_atomic_int_inc(&render_thread->generation);
+  render_cancel(render_thread);
+  if (render_thread->deferred_source != 0) {
+    g_source_remove(render_thread->deferred_source);
+    render_thread->deferred_source = 0;
+  }
+  render_thread->deferred = false;
+
+  /* the queued jobs are dropped right away, and the plugin is asked to stop
+   * the pages in progress; none of them may touch the document afterwards.
+   * This runs on the main loop with the GDK lock held, which is fine since
+   * the workers pass all of their results on with idles instead of taking
+   * the lock */
+  mutex_lock(&render_thread->jobs_lock);
+  while (render_thread->jobs > 0) {
+    cond_wait(&render_thread->jobs_done, &render_thread->jobs_lock);
+  }
+  mutex_unlock(&render_thread->jobs_lock);
+
+  /* the workers have finished, so no rows or results are handed to the main
+   * loop anymore; the ones that have not been passed on yet are dropped */
+  for (GList* iter = render_thread->group_shows; iter != NULL; iter = g_list_next(iter)) {
+    g_source_remove_by_user_data(iter->data);
+    render_group_show_free(iter->data);
+  }
+  g_list_free(render_thread->group_shows);
+  render_thread->group_shows = NULL;
+
+  for (GList* iter = render_thread->handoffs; iter != NULL; iter = g_list_next(iter)) {
+    g_source_remove_by_user_data(iter->data);
+    render_handoff_free(iter->data);
+  }
+  g_list_free(render_thread->handoffs);
+  render_thread->handoffs = NULL;
+
+  if (render_thread->group_parked != NULL) {
+    for (unsigned int i = 0; i < render_thread->number_of_pages; i++) {
+      if (render_thread->group_parked[i].surface != NULL) {
+        cairo_surface_destroy(render_thread->group_parked[i].surface);
+      }
+    }
+  }
+  g_free(render_thread->group_parked);
+  render_thread->group_parked = NULL;
+  g_free(render_thread->group_queued);
+  render_thread->group_queued    = NULL;
+  render_thread->number_of_pages = 0;
+
+  g_hash_table_remove_all(render_thread->prefetching);
+  zathura_readahead_free(render_thread->readahead);
+  render_thread->readahead = NULL;
+}
+
+void
+render_free(render_thread_t* render_thread)
+{
+  if (render_thread == NULL) {
+    return;
+  }
+
+  render_detach(render_thread);
   if (render_thread->pool) {
-    g_thread_pool_free(render_thread->pool, TRUE, TRUE);
+    g_thread_pool_free(render_thread->pool, FALSE, TRUE);
   }
 
+  g_hash_table_unref(render_thread->prefetching);
+  mutex_free(&(render_thread->prefetch_lock));
+  mutex_free(&(render_thread->group_lock));
+  mutex_free(&(render_thread->handoff_lock));
+  g_ptr_array_free(render_thread->running, TRUE);
+  mutex_free(&(render_thread->running_lock));
+  cond_free(&(render_thread->jobs_done));
+  mutex_free(&(render_thread->jobs_lock));
   mutex_free(&(render_thread->mutex));
   g_free(render_thread);
 }
 
 bool
 render_page(render_thread_t* render_thread, zathura_page_t* page)
+{
+  return render_page_tile(render_thread, page, 0);
+}
+
+bool
+render_page_tile(render_thread_t* render_thread, zathura_page_t* page, unsigned int tile)
+{
+  return render_queue(render_thread, page, tile, RENDER_JOB_PAGE);
+}
+
+bool
+render_page_preview(render_thread_t* render_thread, zathura_page_t* page)
+{
+  if (render_thread == NULL || render_thread->preview == false) {
+    return false;
+  }
+
+  return render_queue(render_thread, page, 0, RENDER_JOB_PREVIEW);
+}
+
+bool
+render_page_prefetch(render_thread_t* render_thread, zathura_page_t* page)
+{
+  if (render_thread == NULL || page == NULL || render_thread->pool == NULL ||
+      render_thread->about_to_close == true) {
+    return false;
+  }
+
+  /* the same pages are predicted again and again while scrolling */
+  gpointer key = GUINT_TO_POINTER(zathura_page_get_index(page));
+  mutex_lock(&render_thread->prefetch_lock);
+  const bool queued = g_hash_table_contains(render_thread->prefetching, key) == TRUE;
+  if (queued == false) {
+    g_hash_table_add(render_thread->prefetching, key);
+  }
+  mutex_unlock(&render_thread->prefetch_lock);
+
+  if (queued == true) {
+    return false;
+  }
+
+  return render_queue(render_thread, page, 0, RENDER_JOB_PREFETCH);
+}
+
+bool
+render_page_thumbnail(render_thread_t* render_thread, zathura_page_t* page)
+{
+  if (render_thread == NULL || render_thread->thumbnail_size == 0) {
+    return false;
+  }
+
+  return render_queue(render_thread, page, 0, RENDER_JOB_THUMBNAIL);
+}
+
+static bool
+render_queue(render_thread_t* render_thread, zathura_page_t* page, unsigned int tile, render_job_type_t type)
 {
   if (render_thread == NULL || page == NULL || render_thread->pool == NULL || render_thread->about_to_close == true) {
     return false;
   }
 
-  g_thread_pool_push(render_thread->pool, page, NULL);
+  /* the file is read while earlier jobs are rendered, so that the plugin
+   * does not wait for slow storage once the job runs */
+  uint64_t offset = 0;
+  uint64_t length = 0;
+  if (render_thread->readahead != NULL && (type == RENDER_JOB_PAGE || type == RENDER_JOB_PREFETCH) &&
+      zathura_page_get_cached_byte_range(page, &offset, &length) == true) {
+    zathura_readahead_range(render_thread->readahead, offset, length);
+  }
+
+  render_job_t* job = g_malloc0(sizeof(render_job_t));
+  job->page       = page;
+  job->tile       = tile;
+  job->generation = g_atomic_int_get(&render_thread->generation);
+  job->type       = type;
+  job->queued     = g_get_monotonic_time();
+
+  /* the pages of a row are shown once all of them have been rendered */
+  const unsigned int page_id = zathura_page_get_index(page);
+  if (type == RENDER_JOB_PAGE && tile == 0 && render_thread->group_queued != NULL &&
+      page_id < render_thread->number_of_pages) {
+    mutex_lock(&render_thread->group_lock);
+    if (render_thread->group_size > 1) {
+      ++render_thread->group_queued[page_id];
+      job->grouped = true;
+    }
+    mutex_unlock(&render_thread->group_lock);
+  }
+
+  mutex_lock(&render_thread->jobs_lock);
+  ++render_thread->jobs;
+  mutex_unlock(&render_thread->jobs_lock);
+
+  g_thread_pool_push(render_thread->pool, job, NULL);
   return true;
 }
 
-static void
-color2double(GdkColor* col, double* v)
+unsigned int
+render_get_tile_size(render_thread_t* render_thread)
 {
-  v[0] = (double) col->red / 65535.;
-  v[1] = (double) col->green / 65535.;
-  v[2] = (double) col->blue / 65535.;
+  if (render_thread == NULL) {
+    return 0;
+  }
+
+  return render_thread->tile_size;
 }
 
-/* Returns the maximum possible saturation for given h and l.
-   Assumes that l is in the interval l1, l2 and corrects the value to
-   force u=0 on l1 and l2 */
-static double
-colorumax(double* h, double l, double l1, double l2)
+unsigned int
+render_get_max_threads(render_thread_t* render_thread)
 {
-  double u, uu, v, vv, lv;
-  if (h[0] == 0 && h[1] == 0 && h[2] == 0) {
+  if (render_thread == NULL || render_thread->pool == NULL) {
     return 0;
   }
 
-  lv = (l - l1)/(l2 - l1);    /* Remap l to the whole interval 0,1 */
-  u = v = 1000000;
-  for (int k = 0; k < 3; k++) {
-    if (h[k] > 0) {
-      uu = fabs((1-l)/h[k]);
-      vv = fabs((1-lv)/h[k]);
+  return MAX(g_thread_pool_get_max_threads(render_thread->pool), 0);
+}
+
+bool
+render_is_serialized(render_thread_t* render_thread)
+{
+  if (render_thread == NULL) {
+    return true;
+  }
 
-      if (uu < u) {
-        u = uu;
-      }
-      if (vv < v) {
-        v = vv;
-      }
-    } else if (h[k] < 0) {
-      uu = fabs(l/h[k]);
-      vv = fabs(lv/h[k]);
+  return render_thread->serialize;
+}
 
-      if (uu < u) {
-        u = uu;
-      }
-      if (vv < v) {
-        v = vv;
-      }
-    }
+unsigned int
+render_get_thumbnail_size(render_thread_t* render_thread)
+{
+  if (render_thread == NULL) {
+    return 0;
   }
 
-  /* rescale v according to the length of the interval [l1, l2] */
-  v = fabs(l2 - l1) * v;
+  return render_thread->thumbnail_size;
+}
 
-  /* forces the returned value to be 0 on l1 and l2, trying not to distort colors too much */
-  return fmin(u, v);
+void
+render_get_cache_key(zathura_t* zathura, zathura_page_t* page, zathura_page_cache_key_t* key)
+{
+  if (zathura == NULL || page == NULL || key == NULL) {
+    return;
+  }
+
+  key->page  = zathura_page_get_index(page);
+  key->scale = zathura_document_get_scale(zathura_page_get_document(page));
+  if (zathura->global.recolor == false) {
+    key->recolor = 0;
+  } else if (zathura->global.recolor_keep_hue == false) {
+    key->recolor = 1;
+  } else {
+    key->recolor = 2;
+  }
+  key->tile     = 0;
+  key->document = zathura->tabs.id;
 }
 
+static void
+render_recolor(zathura_t* zathura, cairo_surface_t* surface)
+{
+  const gint64 start = g_get_monotonic_time();
+
+  zathura_recolor_t recolor;
+  zathura_recolor_init(&recolor, &zathura->ui.colors.recolor_dark_color,
+      &zathura->ui.colors.recolor_light_color, zathura->global.recolor_keep_hue);
+
+  cairo_surface_flush(surface);
+  zathura_recolor_image(&recolor, cairo_image_surface_get_data(surface),
+      cairo_image_surface_get_width(surface),
+      cairo_image_surface_get_height(surface),
+      cairo_image_surface_get_stride(surface));
+  cairo_surface_mark_dirty(surface);
+
+  zathura_stats_add(zathura->stats, ZATHURA_STAT_RECOLOR, g_get_monotonic_time() - start);
+}
+
+static cairo_surface_t*
+render_copy_surface(zathura_t* zathura, cairo_surface_t* surface)
+{
+  const int width  = cairo_image_surface_get_width(surface);
+  const int height = cairo_image_surface_get_height(surface);
+
+  cairo_surface_t* copy = zathura_surface_pool_create(zathura->surface_pool,
+      cairo_image_surface_get_format(surface), width, height);
+  if (copy == NULL) {
+    return NULL;
+  }
+
+  /* both surfaces have the same format and width, hence the same stride */
+  cairo_surface_flush(surface);
+  memcpy(cairo_image_surface_get_data(copy), cairo_image_surface_get_data(surface),
+      (size_t) cairo_image_surface_get_stride(surface) * height);
+  cairo_surface_mark_dirty(copy);
+
+  return copy;
+}
+
+/* Renders (a part of) the page at the given scale without recoloring it. */
+static cairo_surface_t*
+render_surface(zathura_t* zathura, zathura_page_t* page, double scale,
+    unsigned int offset_x, unsigned int offset_y, unsigned int width,
+    unsigned int height, const gint* cancel)
+{
+  /* buffers of evicted pages are reused */
+  cairo_surface_t* surface = zathura_surface_pool_create(zathura->surface_pool,
+      CAIRO_FORMAT_RGB24, width, height);
+
+  if (surface == NULL) {
+    return NULL;
+  }
+
+  /* the plugin renders straight into the buffer */
+  cairo_surface_flush(surface);
+  unsigned char* data = cairo_image_surface_get_data(surface);
+  const int stride    = cairo_image_surface_get_stride(surface);
+  memset(data, 0xFF, (size_t) stride * height);
+
+  const zathura_render_target_t target = {
+    .data   = data,
+    .format = CAIRO_FORMAT_RGB24,
+    .width  = width,
+    .height = height,
+    .stride = stride,
+    .scale  = scale,
+    .x      = offset_x,
+    .y      = offset_y,
+    .cancel = cancel
+  };
+
+  const bool serialize = zathura->sync.render_thread->serialize;
+  if (serialize == true) {
+    render_lock(zathura->sync.render_thread);
+  }
+  const gint64 start = g_get_monotonic_time();
+  const zathura_error_t error = zathura_page_render_region(page, &target);
+  /* plugins without support for cancellation finish the render, which is
+   * then thrown away, so that it is neither cached nor written to disk */
+  if (error != ZATHURA_ERROR_OK || zathura_render_target_cancelled(&target) == true) {
+    if (serialize == true) {
+      render_unlock(zathura->sync.render_thread);
+    }
+    if (error == ZATHURA_ERROR_CANCELLED || zathura_render_target_cancelled(&target) == true) {
+      girara_debug("render of page %d has been cancelled", zathura_page_get_index(page) + 1);
+    }
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+  zathura_stats_add(zathura->stats, ZATHURA_STAT_RENDER, g_get_monotonic_time() - start);
+
+  /* remember which content has been rendered, so that unchanged pages can
+   * be recognized when the document is reloaded */
+  zathura_page_get_content_hash(page, NULL);
+
+  if (serialize == true) {
+    render_unlock(zathura->sync.render_thread);
+  }
+  cairo_surface_mark_dirty(surface);
+
+  return surface;
+}
 
 static bool
-render(zathura_t* zathura, zathura_page_t* page)
+render(zathura_t* zathura, zathura_page_t* page, unsigned int tile, gint
+    generation, bool prefetch, bool grouped, const gint* cancel)
 {
   if (zathura == NULL || page == NULL || zathura->sync.render_thread->about_to_close == true) {
     return false;
   }
 
-  /* create cairo surface */
+  /* remember what is going to be rendered */
+  zathura_page_cache_key_t key;
+  render_get_cache_key(zathura, page, &key);
+  key.tile = tile;
+
+  /* the page might have been prefetched since the job has been queued */
+  if (prefetch == true) {
+    if (zathura_page_cache_touch(zathura->page_cache, &key) == true) {
+      return true;
+    }
+  } else if (tile == 0) {
+    cairo_surface_t* cached = zathura_page_cache_get(zathura->page_cache, &key);
+    if (cached != NULL) {
+      render_handoff_t* handoff = g_malloc0(sizeof(render_handoff_t));
+      handoff->page       = page;
+      handoff->generation = generation;
+      handoff->type       = RENDER_JOB_PAGE;
+      handoff->surface    = cached;
+      handoff->key        = key;
+      handoff->grouped    = grouped;
+      render_handoff(zathura, handoff);
+      return true;
+    }
+  }
+
   unsigned int page_width  = 0;
   unsigned int page_height = 0;
   const double real_scale = page_calc_height_width(page, &page_height, &page_width, false);
 
-  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, page_width, page_height);
+  /* only render the requested tile */
+  unsigned int offset_x = 0;
+  unsigned int offset_y = 0;
+  if (tile != 0) {
+    const unsigned int tile_size = zathura->sync.render_thread->tile_size;
+    if (tile_size == 0) {
+      return false;
+    }
 
-  if (surface == NULL) {
-    return false;
+    const unsigned int columns = (page_width + tile_size - 1) / tile_size;
+    offset_x = ((tile - 1) % columns) * tile_size;
+    offset_y = ((tile - 1) / columns) * tile_size;
+    if (offset_x >= page_width || offset_y >= page_height) {
+      return false;
+    }
+
+    page_width  = MIN(tile_size, page_width - offset_x);
+    page_height = MIN(tile_size, page_height - offset_y);
   }
 
-  cairo_t* cairo = cairo_create(surface);
+  /* recolored surfaces are made from the un-recolored one, so toggling
+   * recolor or changing the colors does not need the plugin again */
+  zathura_page_cache_key_t base_key = key;
+  base_key.recolor = 0;
 
-  if (cairo == NULL) {
-    cairo_surface_destroy(surface);
-    return false;
+  cairo_surface_t* base = NULL;
+  if (key.recolor != 0) {
+    base = zathura_page_cache_get(zathura->page_cache, &base_key);
   }
 
-  cairo_save(cairo);
-  cairo_set_source_rgb(cairo, 1, 1, 1);
-  cairo_rectangle(cairo, 0, 0, page_width, page_height);
-  cairo_fill(cairo);
-  cairo_restore(cairo);
-  cairo_save(cairo);
+  const bool base_rendered = base == NULL;
 
-  if (fabs(real_scale - 1.0f) > FLT_EPSILON) {
-    cairo_scale(cairo, real_scale, real_scale);
+  /* pages rendered in an earlier session are read from disk */
+  if (base == NULL && tile == 0) {
+    base = zathura_render_cache_get(zathura->render_cache, &base_key);
   }
 
-  render_lock(zathura->sync.render_thread);
-  if (zathura_page_render(page, cairo, false) != ZATHURA_ERROR_OK) {
-    render_unlock(zathura->sync.render_thread);
-    cairo_destroy(cairo);
-    cairo_surface_destroy(surface);
+  if (base == NULL) {
+    base = render_surface(zathura, page, real_scale, offset_x, offset_y,
+        page_width, page_height, cancel);
+    if (base == NULL) {
+      return false;
+    }
+
+    if (tile == 0) {
+      zathura_render_cache_add(zathura->render_cache, &base_key, base);
+    }
+  }
+
+  cairo_surface_t* surface = NULL;
+  if (key.recolor != 0) {
+    surface = render_copy_surface(zathura, base);
+    if (surface == NULL) {
+      cairo_surface_destroy(base);
+      return false;
+    }
+    render_recolor(zathura, surface);
+  } else {
+    surface = cairo_surface_reference(base);
+  }
+
+  render_handoff_t* handoff = g_malloc0(sizeof(render_handoff_t));
+  handoff->page       = page;
+  handoff->generation = generation;
+  handoff->type       = prefetch == true ? RENDER_JOB_PREFETCH : RENDER_JOB_PAGE;
+  handoff->tile       = tile;
+  handoff->surface    = surface;
+  handoff->key        = key;
+  handoff->cache      = true;
+  if (base_rendered == true && key.recolor != 0) {
+    handoff->base     = base;
+    handoff->base_key = base_key;
+  } else {
+    cairo_surface_destroy(base);
+  }
+  handoff->grouped    = grouped;
+  render_handoff(zathura, handoff);
+
+  return true;
+}
+
+/* passes a preview or a thumbnail to the main loop */
+static void
+render_update_preview(zathura_t* zathura, zathura_page_t* page, gint generation,
+    render_job_type_t type, cairo_surface_t* surface)
+{
+  render_handoff_t* handoff = g_malloc0(sizeof(render_handoff_t));
+  handoff->page       = page;
+  handoff->generation = generation;
+  handoff->type       = type;
+  handoff->surface    = cairo_surface_reference(surface);
+  render_handoff(zathura, handoff);
+}
+
+static bool
+render_preview(zathura_t* zathura, zathura_page_t* page, gint generation,
+    const gint* cancel)
+{
+  if (zathura == NULL || page == NULL || zathura->sync.render_thread->about_to_close == true) {
     return false;
   }
 
-  render_unlock(zathura->sync.render_thread);
-  cairo_restore(cairo);
-  cairo_destroy(cairo);
+  unsigned int page_width  = 0;
+  unsigned int page_height = 0;
+  const double real_scale = page_calc_height_width(page, &page_height, &page_width, false);
 
-  const int rowstride  = cairo_image_surface_get_stride(surface);
-  unsigned char* image = cairo_image_surface_get_data(surface);
+  /* the page is too small to need a preview */
+  const unsigned int preview_width  = page_width / RENDER_PREVIEW_FACTOR;
+  const unsigned int preview_height = page_height / RENDER_PREVIEW_FACTOR;
+  if (preview_width == 0 || preview_height == 0) {
+    return true;
+  }
+
+  /* a stored thumbnail is much cheaper than rendering the page again */
+  cairo_surface_t* surface = zathura_thumbnail_cache_get(zathura->thumbnail_cache,
+      zathura_page_get_index(page));
+  if (surface == NULL) {
+    const double scale = real_scale * preview_width / page_width;
+    surface = render_surface(zathura, page, scale, 0, 0, preview_width,
+        preview_height, cancel);
+    if (surface == NULL) {
+      return false;
+    }
+  }
 
-  /* recolor */
-  /* uses a representation of a rgb color as follows:
-     - a lightness scalar (between 0,1), which is a weighted average of r, g, b,
-     - a hue vector, which indicates a radian direction from the grey axis, inside the equal lightness plane.
-     - a saturation scalar between 0,1. It is 0 when grey, 1 when the color is in the boundary of the rgb cube.
-  */
   if (zathura->global.recolor == true) {
-    /* RGB weights for computing lightness. Must sum to one */
-    double a[] = {0.30, 0.59, 0.11};
-
-    double l1, l2, l, s, u, t;
-    double h[3];
-    double rgb1[3], rgb2[3], rgb[3];
-
-    color2double(&zathura->ui.colors.recolor_dark_color, rgb1);
-    color2double(&zathura->ui.colors.recolor_light_color, rgb2);
-
-    l1 = (a[0]*rgb1[0] + a[1]*rgb1[1] + a[2]*rgb1[2]);
-    l2 = (a[0]*rgb2[0] + a[1]*rgb2[1] + a[2]*rgb2[2]);
-
-    for (unsigned int y = 0; y < page_height; y++) {
-      unsigned char* data = image + y * rowstride;
-
-      for (unsigned int x = 0; x < page_width; x++) {
-        /* Careful. data color components blue, green, red. */
-        rgb[0] = (double) data[2] / 256.;
-        rgb[1] = (double) data[1] / 256.;
-        rgb[2] = (double) data[0] / 256.;
-
-        /* compute h, s, l data   */
-        l = a[0]*rgb[0] + a[1]*rgb[1] + a[2]*rgb[2];
-
-        h[0] = rgb[0] - l;
-        h[1] = rgb[1] - l;
-        h[2] = rgb[2] - l;
-
-        /* u is the maximum possible saturation for given h and l. s is a rescaled saturation between 0 and 1 */
-        u = colorumax(h, l, 0, 1);
-        if (u == 0) {
-          s = 0;
-        } else {
-          s = 1/u;
-        }
-
-        /* Interpolates lightness between light and dark colors. white goes to light, and black goes to dark. */
-        t = l;
-        l = t * (l2 - l1) + l1;
-
-        if (zathura->global.recolor_keep_hue == true) {
-          /* adjusting lightness keeping hue of current color. white and black go to grays of same ligtness
-             as light and dark colors. */
-          u = colorumax(h, l, l1, l2);
-          data[2] = (unsigned char)round(255.*(l + s*u * h[0]));
-          data[1] = (unsigned char)round(255.*(l + s*u * h[1]));
-          data[0] = (unsigned char)round(255.*(l + s*u * h[2]));
-        } else {
-          /* Linear interpolation between dark and light with color ligtness as a parameter */
-          data[2] = (unsigned char)round(255.*(t * (rgb2[0] - rgb1[0]) + rgb1[0]));
-          data[1] = (unsigned char)round(255.*(t * (rgb2[1] - rgb1[1]) + rgb1[1]));
-          data[0] = (unsigned char)round(255.*(t * (rgb2[2] - rgb1[2]) + rgb1[2]));
-        }
-
-        data += 4;
-      }
+    render_recolor(zathura, surface);
+  }
+
+  render_update_preview(zathura, page, generation, RENDER_JOB_PREVIEW, surface);
+  cairo_surface_destroy(surface);
+
+  return true;
+}
+
+static bool
+render_thumbnail(zathura_t* zathura, zathura_page_t* page, gint generation,
+    const gint* cancel)
+{
+  if (zathura == NULL || page == NULL || zathura->sync.render_thread->about_to_close == true) {
+    return false;
+  }
+
+  const unsigned int page_id = zathura_page_get_index(page);
+  cairo_surface_t* surface = zathura_thumbnail_cache_get(zathura->thumbnail_cache, page_id);
+  if (surface == NULL) {
+    /* thumbnails have a fixed size, independent of the zoom level */
+    const double width  = zathura_page_get_width(page);
+    const double height = zathura_page_get_height(page);
+    if (width <= 0 || height <= 0) {
+      return false;
     }
+
+    const double scale = zathura->sync.render_thread->thumbnail_size / MAX(width, height);
+    const unsigned int thumbnail_width  = MAX(1, round(width * scale));
+    const unsigned int thumbnail_height = MAX(1, round(height * scale));
+
+    surface = render_surface(zathura, page, scale, 0, 0, thumbnail_width,
+        thumbnail_height, cancel);
+    if (surface == NULL) {
+      return false;
+    }
+
+    /* thumbnails are stored without recoloring */
+    zathura_thumbnail_cache_add(zathura->thumbnail_cache, page_id, surface);
   }
 
-  if (zathura->sync.render_thread->about_to_close == false) {
-    /* update the widget */
-    gdk_threads_enter();
-    GtkWidget* widget = zathura_page_get_widget(zathura, page);
-    zathura_page_widget_update_surface(ZATHURA_PAGE(widget), surface);
-    gdk_threads_leave();
-  } else {
-    cairo_surface_destroy(surface);
+  if (zathura->global.recolor == true) {
+    render_recolor(zathura, surface);
   }
 
+  render_update_preview(zathura, page, generation, RENDER_JOB_THUMBNAIL, surface);
+  cairo_surface_destroy(surface);
+
   return true;
 }
 
+static void
+render_metadata(zathura_t* zathura, zathura_page_t* page, gint generation)
+{
+  render_thread_t* render_thread = zathura->sync.render_thread;
+  if (render_thread->serialize == true) {
+    render_lock(render_thread);
+  }
+  girara_list_t* links  = zathura_page_links_get(page, NULL);
+  girara_list_t* images = zathura_page_images_get(page, NULL);
+  if (render_thread->serialize == true) {
+    render_unlock(render_thread);
+  }
+
+  render_handoff_t* handoff = g_malloc0(sizeof(render_handoff_t));
+  handoff->page       = page;
+  handoff->generation = generation;
+  handoff->type       = RENDER_JOB_METADATA;
+  handoff->links      = links;
+  handoff->images     = images;
+  render_handoff(zathura, handoff);
+}
+
 void
 render_all(zathura_t* zathura)
 {
@@ -280,17 +1251,108 @@ render_all(zathura_t* zathura)
     return;
   }
 
-  /* unmark all pages */
-  unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
-  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
-    zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
-    unsigned int page_height = 0, page_width = 0;
-    page_calc_height_width(page, &page_height, &page_width, true);
+  /* cancel all queued jobs and stop the ones in progress */
+  if (zathura->sync.render_thread != NULL) {
+    g_atomic_int_inc(&zathura->sync.render_thread->generation);
+    render_cancel(zathura->sync.render_thread);
+  }
 
-    GtkWidget* widget = zathura_page_get_widget(zathura, page);
-    gtk_widget_set_size_request(widget, page_width, page_height);
-    gtk_widget_queue_resize(widget);
+  render_relayout(zathura);
+}
+
+void
+render_relayout(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->document == NULL) {
+    return;
+  }
+
+  page_widget_resize(zathura);
+}
+
+static gboolean
+render_deferred_end(gpointer data)
+{
+  zathura_t* zathura = data;
+  render_thread_t* render_thread = zathura->sync.render_thread;
+
+  render_thread->deferred        = false;
+  render_thread->deferred_source = 0;
+
+  /* the pages request their renders at the final scale once they are drawn */
+  if (zathura->ui.page_widget != NULL) {
+    gtk_widget_queue_draw(zathura->ui.page_widget);
   }
+  prefetch_schedule(zathura);
+
+  return FALSE;
+}
+
+void
+render_all_deferred(zathura_t* zathura, unsigned int delay)
+{
+  if (zathura == NULL || zathura->sync.render_thread == NULL || delay == 0) {
+    render_all(zathura);
+    return;
+  }
+
+  render_thread_t* render_thread = zathura->sync.render_thread;
+  render_thread->deferred = true;
+  if (render_thread->deferred_source != 0) {
+    g_source_remove(render_thread->deferred_source);
+  }
+  render_thread->deferred_source = gdk_threads_add_timeout(delay, render_deferred_end, zathura);
+
+  render_all(zathura);
+}
+
+bool
+render_is_deferred(render_thread_t* render_thread)
+{
+  if (render_thread == NULL) {
+    return false;
+  }
+
+  return render_thread->deferred;
+}
+
+void
+render_set_row_groups(zathura_t* zathura, unsigned int pages_per_row,
+    unsigned int first_page_column)
+{
+  if (zathura == NULL || zathura->sync.render_thread == NULL) {
+    return;
+  }
+
+  render_thread_t* render_thread = zathura->sync.render_thread;
+
+  /* pages that wait for their old row are shown right away */
+  render_group_entry_t* entries = NULL;
+  mutex_lock(&render_thread->group_lock);
+  render_thread->group_size   = MAX(pages_per_row, 1);
+  render_thread->group_column = MAX(first_page_column, 1);
+  if (render_thread->group_parked != NULL) {
+    const size_t size = render_thread->number_of_pages * sizeof(render_group_entry_t);
+    entries = g_malloc(size);
+    memcpy(entries, render_thread->group_parked, size);
+    memset(render_thread->group_parked, 0, size);
+  }
+  mutex_unlock(&render_thread->group_lock);
+
+  if (entries != NULL) {
+    render_group_show(zathura, entries, 0, render_thread->number_of_pages);
+    g_free(entries);
+  }
+}
+
+gint
+render_get_generation(render_thread_t* render_thread)
+{
+  if (render_thread == NULL) {
+    return 0;
+  }
+
+  return g_atomic_int_get(&render_thread->generation);
 }
 
 static gint
@@ -300,23 +1362,68 @@ render_thread_sort(gconstpointer a, gconstpointer b, gpointer data)
     return 0;
   }
 
-  zathura_page_t* page_a = (zathura_page_t*) a;
-  zathura_page_t* page_b = (zathura_page_t*) b;
-  zathura_t* zathura     = (zathura_t*) data;
+  const render_job_t* job_a = a;
+  const render_job_t* job_b = b;
+  zathura_t* zathura        = data;
 
-  unsigned int page_a_index = zathura_page_get_index(page_a);
-  unsigned int page_b_index = zathura_page_get_index(page_b);
+  /* visible pages first */
+  const bool visible_a = zathura_page_get_visibility(job_a->page);
+  const bool visible_b = zathura_page_get_visibility(job_b->page);
+  if (visible_a != visible_b) {
+    return visible_a == true ? -1 : 1;
+  }
 
-  gint64 last_view_a = 0;
-  gint64 last_view_b = 0;
+  /* thumbnails are only rendered when nothing else is left to do, and
+   * prefetching must not delay pages that have been asked for */
+  const bool thumbnail_a = job_a->type == RENDER_JOB_THUMBNAIL;
+  const bool thumbnail_b = job_b->type == RENDER_JOB_THUMBNAIL;
+  if (thumbnail_a != thumbnail_b) {
+    return thumbnail_a == true ? 1 : -1;
+  }
 
-  g_object_get(zathura->pages[page_a_index], "last-view", &last_view_a, NULL);
-  g_object_get(zathura->pages[page_b_index], "last-view", &last_view_b, NULL);
+  const bool prefetch_a = job_a->type == RENDER_JOB_PREFETCH;
+  const bool prefetch_b = job_b->type == RENDER_JOB_PREFETCH;
+  if (prefetch_a != prefetch_b) {
+    return prefetch_a == true ? 1 : -1;
+  }
 
-  if (last_view_a < last_view_b) {
-    return -1;
-  } else if (last_view_a > last_view_b) {
-    return 1;
+  /* links and images are retrieved after the pages have been rendered */
+  const bool metadata_a = job_a->type == RENDER_JOB_METADATA;
+  const bool metadata_b = job_b->type == RENDER_JOB_METADATA;
+  if (metadata_a != metadata_b) {
+    return metadata_a == true ? 1 : -1;
+  }
+
+  /* previews are cheap, so they are rendered before the pages */
+  const bool preview_a = job_a->type == RENDER_JOB_PREVIEW;
+  const bool preview_b = job_b->type == RENDER_JOB_PREVIEW;
+  if (preview_a != preview_b) {
+    return preview_a == true ? -1 : 1;
+  }
+
+  /* then pages close to the current page; the pages of a row are kept
+   * together, so that they are rendered at the same time */
+  if (zathura->document != NULL) {
+    render_thread_t* render_thread = zathura->sync.render_thread;
+    const unsigned int size   = render_thread != NULL ? MAX(render_thread->group_size, 1) : 1;
+    const unsigned int offset = render_thread != NULL && size > 1 ?
+      (MIN(render_thread->group_column, size) - 1) : 0;
+
+    const int index_a = zathura_page_get_index(job_a->page);
+    const int index_b = zathura_page_get_index(job_b->page);
+    const int current = zathura_document_get_current_page_number(zathura->document);
+    const int row     = (current + offset) / size;
+    const int distance_a = abs((int) ((index_a + offset) / size) - row);
+    const int distance_b = abs((int) ((index_b + offset) / size) - row);
+    if (distance_a < distance_b) {
+      return -1;
+    } else if (distance_a > distance_b) {
+      return 1;
+    }
+
+    if (size > 1 && index_a != index_b) {
+      return index_a < index_b ? -1 : 1;
+    }
   }
 
   return 0;
@@ -11,13 +11,32 @@
 #include "callbacks.h"
 
 /**
- * This function initializes a render thread
+ * This function initializes a render thread. The thread is kept for the whole
+ * session and does not render anything until a document has been attached.
  *
  * @param zathura object
  * @return The render thread object or NULL if an error occured
  */
 render_thread_t* render_init(zathura_t* zathura);
 
+/**
+ * Prepares the render thread for the document that is shown now. The
+ * settings that affect rendering are read again.
+ *
+ * @param render_thread The render thread object
+ * @param zathura object
+ */
+void render_attach(render_thread_t* render_thread, zathura_t* zathura);
+
+/**
+ * Stops rendering the pages of the shown document. Queued jobs are dropped
+ * and the plugin is asked to stop the pages in progress. The function returns
+ * once no job uses the document anymore.
+ *
+ * @param render_thread The render thread object
+ */
+void render_detach(render_thread_t* render_thread);
+
 /**
  * This function destroys the render thread object
  *
@@ -27,7 +46,9 @@ void render_free(render_thread_t* render_thread);
 
 /**
  * This function is used to add a page to the render thread list
- * that should be rendered.
+ * that should be rendered. Visible pages are rendered first, followed by the
+ * pages closest to the current page. The job is dropped without rendering if
+ * the page is no longer visible when its turn comes.
  *
  * @param render_thread The render thread object
  * @param page The page that should be rendered
@@ -35,15 +56,161 @@ void render_free(render_thread_t* render_thread);
  */
 bool render_page(render_thread_t* render_thread, zathura_page_t* page);
 
+/**
+ * This function is used to add a single tile of a page to the render thread
+ * list. Tiles are squares of render-tile-size pixels of the unrotated page at
+ * the current scale; they are numbered row by row starting with 1. Rendered
+ * tiles are stored in the page cache.
+ *
+ * @param render_thread The render thread object
+ * @param page The page
+ * @param tile The tile that should be rendered (0 for the whole page)
+ * @return true if no error occured
+ */
+bool render_page_tile(render_thread_t* render_thread, zathura_page_t* page, unsigned int tile);
+
+/**
+ * This function is used to add a low resolution preview of a page to the
+ * render thread list. Previews of visible pages are rendered before the pages
+ * themselves and are shown scaled until the page has been rendered.
+ *
+ * @param render_thread The render thread object
+ * @param page The page
+ * @return true if the preview has been queued, false if previews are disabled
+ *   or an error occured
+ */
+bool render_page_preview(render_thread_t* render_thread, zathura_page_t* page);
+
+/**
+ * This function is used to add a page to the render thread list that is not
+ * visible yet but is expected to be shown soon. The page is rendered into the
+ * page cache after all other jobs, even if it stays hidden, and is skipped if
+ * it already is in the cache.
+ *
+ * @param render_thread The render thread object
+ * @param page The page
+ * @return true if the page has been queued, false if it is already queued or
+ *   an error occured
+ */
+bool render_page_prefetch(render_thread_t* render_thread, zathura_page_t* page);
+
+/**
+ * This function is used to add a thumbnail of a page to the render thread
+ * list. Thumbnails have a fixed size of thumbnail-size pixels, are rendered
+ * after all other jobs and are stored in the thumbnail cache. They are shown
+ * instead of the page while the page is not larger than a thumbnail.
+ *
+ * @param render_thread The render thread object
+ * @param page The page
+ * @return true if the thumbnail has been queued, false if thumbnails are
+ *   disabled or an error occured
+ */
+bool render_page_thumbnail(render_thread_t* render_thread, zathura_page_t* page);
+
+/**
+ * Returns the size of the thumbnails.
+ *
+ * @param render_thread The render thread object
+ * @return The length of the longer side of the thumbnails in pixels or 0 if
+ *   thumbnails are disabled
+ */
+unsigned int render_get_thumbnail_size(render_thread_t* render_thread);
+
+/**
+ * Returns the size of the tiles if pages are rendered in tiles.
+ *
+ * @param render_thread The render thread object
+ * @return The tile size in pixels or 0 if pages are rendered as a whole
+ */
+unsigned int render_get_tile_size(render_thread_t* render_thread);
+
+/**
+ * Returns the number of threads that render pages at most.
+ *
+ * @param render_thread The render thread object
+ * @return The maximal number of render threads
+ */
+unsigned int render_get_max_threads(render_thread_t* render_thread);
+
+/**
+ * Checks whether the plugin has to be called by one thread at a time. In that
+ * case every call has to be guarded by render_lock.
+ *
+ * @param render_thread The render thread object
+ * @return true if rendering is serialized
+ */
+bool render_is_serialized(render_thread_t* render_thread);
+
+/**
+ * Fills in the page cache key that describes how the page would be rendered
+ * with the current settings.
+ *
+ * @param zathura Zathura object
+ * @param page The page
+ * @param key The key to fill in
+ */
+void render_get_cache_key(zathura_t* zathura, zathura_page_t* page, zathura_page_cache_key_t* key);
+
 /**
  * This function is used to unmark all pages as not rendered. This should
  * be used if all pages should be rendered again (e.g.: the zoom level or the
- * colors have changed)
+ * colors have changed). Jobs that are still queued are cancelled.
  *
  * @param zathura Zathura object
  */
 void render_all(zathura_t* zathura);
 
+/**
+ * Resizes all page widgets to the current scale and rotation without
+ * cancelling queued jobs. Rendered pages are kept if they still show the page
+ * at the current scale, e.g. if only the rotation has changed, since surfaces
+ * are rotated while painting.
+ *
+ * @param zathura Zathura object
+ */
+void render_relayout(zathura_t* zathura);
+
+/**
+ * Like render_all, but the pages are only rendered again once the function
+ * has not been called for the given time; until then they show their old
+ * surfaces scaled to the new size. Repeated calls, e.g. while zooming with
+ * the mouse wheel, lead to one render at the final scale.
+ *
+ * @param zathura Zathura object
+ * @param delay Time in milliseconds (0 to render right away)
+ */
+void render_all_deferred(zathura_t* zathura, unsigned int delay);
+
+/**
+ * Checks whether rendering is deferred by render_all_deferred
+ *
+ * @param render_thread The render thread object
+ * @return true if no pages should be requested
+ */
+bool render_is_deferred(render_thread_t* render_thread);
+
+/**
+ * Groups the pages by the rows they are shown in. The pages of a row are
+ * rendered next to each other, in parallel if the plugin allows it, and are
+ * shown at the same time once all of them have been rendered, so that facing
+ * pages appear together.
+ *
+ * @param zathura Zathura object
+ * @param pages_per_row Number of pages per row (1 to disable the groups)
+ * @param first_page_column Column of the first page (starting at 1)
+ */
+void render_set_row_groups(zathura_t* zathura, unsigned int pages_per_row,
+    unsigned int first_page_column);
+
+/**
+ * Returns the current render generation. It changes whenever queued jobs are
+ * cancelled by render_all.
+ *
+ * @param render_thread The render thread object
+ * @return The generation
+ */
+gint render_get_generation(render_thread_t* render_thread);
+
 /**
  * Lock the render thread. This is useful if you want to render on your own (e.g
  * for printing).
@@ -0,0 +1,422 @@
+/* See LICENSE file for license and copyright information */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <girara/utils.h>
+
+#include "replay.h"
+#include "commands.h"
+#include "document.h"
+#include "page.h"
+#include "page-widget.h"
+#include "shortcuts.h"
+#include "utils.h"
+
+/* interval in milliseconds in which the view is checked */
+#define REPLAY_POLL_INTERVAL 1
+/* time in microseconds after which an incomplete view is given up on */
+#define REPLAY_TIMEOUT (10 * G_USEC_PER_SEC)
+
+struct zathura_replay_s {
+  zathura_t* zathura; /**< Zathura session */
+  char* file; /**< The file containing the events */
+  GArray* events; /**< The events */
+  unsigned int next; /**< Next event to replay */
+  guint event_source; /**< Source that replays the next event */
+  guint poll_source; /**< Source that checks the view */
+  bool pending; /**< The view has not been complete since the last event */
+  gint64 dispatched; /**< Time the last event has been replayed */
+  GArray* latencies; /**< Time to a complete view after each event */
+  unsigned int superseded; /**< Events followed by the next one before the view was complete */
+  unsigned int timed_out; /**< Events after which the view never became complete */
+};
+
+typedef struct replay_name_s {
+  const char* name;
+  int argument;
+} replay_name_t;
+
+static const replay_name_t scroll_names[] = {
+  { "down",       DOWN },
+  { "up",         UP },
+  { "left",       LEFT },
+  { "right",      RIGHT },
+  { "half-down",  HALF_DOWN },
+  { "half-up",    HALF_UP },
+  { "full-down",  FULL_DOWN },
+  { "full-up",    FULL_UP },
+  { "half-left",  HALF_LEFT },
+  { "half-right", HALF_RIGHT },
+  { "full-left",  FULL_LEFT },
+  { "full-right", FULL_RIGHT },
+  { "top",        TOP },
+  { "bottom",     BOTTOM }
+};
+
+static const replay_name_t zoom_names[] = {
+  { "in",       ZOOM_IN },
+  { "out",      ZOOM_OUT },
+  { "original", ZOOM_ORIGINAL }
+};
+
+static const replay_name_t navigate_names[] = {
+  { "next",     NEXT },
+  { "previous", PREVIOUS }
+};
+
+static const char* action_names[] = {
+  [ZATHURA_REPLAY_SCROLL]   = "scroll",
+  [ZATHURA_REPLAY_ZOOM]     = "zoom",
+  [ZATHURA_REPLAY_NAVIGATE] = "navigate",
+  [ZATHURA_REPLAY_SEARCH]   = "search",
+  [ZATHURA_REPLAY_WAIT]     = "wait"
+};
+
+static bool
+replay_lookup(const replay_name_t* names, size_t n, const char* name, int* argument)
+{
+  for (size_t i = 0; i < n; i++) {
+    if (g_strcmp0(names[i].name, name) == 0) {
+      *argument = names[i].argument;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static bool
+replay_parse_line(char* line, zathura_replay_event_t* event)
+{
+  char* end = NULL;
+  const long delay = strtol(line, &end, 10);
+  if (end == line || delay < 0 || g_ascii_isspace(*end) == FALSE) {
+    return false;
+  }
+
+  gchar** tokens = g_strsplit_set(g_strstrip(end), " \t", 2);
+  const char* action   = tokens[0];
+  const char* argument = action != NULL ? tokens[1] : NULL;
+  if (argument != NULL) {
+    argument = g_strstrip(tokens[1]);
+  }
+
+  event->delay    = delay;
+  event->argument = 0;
+  event->count    = 0;
+  event->text     = NULL;
+
+  bool valid = true;
+  if (g_strcmp0(action, "scroll") == 0) {
+    event->action = ZATHURA_REPLAY_SCROLL;
+    valid = replay_lookup(scroll_names, LENGTH(scroll_names), argument, &event->argument);
+  } else if (g_strcmp0(action, "zoom") == 0) {
+    event->action = ZATHURA_REPLAY_ZOOM;
+    valid = replay_lookup(zoom_names, LENGTH(zoom_names), argument, &event->argument);
+    if (valid == false && argument != NULL) {
+      const long percent = strtol(argument, &end, 10);
+      valid = *end == '\0' && percent > 0;
+      event->argument = ZOOM_SPECIFIC;
+      event->count    = valid == true ? percent : 0;
+    }
+  } else if (g_strcmp0(action, "navigate") == 0) {
+    event->action = ZATHURA_REPLAY_NAVIGATE;
+    valid = replay_lookup(navigate_names, LENGTH(navigate_names), argument, &event->argument);
+  } else if (g_strcmp0(action, "search") == 0) {
+    event->action = ZATHURA_REPLAY_SEARCH;
+    event->argument = FORWARD;
+    valid = argument != NULL && *argument != '\0';
+    if (valid == true) {
+      event->text = g_strdup(argument);
+    }
+  } else if (g_strcmp0(action, "wait") == 0) {
+    event->action = ZATHURA_REPLAY_WAIT;
+    valid = argument == NULL || *argument == '\0';
+  } else {
+    valid = false;
+  }
+  g_strfreev(tokens);
+
+  return valid;
+}
+
+GArray*
+zathura_replay_parse(const char* content, unsigned int* error_line)
+{
+  if (content == NULL) {
+    return NULL;
+  }
+
+  GArray* events = g_array_new(FALSE, FALSE, sizeof(zathura_replay_event_t));
+  gchar** lines  = g_strsplit(content, "\n", -1);
+
+  for (unsigned int i = 0; lines[i] != NULL; i++) {
+    char* line = g_strstrip(lines[i]);
+    if (*line == '\0' || *line == '#') {
+      continue;
+    }
+
+    zathura_replay_event_t event;
+    if (replay_parse_line(line, &event) == false) {
+      if (error_line != NULL) {
+        *error_line = i + 1;
+      }
+      g_strfreev(lines);
+      zathura_replay_events_free(events);
+      return NULL;
+    }
+    g_array_append_val(events, event);
+  }
+  g_strfreev(lines);
+
+  return events;
+}
+
+void
+zathura_replay_events_free(GArray* events)
+{
+  if (events == NULL) {
+    return;
+  }
+
+  for (guint i = 0; i < events->len; i++) {
+    g_free(g_array_index(events, zathura_replay_event_t, i).text);
+  }
+  g_array_free(events, TRUE);
+}
+
+gint64
+zathura_replay_percentile(const gint64* sorted, unsigned int n, double percentile)
+{
+  if (sorted == NULL || n == 0) {
+    return 0;
+  }
+
+  /* nearest rank */
+  unsigned int rank = ceil(percentile / 100 * n);
+  rank = MAX(1, MIN(rank, n));
+
+  return sorted[rank - 1];
+}
+
+static gint
+replay_compare(gconstpointer a, gconstpointer b)
+{
+  const gint64 value_a = *(const gint64*) a;
+  const gint64 value_b = *(const gint64*) b;
+
+  return value_a < value_b ? -1 : (value_a > value_b ? 1 : 0);
+}
+
+/* checks whether all pages in the view show their rendered contents */
+static bool
+replay_view_complete(zathura_t* zathura)
+{
+  if (zathura->document == NULL || zathura->ui.layout.visible.valid == false) {
+    return true;
+  }
+
+  for (unsigned int page_id = zathura->ui.layout.visible.first;
+      page_id <= zathura->ui.layout.visible.last; page_id++) {
+    zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
+    if (page == NULL || zathura_page_get_visibility(page) == false) {
+      continue;
+    }
+
+    GtkWidget* widget = zathura_page_get_widget(zathura, page);
+    if (widget == NULL || zathura_page_widget_is_complete(ZATHURA_PAGE(widget)) == false) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void
+replay_print_event(zathura_replay_t* replay, const char* result, gint64 latency)
+{
+  const zathura_replay_event_t* event = &g_array_index(replay->events,
+      zathura_replay_event_t, replay->next - 1);
+
+  printf("{\"event\": %u, \"action\": \"%s\", \"result\": \"%s\", \"latency_us\": %"
+      G_GINT64_FORMAT "}\n", replay->next - 1, action_names[event->action], result,
+      latency);
+}
+
+static void
+replay_finish(zathura_replay_t* replay)
+{
+  g_array_sort(replay->latencies, replay_compare);
+  const gint64* latencies = (const gint64*) replay->latencies->data;
+  const unsigned int n    = replay->latencies->len;
+
+  printf("{\"replay\": \"%s\", \"events\": %u, \"complete\": %u, \"superseded\": %u, "
+      "\"timed_out\": %u, \"p50_us\": %" G_GINT64_FORMAT ", \"p95_us\": %"
+      G_GINT64_FORMAT ", \"p99_us\": %" G_GINT64_FORMAT ", \"max_us\": %"
+      G_GINT64_FORMAT "}\n", replay->file, replay->events->len, n,
+      replay->superseded, replay->timed_out,
+      zathura_replay_percentile(latencies, n, 50),
+      zathura_replay_percentile(latencies, n, 95),
+      zathura_replay_percentile(latencies, n, 99),
+      zathura_replay_percentile(latencies, n, 100));
+  fflush(stdout);
+
+  girara_info("replayed %u events from '%s'", replay->events->len, replay->file);
+  gtk_main_quit();
+}
+
+/* runs with idle priority, i.e. after pending redraws have been handled */
+static gboolean
+replay_poll(gpointer data)
+{
+  zathura_replay_t* replay = data;
+
+  if (replay->pending == true) {
+    const gint64 latency = g_get_monotonic_time() - replay->dispatched;
+    if (replay_view_complete(replay->zathura) == true) {
+      g_array_append_val(replay->latencies, latency);
+      replay_print_event(replay, "complete", latency);
+      replay->pending = false;
+    } else if (latency > REPLAY_TIMEOUT) {
+      ++replay->timed_out;
+      replay_print_event(replay, "timeout", latency);
+      replay->pending = false;
+    }
+  }
+
+  if (replay->pending == true) {
+    return TRUE;
+  }
+
+  replay->poll_source = 0;
+  if (replay->next >= replay->events->len) {
+    replay_finish(replay);
+  }
+
+  return FALSE;
+}
+
+static void
+replay_event(zathura_replay_t* replay, const zathura_replay_event_t* event)
+{
+  girara_session_t* session = replay->zathura->ui.session;
+  girara_argument_t argument = { event->argument, NULL };
+
+  switch (event->action) {
+    case ZATHURA_REPLAY_SCROLL:
+      sc_scroll(session, &argument, NULL, 0);
+      break;
+    case ZATHURA_REPLAY_ZOOM:
+      sc_zoom(session, &argument, NULL, event->count);
+      break;
+    case ZATHURA_REPLAY_NAVIGATE:
+      sc_navigate(session, &argument, NULL, 0);
+      break;
+    case ZATHURA_REPLAY_SEARCH:
+      cmd_search(session, event->text, &argument);
+      break;
+    case ZATHURA_REPLAY_WAIT:
+      break;
+  }
+}
+
+static gboolean
+replay_dispatch(gpointer data)
+{
+  zathura_replay_t* replay = data;
+  replay->event_source = 0;
+
+  if (replay->zathura->document == NULL) {
+    girara_error("replay stopped, the document has been closed");
+    return FALSE;
+  }
+
+  /* the view never became complete before this event */
+  if (replay->pending == true) {
+    ++replay->superseded;
+    replay_print_event(replay, "superseded", g_get_monotonic_time() - replay->dispatched);
+  }
+
+  const zathura_replay_event_t* event = &g_array_index(replay->events,
+      zathura_replay_event_t, replay->next);
+  ++replay->next;
+
+  replay->dispatched = g_get_monotonic_time();
+  replay->pending    = event->action != ZATHURA_REPLAY_WAIT;
+  replay_event(replay, event);
+
+  if (replay->next < replay->events->len) {
+    const zathura_replay_event_t* next = &g_array_index(replay->events,
+        zathura_replay_event_t, replay->next);
+    replay->event_source = gdk_threads_add_timeout(next->delay, replay_dispatch, replay);
+  }
+
+  if (replay->poll_source == 0) {
+    replay->poll_source = gdk_threads_add_timeout_full(G_PRIORITY_DEFAULT_IDLE,
+        REPLAY_POLL_INTERVAL, replay_poll, replay, NULL);
+  }
+
+  return FALSE;
+}
+
+zathura_replay_t*
+zathura_replay_start(zathura_t* zathura, const char* file)
+{
+  if (zathura == NULL || file == NULL) {
+    return NULL;
+  }
+
+  GError* error  = NULL;
+  char* content  = NULL;
+  if (g_file_get_contents(file, &content, NULL, &error) == FALSE) {
+    girara_error("could not read replay '%s': %s", file, error->message);
+    g_error_free(error);
+    return NULL;
+  }
+
+  unsigned int error_line = 0;
+  GArray* events = zathura_replay_parse(content, &error_line);
+  g_free(content);
+  if (events == NULL) {
+    girara_error("invalid event in line %u of replay '%s'", error_line, file);
+    return NULL;
+  }
+
+  zathura_replay_t* replay = g_malloc0(sizeof(zathura_replay_t));
+  replay->zathura   = zathura;
+  replay->file      = g_strdup(file);
+  replay->events    = events;
+  replay->latencies = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+  if (events->len == 0) {
+    replay->poll_source = gdk_threads_add_timeout_full(G_PRIORITY_DEFAULT_IDLE,
+        REPLAY_POLL_INTERVAL, replay_poll, replay, NULL);
+  } else {
+    const zathura_replay_event_t* event = &g_array_index(events, zathura_replay_event_t, 0);
+    replay->event_source = gdk_threads_add_timeout(event->delay, replay_dispatch, replay);
+  }
+
+  return replay;
+}
+
+void
+zathura_replay_free(zathura_replay_t* replay)
+{
+  if (replay == NULL) {
+    return;
+  }
+
+  if (replay->event_source != 0) {
+    g_source_remove(replay->event_source);
+  }
+  if (replay->poll_source != 0) {
+    g_source_remove(replay->poll_source);
+  }
+
+  zathura_replay_events_free(replay->events);
+  g_array_free(replay->latencies, TRUE);
+  g_free(replay->file);
+  g_free(replay);
+}
@@ -0,0 +1,89 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+#include "zathura.h"
+
+/**
+ * What a recorded event does
+ */
+typedef enum zathura_replay_action_e {
+  ZATHURA_REPLAY_SCROLL, /**< Scroll like sc_scroll */
+  ZATHURA_REPLAY_ZOOM, /**< Zoom like sc_zoom */
+  ZATHURA_REPLAY_NAVIGATE, /**< Go to another page like sc_navigate */
+  ZATHURA_REPLAY_SEARCH, /**< Search like the search command */
+  ZATHURA_REPLAY_WAIT /**< Do nothing */
+} zathura_replay_action_t;
+
+/**
+ * A recorded event
+ */
+typedef struct zathura_replay_event_s {
+  unsigned int delay; /**< Milliseconds since the previous event */
+  zathura_replay_action_t action; /**< What the event does */
+  int argument; /**< Argument of the shortcut, e.g. DOWN or ZOOM_IN */
+  unsigned int count; /**< Count of the shortcut, e.g. the zoom level */
+  char* text; /**< The query of a search */
+} zathura_replay_event_t;
+
+/**
+ * Parses a recorded sequence of events. Every line consists of the delay in
+ * milliseconds since the previous event, the action and its argument:
+ *
+ *   <delay> scroll down|up|left|right|half-down|half-up|full-down|full-up|
+ *                  half-left|half-right|full-left|full-right|top|bottom
+ *   <delay> zoom in|out|original|<percent>
+ *   <delay> navigate next|previous
+ *   <delay> search <text>
+ *   <delay> wait
+ *
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ * @param content The recorded sequence
+ * @param error_line Set to the number of the first invalid line (or NULL)
+ * @return Array of zathura_replay_event_t (free with
+ *   zathura_replay_events_free) or NULL if a line is invalid
+ */
+GArray* zathura_replay_parse(const char* content, unsigned int* error_line);
+
+/**
+ * Frees parsed events
+ *
+ * @param events The events
+ */
+void zathura_replay_events_free(GArray* events);
+
+/**
+ * Returns a percentile with the nearest-rank method
+ *
+ * @param sorted Values sorted in ascending order
+ * @param n Number of values
+ * @param percentile The percentile (0 to 100)
+ * @return The percentile or 0 if there are no values
+ */
+gint64 zathura_replay_percentile(const gint64* sorted, unsigned int n, double percentile);
+
+/**
+ * Starts replaying a recorded sequence of events on the opened document. After
+ * each event it is measured how long it takes until all pages in the view are
+ * drawn with their rendered contents. Once all events have been replayed, the
+ * results are printed to stdout as JSON and zathura quits.
+ *
+ * @param zathura The zathura session
+ * @param file The file containing the recorded sequence
+ * @return The replay or NULL if the file could not be read
+ */
+zathura_replay_t* zathura_replay_start(zathura_t* zathura, const char* file);
+
+/**
+ * Stops and frees a replay
+ *
+ * @param replay The replay
+ */
+void zathura_replay_free(zathura_replay_t* replay);
+
+#endif // REPLAY_H
@@ -0,0 +1,464 @@
+/* See LICENSE file for license and copyright information */
+
+#include <math.h>
+#include <girara/session.h>
+#include <girara/settings.h>
+#include <girara/utils.h>
+
+#include "scroll.h"
+#include "adjustment.h"
+#include "callbacks.h"
+#include "macros.h"
+#include "page-layout.h"
+#include "prefetch.h"
+
+/* interval in milliseconds between frames if there is no frame clock */
+#define SCROLL_FRAME_INTERVAL 16
+/* time in seconds in which the velocity of a kinetic scroll decays to 1/e */
+#define SCROLL_KINETIC_TIME_CONSTANT 0.325
+/* kinetic scrolls stop below this velocity in pixels per second */
+#define SCROLL_KINETIC_MIN_VELOCITY 20.0
+/* a drag has to be faster than this to keep moving once it ends */
+#define SCROLL_KINETIC_START_VELOCITY 200.0
+/* the drag has halted if the pointer has not moved for this many microseconds */
+#define SCROLL_DRAG_IDLE (50 * G_TIME_SPAN_MILLISECOND)
+
+#if GTK_CHECK_VERSION(3, 8, 0)
+#define SCROLL_FRAME_CLOCK
+#endif
+
+/**
+ * Animation of one adjustment of the view
+ */
+typedef struct scroll_axis_s {
+  GtkAdjustment* adjustment; /**< The adjustment */
+  bool active; /**< The adjustment is animated */
+  bool kinetic; /**< The animation is a kinetic scroll */
+  double from; /**< Value at the start of the animation */
+  double to; /**< Destination of the animation */
+  gint64 start; /**< Frame time at the start of the animation (0 until the first frame) */
+  gint64 duration; /**< Duration of the animation in microseconds */
+  double position; /**< Unclamped position of a kinetic scroll */
+  double velocity; /**< Velocity of a kinetic scroll or a drag in pixels per second */
+  gint64 last; /**< Frame time of the last step of a kinetic scroll or a drag */
+  double value; /**< Value the animation has set last */
+  double drag_value; /**< Value at the last motion of a drag */
+} scroll_axis_t;
+
+struct zathura_scroll_s {
+  guint source; /**< Frame callback or timeout (0 if no frame is pending) */
+  bool update_view; /**< The visible pages are updated in the next frame */
+  bool dragging; /**< The view is dragged with the mouse */
+  scroll_axis_t axes[2]; /**< Horizontal and vertical animation */
+};
+
+double
+zathura_scroll_ease(double from, double to, double progress)
+{
+  if (progress <= 0) {
+    return from;
+  } else if (progress >= 1) {
+    return to;
+  }
+
+  /* cubic ease out */
+  const double remaining = 1 - progress;
+  return from + (to - from) * (1 - remaining * remaining * remaining);
+}
+
+double
+zathura_scroll_kinetic_step(double* velocity, double elapsed, double time_constant)
+{
+  if (velocity == NULL || elapsed <= 0 || time_constant <= 0) {
+    return 0;
+  }
+
+  const double decay = exp(-elapsed / time_constant);
+  const double distance = *velocity * time_constant * (1 - decay);
+  *velocity *= decay;
+
+  return distance;
+}
+
+double
+zathura_scroll_kinetic_distance(double velocity, double time_constant)
+{
+  return velocity * time_constant;
+}
+
+static zathura_scroll_t*
+scroll_get(zathura_t* zathura)
+{
+  if (zathura->ui.scroll == NULL) {
+    zathura_scroll_t* scroll = g_malloc0(sizeof(zathura_scroll_t));
+    GtkScrolledWindow* view = GTK_SCROLLED_WINDOW(zathura->ui.session->gtk.view);
+    scroll->axes[0].adjustment = gtk_scrolled_window_get_hadjustment(view);
+    scroll->axes[1].adjustment = gtk_scrolled_window_get_vadjustment(view);
+    zathura->ui.scroll = scroll;
+  }
+
+  return zathura->ui.scroll;
+}
+
+static scroll_axis_t*
+scroll_get_axis(zathura_scroll_t* scroll, GtkAdjustment* adjustment)
+{
+  for (unsigned int i = 0; i < G_N_ELEMENTS(scroll->axes); i++) {
+    if (scroll->axes[i].adjustment == adjustment) {
+      return &scroll->axes[i];
+    }
+  }
+
+  return NULL;
+}
+
+static double
+scroll_clamp(GtkAdjustment* adjustment, double value)
+{
+  const double lower = gtk_adjustment_get_lower(adjustment);
+  const double upper = gtk_adjustment_get_upper(adjustment) -
+    gtk_adjustment_get_page_size(adjustment);
+
+  return MAX(lower, MIN(upper, value));
+}
+
+/* renders the pages that will be shown once the view has moved to the
+ * destination of the vertical animation */
+static void
+scroll_prefetch_destination(zathura_t* zathura, double destination)
+{
+  if (zathura->document == NULL || zathura->ui.page_widget == NULL) {
+    return;
+  }
+
+  GtkAdjustment* vadjustment = scroll_get(zathura)->axes[1].adjustment;
+  const double value = gtk_adjustment_get_value(vadjustment);
+  const double height = gtk_adjustment_get_page_size(vadjustment);
+
+  /* pages are positioned relative to the widget containing them */
+  int origin_x = 0;
+  int origin_y = 0;
+  gtk_widget_translate_coordinates(zathura->ui.page_widget,
+      zathura->ui.session->gtk.view, 0, 0, &origin_x, &origin_y);
+
+  unsigned int first = 0;
+  unsigned int last  = 0;
+  if (zathura_page_layout_get_pages_in_range(zathura->ui.layout.pages,
+        destination - value - origin_y, height, &first, &last) == true) {
+    prefetch_range(zathura, first, last);
+  }
+}
+
+/* advances the animations and updates the visible pages; returns whether
+ * another frame is needed */
+static bool
+scroll_frame(zathura_t* zathura, gint64 frame_time)
+{
+  zathura_scroll_t* scroll = zathura->ui.scroll;
+
+  bool animating = false;
+  for (unsigned int i = 0; i < G_N_ELEMENTS(scroll->axes); i++) {
+    scroll_axis_t* axis = &scroll->axes[i];
+    if (axis->active == false) {
+      continue;
+    }
+
+    /* the view has been moved by something else */
+    if (fabs(gtk_adjustment_get_value(axis->adjustment) - axis->value) >= 0.5) {
+      axis->active = false;
+      continue;
+    }
+
+    double value = axis->to;
+    if (axis->kinetic == true) {
+      const double elapsed = (frame_time - axis->last) / (double) G_USEC_PER_SEC;
+      axis->position += zathura_scroll_kinetic_step(&axis->velocity, elapsed,
+          SCROLL_KINETIC_TIME_CONSTANT);
+      axis->last = frame_time;
+      value = scroll_clamp(axis->adjustment, axis->position);
+
+      /* the view stops at the ends of the document as well */
+      axis->active = fabs(axis->velocity) >= SCROLL_KINETIC_MIN_VELOCITY &&
+        value == axis->position;
+    } else {
+      if (axis->start == 0) {
+        axis->start = frame_time;
+      }
+
+      const double progress = axis->duration > 0 ?
+        (frame_time - axis->start) / (double) axis->duration : 1;
+
+      value = zathura_scroll_ease(axis->from, axis->to, progress);
+      axis->active = progress < 1;
+    }
+
+    axis->value = value;
+    zathura_adjustment_set_value(axis->adjustment, value);
+    animating = animating || axis->active;
+  }
+
+  /* the adjustments have changed any number of times since the last frame */
+  if (scroll->update_view == true) {
+    scroll->update_view = false;
+    cb_view_vadjustment_value_changed(NULL, zathura);
+  }
+
+  return animating;
+}
+
+#ifdef SCROLL_FRAME_CLOCK
+static gboolean
+scroll_tick(GtkWidget* UNUSED(widget), GdkFrameClock* clock, gpointer data)
+{
+  zathura_t* zathura = data;
+
+  if (scroll_frame(zathura, gdk_frame_clock_get_frame_time(clock)) == true) {
+    return TRUE;
+  }
+
+  zathura->ui.scroll->source = 0;
+  return FALSE;
+}
+#else
+static gboolean
+scroll_timeout(gpointer data)
+{
+  zathura_t* zathura = data;
+
+  if (scroll_frame(zathura, g_get_monotonic_time()) == true) {
+    return TRUE;
+  }
+
+  zathura->ui.scroll->source = 0;
+  return FALSE;
+}
+#endif
+
+static void
+scroll_schedule(zathura_t* zathura)
+{
+  zathura_scroll_t* scroll = scroll_get(zathura);
+  if (scroll->source != 0) {
+    return;
+  }
+
+#ifdef SCROLL_FRAME_CLOCK
+  scroll->source = gtk_widget_add_tick_callback(zathura->ui.session->gtk.view,
+      scroll_tick, zathura, NULL);
+#else
+  /* the pages are updated before the view is redrawn */
+  scroll->source = gdk_threads_add_timeout_full(GDK_PRIORITY_REDRAW - 1,
+      SCROLL_FRAME_INTERVAL, scroll_timeout, zathura, NULL);
+#endif
+}
+
+static void
+scroll_unschedule(zathura_t* zathura)
+{
+  zathura_scroll_t* scroll = zathura->ui.scroll;
+  if (scroll->source == 0) {
+    return;
+  }
+
+#ifdef SCROLL_FRAME_CLOCK
+  gtk_widget_remove_tick_callback(zathura->ui.session->gtk.view, scroll->source);
+#else
+  g_source_remove(scroll->source);
+#endif
+  scroll->source = 0;
+}
+
+void
+scroll_to(zathura_t* zathura, GtkAdjustment* adjustment, double value)
+{
+  if (zathura == NULL || adjustment == NULL) {
+    return;
+  }
+
+  bool smooth_scroll = false;
+  girara_setting_get(zathura->ui.session, "smooth-scroll", &smooth_scroll);
+
+  zathura_scroll_t* scroll = scroll_get(zathura);
+  scroll_axis_t* axis = scroll_get_axis(scroll, adjustment);
+  value = scroll_clamp(adjustment, value);
+
+  if (smooth_scroll == false || axis == NULL || scroll->dragging == true) {
+    if (axis != NULL) {
+      axis->active = false;
+    }
+    zathura_adjustment_set_value(adjustment, value);
+    return;
+  }
+
+  const double current = gtk_adjustment_get_value(adjustment);
+  if (value == current) {
+    axis->active = false;
+    return;
+  }
+
+  /* further steps continue from the current position instead of waiting for
+   * the running animation to finish */
+  axis->active  = true;
+  axis->kinetic = false;
+  axis->from    = current;
+  axis->to      = value;
+  axis->value   = current;
+  axis->start   = 0;
+
+  int duration = 150;
+  girara_setting_get(zathura->ui.session, "smooth-scroll-duration", &duration);
+  axis->duration = (gint64) duration * G_TIME_SPAN_MILLISECOND;
+
+  if (axis == &scroll->axes[1]) {
+    scroll_prefetch_destination(zathura, value);
+  }
+  scroll_schedule(zathura);
+}
+
+double
+scroll_get_destination(zathura_t* zathura, GtkAdjustment* adjustment)
+{
+  if (zathura == NULL || adjustment == NULL) {
+    return 0;
+  }
+
+  scroll_axis_t* axis = scroll_get_axis(scroll_get(zathura), adjustment);
+  if (axis == NULL || axis->active == false) {
+    return gtk_adjustment_get_value(adjustment);
+  }
+
+  if (axis->kinetic == true) {
+    return scroll_clamp(adjustment, axis->position +
+        zathura_scroll_kinetic_distance(axis->velocity, SCROLL_KINETIC_TIME_CONSTANT));
+  }
+
+  return axis->to;
+}
+
+void
+scroll_drag_begin(zathura_t* zathura)
+{
+  if (zathura == NULL) {
+    return;
+  }
+
+  zathura_scroll_t* scroll = scroll_get(zathura);
+  scroll->dragging = true;
+
+  const gint64 now = g_get_monotonic_time();
+  for (unsigned int i = 0; i < G_N_ELEMENTS(scroll->axes); i++) {
+    scroll_axis_t* axis = &scroll->axes[i];
+    axis->active     = false;
+    axis->velocity   = 0;
+    axis->last       = now;
+    axis->drag_value = gtk_adjustment_get_value(axis->adjustment);
+  }
+}
+
+void
+scroll_drag_motion(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->ui.scroll == NULL || zathura->ui.scroll->dragging == false) {
+    return;
+  }
+
+  zathura_scroll_t* scroll = zathura->ui.scroll;
+  const gint64 now = g_get_monotonic_time();
+  for (unsigned int i = 0; i < G_N_ELEMENTS(scroll->axes); i++) {
+    scroll_axis_t* axis = &scroll->axes[i];
+    const double value = gtk_adjustment_get_value(axis->adjustment);
+    if (now > axis->last) {
+      /* smooth the velocity, motion events do not arrive evenly */
+      const double velocity = (value - axis->drag_value) * G_USEC_PER_SEC / (now - axis->last);
+      axis->velocity = 0.8 * velocity + 0.2 * axis->velocity;
+    }
+    axis->drag_value = value;
+    axis->last       = now;
+  }
+}
+
+void
+scroll_drag_end(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->ui.scroll == NULL || zathura->ui.scroll->dragging == false) {
+    return;
+  }
+
+  zathura_scroll_t* scroll = zathura->ui.scroll;
+  scroll->dragging = false;
+
+  bool kinetic_scroll = false;
+  girara_setting_get(zathura->ui.session, "kinetic-scroll", &kinetic_scroll);
+  if (kinetic_scroll == false) {
+    return;
+  }
+
+  const gint64 now = g_get_monotonic_time();
+  bool started = false;
+  for (unsigned int i = 0; i < G_N_ELEMENTS(scroll->axes); i++) {
+    scroll_axis_t* axis = &scroll->axes[i];
+
+    /* the pointer has been held still before it has been released */
+    if (now - axis->last > SCROLL_DRAG_IDLE ||
+        fabs(axis->velocity) < SCROLL_KINETIC_START_VELOCITY) {
+      continue;
+    }
+
+    axis->active   = true;
+    axis->kinetic  = true;
+    axis->position = gtk_adjustment_get_value(axis->adjustment);
+    axis->value    = axis->position;
+    axis->last     = now;
+    started        = true;
+  }
+
+  if (started == false) {
+    return;
+  }
+
+  if (scroll->axes[1].active == true) {
+    scroll_prefetch_destination(zathura,
+        scroll_get_destination(zathura, scroll->axes[1].adjustment));
+  }
+  scroll_schedule(zathura);
+}
+
+void
+scroll_update_view(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->ui.session == NULL) {
+    return;
+  }
+
+  zathura_scroll_t* scroll = scroll_get(zathura);
+  scroll->update_view = true;
+  scroll_schedule(zathura);
+}
+
+void
+scroll_stop(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->ui.scroll == NULL) {
+    return;
+  }
+
+  zathura_scroll_t* scroll = zathura->ui.scroll;
+  scroll_unschedule(zathura);
+  scroll->update_view = false;
+  scroll->dragging    = false;
+  for (unsigned int i = 0; i < G_N_ELEMENTS(scroll->axes); i++) {
+    scroll->axes[i].active = false;
+  }
+}
+
+void
+scroll_free(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->ui.scroll == NULL) {
+    return;
+  }
+
+  scroll_stop(zathura);
+  g_free(zathura->ui.scroll);
+  zathura->ui.scroll = NULL;
+}
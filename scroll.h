@@ -0,0 +1,107 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef SCROLL_H
+#define SCROLL_H
+
+#include <stdbool.h>
+#include <gtk/gtk.h>
+
+#include "zathura.h"
+
+/**
+ * Returns the position of an animated scroll
+ *
+ * @param from Position at the start of the animation
+ * @param to Destination of the animation
+ * @param progress Elapsed fraction of the duration of the animation
+ * @return The position; the movement slows down towards the destination
+ */
+double zathura_scroll_ease(double from, double to, double progress);
+
+/**
+ * Advances a kinetic scroll. Its velocity decays exponentially.
+ *
+ * @param velocity Velocity in pixels per second; it is replaced by the
+ *   velocity after the step
+ * @param elapsed Duration of the step in seconds
+ * @param time_constant Time in seconds in which the velocity decays to 1/e
+ * @return Distance in pixels covered during the step
+ */
+double zathura_scroll_kinetic_step(double* velocity, double elapsed, double
+    time_constant);
+
+/**
+ * Returns the distance a kinetic scroll covers until it stops
+ *
+ * @param velocity Initial velocity in pixels per second
+ * @param time_constant Time in seconds in which the velocity decays to 1/e
+ * @return The distance in pixels
+ */
+double zathura_scroll_kinetic_distance(double velocity, double time_constant);
+
+/**
+ * Scrolls the view to a position. If smooth-scroll is enabled, the position
+ * is approached over the following frames; otherwise it is set right away.
+ * The pages around the destination are rendered before they come into view.
+ *
+ * @param zathura The zathura session
+ * @param adjustment The horizontal or vertical adjustment of the view
+ * @param value The destination
+ */
+void scroll_to(zathura_t* zathura, GtkAdjustment* adjustment, double value);
+
+/**
+ * Returns the destination the view is scrolled to
+ *
+ * @param zathura The zathura session
+ * @param adjustment The horizontal or vertical adjustment of the view
+ * @return The destination of the running animation or the current value
+ */
+double scroll_get_destination(zathura_t* zathura, GtkAdjustment* adjustment);
+
+/**
+ * Starts dragging the view with the mouse. Running animations are stopped.
+ *
+ * @param zathura The zathura session
+ */
+void scroll_drag_begin(zathura_t* zathura);
+
+/**
+ * Records the position of the view while it is dragged, so that the velocity
+ * of the drag is known once it ends.
+ *
+ * @param zathura The zathura session
+ */
+void scroll_drag_motion(zathura_t* zathura);
+
+/**
+ * Ends dragging the view. If kinetic-scroll is enabled, the view keeps moving
+ * and slows down until it stops.
+ *
+ * @param zathura The zathura session
+ */
+void scroll_drag_end(zathura_t* zathura);
+
+/**
+ * Updates the visible pages in the next frame. Any number of changes of the
+ * adjustments during a frame result in a single update.
+ *
+ * @param zathura The zathura session
+ */
+void scroll_update_view(zathura_t* zathura);
+
+/**
+ * Stops all animations and drops pending updates
+ *
+ * @param zathura The zathura session
+ */
+void scroll_stop(zathura_t* zathura);
+
+/**
+ * Frees the state of the animations
+ *
+ * @param zathura The zathura session
+ */
+void scroll_free(zathura_t* zathura);
+
+#endif // SCROLL_H
@@ -0,0 +1,490 @@
+/* See LICENSE file for license and copyright information */
+
+#include <string.h>
+#include <girara/datastructures.h>
+#include <girara/utils.h>
+#include <girara/session.h>
+#include <girara/settings.h>
+
+#include "glib-compat.h"
+#include "search.h"
+#include "document.h"
+#include "page.h"
+#include "plugin.h"
+#include "render.h"
+#include "utils.h"
+
+/* interval in milliseconds in which found results are passed to the widgets */
+#define SEARCH_UPDATE_INTERVAL 50
+
+/* time in milliseconds typing has to pause before an incremental search starts */
+#define SEARCH_DELAY 150
+
+/**
+ * Results of a single page
+ */
+typedef struct search_result_s {
+  unsigned int page; /**< The page index */
+  girara_list_t* list; /**< The found rectangles or NULL */
+  zathura_error_t error; /**< Error returned by the plugin */
+} search_result_t;
+
+/**
+ * A search that is running in the background
+ */
+struct search_job_s {
+  zathura_t* zathura; /**< Zathura object */
+  char* input; /**< The text to search for */
+  int direction; /**< The search direction */
+  unsigned int start_page; /**< The page the search started on */
+  unsigned int number_of_pages; /**< Number of pages */
+  unsigned int* order; /**< Pages in the order the workers search them */
+  unsigned int number_of_positions; /**< Number of pages the workers search */
+  bool serialize; /**< Whether the render lock has to be held */
+  bool use_index; /**< Whether the text index is used */
+  GThread** threads; /**< Worker threads */
+  unsigned int number_of_threads; /**< Number of worker threads */
+  gint next; /**< Position of the next page to search */
+  gint cancelled; /**< Set when the workers should stop */
+  gint running; /**< Number of workers that are still running */
+  GAsyncQueue* results; /**< Results that have not been passed to the widgets */
+  guint source; /**< Source that passes results to the widgets */
+  gint64 start; /**< Time the search has been started */
+
+  /* only used on the main thread */
+  bool* searched; /**< Pages whose results are known */
+  bool* found; /**< Pages with hits */
+  bool* empty; /**< Pages known not to contain the input */
+  unsigned int first_pending; /**< Offset from the start page of the first
+                                page whose results are not known yet */
+  unsigned int pages_searched; /**< Number of searched pages */
+  bool first_hit_shown; /**< The first hit has been shown */
+};
+
+static void
+search_result_free(search_result_t* result)
+{
+  if (result == NULL) {
+    return;
+  }
+
+  if (result->list != NULL) {
+    girara_list_free(result->list);
+  }
+  g_free(result);
+}
+
+/**
+ * A search that starts once typing has paused
+ */
+typedef struct search_request_s {
+  zathura_t* zathura; /**< Zathura object */
+  char* input; /**< The text to search for */
+  int direction; /**< The search direction */
+} search_request_t;
+
+static void
+search_request_free(search_request_t* request)
+{
+  g_free(request->input);
+  g_free(request);
+}
+
+static unsigned int
+search_page_of(search_job_t* job, unsigned int offset)
+{
+  return (job->start_page + offset) % job->number_of_pages;
+}
+
+/* checks the text index; only pages without text and pages the plugin did
+ * not find the input on before are skipped */
+static bool
+search_text_index_match(search_job_t* job, zathura_page_t* page)
+{
+  zathura_text_index_t* index = job->zathura->text_index;
+  if (index == NULL || job->use_index == false) {
+    return true;
+  }
+
+  const unsigned int page_id = zathura_page_get_index(page);
+  return zathura_text_index_match(index, page_id, job->input) != ZATHURA_TEXT_INDEX_NO_MATCH;
+}
+
+static gpointer
+search_worker(gpointer data)
+{
+  search_job_t* job   = data;
+  zathura_t* zathura  = job->zathura;
+
+  while (g_atomic_int_get(&job->cancelled) == 0) {
+    const gint position = g_atomic_int_add(&job->next, 1);
+    if (position < 0 || (unsigned int) position >= job->number_of_positions) {
+      break;
+    }
+
+    const unsigned int page_id = job->order[position];
+    zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
+
+    search_result_t* result = g_malloc0(sizeof(search_result_t));
+    result->page = page_id;
+    if (page != NULL) {
+      if (job->serialize == true) {
+        render_lock(zathura->sync.render_thread);
+      }
+      /* the plugin is only asked for the positions of hits on pages whose
+       * text might contain them */
+      if (search_text_index_match(job, page) == true) {
+        result->list = zathura_page_search_text(page, job->input, &result->error);
+        if (job->use_index == true && result->error == ZATHURA_ERROR_OK &&
+            (result->list == NULL || girara_list_size(result->list) == 0)) {
+          zathura_text_index_set_miss(zathura->text_index, page_id, job->input);
+        }
+      }
+      if (job->serialize == true) {
+        render_unlock(zathura->sync.render_thread);
+      }
+    }
+
+    g_async_queue_push(job->results, result);
+
+    /* there is no point in asking the other pages */
+    if (result->error == ZATHURA_ERROR_NOT_IMPLEMENTED) {
+      g_atomic_int_set(&job->cancelled, 1);
+    }
+  }
+
+  g_atomic_int_add(&job->running, -1);
+  return NULL;
+}
+
+/* passes a result to the page widget and records it */
+static void
+search_apply_result(search_job_t* job, search_result_t* result)
+{
+  zathura_t* zathura = job->zathura;
+  zathura_page_t* page = zathura_document_get_page(zathura->document, result->page);
+  GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
+  if (page_widget == NULL) {
+    return;
+  }
+
+  g_object_set(page_widget, "draw-links", FALSE, NULL);
+
+  const bool found = result->list != NULL && girara_list_size(result->list) > 0;
+  if (found == true) {
+    /* the widget takes ownership of the list */
+    g_object_set(page_widget, "search-results", result->list, NULL);
+    result->list = NULL;
+  } else {
+    g_object_set(page_widget, "search-results", NULL, NULL);
+  }
+
+  job->searched[result->page] = true;
+  job->found[result->page]    = found;
+  job->empty[result->page]    = found == false &&
+    result->error != ZATHURA_ERROR_NOT_IMPLEMENTED;
+  ++job->pages_searched;
+}
+
+/* shows the first hit once all pages in front of it have been searched */
+static void
+search_show_first_hit(search_job_t* job)
+{
+  while (job->first_hit_shown == false && job->first_pending < job->number_of_pages &&
+      job->searched[search_page_of(job, job->first_pending)] == true) {
+    const unsigned int offset  = job->first_pending++;
+    const unsigned int page_id = search_page_of(job, offset);
+    if (job->found[page_id] == false) {
+      continue;
+    }
+
+    zathura_t* zathura     = job->zathura;
+    zathura_page_t* page   = zathura_document_get_page(zathura->document, page_id);
+    GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
+
+    if (offset != 0) {
+      page_set_delayed(zathura, page_id);
+    }
+
+    if (job->direction == BACKWARD) {
+      /* start at bottom hit in page */
+      girara_list_t* results = NULL;
+      g_object_get(page_widget, "search-results", &results, NULL);
+      g_object_set(page_widget, "search-current", girara_list_size(results) - 1, NULL);
+    } else {
+      g_object_set(page_widget, "search-current", 0, NULL);
+    }
+
+    job->first_hit_shown = true;
+  }
+}
+
+/* stops the workers; results they have already found are still applied, so
+ * that the job stays a complete record of what is known about each page */
+static void
+search_job_stop(search_job_t* job)
+{
+  g_atomic_int_set(&job->cancelled, 1);
+  for (unsigned int i = 0; i < job->number_of_threads; i++) {
+    if (job->threads[i] != NULL) {
+      g_thread_join(job->threads[i]);
+      job->threads[i] = NULL;
+    }
+  }
+
+  if (job->source != 0) {
+    g_source_remove(job->source);
+    job->source = 0;
+  }
+
+  search_result_t* result = NULL;
+  while ((result = g_async_queue_try_pop(job->results)) != NULL) {
+    search_apply_result(job, result);
+    search_result_free(result);
+  }
+}
+
+static void
+search_job_free(search_job_t* job)
+{
+  g_atomic_int_set(&job->cancelled, 1);
+  for (unsigned int i = 0; i < job->number_of_threads; i++) {
+    if (job->threads[i] != NULL) {
+      g_thread_join(job->threads[i]);
+    }
+  }
+
+  if (job->source != 0) {
+    g_source_remove(job->source);
+  }
+
+  search_result_t* result = NULL;
+  while ((result = g_async_queue_try_pop(job->results)) != NULL) {
+    search_result_free(result);
+  }
+  g_async_queue_unref(job->results);
+
+  g_free(job->threads);
+  g_free(job->order);
+  g_free(job->searched);
+  g_free(job->found);
+  g_free(job->empty);
+  g_free(job->input);
+  g_free(job);
+}
+
+static gboolean
+search_update(gpointer data)
+{
+  search_job_t* job = data;
+
+  /* the workers decrement the counter after their last result is queued */
+  const bool finished = g_atomic_int_get(&job->running) == 0;
+
+  search_result_t* result = NULL;
+  while ((result = g_async_queue_try_pop(job->results)) != NULL) {
+    search_apply_result(job, result);
+    search_result_free(result);
+  }
+
+  search_show_first_hit(job);
+
+  if (finished == false) {
+    return TRUE;
+  }
+
+  girara_debug("searched %u of %u pages for '%s' in %" G_GINT64_FORMAT " ms",
+               job->pages_searched, job->number_of_pages, job->input,
+               (g_get_monotonic_time() - job->start) / 1000);
+
+  /* the finished job is kept, so that a refined search can reuse it */
+  job->source = 0;
+  search_job_stop(job);
+
+  return FALSE;
+}
+
+/* pages that are known not to contain a prefix of the input do not contain
+ * the input either */
+static void
+search_job_reuse(search_job_t* job, search_job_t* previous)
+{
+  if (previous == NULL || previous->number_of_pages != job->number_of_pages ||
+      g_str_has_prefix(job->input, previous->input) == FALSE) {
+    return;
+  }
+
+  unsigned int reused = 0;
+  for (unsigned int page_id = 0; page_id < job->number_of_pages; page_id++) {
+    if (previous->empty[page_id] == true) {
+      job->searched[page_id] = true;
+      job->empty[page_id]    = true;
+      ++reused;
+    }
+  }
+
+  girara_debug("skipping %u pages without '%s'", reused, previous->input);
+}
+
+/* visible pages are searched first, so that their results show up while the
+ * rest of the document is searched */
+static void
+search_job_order(search_job_t* job)
+{
+  zathura_document_t* document = job->zathura->document;
+
+  job->order = g_malloc0_n(job->number_of_pages, sizeof(unsigned int));
+  for (unsigned int visible = 1; visible <= 2; visible++) {
+    for (unsigned int offset = 0; offset < job->number_of_pages; offset++) {
+      const unsigned int page_id = search_page_of(job, offset);
+      zathura_page_t* page = zathura_document_get_page(document, page_id);
+      const bool is_visible = page != NULL && zathura_page_get_visibility(page) == true;
+      if (job->searched[page_id] == false && is_visible == (visible == 1)) {
+        job->order[job->number_of_positions++] = page_id;
+      }
+    }
+  }
+}
+
+bool
+search_start(zathura_t* zathura, const char* input, int direction)
+{
+  if (zathura == NULL || zathura->document == NULL || input == NULL) {
+    return false;
+  }
+
+  if (zathura->sync.search_delay != 0) {
+    g_source_remove(zathura->sync.search_delay);
+    zathura->sync.search_delay = 0;
+  }
+
+  search_job_t* previous = zathura->sync.search;
+  zathura->sync.search = NULL;
+  if (previous != NULL) {
+    search_job_stop(previous);
+  }
+
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  if (number_of_pages == 0) {
+    if (previous != NULL) {
+      search_job_free(previous);
+    }
+    return false;
+  }
+
+  search_job_t* job    = g_malloc0(sizeof(search_job_t));
+  job->zathura         = zathura;
+  job->input           = g_strdup(input);
+  job->direction       = direction;
+  job->start_page      = zathura_document_get_current_page_number(zathura->document);
+  job->number_of_pages = number_of_pages;
+  job->searched        = g_malloc0_n(number_of_pages, sizeof(bool));
+  job->found           = g_malloc0_n(number_of_pages, sizeof(bool));
+  job->empty           = g_malloc0_n(number_of_pages, sizeof(bool));
+  job->results         = g_async_queue_new();
+  job->use_index       = zathura->text_index != NULL;
+  job->start           = g_get_monotonic_time();
+
+  search_job_reuse(job, previous);
+  if (previous != NULL) {
+    search_job_free(previous);
+  }
+  search_job_order(job);
+
+  /* only search pages in parallel if the plugin allows it */
+  job->serialize = true;
+  job->number_of_threads = 1;
+  zathura_plugin_t* plugin = zathura_document_get_plugin(zathura->document);
+  zathura_plugin_functions_t* functions = zathura_plugin_get_functions(plugin);
+  if (functions != NULL && (functions->capabilities & ZATHURA_PLUGIN_CAPABILITY_THREAD_SAFE_TEXT) != 0) {
+    int threads = 1;
+    girara_setting_get(zathura->ui.session, "render-threads", &threads);
+    job->serialize = false;
+    job->number_of_threads = CLAMP(threads, 1, (int) MAX(job->number_of_positions, 1));
+  }
+
+  job->threads = g_malloc0_n(job->number_of_threads, sizeof(GThread*));
+  unsigned int created = 0;
+  for (unsigned int i = 0; i < job->number_of_threads; i++) {
+    g_atomic_int_inc(&job->running);
+    job->threads[i] = thread_new("search", search_worker, job);
+    if (job->threads[i] == NULL) {
+      g_atomic_int_add(&job->running, -1);
+    } else {
+      ++created;
+    }
+  }
+
+  if (created == 0) {
+    girara_error("could not create search thread");
+    search_job_free(job);
+    return false;
+  }
+
+  job->source = gdk_threads_add_timeout(SEARCH_UPDATE_INTERVAL, search_update, job);
+  zathura->sync.search = job;
+
+  girara_debug("searching %u of %u pages for '%s' with %u thread(s)",
+               job->number_of_positions, number_of_pages, input,
+               job->number_of_threads);
+
+  return true;
+}
+
+static gboolean
+search_delayed(gpointer data)
+{
+  search_request_t* request = data;
+  zathura_t* zathura = request->zathura;
+
+  /* the source is destroyed once this function returns */
+  zathura->sync.search_delay = 0;
+  search_start(zathura, request->input, request->direction);
+
+  return FALSE;
+}
+
+bool
+search_start_delayed(zathura_t* zathura, const char* input, int direction)
+{
+  if (zathura == NULL || zathura->document == NULL || input == NULL) {
+    return false;
+  }
+
+  if (zathura->sync.search_delay != 0) {
+    g_source_remove(zathura->sync.search_delay);
+  }
+
+  search_request_t* request = g_malloc0(sizeof(search_request_t));
+  request->zathura   = zathura;
+  request->input     = g_strdup(input);
+  request->direction = direction;
+
+  zathura->sync.search_delay = gdk_threads_add_timeout_full(G_PRIORITY_DEFAULT,
+      SEARCH_DELAY, search_delayed, request, (GDestroyNotify) search_request_free);
+
+  return true;
+}
+
+void
+search_cancel(zathura_t* zathura)
+{
+  if (zathura == NULL) {
+    return;
+  }
+
+  if (zathura->sync.search_delay != 0) {
+    g_source_remove(zathura->sync.search_delay);
+    zathura->sync.search_delay = 0;
+  }
+
+  if (zathura->sync.search == NULL) {
+    return;
+  }
+
+  search_job_t* job = zathura->sync.search;
+  zathura->sync.search = NULL;
+
+  girara_debug("discarding search for '%s'", job->input);
+  search_job_free(job);
+}
@@ -0,0 +1,52 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdbool.h>
+
+#include "zathura.h"
+
+/**
+ * Starts searching the document for the given text in the background. A
+ * search that is still running is cancelled. The results of each page are
+ * passed to its widget as soon as they are known; the first hit in search
+ * order, starting at the current page, is shown once all pages before it
+ * have been searched.
+ *
+ * Visible pages are searched first. If the text extends the text of the
+ * previous search, pages that are known not to contain the previous text are
+ * skipped.
+ *
+ * Pages are searched by several threads if the plugin declares
+ * ZATHURA_PLUGIN_CAPABILITY_THREAD_SAFE_TEXT. Otherwise a single thread
+ * searches them one after another while holding the render lock.
+ *
+ * @param zathura The zathura session
+ * @param input The text to search for
+ * @param direction The search direction (FORWARD or BACKWARD)
+ * @return true if the search has been started
+ */
+bool search_start(zathura_t* zathura, const char* input, int direction);
+
+/**
+ * Starts searching once no other search has been requested for a short time,
+ * so that a search is not started for every keystroke while typing
+ *
+ * @param zathura The zathura session
+ * @param input The text to search for
+ * @param direction The search direction (FORWARD or BACKWARD)
+ * @return true if the search has been scheduled
+ */
+bool search_start_delayed(zathura_t* zathura, const char* input, int direction);
+
+/**
+ * Cancels the running or scheduled search and waits for its threads. Results
+ * that have already been passed to the page widgets are kept, but the next
+ * search does not reuse them.
+ *
+ * @param zathura The zathura session
+ */
+void search_cancel(zathura_t* zathura);
+
+#endif // SEARCH_H
@@ -0,0 +1,260 @@
+/* See LICENSE file for license and copyright information */
+
+#include <math.h>
+#include <string.h>
+#include <glib/gi18n.h>
+#include <girara/session.h>
+#include <girara/utils.h>
+
+#include "glib-compat.h"
+#include "selection.h"
+#include "document.h"
+#include "page.h"
+#include "render.h"
+#include "text-index.h"
+
+/* interval in milliseconds in which the thread is checked */
+#define SELECTION_CHECK_INTERVAL 20
+/* number of selections whose texts are kept */
+#define SELECTION_CACHE_SIZE 16
+/* selections that differ by less points are considered equal */
+#define SELECTION_TOLERANCE 0.5
+
+/**
+ * The text of a recent selection
+ */
+typedef struct selection_text_s {
+  unsigned int page; /**< Index of the page */
+  zathura_rectangle_t rectangle; /**< The selection in page coordinates */
+  char* text; /**< The text of the selection */
+} selection_text_t;
+
+/**
+ * Text of a selection that is extracted in the background
+ */
+struct selection_job_s {
+  zathura_t* zathura; /**< Zathura object */
+  bool serialize; /**< Plugin requires calls to be serialized */
+  GThread* thread; /**< Thread that extracts the text */
+  guint timeout; /**< Source that checks whether the thread has finished */
+  gint done; /**< Set by the thread when it has finished */
+  zathura_page_t* page; /**< The page */
+  zathura_rectangle_t rectangle; /**< The selection in page coordinates */
+  char* text; /**< The text once it has been extracted */
+  bool pending; /**< Another selection has been made in the meantime */
+  zathura_page_t* next_page; /**< Page of the other selection */
+  zathura_rectangle_t next_rectangle; /**< The other selection */
+  GQueue texts; /**< Texts of recent selections, most recently used first */
+};
+
+static void
+selection_text_free(gpointer data)
+{
+  selection_text_t* entry = data;
+
+  g_free(entry->text);
+  g_free(entry);
+}
+
+static bool
+selection_rectangle_equal(zathura_rectangle_t a, zathura_rectangle_t b)
+{
+  return fabs(a.x1 - b.x1) < SELECTION_TOLERANCE && fabs(a.y1 - b.y1) < SELECTION_TOLERANCE
+    && fabs(a.x2 - b.x2) < SELECTION_TOLERANCE && fabs(a.y2 - b.y2) < SELECTION_TOLERANCE;
+}
+
+static selection_text_t*
+selection_cache_lookup(selection_job_t* job, unsigned int page,
+    zathura_rectangle_t rectangle)
+{
+  for (GList* iter = job->texts.head; iter != NULL; iter = g_list_next(iter)) {
+    selection_text_t* entry = iter->data;
+    if (entry->page == page && selection_rectangle_equal(entry->rectangle, rectangle) == true) {
+      g_queue_unlink(&job->texts, iter);
+      g_queue_push_head_link(&job->texts, iter);
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+static void
+selection_cache_add(selection_job_t* job, unsigned int page,
+    zathura_rectangle_t rectangle, const char* text)
+{
+  selection_text_t* entry = g_malloc0(sizeof(selection_text_t));
+  entry->page      = page;
+  entry->rectangle = rectangle;
+  entry->text      = g_strdup(text);
+  g_queue_push_head(&job->texts, entry);
+
+  while (g_queue_get_length(&job->texts) > SELECTION_CACHE_SIZE) {
+    selection_text_free(g_queue_pop_tail(&job->texts));
+  }
+}
+
+static void
+selection_set_clipboard(zathura_t* zathura, const char* text)
+{
+  if (text == NULL || strlen(text) == 0) {
+    return;
+  }
+
+  /* copy to clipboard */
+  gtk_clipboard_set_text(gtk_clipboard_get(GDK_SELECTION_PRIMARY), text, -1);
+
+  char* stripped_text = g_strdelimit(g_strdup(text), "\n\t\r\n", ' ');
+  girara_notify(zathura->ui.session, GIRARA_INFO, _("Copied selected text to clipboard: %s"), stripped_text);
+  g_free(stripped_text);
+}
+
+static gpointer
+selection_job_run(gpointer data)
+{
+  selection_job_t* job = data;
+  render_thread_t* render_thread = job->zathura->sync.render_thread;
+
+  if (job->serialize == true) {
+    render_lock(render_thread);
+  }
+  job->text = zathura_page_get_text(job->page, job->rectangle, NULL);
+  if (job->serialize == true) {
+    render_unlock(render_thread);
+  }
+
+  g_atomic_int_set(&job->done, 1);
+  return NULL;
+}
+
+static gboolean selection_job_check(gpointer data);
+
+static void
+selection_job_start(selection_job_t* job, zathura_page_t* page,
+    zathura_rectangle_t rectangle)
+{
+  job->page      = page;
+  job->rectangle = rectangle;
+  job->text      = NULL;
+  g_atomic_int_set(&job->done, 0);
+
+  job->thread = thread_new("selection", selection_job_run, job);
+  if (job->thread == NULL) {
+    /* the text is extracted right away */
+    selection_job_run(job);
+    selection_job_check(job);
+    return;
+  }
+
+  job->timeout = gdk_threads_add_timeout(SELECTION_CHECK_INTERVAL,
+      selection_job_check, job);
+}
+
+static gboolean
+selection_job_check(gpointer data)
+{
+  selection_job_t* job = data;
+  zathura_t* zathura   = job->zathura;
+
+  if (g_atomic_int_get(&job->done) == 0) {
+    return TRUE;
+  }
+
+  if (job->thread != NULL) {
+    g_thread_join(job->thread);
+    job->thread = NULL;
+  }
+  job->timeout = 0;
+
+  if (job->text != NULL) {
+    const unsigned int page_id = zathura_page_get_index(job->page);
+    selection_cache_add(job, page_id, job->rectangle, job->text);
+
+    /* the text of a whole page is indexed for searching as well */
+    if (job->rectangle.x1 <= 0 && job->rectangle.y1 <= 0
+        && job->rectangle.x2 >= zathura_page_get_width(job->page)
+        && job->rectangle.y2 >= zathura_page_get_height(job->page)) {
+      zathura_text_index_set_page(zathura->text_index, page_id, job->text);
+    }
+
+    /* the last selection is copied */
+    if (job->pending == false) {
+      selection_set_clipboard(zathura, job->text);
+    }
+
+    g_free(job->text);
+    job->text = NULL;
+  }
+
+  if (job->pending == true) {
+    job->pending = false;
+    selection_copy(zathura, job->next_page, job->next_rectangle);
+  }
+
+  return FALSE;
+}
+
+void
+selection_copy(zathura_t* zathura, zathura_page_t* page,
+    zathura_rectangle_t rectangle)
+{
+  if (zathura == NULL || zathura->document == NULL || page == NULL) {
+    return;
+  }
+
+  selection_job_t* job = zathura->sync.selection_job;
+  if (job == NULL) {
+    job = g_malloc0(sizeof(selection_job_t));
+    job->zathura = zathura;
+    g_queue_init(&job->texts);
+    zathura->sync.selection_job = job;
+  }
+
+  /* the text is extracted once the running job has finished */
+  if (job->timeout != 0) {
+    job->pending        = true;
+    job->next_page      = page;
+    job->next_rectangle = rectangle;
+    return;
+  }
+
+  const unsigned int page_id = zathura_page_get_index(page);
+  selection_text_t* entry = selection_cache_lookup(job, page_id, rectangle);
+  if (entry != NULL) {
+    selection_set_clipboard(zathura, entry->text);
+    return;
+  }
+
+  /* pages without any text do not have to be asked */
+  if (zathura_text_index_is_empty_page(zathura->text_index, page_id) == true) {
+    return;
+  }
+
+  job->serialize = render_is_serialized(zathura->sync.render_thread);
+  selection_job_start(job, page, rectangle);
+}
+
+void
+selection_cancel(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->sync.selection_job == NULL) {
+    return;
+  }
+
+  selection_job_t* job = zathura->sync.selection_job;
+  zathura->sync.selection_job = NULL;
+
+  if (job->timeout != 0) {
+    g_source_remove(job->timeout);
+  }
+  /* waits for the plugin to finish */
+  if (job->thread != NULL) {
+    g_thread_join(job->thread);
+  }
+
+  g_free(job->text);
+  while (g_queue_is_empty(&job->texts) == FALSE) {
+    selection_text_free(g_queue_pop_head(&job->texts));
+  }
+  g_free(job);
+}
@@ -0,0 +1,31 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef SELECTION_H
+#define SELECTION_H
+
+#include "zathura.h"
+#include "types.h"
+
+/**
+ * Copies the text of a selection to the primary clipboard. The text is
+ * extracted in the background, so that slow plugins do not block the user
+ * interface. Plugins that are not thread-safe are only called while the
+ * render lock is held. The texts of recent selections are kept, so that
+ * selecting the same text again does not call the plugin.
+ *
+ * @param zathura The zathura session
+ * @param page The page
+ * @param rectangle The selection in page coordinates
+ */
+void selection_copy(zathura_t* zathura, zathura_page_t* page,
+    zathura_rectangle_t rectangle);
+
+/**
+ * Cancels copying the selection, waits for the thread and forgets the texts
+ * of recent selections.
+ *
+ * @param zathura The zathura session
+ */
+void selection_cancel(zathura_t* zathura);
+
+#endif // SELECTION_H
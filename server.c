@@ -0,0 +1,737 @@
+/* See LICENSE file for license and copyright information */
+
+#define _BSD_SOURCE
+#define _XOPEN_SOURCE 700
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <gtk/gtk.h>
+#include <girara/utils.h>
+#include <girara/datastructures.h>
+#include <girara/session.h>
+#include <girara/settings.h>
+
+#include "server.h"
+#include "database.h"
+#include "document.h"
+#include "page-cache.h"
+#include "plugin.h"
+#include "surface-pool.h"
+#include "synctex.h"
+
+#define SERVER_SOCKET "zathura.socket"
+/* seconds a client waits for the answer of the server */
+#define SERVER_REPLY_TIMEOUT 2
+
+struct zathura_server_s {
+  char* socket_path; /**< Path of the socket */
+  int fd; /**< Listening socket */
+  guint source; /**< Source that accepts connections */
+  girara_list_t* sessions; /**< Open windows */
+  girara_list_t* closed; /**< Closed windows that have not been freed yet */
+  guint close_source; /**< Source that frees the closed windows */
+
+  void* plugin_manager; /**< Shared plugin manager */
+  zathura_database_t* database; /**< Shared database */
+  zathura_surface_pool_t* surface_pool; /**< Shared surface pool */
+  size_t cache_memory; /**< Budget of all page caches together in bytes */
+
+  gchar* config_dir; /**< Configuration directory of new windows */
+  gchar* data_dir; /**< Data directory of new windows */
+  gchar* synctex_editor; /**< Synctex editor of new windows */
+  bool synctex; /**< Synctex support of new windows */
+  size_t memory_limit; /**< Memory limit of new windows */
+  char** arguments; /**< Arguments zathura has been started with */
+};
+
+typedef struct server_client_s {
+  zathura_server_t* server; /**< The server */
+  GString* buffer; /**< Received data that does not form a line yet */
+} server_client_t;
+
+char*
+zathura_server_socket_path(void)
+{
+  return g_build_filename(g_get_user_runtime_dir(), SERVER_SOCKET, NULL);
+}
+
+char*
+zathura_server_request_format(const char* path, const char* password, int page_number)
+{
+  char* escaped_path     = g_strescape(path != NULL ? path : "", NULL);
+  char* escaped_password = g_strescape(password != NULL ? password : "", NULL);
+
+  char* request = g_strdup_printf("open\t%d\t%s\t%s\n", page_number,
+      escaped_password, escaped_path);
+
+  g_free(escaped_password);
+  g_free(escaped_path);
+
+  return request;
+}
+
+/* splits a request line into its fields; only the line break is stripped,
+ * since g_strescape keeps trailing spaces of the last field */
+static char**
+request_split(const char* line)
+{
+  size_t length = strlen(line);
+  if (length > 0 && line[length - 1] == '\n') {
+    --length;
+  }
+
+  char* request = g_strndup(line, length);
+  char** fields = g_strsplit(request, "\t", 0);
+  g_free(request);
+
+  return fields;
+}
+
+static char*
+request_field(const char* field)
+{
+  if (field[0] == '\0') {
+    return NULL;
+  }
+
+  return g_strcompress(field);
+}
+
+bool
+zathura_server_request_parse(const char* line, char** path, char** password, int* page_number)
+{
+  if (line == NULL || path == NULL || password == NULL || page_number == NULL) {
+    return false;
+  }
+
+  char** fields = request_split(line);
+
+  bool valid = false;
+  if (g_strv_length(fields) == 4 && g_strcmp0(fields[0], "open") == 0) {
+    char* end = NULL;
+    errno = 0;
+    const long value = strtol(fields[1], &end, 10);
+    if (errno == 0 && end != fields[1] && *end == '\0' && value >= INT_MIN && value <= INT_MAX) {
+      *page_number = value;
+      *password    = request_field(fields[2]);
+      *path        = request_field(fields[3]);
+      valid        = true;
+    }
+  }
+
+  g_strfreev(fields);
+  return valid;
+}
+
+char*
+zathura_server_synctex_request_format(const char* path, const char* position)
+{
+  char* escaped_path     = g_strescape(path != NULL ? path : "", NULL);
+  char* escaped_position = g_strescape(position != NULL ? position : "", NULL);
+
+  char* request = g_strdup_printf("synctex\t%s\t%s\n", escaped_position, escaped_path);
+
+  g_free(escaped_position);
+  g_free(escaped_path);
+
+  return request;
+}
+
+bool
+zathura_server_synctex_request_parse(const char* line, char** path, char** position)
+{
+  if (line == NULL || path == NULL || position == NULL) {
+    return false;
+  }
+
+  char** fields = request_split(line);
+
+  bool valid = false;
+  if (g_strv_length(fields) == 3 && g_strcmp0(fields[0], "synctex") == 0 &&
+      fields[1][0] != '\0' && fields[2][0] != '\0') {
+    *position = request_field(fields[1]);
+    *path     = request_field(fields[2]);
+    valid     = true;
+  }
+
+  g_strfreev(fields);
+  return valid;
+}
+
+static char*
+server_absolute_path(const char* file)
+{
+  if (g_path_is_absolute(file) == TRUE) {
+    return g_strdup(file);
+  }
+
+  char* cwd  = g_get_current_dir();
+  char* path = g_build_filename(cwd, file, NULL);
+  g_free(cwd);
+
+  return path;
+}
+
+static bool
+server_address(const char* socket_path, struct sockaddr_un* address)
+{
+  if (strlen(socket_path) >= sizeof(address->sun_path)) {
+    return false;
+  }
+
+  memset(address, 0, sizeof(struct sockaddr_un));
+  address->sun_family = AF_UNIX;
+  g_strlcpy(address->sun_path, socket_path, sizeof(address->sun_path));
+
+  return true;
+}
+
+static int
+server_connect(const char* socket_path)
+{
+  struct sockaddr_un address;
+  if (server_address(socket_path, &address) == false) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) {
+    return -1;
+  }
+
+  if (connect(fd, (struct sockaddr*) &address, sizeof(address)) == -1) {
+    const int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+  }
+
+  return fd;
+}
+
+/* sends the requests and returns the number of requests the server has
+ * answered with ok, or -1 if no server is listening; the answer to each of the
+ * count requests is stored in accepted if it is not NULL */
+static int
+server_send(const char* socket_path, GString* requests, bool* accepted_requests,
+    unsigned int count)
+{
+  int fd = server_connect(socket_path);
+  if (fd == -1) {
+    girara_debug("No server is listening on '%s': %s", socket_path, strerror(errno));
+    return -1;
+  }
+
+  struct timeval timeout = { SERVER_REPLY_TIMEOUT, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  bool written = true;
+  for (gsize offset = 0; offset < requests->len;) {
+    const ssize_t bytes = write(fd, requests->str + offset, requests->len - offset);
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes <= 0) {
+      girara_error("Could not send the request to the server: %s", strerror(errno));
+      written = false;
+      break;
+    }
+    offset += bytes;
+  }
+  shutdown(fd, SHUT_WR);
+
+  /* the server answers every request once the window has been created */
+  int accepted = 0;
+  GString* replies = g_string_new(NULL);
+  while (written == true) {
+    char buffer[256];
+    const ssize_t bytes = read(fd, buffer, sizeof(buffer));
+    if (bytes == -1 && errno == EINTR) {
+      continue;
+    } else if (bytes <= 0) {
+      break;
+    }
+    g_string_append_len(replies, buffer, bytes);
+  }
+  close(fd);
+
+  /* the requests are answered in order */
+  char** lines = g_strsplit(replies->str, "\n", 0);
+  for (unsigned int i = 0; lines[i] != NULL; i++) {
+    const bool ok = written == true && g_strcmp0(lines[i], "ok") == 0;
+    if (ok == true) {
+      ++accepted;
+    }
+    if (accepted_requests != NULL && i < count) {
+      accepted_requests[i] = ok;
+    }
+  }
+  g_strfreev(lines);
+  g_string_free(replies, TRUE);
+
+  return written == true ? accepted : 0;
+}
+
+bool
+zathura_server_forward(const char* socket_path, char** files, const char*
+    password, int page_number, char*** rejected)
+{
+  if (rejected != NULL) {
+    *rejected = NULL;
+  }
+
+  if (socket_path == NULL || files == NULL) {
+    return false;
+  }
+
+  /* the server cannot read the stdin of this process */
+  for (unsigned int i = 0; files[i] != NULL; i++) {
+    if (g_strcmp0(files[i], "-") == 0) {
+      return false;
+    }
+  }
+
+  /* without documents an empty window is opened */
+  const unsigned int count = MAX(g_strv_length(files), 1);
+  GString* requests = g_string_new(NULL);
+  for (unsigned int i = 0; i < count; i++) {
+    char* path = files[i] != NULL ? server_absolute_path(files[i]) : NULL;
+
+    char* request = zathura_server_request_format(path,
+        i == 0 ? password : NULL,
+        i == 0 ? page_number : ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+    g_string_append(requests, request);
+    g_free(request);
+    g_free(path);
+  }
+
+  bool* accepted_requests = g_malloc0_n(count, sizeof(bool));
+  const int accepted = server_send(socket_path, requests, accepted_requests, count);
+  g_string_free(requests, TRUE);
+
+  if (accepted >= 0 && (unsigned int) accepted != count) {
+    girara_error("The server has only opened %d of %u documents.", accepted, count);
+  }
+
+  /* only the documents the server has not opened are left to the caller */
+  if (accepted >= 0 && rejected != NULL) {
+    GPtrArray* list = g_ptr_array_new();
+    for (unsigned int i = 0; files[i] != NULL; i++) {
+      if (accepted_requests[i] == false) {
+        g_ptr_array_add(list, g_strdup(files[i]));
+      }
+    }
+    g_ptr_array_add(list, NULL);
+    *rejected = (char**) g_ptr_array_free(list, FALSE);
+  }
+  g_free(accepted_requests);
+
+  return accepted >= 0 && (unsigned int) accepted == count;
+}
+
+bool
+zathura_server_forward_synctex(const char* socket_path, const char* file, const char* position)
+{
+  if (socket_path == NULL || file == NULL || position == NULL || g_strcmp0(file, "-") == 0) {
+    return false;
+  }
+
+  /* relative source files are resolved against the current directory of the
+   * editor, not of the server */
+  char* input = NULL;
+  unsigned int line = 0;
+  int column = -1;
+  if (synctex_parse_position(position, &input, &line, &column) == false) {
+    return false;
+  }
+
+  char* absolute_input = server_absolute_path(input);
+  char* absolute_position = g_strdup_printf("%u:%d:%s", line, column, absolute_input);
+  char* path = server_absolute_path(file);
+
+  GString* requests = g_string_new(NULL);
+  char* request = zathura_server_synctex_request_format(path, absolute_position);
+  g_string_append(requests, request);
+  g_free(request);
+
+  const int accepted = server_send(socket_path, requests, NULL, 1);
+  g_string_free(requests, TRUE);
+
+  g_free(path);
+  g_free(absolute_position);
+  g_free(absolute_input);
+  g_free(input);
+
+  if (accepted == 0) {
+    girara_error("The server could not show the position in '%s'.", file);
+  }
+
+  return accepted == 1;
+}
+
+static void
+server_balance_caches(zathura_server_t* server)
+{
+  const size_t sessions = girara_list_size(server->sessions);
+  if (sessions == 0 || server->cache_memory == 0) {
+    return;
+  }
+
+  GIRARA_LIST_FOREACH(server->sessions, zathura_t*, iter, zathura)
+    size_t max_bytes = server->cache_memory / sessions;
+    if (zathura->memory.limit != 0) {
+      max_bytes = MIN(max_bytes, zathura->memory.limit / 2);
+    }
+    zathura_page_cache_set_max_bytes(zathura->page_cache, max_bytes);
+  GIRARA_LIST_FOREACH_END(server->sessions, zathura_t*, iter, zathura);
+}
+
+static gboolean
+server_free_closed(gpointer data)
+{
+  zathura_server_t* server = data;
+
+  server->close_source = 0;
+  while (girara_list_size(server->closed) > 0) {
+    zathura_t* zathura = girara_list_nth(server->closed, 0);
+    girara_list_remove(server->closed, zathura);
+    zathura_free(zathura);
+  }
+
+  return FALSE;
+}
+
+static void
+server_client_free(gpointer data)
+{
+  server_client_t* client = data;
+
+  g_string_free(client->buffer, TRUE);
+  g_free(client);
+}
+
+static void
+server_client_request(server_client_t* client, GIOChannel* channel, const char* line)
+{
+  char* path     = NULL;
+  char* password = NULL;
+  int page_number = ZATHURA_PAGE_NUMBER_UNSPECIFIED;
+
+  char* position  = NULL;
+
+  bool opened = false;
+  if (zathura_server_request_parse(line, &path, &password, &page_number) == true) {
+    girara_debug("Opening '%s' for a client.", path != NULL ? path : "");
+    opened = zathura_server_open(client->server, path, password, page_number);
+  } else if (zathura_server_synctex_request_parse(line, &path, &position) == true) {
+    girara_debug("Showing '%s' in '%s' for a client.", position, path);
+    opened = zathura_server_synctex(client->server, path, position);
+  } else {
+    girara_warning("Ignoring invalid request '%s'.", line);
+  }
+
+  const char* reply = opened == true ? "ok\n" : "error\n";
+  g_io_channel_write_chars(channel, reply, -1, NULL, NULL);
+  g_io_channel_flush(channel, NULL);
+
+  g_free(position);
+  g_free(password);
+  g_free(path);
+}
+
+static gboolean
+cb_server_client(GIOChannel* channel, GIOCondition condition, gpointer data)
+{
+  server_client_t* client = data;
+
+  if ((condition & G_IO_IN) == 0) {
+    return FALSE;
+  }
+
+  char buffer[4096];
+  gsize bytes = 0;
+  const GIOStatus status = g_io_channel_read_chars(channel, buffer,
+      sizeof(buffer), &bytes, NULL);
+  g_string_append_len(client->buffer, buffer, bytes);
+
+  gdk_threads_enter();
+  char* end = NULL;
+  while ((end = strchr(client->buffer->str, '\n')) != NULL) {
+    char* line = g_strndup(client->buffer->str, end - client->buffer->str);
+    g_string_erase(client->buffer, 0, end - client->buffer->str + 1);
+    server_client_request(client, channel, line);
+    g_free(line);
+  }
+  gdk_threads_leave();
+
+  return status == G_IO_STATUS_NORMAL || status == G_IO_STATUS_AGAIN;
+}
+
+static gboolean
+cb_server_accept(GIOChannel* UNUSED(channel), GIOCondition UNUSED(condition), gpointer data)
+{
+  zathura_server_t* server = data;
+
+  int fd = accept(server->fd, NULL, NULL);
+  if (fd == -1) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      girara_error("Could not accept a connection: %s", strerror(errno));
+    }
+    return TRUE;
+  }
+
+  GIOChannel* channel = g_io_channel_unix_new(fd);
+  g_io_channel_set_close_on_unref(channel, TRUE);
+  g_io_channel_set_encoding(channel, NULL, NULL);
+  g_io_channel_set_buffered(channel, FALSE);
+  g_io_channel_set_flags(channel, G_IO_FLAG_NONBLOCK, NULL);
+
+  server_client_t* client = g_malloc0(sizeof(server_client_t));
+  client->server = server;
+  client->buffer = g_string_new(NULL);
+
+  g_io_add_watch_full(channel, G_PRIORITY_DEFAULT, G_IO_IN | G_IO_HUP | G_IO_ERR,
+      cb_server_client, client, server_client_free);
+  g_io_channel_unref(channel);
+
+  return TRUE;
+}
+
+zathura_server_t*
+zathura_server_new(zathura_t* zathura, const char* socket_path)
+{
+  if (zathura == NULL || socket_path == NULL || zathura->server != NULL) {
+    return NULL;
+  }
+
+  struct sockaddr_un address;
+  if (server_address(socket_path, &address) == false) {
+    girara_error("The path of the socket '%s' is too long.", socket_path);
+    return NULL;
+  }
+
+  /* another instance may have started its server in the meantime; otherwise
+   * the socket is left over from a server that has not been stopped */
+  int other = server_connect(socket_path);
+  if (other != -1) {
+    close(other);
+    girara_warning("Another server is already listening on '%s'.", socket_path);
+    return NULL;
+  }
+  unlink(socket_path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) {
+    girara_error("Could not create a socket: %s", strerror(errno));
+    return NULL;
+  }
+
+  if (bind(fd, (struct sockaddr*) &address, sizeof(address)) == -1 || listen(fd, 8) == -1) {
+    girara_error("Could not listen on '%s': %s", socket_path, strerror(errno));
+    close(fd);
+    return NULL;
+  }
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+
+  zathura_server_t* server = g_malloc0(sizeof(zathura_server_t));
+
+  server->socket_path = g_strdup(socket_path);
+  server->fd          = fd;
+  server->sessions    = girara_list_new();
+  server->closed      = girara_list_new();
+
+  /* state shared by all windows */
+  server->plugin_manager = zathura->plugins.manager;
+  server->database       = zathura->database;
+  server->surface_pool   = zathura->surface_pool;
+
+  int cache_memory = 0;
+  girara_setting_get(zathura->ui.session, "page-cache-memory", &cache_memory);
+  if (cache_memory <= 0) {
+    cache_memory = ZATHURA_PAGE_CACHE_DEFAULT_MEMORY;
+  }
+  server->cache_memory = (size_t) cache_memory * 1024 * 1024;
+
+  /* configuration of new windows */
+  server->config_dir     = g_strdup(zathura->config.config_dir);
+  server->data_dir       = g_strdup(zathura->config.data_dir);
+  server->synctex_editor = g_strdup(zathura->synctex.editor);
+  server->memory_limit   = zathura->memory.limit;
+  server->arguments      = zathura->global.arguments;
+  girara_setting_get(zathura->ui.session, "synctex", &server->synctex);
+
+  zathura->server = server;
+  girara_list_append(server->sessions, zathura);
+
+  GIOChannel* channel = g_io_channel_unix_new(fd);
+  server->source = g_io_add_watch(channel, G_IO_IN, cb_server_accept, server);
+  g_io_channel_unref(channel);
+
+  girara_debug("Listening on '%s'.", socket_path);
+
+  return server;
+}
+
+void
+zathura_server_free(zathura_server_t* server)
+{
+  if (server == NULL) {
+    return;
+  }
+
+  if (server->source != 0) {
+    g_source_remove(server->source);
+  }
+  close(server->fd);
+  unlink(server->socket_path);
+
+  if (server->close_source != 0) {
+    g_source_remove(server->close_source);
+  }
+
+  /* windows are removed from the list first, so that destroying them does
+   * not close them a second time */
+  server_free_closed(server);
+  while (girara_list_size(server->sessions) > 0) {
+    zathura_t* zathura = girara_list_nth(server->sessions, 0);
+    girara_list_remove(server->sessions, zathura);
+    zathura_free(zathura);
+  }
+  girara_list_free(server->sessions);
+  girara_list_free(server->closed);
+
+  if (server->database != NULL) {
+    g_object_unref(G_OBJECT(server->database));
+  }
+  zathura_plugin_manager_free(server->plugin_manager);
+  zathura_surface_pool_free(server->surface_pool);
+
+  g_free(server->socket_path);
+  g_free(server->config_dir);
+  g_free(server->data_dir);
+  g_free(server->synctex_editor);
+  g_free(server);
+}
+
+bool
+zathura_server_open(zathura_server_t* server, const char* path, const char* password, int page_number)
+{
+  if (server == NULL) {
+    return false;
+  }
+
+  zathura_t* zathura = zathura_create();
+  if (zathura == NULL) {
+    return false;
+  }
+
+  /* zathura_init only creates what is not shared */
+  zathura_plugin_manager_free(zathura->plugins.manager);
+  zathura->plugins.manager = server->plugin_manager;
+  zathura->database        = server->database;
+  zathura->surface_pool    = server->surface_pool;
+  zathura->server          = server;
+
+  zathura_set_config_dir(zathura, server->config_dir);
+  zathura_set_data_dir(zathura, server->data_dir);
+  zathura_set_synctex_editor_command(zathura, server->synctex_editor);
+  zathura_set_argv(zathura, server->arguments);
+  zathura->memory.limit = server->memory_limit;
+
+  if (zathura_init(zathura) == false) {
+    girara_error("Could not initialize zathura.");
+    zathura_free(zathura);
+    return false;
+  }
+
+  zathura_set_synctex(zathura, server->synctex);
+
+  girara_list_append(server->sessions, zathura);
+  server_balance_caches(server);
+
+  if (path != NULL) {
+    document_open_idle(zathura, path, password, page_number);
+  }
+
+  return true;
+}
+
+void
+zathura_server_close(zathura_server_t* server, zathura_t* zathura)
+{
+  if (server == NULL || zathura == NULL ||
+      girara_list_contains(server->sessions, zathura) == false) {
+    return;
+  }
+
+  girara_list_remove(server->sessions, zathura);
+  girara_list_append(server->closed, zathura);
+  if (server->close_source == 0) {
+    server->close_source = gdk_threads_add_idle(server_free_closed, server);
+  }
+
+  if (girara_list_size(server->sessions) == 0) {
+    gtk_main_quit();
+  } else {
+    server_balance_caches(server);
+  }
+}
+
+/* finds the window that shows the document */
+static zathura_t*
+server_find_session(zathura_server_t* server, const char* path)
+{
+  char* real = realpath(path, NULL);
+  zathura_t* found = NULL;
+
+  GIRARA_LIST_FOREACH(server->sessions, zathura_t*, iter, zathura)
+    if (found != NULL || zathura->document == NULL) {
+      continue;
+    }
+
+    char* document = realpath(zathura_document_get_path(zathura->document), NULL);
+    if (g_strcmp0(document, real != NULL ? real : path) == 0) {
+      found = zathura;
+    }
+    free(document);
+  GIRARA_LIST_FOREACH_END(server->sessions, zathura_t*, iter, zathura);
+
+  free(real);
+  return found;
+}
+
+bool
+zathura_server_synctex(zathura_server_t* server, const char* path, const char* position)
+{
+  if (server == NULL || path == NULL || position == NULL) {
+    return false;
+  }
+
+  /* the document stays open while it is edited, so its index is only read
+   * once and every further position is looked up in memory */
+  zathura_t* zathura = server_find_session(server, path);
+  if (zathura != NULL) {
+    synctex_view(zathura, position);
+    gtk_window_present(GTK_WINDOW(zathura->ui.session->gtk.window));
+    return true;
+  }
+
+  if (zathura_server_open(server, path, NULL, ZATHURA_PAGE_NUMBER_UNSPECIFIED) == false) {
+    return false;
+  }
+
+  zathura = girara_list_nth(server->sessions, girara_list_size(server->sessions) - 1);
+  zathura_set_synctex_forward(zathura, position);
+
+  return true;
+}
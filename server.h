@@ -0,0 +1,151 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdbool.h>
+
+#include "zathura.h"
+
+/**
+ * Returns the path of the socket the server listens on. It is located in the
+ * runtime directory of the user.
+ *
+ * @return The path (free with g_free)
+ */
+char* zathura_server_socket_path(void);
+
+/**
+ * Formats a request to open a document. The fields are escaped, so that paths
+ * and passwords may contain any character.
+ *
+ * @param path The path of the document (NULL for an empty window)
+ * @param password The password of the document or NULL
+ * @param page_number The page number or ZATHURA_PAGE_NUMBER_UNSPECIFIED
+ * @return The request including the line break (free with g_free)
+ */
+char* zathura_server_request_format(const char* path, const char* password,
+    int page_number);
+
+/**
+ * Parses a request formatted by zathura_server_request_format.
+ *
+ * @param line The request with or without the line break
+ * @param path Will be set to the path (NULL if there is none, free with
+ *   g_free)
+ * @param password Will be set to the password (NULL if there is none, free
+ *   with g_free)
+ * @param page_number Will be set to the page number
+ * @return true if the request is valid
+ */
+bool zathura_server_request_parse(const char* line, char** path,
+    char** password, int* page_number);
+
+/**
+ * Formats a request to show a position in the source of a document (forward
+ * search).
+ *
+ * @param path The path of the document
+ * @param position The position in the format line:column:input
+ * @return The request including the line break (free with g_free)
+ */
+char* zathura_server_synctex_request_format(const char* path, const char* position);
+
+/**
+ * Parses a request formatted by zathura_server_synctex_request_format.
+ *
+ * @param line The request with or without the line break
+ * @param path Will be set to the path (free with g_free)
+ * @param position Will be set to the position (free with g_free)
+ * @return true if the request is valid
+ */
+bool zathura_server_synctex_request_parse(const char* line, char** path,
+    char** position);
+
+/**
+ * Asks a running server to open the documents. Relative paths are resolved
+ * against the current directory. The password and the page number apply to
+ * the first document only. Documents read from stdin are never forwarded.
+ *
+ * @param socket_path The socket of the server
+ * @param files NULL terminated list of documents (an empty window is opened
+ *   if it is empty)
+ * @param password The password of the first document or NULL
+ * @param page_number The page number of the first document
+ * @param rejected If not NULL, set to the NULL terminated list of the
+ *   documents the server has not opened if a server has answered, or to NULL
+ *   otherwise (free with g_strfreev)
+ * @return true if the server has accepted every document
+ */
+bool zathura_server_forward(const char* socket_path, char** files,
+    const char* password, int page_number, char*** rejected);
+
+/**
+ * Asks a running server to show a position in the source of a document. The
+ * window that shows the document is reused, so that its SyncTeX index does not
+ * have to be read again. Relative paths are resolved against the current
+ * directory.
+ *
+ * @param socket_path The socket of the server
+ * @param file The document
+ * @param position The position in the format line:column:input
+ * @return true if the server has shown the position
+ */
+bool zathura_server_forward_synctex(const char* socket_path, const char* file,
+    const char* position);
+
+/**
+ * Starts a server for an initialized session. The server takes over the
+ * plugin manager, the database and the surface pool of the session and shares
+ * them with every window it opens. The page caches of all windows share the
+ * budget of page-cache-memory. Once the last window has been closed, the main
+ * loop is quit.
+ *
+ * @param zathura The zathura session
+ * @param socket_path The socket to listen on
+ * @return The server or NULL if another server is listening or the socket
+ *   could not be created
+ */
+zathura_server_t* zathura_server_new(zathura_t* zathura, const char* socket_path);
+
+/**
+ * Stops the server and frees all of its windows and the shared state.
+ *
+ * @param server The server
+ */
+void zathura_server_free(zathura_server_t* server);
+
+/**
+ * Opens a document in a new window of the server.
+ *
+ * @param server The server
+ * @param path The path of the document (NULL for an empty window)
+ * @param password The password of the document or NULL
+ * @param page_number The page number or ZATHURA_PAGE_NUMBER_UNSPECIFIED
+ * @return true if the window has been created
+ */
+bool zathura_server_open(zathura_server_t* server, const char* path,
+    const char* password, int page_number);
+
+/**
+ * Closes a window of the server. The session is freed once the main loop is
+ * idle again.
+ *
+ * @param server The server
+ * @param zathura The session of the window
+ */
+void zathura_server_close(zathura_server_t* server, zathura_t* zathura);
+
+/**
+ * Shows a position in the source of a document in the window that shows the
+ * document. If there is none, the document is opened in a new window.
+ *
+ * @param server The server
+ * @param path The path of the document
+ * @param position The position in the format line:column:input
+ * @return true if the position is shown or the window has been created
+ */
+bool zathura_server_synctex(zathura_server_t* server, const char* path,
+    const char* position);
+
+#endif // SERVER_H
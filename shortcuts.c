@@ -11,6 +11,7 @@
 #include "callbacks.h"
 #include "shortcuts.h"
 #include "document.h"
+#include "document-index.h"
 #include "zathura.h"
 #include "render.h"
 #include "utils.h"
@@ -18,6 +19,10 @@
 #include "print.h"
 #include "page-widget.h"
 #include "adjustment.h"
+#include "prefetch.h"
+#include "scroll.h"
+#include "tabs.h"
+#include "bookmarks.h"
 
 /* Helper function; see sc_display_link and sc_follow. */
 static bool
@@ -364,10 +369,12 @@ sc_mouse_scroll(girara_session_t* session, girara_argument_t* argument, girara_e
     case GIRARA_EVENT_BUTTON_PRESS:
       x = event->x;
       y = event->y;
+      scroll_drag_begin(zathura);
       break;
     case GIRARA_EVENT_BUTTON_RELEASE:
       x = 0;
       y = 0;
+      scroll_drag_end(zathura);
       break;
     case GIRARA_EVENT_MOTION_NOTIFY:
       x_adj = gtk_scrolled_window_get_hadjustment(GTK_SCROLLED_WINDOW(session->gtk.view));
@@ -381,6 +388,7 @@ sc_mouse_scroll(girara_session_t* session, girara_argument_t* argument, girara_e
           gtk_adjustment_get_value(x_adj) - (event->x - x));
       zathura_adjustment_set_value(y_adj,
           gtk_adjustment_get_value(y_adj) - (event->y - y));
+      scroll_drag_motion(zathura);
       break;
 
       /* unhandled events */
@@ -462,6 +470,12 @@ sc_navigate(girara_session_t* session, girara_argument_t* argument,
     return false;
   }
 
+  /* measure how long it takes to show the next slide */
+  if (zathura->presentation.active == true) {
+    zathura->presentation.flip_start = g_get_monotonic_time();
+    zathura->presentation.flip_page  = new_page;
+  }
+
   page_set(zathura, new_page);
 
   /* adjust horizontal position */
@@ -515,13 +529,8 @@ sc_reload(girara_session_t* session, girara_argument_t* UNUSED(argument),
     return false;
   }
 
-  /* close current document */
-  document_close(zathura, true);
-
-  /* reopen document */
-  document_open(zathura, zathura->file_monitor.file_path,
-                zathura->file_monitor.password,
-                ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+  /* reload document, reusing the widgets if possible */
+  document_reload(zathura);
 
   return false;
 }
@@ -548,11 +557,17 @@ sc_rotate(girara_session_t* session, girara_argument_t* argument,
   zathura_document_set_rotation(zathura->document, (rotation + angle * t) % 360);
 
   /* update scale */
+  const double scale = zathura_document_get_scale(zathura->document);
   girara_argument_t new_argument = { zathura_document_get_adjust_mode(zathura->document), NULL };
   sc_adjust_window(zathura->ui.session, &new_argument, NULL, 0);
 
-  /* render all pages again */
-  render_all(zathura);
+  /* the rendered pages are rotated while painting, so they only have to be
+   * rendered again if the scale has changed */
+  if (zathura_document_get_scale(zathura->document) == scale) {
+    render_relayout(zathura);
+  } else {
+    render_all(zathura);
+  }
 
   page_set_delayed(zathura, page_number);
 
@@ -584,7 +599,8 @@ sc_scroll(girara_session_t* session, girara_argument_t* argument,
   }
 
   gdouble view_size                  = gtk_adjustment_get_page_size(adjustment);
-  gdouble value                      = gtk_adjustment_get_value(adjustment);
+  /* steps taken while the view is moving add up */
+  gdouble value                      = scroll_get_destination(zathura, adjustment);
   gdouble max                        = gtk_adjustment_get_upper(adjustment) - view_size;
   zathura->global.update_page_number = true;
 
@@ -706,7 +722,7 @@ sc_scroll(girara_session_t* session, girara_argument_t* argument,
     }
   }
 
-  zathura_adjustment_set_value(adjustment, new_value);
+  scroll_to(zathura, adjustment, new_value);
 
   return false;
 }
@@ -1071,6 +1087,61 @@ sc_navigate_index(girara_session_t* session, girara_argument_t* argument,
   return false;
 }
 
+bool
+sc_switch_tab(girara_session_t* session, girara_argument_t* argument,
+    girara_event_t* UNUSED(event), unsigned int t)
+{
+  g_return_val_if_fail(session != NULL, false);
+  g_return_val_if_fail(session->global.data != NULL, false);
+  zathura_t* zathura = session->global.data;
+  g_return_val_if_fail(argument != NULL, false);
+
+  const int offset = (t == 0) ? 1 : t;
+  if (argument->n == PREVIOUS) {
+    return tab_switch(zathura, -offset);
+  }
+
+  return tab_switch(zathura, offset);
+}
+
+bool
+sc_navigate_bookmarks(girara_session_t* session, girara_argument_t* argument,
+    girara_event_t* UNUSED(event), unsigned int t)
+{
+  g_return_val_if_fail(session != NULL, false);
+  g_return_val_if_fail(session->global.data != NULL, false);
+  zathura_t* zathura = session->global.data;
+  g_return_val_if_fail(argument != NULL, false);
+  if (zathura->document == NULL) {
+    return false;
+  }
+
+  const bool forward = argument->n != PREVIOUS;
+  unsigned int page  = zathura_document_get_current_page_number(zathura->document) + 1;
+
+  zathura_bookmark_t* bookmark = NULL;
+  for (unsigned int i = 0; i < MAX(t, 1); i++) {
+    zathura_bookmark_t* next = zathura_bookmark_find(zathura, page, forward);
+    if (next == NULL) {
+      break;
+    }
+    bookmark = next;
+    page     = bookmark->page;
+  }
+
+  if (bookmark == NULL) {
+    girara_notify(session, GIRARA_INFO, forward == true ? _("No next bookmark.") :
+        _("No previous bookmark."));
+    return false;
+  }
+
+  zathura_jumplist_save(zathura);
+  page_set(zathura, bookmark->page - 1);
+  zathura_jumplist_add(zathura);
+
+  return false;
+}
+
 bool
 sc_toggle_index(girara_session_t* session, girara_argument_t* UNUSED(argument),
                 girara_event_t* UNUSED(event), unsigned int UNUSED(t))
@@ -1089,24 +1160,33 @@ sc_toggle_index(girara_session_t* session, girara_argument_t* UNUSED(argument),
   GtkCellRenderer* renderer2         = NULL;
 
   if (zathura->ui.index == NULL) {
+    /* the index is generated in the background after the document has been
+     * opened; it is shown once it is available */
+    bool pending = false;
+    document_index = document_index_take(zathura, &pending);
+    if (pending == true) {
+      girara_notify(session, GIRARA_INFO, _("Loading index..."));
+      goto error_ret;
+    }
+
     /* create new index widget */
     zathura->ui.index = gtk_scrolled_window_new(NULL, NULL);
 
     if (zathura->ui.index == NULL) {
-      goto error_ret;
+      goto error_free;
     }
 
     gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(zathura->ui.index),
                                    GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
 
-    /* create index */
-    document_index = zathura_document_index_generate(zathura->document, NULL);
     if (document_index == NULL) {
       girara_notify(session, GIRARA_WARNING, _("This document does not contain any index"));
       goto error_free;
     }
 
-    model = GTK_TREE_MODEL(gtk_tree_store_new(3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_POINTER));
+    /* the model owns the index from now on */
+    model = document_index_model_new(document_index);
+    document_index = NULL;
     if (model == NULL) {
       goto error_free;
     }
@@ -1128,9 +1208,6 @@ sc_toggle_index(girara_session_t* session, girara_argument_t* UNUSED(argument),
       goto error_free;
     }
 
-    document_index_build(model, NULL, document_index);
-    girara_node_free(document_index);
-
     /* setup widget */
     gtk_tree_view_insert_column_with_attributes(GTK_TREE_VIEW (treeview), 0, "Title", renderer, "markup", 0, NULL);
     gtk_tree_view_insert_column_with_attributes(GTK_TREE_VIEW (treeview), 1, "Target", renderer2, "text", 1, NULL);
@@ -1141,6 +1218,7 @@ sc_toggle_index(girara_session_t* session, girara_argument_t* UNUSED(argument),
     gtk_tree_view_column_set_alignment(gtk_tree_view_get_column(GTK_TREE_VIEW(treeview), 1), 1.0f);
     gtk_tree_view_set_cursor(GTK_TREE_VIEW(treeview), gtk_tree_path_new_first(), NULL, FALSE);
     g_signal_connect(G_OBJECT(treeview), "row-activated", G_CALLBACK(cb_index_row_activated), zathura);
+    g_signal_connect(G_OBJECT(treeview), "test-expand-row", G_CALLBACK(cb_index_row_test_expand), NULL);
 
     gtk_container_add(GTK_CONTAINER(zathura->ui.index), treeview);
     gtk_widget_show(treeview);
@@ -1181,9 +1259,7 @@ error_free:
     zathura->ui.index = NULL;
   }
 
-  if (document_index != NULL) {
-    girara_node_free(document_index);
-  }
+  document_index_free(document_index);
 
 error_ret:
 
@@ -1259,6 +1335,9 @@ sc_toggle_fullscreen(girara_session_t* session, girara_argument_t*
     render_all(zathura);
     page_set_delayed(zathura, zathura_document_get_current_page_number(zathura->document));
 
+    /* release the slides */
+    prefetch_set_presentation(zathura, false);
+
     /* set mode */
     girara_mode_set(session, zathura->modes.normal);
   } else {
@@ -1287,6 +1366,9 @@ sc_toggle_fullscreen(girara_session_t* session, girara_argument_t*
     gtk_window_fullscreen(GTK_WINDOW(session->gtk.window));
     page_set_delayed(zathura, zathura_document_get_current_page_number(zathura->document));
 
+    /* keep the current, next and previous slides rendered */
+    prefetch_set_presentation(zathura, true);
+
     /* set mode */
     girara_mode_set(session, zathura->modes.fullscreen);
   }
@@ -1296,16 +1378,86 @@ sc_toggle_fullscreen(girara_session_t* session, girara_argument_t*
   return false;
 }
 
+bool
+sc_toggle_overview(girara_session_t* session, girara_argument_t*
+                   UNUSED(argument), girara_event_t* UNUSED(event), unsigned int UNUSED(t))
+{
+  g_return_val_if_fail(session != NULL, false);
+  g_return_val_if_fail(session->global.data != NULL, false);
+  zathura_t* zathura = session->global.data;
+
+  if (zathura->document == NULL) {
+    girara_notify(session, GIRARA_WARNING, _("No document opened."));
+    return false;
+  }
+
+  const unsigned int thumbnail_size = render_get_thumbnail_size(zathura->sync.render_thread);
+  if (thumbnail_size == 0) {
+    girara_notify(session, GIRARA_WARNING, _("Thumbnails are disabled."));
+    return false;
+  }
+
+  static bool overview = false;
+  static int pages_per_row = 1;
+  static int first_page_column = 1;
+  static double zoom = 1.0;
+  static zathura_adjust_mode_t adjust_mode = ZATHURA_ADJUST_NONE;
+
+  if (overview == true) {
+    girara_setting_set(session, "pages-per-row", &pages_per_row);
+    girara_setting_set(session, "first-page-column", &first_page_column);
+
+    zathura_document_set_adjust_mode(zathura->document, adjust_mode);
+    zathura_document_set_scale(zathura->document, zoom);
+  } else {
+    girara_setting_get(session, "pages-per-row", &pages_per_row);
+    girara_setting_get(session, "first-page-column", &first_page_column);
+    adjust_mode = zathura_document_get_adjust_mode(zathura->document);
+    zoom        = zathura_document_get_scale(zathura->document);
+
+    /* the largest page is shown at the size of a thumbnail */
+    unsigned int cell_height = 0;
+    unsigned int cell_width  = 0;
+    zathura_document_get_cell_size(zathura->document, &cell_height, &cell_width);
+    if (cell_height == 0 || cell_width == 0) {
+      return false;
+    }
+
+    const double scale = zoom * thumbnail_size / MAX(cell_height, cell_width);
+    zathura_document_set_adjust_mode(zathura->document, ZATHURA_ADJUST_NONE);
+    zathura_document_set_scale(zathura->document, scale);
+
+    /* fill the width of the view with pages */
+    int padding = 1;
+    girara_setting_get(session, "page-padding", &padding);
+    GtkAdjustment* hadjustment = gtk_scrolled_window_get_hadjustment(GTK_SCROLLED_WINDOW(session->gtk.view));
+    const double column_width = cell_width * scale / zoom + padding;
+    int columns = gtk_adjustment_get_page_size(hadjustment) / column_width;
+    columns = MAX(columns, 1);
+    int column = 1;
+    girara_setting_set(session, "pages-per-row", &columns);
+    girara_setting_set(session, "first-page-column", &column);
+  }
+
+  render_all(zathura);
+  page_set_delayed(zathura, zathura_document_get_current_page_number(zathura->document));
+
+  overview = overview ? false : true;
+
+  return false;
+}
+
 bool
 sc_quit(girara_session_t* session, girara_argument_t* UNUSED(argument),
         girara_event_t* UNUSED(event), unsigned int UNUSED(t))
 {
   g_return_val_if_fail(session != NULL, false);
+  zathura_t* zathura = session->global.data;
 
   girara_argument_t arg = { GIRARA_HIDE, NULL };
   girara_isc_completion(session, &arg, NULL, 0);
 
-  cb_destroy(NULL, NULL);
+  cb_destroy(NULL, zathura);
 
   return false;
 }
@@ -1361,7 +1513,10 @@ sc_zoom(girara_session_t* session, girara_argument_t* argument, girara_event_t*
     zathura_document_set_scale(zathura->document, zoom_max);
   }
 
-  render_all(zathura);
+  /* render once the zoom gesture has settled */
+  int render_delay = 0;
+  girara_setting_get(session, "zoom-render-delay", &render_delay);
+  render_all_deferred(zathura, render_delay > 0 ? render_delay : 0);
 
   return false;
 }
@@ -0,0 +1,268 @@
+/* See LICENSE file for license and copyright information */
+
+#include "glib-compat.h"
+#include "macros.h"
+#include "stats.h"
+
+struct zathura_stats_s {
+  zathura_stat_value_t values[ZATHURA_STAT_N]; /**< The measured durations */
+  unsigned int counters[ZATHURA_COUNTER_N]; /**< The counted events */
+  unsigned int queue_depth; /**< Last recorded number of queued jobs */
+  unsigned int max_queue_depth; /**< Largest recorded number of queued jobs */
+  mutex lock; /**< Lock */
+};
+
+static const char* stat_names[ZATHURA_STAT_N] = {
+  [ZATHURA_STAT_QUEUE_DELAY] = "queue-delay",
+  [ZATHURA_STAT_RENDER]      = "render",
+  [ZATHURA_STAT_RECOLOR]     = "recolor",
+  [ZATHURA_STAT_HANDOFF]     = "handoff",
+  [ZATHURA_STAT_SCROLL]      = "scroll",
+  [ZATHURA_STAT_FLIP]        = "flip"
+};
+
+zathura_stats_t*
+zathura_stats_new(void)
+{
+  zathura_stats_t* stats = g_malloc0(sizeof(zathura_stats_t));
+  mutex_init(&stats->lock);
+
+  return stats;
+}
+
+void
+zathura_stats_free(zathura_stats_t* stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+
+  mutex_free(&stats->lock);
+  g_free(stats);
+}
+
+void
+zathura_stats_add(zathura_stats_t* stats, zathura_stat_t stat, gint64 duration)
+{
+  if (stats == NULL || stat >= ZATHURA_STAT_N) {
+    return;
+  }
+
+  mutex_lock(&stats->lock);
+  zathura_stat_value_t* value = &stats->values[stat];
+  ++value->count;
+  value->total += duration;
+  value->max = MAX(value->max, duration);
+  mutex_unlock(&stats->lock);
+}
+
+void
+zathura_stats_count(zathura_stats_t* stats, zathura_counter_t counter)
+{
+  if (stats == NULL || counter >= ZATHURA_COUNTER_N) {
+    return;
+  }
+
+  mutex_lock(&stats->lock);
+  ++stats->counters[counter];
+  mutex_unlock(&stats->lock);
+}
+
+void
+zathura_stats_set_queue_depth(zathura_stats_t* stats, unsigned int depth)
+{
+  if (stats == NULL) {
+    return;
+  }
+
+  mutex_lock(&stats->lock);
+  stats->queue_depth     = depth;
+  stats->max_queue_depth = MAX(stats->max_queue_depth, depth);
+  mutex_unlock(&stats->lock);
+}
+
+void
+zathura_stats_get(zathura_stats_t* stats, zathura_stat_t stat,
+    zathura_stat_value_t* value)
+{
+  if (value == NULL) {
+    return;
+  }
+
+  if (stats == NULL || stat >= ZATHURA_STAT_N) {
+    value->count = 0;
+    value->total = 0;
+    value->max   = 0;
+    return;
+  }
+
+  mutex_lock(&stats->lock);
+  *value = stats->values[stat];
+  mutex_unlock(&stats->lock);
+}
+
+unsigned int
+zathura_stats_get_count(zathura_stats_t* stats, zathura_counter_t counter)
+{
+  if (stats == NULL || counter >= ZATHURA_COUNTER_N) {
+    return 0;
+  }
+
+  mutex_lock(&stats->lock);
+  const unsigned int count = stats->counters[counter];
+  mutex_unlock(&stats->lock);
+
+  return count;
+}
+
+void
+zathura_stats_get_queue_depth(zathura_stats_t* stats, unsigned int* current,
+    unsigned int* max)
+{
+  unsigned int depth     = 0;
+  unsigned int max_depth = 0;
+  if (stats != NULL) {
+    mutex_lock(&stats->lock);
+    depth     = stats->queue_depth;
+    max_depth = stats->max_queue_depth;
+    mutex_unlock(&stats->lock);
+  }
+
+  if (current != NULL) {
+    *current = depth;
+  }
+  if (max != NULL) {
+    *max = max_depth;
+  }
+}
+
+void
+zathura_stats_reset(zathura_stats_t* stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+
+  mutex_lock(&stats->lock);
+  for (unsigned int i = 0; i < ZATHURA_STAT_N; i++) {
+    stats->values[i].count = 0;
+    stats->values[i].total = 0;
+    stats->values[i].max   = 0;
+  }
+  for (unsigned int i = 0; i < ZATHURA_COUNTER_N; i++) {
+    stats->counters[i] = 0;
+  }
+  stats->queue_depth     = 0;
+  stats->max_queue_depth = 0;
+  mutex_unlock(&stats->lock);
+}
+
+const char*
+zathura_stats_get_name(zathura_stat_t stat)
+{
+  if (stat >= ZATHURA_STAT_N) {
+    return NULL;
+  }
+
+  return stat_names[stat];
+}
+
+static double
+stats_hit_rate(const zathura_page_cache_statistics_t* cache)
+{
+  const unsigned int lookups = cache->hits + cache->misses;
+  return lookups > 0 ? 100.0 * cache->hits / lookups : 0.0;
+}
+
+char*
+zathura_stats_to_string(zathura_stats_t* stats, const
+    zathura_page_cache_statistics_t* cache, const
+    zathura_surface_pool_statistics_t* pool)
+{
+  GString* string = g_string_new(NULL);
+
+  for (unsigned int i = 0; i < ZATHURA_STAT_N; i++) {
+    zathura_stat_value_t value;
+    zathura_stats_get(stats, i, &value);
+
+    const double average = value.count > 0 ? (double) value.total / value.count / 1000 : 0.0;
+    g_string_append_printf(string, "%s: %u, avg %.2f ms, max %.2f ms\n",
+        stat_names[i], value.count, average, value.max / 1000.0);
+  }
+
+  unsigned int depth     = 0;
+  unsigned int max_depth = 0;
+  zathura_stats_get_queue_depth(stats, &depth, &max_depth);
+  g_string_append_printf(string, "queue-depth: %u, max %u", depth, max_depth);
+  g_string_append_printf(string, "\nsurfaces: %u kept, %u invalidated, %u uploaded",
+      zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_KEPT),
+      zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_INVALIDATED),
+      zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_UPLOADED));
+
+  if (cache != NULL) {
+    g_string_append_printf(string, "\ncache: %.1f%% hits (%u of %u), %u entries, %"
+        G_GSIZE_FORMAT " of %" G_GSIZE_FORMAT " KiB, %u evictions",
+        stats_hit_rate(cache), cache->hits, cache->hits + cache->misses,
+        cache->entries, cache->bytes / 1024, cache->max_bytes / 1024,
+        cache->evictions);
+  }
+
+  if (pool != NULL) {
+    g_string_append_printf(string, "\nsurface-pool: %u reused, %u allocated, "
+        "%u dropped, %u buffers, %" G_GSIZE_FORMAT " of %" G_GSIZE_FORMAT " KiB",
+        pool->reused, pool->allocated, pool->dropped, pool->buffers,
+        pool->bytes / 1024, pool->max_bytes / 1024);
+  }
+
+  return g_string_free(string, FALSE);
+}
+
+char*
+zathura_stats_to_json(zathura_stats_t* stats, const
+    zathura_page_cache_statistics_t* cache, const
+    zathura_surface_pool_statistics_t* pool)
+{
+  GString* string = g_string_new("{");
+
+  for (unsigned int i = 0; i < ZATHURA_STAT_N; i++) {
+    zathura_stat_value_t value;
+    zathura_stats_get(stats, i, &value);
+
+    g_string_append_printf(string, "\"%s\": {\"count\": %u, \"total_us\": %"
+        G_GINT64_FORMAT ", \"max_us\": %" G_GINT64_FORMAT "}, ", stat_names[i],
+        value.count, value.total, value.max);
+  }
+
+  unsigned int depth     = 0;
+  unsigned int max_depth = 0;
+  zathura_stats_get_queue_depth(stats, &depth, &max_depth);
+  g_string_append_printf(string, "\"queue_depth\": {\"current\": %u, \"max\": %u}",
+      depth, max_depth);
+  g_string_append_printf(string, ", \"surfaces\": {\"kept\": %u, \"invalidated\": %u, "
+      "\"uploaded\": %u}",
+      zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_KEPT),
+      zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_INVALIDATED),
+      zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_UPLOADED));
+
+  if (cache != NULL) {
+    char rate[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_formatd(rate, sizeof(rate), "%.4f", stats_hit_rate(cache) / 100);
+    g_string_append_printf(string, ", \"cache\": {\"hits\": %u, \"misses\": %u, "
+        "\"hit_rate\": %s, \"entries\": %u, \"bytes\": %" G_GSIZE_FORMAT
+        ", \"max_bytes\": %" G_GSIZE_FORMAT ", \"evictions\": %u}",
+        cache->hits, cache->misses, rate, cache->entries, cache->bytes,
+        cache->max_bytes, cache->evictions);
+  }
+
+  if (pool != NULL) {
+    g_string_append_printf(string, ", \"surface_pool\": {\"reused\": %u, "
+        "\"allocated\": %u, \"dropped\": %u, \"buffers\": %u, \"bytes\": %"
+        G_GSIZE_FORMAT ", \"max_bytes\": %" G_GSIZE_FORMAT "}", pool->reused,
+        pool->allocated, pool->dropped, pool->buffers, pool->bytes,
+        pool->max_bytes);
+  }
+
+  g_string_append_c(string, '}');
+
+  return g_string_free(string, FALSE);
+}
@@ -0,0 +1,153 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+#include "page-cache.h"
+#include "surface-pool.h"
+
+typedef struct zathura_stats_s zathura_stats_t;
+
+/**
+ * The measured durations
+ */
+typedef enum zathura_stat_e {
+  ZATHURA_STAT_QUEUE_DELAY, /**< From queueing a render job to its start */
+  ZATHURA_STAT_RENDER, /**< Rendering by the plugin */
+  ZATHURA_STAT_RECOLOR, /**< Recoloring a rendered surface */
+  ZATHURA_STAT_HANDOFF, /**< Passing a surface to the widget */
+  ZATHURA_STAT_SCROLL, /**< Handling a change of the view */
+  ZATHURA_STAT_FLIP, /**< From changing the slide in presentation mode to showing it */
+  ZATHURA_STAT_N /**< Number of measured durations */
+} zathura_stat_t;
+
+/**
+ * The counted events
+ */
+typedef enum zathura_counter_e {
+  ZATHURA_COUNTER_SURFACE_KEPT, /**< A new allocation kept the rendered page */
+  ZATHURA_COUNTER_SURFACE_INVALIDATED, /**< A new allocation discarded the rendered page */
+  ZATHURA_COUNTER_SURFACE_UPLOADED, /**< A rendered page has been copied to the display server */
+  ZATHURA_COUNTER_N /**< Number of counted events */
+} zathura_counter_t;
+
+/**
+ * Summary of a measured duration
+ */
+typedef struct zathura_stat_value_s {
+  unsigned int count; /**< Number of measurements */
+  gint64 total; /**< Sum of the measurements in microseconds */
+  gint64 max; /**< Longest measurement in microseconds */
+} zathura_stat_value_t;
+
+/**
+ * Creates a new set of statistics
+ *
+ * @return The statistics
+ */
+zathura_stats_t* zathura_stats_new(void);
+
+/**
+ * Frees the statistics
+ *
+ * @param stats The statistics
+ */
+void zathura_stats_free(zathura_stats_t* stats);
+
+/**
+ * Records a measurement. This function is thread-safe.
+ *
+ * @param stats The statistics
+ * @param stat What has been measured
+ * @param duration The duration in microseconds
+ */
+void zathura_stats_add(zathura_stats_t* stats, zathura_stat_t stat, gint64 duration);
+
+/**
+ * Counts an event. This function is thread-safe.
+ *
+ * @param stats The statistics
+ * @param counter What has happened
+ */
+void zathura_stats_count(zathura_stats_t* stats, zathura_counter_t counter);
+
+/**
+ * Records the number of queued render jobs. This function is thread-safe.
+ *
+ * @param stats The statistics
+ * @param depth The number of queued jobs
+ */
+void zathura_stats_set_queue_depth(zathura_stats_t* stats, unsigned int depth);
+
+/**
+ * Returns the summary of a measured duration
+ *
+ * @param stats The statistics
+ * @param stat The measured duration
+ * @param value Will be set to the summary
+ */
+void zathura_stats_get(zathura_stats_t* stats, zathura_stat_t stat,
+    zathura_stat_value_t* value);
+
+/**
+ * Returns how often an event has happened
+ *
+ * @param stats The statistics
+ * @param counter The counted event
+ * @return The number of events
+ */
+unsigned int zathura_stats_get_count(zathura_stats_t* stats, zathura_counter_t counter);
+
+/**
+ * Returns the number of queued render jobs
+ *
+ * @param stats The statistics
+ * @param current Will be set to the last recorded number (or NULL)
+ * @param max Will be set to the largest recorded number (or NULL)
+ */
+void zathura_stats_get_queue_depth(zathura_stats_t* stats, unsigned int*
+    current, unsigned int* max);
+
+/**
+ * Forgets all measurements
+ *
+ * @param stats The statistics
+ */
+void zathura_stats_reset(zathura_stats_t* stats);
+
+/**
+ * Returns the name of a measured duration as used in the reports
+ *
+ * @param stat The measured duration
+ * @return The name
+ */
+const char* zathura_stats_get_name(zathura_stat_t stat);
+
+/**
+ * Formats the statistics for humans, one line per measured duration
+ *
+ * @param stats The statistics
+ * @param cache Statistics of the page cache (or NULL)
+ * @param pool Statistics of the surface pool (or NULL)
+ * @return The text (free with g_free)
+ */
+char* zathura_stats_to_string(zathura_stats_t* stats, const
+    zathura_page_cache_statistics_t* cache, const
+    zathura_surface_pool_statistics_t* pool);
+
+/**
+ * Formats the statistics as a JSON object
+ *
+ * @param stats The statistics
+ * @param cache Statistics of the page cache (or NULL)
+ * @param pool Statistics of the surface pool (or NULL)
+ * @return The JSON text (free with g_free)
+ */
+char* zathura_stats_to_json(zathura_stats_t* stats, const
+    zathura_page_cache_statistics_t* cache, const
+    zathura_surface_pool_statistics_t* pool);
+
+#endif // STATS_H
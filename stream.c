@@ -0,0 +1,174 @@
+/* See LICENSE file for license and copyright information */
+
+#define _GNU_SOURCE
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <girara/utils.h>
+
+#include "stream.h"
+
+/* bytes moved with a single call */
+#define STREAM_CHUNK (1 << 20)
+/* milliseconds between checks of the cancel flag while waiting for data */
+#define STREAM_POLL_INTERVAL 100
+
+typedef enum stream_result_e {
+  STREAM_DONE, /**< The end of the input has been reached */
+  STREAM_FAILED, /**< Reading or writing failed */
+  STREAM_UNSUPPORTED /**< The method is not supported by the descriptors */
+} stream_result_t;
+
+static bool
+stream_wait(int from, const gint* cancel)
+{
+  struct pollfd descriptor = { .fd = from, .events = POLLIN };
+  while (cancel == NULL || g_atomic_int_get(cancel) == 0) {
+    const int ret = poll(&descriptor, 1, STREAM_POLL_INTERVAL);
+    if (ret > 0) {
+      return true;
+    } else if (ret == -1 && errno != EINTR) {
+      return false;
+    }
+  }
+
+  return false;
+}
+
+static void
+stream_progress(gint* progress, goffset copied)
+{
+  if (progress != NULL) {
+    g_atomic_int_set(progress, copied / 1024);
+  }
+}
+
+static bool
+stream_write(int to, const char* buffer, size_t length)
+{
+  while (length > 0) {
+    const ssize_t written = write(to, buffer, length);
+    if (written == -1 && errno == EINTR) {
+      continue;
+    } else if (written <= 0) {
+      return false;
+    }
+    buffer += written;
+    length -= written;
+  }
+
+  return true;
+}
+
+#ifdef __linux__
+static stream_result_t
+stream_copy_kernel(int from, int to, bool pipe, const gint* cancel,
+    gint* progress, goffset* copied)
+{
+  while (true) {
+    if (pipe == true && stream_wait(from, cancel) == false) {
+      return STREAM_FAILED;
+    }
+
+    const ssize_t moved = pipe == true ?
+      splice(from, NULL, to, NULL, STREAM_CHUNK, SPLICE_F_MOVE | SPLICE_F_MORE) :
+      sendfile(to, from, NULL, STREAM_CHUNK);
+    if (moved == 0) {
+      return STREAM_DONE;
+    } else if (moved == -1) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      /* nothing has been moved yet, so a buffer can take over */
+      if ((errno == EINVAL || errno == ENOSYS) && *copied == 0) {
+        return STREAM_UNSUPPORTED;
+      }
+      return STREAM_FAILED;
+    }
+
+    *copied += moved;
+    stream_progress(progress, *copied);
+  }
+}
+#endif
+
+bool
+zathura_stream_copy(int from, int to, const gint* cancel, gint* progress)
+{
+  if (from < 0 || to < 0) {
+    return false;
+  }
+
+  goffset copied = 0;
+  stream_progress(progress, copied);
+
+#ifdef __linux__
+  GStatBuf info;
+  if (fstat(from, &info) == 0 && (S_ISFIFO(info.st_mode) || S_ISREG(info.st_mode))) {
+    const stream_result_t result = stream_copy_kernel(from, to,
+        S_ISFIFO(info.st_mode), cancel, progress, &copied);
+    if (result != STREAM_UNSUPPORTED) {
+      return result == STREAM_DONE;
+    }
+    girara_debug("copying the stream through a buffer");
+  }
+#endif
+
+  char* buffer = g_malloc(STREAM_CHUNK);
+  bool done = false;
+  while (stream_wait(from, cancel) == true) {
+    const ssize_t count = read(from, buffer, STREAM_CHUNK);
+    if (count == -1 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    } else if (count == 0) {
+      done = true;
+      break;
+    } else if (count == -1 || stream_write(to, buffer, count) == false) {
+      break;
+    }
+
+    copied += count;
+    stream_progress(progress, copied);
+  }
+  g_free(buffer);
+
+  return done;
+}
+
+char*
+zathura_stream_create_file(int* fd)
+{
+  if (fd == NULL) {
+    return NULL;
+  }
+
+  char* file = g_build_filename(g_get_user_runtime_dir(), "zathura.stdin.XXXXXX", NULL);
+  *fd = g_mkstemp(file);
+  if (*fd != -1) {
+    return file;
+  }
+  g_free(file);
+  file = NULL;
+
+  GError* error = NULL;
+  *fd = g_file_open_tmp("zathura.stdin.XXXXXX", &file, &error);
+  if (*fd == -1) {
+    if (error != NULL) {
+      girara_error("Can not create temporary file: %s", error->message);
+      g_error_free(error);
+    }
+    return NULL;
+  }
+
+  return file;
+}
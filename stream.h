@@ -0,0 +1,35 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+/**
+ * Copies everything that can be read from a file descriptor to another one.
+ * Pipes are spliced and regular files are sent without passing the data
+ * through user space where the system supports it; otherwise the data is
+ * copied through a buffer.
+ *
+ * @param from The file descriptor to read from
+ * @param to The file descriptor to write to
+ * @param cancel If not NULL, the copy stops once it is set to a non-zero value
+ *   (checked at least every 100 ms while waiting for data)
+ * @param progress If not NULL, set to the number of KiB copied so far
+ * @return true if the end of the input has been reached and everything has
+ *   been written
+ */
+bool zathura_stream_copy(int from, int to, const gint* cancel, gint* progress);
+
+/**
+ * Creates a temporary file for a document that is read from a stream. The
+ * file is created in the runtime directory of the user, which is usually
+ * kept in memory, or in the directory for temporary files otherwise.
+ *
+ * @param fd Will be set to the file descriptor of the file opened for writing
+ * @return The path of the file (free with g_free) or NULL on error
+ */
+char* zathura_stream_create_file(int* fd);
+
+#endif // STREAM_H
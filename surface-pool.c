@@ -0,0 +1,259 @@
+/* See LICENSE file for license and copyright information */
+
+#include <glib.h>
+
+#include "glib-compat.h"
+#include "surface-pool.h"
+
+/**
+ * Memory of an image surface created by the pool
+ */
+typedef struct surface_pool_buffer_s {
+  zathura_surface_pool_t* pool; /**< The pool the buffer is returned to */
+  guint64 key; /**< Dimensions and format of the buffer */
+  size_t bytes; /**< Size of the buffer */
+  unsigned char* data; /**< The pixels */
+} surface_pool_buffer_t;
+
+/**
+ * Waiting buffers of the same dimensions and format
+ */
+typedef struct surface_pool_bucket_s {
+  guint64 key; /**< Dimensions and format of the buffers */
+  GSList* buffers; /**< The waiting buffers */
+} surface_pool_bucket_t;
+
+struct zathura_surface_pool_s {
+  GHashTable* buckets; /**< key -> bucket */
+  size_t bytes; /**< Memory used by the waiting buffers */
+  size_t max_bytes; /**< Memory budget */
+  unsigned int buffers; /**< Number of waiting buffers */
+  unsigned int reused; /**< Number of recycled buffers */
+  unsigned int allocated; /**< Number of new buffers */
+  unsigned int dropped; /**< Number of freed buffers */
+  unsigned int references; /**< The owner and every buffer in use */
+  mutex lock; /**< Lock */
+};
+
+static const cairo_user_data_key_t surface_pool_user_data_key;
+
+static guint64
+surface_pool_key(cairo_format_t format, int width, int height)
+{
+  return ((guint64) (format + 1) << 48) | ((guint64) width << 24) | (guint64) height;
+}
+
+static void
+surface_pool_buffer_free(surface_pool_buffer_t* buffer)
+{
+  g_free(buffer->data);
+  g_free(buffer);
+}
+
+static void
+surface_pool_bucket_free(surface_pool_bucket_t* bucket)
+{
+  g_slist_free_full(bucket->buffers, (GDestroyNotify) surface_pool_buffer_free);
+  g_free(bucket);
+}
+
+static void
+surface_pool_destroy(zathura_surface_pool_t* pool)
+{
+  g_hash_table_destroy(pool->buckets);
+  mutex_free(&pool->lock);
+  g_free(pool);
+}
+
+/* Called once the last reference of a surface is gone. */
+static void
+surface_pool_release(void* data)
+{
+  surface_pool_buffer_t* buffer = data;
+  zathura_surface_pool_t* pool  = buffer->pool;
+
+  mutex_lock(&pool->lock);
+  const bool last = --pool->references == 0;
+  if (last == false && pool->bytes + buffer->bytes <= pool->max_bytes) {
+    surface_pool_bucket_t* bucket = g_hash_table_lookup(pool->buckets, &buffer->key);
+    if (bucket == NULL) {
+      bucket      = g_malloc0(sizeof(surface_pool_bucket_t));
+      bucket->key = buffer->key;
+      g_hash_table_insert(pool->buckets, &bucket->key, bucket);
+    }
+    bucket->buffers = g_slist_prepend(bucket->buffers, buffer);
+    pool->bytes += buffer->bytes;
+    ++pool->buffers;
+    buffer = NULL;
+  } else if (last == false) {
+    ++pool->dropped;
+  }
+  mutex_unlock(&pool->lock);
+
+  if (buffer != NULL) {
+    surface_pool_buffer_free(buffer);
+  }
+  if (last == true) {
+    surface_pool_destroy(pool);
+  }
+}
+
+zathura_surface_pool_t*
+zathura_surface_pool_new(size_t max_bytes)
+{
+  zathura_surface_pool_t* pool = g_malloc0(sizeof(zathura_surface_pool_t));
+
+  /* the keys are part of the buckets */
+  pool->buckets    = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL,
+      (GDestroyNotify) surface_pool_bucket_free);
+  pool->max_bytes  = max_bytes;
+  pool->references = 1;
+  mutex_init(&pool->lock);
+
+  return pool;
+}
+
+void
+zathura_surface_pool_free(zathura_surface_pool_t* pool)
+{
+  if (pool == NULL) {
+    return;
+  }
+
+  /* buffers of surfaces that are still in use are freed once they are
+   * released */
+  mutex_lock(&pool->lock);
+  pool->max_bytes = 0;
+  mutex_unlock(&pool->lock);
+  zathura_surface_pool_clear(pool);
+
+  mutex_lock(&pool->lock);
+  const bool last = --pool->references == 0;
+  mutex_unlock(&pool->lock);
+  if (last == true) {
+    surface_pool_destroy(pool);
+  }
+}
+
+cairo_surface_t*
+zathura_surface_pool_create(zathura_surface_pool_t* pool, cairo_format_t
+    format, int width, int height)
+{
+  if (width <= 0 || height <= 0) {
+    return NULL;
+  }
+
+  if (pool == NULL) {
+    cairo_surface_t* surface = cairo_image_surface_create(format, width, height);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+      cairo_surface_destroy(surface);
+      return NULL;
+    }
+    return surface;
+  }
+
+  const int stride = cairo_format_stride_for_width(format, width);
+  if (stride <= 0) {
+    return NULL;
+  }
+  const guint64 key = surface_pool_key(format, width, height);
+
+  mutex_lock(&pool->lock);
+  surface_pool_buffer_t* buffer = NULL;
+  surface_pool_bucket_t* bucket = g_hash_table_lookup(pool->buckets, &key);
+  if (bucket != NULL && bucket->buffers != NULL) {
+    GSList* link    = bucket->buffers;
+    bucket->buffers = g_slist_remove_link(link, link);
+    buffer          = link->data;
+    g_slist_free_1(link);
+  }
+
+  if (buffer != NULL) {
+    pool->bytes -= buffer->bytes;
+    --pool->buffers;
+    ++pool->reused;
+  } else {
+    ++pool->allocated;
+  }
+  ++pool->references;
+  mutex_unlock(&pool->lock);
+
+  if (buffer == NULL) {
+    const size_t bytes = (size_t) stride * height;
+    unsigned char* data = g_try_malloc(bytes);
+    if (data != NULL) {
+      buffer        = g_malloc0(sizeof(surface_pool_buffer_t));
+      buffer->pool  = pool;
+      buffer->key   = key;
+      buffer->bytes = bytes;
+      buffer->data  = data;
+    }
+  }
+
+  cairo_surface_t* surface = NULL;
+  if (buffer != NULL) {
+    surface = cairo_image_surface_create_for_data(buffer->data, format, width,
+        height, stride);
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS ||
+        cairo_surface_set_user_data(surface, &surface_pool_user_data_key,
+          buffer, surface_pool_release) != CAIRO_STATUS_SUCCESS) {
+      cairo_surface_destroy(surface);
+      surface_pool_buffer_free(buffer);
+      surface = NULL;
+    }
+  }
+
+  /* the buffer is not in use after all */
+  if (surface == NULL) {
+    mutex_lock(&pool->lock);
+    const bool last = --pool->references == 0;
+    mutex_unlock(&pool->lock);
+    if (last == true) {
+      surface_pool_destroy(pool);
+    }
+  }
+
+  return surface;
+}
+
+void
+zathura_surface_pool_clear(zathura_surface_pool_t* pool)
+{
+  if (pool == NULL) {
+    return;
+  }
+
+  mutex_lock(&pool->lock);
+  g_hash_table_remove_all(pool->buckets);
+  pool->bytes   = 0;
+  pool->buffers = 0;
+  mutex_unlock(&pool->lock);
+}
+
+void
+zathura_surface_pool_get_statistics(zathura_surface_pool_t* pool,
+    zathura_surface_pool_statistics_t* statistics)
+{
+  if (statistics == NULL) {
+    return;
+  }
+
+  if (pool == NULL) {
+    statistics->reused    = 0;
+    statistics->allocated = 0;
+    statistics->dropped   = 0;
+    statistics->buffers   = 0;
+    statistics->bytes     = 0;
+    statistics->max_bytes = 0;
+    return;
+  }
+
+  mutex_lock(&pool->lock);
+  statistics->reused    = pool->reused;
+  statistics->allocated = pool->allocated;
+  statistics->dropped   = pool->dropped;
+  statistics->buffers   = pool->buffers;
+  statistics->bytes     = pool->bytes;
+  statistics->max_bytes = pool->max_bytes;
+  mutex_unlock(&pool->lock);
+}
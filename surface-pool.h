@@ -0,0 +1,72 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef SURFACE_POOL_H
+#define SURFACE_POOL_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <cairo.h>
+
+typedef struct zathura_surface_pool_s zathura_surface_pool_t;
+
+/**
+ * Pool statistics
+ */
+typedef struct zathura_surface_pool_statistics_s {
+  unsigned int reused; /**< Number of surfaces that got a recycled buffer */
+  unsigned int allocated; /**< Number of surfaces that needed a new buffer */
+  unsigned int dropped; /**< Number of buffers freed because the pool was full */
+  unsigned int buffers; /**< Number of buffers waiting to be reused */
+  size_t bytes; /**< Memory used by the waiting buffers */
+  size_t max_bytes; /**< Memory budget */
+} zathura_surface_pool_statistics_t;
+
+/**
+ * Creates a new surface pool. Buffers of destroyed surfaces are kept, grouped
+ * by width, height and format, and used again for new surfaces of the same
+ * dimensions.
+ *
+ * @param max_bytes Memory the waiting buffers may use (0 disables recycling)
+ * @return The surface pool
+ */
+zathura_surface_pool_t* zathura_surface_pool_new(size_t max_bytes);
+
+/**
+ * Frees the surface pool and the waiting buffers. Surfaces created by the
+ * pool stay valid; their buffers are freed once they are destroyed.
+ *
+ * @param pool The surface pool
+ */
+void zathura_surface_pool_free(zathura_surface_pool_t* pool);
+
+/**
+ * Creates an image surface, reusing the buffer of a destroyed surface with
+ * the same dimensions if there is one. The contents of the surface are
+ * undefined. This function is thread-safe.
+ *
+ * @param pool The surface pool (or NULL to allocate a new surface)
+ * @param format The format of the surface
+ * @param width The width of the surface
+ * @param height The height of the surface
+ * @return The surface or NULL if an error occured
+ */
+cairo_surface_t* zathura_surface_pool_create(zathura_surface_pool_t* pool,
+    cairo_format_t format, int width, int height);
+
+/**
+ * Frees all waiting buffers
+ *
+ * @param pool The surface pool
+ */
+void zathura_surface_pool_clear(zathura_surface_pool_t* pool);
+
+/**
+ * Returns the statistics of the pool
+ *
+ * @param pool The surface pool
+ * @param statistics Will be set to the current statistics
+ */
+void zathura_surface_pool_get_statistics(zathura_surface_pool_t* pool,
+    zathura_surface_pool_statistics_t* statistics);
+
+#endif // SURFACE_POOL_H
@@ -1,7 +1,15 @@
 /* See LICENSE file for license and copyright information */
 
+#define _XOPEN_SOURCE 700
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 
 #include "synctex.h"
 
@@ -11,48 +19,816 @@
 #include "utils.h"
 
 #include <girara/session.h>
-
-enum {
-  SYNCTEX_RESULT_BEGIN = 1,
-  SYNCTEX_RESULT_END,
-  SYNCTEX_PROP_PAGE,
-  SYNCTEX_PROP_H,
-  SYNCTEX_PROP_V,
-  SYNCTEX_PROP_WIDTH,
-  SYNCTEX_PROP_HEIGHT,
+#include <girara/utils.h>
+#include <girara/datastructures.h>
+
+/* scaled points per big point */
+#define SYNCTEX_SP_PER_BP 65781.76
+/* numbers of a node: tag, line, column, h, v, width, height and depth */
+#define SYNCTEX_MAX_NUMBERS 8
+
+/**
+ * A node of the SyncTeX file
+ */
+typedef struct synctex_record_s {
+  unsigned int tag; /**< Tag of the source file */
+  unsigned int line; /**< Line in the source file */
+  int column; /**< Column in the source file or -1 */
+  unsigned int page; /**< Index of the page */
+  double h; /**< Horizontal position in points */
+  zathura_rectangle_t box; /**< The box or the box that contains the node */
+  bool is_box; /**< The node is a box and not a point in a box */
+  bool vertical; /**< The box (containing the node) is a vertical box */
+  int parent; /**< Index of the box that contains the node or -1 */
+} synctex_record_t;
+
+/**
+ * The nodes of a page
+ */
+typedef struct synctex_page_s {
+  unsigned int first; /**< Index of the first node */
+  unsigned int count; /**< Number of nodes */
+} synctex_page_t;
+
+/**
+ * Conversion of the coordinates of the file to points
+ */
+typedef struct synctex_scale_s {
+  double factor; /**< Points per unit */
+  double x_offset; /**< Horizontal offset in points */
+  double y_offset; /**< Vertical offset in points */
+} synctex_scale_t;
+
+struct zathura_synctex_s {
+  char* base; /**< Path of the document without its extension */
+  char* directory; /**< Directory of the document */
+  char* file; /**< SyncTeX file the index has been read from */
+  gint64 mtime; /**< Modification time of the file */
+  gint64 size; /**< Size of the file */
+  bool valid; /**< The file could be read */
+
+  GArray* records; /**< synctex_record_t in the order of the file */
+  GArray* by_line; /**< Indices of the records ordered by tag and line */
+  GArray* pages; /**< synctex_page_t of every page */
+  GHashTable* inputs; /**< Tags mapped to the paths of the source files */
 };
 
-typedef struct token_s {
-  const char* name;
-  guint token;
-} token_t;
-
-static token_t scanner_tokens[] = {
-  {"SyncTeX result begin", SYNCTEX_RESULT_BEGIN},
-  {"SyncTeX result end", SYNCTEX_RESULT_END},
-  {"Page:", SYNCTEX_PROP_PAGE},
-  {"h:", SYNCTEX_PROP_H},
-  {"v:", SYNCTEX_PROP_V},
-  {"W:", SYNCTEX_PROP_WIDTH},
-  {"H:", SYNCTEX_PROP_HEIGHT},
-  {NULL, 0}
-};
+static void synctex_record_hits(zathura_t* zathura, unsigned int page_idx, girara_list_t* hits, bool first);
 
-static GScannerConfig scanner_config = {
-  .cset_skip_characters  = "\n\r",
-  .cset_identifier_first = G_CSET_a_2_z G_CSET_A_2_Z,
-  .cset_identifier_nth   = G_CSET_a_2_z G_CSET_A_2_Z ": ",
-  .cpair_comment_single  = NULL,
-  .case_sensitive        = TRUE,
-  .scan_identifier       = TRUE,
-  .scan_symbols          = TRUE,
-  .scan_float            = TRUE,
-  .numbers_2_int         = TRUE,
-};
+zathura_synctex_t*
+zathura_synctex_new(const char* document_path)
+{
+  if (document_path == NULL) {
+    return NULL;
+  }
+
+  zathura_synctex_t* synctex = g_malloc0(sizeof(zathura_synctex_t));
+
+  /* doc.pdf is synchronized with doc.synctex.gz */
+  char* basename  = g_path_get_basename(document_path);
+  char* extension = strrchr(basename, '.');
+  if (extension != NULL && extension != basename) {
+    *extension = '\0';
+  }
+  synctex->directory = g_path_get_dirname(document_path);
+  synctex->base      = g_build_filename(synctex->directory, basename, NULL);
+  g_free(basename);
+
+  synctex->records = g_array_new(FALSE, FALSE, sizeof(synctex_record_t));
+  synctex->by_line = g_array_new(FALSE, FALSE, sizeof(guint));
+  synctex->pages   = g_array_new(FALSE, TRUE, sizeof(synctex_page_t));
+  synctex->inputs  = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+  return synctex;
+}
+
+void
+zathura_synctex_free(zathura_synctex_t* synctex)
+{
+  if (synctex == NULL) {
+    return;
+  }
+
+  g_array_free(synctex->records, TRUE);
+  g_array_free(synctex->by_line, TRUE);
+  g_array_free(synctex->pages, TRUE);
+  g_hash_table_unref(synctex->inputs);
+  g_free(synctex->file);
+  g_free(synctex->directory);
+  g_free(synctex->base);
+  g_free(synctex);
+}
+
+static void
+synctex_clear(zathura_synctex_t* synctex)
+{
+  g_array_set_size(synctex->records, 0);
+  g_array_set_size(synctex->by_line, 0);
+  g_array_set_size(synctex->pages, 0);
+  g_hash_table_remove_all(synctex->inputs);
+}
+
+/* source files are compared by their resolved paths */
+static char*
+synctex_canonical_path(const char* directory, const char* path)
+{
+  char* absolute = NULL;
+  if (g_path_is_absolute(path) == TRUE) {
+    absolute = g_strdup(path);
+  } else {
+    absolute = g_build_filename(directory, path, NULL);
+  }
+
+  char* real = realpath(absolute, NULL);
+  if (real == NULL) {
+    return absolute;
+  }
+
+  g_free(absolute);
+  char* canonical = g_strdup(real);
+  free(real);
+
+  return canonical;
+}
+
+static char*
+synctex_read_gzip(const char* file, gsize* length)
+{
+  GFile* gfile = g_file_new_for_path(file);
+  GFileInputStream* input = g_file_read(gfile, NULL, NULL);
+  g_object_unref(gfile);
+  if (input == NULL) {
+    return NULL;
+  }
+
+  GZlibDecompressor* decompressor = g_zlib_decompressor_new(G_ZLIB_COMPRESSOR_FORMAT_GZIP);
+  GInputStream* stream = g_converter_input_stream_new(G_INPUT_STREAM(input),
+      G_CONVERTER(decompressor));
+  g_object_unref(decompressor);
+  g_object_unref(input);
+
+  GString* data = g_string_new(NULL);
+  char buffer[64 * 1024];
+  gssize bytes = 0;
+  while ((bytes = g_input_stream_read(stream, buffer, sizeof(buffer), NULL, NULL)) > 0) {
+    g_string_append_len(data, buffer, bytes);
+  }
+  g_object_unref(stream);
+
+  if (bytes < 0) {
+    g_string_free(data, TRUE);
+    return NULL;
+  }
+
+  *length = data->len;
+  return g_string_free(data, FALSE);
+}
+
+static char*
+synctex_read(const char* file, gsize* length)
+{
+  if (g_str_has_suffix(file, ".gz") == TRUE) {
+    return synctex_read_gzip(file, length);
+  }
+
+  char* data = NULL;
+  if (g_file_get_contents(file, &data, length, NULL) == FALSE) {
+    return NULL;
+  }
+
+  return data;
+}
+
+/* parses the numbers of a node, e.g. 1,10:4736286,48145839:26673152,0,0;
+ * colons separate the groups of numbers */
+static unsigned int
+synctex_parse_numbers(const char* text, long* values, unsigned int* groups)
+{
+  unsigned int count = 0;
+  unsigned int group = 0;
+
+  while (count < SYNCTEX_MAX_NUMBERS) {
+    char* end = NULL;
+    errno = 0;
+    const long value = strtol(text, &end, 10);
+    if (end == text || errno != 0) {
+      break;
+    }
+
+    values[count] = value;
+    groups[count] = group;
+    ++count;
+
+    if (*end == ',') {
+      text = end + 1;
+    } else if (*end == ':') {
+      text = end + 1;
+      ++group;
+    } else {
+      break;
+    }
+  }
+
+  return count;
+}
+
+static void
+synctex_add_input(zathura_synctex_t* synctex, const char* text)
+{
+  char* end = NULL;
+  errno = 0;
+  const unsigned long tag = strtoul(text, &end, 10);
+  if (end == text || errno != 0 || *end != ':' || end[1] == '\0') {
+    return;
+  }
+
+  g_hash_table_replace(synctex->inputs, GUINT_TO_POINTER(tag),
+      synctex_canonical_path(synctex->directory, end + 1));
+}
+
+static void
+synctex_add_record(zathura_synctex_t* synctex, const char* text, char type,
+    unsigned int page, GArray* stack, const synctex_scale_t* scale)
+{
+  long values[SYNCTEX_MAX_NUMBERS];
+  unsigned int groups[SYNCTEX_MAX_NUMBERS];
+  const unsigned int count = synctex_parse_numbers(text, values, groups);
+
+  /* tag and line, optionally followed by the column */
+  if (count < 2 || groups[1] != 0 || values[0] < 0 || values[1] < 0) {
+    return;
+  }
+  unsigned int index = 2;
+  int column = -1;
+  if (index < count && groups[index] == 0) {
+    column = values[index++];
+  }
+
+  /* position */
+  if (index + 1 >= count || groups[index] != 1 || groups[index + 1] != 1) {
+    return;
+  }
+
+  synctex_record_t record = {
+    .tag    = values[0],
+    .line   = values[1],
+    .column = column,
+    .page   = page,
+    .h      = values[index] * scale->factor + scale->x_offset,
+    .parent = -1
+  };
+  const double v = values[index + 1] * scale->factor + scale->y_offset;
+  index += 2;
+
+  const bool is_box = type == '[' || type == '(' || type == 'v' || type == 'h';
+  if (is_box == true) {
+    /* width, height and depth */
+    if (index + 2 >= count || groups[index] != 2) {
+      return;
+    }
+    const double width  = values[index] * scale->factor;
+    const double height = values[index + 1] * scale->factor;
+    const double depth  = values[index + 2] * scale->factor;
+
+    record.is_box   = true;
+    record.vertical = type == '[' || type == 'v';
+    record.box.x1   = MIN(record.h, record.h + width);
+    record.box.x2   = MAX(record.h, record.h + width);
+    record.box.y1   = v - height;
+    record.box.y2   = v + depth;
+  } else {
+    /* points are shown as the box they are in */
+    if (stack->len == 0) {
+      return;
+    }
+    record.parent = g_array_index(stack, int, stack->len - 1);
+    const synctex_record_t* parent = &g_array_index(synctex->records,
+        synctex_record_t, record.parent);
+    record.box      = parent->box;
+    record.vertical = parent->vertical;
+  }
+
+  g_array_append_val(synctex->records, record);
+  if (type == '[' || type == '(') {
+    const int box = synctex->records->len - 1;
+    g_array_append_val(stack, box);
+  }
+}
+
+static gint
+synctex_compare_lines(gconstpointer a, gconstpointer b, gpointer data)
+{
+  const GArray* records = data;
+  const guint index_a = *(const guint*) a;
+  const guint index_b = *(const guint*) b;
+  const synctex_record_t* record_a = &g_array_index(records, synctex_record_t, index_a);
+  const synctex_record_t* record_b = &g_array_index(records, synctex_record_t, index_b);
+
+  if (record_a->tag != record_b->tag) {
+    return record_a->tag < record_b->tag ? -1 : 1;
+  } else if (record_a->line != record_b->line) {
+    return record_a->line < record_b->line ? -1 : 1;
+  } else if (index_a != index_b) {
+    /* the nodes of a line stay in the order of the pages */
+    return index_a < index_b ? -1 : 1;
+  }
+
+  return 0;
+}
+
+static bool
+synctex_load(zathura_synctex_t* synctex, const char* file)
+{
+  gsize length = 0;
+  char* data = synctex_read(file, &length);
+  if (data == NULL) {
+    return false;
+  }
+
+  double unit          = 1;
+  double magnification = 1000;
+  double x_offset      = 0;
+  double y_offset      = 0;
+  synctex_scale_t scale = { 0, 0, 0 };
+
+  bool version = false;
+  bool content = false;
+  bool in_page = false;
+  unsigned int page = 0;
+  GArray* stack = g_array_new(FALSE, FALSE, sizeof(int));
+
+  char* line = data;
+  while (line != NULL && line < data + length) {
+    char* next = strchr(line, '\n');
+    if (next != NULL) {
+      *next++ = '\0';
+    }
+
+    if (g_str_has_prefix(line, "Input:") == TRUE) {
+      /* files may also be added while the content is written */
+      synctex_add_input(synctex, line + strlen("Input:"));
+    } else if (content == false) {
+      if (g_str_has_prefix(line, "SyncTeX Version:") == TRUE) {
+        version = true;
+      } else if (g_str_has_prefix(line, "Unit:") == TRUE) {
+        unit = g_ascii_strtod(line + strlen("Unit:"), NULL);
+      } else if (g_str_has_prefix(line, "Magnification:") == TRUE) {
+        magnification = g_ascii_strtod(line + strlen("Magnification:"), NULL);
+      } else if (g_str_has_prefix(line, "X Offset:") == TRUE) {
+        x_offset = g_ascii_strtod(line + strlen("X Offset:"), NULL);
+      } else if (g_str_has_prefix(line, "Y Offset:") == TRUE) {
+        y_offset = g_ascii_strtod(line + strlen("Y Offset:"), NULL);
+      } else if (strcmp(line, "Content:") == 0) {
+        if (unit <= 0) {
+          unit = 1;
+        }
+        if (magnification <= 0) {
+          magnification = 1000;
+        }
+        const double bp = magnification / 1000 / SYNCTEX_SP_PER_BP;
+        scale.factor   = unit * bp;
+        scale.x_offset = x_offset * bp;
+        scale.y_offset = y_offset * bp;
+        content = true;
+      }
+    } else if (g_str_has_prefix(line, "Postamble:") == TRUE) {
+      break;
+    } else if (line[0] == '{') {
+      const long number = strtol(line + 1, NULL, 10);
+      if (number > 0) {
+        page = number - 1;
+        if (page >= synctex->pages->len) {
+          g_array_set_size(synctex->pages, page + 1);
+        }
+        g_array_index(synctex->pages, synctex_page_t, page).first = synctex->records->len;
+        in_page = true;
+      }
+      g_array_set_size(stack, 0);
+    } else if (line[0] == '}') {
+      if (in_page == true) {
+        synctex_page_t* nodes = &g_array_index(synctex->pages, synctex_page_t, page);
+        nodes->count = synctex->records->len - nodes->first;
+      }
+      in_page = false;
+      g_array_set_size(stack, 0);
+    } else if (line[0] == ']' || line[0] == ')') {
+      if (stack->len > 0) {
+        g_array_set_size(stack, stack->len - 1);
+      }
+    } else if (in_page == true && strchr("[(vhxkg$", line[0]) != NULL && line[0] != '\0') {
+      synctex_add_record(synctex, line + 1, line[0], page, stack, &scale);
+    }
+
+    line = next;
+  }
+
+  g_array_free(stack, TRUE);
+  g_free(data);
+
+  if (version == false || content == false) {
+    return false;
+  }
+
+  g_array_set_size(synctex->by_line, synctex->records->len);
+  for (guint i = 0; i < synctex->records->len; i++) {
+    g_array_index(synctex->by_line, guint, i) = i;
+  }
+  g_array_sort_with_data(synctex->by_line, synctex_compare_lines, synctex->records);
+
+  return true;
+}
+
+bool
+zathura_synctex_update(zathura_synctex_t* synctex)
+{
+  if (synctex == NULL) {
+    return false;
+  }
+
+  GStatBuf info;
+  char* file = g_strconcat(synctex->base, ".synctex.gz", NULL);
+  if (g_stat(file, &info) != 0) {
+    g_free(file);
+    file = g_strconcat(synctex->base, ".synctex", NULL);
+    if (g_stat(file, &info) != 0) {
+      g_free(file);
+      g_free(synctex->file);
+      synctex->file  = NULL;
+      synctex->valid = false;
+      synctex_clear(synctex);
+      return false;
+    }
+  }
+
+  /* the file is only read again once it has been written again */
+  if (g_strcmp0(file, synctex->file) == 0 && info.st_mtime == synctex->mtime &&
+      info.st_size == synctex->size) {
+    g_free(file);
+    return synctex->valid;
+  }
+
+  synctex_clear(synctex);
+  g_free(synctex->file);
+  synctex->file  = file;
+  synctex->mtime = info.st_mtime;
+  synctex->size  = info.st_size;
+  synctex->valid = synctex_load(synctex, file);
+
+  if (synctex->valid == true) {
+    girara_debug("read %u synctex nodes from '%s'", synctex->records->len, file);
+  } else {
+    girara_warning("Could not read the synctex file '%s'.", file);
+    synctex_clear(synctex);
+  }
+
+  return synctex->valid;
+}
+
+static const synctex_record_t*
+synctex_get_record_by_line(zathura_synctex_t* synctex, guint index)
+{
+  if (index >= synctex->by_line->len) {
+    return NULL;
+  }
+
+  return &g_array_index(synctex->records, synctex_record_t,
+      g_array_index(synctex->by_line, guint, index));
+}
+
+/* returns the first node of the tag at or after the line */
+static guint
+synctex_find_line(zathura_synctex_t* synctex, unsigned int tag, unsigned int line)
+{
+  guint low  = 0;
+  guint high = synctex->by_line->len;
+  while (low < high) {
+    const guint middle = low + (high - low) / 2;
+    const synctex_record_t* record = synctex_get_record_by_line(synctex, middle);
+    if (record->tag < tag || (record->tag == tag && record->line < line)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  return low;
+}
+
+static void
+synctex_add_boxes(zathura_synctex_t* synctex, unsigned int tag, unsigned int line,
+    bool vertical, GArray* boxes)
+{
+  for (guint i = synctex_find_line(synctex, tag, line); i < synctex->by_line->len; i++) {
+    const synctex_record_t* record = synctex_get_record_by_line(synctex, i);
+    if (record->tag != tag || record->line != line) {
+      break;
+    } else if (record->vertical != vertical) {
+      continue;
+    }
+
+    /* the points of a box share its rectangle */
+    bool known = false;
+    for (guint j = 0; j < boxes->len && known == false; j++) {
+      const zathura_synctex_box_t* box = &g_array_index(boxes, zathura_synctex_box_t, j);
+      known = box->page == record->page &&
+        memcmp(&box->rectangle, &record->box, sizeof(zathura_rectangle_t)) == 0;
+    }
+
+    if (known == false) {
+      const zathura_synctex_box_t box = { record->page, record->box };
+      g_array_append_val(boxes, box);
+    }
+  }
+}
+
+static void
+synctex_forward_tag(zathura_synctex_t* synctex, unsigned int tag, unsigned int line,
+    GArray* boxes)
+{
+  const guint index = synctex_find_line(synctex, tag, line);
+
+  const synctex_record_t* after  = synctex_get_record_by_line(synctex, index);
+  const synctex_record_t* before = index > 0 ? synctex_get_record_by_line(synctex, index - 1) : NULL;
+  if (after != NULL && after->tag != tag) {
+    after = NULL;
+  }
+  if (before != NULL && before->tag != tag) {
+    before = NULL;
+  }
+
+  /* lines without nodes are shown as the closest line with nodes */
+  unsigned int closest = 0;
+  if (after != NULL && (before == NULL || after->line - line <= line - before->line)) {
+    closest = after->line;
+  } else if (before != NULL) {
+    closest = before->line;
+  } else {
+    return;
+  }
+
+  /* the boxes of the text are preferred to the boxes of whole paragraphs or
+   * pages */
+  const guint known = boxes->len;
+  synctex_add_boxes(synctex, tag, closest, false, boxes);
+  if (boxes->len == known) {
+    synctex_add_boxes(synctex, tag, closest, true, boxes);
+  }
+}
+
+static gint
+synctex_compare_boxes(gconstpointer a, gconstpointer b)
+{
+  const zathura_synctex_box_t* box_a = a;
+  const zathura_synctex_box_t* box_b = b;
+
+  if (box_a->page != box_b->page) {
+    return box_a->page < box_b->page ? -1 : 1;
+  }
+
+  return 0;
+}
+
+girara_list_t*
+zathura_synctex_forward(zathura_synctex_t* synctex, const char* input, unsigned int line)
+{
+  if (synctex == NULL || input == NULL || zathura_synctex_update(synctex) == false) {
+    return NULL;
+  }
+
+  /* source files are found by their path and otherwise by their name */
+  char* path     = synctex_canonical_path(synctex->directory, input);
+  char* basename = g_path_get_basename(input);
+  GArray* boxes  = g_array_new(FALSE, FALSE, sizeof(zathura_synctex_box_t));
+
+  for (unsigned int pass = 0; pass < 2 && boxes->len == 0; pass++) {
+    GHashTableIter iter;
+    gpointer key   = NULL;
+    gpointer value = NULL;
+    g_hash_table_iter_init(&iter, synctex->inputs);
+    while (g_hash_table_iter_next(&iter, &key, &value) == TRUE) {
+      bool match = false;
+      if (pass == 0) {
+        match = g_strcmp0(value, path) == 0;
+      } else {
+        char* name = g_path_get_basename(value);
+        match = g_strcmp0(name, basename) == 0;
+        g_free(name);
+      }
+
+      if (match == true) {
+        synctex_forward_tag(synctex, GPOINTER_TO_UINT(key), line, boxes);
+      }
+    }
+  }
+
+  g_free(basename);
+  g_free(path);
+
+  if (boxes->len == 0) {
+    g_array_free(boxes, TRUE);
+    return NULL;
+  }
+
+  g_array_sort(boxes, synctex_compare_boxes);
+
+  girara_list_t* list = girara_list_new2(g_free);
+  for (guint i = 0; i < boxes->len; i++) {
+    zathura_synctex_box_t* box = g_malloc(sizeof(zathura_synctex_box_t));
+    *box = g_array_index(boxes, zathura_synctex_box_t, i);
+    girara_list_append(list, box);
+  }
+  g_array_free(boxes, TRUE);
+
+  return list;
+}
+
+static double
+synctex_distance(const zathura_rectangle_t* box, double x, double y)
+{
+  const double dx = x < box->x1 ? box->x1 - x : (x > box->x2 ? x - box->x2 : 0);
+  const double dy = y < box->y1 ? box->y1 - y : (y > box->y2 ? y - box->y2 : 0);
+
+  return dx * dx + dy * dy;
+}
+
+bool
+zathura_synctex_backward(zathura_synctex_t* synctex, unsigned int page, double x,
+    double y, char** input, unsigned int* line, int* column)
+{
+  if (synctex == NULL || input == NULL || line == NULL || column == NULL ||
+      zathura_synctex_update(synctex) == false || page >= synctex->pages->len) {
+    return false;
+  }
+
+  const synctex_page_t* nodes = &g_array_index(synctex->pages, synctex_page_t, page);
+  const synctex_record_t* records = &g_array_index(synctex->records,
+      synctex_record_t, nodes->first);
+
+  /* the smallest box at the point, or the closest box if there is none */
+  int best = -1;
+  bool inside = false;
+  double best_value = 0;
+  for (unsigned int i = 0; i < nodes->count; i++) {
+    const synctex_record_t* record = &records[i];
+    if (record->is_box == false) {
+      continue;
+    }
+
+    const zathura_rectangle_t* box = &record->box;
+    if (x >= box->x1 && x <= box->x2 && y >= box->y1 && y <= box->y2) {
+      const double area = (box->x2 - box->x1) * (box->y2 - box->y1);
+      if (inside == false || area < best_value) {
+        best       = i;
+        best_value = area;
+        inside     = true;
+      }
+    } else if (inside == false) {
+      const double distance = synctex_distance(box, x, y);
+      if (best == -1 || distance < best_value) {
+        best       = i;
+        best_value = distance;
+      }
+    }
+  }
+
+  if (best == -1) {
+    return false;
+  }
+
+  /* a box has the line of the end of its paragraph, while the points in it
+   * have the line of their text */
+  const int box = nodes->first + best;
+  const synctex_record_t* result = &records[best];
+  double distance = 0;
+  for (unsigned int i = best + 1; i < nodes->count; i++) {
+    const synctex_record_t* record = &records[i];
+    if (record->is_box == true || record->parent != box) {
+      continue;
+    }
+
+    if (result == &records[best] || fabs(record->h - x) < distance) {
+      result   = record;
+      distance = fabs(record->h - x);
+    }
+  }
+
+  const char* path = g_hash_table_lookup(synctex->inputs, GUINT_TO_POINTER(result->tag));
+  if (path == NULL) {
+    return false;
+  }
+
+  *input  = g_strdup(path);
+  *line   = result->line;
+  *column = result->column;
+
+  return true;
+}
+
+bool
+synctex_parse_position(const char* position, char** input, unsigned int* line, int* column)
+{
+  if (position == NULL || input == NULL || line == NULL || column == NULL) {
+    return false;
+  }
+
+  char* end = NULL;
+  errno = 0;
+  const unsigned long line_value = strtoul(position, &end, 10);
+  if (end == position || errno != 0 || *end != ':' || line_value > G_MAXUINT) {
+    return false;
+  }
+
+  const char* text = end + 1;
+  const long column_value = strtol(text, &end, 10);
+  if (end == text || errno != 0 || *end != ':' || end[1] == '\0' ||
+      column_value < -1 || column_value > G_MAXINT) {
+    return false;
+  }
+
+  *line   = line_value;
+  *column = column_value;
+  *input  = g_strdup(end + 1);
+
+  return true;
+}
+
+static zathura_synctex_t*
+synctex_get(zathura_t* zathura)
+{
+  if (zathura->document == NULL) {
+    return NULL;
+  }
+
+  if (zathura->synctex.index == NULL) {
+    zathura->synctex.index = zathura_synctex_new(zathura_document_get_path(zathura->document));
+  }
+
+  return zathura->synctex.index;
+}
+
+/* replaces the placeholders of the synctex command in an argument */
+static char*
+synctex_expand(const char* argument, const char* input, unsigned int line, int column)
+{
+  GString* result = g_string_new(NULL);
+
+  while (*argument != '\0') {
+    const char* end = NULL;
+    if (argument[0] == '%' && argument[1] == '{' && (end = strchr(argument, '}')) != NULL) {
+      char* name = g_strndup(argument + 2, end - argument - 2);
+      if (strcmp(name, "input") == 0) {
+        g_string_append(result, input);
+      } else if (strcmp(name, "line") == 0) {
+        g_string_append_printf(result, "%u", line);
+      } else if (strcmp(name, "column") == 0) {
+        g_string_append_printf(result, "%d", column);
+      } else if (strcmp(name, "offset") == 0) {
+        g_string_append(result, "0");
+      } else if (strcmp(name, "context") != 0) {
+        g_string_append_len(result, argument, end - argument + 1);
+      }
+      g_free(name);
+      argument = end + 1;
+    } else {
+      g_string_append_c(result, *argument++);
+    }
+  }
+
+  return g_string_free(result, FALSE);
+}
+
+static void
+synctex_open_editor(zathura_t* zathura, const char* input, unsigned int line, int column)
+{
+  /* without an editor the position is printed like the synctex command does */
+  if (zathura->synctex.editor == NULL) {
+    fprintf(stdout, "SyncTeX result begin\nInput:%s\nLine:%u\nColumn:%d\nSyncTeX result end\n",
+        input, line, column);
+    fflush(stdout);
+    return;
+  }
 
-static void synctex_record_hits(zathura_t* zathura, int page_idx, girara_list_t* hits, bool first);
-static double scan_float(GScanner* scanner);
-static bool synctex_view(zathura_t* zathura, char* position);
+  char** arguments = NULL;
+  GError* error = NULL;
+  if (g_shell_parse_argv(zathura->synctex.editor, NULL, &arguments, &error) == FALSE) {
+    girara_error("Invalid synctex editor command '%s': %s", zathura->synctex.editor,
+        error->message);
+    g_error_free(error);
+    return;
+  }
+
+  for (unsigned int i = 0; arguments[i] != NULL; i++) {
+    char* argument = synctex_expand(arguments[i], input, line, column);
+    g_free(arguments[i]);
+    arguments[i] = argument;
+  }
+
+  if (g_spawn_async(NULL, arguments, NULL, G_SPAWN_SEARCH_PATH, NULL, NULL, NULL, &error) == FALSE) {
+    girara_error("Could not start the synctex editor: %s", error->message);
+    g_error_free(error);
+  }
+  g_strfreev(arguments);
+}
 
 void
 synctex_edit(zathura_t* zathura, zathura_page_t* page, int x, int y)
@@ -71,8 +847,25 @@ synctex_edit(zathura_t* zathura, zathura_page_t* page, int x, int y)
     return;
   }
 
-  int page_idx = zathura_page_get_index(page);
-  char *buffer = g_strdup_printf("%d:%d:%d:%s", page_idx + 1, x, y, filename);
+  const unsigned int page_idx = zathura_page_get_index(page);
+
+  zathura_synctex_t* synctex = synctex_get(zathura);
+  if (zathura_synctex_update(synctex) == true) {
+    char* input = NULL;
+    unsigned int line = 0;
+    int column = -1;
+    if (zathura_synctex_backward(synctex, page_idx, x, y, &input, &line, &column) == true) {
+      synctex_open_editor(zathura, input, line, column);
+      g_free(input);
+    } else {
+      girara_debug("no source found at %d, %d on page %u", x, y, page_idx + 1);
+    }
+    return;
+  }
+
+  /* files that are not next to the document are left to the synctex
+   * command, which knows about build directories */
+  char *buffer = g_strdup_printf("%u:%d:%d:%s", page_idx + 1, x, y, filename);
 
   if (zathura->synctex.editor != NULL) {
     char* argv[] = {"synctex", "edit", "-o", buffer, "-x", zathura->synctex.editor, NULL};
@@ -86,11 +879,13 @@ synctex_edit(zathura_t* zathura, zathura_page_t* page, int x, int y)
 }
 
 static void
-synctex_record_hits(zathura_t* zathura, int page_idx, girara_list_t* hits, bool first)
+synctex_record_hits(zathura_t* zathura, unsigned int page_idx, girara_list_t* hits, bool first)
 {
-  zathura_page_t* page = zathura_document_get_page(zathura->document, page_idx-1);
-  if (page == NULL)
+  zathura_page_t* page = zathura_document_get_page(zathura->document, page_idx);
+  if (page == NULL) {
+    girara_list_free(hits);
     return;
+  }
 
   GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
   g_object_set(page_widget, "draw-links", FALSE, NULL);
@@ -102,137 +897,62 @@ synctex_record_hits(zathura_t* zathura, int page_idx, girara_list_t* hits, bool
   }
 }
 
-static double
-scan_float(GScanner* scanner)
+bool
+synctex_view(zathura_t* zathura, const char* position)
 {
-  switch (g_scanner_get_next_token(scanner)) {
-    case G_TOKEN_FLOAT:
-      return g_scanner_cur_value(scanner).v_float;
-    case G_TOKEN_INT:
-      return g_scanner_cur_value(scanner).v_int;
-    default:
-      return 0.0;
-  }
-}
-
-static bool
-synctex_view(zathura_t* zathura, char* position)
-{
-  char* filename = g_strdup(zathura_document_get_path(zathura->document));
-  char* argv[] = {"synctex", "view", "-i", position, "-o", filename, NULL};
-  gint output;
-
-  bool ret = g_spawn_async_with_pipes(NULL, argv, NULL, G_SPAWN_SEARCH_PATH | G_SPAWN_STDERR_TO_DEV_NULL, NULL, NULL, NULL, NULL, &output, NULL, NULL);
-  g_free(filename);
-
-  if (ret == false) {
+  if (zathura == NULL || zathura->document == NULL || position == NULL) {
     return false;
   }
 
-  GScanner* scanner = g_scanner_new(&scanner_config);
-  token_t* tokens = scanner_tokens;
-  while (tokens->name != NULL) {
-    g_scanner_add_symbol(scanner, tokens->name, GINT_TO_POINTER(tokens->token));
-    tokens++;
+  char* input = NULL;
+  unsigned int line = 0;
+  int column = -1;
+  if (synctex_parse_position(position, &input, &line, &column) == false) {
+    girara_error("Invalid synctex position '%s'.", position);
+    return false;
   }
 
-  g_scanner_input_file(scanner, output);
-
-  bool found_begin = false, found_end = false;
-  while (found_begin == false && found_end == false) {
-    switch (g_scanner_get_next_token(scanner)) {
-      case G_TOKEN_EOF:
-        found_end = true;
-        break;
-
-      case G_TOKEN_SYMBOL:
-        switch (GPOINTER_TO_INT(g_scanner_cur_value(scanner).v_identifier)) {
-          case SYNCTEX_RESULT_BEGIN:
-            found_begin = true;
-            break;
-        }
-        break;
-
-      default:
-        /* skip everything else */
-        break;
-    }
+  girara_list_t* boxes = zathura_synctex_forward(synctex_get(zathura), input, line);
+  g_free(input);
+  if (boxes == NULL) {
+    girara_debug("nothing has been typeset from '%s'", position);
+    return false;
   }
 
-  if (found_begin == true) {
-    unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
-    for (unsigned int page_id = 0; page_id < number_of_pages; ++page_id) {
-      zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
-      if (page == NULL) {
-        continue;
-      }
-      g_object_set(zathura_page_get_widget(zathura, page), "search-results", NULL, NULL);
+  /* remove the results of the previous search */
+  unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  for (unsigned int page_id = 0; page_id < number_of_pages; ++page_id) {
+    zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
+    if (page == NULL) {
+      continue;
     }
+    g_object_set(zathura_page_get_widget(zathura, page), "search-results", NULL, NULL);
   }
 
-  ret = false;
-  int page = -1, nextpage;
+  /* the boxes are ordered by page */
+  bool first = true;
+  unsigned int page = 0;
   girara_list_t* hitlist = NULL;
-  zathura_rectangle_t* rectangle = NULL;
-
-  while (found_end == false) {
-    switch (g_scanner_get_next_token(scanner)) {
-      case G_TOKEN_EOF:
-        found_end = true;
-        break;
-
-      case G_TOKEN_SYMBOL:
-        switch (GPOINTER_TO_INT(g_scanner_cur_value(scanner).v_identifier)) {
-          case SYNCTEX_RESULT_END:
-            found_end = true;
-            break;
-
-          case SYNCTEX_PROP_PAGE:
-            if (g_scanner_get_next_token(scanner) == G_TOKEN_INT) {
-              nextpage = g_scanner_cur_value(scanner).v_int;
-              if (page != nextpage) {
-                if (hitlist) {
-                  synctex_record_hits(zathura, page, hitlist, !ret);
-                  ret = true;
-                }
-                hitlist = girara_list_new2((girara_free_function_t) g_free);
-                page = nextpage;
-              }
-              rectangle = g_malloc0(sizeof(zathura_rectangle_t));
-              girara_list_append(hitlist, rectangle);
-            }
-            break;
-
-          case SYNCTEX_PROP_H:
-            rectangle->x1 = scan_float(scanner);
-            break;
-
-          case SYNCTEX_PROP_V:
-            rectangle->y2 = scan_float(scanner);
-            break;
-
-          case SYNCTEX_PROP_WIDTH:
-            rectangle->x2 = rectangle->x1 + scan_float(scanner);
-            break;
-
-          case SYNCTEX_PROP_HEIGHT:
-            rectangle->y1 = rectangle->y2 - scan_float(scanner);
-            break;
-        }
-        break;
-
-      default:
-        break;
+  GIRARA_LIST_FOREACH(boxes, zathura_synctex_box_t*, iter, box)
+    if (hitlist != NULL && box->page != page) {
+      synctex_record_hits(zathura, page, hitlist, first);
+      first   = false;
+      hitlist = NULL;
+    }
+    if (hitlist == NULL) {
+      hitlist = girara_list_new2(g_free);
+      page    = box->page;
     }
-  }
+
+    zathura_rectangle_t* rectangle = g_malloc(sizeof(zathura_rectangle_t));
+    *rectangle = box->rectangle;
+    girara_list_append(hitlist, rectangle);
+  GIRARA_LIST_FOREACH_END(boxes, zathura_synctex_box_t*, iter, box);
 
   if (hitlist != NULL) {
-    synctex_record_hits(zathura, page, hitlist, !ret);
-    ret = true;
+    synctex_record_hits(zathura, page, hitlist, first);
   }
+  girara_list_free(boxes);
 
-  g_scanner_destroy(scanner);
-  close(output);
-
-  return ret;
+  return true;
 }
@@ -3,8 +3,110 @@
 #ifndef SYNCTEX_H
 #define SYNCTEX_H
 
+#include <stdbool.h>
+
 #include "types.h"
 
+typedef struct zathura_synctex_s zathura_synctex_t;
+
+/**
+ * A box of the document that has been typeset from a line of the source
+ */
+typedef struct zathura_synctex_box_s
+{
+  unsigned int page; /**< Index of the page */
+  zathura_rectangle_t rectangle; /**< Position on the page in points */
+} zathura_synctex_box_t;
+
+/**
+ * Creates the SyncTeX index of a document. The index is read from the
+ * .synctex.gz or .synctex file next to the document once it is needed and
+ * read again whenever that file has changed.
+ *
+ * @param document_path Path of the document
+ * @return The index
+ */
+zathura_synctex_t* zathura_synctex_new(const char* document_path);
+
+/**
+ * Frees the SyncTeX index
+ *
+ * @param synctex The index
+ */
+void zathura_synctex_free(zathura_synctex_t* synctex);
+
+/**
+ * Reads the SyncTeX file again if it has changed since it has been read
+ *
+ * @param synctex The index
+ * @return true if the index is usable
+ */
+bool zathura_synctex_update(zathura_synctex_t* synctex);
+
+/**
+ * Looks up the boxes that have been typeset from a line of a source file
+ * (forward search). If no box belongs to the line, the boxes of the closest
+ * line that has boxes are returned.
+ *
+ * @param synctex The index
+ * @param input Path of the source file; relative paths are resolved against
+ *   the directory of the document
+ * @param line Line in the source file (starting at 1)
+ * @return List of zathura_synctex_box_t ordered by page or NULL if there are
+ *   none
+ */
+girara_list_t* zathura_synctex_forward(zathura_synctex_t* synctex,
+    const char* input, unsigned int line);
+
+/**
+ * Looks up the line of the source that has been typeset at a point of a page
+ * (backward search)
+ *
+ * @param synctex The index
+ * @param page Index of the page
+ * @param x X coordinate of the point in points
+ * @param y Y coordinate of the point in points
+ * @param input Will be set to the path of the source file (free with g_free)
+ * @param line Will be set to the line in the source file
+ * @param column Will be set to the column in the source file or -1 if it is
+ *   not known
+ * @return true if a line has been found
+ */
+bool zathura_synctex_backward(zathura_synctex_t* synctex, unsigned int page,
+    double x, double y, char** input, unsigned int* line, int* column);
+
+/**
+ * Parses a position in the source in the format of the synctex command,
+ * i.e. line:column:input
+ *
+ * @param position The position
+ * @param input Will be set to the source file (free with g_free)
+ * @param line Will be set to the line
+ * @param column Will be set to the column
+ * @return true if the position is valid
+ */
+bool synctex_parse_position(const char* position, char** input,
+    unsigned int* line, int* column);
+
+/**
+ * Opens the source of a point of a page in the synctex editor command
+ * (backward search). Without an editor command, the position is printed.
+ *
+ * @param zathura The zathura session
+ * @param page The page
+ * @param x X coordinate of the point in points
+ * @param y Y coordinate of the point in points
+ */
 void synctex_edit(zathura_t* zathura, zathura_page_t* page, int x, int y);
 
+/**
+ * Highlights the boxes that have been typeset from a position in the source
+ * and goes to the first of them (forward search)
+ *
+ * @param zathura The zathura session
+ * @param position The position in the format line:column:input
+ * @return true if a box has been found
+ */
+bool synctex_view(zathura_t* zathura, const char* position);
+
 #endif
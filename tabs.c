@@ -0,0 +1,265 @@
+/* See LICENSE file for license and copyright information */
+
+#include <sys/stat.h>
+#include <girara/datastructures.h>
+#include <girara/session.h>
+#include <girara/utils.h>
+#include <glib/gstdio.h>
+#include <glib/gi18n.h>
+
+#include "tabs.h"
+#include "document.h"
+#include "page-cache.h"
+
+/**
+ * A document that is open in a tab
+ */
+struct zathura_tab_s {
+  unsigned int id; /**< Identifies the surfaces of the document in the page cache */
+  char* path; /**< Path of the document (NULL if it is not known yet) */
+  char* password; /**< Password of the document (or NULL) */
+  zathura_document_t* document; /**< The document while it is kept open in the background (or NULL) */
+  time_t mtime; /**< Modification time of the file when the document has been kept */
+};
+
+static void
+tab_free(void* data)
+{
+  zathura_tab_t* tab = data;
+  if (tab == NULL) {
+    return;
+  }
+
+  if (tab->document != NULL) {
+    zathura_document_free(tab->document);
+  }
+  g_free(tab->path);
+  g_free(tab->password);
+  g_free(tab);
+}
+
+static zathura_tab_t*
+tab_new(zathura_t* zathura, const char* path, const char* password)
+{
+  zathura_tab_t* tab = g_malloc0(sizeof(zathura_tab_t));
+  tab->id       = zathura->tabs.next_id++;
+  tab->path     = g_strdup(path);
+  tab->password = g_strdup(password);
+
+  return tab;
+}
+
+static time_t
+tab_get_mtime(const char* path)
+{
+  GStatBuf info;
+  if (path == NULL || g_stat(path, &info) != 0) {
+    return 0;
+  }
+
+  return info.st_mtime;
+}
+
+/* the shown document becomes the first tab once a second one is opened */
+static void
+tabs_init(zathura_t* zathura)
+{
+  if (zathura->tabs.list != NULL) {
+    return;
+  }
+
+  zathura->tabs.list = girara_list_new2(tab_free);
+
+  /* the surfaces of the shown document stay valid */
+  zathura->tabs.next_id = zathura->tabs.id;
+  zathura_tab_t* tab = tab_new(zathura, zathura->file_monitor.file_path,
+      zathura->file_monitor.password);
+  girara_list_append(zathura->tabs.list, tab);
+  zathura->tabs.current = tab;
+}
+
+static int
+tab_get_index(zathura_t* zathura, zathura_tab_t* tab)
+{
+  const size_t size = girara_list_size(zathura->tabs.list);
+  for (size_t i = 0; i < size; i++) {
+    if (girara_list_nth(zathura->tabs.list, i) == tab) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+/* keeps the shown document open in its tab */
+static void
+tab_park(zathura_t* zathura)
+{
+  zathura_tab_t* tab = zathura->tabs.current;
+  if (tab == NULL || zathura->document == NULL) {
+    return;
+  }
+
+  /* the document might have been replaced by :open */
+  g_free(tab->path);
+  g_free(tab->password);
+  tab->path     = g_strdup(zathura_document_get_path(zathura->document));
+  tab->password = g_strdup(zathura->file_monitor.password);
+  tab->mtime    = tab_get_mtime(tab->path);
+
+  tab->document = document_park(zathura);
+}
+
+static bool
+tab_show(zathura_t* zathura, zathura_tab_t* tab)
+{
+  zathura->tabs.current = tab;
+  zathura->tabs.id      = tab->id;
+
+  zathura_document_t* document = tab->document;
+  tab->document = NULL;
+
+  /* the file is not monitored while the tab is in the background */
+  if (document != NULL && tab_get_mtime(tab->path) != tab->mtime) {
+    girara_debug("'%s' has changed in the background", tab->path);
+    zathura_page_cache_remove_document(zathura->page_cache, tab->id);
+    zathura_document_free(document);
+    document = NULL;
+  }
+
+  if (document != NULL) {
+    return document_resume(zathura, document, tab->password);
+  }
+
+  if (tab->path == NULL) {
+    return false;
+  }
+
+  return document_open(zathura, tab->path, tab->password, ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+}
+
+bool
+tab_open(zathura_t* zathura, const char* path, const char* password)
+{
+  if (zathura == NULL || path == NULL) {
+    return false;
+  }
+
+  /* there is nothing to keep */
+  if (zathura->document == NULL && zathura->tabs.list == NULL) {
+    return document_open(zathura, path, password, ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+  }
+
+  tabs_init(zathura);
+  zathura_tab_t* previous = zathura->tabs.current;
+  tab_park(zathura);
+
+  zathura_tab_t* tab = tab_new(zathura, path, password);
+  girara_list_append(zathura->tabs.list, tab);
+  if (tab_show(zathura, tab) == true) {
+    return true;
+  }
+
+  /* go back to the document that has been shown */
+  girara_list_remove(zathura->tabs.list, tab);
+  if (previous != NULL) {
+    tab_show(zathura, previous);
+  }
+
+  return false;
+}
+
+void
+tab_add(zathura_t* zathura, const char* path, const char* password)
+{
+  if (zathura == NULL || path == NULL) {
+    return;
+  }
+
+  tabs_init(zathura);
+  girara_list_append(zathura->tabs.list, tab_new(zathura, path, password));
+}
+
+bool
+tab_switch(zathura_t* zathura, int offset)
+{
+  if (zathura == NULL || zathura->tabs.list == NULL) {
+    return false;
+  }
+
+  const int size  = girara_list_size(zathura->tabs.list);
+  const int index = tab_get_index(zathura, zathura->tabs.current);
+  if (size < 2 || index < 0) {
+    return false;
+  }
+
+  const int target = ((index + offset) % size + size) % size;
+  if (target == index) {
+    return true;
+  }
+
+  tab_park(zathura);
+
+  zathura_tab_t* tab = girara_list_nth(zathura->tabs.list, target);
+  if (tab_show(zathura, tab) == false) {
+    girara_notify(zathura->ui.session, GIRARA_ERROR, _("Could not open '%s'."),
+        tab->path != NULL ? tab->path : "");
+    return false;
+  }
+
+  return true;
+}
+
+void
+tab_close(zathura_t* zathura)
+{
+  if (zathura == NULL) {
+    return;
+  }
+
+  document_close(zathura, false);
+
+  zathura_tab_t* tab = zathura->tabs.current;
+  if (zathura->tabs.list == NULL || tab == NULL) {
+    return;
+  }
+
+  const int index = tab_get_index(zathura, tab);
+  girara_list_remove(zathura->tabs.list, tab);
+  zathura->tabs.current = NULL;
+
+  const int size = girara_list_size(zathura->tabs.list);
+  if (size == 0) {
+    girara_list_free(zathura->tabs.list);
+    zathura->tabs.list = NULL;
+    return;
+  }
+
+  tab = girara_list_nth(zathura->tabs.list, MIN(MAX(index, 0), size - 1));
+  if (tab_show(zathura, tab) == false) {
+    girara_notify(zathura->ui.session, GIRARA_ERROR, _("Could not open '%s'."),
+        tab->path != NULL ? tab->path : "");
+  }
+}
+
+unsigned int
+tab_count(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->tabs.list == NULL) {
+    return 0;
+  }
+
+  return girara_list_size(zathura->tabs.list);
+}
+
+void
+tabs_free(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->tabs.list == NULL) {
+    return;
+  }
+
+  girara_list_free(zathura->tabs.list);
+  zathura->tabs.list    = NULL;
+  zathura->tabs.current = NULL;
+}
@@ -0,0 +1,63 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef TABS_H
+#define TABS_H
+
+#include <stdbool.h>
+
+#include "zathura.h"
+
+/**
+ * Opens a document in a new tab and shows it. The shown document is kept open
+ * in its tab, so that switching back to it neither opens nor renders it
+ * again as long as its surfaces are still in the page cache.
+ *
+ * @param zathura The zathura session
+ * @param path The path of the document
+ * @param password The password of the document (or NULL)
+ * @return If no error occured true, otherwise false, is returned.
+ */
+bool tab_open(zathura_t* zathura, const char* path, const char* password);
+
+/**
+ * Adds a tab for a document without showing it. The document is opened once
+ * the tab is shown for the first time.
+ *
+ * @param zathura The zathura session
+ * @param path The path of the document
+ * @param password The password of the document (or NULL)
+ */
+void tab_add(zathura_t* zathura, const char* path, const char* password);
+
+/**
+ * Shows the document of another tab
+ *
+ * @param zathura The zathura session
+ * @param offset Number of tabs to move forward (or backward if negative)
+ * @return If no error occured true, otherwise false, is returned.
+ */
+bool tab_switch(zathura_t* zathura, int offset);
+
+/**
+ * Closes the shown document and its tab and shows the next tab
+ *
+ * @param zathura The zathura session
+ */
+void tab_close(zathura_t* zathura);
+
+/**
+ * Returns the number of tabs
+ *
+ * @param zathura The zathura session
+ * @return The number of tabs (0 if no tabs have been opened)
+ */
+unsigned int tab_count(zathura_t* zathura);
+
+/**
+ * Frees all tabs and the documents they keep open
+ *
+ * @param zathura The zathura session
+ */
+void tabs_free(zathura_t* zathura);
+
+#endif // TABS_H
@@ -0,0 +1,126 @@
+/* See LICENSE file for license and copyright information */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#include "bench-compare.h"
+
+/**
+ * A sample of either run
+ */
+typedef struct bench_sample_s {
+  double value; /**< The sample */
+  bool current; /**< The sample belongs to the current run */
+} bench_sample_t;
+
+static int
+bench_compare_doubles(const void* a, const void* b)
+{
+  const double lhs = *(const double*) a;
+  const double rhs = *(const double*) b;
+
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+static int
+bench_compare_samples(const void* a, const void* b)
+{
+  return bench_compare_doubles(&((const bench_sample_t*) a)->value,
+      &((const bench_sample_t*) b)->value);
+}
+
+double
+bench_median(const double* samples, unsigned int n)
+{
+  if (samples == NULL || n == 0) {
+    return 0;
+  }
+
+  double* sorted = g_malloc_n(n, sizeof(double));
+  memcpy(sorted, samples, n * sizeof(double));
+  qsort(sorted, n, sizeof(double), bench_compare_doubles);
+
+  const double median = (n % 2 == 1) ? sorted[n / 2] :
+    (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+  g_free(sorted);
+
+  return median;
+}
+
+double
+bench_mann_whitney(const double* baseline, unsigned int n_baseline,
+    const double* current, unsigned int n_current)
+{
+  if (baseline == NULL || current == NULL || n_baseline == 0 || n_current == 0) {
+    return 1;
+  }
+
+  const unsigned int n = n_baseline + n_current;
+  bench_sample_t* samples = g_malloc_n(n, sizeof(bench_sample_t));
+  for (unsigned int i = 0; i < n_baseline; i++) {
+    samples[i].value   = baseline[i];
+    samples[i].current = false;
+  }
+  for (unsigned int i = 0; i < n_current; i++) {
+    samples[n_baseline + i].value   = current[i];
+    samples[n_baseline + i].current = true;
+  }
+  qsort(samples, n, sizeof(bench_sample_t), bench_compare_samples);
+
+  /* equal samples share the mean of their ranks */
+  double rank_sum = 0;
+  double ties     = 0;
+  for (unsigned int i = 0; i < n;) {
+    unsigned int j = i + 1;
+    while (j < n && samples[j].value == samples[i].value) {
+      j++;
+    }
+
+    const double rank = (i + 1 + j) / 2.0;
+    for (unsigned int k = i; k < j; k++) {
+      if (samples[k].current == true) {
+        rank_sum += rank;
+      }
+    }
+
+    const double t = j - i;
+    ties += t * t * t - t;
+    i = j;
+  }
+  g_free(samples);
+
+  const double n1       = n_current;
+  const double n2       = n_baseline;
+  const double u        = rank_sum - n1 * (n1 + 1) / 2;
+  const double mean     = n1 * n2 / 2;
+  const double variance = n1 * n2 / 12 * ((n + 1) - ties / ((double) n * (n - 1)));
+  if (variance <= 0) {
+    /* all samples are equal */
+    return 1;
+  }
+
+  const double z = (u - mean - 0.5) / sqrt(variance);
+  return 0.5 * erfc(z / sqrt(2));
+}
+
+bool
+bench_is_regression(const double* baseline, unsigned int n_baseline,
+    const double* current, unsigned int n_current, double significance,
+    double threshold, double* p_value, double* change)
+{
+  const double p          = bench_mann_whitney(baseline, n_baseline, current, n_current);
+  const double old_median = bench_median(baseline, n_baseline);
+  const double new_median = bench_median(current, n_current);
+  const double relative   = old_median > 0 ? (new_median - old_median) / old_median : 0;
+
+  if (p_value != NULL) {
+    *p_value = p;
+  }
+  if (change != NULL) {
+    *change = relative;
+  }
+
+  return p <= significance && relative > threshold;
+}
@@ -0,0 +1,54 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef BENCH_COMPARE_H
+#define BENCH_COMPARE_H
+
+#include <stdbool.h>
+
+/**
+ * Returns the median of the samples
+ *
+ * @param samples The samples
+ * @param n Number of samples
+ * @return The median (0 if there are no samples)
+ */
+double bench_median(const double* samples, unsigned int n);
+
+/**
+ * Tests whether the current samples are larger than the baseline samples
+ * with the one-sided Mann-Whitney U test. The normal approximation with
+ * corrections for ties and continuity is used, so no assumption about the
+ * distribution of the durations is made.
+ *
+ * @param baseline Samples of the baseline
+ * @param n_baseline Number of samples of the baseline
+ * @param current Samples of the current run
+ * @param n_current Number of samples of the current run
+ * @return Probability of samples that are at least as large as the current
+ *   ones if both have the same distribution (1 if there are no samples)
+ */
+double bench_mann_whitney(const double* baseline, unsigned int n_baseline,
+    const double* current, unsigned int n_current);
+
+/**
+ * Decides whether the current samples are a regression of the baseline. A
+ * regression has to be statistically significant and its median has to be
+ * slower by more than the threshold, so that neither noise nor tiny but
+ * consistent differences fail a run.
+ *
+ * @param baseline Samples of the baseline
+ * @param n_baseline Number of samples of the baseline
+ * @param current Samples of the current run
+ * @param n_current Number of samples of the current run
+ * @param significance Largest p-value that is considered significant
+ * @param threshold Smallest relative slowdown of the median, e.g. 0.05
+ * @param p_value Will be set to the p-value of the test (may be NULL)
+ * @param change Will be set to the relative change of the median (may be
+ *   NULL)
+ * @return true if the current samples are a regression
+ */
+bool bench_is_regression(const double* baseline, unsigned int n_baseline,
+    const double* current, unsigned int n_current, double significance,
+    double threshold, double* p_value, double* change);
+
+#endif // BENCH_COMPARE_H
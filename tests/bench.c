@@ -0,0 +1,887 @@
+/* See LICENSE file for license and copyright information */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cairo.h>
+#include <glib/gstdio.h>
+#include <girara/datastructures.h>
+#include <girara/utils.h>
+
+#include "../glib-compat.h"
+#include "../document.h"
+#include "../page.h"
+#include "../plugin.h"
+#include "../internal.h"
+#include "../recolor.h"
+#include "../text-index.h"
+#include "../database-plain.h"
+#ifdef WITH_SQLITE
+#include "../database-sqlite.h"
+#endif
+#include "../synctex.h"
+#include "bench-compare.h"
+
+/* number of bookmarks the database benchmark adds per iteration */
+#define BENCH_BOOKMARKS 100
+/* points of each page the backward search of the synctex benchmark looks up */
+#define BENCH_SYNCTEX_GRID 3
+
+/**
+ * Settings of a benchmark run
+ */
+typedef struct bench_options_s {
+  double* scales; /**< Scales the pages are rendered at */
+  unsigned int number_of_scales; /**< Number of scales */
+  unsigned int* threads; /**< Thread counts the pages are rendered with */
+  unsigned int number_of_threads; /**< Number of thread counts */
+  unsigned int iterations; /**< Repetitions of each benchmark */
+  unsigned int max_pages; /**< Number of pages to use (0 for all) */
+  const char* query; /**< Text that is searched */
+  const char* document; /**< Document that is benchmarked */
+  GKeyFile* results; /**< Samples of all benchmarks, grouped by document */
+} bench_options_t;
+
+/**
+ * Shared state of the render threads
+ */
+typedef struct bench_render_s {
+  zathura_document_t* document; /**< The document */
+  unsigned int number_of_pages; /**< Pages to render */
+  double scale; /**< Scale the pages are rendered at */
+  gint next_page; /**< Next page to render */
+  bool serialize; /**< Plugin requires pages to be rendered one at a time */
+  mutex lock; /**< Serializes the plugin */
+  mutex times_lock; /**< Protects times */
+  GArray* times; /**< Durations of the renders in microseconds */
+  gint failed; /**< Number of failed renders */
+} bench_render_t;
+
+static gint
+bench_compare_times(gconstpointer a, gconstpointer b)
+{
+  const gint64 time_a = *(const gint64*) a;
+  const gint64 time_b = *(const gint64*) b;
+
+  return time_a < time_b ? -1 : (time_a > time_b ? 1 : 0);
+}
+
+/* documents are identified by their path in the results, but groups of key
+ * files cannot contain brackets */
+static char*
+bench_get_group(const char* document)
+{
+  return g_strdelimit(g_strdup(document), "[]", '_');
+}
+
+/* adds the durations to the samples of a benchmark */
+static void
+bench_record_times(const bench_options_t* options, const char* key, GArray* times)
+{
+  if (options->results == NULL || times->len == 0) {
+    return;
+  }
+
+  char* group    = bench_get_group(options->document);
+  gsize n_old    = 0;
+  double* old    = g_key_file_get_double_list(options->results, group, key, &n_old, NULL);
+  double* values = g_malloc_n(n_old + times->len, sizeof(double));
+
+  for (gsize i = 0; i < n_old; i++) {
+    values[i] = old[i];
+  }
+  for (guint i = 0; i < times->len; i++) {
+    values[n_old + i] = g_array_index(times, gint64, i);
+  }
+  g_key_file_set_double_list(options->results, group, key, values, n_old + times->len);
+
+  g_free(values);
+  g_free(old);
+  g_free(group);
+}
+
+/* prints the summary of the measured durations as the rest of a JSON object
+ * whose first members have already been printed, and records them as the
+ * samples of the benchmark called key */
+static void
+bench_print_times(const bench_options_t* options, const char* key, GArray* times,
+    gint64 wall)
+{
+  bench_record_times(options, key, times);
+  g_array_sort(times, bench_compare_times);
+
+  gint64 total = 0;
+  for (guint i = 0; i < times->len; i++) {
+    total += g_array_index(times, gint64, i);
+  }
+
+  const gint64 min    = times->len > 0 ? g_array_index(times, gint64, 0) : 0;
+  const gint64 max    = times->len > 0 ? g_array_index(times, gint64, times->len - 1) : 0;
+  const gint64 median = times->len > 0 ? g_array_index(times, gint64, times->len / 2) : 0;
+  const gint64 mean   = times->len > 0 ? total / (gint64) times->len : 0;
+
+  char* document = g_strescape(options->document, NULL);
+  printf(", \"document\": \"%s\", \"count\": %u, \"wall_us\": %" G_GINT64_FORMAT ", \"total_us\": %"
+      G_GINT64_FORMAT ", \"min_us\": %" G_GINT64_FORMAT ", \"median_us\": %"
+      G_GINT64_FORMAT ", \"mean_us\": %" G_GINT64_FORMAT ", \"max_us\": %"
+      G_GINT64_FORMAT "}\n", document, times->len, wall, total, min, median,
+      mean, max);
+  fflush(stdout);
+  g_free(document);
+}
+
+static cairo_surface_t*
+bench_render_page(zathura_page_t* page, double scale, bench_render_t* render)
+{
+  const unsigned int width  = ceil(zathura_page_get_width(page) * scale);
+  const unsigned int height = ceil(zathura_page_get_height(page) * scale);
+  if (width == 0 || height == 0) {
+    return NULL;
+  }
+
+  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+
+  cairo_t* cairo = cairo_create(surface);
+  cairo_set_source_rgb(cairo, 1, 1, 1);
+  cairo_paint(cairo);
+  cairo_scale(cairo, scale, scale);
+
+  if (render != NULL && render->serialize == true) {
+    mutex_lock(&render->lock);
+  }
+  const zathura_error_t error = zathura_page_render(page, cairo, false);
+  if (render != NULL && render->serialize == true) {
+    mutex_unlock(&render->lock);
+  }
+  cairo_destroy(cairo);
+
+  if (error != ZATHURA_ERROR_OK) {
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+
+  return surface;
+}
+
+static gpointer
+bench_render_thread(gpointer data)
+{
+  bench_render_t* render = data;
+
+  unsigned int page_id = 0;
+  while ((page_id = g_atomic_int_add(&render->next_page, 1)) < render->number_of_pages) {
+    zathura_page_t* page = zathura_document_get_page(render->document, page_id);
+
+    const gint64 start = g_get_monotonic_time();
+    cairo_surface_t* surface = bench_render_page(page, render->scale, render);
+    const gint64 duration = g_get_monotonic_time() - start;
+
+    if (surface == NULL) {
+      g_atomic_int_inc(&render->failed);
+      continue;
+    }
+    cairo_surface_destroy(surface);
+
+    mutex_lock(&render->times_lock);
+    g_array_append_val(render->times, duration);
+    mutex_unlock(&render->times_lock);
+  }
+
+  return NULL;
+}
+
+static void
+bench_render(zathura_document_t* document, unsigned int number_of_pages,
+    const bench_options_t* options, bool serialize)
+{
+  for (unsigned int s = 0; s < options->number_of_scales; s++) {
+    for (unsigned int t = 0; t < options->number_of_threads; t++) {
+      for (unsigned int i = 0; i < options->iterations; i++) {
+        bench_render_t render = {
+          .document        = document,
+          .number_of_pages = number_of_pages,
+          .scale           = options->scales[s],
+          .next_page       = 0,
+          .serialize       = serialize,
+          .times           = g_array_new(FALSE, FALSE, sizeof(gint64)),
+          .failed          = 0
+        };
+        mutex_init(&render.lock);
+        mutex_init(&render.times_lock);
+
+        const unsigned int number_of_threads = options->threads[t];
+        GThread** threads = g_malloc0(number_of_threads * sizeof(GThread*));
+
+        const gint64 start = g_get_monotonic_time();
+        for (unsigned int n = 0; n < number_of_threads; n++) {
+          threads[n] = thread_new("bench-render", bench_render_thread, &render);
+        }
+        for (unsigned int n = 0; n < number_of_threads; n++) {
+          g_thread_join(threads[n]);
+        }
+        const gint64 wall = g_get_monotonic_time() - start;
+
+        char scale[G_ASCII_DTOSTR_BUF_SIZE];
+        g_ascii_formatd(scale, sizeof(scale), "%g", options->scales[s]);
+        printf("{\"benchmark\": \"render\", \"scale\": %s, \"threads\": %u, "
+            "\"serialized\": %s, \"iteration\": %u, \"failed\": %d", scale,
+            number_of_threads, serialize == true ? "true" : "false", i,
+            g_atomic_int_get(&render.failed));
+        char* key = g_strdup_printf("render-%s-%u", scale, number_of_threads);
+        bench_print_times(options, key, render.times, wall);
+        g_free(key);
+
+        g_free(threads);
+        g_array_free(render.times, TRUE);
+        mutex_free(&render.times_lock);
+        mutex_free(&render.lock);
+      }
+    }
+  }
+}
+
+static void
+bench_recolor(zathura_document_t* document, const bench_options_t* options)
+{
+  cairo_surface_t* surface = bench_render_page(zathura_document_get_page(document, 0), 1.0, NULL);
+  if (surface == NULL) {
+    girara_error("could not render the first page for the recolor benchmark");
+    return;
+  }
+
+  GdkColor dark  = { 0, 0x0000, 0x0000, 0x0000 };
+  GdkColor light = { 0, 0xffff, 0xffff, 0xffff };
+  const int width  = cairo_image_surface_get_width(surface);
+  const int height = cairo_image_surface_get_height(surface);
+
+  for (unsigned int keep_hue = 0; keep_hue < 2; keep_hue++) {
+    zathura_recolor_t recolor;
+    zathura_recolor_init(&recolor, &dark, &light, keep_hue == 1);
+
+    GArray* times = g_array_new(FALSE, FALSE, sizeof(gint64));
+    const gint64 start = g_get_monotonic_time();
+    for (unsigned int i = 0; i < options->iterations; i++) {
+      const gint64 begin = g_get_monotonic_time();
+      zathura_recolor_image(&recolor, cairo_image_surface_get_data(surface),
+          width, height, cairo_image_surface_get_stride(surface));
+      const gint64 duration = g_get_monotonic_time() - begin;
+      g_array_append_val(times, duration);
+    }
+    const gint64 wall = g_get_monotonic_time() - start;
+
+    printf("{\"benchmark\": \"recolor\", \"keep_hue\": %s, \"width\": %d, \"height\": %d",
+        keep_hue == 1 ? "true" : "false", width, height);
+    bench_print_times(options, keep_hue == 1 ? "recolor-keep-hue" : "recolor", times, wall);
+    g_array_free(times, TRUE);
+  }
+
+  cairo_surface_destroy(surface);
+}
+
+static void
+bench_search(zathura_document_t* document, unsigned int number_of_pages,
+    const bench_options_t* options)
+{
+  for (unsigned int i = 0; i < options->iterations; i++) {
+    GArray* times = g_array_new(FALSE, FALSE, sizeof(gint64));
+    unsigned int results = 0;
+
+    const gint64 start = g_get_monotonic_time();
+    for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+      zathura_page_t* page = zathura_document_get_page(document, page_id);
+
+      const gint64 begin = g_get_monotonic_time();
+      girara_list_t* list = zathura_page_search_text(page, options->query, NULL);
+      const gint64 duration = g_get_monotonic_time() - begin;
+      g_array_append_val(times, duration);
+
+      if (list != NULL) {
+        results += girara_list_size(list);
+        girara_list_free(list);
+      }
+    }
+    const gint64 wall = g_get_monotonic_time() - start;
+
+    printf("{\"benchmark\": \"search\", \"iteration\": %u, \"results\": %u", i, results);
+    bench_print_times(options, "search", times, wall);
+    g_array_free(times, TRUE);
+  }
+}
+
+static void
+bench_text_index(zathura_document_t* document, unsigned int number_of_pages,
+    const bench_options_t* options)
+{
+  for (unsigned int i = 0; i < options->iterations; i++) {
+    zathura_text_index_t* index = zathura_text_index_new(
+        zathura_document_get_path(document), 0, 0, number_of_pages);
+    GArray* times = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+    const gint64 start = g_get_monotonic_time();
+    for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+      zathura_page_t* page = zathura_document_get_page(document, page_id);
+      zathura_rectangle_t rectangle = {
+        .x1 = 0,
+        .y1 = 0,
+        .x2 = zathura_page_get_width(page),
+        .y2 = zathura_page_get_height(page)
+      };
+
+      const gint64 begin = g_get_monotonic_time();
+      char* text = zathura_page_get_text(page, rectangle, NULL);
+      if (text != NULL) {
+        zathura_text_index_set_page(index, page_id, text);
+        g_free(text);
+      }
+      const gint64 duration = g_get_monotonic_time() - begin;
+      g_array_append_val(times, duration);
+    }
+    const gint64 wall = g_get_monotonic_time() - start;
+
+    printf("{\"benchmark\": \"text-index\", \"iteration\": %u", i);
+    bench_print_times(options, "text-index", times, wall);
+    g_array_free(times, TRUE);
+    zathura_text_index_free(index);
+  }
+}
+
+static void
+bench_outline(zathura_document_t* document, const bench_options_t* options)
+{
+  GArray* times = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+  const gint64 start = g_get_monotonic_time();
+  for (unsigned int i = 0; i < options->iterations; i++) {
+    const gint64 begin = g_get_monotonic_time();
+    girara_tree_node_t* index = zathura_document_index_generate(document, NULL);
+    const gint64 duration = g_get_monotonic_time() - begin;
+    g_array_append_val(times, duration);
+
+    if (index != NULL) {
+      girara_node_free(index);
+    }
+  }
+  const gint64 wall = g_get_monotonic_time() - start;
+
+  printf("{\"benchmark\": \"outline\"");
+  bench_print_times(options, "outline", times, wall);
+  g_array_free(times, TRUE);
+}
+
+static void
+bench_add_time(GArray* times, gint64 begin)
+{
+  const gint64 duration = g_get_monotonic_time() - begin;
+  g_array_append_val(times, duration);
+}
+
+static zathura_database_t*
+bench_database_open(const char* backend, const char* directory)
+{
+#ifdef WITH_SQLITE
+  if (g_strcmp0(backend, "sqlite") == 0) {
+    char* path = g_build_filename(directory, "bookmarks.sqlite", NULL);
+    zathura_database_t* database = zathura_sqldatabase_new(path);
+    g_free(path);
+    return database;
+  }
+#endif
+
+  return zathura_plaindatabase_new(directory);
+}
+
+static void
+bench_remove_directory(const char* path)
+{
+  GDir* dir = g_dir_open(path, 0, NULL);
+  if (dir != NULL) {
+    const char* name = NULL;
+    while ((name = g_dir_read_name(dir)) != NULL) {
+      char* file = g_build_filename(path, name, NULL);
+      g_remove(file);
+      g_free(file);
+    }
+    g_dir_close(dir);
+  }
+
+  g_rmdir(path);
+}
+
+static void
+bench_database(const char* backend, const bench_options_t* options)
+{
+  char* directory = g_dir_make_tmp("zathura-bench-XXXXXX", NULL);
+  if (directory == NULL) {
+    girara_error("could not create a directory for the database benchmark");
+    return;
+  }
+
+  const char* operations[] = { "add-bookmark", "load-bookmarks",
+    "remove-bookmark", "set-fileinfo", "get-fileinfo", "close" };
+  GArray* times[G_N_ELEMENTS(operations)];
+  for (unsigned int o = 0; o < G_N_ELEMENTS(operations); o++) {
+    times[o] = g_array_new(FALSE, FALSE, sizeof(gint64));
+  }
+
+  /* the database is opened again in every iteration, so that the files that
+   * have been written in the previous one are read */
+  const gint64 start = g_get_monotonic_time();
+  for (unsigned int i = 0; i < options->iterations; i++) {
+    zathura_database_t* database = bench_database_open(backend, directory);
+    if (database == NULL) {
+      girara_error("could not open the %s database", backend);
+      break;
+    }
+
+    for (unsigned int b = 0; b < BENCH_BOOKMARKS; b++) {
+      zathura_bookmark_t bookmark = { g_strdup_printf("bench-%u", b), b + 1 };
+      const gint64 begin = g_get_monotonic_time();
+      zathura_db_add_bookmark(database, options->document, &bookmark);
+      bench_add_time(times[0], begin);
+      g_free(bookmark.id);
+    }
+
+    gint64 begin = g_get_monotonic_time();
+    girara_list_t* bookmarks = zathura_db_load_bookmarks(database, options->document);
+    bench_add_time(times[1], begin);
+    if (bookmarks != NULL) {
+      girara_list_free(bookmarks);
+    }
+
+    for (unsigned int b = 0; b < BENCH_BOOKMARKS; b++) {
+      char* id = g_strdup_printf("bench-%u", b);
+      begin = g_get_monotonic_time();
+      zathura_db_remove_bookmark(database, options->document, id);
+      bench_add_time(times[2], begin);
+      g_free(id);
+    }
+
+    zathura_fileinfo_t file_info = { i, 0, 1.0, 0, 1, 1, 0, 0 };
+    begin = g_get_monotonic_time();
+    zathura_db_set_fileinfo(database, options->document, &file_info);
+    bench_add_time(times[3], begin);
+
+    begin = g_get_monotonic_time();
+    zathura_db_get_fileinfo(database, options->document, &file_info);
+    bench_add_time(times[4], begin);
+
+    /* the plain database writes its files once it is closed */
+    begin = g_get_monotonic_time();
+    g_object_unref(database);
+    bench_add_time(times[5], begin);
+  }
+  const gint64 wall = g_get_monotonic_time() - start;
+
+  for (unsigned int o = 0; o < G_N_ELEMENTS(operations); o++) {
+    printf("{\"benchmark\": \"database\", \"backend\": \"%s\", \"operation\": \"%s\"",
+        backend, operations[o]);
+    char* key = g_strdup_printf("database-%s-%s", backend, operations[o]);
+    bench_print_times(options, key, times[o], wall);
+    g_free(key);
+    g_array_free(times[o], TRUE);
+  }
+
+  bench_remove_directory(directory);
+  g_free(directory);
+}
+
+static void
+bench_synctex(zathura_document_t* document, unsigned int number_of_pages,
+    const bench_options_t* options)
+{
+  zathura_synctex_t* synctex = NULL;
+  GArray* times = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+  const gint64 start = g_get_monotonic_time();
+  for (unsigned int i = 0; i < options->iterations; i++) {
+    zathura_synctex_free(synctex);
+    synctex = zathura_synctex_new(zathura_document_get_path(document));
+
+    const gint64 begin = g_get_monotonic_time();
+    const bool usable = zathura_synctex_update(synctex);
+    bench_add_time(times, begin);
+
+    /* documents without a synctex file are skipped */
+    if (usable == false) {
+      zathura_synctex_free(synctex);
+      g_array_free(times, TRUE);
+      return;
+    }
+  }
+  gint64 wall = g_get_monotonic_time() - start;
+
+  printf("{\"benchmark\": \"synctex\", \"operation\": \"parse\"");
+  bench_print_times(options, "synctex-parse", times, wall);
+  g_array_free(times, TRUE);
+
+  /* the lines found by the backward search are looked up again */
+  GArray* backward = g_array_new(FALSE, FALSE, sizeof(gint64));
+  GArray* forward  = g_array_new(FALSE, FALSE, sizeof(gint64));
+  unsigned int lines = 0;
+
+  const gint64 search_start = g_get_monotonic_time();
+  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+    zathura_page_t* page = zathura_document_get_page(document, page_id);
+    const double width   = zathura_page_get_width(page);
+    const double height  = zathura_page_get_height(page);
+
+    for (unsigned int n = 0; n < BENCH_SYNCTEX_GRID * BENCH_SYNCTEX_GRID; n++) {
+      const double x = width * (n % BENCH_SYNCTEX_GRID + 0.5) / BENCH_SYNCTEX_GRID;
+      const double y = height * (n / BENCH_SYNCTEX_GRID + 0.5) / BENCH_SYNCTEX_GRID;
+
+      char* input       = NULL;
+      unsigned int line = 0;
+      int column        = 0;
+      gint64 begin      = g_get_monotonic_time();
+      const bool found  = zathura_synctex_backward(synctex, page_id, x, y, &input,
+          &line, &column);
+      bench_add_time(backward, begin);
+      if (found == false) {
+        continue;
+      }
+
+      begin = g_get_monotonic_time();
+      girara_list_t* boxes = zathura_synctex_forward(synctex, input, line);
+      bench_add_time(forward, begin);
+      if (boxes != NULL) {
+        girara_list_free(boxes);
+      }
+      g_free(input);
+      ++lines;
+    }
+  }
+  wall = g_get_monotonic_time() - search_start;
+
+  printf("{\"benchmark\": \"synctex\", \"operation\": \"backward\", \"lines\": %u", lines);
+  bench_print_times(options, "synctex-backward", backward, wall);
+  printf("{\"benchmark\": \"synctex\", \"operation\": \"forward\"");
+  bench_print_times(options, "synctex-forward", forward, wall);
+
+  g_array_free(forward, TRUE);
+  g_array_free(backward, TRUE);
+  zathura_synctex_free(synctex);
+}
+
+/* compares the samples of every benchmark that is part of the baseline and
+ * returns the number of regressions */
+static unsigned int
+bench_compare_baseline(const bench_options_t* options, const char* path,
+    double significance, double threshold)
+{
+  GKeyFile* baseline = g_key_file_new();
+  GError* error      = NULL;
+  if (g_key_file_load_from_file(baseline, path, G_KEY_FILE_NONE, &error) == FALSE) {
+    girara_error("Could not read the baseline '%s': %s", path, error->message);
+    g_error_free(error);
+    g_key_file_free(baseline);
+    return 1;
+  }
+
+  unsigned int regressions = 0;
+  gchar** groups = g_key_file_get_groups(baseline, NULL);
+  for (gchar** group = groups; *group != NULL; group++) {
+    gchar** keys = g_key_file_get_keys(baseline, *group, NULL, NULL);
+    for (gchar** key = keys; keys != NULL && *key != NULL; key++) {
+      gsize n_old = 0;
+      gsize n_new = 0;
+      double* old = g_key_file_get_double_list(baseline, *group, *key, &n_old, NULL);
+      double* new = g_key_file_get_double_list(options->results, *group, *key, &n_new, NULL);
+
+      /* benchmarks that have not been run this time are not compared */
+      if (old != NULL && new != NULL) {
+        double p_value = 1;
+        double change  = 0;
+        const bool regression = bench_is_regression(old, n_old, new, n_new,
+            significance, threshold, &p_value, &change);
+
+        char* document = g_strescape(*group, NULL);
+        char number_p[G_ASCII_DTOSTR_BUF_SIZE];
+        char number_c[G_ASCII_DTOSTR_BUF_SIZE];
+        g_ascii_formatd(number_p, sizeof(number_p), "%g", p_value);
+        g_ascii_formatd(number_c, sizeof(number_c), "%g", change);
+        printf("{\"benchmark\": \"comparison\", \"document\": \"%s\", \"key\": \"%s\", "
+            "\"baseline_count\": %" G_GSIZE_FORMAT ", \"count\": %" G_GSIZE_FORMAT
+            ", \"change\": %s, \"p_value\": %s, \"regression\": %s}\n", document,
+            *key, n_old, n_new, number_c, number_p, regression == true ? "true" : "false");
+        g_free(document);
+
+        if (regression == true) {
+          girara_error("%s of '%s' is %.1f%% slower than the baseline (p = %g).",
+              *key, *group, change * 100, p_value);
+          ++regressions;
+        }
+      }
+
+      g_free(new);
+      g_free(old);
+    }
+    g_strfreev(keys);
+  }
+  g_strfreev(groups);
+  g_key_file_free(baseline);
+
+  fflush(stdout);
+  return regressions;
+}
+
+/* reads the documents of a corpus file: one path per line, empty lines and
+ * lines starting with # are skipped */
+static bool
+bench_read_corpus(const char* path, GPtrArray* documents)
+{
+  char* content = NULL;
+  GError* error = NULL;
+  if (g_file_get_contents(path, &content, NULL, &error) == FALSE) {
+    girara_error("Could not read the corpus '%s': %s", path, error->message);
+    g_error_free(error);
+    return false;
+  }
+
+  gchar** lines = g_strsplit(content, "\n", -1);
+  for (gchar** line = lines; *line != NULL; line++) {
+    g_strstrip(*line);
+    if (**line != '\0' && **line != '#') {
+      g_ptr_array_add(documents, g_strdup(*line));
+    }
+  }
+  g_strfreev(lines);
+  g_free(content);
+
+  return true;
+}
+
+static int
+bench_document(zathura_plugin_manager_t* plugin_manager, const char* path,
+    const char* password, const bench_options_t* options)
+{
+  GArray* times = g_array_new(FALSE, FALSE, sizeof(gint64));
+  zathura_document_t* document = NULL;
+
+  /* the document is opened once per iteration; the last one is benchmarked */
+  const gint64 start = g_get_monotonic_time();
+  for (unsigned int i = 0; i < options->iterations; i++) {
+    if (document != NULL) {
+      zathura_document_free(document);
+    }
+
+    zathura_error_t open_error = ZATHURA_ERROR_OK;
+    const gint64 begin = g_get_monotonic_time();
+    document = zathura_document_open(plugin_manager, path, password, &open_error);
+    bench_add_time(times, begin);
+
+    if (document == NULL) {
+      girara_error("Could not open '%s' (error %d).", path, open_error);
+      g_array_free(times, TRUE);
+      return -1;
+    }
+  }
+  const gint64 open_time = g_get_monotonic_time() - start;
+
+  unsigned int number_of_pages = zathura_document_get_number_of_pages(document);
+  if (options->max_pages != 0) {
+    number_of_pages = MIN(number_of_pages, options->max_pages);
+  }
+
+  /* only render pages in parallel if the plugin allows it */
+  zathura_plugin_functions_t* functions = zathura_plugin_get_functions(
+      zathura_document_get_plugin(document));
+  const bool serialize = functions == NULL ||
+    (functions->capabilities & ZATHURA_PLUGIN_CAPABILITY_THREAD_SAFE_RENDER) == 0;
+
+  printf("{\"benchmark\": \"open\", \"pages\": %u",
+      zathura_document_get_number_of_pages(document));
+  bench_print_times(options, "open", times, open_time);
+  g_array_free(times, TRUE);
+
+  /* the pages are loaded up front so that their sizes are known and loading is
+   * not measured as rendering */
+  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+    zathura_page_load(zathura_document_get_page(document, page_id));
+  }
+
+  if (number_of_pages > 0) {
+    bench_render(document, number_of_pages, options, serialize);
+    bench_recolor(document, options);
+    bench_search(document, number_of_pages, options);
+    bench_text_index(document, number_of_pages, options);
+    bench_synctex(document, number_of_pages, options);
+  }
+  bench_outline(document, options);
+
+  bench_database("plain", options);
+#ifdef WITH_SQLITE
+  bench_database("sqlite", options);
+#endif
+
+  zathura_document_free(document);
+
+  return 0;
+}
+
+/* parses a comma separated list of positive numbers */
+static double*
+bench_parse_list(const char* value, unsigned int* length)
+{
+  gchar** tokens = g_strsplit(value, ",", -1);
+  double* list   = g_malloc0((g_strv_length(tokens) + 1) * sizeof(double));
+
+  unsigned int count = 0;
+  for (gchar** token = tokens; *token != NULL; token++) {
+    const double number = g_ascii_strtod(*token, NULL);
+    if (number > 0) {
+      list[count++] = number;
+    }
+  }
+  g_strfreev(tokens);
+
+  *length = count;
+  return list;
+}
+
+int
+main(int argc, char* argv[])
+{
+#if !GLIB_CHECK_VERSION(2, 31, 0)
+  g_thread_init(NULL);
+#endif
+
+  gchar* plugin_path  = NULL;
+  gchar* password     = NULL;
+  gchar* scales       = NULL;
+  gchar* threads      = NULL;
+  gchar* query        = NULL;
+  gchar* corpus       = NULL;
+  gchar* baseline     = NULL;
+  gchar* save         = NULL;
+  int iterations      = 3;
+  int max_pages       = 0;
+  double significance = 0.05;
+  double threshold    = 0.05;
+
+  GOptionEntry entries[] = {
+    { "plugins-dir",   'p', 0, G_OPTION_ARG_STRING,   &plugin_path,  "Path to the directories containing plugins",        "path" },
+    { "password",      'w', 0, G_OPTION_ARG_STRING,   &password,     "Document password",                                 "password" },
+    { "scales",        's', 0, G_OPTION_ARG_STRING,   &scales,       "Comma separated scales (default: 0.5,1,2)",         "list" },
+    { "threads",       't', 0, G_OPTION_ARG_STRING,   &threads,      "Comma separated thread counts (default: 1,2,4)",    "list" },
+    { "iterations",    'i', 0, G_OPTION_ARG_INT,      &iterations,   "Repetitions of each benchmark (default: 3)",        "number" },
+    { "pages",         'n', 0, G_OPTION_ARG_INT,      &max_pages,    "Number of pages to use (default: all)",             "number" },
+    { "query",         'q', 0, G_OPTION_ARG_STRING,   &query,        "Text to search for (default: the)",                 "text" },
+    { "corpus",        'c', 0, G_OPTION_ARG_FILENAME, &corpus,       "File listing the documents to benchmark",           "path" },
+    { "baseline",      'b', 0, G_OPTION_ARG_FILENAME, &baseline,     "Fail on regressions of this baseline",              "path" },
+    { "save-baseline", 'o', 0, G_OPTION_ARG_FILENAME, &save,         "Save the samples as baseline",                      "path" },
+    { "significance",  'a', 0, G_OPTION_ARG_DOUBLE,   &significance, "Largest p-value of a regression (default: 0.05)",   "number" },
+    { "threshold",     'r', 0, G_OPTION_ARG_DOUBLE,   &threshold,    "Smallest slowdown of a regression (default: 0.05)", "number" },
+    { NULL, '\0', 0, 0, NULL, NULL, NULL }
+  };
+
+  GOptionContext* context = g_option_context_new(" [documents]");
+  g_option_context_add_main_entries(context, entries, NULL);
+
+  GError* error = NULL;
+  if (g_option_context_parse(context, &argc, &argv, &error) == false) {
+    girara_error("Error parsing command line arguments: %s\n", error->message);
+    g_error_free(error);
+    g_option_context_free(context);
+    return -1;
+  }
+  g_option_context_free(context);
+
+  /* the documents of the corpus are benchmarked after the given ones */
+  GPtrArray* documents = g_ptr_array_new_with_free_func(g_free);
+  for (int i = 1; i < argc; i++) {
+    g_ptr_array_add(documents, g_strdup(argv[i]));
+  }
+  if (corpus != NULL && bench_read_corpus(corpus, documents) == false) {
+    g_ptr_array_free(documents, TRUE);
+    return -1;
+  }
+  if (documents->len == 0) {
+    girara_error("At least one document has to be given.");
+    g_ptr_array_free(documents, TRUE);
+    return -1;
+  }
+
+  /* results go to stdout, so only errors are logged */
+  girara_set_debug_level(GIRARA_ERROR);
+
+  bench_options_t options = {
+    .iterations = iterations > 0 ? iterations : 1,
+    .max_pages  = max_pages > 0 ? max_pages : 0,
+    .query      = query != NULL ? query : "the",
+    .document   = NULL,
+    .results    = g_key_file_new()
+  };
+
+  options.scales = bench_parse_list(scales != NULL ? scales : "0.5,1,2", &options.number_of_scales);
+  double* thread_list = bench_parse_list(threads != NULL ? threads : "1,2,4", &options.number_of_threads);
+  options.threads = g_malloc0((options.number_of_threads + 1) * sizeof(unsigned int));
+  for (unsigned int i = 0; i < options.number_of_threads; i++) {
+    options.threads[i] = thread_list[i];
+  }
+  g_free(thread_list);
+
+  /* load plugins */
+  zathura_plugin_manager_t* plugin_manager = zathura_plugin_manager_new();
+  girara_list_t* paths = NULL;
+  if (plugin_path != NULL) {
+    paths = girara_split_path_array(plugin_path);
+  }
+#ifdef ZATHURA_PLUGINDIR
+  else {
+    paths = girara_split_path_array(ZATHURA_PLUGINDIR);
+  }
+#endif
+  if (paths != NULL) {
+    GIRARA_LIST_FOREACH(paths, char*, iter, path)
+      zathura_plugin_manager_add_dir(plugin_manager, path);
+    GIRARA_LIST_FOREACH_END(paths, char*, iter, path);
+    girara_list_free(paths);
+  }
+  zathura_plugin_manager_load(plugin_manager);
+
+  int ret = 0;
+  for (unsigned int i = 0; i < documents->len; i++) {
+    options.document = g_ptr_array_index(documents, i);
+    if (bench_document(plugin_manager, options.document, password, &options) != 0) {
+      ret = -1;
+    }
+  }
+
+  if (save != NULL) {
+    gsize length = 0;
+    char* data   = g_key_file_to_data(options.results, &length, NULL);
+    if (g_file_set_contents(save, data, length, &error) == FALSE) {
+      girara_error("Could not save the baseline '%s': %s", save, error->message);
+      g_error_free(error);
+      ret = -1;
+    }
+    g_free(data);
+  }
+
+  /* significant regressions fail the run */
+  if (baseline != NULL && ret == 0 &&
+      bench_compare_baseline(&options, baseline, significance, threshold) != 0) {
+    ret = 1;
+  }
+
+  zathura_plugin_manager_free(plugin_manager);
+  g_key_file_free(options.results);
+  g_ptr_array_free(documents, TRUE);
+  g_free(options.threads);
+  g_free(options.scales);
+  g_free(plugin_path);
+  g_free(password);
+  g_free(scales);
+  g_free(threads);
+  g_free(query);
+  g_free(corpus);
+  g_free(baseline);
+  g_free(save);
+
+  return ret;
+}
@@ -0,0 +1,69 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+
+#include "bench-compare.h"
+
+static const double baseline[] = { 100, 104, 98, 101, 97, 103, 99, 102, 100, 96 };
+static const double slower[]   = { 121, 118, 125, 119, 122, 117, 124, 120, 123, 118 };
+static const double faster[]   = { 81, 78, 85, 79, 82, 77, 84, 80, 83, 78 };
+static const double similar[]  = { 101, 99, 103, 98, 100, 102, 97, 104, 96, 101 };
+
+START_TEST(test_bench_median) {
+  const double odd[]  = { 5, 1, 3 };
+  const double even[] = { 4, 1, 3, 2 };
+
+  fail_unless(bench_median(odd, 3) == 3);
+  fail_unless(bench_median(even, 4) == 2.5);
+  fail_unless(bench_median(NULL, 0) == 0);
+
+  /* the samples are not changed */
+  fail_unless(odd[0] == 5);
+} END_TEST
+
+START_TEST(test_bench_mann_whitney) {
+  const unsigned int n = sizeof(baseline) / sizeof(baseline[0]);
+
+  fail_unless(bench_mann_whitney(baseline, n, slower, n) < 0.001);
+  fail_unless(bench_mann_whitney(baseline, n, faster, n) > 0.999);
+  fail_unless(bench_mann_whitney(baseline, n, similar, n) > 0.05);
+
+  /* equal samples are not significant */
+  fail_unless(bench_mann_whitney(baseline, n, baseline, n) > 0.4);
+  const double constant[] = { 7, 7, 7 };
+  fail_unless(bench_mann_whitney(constant, 3, constant, 3) == 1);
+
+  fail_unless(bench_mann_whitney(NULL, 0, slower, n) == 1);
+} END_TEST
+
+START_TEST(test_bench_regression) {
+  const unsigned int n = sizeof(baseline) / sizeof(baseline[0]);
+  double p_value = 1;
+  double change  = 0;
+
+  fail_unless(bench_is_regression(baseline, n, slower, n, 0.05, 0.05, &p_value, &change) == true);
+  fail_unless(p_value < 0.05);
+  fail_unless(change > 0.15 && change < 0.25);
+
+  fail_unless(bench_is_regression(baseline, n, faster, n, 0.05, 0.05, NULL, NULL) == false);
+  fail_unless(bench_is_regression(baseline, n, similar, n, 0.05, 0.05, NULL, NULL) == false);
+
+  /* significant slowdowns below the threshold are accepted */
+  fail_unless(bench_is_regression(baseline, n, slower, n, 0.05, 0.5, NULL, &change) == false);
+  fail_unless(change > 0.15);
+} END_TEST
+
+Suite* suite_bench_compare()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Benchmark comparison");
+
+  /* statistics */
+  tcase = tcase_create("statistics");
+  tcase_add_test(tcase, test_bench_median);
+  tcase_add_test(tcase, test_bench_mann_whitney);
+  tcase_add_test(tcase, test_bench_regression);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
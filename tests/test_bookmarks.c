@@ -0,0 +1,65 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+
+#include "../bookmarks.h"
+
+static zathura_bookmark_t bookmarks[] = {
+  { "e", 9 },
+  { "b", 3 },
+  { "d", 7 },
+  { "a", 3 },
+  { "c", 5 },
+};
+
+START_TEST(test_bookmarks_sort_by_page) {
+  zathura_bookmark_t* sorted[G_N_ELEMENTS(bookmarks)];
+  for (unsigned int i = 0; i < G_N_ELEMENTS(bookmarks); i++) {
+    sorted[i] = &bookmarks[i];
+  }
+
+  /* bookmarks on the same page are ordered by their id */
+  zathura_bookmarks_sort_by_page(sorted, G_N_ELEMENTS(sorted));
+  const char* expected[] = { "a", "b", "c", "d", "e" };
+  for (unsigned int i = 0; i < G_N_ELEMENTS(sorted); i++) {
+    fail_unless(g_strcmp0(sorted[i]->id, expected[i]) == 0);
+  }
+
+  zathura_bookmarks_sort_by_page(NULL, 0);
+} END_TEST
+
+START_TEST(test_bookmarks_find_page) {
+  zathura_bookmark_t* sorted[G_N_ELEMENTS(bookmarks)];
+  for (unsigned int i = 0; i < G_N_ELEMENTS(bookmarks); i++) {
+    sorted[i] = &bookmarks[i];
+  }
+  zathura_bookmarks_sort_by_page(sorted, G_N_ELEMENTS(sorted));
+  const unsigned int n = G_N_ELEMENTS(sorted);
+
+  /* the bookmarks on the page itself are skipped */
+  fail_unless(zathura_bookmarks_find_page(sorted, n, 1, true)->page == 3);
+  fail_unless(zathura_bookmarks_find_page(sorted, n, 3, true)->page == 5);
+  fail_unless(zathura_bookmarks_find_page(sorted, n, 6, true)->page == 7);
+  fail_unless(zathura_bookmarks_find_page(sorted, n, 9, true) == NULL);
+
+  fail_unless(zathura_bookmarks_find_page(sorted, n, 10, false)->page == 9);
+  fail_unless(zathura_bookmarks_find_page(sorted, n, 5, false)->page == 3);
+  fail_unless(g_strcmp0(zathura_bookmarks_find_page(sorted, n, 4, false)->id, "b") == 0);
+  fail_unless(zathura_bookmarks_find_page(sorted, n, 3, false) == NULL);
+
+  fail_unless(zathura_bookmarks_find_page(NULL, 0, 1, true) == NULL);
+} END_TEST
+
+Suite* suite_bookmarks()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Bookmarks");
+
+  /* navigation */
+  tcase = tcase_create("navigation");
+  tcase_add_test(tcase, test_bookmarks_sort_by_page);
+  tcase_add_test(tcase, test_bookmarks_find_page);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,142 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <girara/datastructures.h>
+#include <girara/input-history.h>
+
+#include "../database-plain.h"
+
+static char* directory = NULL;
+
+static void
+setup_directory(void)
+{
+  directory = g_dir_make_tmp("zathura-test-XXXXXX", NULL);
+  fail_unless(directory != NULL);
+}
+
+static void
+teardown_directory(void)
+{
+  const char* files[] = { "bookmarks", "history", "input-history" };
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    char* path = g_build_filename(directory, files[i], NULL);
+    g_remove(path);
+    g_free(path);
+  }
+  g_rmdir(directory);
+  g_free(directory);
+  directory = NULL;
+}
+
+START_TEST(test_database_plain_write_behind) {
+  zathura_database_t* db = zathura_plaindatabase_new(directory);
+  fail_unless(db != NULL);
+
+  zathura_fileinfo_t file_info = { 0 };
+  file_info.current_page = 42;
+  file_info.scale        = 1.0;
+  fail_unless(zathura_db_set_fileinfo(db, "/tmp/document.pdf", &file_info) == true);
+
+  /* the change is not written right away */
+  char* path = g_build_filename(directory, "history", NULL);
+  char* content = NULL;
+  fail_unless(g_file_get_contents(path, &content, NULL, NULL) == TRUE);
+  fail_unless(strstr(content, "/tmp/document.pdf") == NULL);
+  g_free(content);
+
+  /* but once the database is closed */
+  g_object_unref(db);
+  fail_unless(g_file_get_contents(path, &content, NULL, NULL) == TRUE);
+  fail_unless(strstr(content, "/tmp/document.pdf") != NULL);
+  g_free(content);
+  g_free(path);
+
+  db = zathura_plaindatabase_new(directory);
+  fail_unless(db != NULL);
+  zathura_fileinfo_t read_info = { 0 };
+  fail_unless(zathura_db_get_fileinfo(db, "/tmp/document.pdf", &read_info) == true);
+  fail_unless(read_info.current_page == 42);
+  g_object_unref(db);
+} END_TEST
+
+START_TEST(test_database_plain_input_history) {
+  zathura_database_t* db = zathura_plaindatabase_new(directory);
+  fail_unless(db != NULL);
+
+  GiraraInputHistoryIO* io = GIRARA_INPUT_HISTORY_IO(db);
+  girara_input_history_io_append(io, ":open a");
+  girara_input_history_io_append(io, ":open b");
+  girara_input_history_io_append(io, ":open a");
+
+  /* lines are appended, repeated lines only count at their last position */
+  girara_list_t* list = girara_input_history_io_read(io);
+  fail_unless(list != NULL);
+  fail_unless(girara_list_size(list) == 2);
+  fail_unless(g_strcmp0(girara_list_nth(list, 0), ":open b") == 0);
+  fail_unless(g_strcmp0(girara_list_nth(list, 1), ":open a") == 0);
+  girara_list_free(list);
+
+  g_object_unref(db);
+} END_TEST
+
+START_TEST(test_database_plain_input_history_compact) {
+  zathura_database_t* db    = zathura_plaindatabase_new(directory);
+  zathura_database_t* other = zathura_plaindatabase_new(directory);
+  fail_unless(db != NULL && other != NULL);
+
+  /* another instance that is about to append holds the file open */
+  char* path = g_build_filename(directory, "input-history", NULL);
+  girara_input_history_io_append(GIRARA_INPUT_HISTORY_IO(other), ":open other");
+  FILE* file = fopen(path, "a");
+  fail_unless(file != NULL);
+
+  /* repeated lines make the first handle compact the file */
+  for (unsigned int i = 0; i < 300; i++) {
+    girara_input_history_io_append(GIRARA_INPUT_HISTORY_IO(db), i % 2 == 0 ? ":open a" : ":open b");
+  }
+
+  fprintf(file, ":open held\n");
+  fclose(file);
+  girara_input_history_io_append(GIRARA_INPUT_HISTORY_IO(other), ":open last");
+
+  char* content = NULL;
+  fail_unless(g_file_get_contents(path, &content, NULL, NULL) == TRUE);
+  fail_unless(strstr(content, ":open held\n") != NULL);
+  fail_unless(strstr(content, ":open last\n") != NULL);
+  /* the file has been compacted */
+  gchar** lines = g_strsplit(content, "\n", -1);
+  fail_unless(g_strv_length(lines) < 100);
+  g_strfreev(lines);
+  g_free(content);
+
+  girara_list_t* list = girara_input_history_io_read(GIRARA_INPUT_HISTORY_IO(db));
+  fail_unless(list != NULL);
+  fail_unless(girara_list_size(list) == 5);
+  fail_unless(g_strcmp0(girara_list_nth(list, 0), ":open other") == 0);
+  fail_unless(g_strcmp0(girara_list_nth(list, 4), ":open last") == 0);
+  girara_list_free(list);
+
+  g_free(path);
+  g_object_unref(other);
+  g_object_unref(db);
+} END_TEST
+
+Suite* suite_database_plain()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Plain database");
+
+  /* write-behind of the history and the input history */
+  tcase = tcase_create("basic");
+  tcase_add_checked_fixture(tcase, setup_directory, teardown_directory);
+  tcase_add_test(tcase, test_database_plain_write_behind);
+  tcase_add_test(tcase, test_database_plain_input_history);
+  tcase_add_test(tcase, test_database_plain_input_history_compact);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
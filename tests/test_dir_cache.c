@@ -0,0 +1,145 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <girara/datastructures.h>
+
+#include "../dir-cache.h"
+
+static char* directory = NULL;
+static const char* files[] = { "Beta.pdf", "alpha.pdf", "gamma.txt", ".hidden.pdf" };
+
+static void
+setup_dir_cache(void)
+{
+  directory = g_dir_make_tmp("zathura-dir-cache-XXXXXX", NULL);
+  fail_unless(directory != NULL);
+
+  for (unsigned int i = 0; i < G_N_ELEMENTS(files); i++) {
+    char* file = g_build_filename(directory, files[i], NULL);
+    fail_unless(g_file_set_contents(file, "", -1, NULL) == TRUE);
+    g_free(file);
+  }
+
+  char* sub = g_build_filename(directory, "sub", NULL);
+  fail_unless(g_mkdir(sub, 0700) == 0);
+  g_free(sub);
+}
+
+static void
+teardown_dir_cache(void)
+{
+  for (unsigned int i = 0; i < G_N_ELEMENTS(files); i++) {
+    char* file = g_build_filename(directory, files[i], NULL);
+    g_unlink(file);
+    g_free(file);
+  }
+
+  char* file = g_build_filename(directory, "delta.pdf", NULL);
+  g_unlink(file);
+  g_free(file);
+
+  char* sub = g_build_filename(directory, "sub", NULL);
+  g_rmdir(sub);
+  g_free(sub);
+
+  g_rmdir(directory);
+  g_free(directory);
+}
+
+static unsigned int filter_calls = 0;
+
+static bool
+filter_pdf(const char* path, void* data)
+{
+  fail_unless(data == &filter_calls);
+  ++filter_calls;
+  return g_str_has_suffix(path, ".pdf") == TRUE;
+}
+
+static char*
+join_names(girara_list_t* names)
+{
+  fail_unless(names != NULL);
+
+  GString* joined = g_string_new(NULL);
+  for (size_t i = 0; i < girara_list_size(names); i++) {
+    if (i != 0) {
+      g_string_append_c(joined, ' ');
+    }
+    g_string_append(joined, girara_list_nth(names, i));
+  }
+  girara_list_free(names);
+
+  return g_string_free(joined, FALSE);
+}
+
+static void
+check_names(zathura_dir_cache_t* cache, const char* prefix, bool show_hidden,
+    bool show_directories, bool filter_files, const char* expected)
+{
+  char* names = join_names(zathura_dir_cache_list(cache, directory, prefix,
+        show_hidden, show_directories, filter_files));
+  fail_unless(g_strcmp0(names, expected) == 0, "'%s' instead of '%s'", names, expected);
+  g_free(names);
+}
+
+START_TEST(test_dir_cache_list) {
+  zathura_dir_cache_t* cache = zathura_dir_cache_new(4, filter_pdf, &filter_calls);
+  filter_calls = 0;
+
+  /* entries are listed case insensitively */
+  check_names(cache, "", false, true, false, "alpha.pdf Beta.pdf gamma.txt sub");
+  check_names(cache, ".", true, true, false, ".hidden.pdf");
+  check_names(cache, ".", false, true, false, "");
+  check_names(cache, "", false, false, false, "alpha.pdf Beta.pdf gamma.txt");
+  fail_unless(filter_calls == 0);
+
+  /* prefixes are case sensitive */
+  check_names(cache, "B", false, true, false, "Beta.pdf");
+  check_names(cache, "b", false, true, false, "");
+  check_names(cache, "gamma.txt", false, true, false, "gamma.txt");
+  check_names(cache, "gamma.txt2", false, true, false, "");
+
+  /* the filter is called once per file */
+  check_names(cache, "", false, true, true, "alpha.pdf Beta.pdf sub");
+  fail_unless(filter_calls == 3);
+  check_names(cache, "", false, true, true, "alpha.pdf Beta.pdf sub");
+  fail_unless(filter_calls == 3);
+
+  fail_unless(zathura_dir_cache_list(cache, "/does/not/exist", "", false, true, false) == NULL);
+
+  zathura_dir_cache_free(cache);
+} END_TEST
+
+START_TEST(test_dir_cache_invalidate) {
+  zathura_dir_cache_t* cache = zathura_dir_cache_new(4, NULL, NULL);
+  check_names(cache, "", false, true, false, "alpha.pdf Beta.pdf gamma.txt sub");
+
+  char* file = g_build_filename(directory, "delta.pdf", NULL);
+  fail_unless(g_file_set_contents(file, "", -1, NULL) == TRUE);
+  g_free(file);
+
+  /* the directory is read again once it is known to have changed */
+  zathura_dir_cache_invalidate(cache, directory);
+  check_names(cache, "", false, true, false, "alpha.pdf Beta.pdf delta.pdf gamma.txt sub");
+
+  zathura_dir_cache_free(cache);
+} END_TEST
+
+Suite* suite_dir_cache()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Directory cache");
+
+  /* listing */
+  tcase = tcase_create("listing");
+  tcase_add_checked_fixture(tcase, setup_dir_cache, teardown_dir_cache);
+  tcase_add_test(tcase, test_dir_cache_list);
+  tcase_add_test(tcase, test_dir_cache_invalidate);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -1,6 +1,7 @@
 /* See LICENSE file for license and copyright information */
 
 #include <check.h>
+#include <glib.h>
 
 #include "../document.h"
 
@@ -10,6 +11,32 @@ START_TEST(test_open) {
   fail_unless(zathura_document_open(NULL, "fl", "pw", NULL) == NULL, "Could create document", NULL);
 } END_TEST
 
+START_TEST(test_sniff_type) {
+  fail_unless(zathura_document_sniff_type(NULL, 0) == NULL);
+  fail_unless(g_strcmp0(zathura_document_sniff_type("%PDF-1.4\n", 9), "application/pdf") == 0);
+  fail_unless(g_strcmp0(zathura_document_sniff_type("%!PS-Adobe-3.0\n", 15), "application/postscript") == 0);
+  fail_unless(g_strcmp0(zathura_document_sniff_type("AT&TFORM\0\0\0\0DJVM", 16), "image/vnd.djvu") == 0);
+  fail_unless(zathura_document_sniff_type("AT&TFORM\0\0\0\0ABCD", 16) == NULL);
+  fail_unless(zathura_document_sniff_type("%PDF", 4) == NULL);
+  fail_unless(zathura_document_sniff_type("plain text", 10) == NULL);
+
+  /* comic books are plain archives, EPUBs name their type */
+  const char zip[] = "PK\x03\x04\x14\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x09\0\0\0page1.jpg";
+  fail_unless(g_strcmp0(zathura_document_sniff_type(zip, sizeof(zip) - 1), "application/zip") == 0);
+  const char epub[] = "PK\x03\x04\x14\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x08\0\0\0mimetypeapplication/epub+zip";
+  fail_unless(zathura_document_sniff_type(epub, sizeof(epub) - 1) == NULL);
+
+  /* office documents and XPS are zip archives as well, but no comic books */
+  const char ooxml[] = "PK\x03\x04\x14\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x13\0\0\0[Content_Types].xml";
+  fail_unless(zathura_document_sniff_type(ooxml, sizeof(ooxml) - 1) == NULL);
+  const char xps[] = "PK\x03\x04\x14\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x06\0\0\0_rels/";
+  fail_unless(zathura_document_sniff_type(xps, sizeof(xps) - 1) == NULL);
+  const char upper[] = "PK\x03\x04\x14\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\x09\0\0\0COVER.PNG";
+  fail_unless(g_strcmp0(zathura_document_sniff_type(upper, sizeof(upper) - 1), "application/zip") == 0);
+  /* a truncated name is not trusted */
+  fail_unless(zathura_document_sniff_type(zip, 35) == NULL);
+} END_TEST
+
 Suite* suite_document()
 {
   TCase* tcase = NULL;
@@ -20,5 +47,10 @@ Suite* suite_document()
   tcase_add_test(tcase, test_open);
   suite_add_tcase(suite, tcase);
 
+  /* type detection */
+  tcase = tcase_create("type");
+  tcase_add_test(tcase, test_sniff_type);
+  suite_add_tcase(suite, tcase);
+
   return suite;
 }
@@ -0,0 +1,76 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <gtk/gtk.h>
+#include <girara/datastructures.h>
+
+#include "../document-index.h"
+#include "../types.h"
+
+static girara_tree_node_t*
+create_index(void)
+{
+  girara_tree_node_t* root = girara_node_new(NULL);
+  girara_tree_node_t* a    = girara_node_append_data(root, zathura_index_element_new("A"));
+  girara_node_append_data(a, zathura_index_element_new("A1"));
+  girara_node_append_data(a, zathura_index_element_new("A2"));
+  girara_node_append_data(root, zathura_index_element_new("B"));
+
+  return root;
+}
+
+START_TEST(test_document_index_model_lazy) {
+  GtkTreeModel* model = document_index_model_new(create_index());
+  fail_unless(model != NULL);
+  fail_unless(gtk_tree_model_iter_n_children(model, NULL) == 2);
+
+  GtkTreeIter a;
+  fail_unless(gtk_tree_model_iter_nth_child(model, &a, NULL, 0) == TRUE);
+  /* only a placeholder until the entry is expanded */
+  fail_unless(gtk_tree_model_iter_n_children(model, &a) == 1);
+  GtkTreeIter child;
+  fail_unless(gtk_tree_model_iter_children(model, &child, &a) == TRUE);
+  zathura_index_element_t* element = NULL;
+  gtk_tree_model_get(model, &child, DOCUMENT_INDEX_COLUMN_ELEMENT, &element, -1);
+  fail_unless(element == NULL);
+
+  document_index_expand(model, &a);
+  fail_unless(gtk_tree_model_iter_n_children(model, &a) == 2);
+  fail_unless(gtk_tree_model_iter_nth_child(model, &child, &a, 1) == TRUE);
+  gtk_tree_model_get(model, &child, DOCUMENT_INDEX_COLUMN_ELEMENT, &element, -1);
+  fail_unless(element != NULL);
+  fail_unless(g_strcmp0(element->title, "A2") == 0);
+
+  /* expanding again does not add the children twice */
+  document_index_expand(model, &a);
+  fail_unless(gtk_tree_model_iter_n_children(model, &a) == 2);
+
+  GtkTreeIter b;
+  fail_unless(gtk_tree_model_iter_nth_child(model, &b, NULL, 1) == TRUE);
+  fail_unless(gtk_tree_model_iter_has_child(model, &b) == FALSE);
+  document_index_expand(model, &b);
+  fail_unless(gtk_tree_model_iter_has_child(model, &b) == FALSE);
+
+  /* frees the index */
+  g_object_unref(model);
+} END_TEST
+
+START_TEST(test_document_index_model_invalid) {
+  fail_unless(document_index_model_new(NULL) == NULL);
+  document_index_expand(NULL, NULL);
+  document_index_free(NULL);
+} END_TEST
+
+Suite* suite_document_index()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Document index");
+
+  /* lazily populated tree model */
+  tcase = tcase_create("model");
+  tcase_add_test(tcase, test_document_index_model_lazy);
+  tcase_add_test(tcase, test_document_index_model_invalid);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
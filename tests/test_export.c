@@ -0,0 +1,71 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <string.h>
+#include <glib.h>
+
+#include "../export.h"
+
+START_TEST(test_export_range) {
+  unsigned int first = 0;
+  unsigned int last  = 0;
+
+  fail_unless(export_parse_page_range("7", 10, &first, &last) == true);
+  fail_unless(first == 6 && last == 6);
+
+  fail_unless(export_parse_page_range("2-5", 10, &first, &last) == true);
+  fail_unless(first == 1 && last == 4);
+
+  fail_unless(export_parse_page_range("4-", 10, &first, &last) == true);
+  fail_unless(first == 3 && last == 9);
+
+  fail_unless(export_parse_page_range("all", 10, &first, &last) == true);
+  fail_unless(first == 0 && last == 9);
+} END_TEST
+
+START_TEST(test_export_range_invalid) {
+  unsigned int first = 0;
+  unsigned int last  = 0;
+
+  fail_unless(export_parse_page_range(NULL, 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("0", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("11", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("5-3", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("3-11", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("-3", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("2--3", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("2-3x", 10, &first, &last) == false);
+  fail_unless(export_parse_page_range("1", 0, &first, &last) == false);
+} END_TEST
+
+START_TEST(test_export_file_name) {
+  char* file = export_page_file_name("/tmp/export", 9, 500);
+  fail_unless(g_strcmp0(file, "/tmp/export/page-010.png") == 0);
+  g_free(file);
+
+  file = export_page_file_name("/tmp/export", 0, 5);
+  fail_unless(g_strcmp0(file, "/tmp/export/page-1.png") == 0);
+  g_free(file);
+
+  fail_unless(export_page_file_name(NULL, 0, 5) == NULL);
+} END_TEST
+
+Suite* suite_export()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Export");
+
+  /* page ranges */
+  tcase = tcase_create("range");
+  tcase_add_test(tcase, test_export_range);
+  tcase_add_test(tcase, test_export_range_invalid);
+  suite_add_tcase(suite, tcase);
+
+  /* file names */
+  tcase = tcase_create("file name");
+  tcase_add_test(tcase, test_export_file_name);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,126 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <string.h>
+#include <glib.h>
+
+#include "../history-store.h"
+
+static const char HISTORY[] =
+  "[/tmp/a.pdf]\n"
+  "page=3\n"
+  "offset=0\n"
+  "scale=1.500000\n"
+  "rotate=90\n"
+  "pages-per-row=2\n"
+  "\n"
+  "# comment\n"
+  "[/tmp/b.pdf]\n"
+  "page=7\n"
+  "position-y=12.000000\n";
+
+START_TEST(test_history_store_load) {
+  zathura_history_store_t* store = zathura_history_store_new(0);
+  fail_unless(store != NULL);
+
+  zathura_history_store_load(store, HISTORY);
+  fail_unless(zathura_history_store_size(store) == 2);
+  fail_unless(zathura_history_store_is_dirty(store) == false);
+
+  zathura_fileinfo_t info = { 0, 0, 1, 0, 1, 1, 0, 0 };
+  fail_unless(zathura_history_store_get(store, "/tmp/a.pdf", &info) == true);
+  fail_unless(info.current_page == 3);
+  fail_unless(info.rotation == 90);
+  fail_unless(info.pages_per_row == 2);
+  fail_unless(info.scale == 1.5);
+
+  /* missing values are left untouched */
+  zathura_fileinfo_t info_b = { 0, 0, 1, 0, 1, 1, 0, 0 };
+  fail_unless(zathura_history_store_get(store, "/tmp/b.pdf", &info_b) == true);
+  fail_unless(info_b.current_page == 7);
+  fail_unless(info_b.scale == 1);
+  fail_unless(info_b.position_y == 12);
+
+  fail_unless(zathura_history_store_get(store, "/tmp/c.pdf", &info) == false);
+
+  zathura_history_store_free(store);
+} END_TEST
+
+START_TEST(test_history_store_reload) {
+  zathura_history_store_t* store = zathura_history_store_new(0);
+  zathura_history_store_load(store, HISTORY);
+
+  /* a change that has not been written yet survives a reload */
+  zathura_fileinfo_t info = { 0, 0, 1, 0, 1, 1, 0, 0 };
+  info.current_page = 11;
+  zathura_history_store_set(store, "/tmp/c.pdf", &info, 100);
+  fail_unless(zathura_history_store_is_dirty(store) == true);
+
+  zathura_history_store_load(store, "[/tmp/a.pdf]\npage=5\n");
+  fail_unless(zathura_history_store_size(store) == 2);
+
+  zathura_fileinfo_t read = { 0 };
+  fail_unless(zathura_history_store_get(store, "/tmp/a.pdf", &read) == true);
+  fail_unless(read.current_page == 5);
+  fail_unless(zathura_history_store_get(store, "/tmp/b.pdf", &read) == false);
+  fail_unless(zathura_history_store_get(store, "/tmp/c.pdf", &read) == true);
+  fail_unless(read.current_page == 11);
+
+  /* written entries can be read again */
+  char* content = zathura_history_store_to_data(store, NULL);
+  fail_unless(content != NULL);
+  fail_unless(zathura_history_store_is_dirty(store) == true);
+  zathura_history_store_mark_written(store);
+  fail_unless(zathura_history_store_is_dirty(store) == false);
+
+  zathura_history_store_t* copy = zathura_history_store_new(0);
+  zathura_history_store_load(copy, content);
+  fail_unless(zathura_history_store_size(copy) == 2);
+  fail_unless(zathura_history_store_get(copy, "/tmp/c.pdf", &read) == true);
+  fail_unless(read.current_page == 11);
+  g_free(content);
+
+  zathura_history_store_free(copy);
+  zathura_history_store_free(store);
+} END_TEST
+
+START_TEST(test_history_store_limit) {
+  zathura_history_store_t* store = zathura_history_store_new(2);
+
+  zathura_fileinfo_t info = { 0, 0, 1, 0, 1, 1, 0, 0 };
+  zathura_history_store_set(store, "/tmp/a.pdf", &info, 10);
+  zathura_history_store_set(store, "/tmp/b.pdf", &info, 20);
+  zathura_history_store_set(store, "/tmp/a.pdf", &info, 30);
+  zathura_history_store_set(store, "/tmp/c.pdf", &info, 40);
+
+  /* the least recently stored document is forgotten */
+  fail_unless(zathura_history_store_size(store) == 2);
+  fail_unless(zathura_history_store_get(store, "/tmp/a.pdf", &info) == true);
+  fail_unless(zathura_history_store_get(store, "/tmp/b.pdf", &info) == false);
+  fail_unless(zathura_history_store_get(store, "/tmp/c.pdf", &info) == true);
+
+  zathura_history_store_set_limit(store, 1);
+  fail_unless(zathura_history_store_size(store) == 1);
+  fail_unless(zathura_history_store_get(store, "/tmp/c.pdf", &info) == true);
+
+  zathura_history_store_free(store);
+} END_TEST
+
+Suite* suite_history_store()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("History store");
+
+  /* reading and writing the history file */
+  tcase = tcase_create("file");
+  tcase_add_test(tcase, test_history_store_load);
+  tcase_add_test(tcase, test_history_store_reload);
+  suite_add_tcase(suite, tcase);
+
+  /* least recently used documents */
+  tcase = tcase_create("limit");
+  tcase_add_test(tcase, test_history_store_limit);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,50 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+
+#include "../memory-monitor.h"
+
+START_TEST(test_memory_parse_pressure) {
+  double avg10 = 0.0;
+
+  fail_unless(zathura_memory_parse_pressure(
+        "some avg10=12.50 avg60=3.10 avg300=0.80 total=123456\n"
+        "full avg10=4.00 avg60=1.00 avg300=0.20 total=23456\n", &avg10) == true);
+  fail_unless(avg10 == 12.5);
+
+  /* the line of stalls of all tasks is ignored */
+  fail_unless(zathura_memory_parse_pressure(
+        "full avg10=4.00 avg60=1.00 avg300=0.20 total=23456\n"
+        "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n", &avg10) == true);
+  fail_unless(avg10 == 0.0);
+
+  fail_unless(zathura_memory_parse_pressure("", &avg10) == false);
+  fail_unless(zathura_memory_parse_pressure("some total=0\n", &avg10) == false);
+  fail_unless(zathura_memory_parse_pressure("some avg10=x\n", &avg10) == false);
+  fail_unless(zathura_memory_parse_pressure(NULL, &avg10) == false);
+} END_TEST
+
+START_TEST(test_memory_parse_statm) {
+  size_t rss = 0;
+
+  fail_unless(zathura_memory_parse_statm("10000 2500 300 20 0 4000 0\n", 4096, &rss) == true);
+  fail_unless(rss == 2500 * 4096);
+
+  fail_unless(zathura_memory_parse_statm("", 4096, &rss) == false);
+  fail_unless(zathura_memory_parse_statm("10000", 4096, &rss) == false);
+  fail_unless(zathura_memory_parse_statm(NULL, 4096, &rss) == false);
+} END_TEST
+
+Suite* suite_memory_monitor()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Memory monitor");
+
+  /* parse */
+  tcase = tcase_create("parse");
+  tcase_add_test(tcase, test_memory_parse_pressure);
+  tcase_add_test(tcase, test_memory_parse_statm);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
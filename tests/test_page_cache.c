@@ -0,0 +1,348 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+
+#include "../page-cache.h"
+
+static cairo_surface_t*
+create_surface(void)
+{
+  /* 10 * 10 pixels with 4 bytes per pixel */
+  return cairo_image_surface_create(CAIRO_FORMAT_RGB24, 10, 10);
+}
+
+static unsigned int evict_count = 0;
+
+static void
+count_evictions(const zathura_page_cache_key_t* key, cairo_surface_t* surface, void* data)
+{
+  fail_unless(key != NULL);
+  fail_unless(surface != NULL);
+  fail_unless(data == &evict_count);
+  ++evict_count;
+}
+
+START_TEST(test_page_cache_create) {
+  zathura_page_cache_t* cache = zathura_page_cache_new(1024, 0, NULL, NULL);
+  fail_unless(cache != NULL);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_invalid) {
+  zathura_page_cache_key_t key = { 0, 1.0, 0, 0, 0 };
+  fail_unless(zathura_page_cache_add(NULL, &key, NULL) == false);
+  fail_unless(zathura_page_cache_get(NULL, &key) == NULL);
+  fail_unless(zathura_page_cache_touch(NULL, &key) == false);
+} END_TEST
+
+START_TEST(test_page_cache_hit_miss) {
+  zathura_page_cache_t* cache = zathura_page_cache_new(1024, 0, NULL, NULL);
+  zathura_page_cache_key_t key   = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t other = { 1, 2.0, 0, 0, 0 };
+  zathura_page_cache_key_t recolored = { 1, 1.0, 1, 0, 0 };
+  zathura_page_cache_key_t tile = { 1, 1.0, 0, 1, 0 };
+
+  cairo_surface_t* surface = create_surface();
+  fail_unless(zathura_page_cache_add(cache, &key, surface) == true);
+
+  cairo_surface_t* cached = zathura_page_cache_get(cache, &key);
+  fail_unless(cached == surface);
+  cairo_surface_destroy(cached);
+
+  fail_unless(zathura_page_cache_get(cache, &other) == NULL);
+  fail_unless(zathura_page_cache_get(cache, &recolored) == NULL);
+  fail_unless(zathura_page_cache_get(cache, &tile) == NULL);
+
+  /* checking for a surface is not a lookup */
+  fail_unless(zathura_page_cache_contains(cache, &key) == true);
+  fail_unless(zathura_page_cache_contains(cache, &other) == false);
+
+  zathura_page_cache_statistics_t statistics;
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.hits == 1);
+  fail_unless(statistics.misses == 3);
+  fail_unless(statistics.entries == 1);
+  fail_unless(statistics.bytes == 400);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_evict_lru) {
+  evict_count = 0;
+  /* room for two surfaces */
+  zathura_page_cache_t* cache = zathura_page_cache_new(800, 0, count_evictions, &evict_count);
+  zathura_page_cache_key_t key1 = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key2 = { 2, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key3 = { 3, 1.0, 0, 0, 0 };
+
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &key1, surface);
+  zathura_page_cache_add(cache, &key2, surface);
+  fail_unless(evict_count == 0);
+
+  /* page 1 becomes the most recently used one */
+  fail_unless(zathura_page_cache_touch(cache, &key1) == true);
+  zathura_page_cache_add(cache, &key3, surface);
+  fail_unless(evict_count == 1);
+  fail_unless(zathura_page_cache_touch(cache, &key2) == false);
+  fail_unless(zathura_page_cache_touch(cache, &key1) == true);
+  fail_unless(zathura_page_cache_touch(cache, &key3) == true);
+
+  zathura_page_cache_statistics_t statistics;
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.evictions == 1);
+  fail_unless(statistics.bytes == 800);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_set_max_bytes) {
+  evict_count = 0;
+  zathura_page_cache_t* cache = zathura_page_cache_new(1200, 0, count_evictions, &evict_count);
+  zathura_page_cache_key_t key1 = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key2 = { 2, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key3 = { 3, 1.0, 0, 0, 0 };
+
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &key1, surface);
+  zathura_page_cache_add(cache, &key2, surface);
+  zathura_page_cache_add(cache, &key3, surface);
+
+  /* the least recently used surfaces do not fit anymore */
+  zathura_page_cache_set_max_bytes(cache, 400);
+  fail_unless(evict_count == 2);
+  fail_unless(zathura_page_cache_touch(cache, &key3) == true);
+
+  /* no surface is kept without a budget */
+  zathura_page_cache_set_max_bytes(cache, 0);
+  fail_unless(evict_count == 3);
+
+  zathura_page_cache_statistics_t statistics;
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.bytes == 0);
+  fail_unless(statistics.max_bytes == 0);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_charge) {
+  evict_count = 0;
+  /* room for two surfaces */
+  zathura_page_cache_t* cache = zathura_page_cache_new(800, 0, count_evictions, &evict_count);
+  zathura_page_cache_key_t key1 = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key2 = { 2, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key3 = { 3, 1.0, 0, 0, 0 };
+
+  cairo_surface_t* surface1 = create_surface();
+  cairo_surface_t* surface2 = create_surface();
+  zathura_page_cache_add(cache, &key1, surface1);
+  zathura_page_cache_add(cache, &key2, surface2);
+
+  /* only the surface cached under the key is charged */
+  fail_unless(zathura_page_cache_charge(cache, &key1, surface2, 400) == false);
+  fail_unless(zathura_page_cache_charge(cache, &key3, surface1, 400) == false);
+  fail_unless(evict_count == 0);
+
+  /* a copy of page 1 does not fit next to page 2 */
+  fail_unless(zathura_page_cache_charge(cache, &key1, surface1, 400) == true);
+  fail_unless(evict_count == 1);
+  fail_unless(zathura_page_cache_touch(cache, &key2) == false);
+
+  zathura_page_cache_statistics_t statistics;
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.bytes == 800);
+
+  /* the charge goes away with the surface */
+  zathura_page_cache_remove_page(cache, 0, 1);
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.bytes == 0);
+
+  cairo_surface_destroy(surface1);
+  cairo_surface_destroy(surface2);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_max_entries) {
+  zathura_page_cache_t* cache = zathura_page_cache_new(1024 * 1024, 1, NULL, NULL);
+  zathura_page_cache_key_t key1 = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key2 = { 2, 1.0, 0, 0, 0 };
+
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &key1, surface);
+  zathura_page_cache_add(cache, &key2, surface);
+  fail_unless(zathura_page_cache_touch(cache, &key1) == false);
+  fail_unless(zathura_page_cache_touch(cache, &key2) == true);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_keep_newest) {
+  /* the budget is smaller than a single surface */
+  zathura_page_cache_t* cache = zathura_page_cache_new(100, 0, NULL, NULL);
+  zathura_page_cache_key_t key = { 1, 1.0, 0, 0, 0 };
+
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &key, surface);
+  fail_unless(zathura_page_cache_touch(cache, &key) == true);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_pin) {
+  evict_count = 0;
+  /* room for two surfaces */
+  zathura_page_cache_t* cache = zathura_page_cache_new(800, 0, count_evictions, &evict_count);
+  zathura_page_cache_key_t key1 = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key2 = { 2, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key3 = { 3, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key4 = { 4, 1.0, 0, 0, 0 };
+
+  /* pins may be set before the surfaces are cached */
+  zathura_page_cache_key_t pinned[] = { key1, key2 };
+  zathura_page_cache_pin(cache, pinned, 2);
+
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &key1, surface);
+  zathura_page_cache_add(cache, &key2, surface);
+
+  /* the pinned surfaces stay although they are the least recently used ones */
+  zathura_page_cache_add(cache, &key3, surface);
+  fail_unless(evict_count == 0);
+  zathura_page_cache_add(cache, &key4, surface);
+  fail_unless(evict_count == 1);
+  fail_unless(zathura_page_cache_touch(cache, &key1) == true);
+  fail_unless(zathura_page_cache_touch(cache, &key2) == true);
+  fail_unless(zathura_page_cache_touch(cache, &key3) == false);
+  fail_unless(zathura_page_cache_touch(cache, &key4) == true);
+
+  /* only the same scale is pinned */
+  zathura_page_cache_key_t other_scale = { 1, 2.0, 0, 0, 0 };
+  zathura_page_cache_add(cache, &other_scale, surface);
+  fail_unless(zathura_page_cache_touch(cache, &key4) == false);
+
+  zathura_page_cache_statistics_t statistics;
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.entries == 3);
+
+  /* surfaces that do not fit anymore are evicted once they are released */
+  zathura_page_cache_pin(cache, NULL, 0);
+  fail_unless(evict_count == 3);
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.bytes == 800);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_remove) {
+  zathura_page_cache_t* cache = zathura_page_cache_new(1024 * 1024, 0, NULL, NULL);
+  zathura_page_cache_key_t key1 = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key2 = { 1, 2.0, 0, 0, 0 };
+  zathura_page_cache_key_t key3 = { 2, 1.0, 0, 0, 0 };
+
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &key1, surface);
+  zathura_page_cache_add(cache, &key2, surface);
+  zathura_page_cache_add(cache, &key3, surface);
+
+  zathura_page_cache_remove_page(cache, 0, 1);
+  fail_unless(zathura_page_cache_touch(cache, &key1) == false);
+  fail_unless(zathura_page_cache_touch(cache, &key2) == false);
+  fail_unless(zathura_page_cache_touch(cache, &key3) == true);
+
+  zathura_page_cache_clear(cache);
+  fail_unless(zathura_page_cache_touch(cache, &key3) == false);
+
+  zathura_page_cache_statistics_t statistics;
+  zathura_page_cache_get_statistics(cache, &statistics);
+  fail_unless(statistics.entries == 0);
+  fail_unless(statistics.bytes == 0);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+START_TEST(test_page_cache_documents) {
+  zathura_page_cache_t* cache = zathura_page_cache_new(1024 * 1024, 0, NULL, NULL);
+  zathura_page_cache_key_t key1 = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t key2 = { 1, 1.0, 0, 0, 1 };
+  zathura_page_cache_key_t key3 = { 2, 1.0, 0, 0, 1 };
+
+  /* the same page of different tabs has its own surface */
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &key1, surface);
+  fail_unless(zathura_page_cache_touch(cache, &key2) == false);
+  zathura_page_cache_add(cache, &key2, surface);
+  zathura_page_cache_add(cache, &key3, surface);
+
+  zathura_page_cache_remove_page(cache, 1, 1);
+  fail_unless(zathura_page_cache_touch(cache, &key1) == true);
+  fail_unless(zathura_page_cache_touch(cache, &key2) == false);
+
+  zathura_page_cache_remove_document(cache, 1);
+  fail_unless(zathura_page_cache_touch(cache, &key1) == true);
+  fail_unless(zathura_page_cache_touch(cache, &key3) == false);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+static bool
+filter_recolored(const zathura_page_cache_key_t* key, void* data)
+{
+  fail_unless(data == NULL);
+  return key->recolor != 0;
+}
+
+START_TEST(test_page_cache_remove_matching) {
+  zathura_page_cache_t* cache = zathura_page_cache_new(1024 * 1024, 0, NULL, NULL);
+  zathura_page_cache_key_t base      = { 1, 1.0, 0, 0, 0 };
+  zathura_page_cache_key_t recolored = { 1, 1.0, 1, 0, 0 };
+
+  cairo_surface_t* surface = create_surface();
+  zathura_page_cache_add(cache, &base, surface);
+  zathura_page_cache_add(cache, &recolored, surface);
+
+  zathura_page_cache_remove_matching(cache, NULL, NULL);
+  fail_unless(zathura_page_cache_touch(cache, &recolored) == true);
+
+  zathura_page_cache_remove_matching(cache, filter_recolored, NULL);
+  fail_unless(zathura_page_cache_touch(cache, &base) == true);
+  fail_unless(zathura_page_cache_touch(cache, &recolored) == false);
+
+  cairo_surface_destroy(surface);
+  zathura_page_cache_free(cache);
+} END_TEST
+
+Suite* suite_page_cache()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Page cache");
+
+  /* basic */
+  tcase = tcase_create("basic");
+  tcase_add_test(tcase, test_page_cache_create);
+  tcase_add_test(tcase, test_page_cache_invalid);
+  tcase_add_test(tcase, test_page_cache_hit_miss);
+  suite_add_tcase(suite, tcase);
+
+  /* eviction */
+  tcase = tcase_create("eviction");
+  tcase_add_test(tcase, test_page_cache_evict_lru);
+  tcase_add_test(tcase, test_page_cache_set_max_bytes);
+  tcase_add_test(tcase, test_page_cache_charge);
+  tcase_add_test(tcase, test_page_cache_max_entries);
+  tcase_add_test(tcase, test_page_cache_keep_newest);
+  tcase_add_test(tcase, test_page_cache_pin);
+  tcase_add_test(tcase, test_page_cache_remove);
+  tcase_add_test(tcase, test_page_cache_documents);
+  tcase_add_test(tcase, test_page_cache_remove_matching);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,232 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <glib.h>
+
+#include "../page-layout.h"
+
+START_TEST(test_page_layout_empty) {
+  zathura_page_layout_t* layout = zathura_page_layout_new();
+  fail_unless(layout != NULL);
+
+  unsigned int width = 1, height = 1;
+  zathura_page_layout_get_size(layout, &width, &height);
+  fail_unless(width == 0 && height == 0);
+
+  unsigned int x = 0, y = 0;
+  fail_unless(zathura_page_layout_get_page_position(layout, 0, &x, &y) == false);
+
+  unsigned int first = 0, last = 0;
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, 0, 100, &first, &last) == false);
+
+  zathura_page_layout_free(layout);
+} END_TEST
+
+START_TEST(test_page_layout_single_column) {
+  const unsigned int widths[]  = { 100, 80, 100 };
+  const unsigned int heights[] = { 200, 200, 150 };
+
+  zathura_page_layout_t* layout = zathura_page_layout_new();
+  zathura_page_layout_set_padding(layout, 10);
+  zathura_page_layout_update(layout, 3, widths, heights);
+  fail_unless(zathura_page_layout_get_number_of_pages(layout) == 3);
+
+  unsigned int width = 0, height = 0;
+  zathura_page_layout_get_size(layout, &width, &height);
+  fail_unless(width == 100);
+  fail_unless(height == 3 * 200 + 2 * 10);
+
+  /* pages are centered in their cells */
+  unsigned int x = 0, y = 0;
+  fail_unless(zathura_page_layout_get_page_position(layout, 1, &x, &y) == true);
+  fail_unless(x == 10 && y == 210);
+  fail_unless(zathura_page_layout_get_page_position(layout, 2, &x, &y) == true);
+  fail_unless(x == 0 && y == 420 + 25);
+
+  zathura_page_layout_free(layout);
+} END_TEST
+
+START_TEST(test_page_layout_columns) {
+  const unsigned int widths[]  = { 100, 100, 100, 100, 100 };
+  const unsigned int heights[] = { 100, 100, 100, 100, 100 };
+
+  zathura_page_layout_t* layout = zathura_page_layout_new();
+  zathura_page_layout_set_mode(layout, 2, 2);
+  zathura_page_layout_update(layout, 5, widths, heights);
+
+  unsigned int width = 0, height = 0;
+  zathura_page_layout_get_size(layout, &width, &height);
+  fail_unless(width == 200);
+  fail_unless(height == 300);
+
+  unsigned int x = 0, y = 0;
+  fail_unless(zathura_page_layout_get_page_position(layout, 0, &x, &y) == true);
+  fail_unless(x == 100 && y == 0);
+  fail_unless(zathura_page_layout_get_page_position(layout, 1, &x, &y) == true);
+  fail_unless(x == 0 && y == 100);
+  fail_unless(zathura_page_layout_get_page_position(layout, 4, &x, &y) == true);
+  fail_unless(x == 100 && y == 200);
+
+  zathura_page_layout_free(layout);
+} END_TEST
+
+START_TEST(test_page_layout_range) {
+  const unsigned int widths[]  = { 100, 100, 100, 100, 100, 100 };
+  const unsigned int heights[] = { 100, 100, 100, 100, 100, 100 };
+
+  zathura_page_layout_t* layout = zathura_page_layout_new();
+  zathura_page_layout_set_padding(layout, 10);
+  zathura_page_layout_update(layout, 6, widths, heights);
+
+  unsigned int first = 0, last = 0;
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, 0, 50, &first, &last) == true);
+  fail_unless(first == 0 && last == 0);
+
+  /* the padding between two pages belongs to neither of them */
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, 101, 8, &first, &last) == false);
+
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, 150, 200, &first, &last) == true);
+  fail_unless(first == 1 && last == 3);
+
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, -500, 10000, &first, &last) == true);
+  fail_unless(first == 0 && last == 5);
+
+  /* rows of two pages */
+  zathura_page_layout_set_mode(layout, 2, 1);
+  zathura_page_layout_update(layout, 6, widths, heights);
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, 150, 10, &first, &last) == true);
+  fail_unless(first == 2 && last == 3);
+
+  zathura_page_layout_free(layout);
+} END_TEST
+
+START_TEST(test_page_layout_range_many_pages) {
+  unsigned int widths[1000];
+  unsigned int heights[1000];
+  for (unsigned int i = 0; i < 1000; i++) {
+    widths[i]  = 100;
+    heights[i] = 100;
+  }
+
+  zathura_page_layout_t* layout = zathura_page_layout_new();
+  zathura_page_layout_set_mode(layout, 3, 2);
+  zathura_page_layout_update(layout, 1000, widths, heights);
+
+  /* every row intersecting with the range is found */
+  unsigned int first = 0, last = 0;
+  for (unsigned int row = 0; row < 334; row++) {
+    fail_unless(zathura_page_layout_get_pages_in_range(layout, row * 100 + 50, 1, &first, &last) == true);
+    fail_unless(first == (row == 0 ? 0 : row * 3 - 1));
+    fail_unless(last == MIN(row * 3 + 1, 999));
+  }
+
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, 334 * 100, 100, &first, &last) == false);
+  fail_unless(zathura_page_layout_get_pages_in_range(layout, -100, 100, &first, &last) == false);
+
+  zathura_page_layout_free(layout);
+} END_TEST
+
+START_TEST(test_page_layout_page_size) {
+  const unsigned int widths[]  = { 100, 100, 100 };
+  const unsigned int heights[] = { 100, 100, 100 };
+
+  zathura_page_layout_t* layout = zathura_page_layout_new();
+  zathura_page_layout_update(layout, 3, widths, heights);
+
+  /* smaller pages do not change the cells */
+  fail_unless(zathura_page_layout_set_page_size(layout, 1, 50, 50) == false);
+  unsigned int x = 0, y = 0;
+  fail_unless(zathura_page_layout_get_page_position(layout, 1, &x, &y) == true);
+  fail_unless(x == 25 && y == 125);
+
+  /* larger ones do */
+  fail_unless(zathura_page_layout_set_page_size(layout, 2, 100, 200) == true);
+  fail_unless(zathura_page_layout_get_page_position(layout, 2, &x, &y) == true);
+  fail_unless(x == 0 && y == 400);
+
+  /* and so does shrinking the largest page */
+  fail_unless(zathura_page_layout_set_page_size(layout, 2, 100, 100) == true);
+  unsigned int width = 0, height = 0;
+  zathura_page_layout_get_size(layout, &width, &height);
+  fail_unless(width == 100 && height == 300);
+
+  zathura_page_layout_free(layout);
+} END_TEST
+
+START_TEST(test_page_layout_refresh) {
+  const unsigned int widths[]  = { 100, 50, 100 };
+  const unsigned int heights[] = { 100, 50, 100 };
+
+  zathura_page_layout_t* layout = zathura_page_layout_new();
+  zathura_page_layout_update(layout, 3, widths, heights);
+
+  unsigned int width = 0, height = 0;
+  fail_unless(zathura_page_layout_get_page_size(layout, 1, &width, &height) == true);
+  fail_unless(width == 50 && height == 50);
+  fail_unless(zathura_page_layout_get_page_size(layout, 3, &width, &height) == false);
+
+  /* the known sizes are arranged again without being passed */
+  zathura_page_layout_set_mode(layout, 2, 2);
+  zathura_page_layout_set_padding(layout, 10);
+  zathura_page_layout_refresh(layout);
+
+  zathura_page_layout_get_size(layout, &width, &height);
+  fail_unless(width == 210 && height == 210);
+
+  unsigned int x = 0, y = 0;
+  fail_unless(zathura_page_layout_get_page_position(layout, 1, &x, &y) == true);
+  fail_unless(x == 25 && y == 110 + 25);
+
+  zathura_page_layout_free(layout);
+} END_TEST
+
+START_TEST(test_page_layout_row_pages) {
+  unsigned int first = 0;
+  unsigned int last  = 0;
+
+  fail_unless(zathura_page_layout_get_row_pages(1, 1, 5, 3, &first, &last) == true);
+  fail_unless(first == 3 && last == 3);
+
+  /* book mode: the first page is shown on its own */
+  fail_unless(zathura_page_layout_get_row_pages(2, 2, 6, 0, &first, &last) == true);
+  fail_unless(first == 0 && last == 0);
+  fail_unless(zathura_page_layout_get_row_pages(2, 2, 6, 1, &first, &last) == true);
+  fail_unless(first == 1 && last == 2);
+  fail_unless(zathura_page_layout_get_row_pages(2, 2, 6, 2, &first, &last) == true);
+  fail_unless(first == 1 && last == 2);
+  fail_unless(zathura_page_layout_get_row_pages(2, 2, 6, 5, &first, &last) == true);
+  fail_unless(first == 5 && last == 5);
+
+  fail_unless(zathura_page_layout_get_row_pages(3, 1, 7, 4, &first, &last) == true);
+  fail_unless(first == 3 && last == 5);
+  fail_unless(zathura_page_layout_get_row_pages(3, 1, 7, 6, &first, &last) == true);
+  fail_unless(first == 6 && last == 6);
+
+  fail_unless(zathura_page_layout_get_row_pages(2, 1, 6, 6, &first, &last) == false);
+  fail_unless(zathura_page_layout_get_row_pages(0, 1, 2, 1, &first, &last) == true);
+  fail_unless(first == 1 && last == 1);
+} END_TEST
+
+Suite* suite_page_layout()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Page layout");
+
+  /* basic */
+  tcase = tcase_create("basic");
+  tcase_add_test(tcase, test_page_layout_empty);
+  tcase_add_test(tcase, test_page_layout_single_column);
+  tcase_add_test(tcase, test_page_layout_columns);
+  tcase_add_test(tcase, test_page_layout_row_pages);
+  suite_add_tcase(suite, tcase);
+
+  /* updates */
+  tcase = tcase_create("updates");
+  tcase_add_test(tcase, test_page_layout_range);
+  tcase_add_test(tcase, test_page_layout_range_many_pages);
+  tcase_add_test(tcase, test_page_layout_page_size);
+  tcase_add_test(tcase, test_page_layout_refresh);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,162 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "../plugin.h"
+
+static char* data_dir = NULL;
+static char* plugin_dir = NULL;
+static char* plugin_file = NULL;
+static char* manifest = NULL;
+
+static void
+setup_plugin(void)
+{
+  data_dir = g_dir_make_tmp("zathura-test-XXXXXX", NULL);
+  fail_unless(data_dir != NULL);
+
+  plugin_dir = g_build_filename(data_dir, "plugins.d", NULL);
+  fail_unless(g_mkdir(plugin_dir, 0700) == 0);
+
+  /* a file that cannot be opened as a plugin */
+  plugin_file = g_build_filename(plugin_dir, "fake.so", NULL);
+  fail_unless(g_file_set_contents(plugin_file, "not a plugin", -1, NULL) == TRUE);
+
+  manifest = g_build_filename(data_dir, "plugins", NULL);
+}
+
+static void
+teardown_plugin(void)
+{
+  g_unlink(manifest);
+  g_unlink(plugin_file);
+  g_rmdir(plugin_dir);
+  g_rmdir(data_dir);
+
+  g_free(manifest);
+  g_free(plugin_file);
+  g_free(plugin_dir);
+  g_free(data_dir);
+}
+
+static zathura_plugin_manager_t*
+load_plugins(void)
+{
+  zathura_plugin_manager_t* plugin_manager = zathura_plugin_manager_new();
+  fail_unless(plugin_manager != NULL);
+
+  zathura_plugin_manager_add_dir(plugin_manager, plugin_dir);
+  zathura_plugin_manager_set_manifest(plugin_manager, manifest);
+  zathura_plugin_manager_load(plugin_manager);
+
+  return plugin_manager;
+}
+
+static void
+write_manifest(int api_version, bool valid)
+{
+  GStatBuf info;
+  fail_unless(g_stat(plugin_file, &info) == 0);
+
+  GKeyFile* key_file = g_key_file_new();
+  g_key_file_set_integer(key_file, "manifest", "api-version", api_version);
+  g_key_file_set_integer(key_file, "manifest", "abi-version", ZATHURA_ABI_VERSION);
+  g_key_file_set_int64(key_file, plugin_file, "mtime", info.st_mtime);
+  g_key_file_set_int64(key_file, plugin_file, "size", info.st_size);
+  g_key_file_set_boolean(key_file, plugin_file, "valid", valid == true ? TRUE : FALSE);
+  g_key_file_set_string(key_file, plugin_file, "name", "fake");
+  g_key_file_set_string(key_file, plugin_file, "content-types", "application/pdf;");
+  g_key_file_set_string(key_file, plugin_file, "version", "1;2;3;");
+
+  char* content = g_key_file_to_data(key_file, NULL, NULL);
+  fail_unless(g_file_set_contents(manifest, content, -1, NULL) == TRUE);
+  g_free(content);
+  g_key_file_free(key_file);
+}
+
+START_TEST(test_plugin_manifest_written) {
+  zathura_plugin_manager_t* plugin_manager = load_plugins();
+  fail_unless(girara_list_size(zathura_plugin_manager_get_plugins(plugin_manager)) == 0);
+  zathura_plugin_manager_free(plugin_manager);
+
+  /* files that are no plugins are not remembered, so they are tried again */
+  GKeyFile* key_file = g_key_file_new();
+  fail_unless(g_key_file_load_from_file(key_file, manifest, G_KEY_FILE_NONE, NULL) == TRUE);
+  fail_unless(g_key_file_get_integer(key_file, "manifest", "api-version", NULL) == ZATHURA_API_VERSION);
+  fail_unless(g_key_file_has_group(key_file, plugin_file) == FALSE);
+  g_key_file_free(key_file);
+} END_TEST
+
+START_TEST(test_plugin_manifest_invalid) {
+  /* files that failed to open before are opened again */
+  write_manifest(ZATHURA_API_VERSION, false);
+
+  zathura_plugin_manager_t* plugin_manager = load_plugins();
+  fail_unless(girara_list_size(zathura_plugin_manager_get_plugins(plugin_manager)) == 0);
+  zathura_plugin_manager_free(plugin_manager);
+
+  GKeyFile* key_file = g_key_file_new();
+  fail_unless(g_key_file_load_from_file(key_file, manifest, G_KEY_FILE_NONE, NULL) == TRUE);
+  fail_unless(g_key_file_has_group(key_file, plugin_file) == FALSE);
+  g_key_file_free(key_file);
+} END_TEST
+
+START_TEST(test_plugin_manifest_lazy) {
+  write_manifest(ZATHURA_API_VERSION, true);
+
+  /* the plugin is registered without opening it */
+  zathura_plugin_manager_t* plugin_manager = load_plugins();
+  girara_list_t* plugins = zathura_plugin_manager_get_plugins(plugin_manager);
+  fail_unless(girara_list_size(plugins) == 1);
+
+  zathura_plugin_t* plugin = girara_list_nth(plugins, 0);
+  fail_unless(g_strcmp0(zathura_plugin_get_name(plugin), "fake") == 0);
+  fail_unless(g_strcmp0(zathura_plugin_get_path(plugin), plugin_file) == 0);
+  zathura_plugin_version_t version = zathura_plugin_get_version(plugin);
+  fail_unless(version.major == 1 && version.minor == 2 && version.rev == 3);
+  fail_unless(zathura_plugin_manager_has_plugin(plugin_manager, "application/pdf") == true);
+  fail_unless(zathura_plugin_manager_has_plugin(plugin_manager, "image/png") == false);
+
+  /* opening the file fails once a document needs it */
+  fail_unless(zathura_plugin_manager_get_plugin(plugin_manager, "application/pdf") == NULL);
+  fail_unless(zathura_plugin_manager_get_plugin(plugin_manager, "application/pdf") == NULL);
+
+  zathura_plugin_manager_free(plugin_manager);
+} END_TEST
+
+START_TEST(test_plugin_manifest_outdated) {
+  /* a manifest of another API version is ignored */
+  write_manifest(ZATHURA_API_VERSION + 1, true);
+
+  zathura_plugin_manager_t* plugin_manager = load_plugins();
+  fail_unless(girara_list_size(zathura_plugin_manager_get_plugins(plugin_manager)) == 0);
+  fail_unless(zathura_plugin_manager_has_plugin(plugin_manager, "application/pdf") == false);
+  zathura_plugin_manager_free(plugin_manager);
+
+  /* a changed file is opened again */
+  write_manifest(ZATHURA_API_VERSION, true);
+  fail_unless(g_file_set_contents(plugin_file, "still not a plugin", -1, NULL) == TRUE);
+
+  plugin_manager = load_plugins();
+  fail_unless(girara_list_size(zathura_plugin_manager_get_plugins(plugin_manager)) == 0);
+  zathura_plugin_manager_free(plugin_manager);
+} END_TEST
+
+Suite* suite_plugin()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Plugin");
+
+  /* manifest */
+  tcase = tcase_create("manifest");
+  tcase_add_checked_fixture(tcase, setup_plugin, teardown_plugin);
+  tcase_add_test(tcase, test_plugin_manifest_written);
+  tcase_add_test(tcase, test_plugin_manifest_invalid);
+  tcase_add_test(tcase, test_plugin_manifest_lazy);
+  tcase_add_test(tcase, test_plugin_manifest_outdated);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,83 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+
+#include "../prefetch.h"
+
+START_TEST(test_prefetch_predict_forward) {
+  unsigned int pages[4];
+
+  fail_unless(zathura_prefetch_predict(2, 3, 10, ZATHURA_PREFETCH_FORWARD, 3, pages) == 3);
+  fail_unless(pages[0] == 4 && pages[1] == 5 && pages[2] == 6);
+
+  /* there are no pages after the last one */
+  fail_unless(zathura_prefetch_predict(7, 8, 10, ZATHURA_PREFETCH_FORWARD, 3, pages) == 1);
+  fail_unless(pages[0] == 9);
+  fail_unless(zathura_prefetch_predict(9, 9, 10, ZATHURA_PREFETCH_FORWARD, 3, pages) == 0);
+} END_TEST
+
+START_TEST(test_prefetch_predict_backward) {
+  unsigned int pages[4];
+
+  fail_unless(zathura_prefetch_predict(5, 5, 10, ZATHURA_PREFETCH_BACKWARD, 2, pages) == 2);
+  fail_unless(pages[0] == 4 && pages[1] == 3);
+
+  fail_unless(zathura_prefetch_predict(0, 1, 10, ZATHURA_PREFETCH_BACKWARD, 2, pages) == 0);
+} END_TEST
+
+START_TEST(test_prefetch_predict_both) {
+  unsigned int pages[4];
+
+  fail_unless(zathura_prefetch_predict(4, 5, 10, ZATHURA_PREFETCH_BOTH, 4, pages) == 4);
+  fail_unless(pages[0] == 6 && pages[1] == 3 && pages[2] == 7 && pages[3] == 2);
+
+  /* the other side is used once one side is exhausted */
+  fail_unless(zathura_prefetch_predict(1, 1, 10, ZATHURA_PREFETCH_BOTH, 4, pages) == 4);
+  fail_unless(pages[0] == 2 && pages[1] == 0 && pages[2] == 3 && pages[3] == 4);
+} END_TEST
+
+START_TEST(test_prefetch_predict_invalid) {
+  unsigned int pages[4];
+
+  fail_unless(zathura_prefetch_predict(0, 0, 10, ZATHURA_PREFETCH_FORWARD, 0, pages) == 0);
+  fail_unless(zathura_prefetch_predict(3, 2, 10, ZATHURA_PREFETCH_FORWARD, 2, pages) == 0);
+  fail_unless(zathura_prefetch_predict(0, 10, 10, ZATHURA_PREFETCH_FORWARD, 2, pages) == 0);
+  fail_unless(zathura_prefetch_predict(0, 1, 10, ZATHURA_PREFETCH_FORWARD, 2, NULL) == 0);
+} END_TEST
+
+START_TEST(test_prefetch_parse_direction) {
+  zathura_prefetch_direction_t direction = ZATHURA_PREFETCH_BOTH;
+
+  fail_unless(zathura_prefetch_parse_direction("scroll", 0, &direction) == true);
+  fail_unless(direction == ZATHURA_PREFETCH_FORWARD);
+  fail_unless(zathura_prefetch_parse_direction("scroll", -1, &direction) == true);
+  fail_unless(direction == ZATHURA_PREFETCH_BACKWARD);
+  fail_unless(zathura_prefetch_parse_direction("forward", -1, &direction) == true);
+  fail_unless(direction == ZATHURA_PREFETCH_FORWARD);
+  fail_unless(zathura_prefetch_parse_direction("both", 1, &direction) == true);
+  fail_unless(direction == ZATHURA_PREFETCH_BOTH);
+
+  fail_unless(zathura_prefetch_parse_direction("sideways", 1, &direction) == false);
+  fail_unless(zathura_prefetch_parse_direction(NULL, 1, &direction) == false);
+} END_TEST
+
+Suite* suite_prefetch()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Prefetch");
+
+  /* predict */
+  tcase = tcase_create("predict");
+  tcase_add_test(tcase, test_prefetch_predict_forward);
+  tcase_add_test(tcase, test_prefetch_predict_backward);
+  tcase_add_test(tcase, test_prefetch_predict_both);
+  tcase_add_test(tcase, test_prefetch_predict_invalid);
+  suite_add_tcase(suite, tcase);
+
+  /* settings */
+  tcase = tcase_create("settings");
+  tcase_add_test(tcase, test_prefetch_parse_direction);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
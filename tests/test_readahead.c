@@ -0,0 +1,74 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "../readahead.h"
+
+static char* directory = NULL;
+static char* file      = NULL;
+
+static void
+setup_readahead(void)
+{
+  directory = g_dir_make_tmp("zathura-readahead-XXXXXX", NULL);
+  fail_unless(directory != NULL);
+
+  file = g_build_filename(directory, "document.pdf", NULL);
+  fail_unless(g_file_set_contents(file, "%PDF-1.4 not much of a document", -1, NULL) == TRUE);
+}
+
+static void
+teardown_readahead(void)
+{
+  g_unlink(file);
+  g_rmdir(directory);
+
+  g_free(file);
+  g_free(directory);
+}
+
+START_TEST(test_readahead_file) {
+  fail_unless(zathura_readahead_file(file, 1024 * 1024) == true);
+
+  /* files larger than the limit and disabled read ahead */
+  fail_unless(zathura_readahead_file(file, 4) == false);
+  fail_unless(zathura_readahead_file(file, 0) == false);
+
+  /* only regular files are read ahead */
+  fail_unless(zathura_readahead_file(directory, 1024 * 1024) == false);
+  fail_unless(zathura_readahead_file(NULL, 1024 * 1024) == false);
+} END_TEST
+
+START_TEST(test_readahead_range) {
+  fail_unless(zathura_readahead_new(NULL) == NULL);
+  fail_unless(zathura_readahead_new(directory) == NULL);
+
+  zathura_readahead_t* readahead = zathura_readahead_new(file);
+  fail_unless(readahead != NULL);
+
+  fail_unless(zathura_readahead_range(readahead, 0, 8) == true);
+  /* ranges are cut at the end of the file */
+  fail_unless(zathura_readahead_range(readahead, 8, 1024 * 1024) == true);
+  fail_unless(zathura_readahead_range(readahead, 1024 * 1024, 8) == false);
+  fail_unless(zathura_readahead_range(readahead, 0, 0) == false);
+  fail_unless(zathura_readahead_range(NULL, 0, 8) == false);
+
+  zathura_readahead_free(readahead);
+  zathura_readahead_free(NULL);
+} END_TEST
+
+Suite* suite_readahead()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Readahead");
+
+  tcase = tcase_create("basic");
+  tcase_add_checked_fixture(tcase, setup_readahead, teardown_readahead);
+  tcase_add_test(tcase, test_readahead_file);
+  tcase_add_test(tcase, test_readahead_range);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
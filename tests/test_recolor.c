@@ -0,0 +1,112 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../recolor.h"
+
+/* 16 * 16 pixels with 4 bytes per pixel */
+#define IMAGE_SIZE 16
+#define IMAGE_STRIDE (IMAGE_SIZE * 4)
+
+static const GdkColor dark_color  = { 0, 0x2000, 0x3000, 0x4000 };
+static const GdkColor light_color = { 0, 0xF000, 0xE000, 0xD000 };
+
+static void
+fill_image(unsigned char* image)
+{
+  for (unsigned int i = 0; i < IMAGE_SIZE * IMAGE_SIZE; i++) {
+    unsigned char* data = image + i * 4;
+    if (i % 3 == 0) {
+      /* grey */
+      data[0] = data[1] = data[2] = i;
+    } else {
+      data[0] = i * 7;
+      data[1] = i * 13;
+      data[2] = 255 - i;
+    }
+    data[3] = 0xAB;
+  }
+}
+
+static void
+check_image(bool keep_hue)
+{
+  unsigned char image[IMAGE_SIZE * IMAGE_STRIDE];
+  unsigned char expected[IMAGE_SIZE * IMAGE_STRIDE];
+  fill_image(image);
+  /* every color appears twice to exercise the cache */
+  memcpy(image + IMAGE_SIZE * IMAGE_STRIDE / 2, image, IMAGE_SIZE * IMAGE_STRIDE / 2);
+  memcpy(expected, image, sizeof(image));
+
+  zathura_recolor_t recolor;
+  zathura_recolor_init(&recolor, &dark_color, &light_color, keep_hue);
+
+  for (unsigned int i = 0; i < IMAGE_SIZE * IMAGE_SIZE; i++) {
+    zathura_recolor_pixel(&recolor, expected + i * 4);
+  }
+
+  zathura_recolor_image(&recolor, image, IMAGE_SIZE, IMAGE_SIZE, IMAGE_STRIDE);
+  fail_unless(memcmp(image, expected, sizeof(image)) == 0);
+}
+
+START_TEST(test_recolor_invalid) {
+  zathura_recolor_image(NULL, NULL, 0, 0, 0);
+  zathura_recolor_t recolor;
+  zathura_recolor_init(&recolor, &dark_color, &light_color, false);
+  zathura_recolor_image(&recolor, NULL, 10, 10, 40);
+} END_TEST
+
+START_TEST(test_recolor_black_white) {
+  zathura_recolor_t recolor;
+  zathura_recolor_init(&recolor, &dark_color, &light_color, false);
+
+  /* black becomes the dark color and white (nearly) the light color */
+  unsigned char pixel[4] = { 0, 0, 0, 0 };
+  zathura_recolor_image(&recolor, pixel, 1, 1, 4);
+  fail_unless(pixel[2] == 0x20 && pixel[1] == 0x30 && pixel[0] == 0x40);
+
+  unsigned char white[4] = { 255, 255, 255, 0 };
+  zathura_recolor_image(&recolor, white, 1, 1, 4);
+  fail_unless(abs(white[2] - 0xF0) <= 2 && abs(white[1] - 0xE0) <= 2 && abs(white[0] - 0xD0) <= 2);
+} END_TEST
+
+START_TEST(test_recolor_alpha) {
+  zathura_recolor_t recolor;
+  zathura_recolor_init(&recolor, &dark_color, &light_color, true);
+
+  unsigned char pixel[8] = { 10, 20, 30, 0x12, 40, 40, 40, 0x34 };
+  zathura_recolor_image(&recolor, pixel, 2, 1, 8);
+  fail_unless(pixel[3] == 0x12);
+  fail_unless(pixel[7] == 0x34);
+} END_TEST
+
+START_TEST(test_recolor_identical) {
+  check_image(false);
+} END_TEST
+
+START_TEST(test_recolor_identical_keep_hue) {
+  check_image(true);
+} END_TEST
+
+Suite* suite_recolor()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Recolor");
+
+  /* basic */
+  tcase = tcase_create("basic");
+  tcase_add_test(tcase, test_recolor_invalid);
+  tcase_add_test(tcase, test_recolor_black_white);
+  tcase_add_test(tcase, test_recolor_alpha);
+  suite_add_tcase(suite, tcase);
+
+  /* lookup tables */
+  tcase = tcase_create("tables");
+  tcase_add_test(tcase, test_recolor_identical);
+  tcase_add_test(tcase, test_recolor_identical_keep_hue);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,39 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <girara/session.h>
+#include <girara/settings.h>
+
+#include "../zathura.h"
+#include "../render.h"
+
+START_TEST(test_render_row_groups_threads) {
+  zathura_t* zathura = zathura_create();
+  fail_unless(zathura != NULL);
+  fail_unless(zathura_init(zathura) == true);
+
+  int render_threads = 1;
+  girara_setting_set(zathura->ui.session, "render-threads", &render_threads);
+  zathura->sync.render_thread = render_init(zathura);
+  fail_unless(zathura->sync.render_thread != NULL);
+  render_attach(zathura->sync.render_thread, zathura);
+  fail_unless(render_get_max_threads(zathura->sync.render_thread) == 1);
+
+  /* a row of pages does not start more threads than render-threads */
+  render_set_row_groups(zathura, 12, 1);
+  fail_unless(render_get_max_threads(zathura->sync.render_thread) == 1);
+
+  zathura_free(zathura);
+} END_TEST
+
+Suite* suite_render()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Render");
+
+  tcase = tcase_create("row groups");
+  tcase_add_test(tcase, test_render_row_groups_threads);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,149 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <glib.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "../render-cache.h"
+
+static char*
+create_cache_dir(void)
+{
+  char* dir = g_dir_make_tmp("zathura-test-XXXXXX", NULL);
+  fail_unless(dir != NULL);
+  return dir;
+}
+
+static void
+remove_cache_dir(char* dir)
+{
+  GDir* handle = g_dir_open(dir, 0, NULL);
+  if (handle != NULL) {
+    const char* name = NULL;
+    while ((name = g_dir_read_name(handle)) != NULL) {
+      char* file = g_build_filename(dir, name, NULL);
+      g_unlink(file);
+      g_free(file);
+    }
+    g_dir_close(handle);
+  }
+  g_rmdir(dir);
+  g_free(dir);
+}
+
+static cairo_surface_t*
+create_surface(double red)
+{
+  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, 10, 20);
+  cairo_t* cairo = cairo_create(surface);
+  cairo_set_source_rgb(cairo, red, 0, 0);
+  cairo_paint(cairo);
+  cairo_destroy(cairo);
+  cairo_surface_flush(surface);
+
+  return surface;
+}
+
+static zathura_page_cache_key_t
+create_key(unsigned int page, double scale)
+{
+  zathura_page_cache_key_t key = { page, scale, 0, 0, 0 };
+  return key;
+}
+
+START_TEST(test_render_cache_add_get) {
+  char* dir = create_cache_dir();
+  zathura_render_cache_t* cache = zathura_render_cache_new(dir, "/tmp/document.pdf", 1, 2, 1024 * 1024);
+  fail_unless(cache != NULL);
+
+  zathura_page_cache_key_t key = create_key(3, 1.5);
+  fail_unless(zathura_render_cache_get(cache, &key) == NULL);
+
+  cairo_surface_t* surface = create_surface(1);
+  fail_unless(zathura_render_cache_add(cache, &key, surface) == true);
+  fail_unless(zathura_render_cache_get_size(cache) > 0);
+  zathura_render_cache_free(cache);
+
+  /* the surface is kept for the next session */
+  cache = zathura_render_cache_new(dir, "/tmp/document.pdf", 1, 2, 1024 * 1024);
+  cairo_surface_t* stored = zathura_render_cache_get(cache, &key);
+  fail_unless(stored != NULL);
+  fail_unless(cairo_image_surface_get_width(stored) == 10);
+  fail_unless(cairo_image_surface_get_height(stored) == 20);
+  fail_unless(memcmp(cairo_image_surface_get_data(stored), cairo_image_surface_get_data(surface),
+        cairo_image_surface_get_stride(surface) * 20) == 0);
+  cairo_surface_destroy(stored);
+  cairo_surface_destroy(surface);
+
+  /* other pages, scales and recolor states are not cached */
+  zathura_page_cache_key_t other = create_key(2, 1.5);
+  fail_unless(zathura_render_cache_get(cache, &other) == NULL);
+  other = create_key(3, 1.25);
+  fail_unless(zathura_render_cache_get(cache, &other) == NULL);
+  other = create_key(3, 1.5);
+  other.recolor = 1;
+  fail_unless(zathura_render_cache_get(cache, &other) == NULL);
+  zathura_render_cache_free(cache);
+
+  /* neither is another version of the document */
+  cache = zathura_render_cache_new(dir, "/tmp/document.pdf", 5, 2, 1024 * 1024);
+  fail_unless(zathura_render_cache_get(cache, &key) == NULL);
+  zathura_render_cache_free(cache);
+
+  remove_cache_dir(dir);
+} END_TEST
+
+START_TEST(test_render_cache_budget) {
+  char* dir = create_cache_dir();
+
+  /* only one surface fits */
+  cairo_surface_t* surface = create_surface(0.5);
+  const size_t surface_size = cairo_image_surface_get_stride(surface) * 20;
+  zathura_render_cache_t* cache = zathura_render_cache_new(dir, "/tmp/document.pdf", 1, 2,
+      surface_size + surface_size / 2);
+  fail_unless(cache != NULL);
+
+  zathura_page_cache_key_t key_1 = create_key(0, 1);
+  zathura_page_cache_key_t key_2 = create_key(1, 1);
+  fail_unless(zathura_render_cache_add(cache, &key_1, surface) == true);
+  fail_unless(zathura_render_cache_add(cache, &key_2, surface) == true);
+  fail_unless(zathura_render_cache_get_size(cache) <= surface_size + surface_size / 2);
+
+  unsigned int stored = 0;
+  cairo_surface_t* result = zathura_render_cache_get(cache, &key_1);
+  if (result != NULL) {
+    ++stored;
+    cairo_surface_destroy(result);
+  }
+  result = zathura_render_cache_get(cache, &key_2);
+  if (result != NULL) {
+    ++stored;
+    cairo_surface_destroy(result);
+  }
+  fail_unless(stored == 1);
+
+  /* surfaces larger than the budget are not stored at all */
+  zathura_render_cache_free(cache);
+  cache = zathura_render_cache_new(dir, "/tmp/document.pdf", 1, 2, surface_size / 2);
+  fail_unless(zathura_render_cache_get_size(cache) == 0);
+  fail_unless(zathura_render_cache_add(cache, &key_1, surface) == false);
+
+  cairo_surface_destroy(surface);
+  zathura_render_cache_free(cache);
+  remove_cache_dir(dir);
+} END_TEST
+
+Suite* suite_render_cache()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Render cache");
+
+  /* basic */
+  tcase = tcase_create("basic");
+  tcase_add_test(tcase, test_render_cache_add_get);
+  tcase_add_test(tcase, test_render_cache_budget);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,101 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+
+#include "../replay.h"
+
+START_TEST(test_replay_parse) {
+  const char* content =
+    "# scroll through the document\n"
+    "\n"
+    "0 scroll half-down\n"
+    "  150   zoom 200\n"
+    "20 zoom in\n"
+    "100 navigate previous\n"
+    "40 search hello world \n"
+    "500 wait\n";
+
+  unsigned int error_line = 0;
+  GArray* events = zathura_replay_parse(content, &error_line);
+  fail_unless(events != NULL);
+  fail_unless(events->len == 6);
+
+  zathura_replay_event_t* event = &g_array_index(events, zathura_replay_event_t, 0);
+  fail_unless(event->delay == 0);
+  fail_unless(event->action == ZATHURA_REPLAY_SCROLL);
+  fail_unless(event->argument == HALF_DOWN);
+
+  event = &g_array_index(events, zathura_replay_event_t, 1);
+  fail_unless(event->delay == 150);
+  fail_unless(event->action == ZATHURA_REPLAY_ZOOM);
+  fail_unless(event->argument == ZOOM_SPECIFIC && event->count == 200);
+
+  event = &g_array_index(events, zathura_replay_event_t, 2);
+  fail_unless(event->argument == ZOOM_IN && event->count == 0);
+
+  event = &g_array_index(events, zathura_replay_event_t, 3);
+  fail_unless(event->action == ZATHURA_REPLAY_NAVIGATE);
+  fail_unless(event->argument == PREVIOUS);
+
+  event = &g_array_index(events, zathura_replay_event_t, 4);
+  fail_unless(event->action == ZATHURA_REPLAY_SEARCH);
+  fail_unless(g_strcmp0(event->text, "hello world") == 0);
+
+  event = &g_array_index(events, zathura_replay_event_t, 5);
+  fail_unless(event->delay == 500);
+  fail_unless(event->action == ZATHURA_REPLAY_WAIT);
+
+  zathura_replay_events_free(events);
+} END_TEST
+
+START_TEST(test_replay_parse_invalid) {
+  unsigned int error_line = 0;
+
+  fail_unless(zathura_replay_parse("0 scroll down\n10 scroll sideways\n", &error_line) == NULL);
+  fail_unless(error_line == 2);
+  fail_unless(zathura_replay_parse("scroll down\n", &error_line) == NULL);
+  fail_unless(error_line == 1);
+  fail_unless(zathura_replay_parse("-5 wait\n", NULL) == NULL);
+  fail_unless(zathura_replay_parse("0 zoom 0\n", NULL) == NULL);
+  fail_unless(zathura_replay_parse("0 zoom 150%\n", NULL) == NULL);
+  fail_unless(zathura_replay_parse("0 search\n", NULL) == NULL);
+  fail_unless(zathura_replay_parse("0 wait long\n", NULL) == NULL);
+  fail_unless(zathura_replay_parse("0 jump\n", NULL) == NULL);
+  fail_unless(zathura_replay_parse(NULL, NULL) == NULL);
+
+  /* an empty replay is valid */
+  GArray* events = zathura_replay_parse("# nothing\n", NULL);
+  fail_unless(events != NULL && events->len == 0);
+  zathura_replay_events_free(events);
+} END_TEST
+
+START_TEST(test_replay_percentile) {
+  const gint64 values[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+  fail_unless(zathura_replay_percentile(values, 10, 50) == 5);
+  fail_unless(zathura_replay_percentile(values, 10, 95) == 10);
+  fail_unless(zathura_replay_percentile(values, 10, 0) == 1);
+  fail_unless(zathura_replay_percentile(values, 10, 100) == 10);
+  fail_unless(zathura_replay_percentile(values, 1, 99) == 1);
+  fail_unless(zathura_replay_percentile(values, 0, 50) == 0);
+  fail_unless(zathura_replay_percentile(NULL, 10, 50) == 0);
+} END_TEST
+
+Suite* suite_replay()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Replay");
+
+  /* parse */
+  tcase = tcase_create("parse");
+  tcase_add_test(tcase, test_replay_parse);
+  tcase_add_test(tcase, test_replay_parse_invalid);
+  suite_add_tcase(suite, tcase);
+
+  /* report */
+  tcase = tcase_create("report");
+  tcase_add_test(tcase, test_replay_percentile);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
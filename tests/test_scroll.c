@@ -0,0 +1,67 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <math.h>
+
+#include "../scroll.h"
+
+START_TEST(test_scroll_ease) {
+  fail_unless(zathura_scroll_ease(100, 200, -1) == 100);
+  fail_unless(zathura_scroll_ease(100, 200, 0) == 100);
+  fail_unless(zathura_scroll_ease(100, 200, 1) == 200);
+  fail_unless(zathura_scroll_ease(100, 200, 2) == 200);
+
+  /* the movement slows down towards the destination */
+  const double half = zathura_scroll_ease(100, 200, 0.5);
+  fail_unless(half > 150 && half < 200);
+  fail_unless(zathura_scroll_ease(200, 100, 0.5) < 150);
+
+  double previous = 100;
+  for (unsigned int i = 1; i <= 10; i++) {
+    const double value = zathura_scroll_ease(100, 200, i / 10.0);
+    fail_unless(value >= previous);
+    previous = value;
+  }
+} END_TEST
+
+START_TEST(test_scroll_kinetic) {
+  double velocity = 1000;
+  double distance = 0;
+
+  /* the steps add up to the predicted distance */
+  for (unsigned int i = 0; i < 1000; i++) {
+    distance += zathura_scroll_kinetic_step(&velocity, 0.016, 0.325);
+  }
+  fail_unless(fabs(distance - zathura_scroll_kinetic_distance(1000, 0.325)) < 1);
+  fail_unless(velocity < 1);
+
+  /* the distance does not depend on the frame rate */
+  double slow = 2000;
+  double fast = 2000;
+  double slow_distance = zathura_scroll_kinetic_step(&slow, 0.1, 0.325);
+  double fast_distance = 0;
+  for (unsigned int i = 0; i < 10; i++) {
+    fast_distance += zathura_scroll_kinetic_step(&fast, 0.01, 0.325);
+  }
+  fail_unless(fabs(slow_distance - fast_distance) < 1e-6);
+  fail_unless(fabs(slow - fast) < 1e-6);
+
+  velocity = -500;
+  fail_unless(zathura_scroll_kinetic_step(&velocity, 0.1, 0.325) < 0);
+  fail_unless(zathura_scroll_kinetic_step(&velocity, 0, 0.325) == 0);
+  fail_unless(zathura_scroll_kinetic_step(NULL, 0.1, 0.325) == 0);
+} END_TEST
+
+Suite* suite_scroll()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Scroll");
+
+  /* animation */
+  tcase = tcase_create("animation");
+  tcase_add_test(tcase, test_scroll_ease);
+  tcase_add_test(tcase, test_scroll_kinetic);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
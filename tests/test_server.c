@@ -0,0 +1,190 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "../server.h"
+
+START_TEST(test_server_request) {
+  char* request = zathura_server_request_format("/tmp/a\tb\nc.pdf", "se\\cret", 4);
+  fail_unless(request != NULL);
+  fail_unless(g_str_has_suffix(request, "\n") == TRUE);
+  /* the request is a single line of four fields */
+  fail_unless(strchr(request, '\n') == request + strlen(request) - 1);
+
+  char* path     = NULL;
+  char* password = NULL;
+  int page_number = 0;
+  fail_unless(zathura_server_request_parse(request, &path, &password, &page_number) == true);
+  fail_unless(g_strcmp0(path, "/tmp/a\tb\nc.pdf") == 0);
+  fail_unless(g_strcmp0(password, "se\\cret") == 0);
+  fail_unless(page_number == 4);
+
+  g_free(path);
+  g_free(password);
+  g_free(request);
+} END_TEST
+
+START_TEST(test_server_request_trailing_space) {
+  char* request = zathura_server_request_format("/tmp/a.pdf ", NULL, 1);
+
+  char* path     = NULL;
+  char* password = NULL;
+  int page_number = 0;
+  fail_unless(zathura_server_request_parse(request, &path, &password, &page_number) == true);
+  fail_unless(g_strcmp0(path, "/tmp/a.pdf ") == 0);
+
+  g_free(path);
+  g_free(request);
+} END_TEST
+
+START_TEST(test_server_request_empty) {
+  char* request = zathura_server_request_format(NULL, NULL, ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+
+  char* path     = NULL;
+  char* password = NULL;
+  int page_number = 0;
+  fail_unless(zathura_server_request_parse(request, &path, &password, &page_number) == true);
+  fail_unless(path == NULL);
+  fail_unless(password == NULL);
+  fail_unless(page_number == ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+
+  g_free(request);
+} END_TEST
+
+START_TEST(test_server_request_invalid) {
+  char* path     = NULL;
+  char* password = NULL;
+  int page_number = 0;
+
+  fail_unless(zathura_server_request_parse(NULL, &path, &password, &page_number) == false);
+  fail_unless(zathura_server_request_parse("", &path, &password, &page_number) == false);
+  fail_unless(zathura_server_request_parse("close\t1\t\t/tmp/a.pdf", &path, &password, &page_number) == false);
+  fail_unless(zathura_server_request_parse("open\tx\t\t/tmp/a.pdf", &path, &password, &page_number) == false);
+  fail_unless(zathura_server_request_parse("open\t1\t/tmp/a.pdf", &path, &password, &page_number) == false);
+  fail_unless(path == NULL);
+  fail_unless(password == NULL);
+} END_TEST
+
+START_TEST(test_server_synctex_request) {
+  char* request = zathura_server_synctex_request_format("/tmp/a b.pdf", "12:0:/tmp/chapter\t1.tex");
+  fail_unless(request != NULL);
+  fail_unless(strchr(request, '\n') == request + strlen(request) - 1);
+
+  char* path     = NULL;
+  char* position = NULL;
+  fail_unless(zathura_server_synctex_request_parse(request, &path, &position) == true);
+  fail_unless(g_strcmp0(path, "/tmp/a b.pdf") == 0);
+  fail_unless(g_strcmp0(position, "12:0:/tmp/chapter\t1.tex") == 0);
+  g_free(path);
+  g_free(position);
+
+  /* open requests are no synctex requests and vice versa */
+  char* password = NULL;
+  int page_number = 0;
+  fail_unless(zathura_server_request_parse(request, &path, &password, &page_number) == false);
+  g_free(request);
+
+  request = zathura_server_request_format("/tmp/a.pdf", NULL, 1);
+  fail_unless(zathura_server_synctex_request_parse(request, &path, &position) == false);
+  fail_unless(zathura_server_synctex_request_parse("synctex\t\t/tmp/a.pdf", &path, &position) == false);
+  g_free(request);
+} END_TEST
+
+START_TEST(test_server_forward) {
+  char* files[] = { NULL };
+
+  /* nobody listens on the socket */
+  char** rejected = files;
+  fail_unless(zathura_server_forward("/nonexistent/zathura.socket", files, NULL,
+        ZATHURA_PAGE_NUMBER_UNSPECIFIED, &rejected) == false);
+  fail_unless(rejected == NULL);
+
+  /* stdin is never forwarded */
+  char* stdin_files[] = { "-", NULL };
+  fail_unless(zathura_server_forward("/nonexistent/zathura.socket", stdin_files,
+        NULL, ZATHURA_PAGE_NUMBER_UNSPECIFIED, NULL) == false);
+} END_TEST
+
+/* answers the requests of a single client with the given replies */
+static gpointer
+fake_server(gpointer data)
+{
+  const int fd = GPOINTER_TO_INT(data);
+  const int client = accept(fd, NULL, NULL);
+  if (client == -1) {
+    return NULL;
+  }
+
+  char buffer[256];
+  while (read(client, buffer, sizeof(buffer)) > 0) {
+  }
+
+  const char replies[] = "ok\nerror\nok\n";
+  fail_unless(write(client, replies, sizeof(replies) - 1) == (ssize_t) sizeof(replies) - 1);
+  close(client);
+
+  return NULL;
+}
+
+START_TEST(test_server_forward_rejected) {
+  char* dir = g_dir_make_tmp("zathura-test-XXXXXX", NULL);
+  fail_unless(dir != NULL);
+  char* socket_path = g_build_filename(dir, "socket", NULL);
+
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  g_strlcpy(address.sun_path, socket_path, sizeof(address.sun_path));
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  fail_unless(fd != -1);
+  fail_unless(bind(fd, (struct sockaddr*) &address, sizeof(address)) == 0);
+  fail_unless(listen(fd, 1) == 0);
+  GThread* thread = g_thread_new("server", fake_server, GINT_TO_POINTER(fd));
+
+  /* only the document the server has not opened is left */
+  char* files[] = { "/tmp/a.pdf", "/tmp/b.pdf", "/tmp/c.pdf", NULL };
+  char** rejected = NULL;
+  fail_unless(zathura_server_forward(socket_path, files, NULL,
+        ZATHURA_PAGE_NUMBER_UNSPECIFIED, &rejected) == false);
+  fail_unless(rejected != NULL);
+  fail_unless(g_strv_length(rejected) == 1);
+  fail_unless(g_strcmp0(rejected[0], "/tmp/b.pdf") == 0);
+  g_strfreev(rejected);
+
+  g_thread_join(thread);
+  close(fd);
+  g_unlink(socket_path);
+  g_rmdir(dir);
+  g_free(socket_path);
+  g_free(dir);
+} END_TEST
+
+Suite* suite_server()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Server");
+
+  /* requests */
+  tcase = tcase_create("request");
+  tcase_add_test(tcase, test_server_request);
+  tcase_add_test(tcase, test_server_request_trailing_space);
+  tcase_add_test(tcase, test_server_request_empty);
+  tcase_add_test(tcase, test_server_request_invalid);
+  tcase_add_test(tcase, test_server_synctex_request);
+  suite_add_tcase(suite, tcase);
+
+  /* clients */
+  tcase = tcase_create("forward");
+  tcase_add_test(tcase, test_server_forward);
+  tcase_add_test(tcase, test_server_forward_rejected);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
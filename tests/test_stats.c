@@ -0,0 +1,146 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <string.h>
+
+#include "../stats.h"
+
+START_TEST(test_stats_add) {
+  zathura_stats_t* stats = zathura_stats_new();
+  fail_unless(stats != NULL);
+
+  zathura_stats_add(stats, ZATHURA_STAT_RENDER, 300);
+  zathura_stats_add(stats, ZATHURA_STAT_RENDER, 100);
+  zathura_stats_add(stats, ZATHURA_STAT_SCROLL, 50);
+
+  zathura_stat_value_t value;
+  zathura_stats_get(stats, ZATHURA_STAT_RENDER, &value);
+  fail_unless(value.count == 2);
+  fail_unless(value.total == 400);
+  fail_unless(value.max == 300);
+
+  zathura_stats_get(stats, ZATHURA_STAT_RECOLOR, &value);
+  fail_unless(value.count == 0 && value.total == 0 && value.max == 0);
+
+  zathura_stats_free(stats);
+} END_TEST
+
+START_TEST(test_stats_queue_depth) {
+  zathura_stats_t* stats = zathura_stats_new();
+
+  zathura_stats_set_queue_depth(stats, 4);
+  zathura_stats_set_queue_depth(stats, 1);
+
+  unsigned int current = 0;
+  unsigned int max     = 0;
+  zathura_stats_get_queue_depth(stats, &current, &max);
+  fail_unless(current == 1);
+  fail_unless(max == 4);
+
+  zathura_stats_free(stats);
+} END_TEST
+
+START_TEST(test_stats_count) {
+  zathura_stats_t* stats = zathura_stats_new();
+
+  zathura_stats_count(stats, ZATHURA_COUNTER_SURFACE_KEPT);
+  zathura_stats_count(stats, ZATHURA_COUNTER_SURFACE_KEPT);
+  zathura_stats_count(stats, ZATHURA_COUNTER_SURFACE_INVALIDATED);
+  zathura_stats_count(stats, ZATHURA_COUNTER_SURFACE_UPLOADED);
+  zathura_stats_count(stats, ZATHURA_COUNTER_N);
+
+  fail_unless(zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_KEPT) == 2);
+  fail_unless(zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_INVALIDATED) == 1);
+  fail_unless(zathura_stats_get_count(stats, ZATHURA_COUNTER_N) == 0);
+
+  char* json = zathura_stats_to_json(stats, NULL, NULL);
+  fail_unless(strstr(json, "\"surfaces\": {\"kept\": 2, \"invalidated\": 1, \"uploaded\": 1}") != NULL);
+  g_free(json);
+
+  zathura_stats_reset(stats);
+  fail_unless(zathura_stats_get_count(stats, ZATHURA_COUNTER_SURFACE_KEPT) == 0);
+
+  zathura_stats_free(stats);
+} END_TEST
+
+START_TEST(test_stats_reset) {
+  zathura_stats_t* stats = zathura_stats_new();
+
+  zathura_stats_add(stats, ZATHURA_STAT_HANDOFF, 10);
+  zathura_stats_set_queue_depth(stats, 3);
+  zathura_stats_reset(stats);
+
+  zathura_stat_value_t value;
+  zathura_stats_get(stats, ZATHURA_STAT_HANDOFF, &value);
+  fail_unless(value.count == 0 && value.total == 0 && value.max == 0);
+
+  unsigned int max = 1;
+  zathura_stats_get_queue_depth(stats, NULL, &max);
+  fail_unless(max == 0);
+
+  zathura_stats_free(stats);
+} END_TEST
+
+START_TEST(test_stats_invalid) {
+  /* a missing set of statistics is ignored */
+  zathura_stats_add(NULL, ZATHURA_STAT_RENDER, 10);
+  zathura_stats_reset(NULL);
+  zathura_stats_free(NULL);
+
+  zathura_stat_value_t value = { 1, 1, 1 };
+  zathura_stats_get(NULL, ZATHURA_STAT_RENDER, &value);
+  fail_unless(value.count == 0);
+
+  fail_unless(zathura_stats_get_name(ZATHURA_STAT_N) == NULL);
+  fail_unless(strcmp(zathura_stats_get_name(ZATHURA_STAT_QUEUE_DELAY), "queue-delay") == 0);
+} END_TEST
+
+START_TEST(test_stats_json) {
+  zathura_stats_t* stats = zathura_stats_new();
+  zathura_stats_add(stats, ZATHURA_STAT_RENDER, 1500);
+
+  zathura_page_cache_statistics_t cache = {
+    .hits = 3, .misses = 1, .evictions = 0, .entries = 2, .bytes = 2048, .max_bytes = 4096
+  };
+
+  char* json = zathura_stats_to_json(stats, &cache, NULL);
+  fail_unless(json != NULL);
+  fail_unless(json[0] == '{' && json[strlen(json) - 1] == '}');
+  fail_unless(strstr(json, "\"render\": {\"count\": 1, \"total_us\": 1500, \"max_us\": 1500}") != NULL);
+  fail_unless(strstr(json, "\"hit_rate\": 0.7500") != NULL);
+  g_free(json);
+
+  /* the cache is optional */
+  json = zathura_stats_to_json(stats, NULL, NULL);
+  fail_unless(strstr(json, "\"cache\"") == NULL);
+  g_free(json);
+
+  char* string = zathura_stats_to_string(stats, &cache, NULL);
+  fail_unless(strstr(string, "render: 1, avg 1.50 ms, max 1.50 ms") != NULL);
+  fail_unless(strstr(string, "75.0% hits") != NULL);
+  g_free(string);
+
+  zathura_stats_free(stats);
+} END_TEST
+
+Suite* suite_stats()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Stats");
+
+  /* measurements */
+  tcase = tcase_create("measurements");
+  tcase_add_test(tcase, test_stats_add);
+  tcase_add_test(tcase, test_stats_queue_depth);
+  tcase_add_test(tcase, test_stats_count);
+  tcase_add_test(tcase, test_stats_reset);
+  tcase_add_test(tcase, test_stats_invalid);
+  suite_add_tcase(suite, tcase);
+
+  /* reports */
+  tcase = tcase_create("reports");
+  tcase_add_test(tcase, test_stats_json);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,111 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "../stream.h"
+
+static char*
+read_file(const char* path)
+{
+  char* content = NULL;
+  fail_unless(g_file_get_contents(path, &content, NULL, NULL) == TRUE);
+  return content;
+}
+
+START_TEST(test_stream_copy_pipe) {
+  int fds[2];
+  fail_unless(pipe(fds) == 0);
+
+  const char data[] = "%PDF-1.4 arriving through a pipe";
+  fail_unless(write(fds[1], data, strlen(data)) == (ssize_t) strlen(data));
+  close(fds[1]);
+
+  int fd = -1;
+  char* file = zathura_stream_create_file(&fd);
+  fail_unless(file != NULL);
+  fail_unless(fd != -1);
+
+  gint progress = -1;
+  fail_unless(zathura_stream_copy(fds[0], fd, NULL, &progress) == true);
+  fail_unless(progress == 0);
+  close(fds[0]);
+  close(fd);
+
+  char* content = read_file(file);
+  fail_unless(g_strcmp0(content, data) == 0);
+  g_free(content);
+
+  g_unlink(file);
+  g_free(file);
+} END_TEST
+
+START_TEST(test_stream_copy_file) {
+  char* source = NULL;
+  int source_fd = g_file_open_tmp("zathura-test-XXXXXX", &source, NULL);
+  fail_unless(source_fd != -1);
+
+  /* more than a KiB to see the progress */
+  char data[4096];
+  memset(data, 'x', sizeof(data));
+  fail_unless(write(source_fd, data, sizeof(data)) == (ssize_t) sizeof(data));
+  fail_unless(lseek(source_fd, 0, SEEK_SET) == 0);
+
+  int fd = -1;
+  char* file = zathura_stream_create_file(&fd);
+  fail_unless(file != NULL);
+
+  gint progress = 0;
+  fail_unless(zathura_stream_copy(source_fd, fd, NULL, &progress) == true);
+  fail_unless(progress == 4);
+  close(source_fd);
+  close(fd);
+
+  char* content = read_file(file);
+  fail_unless(strlen(content) == sizeof(data));
+  g_free(content);
+
+  g_unlink(file);
+  g_unlink(source);
+  g_free(file);
+  g_free(source);
+} END_TEST
+
+START_TEST(test_stream_copy_cancel) {
+  fail_unless(zathura_stream_copy(-1, 1, NULL, NULL) == false);
+
+  /* nothing arrives, but the writer is still there */
+  int fds[2];
+  fail_unless(pipe(fds) == 0);
+
+  int fd = -1;
+  char* file = zathura_stream_create_file(&fd);
+  fail_unless(file != NULL);
+
+  gint cancel = 1;
+  fail_unless(zathura_stream_copy(fds[0], fd, &cancel, NULL) == false);
+
+  close(fds[0]);
+  close(fds[1]);
+  close(fd);
+  g_unlink(file);
+  g_free(file);
+} END_TEST
+
+Suite* suite_stream()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Stream");
+
+  /* copy */
+  tcase = tcase_create("copy");
+  tcase_add_test(tcase, test_stream_copy_pipe);
+  tcase_add_test(tcase, test_stream_copy_file);
+  tcase_add_test(tcase, test_stream_copy_cancel);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,100 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+
+#include "../surface-pool.h"
+
+START_TEST(test_surface_pool_reuse) {
+  zathura_surface_pool_t* pool = zathura_surface_pool_new(1024 * 1024);
+  fail_unless(pool != NULL);
+
+  cairo_surface_t* surface = zathura_surface_pool_create(pool, CAIRO_FORMAT_RGB24, 100, 50);
+  fail_unless(surface != NULL);
+  fail_unless(cairo_image_surface_get_width(surface) == 100);
+  fail_unless(cairo_image_surface_get_height(surface) == 50);
+  unsigned char* data = cairo_image_surface_get_data(surface);
+  cairo_surface_destroy(surface);
+
+  zathura_surface_pool_statistics_t statistics;
+  zathura_surface_pool_get_statistics(pool, &statistics);
+  fail_unless(statistics.allocated == 1);
+  fail_unless(statistics.buffers == 1);
+  fail_unless(statistics.bytes == (size_t) cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, 100) * 50);
+
+  /* the same dimensions get the buffer again */
+  surface = zathura_surface_pool_create(pool, CAIRO_FORMAT_RGB24, 100, 50);
+  fail_unless(cairo_image_surface_get_data(surface) == data);
+  zathura_surface_pool_get_statistics(pool, &statistics);
+  fail_unless(statistics.reused == 1);
+  fail_unless(statistics.buffers == 0 && statistics.bytes == 0);
+
+  /* other dimensions or formats do not */
+  cairo_surface_t* other = zathura_surface_pool_create(pool, CAIRO_FORMAT_ARGB32, 100, 50);
+  cairo_surface_destroy(other);
+  other = zathura_surface_pool_create(pool, CAIRO_FORMAT_RGB24, 50, 100);
+  zathura_surface_pool_get_statistics(pool, &statistics);
+  fail_unless(statistics.reused == 1);
+  fail_unless(statistics.allocated == 3);
+
+  cairo_surface_destroy(other);
+  cairo_surface_destroy(surface);
+  zathura_surface_pool_free(pool);
+} END_TEST
+
+START_TEST(test_surface_pool_limit) {
+  const size_t bytes = (size_t) cairo_format_stride_for_width(CAIRO_FORMAT_RGB24, 64) * 64;
+  zathura_surface_pool_t* pool = zathura_surface_pool_new(bytes);
+
+  cairo_surface_t* first  = zathura_surface_pool_create(pool, CAIRO_FORMAT_RGB24, 64, 64);
+  cairo_surface_t* second = zathura_surface_pool_create(pool, CAIRO_FORMAT_RGB24, 64, 64);
+  cairo_surface_destroy(first);
+  cairo_surface_destroy(second);
+
+  /* only one buffer fits into the pool */
+  zathura_surface_pool_statistics_t statistics;
+  zathura_surface_pool_get_statistics(pool, &statistics);
+  fail_unless(statistics.buffers == 1);
+  fail_unless(statistics.dropped == 1);
+
+  zathura_surface_pool_clear(pool);
+  zathura_surface_pool_get_statistics(pool, &statistics);
+  fail_unless(statistics.buffers == 0 && statistics.bytes == 0);
+
+  zathura_surface_pool_free(pool);
+} END_TEST
+
+START_TEST(test_surface_pool_outlive) {
+  zathura_surface_pool_t* pool = zathura_surface_pool_new(1024 * 1024);
+  cairo_surface_t* surface = zathura_surface_pool_create(pool, CAIRO_FORMAT_RGB24, 10, 10);
+
+  /* surfaces stay valid after the pool has been freed */
+  zathura_surface_pool_free(pool);
+  fail_unless(cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS);
+  cairo_surface_destroy(surface);
+
+  /* without a pool new surfaces are allocated */
+  surface = zathura_surface_pool_create(NULL, CAIRO_FORMAT_RGB24, 10, 10);
+  fail_unless(surface != NULL);
+  cairo_surface_destroy(surface);
+
+  fail_unless(zathura_surface_pool_create(NULL, CAIRO_FORMAT_RGB24, 0, 10) == NULL);
+} END_TEST
+
+Suite* suite_surface_pool()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Surface pool");
+
+  /* reuse */
+  tcase = tcase_create("reuse");
+  tcase_add_test(tcase, test_surface_pool_reuse);
+  tcase_add_test(tcase, test_surface_pool_limit);
+  suite_add_tcase(suite, tcase);
+
+  /* lifetime */
+  tcase = tcase_create("lifetime");
+  tcase_add_test(tcase, test_surface_pool_outlive);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,246 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <math.h>
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "../synctex.h"
+
+/* the coordinates are multiples of points in scaled points */
+static const char synctex_content[] =
+  "SyncTeX Version:1\n"
+  "Input:1:./doc.tex\n"
+  "Input:2:chapter.tex\n"
+  "Output:pdf\n"
+  "Magnification:1000\n"
+  "Unit:1\n"
+  "X Offset:0\n"
+  "Y Offset:0\n"
+  "Content:\n"
+  "!100\n"
+  "{1\n"
+  "[1,5:4736287,44205343:26312704,39469056,0\n"
+  "(1,10:4736287,5736175:26312704,657818,131564\n"
+  "x1,8:5736175,5736175\n"
+  "g1,9:15734997,5736175\n"
+  ")\n"
+  "(2,3:4736287,7735935:26312704,657818,131564\n"
+  ")\n"
+  "]\n"
+  "}1\n"
+  "{2\n"
+  "(1,20:4736287,4736287:6578176,657818,0\n"
+  ")\n"
+  "}2\n"
+  "Postamble:\n"
+  "Count:9\n"
+  "!200\n"
+  "Post scriptum:\n";
+
+static char* directory = NULL;
+static char* document  = NULL;
+static char* file      = NULL;
+
+static void
+setup_synctex(void)
+{
+  directory = g_dir_make_tmp("zathura-synctex-XXXXXX", NULL);
+  fail_unless(directory != NULL);
+
+  document = g_build_filename(directory, "doc.pdf", NULL);
+  file     = g_build_filename(directory, "doc.synctex", NULL);
+  fail_unless(g_file_set_contents(file, synctex_content, -1, NULL) == TRUE);
+
+  /* the main file exists, so that it is matched by its path */
+  char* source = g_build_filename(directory, "doc.tex", NULL);
+  fail_unless(g_file_set_contents(source, "", -1, NULL) == TRUE);
+  g_free(source);
+}
+
+static void
+teardown_synctex(void)
+{
+  char* source = g_build_filename(directory, "doc.tex", NULL);
+  g_unlink(source);
+  g_free(source);
+  g_unlink(file);
+  g_rmdir(directory);
+
+  g_free(file);
+  g_free(document);
+  g_free(directory);
+}
+
+static bool
+is_close(double a, double b)
+{
+  return fabs(a - b) < 0.01;
+}
+
+static zathura_synctex_box_t*
+forward_single(zathura_synctex_t* synctex, const char* input, unsigned int line)
+{
+  girara_list_t* boxes = zathura_synctex_forward(synctex, input, line);
+  fail_unless(boxes != NULL);
+  fail_unless(girara_list_size(boxes) == 1);
+
+  zathura_synctex_box_t* box = g_malloc(sizeof(zathura_synctex_box_t));
+  *box = *(zathura_synctex_box_t*) girara_list_nth(boxes, 0);
+  girara_list_free(boxes);
+
+  return box;
+}
+
+START_TEST(test_synctex_forward) {
+  zathura_synctex_t* synctex = zathura_synctex_new(document);
+  fail_unless(synctex != NULL);
+  fail_unless(zathura_synctex_update(synctex) == true);
+
+  /* the line of a box */
+  zathura_synctex_box_t* box = forward_single(synctex, "doc.tex", 10);
+  fail_unless(box->page == 0);
+  fail_unless(is_close(box->rectangle.x1, 72));
+  fail_unless(is_close(box->rectangle.x2, 472));
+  fail_unless(is_close(box->rectangle.y1, 77.2));
+  fail_unless(is_close(box->rectangle.y2, 89.2));
+  g_free(box);
+
+  /* points are shown as their box */
+  char* source = g_build_filename(directory, "doc.tex", NULL);
+  box = forward_single(synctex, source, 8);
+  g_free(source);
+  fail_unless(box->page == 0);
+  fail_unless(is_close(box->rectangle.y1, 77.2));
+  g_free(box);
+
+  /* lines without nodes are shown as the closest line */
+  box = forward_single(synctex, "doc.tex", 7);
+  fail_unless(is_close(box->rectangle.y1, 77.2));
+  g_free(box);
+
+  box = forward_single(synctex, "doc.tex", 15);
+  fail_unless(box->page == 1);
+  fail_unless(is_close(box->rectangle.x2, 172));
+  g_free(box);
+
+  /* vertical boxes are only shown if there is nothing else */
+  box = forward_single(synctex, "doc.tex", 5);
+  fail_unless(box->page == 0);
+  fail_unless(is_close(box->rectangle.y2, 672));
+  g_free(box);
+
+  /* files that do not exist are found by their name */
+  box = forward_single(synctex, "/elsewhere/chapter.tex", 3);
+  fail_unless(box->page == 0);
+  fail_unless(is_close(box->rectangle.y1, 107.6));
+  g_free(box);
+
+  fail_unless(zathura_synctex_forward(synctex, "unknown.tex", 1) == NULL);
+
+  zathura_synctex_free(synctex);
+} END_TEST
+
+START_TEST(test_synctex_backward) {
+  zathura_synctex_t* synctex = zathura_synctex_new(document);
+
+  char* input = NULL;
+  unsigned int line = 0;
+  int column = 0;
+
+  /* the closest point in the smallest box */
+  fail_unless(zathura_synctex_backward(synctex, 0, 100, 85, &input, &line, &column) == true);
+  fail_unless(g_str_has_suffix(input, "/doc.tex") == TRUE);
+  fail_unless(line == 8);
+  fail_unless(column == -1);
+  g_free(input);
+
+  fail_unless(zathura_synctex_backward(synctex, 0, 300, 85, &input, &line, &column) == true);
+  fail_unless(line == 9);
+  g_free(input);
+
+  /* a box without points */
+  fail_unless(zathura_synctex_backward(synctex, 0, 100, 115, &input, &line, &column) == true);
+  fail_unless(g_str_has_suffix(input, "/chapter.tex") == TRUE);
+  fail_unless(line == 3);
+  g_free(input);
+
+  /* the closest box if there is none at the point */
+  fail_unless(zathura_synctex_backward(synctex, 1, 500, 500, &input, &line, &column) == true);
+  fail_unless(line == 20);
+  g_free(input);
+
+  fail_unless(zathura_synctex_backward(synctex, 2, 100, 100, &input, &line, &column) == false);
+
+  zathura_synctex_free(synctex);
+} END_TEST
+
+START_TEST(test_synctex_update) {
+  zathura_synctex_t* synctex = zathura_synctex_new(document);
+  fail_unless(zathura_synctex_update(synctex) == true);
+
+  /* the file is read again once it has been written again */
+  char* content = g_strdup(synctex_content);
+  char* changed = strstr(content, "(1,10:");
+  fail_unless(changed != NULL);
+  char* replaced = g_strdup_printf("%.*s(1,100:%s", (int) (changed - content), content,
+      changed + strlen("(1,10:"));
+  fail_unless(g_file_set_contents(file, replaced, -1, NULL) == TRUE);
+  g_free(replaced);
+  g_free(content);
+
+  zathura_synctex_box_t* box = forward_single(synctex, "doc.tex", 100);
+  fail_unless(is_close(box->rectangle.y1, 77.2));
+  g_free(box);
+
+  /* without the file there is no index */
+  g_unlink(file);
+  fail_unless(zathura_synctex_update(synctex) == false);
+  fail_unless(zathura_synctex_forward(synctex, "doc.tex", 100) == NULL);
+
+  zathura_synctex_free(synctex);
+} END_TEST
+
+START_TEST(test_synctex_position) {
+  char* input = NULL;
+  unsigned int line = 0;
+  int column = 0;
+
+  fail_unless(synctex_parse_position("12:3:/tmp/a:b.tex", &input, &line, &column) == true);
+  fail_unless(line == 12);
+  fail_unless(column == 3);
+  fail_unless(g_strcmp0(input, "/tmp/a:b.tex") == 0);
+  g_free(input);
+
+  fail_unless(synctex_parse_position("12:-1:a.tex", &input, &line, &column) == true);
+  fail_unless(column == -1);
+  g_free(input);
+
+  fail_unless(synctex_parse_position(NULL, &input, &line, &column) == false);
+  fail_unless(synctex_parse_position("12", &input, &line, &column) == false);
+  fail_unless(synctex_parse_position("12:3", &input, &line, &column) == false);
+  fail_unless(synctex_parse_position("12:3:", &input, &line, &column) == false);
+  fail_unless(synctex_parse_position("x:3:a.tex", &input, &line, &column) == false);
+} END_TEST
+
+Suite* suite_synctex()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("SyncTeX");
+
+  /* index */
+  tcase = tcase_create("index");
+  tcase_add_checked_fixture(tcase, setup_synctex, teardown_synctex);
+  tcase_add_test(tcase, test_synctex_forward);
+  tcase_add_test(tcase, test_synctex_backward);
+  tcase_add_test(tcase, test_synctex_update);
+  suite_add_tcase(suite, tcase);
+
+  /* positions */
+  tcase = tcase_create("position");
+  tcase_add_test(tcase, test_synctex_position);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,126 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "../text-index.h"
+
+START_TEST(test_text_index_match) {
+  zathura_text_index_t* index = zathura_text_index_new("/tmp/document.pdf", 1, 2, 3);
+  fail_unless(index != NULL);
+
+  fail_unless(zathura_text_index_match(index, 0, "text") == ZATHURA_TEXT_INDEX_UNKNOWN);
+  fail_unless(zathura_text_index_match(index, 3, "text") == ZATHURA_TEXT_INDEX_UNKNOWN);
+
+  zathura_text_index_set_page(index, 0, "Some text\nspanning  two lines");
+  zathura_text_index_set_page(index, 1, "Other words");
+
+  fail_unless(zathura_text_index_match(index, 0, "text") == ZATHURA_TEXT_INDEX_MATCH);
+  fail_unless(zathura_text_index_match(index, 2, "text") == ZATHURA_TEXT_INDEX_UNKNOWN);
+
+  /* the plugin may still find a query the indexed text does not contain */
+  fail_unless(zathura_text_index_match(index, 1, "text") == ZATHURA_TEXT_INDEX_UNKNOWN);
+
+  /* case and white space are ignored */
+  fail_unless(zathura_text_index_match(index, 0, "SOME TEXT") == ZATHURA_TEXT_INDEX_MATCH);
+  fail_unless(zathura_text_index_match(index, 0, "text spanning two") == ZATHURA_TEXT_INDEX_MATCH);
+  fail_unless(zathura_text_index_match(index, 0, "lines ") == ZATHURA_TEXT_INDEX_MATCH);
+
+  zathura_text_index_free(index);
+} END_TEST
+
+START_TEST(test_text_index_miss) {
+  zathura_text_index_t* index = zathura_text_index_new("/tmp/document.pdf", 1, 2, 2);
+  fail_unless(index != NULL);
+
+  zathura_text_index_set_page(index, 0, "Some text");
+  zathura_text_index_set_page(index, 1, " ");
+
+  /* misses reported by the plugin rule a page out */
+  zathura_text_index_set_miss(index, 0, "other");
+  zathura_text_index_set_miss(index, 2, "other");
+  fail_unless(zathura_text_index_match(index, 0, "other") == ZATHURA_TEXT_INDEX_NO_MATCH);
+  fail_unless(zathura_text_index_match(index, 0, "Other") == ZATHURA_TEXT_INDEX_UNKNOWN);
+  fail_unless(zathura_text_index_match(index, 0, "text") == ZATHURA_TEXT_INDEX_MATCH);
+
+  /* as do pages without any text */
+  fail_unless(zathura_text_index_match(index, 1, "text") == ZATHURA_TEXT_INDEX_NO_MATCH);
+
+  /* only the latest misses are remembered */
+  for (unsigned int i = 0; i < 64; i++) {
+    char query[16];
+    g_snprintf(query, sizeof(query), "query %u", i);
+    zathura_text_index_set_miss(index, 0, query);
+  }
+  fail_unless(zathura_text_index_match(index, 0, "other") == ZATHURA_TEXT_INDEX_UNKNOWN);
+  fail_unless(zathura_text_index_match(index, 0, "query 63") == ZATHURA_TEXT_INDEX_NO_MATCH);
+
+  zathura_text_index_free(index);
+} END_TEST
+
+START_TEST(test_text_index_empty_page) {
+  zathura_text_index_t* index = zathura_text_index_new("/tmp/document.pdf", 1, 2, 2);
+  fail_unless(index != NULL);
+
+  /* pages that have not been indexed might contain text */
+  fail_unless(zathura_text_index_is_empty_page(index, 0) == false);
+
+  zathura_text_index_set_page(index, 0, " \n\t");
+  zathura_text_index_set_page(index, 1, "text");
+  fail_unless(zathura_text_index_is_empty_page(index, 0) == true);
+  fail_unless(zathura_text_index_is_empty_page(index, 1) == false);
+  fail_unless(zathura_text_index_is_empty_page(index, 2) == false);
+
+  zathura_text_index_free(index);
+} END_TEST
+
+START_TEST(test_text_index_save_load) {
+  char* dir  = g_dir_make_tmp("zathura-test-XXXXXX", NULL);
+  fail_unless(dir != NULL);
+  char* file = zathura_text_index_get_file(dir, "/tmp/document.pdf");
+  fail_unless(file != NULL);
+
+  zathura_text_index_t* index = zathura_text_index_new("/tmp/document.pdf", 10, 20, 2);
+  zathura_text_index_set_page(index, 1, "Second page");
+  zathura_text_index_set_miss(index, 1, "first; page");
+  fail_unless(zathura_text_index_save(index, file) == true);
+  zathura_text_index_free(index);
+
+  index = zathura_text_index_load(file, "/tmp/document.pdf", 10, 20, 2);
+  fail_unless(index != NULL);
+  fail_unless(zathura_text_index_match(index, 0, "page") == ZATHURA_TEXT_INDEX_UNKNOWN);
+  fail_unless(zathura_text_index_match(index, 1, "page") == ZATHURA_TEXT_INDEX_MATCH);
+  fail_unless(zathura_text_index_match(index, 1, "first; page") == ZATHURA_TEXT_INDEX_NO_MATCH);
+  zathura_text_index_free(index);
+
+  /* the index of another version of the document is not used */
+  fail_unless(zathura_text_index_load(file, "/tmp/document.pdf", 11, 20, 2) == NULL);
+  fail_unless(zathura_text_index_load(file, "/tmp/document.pdf", 10, 21, 2) == NULL);
+  fail_unless(zathura_text_index_load(file, "/tmp/document.pdf", 10, 20, 3) == NULL);
+  fail_unless(zathura_text_index_load(file, "/tmp/other.pdf", 10, 20, 2) == NULL);
+
+  g_unlink(file);
+  char* index_dir = g_path_get_dirname(file);
+  g_rmdir(index_dir);
+  g_rmdir(dir);
+  g_free(index_dir);
+  g_free(file);
+  g_free(dir);
+} END_TEST
+
+Suite* suite_text_index()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Text index");
+
+  /* basic */
+  tcase = tcase_create("basic");
+  tcase_add_test(tcase, test_text_index_match);
+  tcase_add_test(tcase, test_text_index_miss);
+  tcase_add_test(tcase, test_text_index_empty_page);
+  tcase_add_test(tcase, test_text_index_save_load);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
@@ -0,0 +1,132 @@
+/* See LICENSE file for license and copyright information */
+
+#include <check.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "../thumbnail-cache.h"
+
+static char* data_dir = NULL;
+
+static void
+setup_thumbnail_cache(void)
+{
+  data_dir = g_dir_make_tmp("zathura-test-XXXXXX", NULL);
+  fail_unless(data_dir != NULL);
+}
+
+static void
+remove_directory(const char* dir)
+{
+  GDir* handle = g_dir_open(dir, 0, NULL);
+  if (handle != NULL) {
+    const char* name = NULL;
+    while ((name = g_dir_read_name(handle)) != NULL) {
+      char* file = g_build_filename(dir, name, NULL);
+      if (g_file_test(file, G_FILE_TEST_IS_DIR) == TRUE) {
+        remove_directory(file);
+      } else {
+        g_unlink(file);
+      }
+      g_free(file);
+    }
+    g_dir_close(handle);
+  }
+  g_rmdir(dir);
+}
+
+static void
+teardown_thumbnail_cache(void)
+{
+  remove_directory(data_dir);
+  g_free(data_dir);
+  data_dir = NULL;
+}
+
+static cairo_surface_t*
+create_thumbnail(void)
+{
+  cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, 12, 16);
+  cairo_t* cairo = cairo_create(surface);
+  cairo_set_source_rgb(cairo, 1, 0, 0);
+  cairo_paint(cairo);
+  cairo_destroy(cairo);
+
+  return surface;
+}
+
+START_TEST(test_thumbnail_cache_new) {
+  fail_unless(zathura_thumbnail_cache_new(NULL, "/tmp/document.pdf", 1, 2, 16) == NULL);
+  fail_unless(zathura_thumbnail_cache_new(data_dir, NULL, 1, 2, 16) == NULL);
+  fail_unless(zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 1, 2, 0) == NULL);
+
+  zathura_thumbnail_cache_t* cache = zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 1, 2, 16);
+  fail_unless(cache != NULL);
+  fail_unless(zathura_thumbnail_cache_get_size(cache) == 16);
+  fail_unless(zathura_thumbnail_cache_get(cache, 0) == NULL);
+  zathura_thumbnail_cache_free(cache);
+} END_TEST
+
+START_TEST(test_thumbnail_cache_add_get) {
+  zathura_thumbnail_cache_t* cache = zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 1, 2, 16);
+  fail_unless(cache != NULL);
+
+  cairo_surface_t* thumbnail = create_thumbnail();
+  fail_unless(zathura_thumbnail_cache_add(cache, 3, thumbnail) == true);
+  cairo_surface_destroy(thumbnail);
+  zathura_thumbnail_cache_free(cache);
+
+  /* the thumbnails are kept for the next session */
+  cache = zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 1, 2, 16);
+  fail_unless(cache != NULL);
+  fail_unless(zathura_thumbnail_cache_get(cache, 2) == NULL);
+
+  cairo_surface_t* surface = zathura_thumbnail_cache_get(cache, 3);
+  fail_unless(surface != NULL);
+  fail_unless(cairo_image_surface_get_width(surface) == 12);
+  fail_unless(cairo_image_surface_get_height(surface) == 16);
+  cairo_surface_destroy(surface);
+  zathura_thumbnail_cache_free(cache);
+} END_TEST
+
+START_TEST(test_thumbnail_cache_outdated) {
+  zathura_thumbnail_cache_t* cache = zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 1, 2, 16);
+  cairo_surface_t* thumbnail = create_thumbnail();
+  fail_unless(zathura_thumbnail_cache_add(cache, 0, thumbnail) == true);
+  cairo_surface_destroy(thumbnail);
+  zathura_thumbnail_cache_free(cache);
+
+  /* another size of the thumbnails */
+  cache = zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 1, 2, 32);
+  fail_unless(cache != NULL);
+  fail_unless(zathura_thumbnail_cache_get(cache, 0) == NULL);
+  zathura_thumbnail_cache_free(cache);
+
+  /* another version of the document */
+  cache = zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 1, 2, 32);
+  thumbnail = create_thumbnail();
+  fail_unless(zathura_thumbnail_cache_add(cache, 0, thumbnail) == true);
+  cairo_surface_destroy(thumbnail);
+  zathura_thumbnail_cache_free(cache);
+
+  cache = zathura_thumbnail_cache_new(data_dir, "/tmp/document.pdf", 3, 2, 32);
+  fail_unless(cache != NULL);
+  fail_unless(zathura_thumbnail_cache_get(cache, 0) == NULL);
+  zathura_thumbnail_cache_free(cache);
+} END_TEST
+
+Suite* suite_thumbnail_cache()
+{
+  TCase* tcase = NULL;
+  Suite* suite = suite_create("Thumbnail cache");
+
+  /* basic */
+  tcase = tcase_create("basic");
+  tcase_add_checked_fixture(tcase, setup_thumbnail_cache, teardown_thumbnail_cache);
+  tcase_add_test(tcase, test_thumbnail_cache_new);
+  tcase_add_test(tcase, test_thumbnail_cache_add_get);
+  tcase_add_test(tcase, test_thumbnail_cache_outdated);
+  suite_add_tcase(suite, tcase);
+
+  return suite;
+}
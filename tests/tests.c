@@ -9,6 +9,31 @@
 extern Suite* suite_session();
 extern Suite* suite_utils();
 extern Suite* suite_document();
+extern Suite* suite_page_cache();
+extern Suite* suite_recolor();
+extern Suite* suite_page_layout();
+extern Suite* suite_text_index();
+extern Suite* suite_prefetch();
+extern Suite* suite_thumbnail_cache();
+extern Suite* suite_render();
+extern Suite* suite_render_cache();
+extern Suite* suite_stats();
+extern Suite* suite_replay();
+extern Suite* suite_export();
+extern Suite* suite_surface_pool();
+extern Suite* suite_memory_monitor();
+extern Suite* suite_document_index();
+extern Suite* suite_database_plain();
+extern Suite* suite_history_store();
+extern Suite* suite_server();
+extern Suite* suite_plugin();
+extern Suite* suite_stream();
+extern Suite* suite_synctex();
+extern Suite* suite_readahead();
+extern Suite* suite_dir_cache();
+extern Suite* suite_scroll();
+extern Suite* suite_bookmarks();
+extern Suite* suite_bench_compare();
 
 typedef Suite* (*suite_create_fnt_t)(void);
 
@@ -16,6 +41,31 @@ const suite_create_fnt_t suites[] = {
   suite_utils,
   suite_document,
   suite_session,
+  suite_page_cache,
+  suite_recolor,
+  suite_page_layout,
+  suite_text_index,
+  suite_prefetch,
+  suite_thumbnail_cache,
+  suite_render,
+  suite_render_cache,
+  suite_stats,
+  suite_replay,
+  suite_export,
+  suite_surface_pool,
+  suite_memory_monitor,
+  suite_document_index,
+  suite_database_plain,
+  suite_history_store,
+  suite_server,
+  suite_plugin,
+  suite_stream,
+  suite_synctex,
+  suite_readahead,
+  suite_dir_cache,
+  suite_scroll,
+  suite_bookmarks,
+  suite_bench_compare,
 };
 
 int
@@ -0,0 +1,334 @@
+/* See LICENSE file for license and copyright information */
+
+#include <string.h>
+#include <girara/utils.h>
+
+#include "glib-compat.h"
+#include "text-index.h"
+
+#define GROUP_INDEX "index"
+#define GROUP_TEXT "text"
+#define GROUP_MISSES "misses"
+
+#define KEY_PATH "path"
+#define KEY_MTIME "mtime"
+#define KEY_SIZE "size"
+#define KEY_PAGES "pages"
+
+/* number of queries whose misses are remembered per page */
+#define MAX_MISSES 32
+
+struct zathura_text_index_s {
+  char* path; /**< Path of the document */
+  gint64 mtime; /**< Modification time of the document */
+  gint64 size; /**< Size of the document */
+  unsigned int number_of_pages; /**< Number of pages */
+  char** pages; /**< Normalized text of each page or NULL */
+  GPtrArray** misses; /**< Queries the plugin did not find on each page or NULL */
+  bool dirty; /**< Pages have been added since the index has been saved */
+  mutex lock; /**< Lock */
+};
+
+/* casefolds the text and collapses white space, so that text that is laid
+ * out in lines still matches queries spanning several of them */
+static char*
+text_index_normalize(const char* text)
+{
+  char* folded = g_utf8_casefold(text, -1);
+  GString* normalized = g_string_sized_new(strlen(folded));
+
+  bool space = true;
+  for (const char* iter = folded; *iter != '\0'; iter = g_utf8_next_char(iter)) {
+    const gunichar c = g_utf8_get_char(iter);
+    if (g_unichar_isspace(c) == TRUE) {
+      if (space == false) {
+        g_string_append_c(normalized, ' ');
+        space = true;
+      }
+    } else if (c != 0x00AD) { /* soft hyphen */
+      g_string_append_unichar(normalized, c);
+      space = false;
+    }
+  }
+
+  if (normalized->len > 0 && normalized->str[normalized->len - 1] == ' ') {
+    g_string_truncate(normalized, normalized->len - 1);
+  }
+
+  g_free(folded);
+  return g_string_free(normalized, FALSE);
+}
+
+zathura_text_index_t*
+zathura_text_index_new(const char* path, gint64 mtime, gint64 size, unsigned
+    int number_of_pages)
+{
+  if (path == NULL) {
+    return NULL;
+  }
+
+  zathura_text_index_t* index = g_malloc0(sizeof(zathura_text_index_t));
+  index->path            = g_strdup(path);
+  index->mtime           = mtime;
+  index->size            = size;
+  index->number_of_pages = number_of_pages;
+  index->pages           = g_malloc0_n(number_of_pages + 1, sizeof(char*));
+  index->misses          = g_malloc0_n(number_of_pages + 1, sizeof(GPtrArray*));
+  mutex_init(&index->lock);
+
+  return index;
+}
+
+zathura_text_index_t*
+zathura_text_index_load(const char* file, const char* path, gint64 mtime,
+    gint64 size, unsigned int number_of_pages)
+{
+  if (file == NULL || path == NULL) {
+    return NULL;
+  }
+
+  GKeyFile* key_file = g_key_file_new();
+  if (g_key_file_load_from_file(key_file, file, G_KEY_FILE_NONE, NULL) == FALSE) {
+    g_key_file_free(key_file);
+    return NULL;
+  }
+
+  /* only use an index of the same version of the document */
+  char* indexed_path = g_key_file_get_string(key_file, GROUP_INDEX, KEY_PATH, NULL);
+  const bool same = g_strcmp0(indexed_path, path) == 0 &&
+    g_key_file_get_int64(key_file, GROUP_INDEX, KEY_MTIME, NULL) == mtime &&
+    g_key_file_get_int64(key_file, GROUP_INDEX, KEY_SIZE, NULL) == size &&
+    g_key_file_get_integer(key_file, GROUP_INDEX, KEY_PAGES, NULL) == (gint) number_of_pages;
+  g_free(indexed_path);
+
+  if (same == false) {
+    girara_debug("text index '%s' is outdated", file);
+    g_key_file_free(key_file);
+    return NULL;
+  }
+
+  zathura_text_index_t* index = zathura_text_index_new(path, mtime, size, number_of_pages);
+
+  gsize number_of_keys = 0;
+  char** keys = g_key_file_get_keys(key_file, GROUP_TEXT, &number_of_keys, NULL);
+  for (gsize i = 0; i < number_of_keys; i++) {
+    const guint64 page = g_ascii_strtoull(keys[i], NULL, 10);
+    if (page < number_of_pages && index->pages[page] == NULL) {
+      index->pages[page] = g_key_file_get_string(key_file, GROUP_TEXT, keys[i], NULL);
+    }
+  }
+  g_strfreev(keys);
+
+  keys = g_key_file_get_keys(key_file, GROUP_MISSES, &number_of_keys, NULL);
+  for (gsize i = 0; i < number_of_keys; i++) {
+    const guint64 page = g_ascii_strtoull(keys[i], NULL, 10);
+    if (page >= number_of_pages || index->misses[page] != NULL) {
+      continue;
+    }
+
+    gsize number_of_queries = 0;
+    char** queries = g_key_file_get_string_list(key_file, GROUP_MISSES, keys[i],
+        &number_of_queries, NULL);
+    index->misses[page] = g_ptr_array_new_with_free_func(g_free);
+    for (gsize q = 0; q < number_of_queries && q < MAX_MISSES; q++) {
+      g_ptr_array_add(index->misses[page], queries[q]);
+      queries[q] = NULL;
+    }
+    g_strfreev(queries);
+  }
+  g_strfreev(keys);
+  g_key_file_free(key_file);
+
+  girara_debug("loaded text index of %" G_GSIZE_FORMAT " pages from '%s'",
+               number_of_keys, file);
+
+  return index;
+}
+
+bool
+zathura_text_index_save(zathura_text_index_t* index, const char* file)
+{
+  if (index == NULL || file == NULL) {
+    return false;
+  }
+
+  mutex_lock(&index->lock);
+  if (index->dirty == false) {
+    mutex_unlock(&index->lock);
+    return true;
+  }
+
+  GKeyFile* key_file = g_key_file_new();
+  g_key_file_set_string(key_file, GROUP_INDEX, KEY_PATH, index->path);
+  g_key_file_set_int64(key_file, GROUP_INDEX, KEY_MTIME, index->mtime);
+  g_key_file_set_int64(key_file, GROUP_INDEX, KEY_SIZE, index->size);
+  g_key_file_set_integer(key_file, GROUP_INDEX, KEY_PAGES, index->number_of_pages);
+
+  for (unsigned int page = 0; page < index->number_of_pages; page++) {
+    if (index->pages[page] != NULL) {
+      char key[16];
+      g_snprintf(key, sizeof(key), "%u", page);
+      g_key_file_set_string(key_file, GROUP_TEXT, key, index->pages[page]);
+    }
+    if (index->misses[page] != NULL && index->misses[page]->len > 0) {
+      char key[16];
+      g_snprintf(key, sizeof(key), "%u", page);
+      g_key_file_set_string_list(key_file, GROUP_MISSES, key,
+          (const gchar* const*) index->misses[page]->pdata, index->misses[page]->len);
+    }
+  }
+  index->dirty = false;
+  mutex_unlock(&index->lock);
+
+  gsize length = 0;
+  char* content = g_key_file_to_data(key_file, &length, NULL);
+  g_key_file_free(key_file);
+
+  char* dir = g_path_get_dirname(file);
+  g_mkdir_with_parents(dir, 0700);
+  g_free(dir);
+
+  GError* error = NULL;
+  const bool saved = g_file_set_contents(file, content, length, &error) == TRUE;
+  if (saved == false) {
+    girara_error("could not save text index to '%s': %s", file, error->message);
+    g_error_free(error);
+  }
+  g_free(content);
+
+  return saved;
+}
+
+void
+zathura_text_index_free(zathura_text_index_t* index)
+{
+  if (index == NULL) {
+    return;
+  }
+
+  for (unsigned int page = 0; page < index->number_of_pages; page++) {
+    g_free(index->pages[page]);
+    if (index->misses[page] != NULL) {
+      g_ptr_array_unref(index->misses[page]);
+    }
+  }
+  g_free(index->pages);
+  g_free(index->misses);
+  g_free(index->path);
+  mutex_free(&index->lock);
+  g_free(index);
+}
+
+char*
+zathura_text_index_get_file(const char* data_dir, const char* path)
+{
+  if (data_dir == NULL || path == NULL) {
+    return NULL;
+  }
+
+  char* name = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+  char* file = g_build_filename(data_dir, "text-index", name, NULL);
+  g_free(name);
+
+  return file;
+}
+
+void
+zathura_text_index_set_page(zathura_text_index_t* index, unsigned int page,
+    const char* text)
+{
+  if (index == NULL || page >= index->number_of_pages || text == NULL) {
+    return;
+  }
+
+  char* normalized = text_index_normalize(text);
+
+  mutex_lock(&index->lock);
+  g_free(index->pages[page]);
+  index->pages[page] = normalized;
+  index->dirty = true;
+  mutex_unlock(&index->lock);
+}
+
+static bool
+text_index_find_miss(GPtrArray* misses, const char* query)
+{
+  if (misses == NULL) {
+    return false;
+  }
+
+  for (guint i = 0; i < misses->len; i++) {
+    if (g_strcmp0(g_ptr_array_index(misses, i), query) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void
+zathura_text_index_set_miss(zathura_text_index_t* index, unsigned int page,
+    const char* query)
+{
+  if (index == NULL || page >= index->number_of_pages || query == NULL) {
+    return;
+  }
+
+  mutex_lock(&index->lock);
+  if (index->misses[page] == NULL) {
+    index->misses[page] = g_ptr_array_new_with_free_func(g_free);
+  }
+
+  GPtrArray* misses = index->misses[page];
+  if (text_index_find_miss(misses, query) == false) {
+    /* the oldest query is forgotten */
+    if (misses->len >= MAX_MISSES) {
+      g_ptr_array_remove_index(misses, 0);
+    }
+    g_ptr_array_add(misses, g_strdup(query));
+    index->dirty = true;
+  }
+  mutex_unlock(&index->lock);
+}
+
+zathura_text_index_match_t
+zathura_text_index_match(zathura_text_index_t* index, unsigned int page,
+    const char* query)
+{
+  if (index == NULL || page >= index->number_of_pages || query == NULL) {
+    return ZATHURA_TEXT_INDEX_UNKNOWN;
+  }
+
+  char* normalized = text_index_normalize(query);
+
+  /* the plugin may find hits the normalized text does not contain (e.g. over
+   * hyphenation or ligatures), so only an empty page or a miss reported by
+   * the plugin itself rules a page out */
+  zathura_text_index_match_t match = ZATHURA_TEXT_INDEX_UNKNOWN;
+  mutex_lock(&index->lock);
+  if (index->pages[page] != NULL && index->pages[page][0] == '\0') {
+    match = ZATHURA_TEXT_INDEX_NO_MATCH;
+  } else if (text_index_find_miss(index->misses[page], query) == true) {
+    match = ZATHURA_TEXT_INDEX_NO_MATCH;
+  } else if (index->pages[page] != NULL && strstr(index->pages[page], normalized) != NULL) {
+    match = ZATHURA_TEXT_INDEX_MATCH;
+  }
+  mutex_unlock(&index->lock);
+
+  g_free(normalized);
+  return match;
+}
+
+bool
+zathura_text_index_is_empty_page(zathura_text_index_t* index, unsigned int page)
+{
+  if (index == NULL || page >= index->number_of_pages) {
+    return false;
+  }
+
+  mutex_lock(&index->lock);
+  const bool empty = index->pages[page] != NULL && index->pages[page][0] == '\0';
+  mutex_unlock(&index->lock);
+
+  return empty;
+}
@@ -0,0 +1,121 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef TEXT_INDEX_H
+#define TEXT_INDEX_H
+
+#include <stdbool.h>
+#include <glib.h>
+
+typedef struct zathura_text_index_s zathura_text_index_t;
+
+/**
+ * Result of looking up a query in the text index
+ */
+typedef enum zathura_text_index_match_e {
+  ZATHURA_TEXT_INDEX_UNKNOWN, /**< The text of the page has not been indexed */
+  ZATHURA_TEXT_INDEX_NO_MATCH, /**< The page does not contain the query */
+  ZATHURA_TEXT_INDEX_MATCH /**< The indexed text contains the query */
+} zathura_text_index_match_t;
+
+/**
+ * Creates an empty text index. The index is identified by the path, the
+ * modification time and the size of the document, so that it is not used
+ * for a document that has changed.
+ *
+ * @param path Path of the document
+ * @param mtime Modification time of the document
+ * @param size Size of the document
+ * @param number_of_pages Number of pages of the document
+ * @return The text index
+ */
+zathura_text_index_t* zathura_text_index_new(const char* path, gint64 mtime,
+    gint64 size, unsigned int number_of_pages);
+
+/**
+ * Loads a text index from a file. The index is only loaded if it belongs to
+ * the same version of the document.
+ *
+ * @param file The file the index has been saved to
+ * @param path Path of the document
+ * @param mtime Modification time of the document
+ * @param size Size of the document
+ * @param number_of_pages Number of pages of the document
+ * @return The text index or NULL if there is no usable index
+ */
+zathura_text_index_t* zathura_text_index_load(const char* file, const char*
+    path, gint64 mtime, gint64 size, unsigned int number_of_pages);
+
+/**
+ * Saves the text index to a file if pages have been added since it has been
+ * created, loaded or saved
+ *
+ * @param index The text index
+ * @param file The file
+ * @return true if the index has been saved or did not need to be saved
+ */
+bool zathura_text_index_save(zathura_text_index_t* index, const char* file);
+
+/**
+ * Frees the text index
+ *
+ * @param index The text index
+ */
+void zathura_text_index_free(zathura_text_index_t* index);
+
+/**
+ * Returns the file the index of a document is stored in
+ *
+ * @param data_dir The data directory
+ * @param path Path of the document
+ * @return The file name (free with g_free)
+ */
+char* zathura_text_index_get_file(const char* data_dir, const char* path);
+
+/**
+ * Adds the text of a page to the index. This function is thread-safe.
+ *
+ * @param index The text index
+ * @param page The page index
+ * @param text The text of the page
+ */
+void zathura_text_index_set_page(zathura_text_index_t* index, unsigned int
+    page, const char* text);
+
+/**
+ * Remembers that the plugin did not find a query on a page. This function is
+ * thread-safe.
+ *
+ * @param index The text index
+ * @param page The page index
+ * @param query The query
+ */
+void zathura_text_index_set_miss(zathura_text_index_t* index, unsigned int
+    page, const char* query);
+
+/**
+ * Checks whether a page might contain a query. Case and white space are
+ * ignored when the indexed text is compared. A page is only ruled out if it
+ * does not contain any text or the plugin did not find the query on it
+ * before, since the plugin may find hits the indexed text does not contain.
+ * This function is thread-safe.
+ *
+ * @param index The text index
+ * @param page The page index
+ * @param query The query
+ * @return Whether the page might contain the query
+ */
+zathura_text_index_match_t zathura_text_index_match(zathura_text_index_t*
+    index, unsigned int page, const char* query);
+
+/**
+ * Checks whether a page is known not to contain any text. This function is
+ * thread-safe.
+ *
+ * @param index The text index
+ * @param page The page index
+ * @return true if the page has been indexed and does not contain any text
+ */
+bool zathura_text_index_is_empty_page(zathura_text_index_t* index, unsigned
+    int page);
+
+#endif // TEXT_INDEX_H
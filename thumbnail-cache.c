@@ -0,0 +1,210 @@
+/* See LICENSE file for license and copyright information */
+
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <girara/utils.h>
+
+#include "thumbnail-cache.h"
+
+#define INFO_FILE "info"
+#define GROUP_THUMBNAILS "thumbnails"
+
+#define KEY_PATH "path"
+#define KEY_MTIME "mtime"
+#define KEY_SIZE "size"
+#define KEY_THUMBNAIL_SIZE "thumbnail-size"
+
+/* distinguishes the temporary files of concurrent writers */
+static gint thumbnail_counter = 0;
+
+struct zathura_thumbnail_cache_s {
+  char* dir; /**< Directory of the thumbnails */
+  unsigned int thumbnail_size; /**< Length of the longer side of the thumbnails */
+};
+
+/* checks whether the thumbnails in the directory belong to this version of
+ * the document */
+static bool
+thumbnail_cache_check_info(const char* file, const char* path, gint64 mtime,
+    gint64 size, unsigned int thumbnail_size)
+{
+  GKeyFile* key_file = g_key_file_new();
+  if (g_key_file_load_from_file(key_file, file, G_KEY_FILE_NONE, NULL) == FALSE) {
+    g_key_file_free(key_file);
+    return false;
+  }
+
+  char* cached_path = g_key_file_get_string(key_file, GROUP_THUMBNAILS, KEY_PATH, NULL);
+  const bool same = g_strcmp0(cached_path, path) == 0 &&
+    g_key_file_get_int64(key_file, GROUP_THUMBNAILS, KEY_MTIME, NULL) == mtime &&
+    g_key_file_get_int64(key_file, GROUP_THUMBNAILS, KEY_SIZE, NULL) == size &&
+    g_key_file_get_integer(key_file, GROUP_THUMBNAILS, KEY_THUMBNAIL_SIZE, NULL) == (gint) thumbnail_size;
+  g_free(cached_path);
+  g_key_file_free(key_file);
+
+  return same;
+}
+
+static bool
+thumbnail_cache_write_info(const char* file, const char* path, gint64 mtime,
+    gint64 size, unsigned int thumbnail_size)
+{
+  GKeyFile* key_file = g_key_file_new();
+  g_key_file_set_string(key_file, GROUP_THUMBNAILS, KEY_PATH, path);
+  g_key_file_set_int64(key_file, GROUP_THUMBNAILS, KEY_MTIME, mtime);
+  g_key_file_set_int64(key_file, GROUP_THUMBNAILS, KEY_SIZE, size);
+  g_key_file_set_integer(key_file, GROUP_THUMBNAILS, KEY_THUMBNAIL_SIZE, thumbnail_size);
+
+  gsize length = 0;
+  char* content = g_key_file_to_data(key_file, &length, NULL);
+  g_key_file_free(key_file);
+
+  GError* error = NULL;
+  const bool written = g_file_set_contents(file, content, length, &error) == TRUE;
+  if (written == false) {
+    girara_error("could not write '%s': %s", file, error->message);
+    g_error_free(error);
+  }
+  g_free(content);
+
+  return written;
+}
+
+/* removes the thumbnails of an outdated version of the document */
+static void
+thumbnail_cache_clear(const char* dir)
+{
+  GDir* handle = g_dir_open(dir, 0, NULL);
+  if (handle == NULL) {
+    return;
+  }
+
+  const char* name = NULL;
+  while ((name = g_dir_read_name(handle)) != NULL) {
+    if (g_str_has_suffix(name, ".png") == TRUE || g_str_has_suffix(name, ".tmp") == TRUE) {
+      char* file = g_build_filename(dir, name, NULL);
+      g_unlink(file);
+      g_free(file);
+    }
+  }
+  g_dir_close(handle);
+}
+
+static char*
+thumbnail_cache_get_file(zathura_thumbnail_cache_t* cache, unsigned int page)
+{
+  char name[32];
+  g_snprintf(name, sizeof(name), "%u.png", page);
+  return g_build_filename(cache->dir, name, NULL);
+}
+
+zathura_thumbnail_cache_t*
+zathura_thumbnail_cache_new(const char* data_dir, const char* path, gint64
+    mtime, gint64 size, unsigned int thumbnail_size)
+{
+  if (data_dir == NULL || path == NULL || thumbnail_size == 0) {
+    return NULL;
+  }
+
+  char* name = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+  char* dir  = g_build_filename(data_dir, "thumbnails", name, NULL);
+  g_free(name);
+
+  if (g_mkdir_with_parents(dir, 0700) != 0) {
+    girara_error("could not create thumbnail directory '%s'", dir);
+    g_free(dir);
+    return NULL;
+  }
+
+  char* info = g_build_filename(dir, INFO_FILE, NULL);
+  if (thumbnail_cache_check_info(info, path, mtime, size, thumbnail_size) == false) {
+    thumbnail_cache_clear(dir);
+    if (thumbnail_cache_write_info(info, path, mtime, size, thumbnail_size) == false) {
+      g_free(info);
+      g_free(dir);
+      return NULL;
+    }
+  }
+  g_free(info);
+
+  zathura_thumbnail_cache_t* cache = g_malloc0(sizeof(zathura_thumbnail_cache_t));
+  cache->dir            = dir;
+  cache->thumbnail_size = thumbnail_size;
+
+  return cache;
+}
+
+void
+zathura_thumbnail_cache_free(zathura_thumbnail_cache_t* cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  g_free(cache->dir);
+  g_free(cache);
+}
+
+unsigned int
+zathura_thumbnail_cache_get_size(zathura_thumbnail_cache_t* cache)
+{
+  if (cache == NULL) {
+    return 0;
+  }
+
+  return cache->thumbnail_size;
+}
+
+cairo_surface_t*
+zathura_thumbnail_cache_get(zathura_thumbnail_cache_t* cache, unsigned int page)
+{
+  if (cache == NULL) {
+    return NULL;
+  }
+
+  char* file = thumbnail_cache_get_file(cache, page);
+  if (g_file_test(file, G_FILE_TEST_IS_REGULAR) == FALSE) {
+    g_free(file);
+    return NULL;
+  }
+
+  cairo_surface_t* surface = cairo_image_surface_create_from_png(file);
+  g_free(file);
+
+  if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+    cairo_surface_destroy(surface);
+    return NULL;
+  }
+
+  return surface;
+}
+
+bool
+zathura_thumbnail_cache_add(zathura_thumbnail_cache_t* cache, unsigned int
+    page, cairo_surface_t* surface)
+{
+  if (cache == NULL || surface == NULL) {
+    return false;
+  }
+
+  /* write to a temporary file first, so that readers never see a partially
+   * written thumbnail */
+  char* file = thumbnail_cache_get_file(cache, page);
+  char* tmp  = g_strdup_printf("%s.%d-%d.tmp", file, (int) getpid(),
+      g_atomic_int_add(&thumbnail_counter, 1));
+
+  bool stored = cairo_surface_write_to_png(surface, tmp) == CAIRO_STATUS_SUCCESS;
+  if (stored == true && g_rename(tmp, file) != 0) {
+    stored = false;
+  }
+  if (stored == false) {
+    girara_debug("could not store thumbnail '%s'", file);
+    g_unlink(tmp);
+  }
+
+  g_free(tmp);
+  g_free(file);
+
+  return stored;
+}
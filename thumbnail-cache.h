@@ -0,0 +1,64 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <stdbool.h>
+#include <glib.h>
+#include <cairo.h>
+
+typedef struct zathura_thumbnail_cache_s zathura_thumbnail_cache_t;
+
+/**
+ * Opens the on-disk cache of the thumbnails of a document. Thumbnails are
+ * stored as PNG files in a directory per document below the data directory.
+ * Thumbnails of another version of the document or of another size are
+ * removed.
+ *
+ * @param data_dir The data directory
+ * @param path Path of the document
+ * @param mtime Modification time of the document
+ * @param size Size of the document
+ * @param thumbnail_size Length of the longer side of the thumbnails in pixels
+ * @return The thumbnail cache or NULL if an error occured
+ */
+zathura_thumbnail_cache_t* zathura_thumbnail_cache_new(const char* data_dir,
+    const char* path, gint64 mtime, gint64 size, unsigned int thumbnail_size);
+
+/**
+ * Frees the thumbnail cache. The thumbnails stay on disk.
+ *
+ * @param cache The thumbnail cache
+ */
+void zathura_thumbnail_cache_free(zathura_thumbnail_cache_t* cache);
+
+/**
+ * Returns the length of the longer side of the thumbnails
+ *
+ * @param cache The thumbnail cache
+ * @return The size in pixels
+ */
+unsigned int zathura_thumbnail_cache_get_size(zathura_thumbnail_cache_t* cache);
+
+/**
+ * Loads the thumbnail of a page. This function is thread-safe.
+ *
+ * @param cache The thumbnail cache
+ * @param page The page index
+ * @return The thumbnail (an image surface) or NULL if it is not cached
+ */
+cairo_surface_t* zathura_thumbnail_cache_get(zathura_thumbnail_cache_t* cache,
+    unsigned int page);
+
+/**
+ * Stores the thumbnail of a page. This function is thread-safe.
+ *
+ * @param cache The thumbnail cache
+ * @param page The page index
+ * @param surface The thumbnail (an image surface)
+ * @return true if the thumbnail has been stored
+ */
+bool zathura_thumbnail_cache_add(zathura_thumbnail_cache_t* cache, unsigned
+    int page, cairo_surface_t* surface);
+
+#endif // THUMBNAIL_CACHE_H
@@ -14,7 +14,6 @@
 #include <girara/settings.h>
 #include <glib/gi18n.h>
 
-#include "links.h"
 #include "utils.h"
 #include "zathura.h"
 #include "internal.h"
@@ -53,10 +52,10 @@ file_valid_extension(zathura_t* zathura, const char* path)
     return false;
   }
 
-  zathura_plugin_t* plugin = zathura_plugin_manager_get_plugin(zathura->plugins.manager, content_type);
+  const bool supported = zathura_plugin_manager_has_plugin(zathura->plugins.manager, content_type);
   g_free((void*)content_type);
 
-  return (plugin == NULL) ? false : true;
+  return supported;
 }
 
 bool
@@ -135,46 +134,19 @@ execute_command(char* const argv[], char** output)
   return true;
 }
 
-void
-document_index_build(GtkTreeModel* model, GtkTreeIter* parent,
-                     girara_tree_node_t* tree)
-{
-  girara_list_t* list        = girara_node_get_children(tree);
-  GIRARA_LIST_FOREACH(list, girara_tree_node_t*, iter, node)
-  zathura_index_element_t* index_element = (zathura_index_element_t*)girara_node_get_data(node);
-
-  zathura_link_type_t type     = zathura_link_get_type(index_element->link);
-  zathura_link_target_t target = zathura_link_get_target(index_element->link);
-
-  gchar* description = NULL;
-  if (type == ZATHURA_LINK_GOTO_DEST) {
-    description = g_strdup_printf("Page %d", target.page_number + 1);
-  } else {
-    description = g_strdup(target.value);
-  }
-
-  GtkTreeIter tree_iter;
-  gtk_tree_store_append(GTK_TREE_STORE(model), &tree_iter, parent);
-  gtk_tree_store_set(GTK_TREE_STORE(model), &tree_iter, 0, index_element->title, 1, description, 2, index_element, -1);
-  g_object_weak_ref(G_OBJECT(model), (GWeakNotify) zathura_index_element_free, index_element);
-  g_free(description);
-
-  if (girara_node_get_num_children(node) > 0) {
-    document_index_build(model, &tree_iter, node);
-  }
-
-  GIRARA_LIST_FOREACH_END(list, gchar*, iter, name);
-}
-
 void
 page_calculate_offset(zathura_t* zathura, zathura_page_t* page, page_offset_t* offset)
 {
   g_return_if_fail(page != NULL);
   g_return_if_fail(offset != NULL);
-  GtkWidget* widget = zathura_page_get_widget(zathura, page);
 
-  g_return_if_fail(gtk_widget_translate_coordinates(widget,
-                   zathura->ui.page_widget, 0, 0, &(offset->x), &(offset->y)) == true);
+  /* the widget of the page might not be attached, so use the layout */
+  unsigned int x = 0;
+  unsigned int y = 0;
+  g_return_if_fail(zathura_page_layout_get_page_position(zathura->ui.layout.pages,
+                   zathura_page_get_index(page), &x, &y) == true);
+  offset->x = x;
+  offset->y = y;
 }
 
 zathura_rectangle_t
@@ -44,16 +44,6 @@ bool file_valid_extension(zathura_t* zathura, const char* path);
  */
 bool execute_command(char* const argv[], char** output);
 
-/**
- * Generates the document index based upon the list retreived from the document
- * object.
- *
- * @param model The tree model
- * @param parent The tree iterator parent
- * @param tree The Tree iterator
- */
-void document_index_build(GtkTreeModel* model, GtkTreeIter* parent, girara_tree_node_t* tree);
-
 /**
  * Calculates the offset of the page to the top of the viewing area as
  * well as to the left side of it. The result has to be freed.
@@ -0,0 +1,13 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef ZATHURA_VERSION_H
+#define ZATHURA_VERSION_H
+
+#define ZATHURA_VERSION_MAJOR 0
+#define ZATHURA_VERSION_MINOR 2
+#define ZATHURA_VERSION_REV 3
+#define ZATHURA_VERSION "0.2.3"
+#define ZATHURA_API_VERSION 5
+#define ZATHURA_ABI_VERSION 8
+
+#endif
@@ -24,6 +24,7 @@
 #endif
 #include "database-plain.h"
 #include "document.h"
+#include "document-index.h"
 #include "shortcuts.h"
 #include "zathura.h"
 #include "utils.h"
@@ -33,6 +34,20 @@
 #include "page-widget.h"
 #include "plugin.h"
 #include "adjustment.h"
+#include "search.h"
+#include "selection.h"
+#include "scroll.h"
+#include "export.h"
+#include "memory-monitor.h"
+#include "stream.h"
+#include "prefetch.h"
+#include "readahead.h"
+#include "replay.h"
+#include "tabs.h"
+#include "glib-compat.h"
+
+/* time in microseconds the background page loader may spend per iteration */
+#define PAGE_LOADER_BUDGET 10000
 
 typedef struct zathura_document_info_s {
   zathura_t* zathura;
@@ -53,10 +68,25 @@ typedef struct position_set_delayed_s {
 } position_set_delayed_t;
 
 static gboolean document_info_open(gpointer data);
-static bool zathura_page_cache_is_cached(zathura_t* zathura, unsigned int page_index);
-static ssize_t zathura_page_cache_lru_invalidate(zathura_t* zathura);
-static void zathura_page_cache_invalidate_all(zathura_t* zathura);
-static bool zathura_page_cache_is_full(zathura_t* zathura, bool* result);
+static bool document_open_finish(zathura_t* zathura, zathura_document_t*
+    document, const char* path, const char* password, int page_number,
+    zathura_error_t error);
+static bool document_open_background(zathura_t* zathura, const char* path,
+    const char* password, int page_number);
+static void page_cache_evict(const zathura_page_cache_key_t* key, cairo_surface_t* surface, void* data);
+static void page_loader_start(zathura_t* zathura);
+static gboolean stats_log(gpointer data);
+static void page_widget_detach_all(zathura_t* zathura);
+static void document_text_index_open(zathura_t* zathura);
+static void document_text_index_close(zathura_t* zathura, bool save);
+static void document_thumbnail_cache_open(zathura_t* zathura);
+static void document_thumbnail_cache_close(zathura_t* zathura);
+static void document_render_cache_open(zathura_t* zathura);
+static void document_render_cache_close(zathura_t* zathura);
+static void page_widget_move(zathura_t* zathura, unsigned int page_id);
+static void page_widget_apply_layout(zathura_t* zathura);
+static void page_loader_stop(zathura_t* zathura);
+static zathura_document_t* document_detach(zathura_t* zathura, bool keep_monitor);
 
 /* function implementation */
 zathura_t*
@@ -107,8 +137,14 @@ zathura_init(zathura_t* zathura)
     girara_error("Could not create '%s': %s", zathura->config.data_dir, strerror(errno));
   }
 
-  /* load plugins */
-  zathura_plugin_manager_load(zathura->plugins.manager);
+  /* load plugins; the plugins of a server are loaded already */
+  if (zathura->server == NULL) {
+    char* manifest = g_build_filename(zathura->config.data_dir, "plugins", NULL);
+    zathura_plugin_manager_set_manifest(zathura->plugins.manager, manifest);
+    g_free(manifest);
+
+    zathura_plugin_manager_load(zathura->plugins.manager);
+  }
 
   /* configuration */
   config_load_default(zathura);
@@ -142,18 +178,14 @@ zathura_init(zathura_t* zathura)
   zathura->ui.session->events.buffer_changed  = cb_buffer_changed;
   zathura->ui.session->events.unknown_command = cb_unknown_command;
 
-  /* page view */
-#if (GTK_MAJOR_VERSION == 3)
-  zathura->ui.page_widget = gtk_grid_new();
-  gtk_grid_set_row_homogeneous(GTK_GRID(zathura->ui.page_widget), TRUE);
-  gtk_grid_set_column_homogeneous(GTK_GRID(zathura->ui.page_widget), TRUE);
-#else
-  zathura->ui.page_widget = gtk_table_new(0, 0, TRUE);
-#endif
+  /* page view; only the widgets of pages close to the view are attached */
+  zathura->ui.page_widget = gtk_fixed_new();
   if (zathura->ui.page_widget == NULL) {
     goto error_free;
   }
 
+  zathura->ui.layout.pages = zathura_page_layout_new();
+
   g_signal_connect(G_OBJECT(zathura->ui.session->gtk.window), "size-allocate", G_CALLBACK(cb_view_resized), zathura);
 
   /* Setup hadjustment tracker */
@@ -164,7 +196,7 @@ zathura_init(zathura_t* zathura)
 
   /* Connect hadjustment signals */
   g_signal_connect(G_OBJECT(hadjustment), "value-changed",
-      G_CALLBACK(cb_view_vadjustment_value_changed), zathura);
+      G_CALLBACK(cb_view_adjustment_value_changed), zathura);
   g_signal_connect(G_OBJECT(hadjustment), "value-changed",
       G_CALLBACK(cb_adjustment_track_value), zathura->ui.hadjustment);
   g_signal_connect(G_OBJECT(hadjustment), "changed",
@@ -180,7 +212,7 @@ zathura_init(zathura_t* zathura)
 
   /* Connect vadjustment signals */
   g_signal_connect(G_OBJECT(vadjustment), "value-changed",
-      G_CALLBACK(cb_view_vadjustment_value_changed), zathura);
+      G_CALLBACK(cb_view_adjustment_value_changed), zathura);
   g_signal_connect(G_OBJECT(vadjustment), "value-changed",
       G_CALLBACK(cb_adjustment_track_value), zathura->ui.vadjustment);
   g_signal_connect(G_OBJECT(vadjustment), "changed",
@@ -229,33 +261,33 @@ zathura_init(zathura_t* zathura)
   /* set page padding */
   int page_padding = 1;
   girara_setting_get(zathura->ui.session, "page-padding", &page_padding);
-
-#if (GTK_MAJOR_VERSION == 3)
-  gtk_grid_set_row_spacing(GTK_GRID(zathura->ui.page_widget), page_padding);
-  gtk_grid_set_column_spacing(GTK_GRID(zathura->ui.page_widget), page_padding);
-#else
-  gtk_table_set_row_spacings(GTK_TABLE(zathura->ui.page_widget), page_padding);
-  gtk_table_set_col_spacings(GTK_TABLE(zathura->ui.page_widget), page_padding);
-#endif
-
-  /* database */
-  char* database = NULL;
-  girara_setting_get(zathura->ui.session, "database", &database);
-
-  if (g_strcmp0(database, "plain") == 0) {
-    girara_debug("Using plain database backend.");
-    zathura->database = zathura_plaindatabase_new(zathura->config.data_dir);
+  zathura_page_layout_set_padding(zathura->ui.layout.pages, page_padding);
+
+  /* database; a server shares its database */
+  if (zathura->server == NULL) {
+    char* database = NULL;
+    girara_setting_get(zathura->ui.session, "database", &database);
+
+    if (g_strcmp0(database, "plain") == 0) {
+      girara_debug("Using plain database backend.");
+      zathura->database = zathura_plaindatabase_new(zathura->config.data_dir);
+      int history_limit = ZATHURA_PLAINDATABASE_HISTORY_LIMIT;
+      girara_setting_get(zathura->ui.session, "history-limit", &history_limit);
+      if (zathura->database != NULL && history_limit >= 0) {
+        zathura_plaindatabase_set_history_limit(zathura->database, history_limit);
+      }
 #ifdef WITH_SQLITE
-  } else if (g_strcmp0(database, "sqlite") == 0) {
-    girara_debug("Using sqlite database backend.");
-    char* tmp = g_build_filename(zathura->config.data_dir, "bookmarks.sqlite", NULL);
-    zathura->database = zathura_sqldatabase_new(tmp);
-    g_free(tmp);
+    } else if (g_strcmp0(database, "sqlite") == 0) {
+      girara_debug("Using sqlite database backend.");
+      char* tmp = g_build_filename(zathura->config.data_dir, "bookmarks.sqlite", NULL);
+      zathura->database = zathura_sqldatabase_new(tmp);
+      g_free(tmp);
 #endif
-  } else {
-    girara_error("Database backend '%s' is not supported.", database);
+    } else {
+      girara_error("Database backend '%s' is not supported.", database);
+    }
+    g_free(database);
   }
-  g_free(database);
 
   if (zathura->database == NULL) {
     girara_error("Unable to initialize database. Bookmarks won't be available.");
@@ -284,13 +316,41 @@ zathura_init(zathura_t* zathura)
   girara_setting_get(zathura->ui.session, "page-cache-size", &cache_size);
   if (cache_size <= 0) {
     girara_warning("page-cache-size is not positive, using %d instead", ZATHURA_PAGE_CACHE_DEFAULT_SIZE);
-    zathura->page_cache.size = ZATHURA_PAGE_CACHE_DEFAULT_SIZE;
-  } else {
-    zathura->page_cache.size = cache_size;
+    cache_size = ZATHURA_PAGE_CACHE_DEFAULT_SIZE;
+  }
+
+  int cache_memory = 0;
+  girara_setting_get(zathura->ui.session, "page-cache-memory", &cache_memory);
+  if (cache_memory <= 0) {
+    girara_warning("page-cache-memory is not positive, using %d instead", ZATHURA_PAGE_CACHE_DEFAULT_MEMORY);
+    cache_memory = ZATHURA_PAGE_CACHE_DEFAULT_MEMORY;
+  }
+
+  zathura->page_cache = zathura_page_cache_new((size_t) cache_memory * 1024 * 1024,
+      cache_size, page_cache_evict, zathura);
+  if (zathura->page_cache == NULL) {
+    goto error_free;
+  }
+
+  /* surface pool */
+
+  if (zathura->server == NULL) {
+    int pool_memory = ZATHURA_SURFACE_POOL_DEFAULT_MEMORY;
+    girara_setting_get(zathura->ui.session, "surface-pool-memory", &pool_memory);
+    zathura->surface_pool = zathura_surface_pool_new((size_t) MAX(pool_memory, 0) * 1024 * 1024);
+  }
+
+  /* statistics */
+  zathura->stats = zathura_stats_new();
+
+  int stats_interval = 0;
+  girara_setting_get(zathura->ui.session, "stats-interval", &stats_interval);
+  if (stats_interval > 0) {
+    zathura->sync.stats_log = g_timeout_add_seconds(stats_interval, stats_log, zathura);
   }
 
-  zathura->page_cache.cache = g_malloc(zathura->page_cache.size * sizeof(int));
-  zathura_page_cache_invalidate_all(zathura);
+  /* memory pressure */
+  memory_monitor_start(zathura);
 
   return true;
 
@@ -304,6 +364,9 @@ error_free:
     g_object_unref(zathura->ui.page_widget_alignment);
   }
 
+  zathura_page_layout_free(zathura->ui.layout.pages);
+  zathura->ui.layout.pages = NULL;
+
   return false;
 }
 
@@ -315,6 +378,27 @@ zathura_free(zathura_t* zathura)
   }
 
   document_close(zathura, false);
+  tabs_free(zathura);
+  render_free(zathura->sync.render_thread);
+  zathura->sync.render_thread = NULL;
+  scroll_free(zathura);
+
+  if (zathura->file_monitor.reload_timeout != 0) {
+    g_source_remove(zathura->file_monitor.reload_timeout);
+  }
+
+  if (zathura->sync.stats_log != 0) {
+    g_source_remove(zathura->sync.stats_log);
+  }
+
+  memory_monitor_stop(zathura);
+
+  zathura_replay_free(zathura->replay.replay);
+  g_free(zathura->replay.file);
+
+  zathura_synctex_free(zathura->synctex.index);
+  g_free(zathura->synctex.forward);
+  g_free(zathura->synctex.editor);
 
   if (zathura->ui.session != NULL) {
     girara_session_destroy(zathura->ui.session);
@@ -334,10 +418,10 @@ zathura_free(zathura_t* zathura)
   }
 
   /* bookmarks */
-  girara_list_free(zathura->bookmarks.bookmarks);
+  zathura_bookmarks_free(zathura);
 
-  /* database */
-  if (zathura->database != NULL) {
+  /* database; the state shared by a server is freed by the server */
+  if (zathura->database != NULL && zathura->server == NULL) {
     g_object_unref(G_OBJECT(zathura->database));
   }
 
@@ -351,7 +435,9 @@ zathura_free(zathura_t* zathura)
   }
 
   /* free registered plugins */
-  zathura_plugin_manager_free(zathura->plugins.manager);
+  if (zathura->server == NULL) {
+    zathura_plugin_manager_free(zathura->plugins.manager);
+  }
 
   /* free config variables */
   g_free(zathura->config.config_dir);
@@ -366,7 +452,13 @@ zathura_free(zathura_t* zathura)
     girara_list_iterator_free(zathura->jumplist.cur);
   }
 
-  g_free(zathura->page_cache.cache);
+  zathura_page_cache_free(zathura->page_cache);
+  if (zathura->server == NULL) {
+    zathura_surface_pool_free(zathura->surface_pool);
+  }
+  zathura_stats_free(zathura->stats);
+  zathura_dir_cache_free(zathura->dir_cache);
+  zathura_page_layout_free(zathura->ui.layout.pages);
 
   g_free(zathura);
 }
@@ -435,6 +527,23 @@ zathura_set_plugin_dir(zathura_t* zathura, const char* dir)
 
 }
 
+void
+zathura_set_replay_file(zathura_t* zathura, const char* file)
+{
+  g_return_if_fail(zathura != NULL);
+
+  g_free(zathura->replay.file);
+  zathura->replay.file = g_strdup(file);
+}
+
+void
+zathura_set_memory_limit(zathura_t* zathura, int limit)
+{
+  g_return_if_fail(zathura != NULL);
+
+  zathura->memory.limit = limit > 0 ? (size_t) limit * 1024 * 1024 : 0;
+}
+
 void
 zathura_set_synctex_editor_command(zathura_t* zathura, const char* command)
 {
@@ -451,6 +560,15 @@ zathura_set_synctex_editor_command(zathura_t* zathura, const char* command)
   }
 }
 
+void
+zathura_set_synctex_forward(zathura_t* zathura, const char* position)
+{
+  g_return_if_fail(zathura != NULL);
+
+  g_free(zathura->synctex.forward);
+  zathura->synctex.forward = g_strdup(position);
+}
+
 void
 zathura_set_synctex(zathura_t* zathura, bool value)
 {
@@ -469,18 +587,11 @@ zathura_set_argv(zathura_t* zathura, char** argv)
 }
 
 static gchar*
-prepare_document_open_from_stdin(zathura_t* zathura)
+prepare_document_open_from_stdin(const gint* cancel, gint* progress)
 {
-  g_return_val_if_fail(zathura, NULL);
-
-  GError* error = NULL;
-  gchar* file = NULL;
-  gint handle = g_file_open_tmp("zathura.stdin.XXXXXX", &file, &error);
-  if (handle == -1) {
-    if (error != NULL) {
-      girara_error("Can not create temporary file: %s", error->message);
-      g_error_free(error);
-    }
+  int handle = -1;
+  gchar* file = zathura_stream_create_file(&handle);
+  if (file == NULL) {
     return NULL;
   }
 
@@ -494,21 +605,10 @@ prepare_document_open_from_stdin(zathura_t* zathura)
     return NULL;
   }
 
-  char buffer[BUFSIZ];
-  ssize_t count = 0;
-  while ((count = read(stdinfno, buffer, BUFSIZ)) > 0) {
-    if (write(handle, buffer, count) != count) {
-      girara_error("Can not write to temporary file: %s", file);
-      close(handle);
-      g_unlink(file);
-      g_free(file);
-      return NULL;
-    }
-  }
-
+  const bool copied = zathura_stream_copy(stdinfno, handle, cancel, progress);
   close(handle);
 
-  if (count != 0) {
+  if (copied == false) {
     girara_error("Can not read from stdin.");
     g_unlink(file);
     g_free(file);
@@ -524,43 +624,52 @@ document_info_open(gpointer data)
   zathura_document_info_t* document_info = data;
   g_return_val_if_fail(document_info != NULL, FALSE);
 
+  /* stdin is read by the thread that opens the document */
   if (document_info->zathura != NULL && document_info->path != NULL) {
-    char* file = NULL;
-    if (g_strcmp0(document_info->path, "-") == 0) {
-      file = prepare_document_open_from_stdin(document_info->zathura);
-      if (file == NULL) {
-        girara_notify(document_info->zathura->ui.session, GIRARA_ERROR,
-                      "Could not read file from stdin and write it to a temporary file.");
-      } else {
-        document_info->zathura->stdin_support.file = g_strdup(file);
-      }
-    } else {
-      file = g_strdup(document_info->path);
-    }
-
-    if (file != NULL) {
-      document_open(document_info->zathura, file, document_info->password,
-                    document_info->page_number);
-      g_free(file);
-    }
+    document_open_background(document_info->zathura, document_info->path,
+        document_info->password, document_info->page_number);
   }
 
   g_free(document_info);
   return FALSE;
 }
 
+/* documents up to this size are read into the page cache while they are
+ * opened */
+static uint64_t
+document_readahead_size(zathura_t* zathura)
+{
+  int size = 0;
+  girara_setting_get(zathura->ui.session, "readahead-size", &size);
+
+  return size > 0 ? (uint64_t) size * 1024 * 1024 : 0;
+}
+
 bool
 document_open(zathura_t* zathura, const char* path, const char* password,
               int page_number)
 {
   if (zathura == NULL || zathura->plugins.manager == NULL || path == NULL) {
-    goto error_out;
+    return false;
   }
 
-  gchar* file_uri = NULL;
+  /* a document that is still being opened in the background is replaced */
+  document_open_cancel(zathura);
+
+  zathura_readahead_file(path, document_readahead_size(zathura));
+
   zathura_error_t error = ZATHURA_ERROR_OK;
   zathura_document_t* document = zathura_document_open(zathura->plugins.manager, path, password, &error);
 
+  return document_open_finish(zathura, document, path, password, page_number, error);
+}
+
+static bool
+document_open_finish(zathura_t* zathura, zathura_document_t* document,
+    const char* path, const char* password, int page_number, zathura_error_t error)
+{
+  gchar* file_uri = NULL;
+
   if (document == NULL) {
     if (error == ZATHURA_ERROR_INVALID_PASSWORD) {
       zathura_password_dialog_info_t* password_dialog_info = malloc(sizeof(zathura_password_dialog_info_t));
@@ -730,6 +839,8 @@ document_open(zathura_t* zathura, const char* path, const char* password,
       goto error_free;
     }
 
+    /* the widget is kept alive while it is not attached to page_widget */
+    g_object_ref_sink(page_widget);
     zathura->pages[page_id] = page_widget;
 
     /* set widget size */
@@ -761,16 +872,24 @@ document_open(zathura_t* zathura, const char* path, const char* password,
 
   girara_set_view(zathura->ui.session, zathura->ui.page_widget_alignment);
 
-  /* threads */
-  zathura->sync.render_thread = render_init(zathura);
+  /* threads; the render thread is kept when switching tabs */
+  if (zathura->sync.render_thread == NULL) {
+    zathura->sync.render_thread = render_init(zathura);
+  }
 
   if (zathura->sync.render_thread == NULL) {
     goto error_free;
   }
+  render_attach(zathura->sync.render_thread, zathura);
 
-  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
-    gtk_widget_realize(zathura->pages[page_id]);
-  }
+  document_text_index_open(zathura);
+  document_thumbnail_cache_open(zathura);
+  document_render_cache_open(zathura);
+  document_index_start(zathura);
+
+  /* the current page should have its real size before the view is adjusted */
+  page_load(zathura, zathura_document_get_current_page_number(document));
+  page_loader_start(zathura);
 
   /* bookmarks */
   zathura_bookmarks_load(zathura, file_path);
@@ -789,8 +908,21 @@ document_open(zathura_t* zathura, const char* path, const char* password,
     cb_view_vadjustment_value_changed(NULL, zathura);
   }
 
-  /* Invalidate all current entries in the page cache */
-  zathura_page_cache_invalidate_all(zathura);
+  /* show the position the document has been opened for */
+  if (zathura->synctex.forward != NULL) {
+    synctex_view(zathura, zathura->synctex.forward);
+    g_free(zathura->synctex.forward);
+    zathura->synctex.forward = NULL;
+  }
+
+  /* replay recorded events on the first document */
+  if (zathura->replay.file != NULL && zathura->replay.replay == NULL) {
+    zathura->replay.replay = zathura_replay_start(zathura, zathura->replay.file);
+    if (zathura->replay.replay == NULL) {
+      g_free(zathura->replay.file);
+      zathura->replay.file = NULL;
+    }
+  }
 
   return true;
 
@@ -807,6 +939,205 @@ error_out:
   return false;
 }
 
+/**
+ * A document that is opened in the background
+ */
+struct document_open_job_s {
+  zathura_t* zathura; /**< Zathura object */
+  char* path; /**< Path of the document */
+  const char* password; /**< Password of the document */
+  int page_number; /**< Page that should be shown */
+  GThread* thread; /**< Thread that opens the document */
+  guint timeout; /**< Source that checks the progress */
+  gint64 start; /**< Time the job has been started */
+  zathura_document_t* document; /**< The document once it has been opened */
+  zathura_error_t error; /**< Error that occured while opening the document */
+  gint pages_read; /**< Number of pages that have been read */
+  gint number_of_pages; /**< Number of pages of the document */
+  gint done; /**< Set by the thread when it has finished */
+  gint cancel; /**< Set to stop reading from stdin */
+  bool from_stdin; /**< The document is read from stdin */
+  bool stdin_failed; /**< Reading from stdin has failed */
+  gint stdin_read; /**< KiB that have been read from stdin */
+  bool stdin_kept; /**< The file read from stdin is removed when zathura quits */
+  uint64_t readahead_size; /**< Maximum size of a document that is read ahead */
+};
+
+static void
+document_open_job_progress(unsigned int pages_read, unsigned int number_of_pages, void* data)
+{
+  document_open_job_t* job = data;
+  g_atomic_int_set(&job->number_of_pages, number_of_pages);
+  g_atomic_int_set(&job->pages_read, pages_read);
+}
+
+static gpointer
+document_open_job_run(gpointer data)
+{
+  document_open_job_t* job = data;
+
+  /* the document is copied into a file while it arrives on stdin; the path
+   * is only read by the main thread once the job is done */
+  if (job->from_stdin == true) {
+    char* file = prepare_document_open_from_stdin(&job->cancel, &job->stdin_read);
+    if (file == NULL) {
+      job->stdin_failed = true;
+      g_atomic_int_set(&job->done, 1);
+      return NULL;
+    }
+    g_free(job->path);
+    job->path = file;
+  } else {
+    /* the plugin reads the file in many small pieces, which is slow on
+     * network file systems unless the file is in the page cache already */
+    zathura_readahead_file(job->path, job->readahead_size);
+  }
+
+  /* detecting the file type, opening the document and reading the page
+   * metadata does not touch the user interface */
+  job->document = zathura_document_open_with_progress(job->zathura->plugins.manager,
+      job->path, job->password, &job->error, document_open_job_progress, job);
+
+  g_atomic_int_set(&job->done, 1);
+  return NULL;
+}
+
+static void
+document_open_job_free(document_open_job_t* job)
+{
+  if (job->timeout != 0) {
+    g_source_remove(job->timeout);
+  }
+  if (job->thread != NULL) {
+    g_atomic_int_set(&job->cancel, 1);
+    g_thread_join(job->thread);
+  }
+  /* a document from stdin that has been cancelled is not kept */
+  if (job->from_stdin == true && job->stdin_kept == false &&
+      g_strcmp0(job->path, "-") != 0) {
+    g_unlink(job->path);
+  }
+  if (job->document != NULL) {
+    zathura_document_free(job->document);
+  }
+
+  g_free(job->path);
+  g_free(job);
+}
+
+static gboolean
+document_open_job_check(gpointer data)
+{
+  document_open_job_t* job = data;
+  zathura_t* zathura       = job->zathura;
+
+  if (g_atomic_int_get(&job->done) == 0) {
+    const int number_of_pages = g_atomic_int_get(&job->number_of_pages);
+    const int stdin_read      = g_atomic_int_get(&job->stdin_read);
+    if (number_of_pages == 0 && stdin_read > 0) {
+      char* text = g_strdup_printf(_("Reading from stdin... %.1f MiB"), stdin_read / 1024.0);
+      girara_statusbar_item_set_text(zathura->ui.session, zathura->ui.statusbar.file, text);
+      g_free(text);
+    } else if (number_of_pages > 0) {
+      char* text = g_strdup_printf(_("Loading... %d/%d pages"),
+          g_atomic_int_get(&job->pages_read), number_of_pages);
+      girara_statusbar_item_set_text(zathura->ui.session, zathura->ui.statusbar.file, text);
+      g_free(text);
+    }
+    return TRUE;
+  }
+
+  g_thread_join(job->thread);
+  job->thread  = NULL;
+  job->timeout = 0;
+  zathura->sync.open_job = NULL;
+
+  girara_debug("read '%s' in the background in %.1f ms", job->path,
+               (g_get_monotonic_time() - job->start) / 1000.0);
+
+  if (job->stdin_failed == true) {
+    girara_notify(zathura->ui.session, GIRARA_ERROR,
+                  "Could not read file from stdin and write it to a temporary file.");
+    girara_statusbar_item_set_text(zathura->ui.session, zathura->ui.statusbar.file, _("[No name]"));
+    document_open_job_free(job);
+    return FALSE;
+  } else if (job->from_stdin == true) {
+    /* the file is removed once zathura quits */
+    g_free(zathura->stdin_support.file);
+    zathura->stdin_support.file = g_strdup(job->path);
+    job->stdin_kept = true;
+  }
+
+  /* create the widgets for the opened document */
+  zathura_document_t* document = job->document;
+  job->document = NULL;
+  if (document_open_finish(zathura, document, job->path, job->password,
+        job->page_number, job->error) == false) {
+    girara_statusbar_item_set_text(zathura->ui.session, zathura->ui.statusbar.file, _("[No name]"));
+  }
+
+  document_open_job_free(job);
+  return FALSE;
+}
+
+static bool
+document_open_background(zathura_t* zathura, const char* path, const char*
+    password, int page_number)
+{
+  if (zathura == NULL || zathura->plugins.manager == NULL || path == NULL) {
+    return false;
+  }
+
+  document_open_cancel(zathura);
+
+  document_open_job_t* job = g_malloc0(sizeof(document_open_job_t));
+  job->zathura     = zathura;
+  job->path        = g_strdup(path);
+  job->password    = password;
+  job->page_number = page_number;
+  job->start       = g_get_monotonic_time();
+  job->from_stdin  = g_strcmp0(path, "-") == 0;
+  job->readahead_size = document_readahead_size(zathura);
+
+  job->thread = thread_new("document-open", document_open_job_run, job);
+  if (job->thread == NULL) {
+    document_open_job_free(job);
+    if (g_strcmp0(path, "-") != 0) {
+      return document_open(zathura, path, password, page_number);
+    }
+
+    char* file = prepare_document_open_from_stdin(NULL, NULL);
+    if (file == NULL) {
+      girara_notify(zathura->ui.session, GIRARA_ERROR,
+                    "Could not read file from stdin and write it to a temporary file.");
+      return false;
+    }
+    g_free(zathura->stdin_support.file);
+    zathura->stdin_support.file = file;
+    return document_open(zathura, file, password, page_number);
+  }
+
+  girara_statusbar_item_set_text(zathura->ui.session, zathura->ui.statusbar.file, _("Loading..."));
+  job->timeout = gdk_threads_add_timeout(100, document_open_job_check, job);
+  zathura->sync.open_job = job;
+
+  return true;
+}
+
+void
+document_open_cancel(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->sync.open_job == NULL) {
+    return;
+  }
+
+  document_open_job_t* job = zathura->sync.open_job;
+  zathura->sync.open_job = NULL;
+
+  /* waits for the thread to finish */
+  document_open_job_free(job);
+}
+
 void
 document_open_idle(zathura_t* zathura, const char* path, const char* password,
                    int page_number)
@@ -854,25 +1185,71 @@ document_save(zathura_t* zathura, const char* path, bool overwrite)
   return (error == ZATHURA_ERROR_OK) ? true : false;
 }
 
-static void
-remove_page_from_table(GtkWidget* page, gpointer permanent)
+bool
+document_close(zathura_t* zathura, bool keep_monitor)
 {
-  if (permanent == false) {
-    g_object_ref(G_OBJECT(page));
+  zathura_document_t* document = document_detach(zathura, keep_monitor);
+  if (document == NULL) {
+    return false;
   }
 
-  gtk_container_remove(GTK_CONTAINER(gtk_widget_get_parent(page)), page);
+  /* release cached surfaces */
+  zathura_page_cache_remove_document(zathura->page_cache, zathura->tabs.id);
+
+  zathura_document_free(document);
+
+  return true;
+}
+
+zathura_document_t*
+document_park(zathura_t* zathura)
+{
+  return document_detach(zathura, false);
 }
 
 bool
-document_close(zathura_t* zathura, bool keep_monitor)
+document_resume(zathura_t* zathura, zathura_document_t* document, const char*
+    password)
 {
-  if (zathura == NULL || zathura->document == NULL) {
+  if (zathura == NULL || document == NULL) {
+    return false;
+  }
+
+  if (zathura->document != NULL) {
+    girara_error("another document is shown");
+    zathura_document_free(document);
     return false;
   }
 
+  return document_open_finish(zathura, document, zathura_document_get_path(document),
+      password, ZATHURA_PAGE_NUMBER_UNSPECIFIED, ZATHURA_ERROR_OK);
+}
+
+/* closes the shown document without freeing it */
+static zathura_document_t*
+document_detach(zathura_t* zathura, bool keep_monitor)
+{
+  document_open_cancel(zathura);
+  search_cancel(zathura);
+  export_pages_cancel(zathura);
+  document_index_cancel(zathura);
+  selection_cancel(zathura);
+
+  if (zathura == NULL || zathura->document == NULL) {
+    return NULL;
+  }
+
+  page_loader_stop(zathura);
+  prefetch_cancel(zathura);
+  scroll_stop(zathura);
+
   /* remove monitor */
   if (keep_monitor == false) {
+    if (zathura->file_monitor.reload_timeout != 0) {
+      g_source_remove(zathura->file_monitor.reload_timeout);
+      zathura->file_monitor.reload_timeout = 0;
+    }
+
     if (zathura->file_monitor.monitor != NULL) {
       g_file_monitor_cancel(zathura->file_monitor.monitor);
       g_object_unref(zathura->file_monitor.monitor);
@@ -921,24 +1298,33 @@ document_close(zathura_t* zathura, bool keep_monitor)
   file_info.position_x = gtk_adjustment_get_value(hadjustment);
   file_info.position_y = gtk_adjustment_get_value(vadjustment);
 
-  /* save file info */
+  /* save file info; whatever is stored on close is written in a single
+   * transaction */
+  zathura_db_begin_transaction(zathura->database);
   zathura_db_set_fileinfo(zathura->database, path, &file_info);
+  zathura_db_end_transaction(zathura->database);
 
-  /* release render thread */
-  render_free(zathura->sync.render_thread);
-  zathura->sync.render_thread = NULL;
+  /* stop rendering the document */
+  render_detach(zathura->sync.render_thread);
+
+  document_text_index_close(zathura, true);
+  document_thumbnail_cache_close(zathura);
+  document_render_cache_close(zathura);
+
+  zathura_synctex_free(zathura->synctex.index);
+  zathura->synctex.index = NULL;
 
   /* remove widgets */
-  gtk_container_foreach(GTK_CONTAINER(zathura->ui.page_widget), remove_page_from_table, (gpointer) 1);
+  page_widget_detach_all(zathura);
   for (unsigned int i = 0; i < zathura_document_get_number_of_pages(zathura->document); i++) {
     g_object_unref(zathura->pages[i]);
-    g_object_unref(zathura->pages[i]); // FIXME
   }
   free(zathura->pages);
   zathura->pages = NULL;
+  zathura_page_layout_update(zathura->ui.layout.pages, 0, NULL, NULL);
+  zathura->ui.layout.visible.valid = false;
 
-  /* remove document */
-  zathura_document_free(zathura->document);
+  zathura_document_t* document = zathura->document;
   zathura->document = NULL;
 
   /* remove index */
@@ -958,9 +1344,335 @@ document_close(zathura_t* zathura, bool keep_monitor)
   /* update title */
   girara_set_window_title(zathura->ui.session, "zathura");
 
+  return document;
+}
+
+static bool
+document_same_layout(zathura_document_t* a, zathura_document_t* b)
+{
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(a);
+  if (zathura_document_get_number_of_pages(b) != number_of_pages) {
+    return false;
+  }
+
+  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+    zathura_page_t* page_a = zathura_document_get_page(a, page_id);
+    zathura_page_t* page_b = zathura_document_get_page(b, page_id);
+    /* pages that have not been loaded yet get their size when they are */
+    if (page_a != NULL && zathura_page_is_loaded(page_a) == false) {
+      continue;
+    }
+    if (page_a == NULL || page_b == NULL || zathura_page_load(page_b) == false ||
+        fabs(zathura_page_get_width(page_a) - zathura_page_get_width(page_b)) > FLT_EPSILON ||
+        fabs(zathura_page_get_height(page_a) - zathura_page_get_height(page_b)) > FLT_EPSILON) {
+      return false;
+    }
+  }
+
   return true;
 }
 
+bool
+document_reload(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->file_monitor.file_path == NULL) {
+    return false;
+  }
+
+  const char* path     = zathura->file_monitor.file_path;
+  const char* password = zathura->file_monitor.password;
+
+  if (zathura->document == NULL) {
+    return document_open(zathura, path, password, ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+  }
+
+  /* stop searching, exporting, rendering and loading pages of the old
+   * document, so that no page gets loaded while the layouts are compared */
+  search_cancel(zathura);
+  export_pages_cancel(zathura);
+  document_index_cancel(zathura);
+  selection_cancel(zathura);
+  render_detach(zathura->sync.render_thread);
+  page_loader_stop(zathura);
+  prefetch_cancel(zathura);
+
+  zathura_error_t error = ZATHURA_ERROR_OK;
+  zathura_document_t* document = zathura_document_open(zathura->plugins.manager, path, password, &error);
+
+  /* the widgets can only be reused if all pages kept their size */
+  if (document == NULL || document_same_layout(zathura->document, document) == false) {
+    girara_debug("reopening '%s'", path);
+    if (document != NULL) {
+      zathura_document_free(document);
+    }
+    document_close(zathura, true);
+    return document_open(zathura, path, password, ZATHURA_PAGE_NUMBER_UNSPECIFIED);
+  }
+
+  zathura_document_t* old_document = zathura->document;
+
+  /* keep the view */
+  zathura_document_set_scale(document, zathura_document_get_scale(old_document));
+  zathura_document_set_rotation(document, zathura_document_get_rotation(old_document));
+  zathura_document_set_page_offset(document, zathura_document_get_page_offset(old_document));
+  zathura_document_set_adjust_mode(document, zathura_document_get_adjust_mode(old_document));
+  zathura_document_set_current_page_number(document,
+      zathura_document_get_current_page_number(old_document));
+
+  /* pages whose content hash is unchanged keep their surfaces; the hash of
+   * the old page has to be known from before the file changed */
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(document);
+  unsigned int changed_pages = 0;
+  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+    zathura_page_t* old_page = zathura_document_get_page(old_document, page_id);
+    zathura_page_t* page     = zathura_document_get_page(document, page_id);
+    zathura_page_set_visibility(page, zathura_page_get_visibility(old_page));
+
+    uint64_t old_hash = 0;
+    uint64_t hash     = 0;
+    const bool changed = zathura_page_get_cached_content_hash(old_page, &old_hash) == false ||
+      zathura_page_get_content_hash(page, &hash) != ZATHURA_ERROR_OK || old_hash != hash;
+    if (changed == true) {
+      zathura_page_cache_remove_page(zathura->page_cache, zathura->tabs.id, page_id);
+      ++changed_pages;
+    }
+
+    zathura_page_widget_set_page(ZATHURA_PAGE(zathura->pages[page_id]), page, changed);
+  }
+
+  zathura->document = document;
+  zathura_document_free(old_document);
+
+  /* the text of the old version is of no use anymore */
+  document_text_index_close(zathura, false);
+  document_text_index_open(zathura);
+  document_thumbnail_cache_close(zathura);
+  document_render_cache_close(zathura);
+
+  /* the index of the new version is generated in the background */
+  if (zathura->ui.index != NULL) {
+    g_object_ref_sink(zathura->ui.index);
+    zathura->ui.index = NULL;
+  }
+
+  render_attach(zathura->sync.render_thread, zathura);
+
+  /* thumbnails are rendered at the size the render thread uses */
+  document_thumbnail_cache_open(zathura);
+  document_render_cache_open(zathura);
+  document_index_start(zathura);
+
+  page_loader_start(zathura);
+
+  girara_debug("reloaded '%s' in place, %u of %u pages changed", path,
+               changed_pages, number_of_pages);
+
+  return true;
+}
+
+bool
+page_load(zathura_t* zathura, unsigned int page_id)
+{
+  if (zathura == NULL || zathura->document == NULL || zathura->pages == NULL) {
+    return false;
+  }
+
+  zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
+  if (page == NULL) {
+    return false;
+  }
+
+  /* plugins that are not thread-safe must not initialize a page while
+   * another thread renders or searches */
+  if (zathura_page_is_loaded(page) == false) {
+    render_lock(zathura->sync.render_thread);
+    const bool loaded = zathura_page_load(page);
+    /* the render queue reads the page's part of the file ahead if the
+     * plugin knows where it is */
+    if (loaded == true) {
+      uint64_t offset = 0;
+      uint64_t length = 0;
+      zathura_page_get_byte_range(page, &offset, &length);
+    }
+    render_unlock(zathura->sync.render_thread);
+    if (loaded == false) {
+      return false;
+    }
+  }
+
+  /* the placeholder might have had a different size; the page might also
+   * have been loaded by the render thread */
+  unsigned int page_height = 0;
+  unsigned int page_width  = 0;
+  page_calc_height_width(page, &page_height, &page_width, true);
+
+  gint old_width  = 0;
+  gint old_height = 0;
+  gtk_widget_get_size_request(zathura->pages[page_id], &old_width, &old_height);
+  if ((unsigned int) old_width != page_width || (unsigned int) old_height != page_height) {
+    gtk_widget_set_size_request(zathura->pages[page_id], page_width, page_height);
+    if (zathura_page_layout_set_page_size(zathura->ui.layout.pages, page_id,
+          page_width, page_height) == true) {
+      page_widget_apply_layout(zathura);
+    } else if (zathura->ui.layout.attached == true && page_id >= zathura->ui.layout.first &&
+        page_id <= zathura->ui.layout.last) {
+      page_widget_move(zathura, page_id);
+    }
+  }
+
+  return true;
+}
+
+static void
+document_text_index_open(zathura_t* zathura)
+{
+  bool enabled = false;
+  girara_setting_get(zathura->ui.session, "search-text-index", &enabled);
+  if (enabled == false || zathura->document == NULL || zathura->config.data_dir == NULL) {
+    return;
+  }
+
+  const char* path = zathura_document_get_path(zathura->document);
+  GStatBuf info;
+  if (path == NULL || g_stat(path, &info) != 0) {
+    return;
+  }
+
+  /* the index is only valid for this version of the file */
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  char* file = zathura_text_index_get_file(zathura->config.data_dir, path);
+  zathura->text_index = zathura_text_index_load(file, path, info.st_mtime,
+      info.st_size, number_of_pages);
+  if (zathura->text_index == NULL) {
+    zathura->text_index = zathura_text_index_new(path, info.st_mtime,
+        info.st_size, number_of_pages);
+  }
+  g_free(file);
+}
+
+static void
+document_text_index_close(zathura_t* zathura, bool save)
+{
+  if (zathura->text_index == NULL) {
+    return;
+  }
+
+  if (save == true && zathura->document != NULL) {
+    char* file = zathura_text_index_get_file(zathura->config.data_dir,
+        zathura_document_get_path(zathura->document));
+    zathura_text_index_save(zathura->text_index, file);
+    g_free(file);
+  }
+
+  zathura_text_index_free(zathura->text_index);
+  zathura->text_index = NULL;
+}
+
+static void
+document_thumbnail_cache_open(zathura_t* zathura)
+{
+  bool enabled = true;
+  girara_setting_get(zathura->ui.session, "thumbnail-cache", &enabled);
+  if (enabled == false || zathura->document == NULL || zathura->config.data_dir == NULL) {
+    return;
+  }
+
+  const char* path = zathura_document_get_path(zathura->document);
+  GStatBuf info;
+  if (path == NULL || g_stat(path, &info) != 0) {
+    return;
+  }
+
+  /* thumbnails of an older version of the file are removed */
+  zathura->thumbnail_cache = zathura_thumbnail_cache_new(zathura->config.data_dir,
+      path, info.st_mtime, info.st_size,
+      render_get_thumbnail_size(zathura->sync.render_thread));
+}
+
+static void
+document_thumbnail_cache_close(zathura_t* zathura)
+{
+  zathura_thumbnail_cache_free(zathura->thumbnail_cache);
+  zathura->thumbnail_cache = NULL;
+}
+
+static void
+document_render_cache_open(zathura_t* zathura)
+{
+  bool enabled = false;
+  girara_setting_get(zathura->ui.session, "render-cache", &enabled);
+  if (enabled == false || zathura->document == NULL || zathura->config.data_dir == NULL) {
+    return;
+  }
+
+  const char* path = zathura_document_get_path(zathura->document);
+  GStatBuf info;
+  if (path == NULL || g_stat(path, &info) != 0) {
+    return;
+  }
+
+  int cache_size = 0;
+  girara_setting_get(zathura->ui.session, "render-cache-size", &cache_size);
+  if (cache_size <= 0) {
+    return;
+  }
+
+  char* dir = g_build_filename(zathura->config.data_dir, "render-cache", NULL);
+  zathura->render_cache = zathura_render_cache_new(dir, path, info.st_mtime,
+      info.st_size, (size_t) cache_size * 1024 * 1024);
+  g_free(dir);
+}
+
+static void
+document_render_cache_close(zathura_t* zathura)
+{
+  zathura_render_cache_free(zathura->render_cache);
+  zathura->render_cache = NULL;
+}
+
+static gboolean
+page_loader_idle(gpointer data)
+{
+  zathura_t* zathura = data;
+  if (zathura->document == NULL) {
+    zathura->sync.page_loader = 0;
+    return FALSE;
+  }
+
+  /* load pages for a few milliseconds at a time to keep the UI responsive */
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  const gint64 deadline = g_get_monotonic_time() + PAGE_LOADER_BUDGET;
+  while (zathura->sync.next_page_to_load < number_of_pages) {
+    page_load(zathura, zathura->sync.next_page_to_load++);
+    if (g_get_monotonic_time() >= deadline) {
+      return TRUE;
+    }
+  }
+
+  girara_debug("all %u pages have been loaded", number_of_pages);
+  zathura->sync.page_loader = 0;
+  return FALSE;
+}
+
+static void
+page_loader_start(zathura_t* zathura)
+{
+  page_loader_stop(zathura);
+
+  zathura->sync.next_page_to_load = 0;
+  zathura->sync.page_loader = gdk_threads_add_idle_full(G_PRIORITY_LOW,
+      page_loader_idle, zathura, NULL);
+}
+
+static void
+page_loader_stop(zathura_t* zathura)
+{
+  if (zathura->sync.page_loader != 0) {
+    g_source_remove(zathura->sync.page_loader);
+    zathura->sync.page_loader = 0;
+  }
+}
+
 static gboolean
 page_set_delayed_impl(gpointer data)
 {
@@ -1094,28 +1806,175 @@ page_widget_set_mode(zathura_t* zathura, unsigned int pages_per_row, unsigned in
     return;
   }
 
-  gtk_container_foreach(GTK_CONTAINER(zathura->ui.page_widget), remove_page_from_table, (gpointer)0);
+  zathura_page_layout_set_mode(zathura->ui.layout.pages, pages_per_row, first_page_column);
+  render_set_row_groups(zathura, pages_per_row, first_page_column);
+  page_widget_update_layout(zathura);
 
-  unsigned int number_of_pages     = zathura_document_get_number_of_pages(zathura->document);
-#if (GTK_MAJOR_VERSION == 3)
-#else
-  gtk_table_resize(GTK_TABLE(zathura->ui.page_widget), ceil((number_of_pages + first_page_column - 1) / pages_per_row), pages_per_row);
-#endif
+  gtk_widget_show(zathura->ui.page_widget);
+}
 
-  for (unsigned int i = 0; i < number_of_pages; i++) {
-    int x = (i + first_page_column - 1) % pages_per_row;
-    int y = (i + first_page_column - 1) / pages_per_row;
+static void
+page_widget_move(zathura_t* zathura, unsigned int page_id)
+{
+  unsigned int x = 0;
+  unsigned int y = 0;
+  if (zathura_page_layout_get_page_position(zathura->ui.layout.pages, page_id, &x, &y) == true) {
+    gtk_fixed_move(GTK_FIXED(zathura->ui.page_widget), zathura->pages[page_id], x, y);
+  }
+}
 
-    zathura_page_t* page   = zathura_document_get_page(zathura->document, i);
-    GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
-#if (GTK_MAJOR_VERSION == 3)
-    gtk_grid_attach(GTK_GRID(zathura->ui.page_widget), page_widget, x, y, 1, 1);
-#else
-    gtk_table_attach(GTK_TABLE(zathura->ui.page_widget), page_widget, x, x + 1, y, y + 1, GTK_SHRINK, GTK_SHRINK, 0, 0);
-#endif
+static void
+page_widget_detach_all(zathura_t* zathura)
+{
+  if (zathura->ui.layout.attached == false) {
+    return;
+  }
+
+  for (unsigned int page_id = zathura->ui.layout.first; page_id <= zathura->ui.layout.last; page_id++) {
+    gtk_container_remove(GTK_CONTAINER(zathura->ui.page_widget), zathura->pages[page_id]);
+  }
+  zathura->ui.layout.attached = false;
+}
+
+/* repositions the attached widgets and resizes page_widget */
+static void
+page_widget_apply_layout(zathura_t* zathura)
+{
+  unsigned int width  = 0;
+  unsigned int height = 0;
+  zathura_page_layout_get_size(zathura->ui.layout.pages, &width, &height);
+  gtk_widget_set_size_request(zathura->ui.page_widget, width, height);
+
+  if (zathura->ui.layout.attached == true) {
+    for (unsigned int page_id = zathura->ui.layout.first; page_id <= zathura->ui.layout.last; page_id++) {
+      page_widget_move(zathura, page_id);
+    }
+  }
+
+  page_widget_update_view(zathura);
+}
+
+void
+page_widget_update_layout(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->document == NULL || zathura->pages == NULL) {
+    return;
+  }
+
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+
+  /* once the layout knows all pages, their sizes need not be read back */
+  if (zathura_page_layout_get_number_of_pages(zathura->ui.layout.pages) == number_of_pages) {
+    zathura_page_layout_refresh(zathura->ui.layout.pages);
+    page_widget_apply_layout(zathura);
+    return;
   }
 
-  gtk_widget_show_all(zathura->ui.page_widget);
+  unsigned int* widths  = g_malloc_n(number_of_pages, sizeof(unsigned int));
+  unsigned int* heights = g_malloc_n(number_of_pages, sizeof(unsigned int));
+
+  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+    gint width  = 0;
+    gint height = 0;
+    gtk_widget_get_size_request(zathura->pages[page_id], &width, &height);
+    widths[page_id]  = MAX(width, 0);
+    heights[page_id] = MAX(height, 0);
+  }
+
+  zathura_page_layout_update(zathura->ui.layout.pages, number_of_pages, widths, heights);
+  g_free(widths);
+  g_free(heights);
+
+  page_widget_apply_layout(zathura);
+}
+
+void
+page_widget_resize(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->document == NULL || zathura->pages == NULL) {
+    return;
+  }
+
+  const unsigned int number_of_pages = zathura_document_get_number_of_pages(zathura->document);
+  unsigned int* widths  = g_malloc_n(number_of_pages, sizeof(unsigned int));
+  unsigned int* heights = g_malloc_n(number_of_pages, sizeof(unsigned int));
+
+  for (unsigned int page_id = 0; page_id < number_of_pages; page_id++) {
+    zathura_page_t* page = zathura_document_get_page(zathura->document, page_id);
+    page_calc_height_width(page, &heights[page_id], &widths[page_id], true);
+
+    /* only the widgets whose size changed need a new allocation; the others
+     * are drawn again at the new settings */
+    unsigned int width  = 0;
+    unsigned int height = 0;
+    if (zathura_page_layout_get_page_size(zathura->ui.layout.pages, page_id, &width, &height) == true &&
+        width == widths[page_id] && height == heights[page_id]) {
+      gtk_widget_queue_draw(zathura->pages[page_id]);
+    } else {
+      gtk_widget_set_size_request(zathura->pages[page_id], widths[page_id], heights[page_id]);
+      gtk_widget_queue_resize(zathura->pages[page_id]);
+    }
+  }
+
+  zathura_page_layout_update(zathura->ui.layout.pages, number_of_pages, widths, heights);
+  g_free(widths);
+  g_free(heights);
+
+  page_widget_apply_layout(zathura);
+}
+
+void
+page_widget_update_view(zathura_t* zathura)
+{
+  if (zathura == NULL || zathura->document == NULL || zathura->pages == NULL) {
+    return;
+  }
+
+  /* visible part of page_widget; before the widgets are realized the view
+   * starts at the top */
+  GtkAdjustment* vadjustment = gtk_scrolled_window_get_vadjustment(
+      GTK_SCROLLED_WINDOW(zathura->ui.session->gtk.view));
+  const int view_height = gtk_adjustment_get_page_size(vadjustment);
+  int x = 0;
+  int y = 0;
+  if (gtk_widget_translate_coordinates(zathura->ui.session->gtk.view,
+        zathura->ui.page_widget, 0, 0, &x, &y) == FALSE) {
+    y = gtk_adjustment_get_value(vadjustment);
+  }
+
+  /* keep one screen above and below attached so that scrolling does not
+   * uncover missing pages */
+  unsigned int first = 0;
+  unsigned int last  = 0;
+  const bool attach = zathura_page_layout_get_pages_in_range(zathura->ui.layout.pages,
+      y - view_height, 3 * MAX(view_height, 1), &first, &last);
+
+  if (zathura->ui.layout.attached == true) {
+    for (unsigned int page_id = zathura->ui.layout.first; page_id <= zathura->ui.layout.last; page_id++) {
+      if (attach == false || page_id < first || page_id > last) {
+        gtk_container_remove(GTK_CONTAINER(zathura->ui.page_widget), zathura->pages[page_id]);
+      }
+    }
+  }
+
+  if (attach == true) {
+    for (unsigned int page_id = first; page_id <= last; page_id++) {
+      if (zathura->ui.layout.attached == true && page_id >= zathura->ui.layout.first &&
+          page_id <= zathura->ui.layout.last) {
+        continue;
+      }
+
+      unsigned int page_x = 0;
+      unsigned int page_y = 0;
+      zathura_page_layout_get_page_position(zathura->ui.layout.pages, page_id, &page_x, &page_y);
+      gtk_fixed_put(GTK_FIXED(zathura->ui.page_widget), zathura->pages[page_id], page_x, page_y);
+      gtk_widget_show(zathura->pages[page_id]);
+    }
+  }
+
+  zathura->ui.layout.attached = attach;
+  zathura->ui.layout.first    = first;
+  zathura->ui.layout.last     = last;
 }
 
 static gboolean
@@ -1262,116 +2121,42 @@ zathura_jumplist_save(zathura_t* zathura)
   }
 }
 
-static bool
-zathura_page_cache_is_cached(zathura_t* zathura, unsigned int page_index)
+static void
+page_cache_evict(const zathura_page_cache_key_t* key, cairo_surface_t* surface, void* data)
 {
-  g_return_val_if_fail(zathura != NULL, false);
-
-  unsigned int i;
-
-  if (zathura->page_cache.num_cached_pages != 0) {
-    for (i = 0; i < zathura->page_cache.size; ++i) {
-      if (zathura->page_cache.cache[i] >= 0 && page_index == (unsigned int)zathura->page_cache.cache[i]) {
-        girara_debug("Page %d is a cache hit", page_index + 1);
-        return true;
-      }
-    }
+  zathura_t* zathura = data;
+  if (key == NULL || zathura == NULL || zathura->document == NULL || zathura->pages == NULL ||
+      key->document != zathura->tabs.id) {
+    return;
   }
 
-  girara_debug("Page %d is a cache miss", page_index + 1);
-  return false;
-}
-
-static ssize_t
-zathura_page_cache_lru_invalidate(zathura_t* zathura)
-{
-   g_return_val_if_fail(zathura != NULL, -1);
-
-   ssize_t lru_index = 0;
-   gint64 view_time = 0;
-   gint64 lru_view_time = G_MAXINT64;
-   GtkWidget* page_widget;
-
-   for (unsigned int i = 0; i < zathura->page_cache.size; ++i) {
-     page_widget = zathura_page_get_widget(zathura, zathura_document_get_page(zathura->document, zathura->page_cache.cache[i]));
-     g_return_val_if_fail(page_widget != NULL, -1);
-     g_object_get(G_OBJECT(page_widget), "last-view", &view_time, NULL);
-
-     if (view_time < lru_view_time) {
-       lru_view_time = view_time;
-       lru_index = i;
-     }
-   }
-
-   zathura_page_t* page = zathura_document_get_page(zathura->document, zathura->page_cache.cache[lru_index]);
-   g_return_val_if_fail(page != NULL, -1);
-
-   page_widget = zathura_page_get_widget(zathura, page);
-   g_return_val_if_fail(page_widget != NULL, -1);
-
-   zathura_page_widget_update_surface(ZATHURA_PAGE(page_widget), NULL);
-   girara_debug("Invalidated page %d at cache index %zd", zathura->page_cache.cache[lru_index] + 1, lru_index);
-   zathura->page_cache.cache[lru_index] = -1;
-   --zathura->page_cache.num_cached_pages;
-
-   return lru_index;
-}
-
-static bool
-zathura_page_cache_is_full(zathura_t* zathura, bool* result)
-{
-  g_return_val_if_fail(zathura != NULL && result != NULL, false);
-
-  *result = zathura->page_cache.num_cached_pages == zathura->page_cache.size;
-
-  return true;
-}
-
-void
-zathura_page_cache_invalidate_all(zathura_t* zathura)
-{
-  g_return_if_fail(zathura != NULL);
-
-  unsigned int i;
-
-  for (i = 0; i < zathura->page_cache.size; ++i) {
-    zathura->page_cache.cache[i] = -1;
+  /* visible pages keep showing the surface; it is released once the page has
+   * been hidden */
+  zathura_page_t* page = zathura_document_get_page(zathura->document, key->page);
+  if (page == NULL || zathura_page_get_visibility(page) == true) {
+    return;
   }
 
-  zathura->page_cache.num_cached_pages = 0;
+  /* free the memory for real if the widget still shows the surface */
+  GtkWidget* page_widget = zathura_page_get_widget(zathura, page);
+  if (page_widget != NULL) {
+    zathura_page_widget_release_surface(ZATHURA_PAGE(page_widget), surface);
+  }
 }
 
-void
-zathura_page_cache_add(zathura_t* zathura, unsigned int page_index)
+static gboolean
+stats_log(gpointer data)
 {
-  g_return_if_fail(zathura != NULL);
-
-  zathura_page_t* page = zathura_document_get_page(zathura->document, page_index);
-
-  g_return_if_fail(page != NULL);
-
-  if (zathura_page_cache_is_cached(zathura, page_index)) {
-    return;
-  }
+  zathura_t* zathura = data;
 
-  bool full;
+  zathura_page_cache_statistics_t cache;
+  zathura_page_cache_get_statistics(zathura->page_cache, &cache);
+  zathura_surface_pool_statistics_t pool;
+  zathura_surface_pool_get_statistics(zathura->surface_pool, &pool);
 
-  if (zathura_page_cache_is_full(zathura, &full) == false) {
-    return;
-  } else if (full == true) {
-    ssize_t idx = zathura_page_cache_lru_invalidate(zathura);
-
-    if (idx == -1) {
-      return;
-    }
-
-    zathura->page_cache.cache[idx] = page_index;
-    ++zathura->page_cache.num_cached_pages;
-    girara_debug("Page %d is cached at cache index %zd", page_index + 1, idx);
-    return;
-  }
+  char* json = zathura_stats_to_json(zathura->stats, &cache, &pool);
+  girara_debug("stats: %s", json);
+  g_free(json);
 
-  zathura->page_cache.cache[zathura->page_cache.num_cached_pages++] = page_index;
-  girara_debug("Page %d is cached at cache index %d", page_index + 1, zathura->page_cache.num_cached_pages - 1);
-  return;
+  return TRUE;
 }
@@ -8,12 +8,23 @@
 #include <gtk/gtk.h>
 #include "macros.h"
 #include "types.h"
+#include "page-cache.h"
+#include "dir-cache.h"
+#include "page-layout.h"
+#include "text-index.h"
+#include "thumbnail-cache.h"
+#include "render-cache.h"
+#include "stats.h"
+#include "surface-pool.h"
+#include "synctex.h"
 
 #if (GTK_MAJOR_VERSION == 3)
 #include <gtk/gtkx.h>
 #endif
 
 #define ZATHURA_PAGE_CACHE_DEFAULT_SIZE		15
+#define ZATHURA_PAGE_CACHE_DEFAULT_MEMORY	256
+#define ZATHURA_SURFACE_POOL_DEFAULT_MEMORY	64
 
 enum { NEXT, PREVIOUS, LEFT, RIGHT, UP, DOWN, BOTTOM, TOP, HIDE, HIGHLIGHT,
   DELETE_LAST_WORD, DELETE_LAST_CHAR, DEFAULT, ERROR, WARNING, NEXT_GROUP,
@@ -35,6 +46,42 @@ typedef struct _ZathuraDatabase zathura_database_t;
 struct render_thread_s;
 typedef struct render_thread_s render_thread_t;
 
+/* a document that is opened in the background */
+struct document_open_job_s;
+typedef struct document_open_job_s document_open_job_t;
+
+/* forward declaration for types from search.h */
+struct search_job_s;
+typedef struct search_job_s search_job_t;
+
+/* forward declaration for types from document-index.h */
+struct document_index_job_s;
+typedef struct document_index_job_s document_index_job_t;
+
+/* forward declaration for types from selection.h */
+struct selection_job_s;
+typedef struct selection_job_s selection_job_t;
+
+/* forward declaration for types from export.h */
+struct export_job_s;
+typedef struct export_job_s export_job_t;
+
+/* forward declaration for types from replay.h */
+struct zathura_replay_s;
+typedef struct zathura_replay_s zathura_replay_t;
+
+/* forward declaration for types from scroll.h */
+struct zathura_scroll_s;
+typedef struct zathura_scroll_s zathura_scroll_t;
+
+/* forward declaration for types from tabs.h */
+struct zathura_tab_s;
+typedef struct zathura_tab_s zathura_tab_t;
+
+/* forward declaration for types from server.h */
+struct zathura_server_s;
+typedef struct zathura_server_s zathura_server_t;
+
 /**
  * Jump
  */
@@ -68,19 +115,57 @@ struct zathura_s
       GdkColor render_loading_fg; /**< Foreground color for render "Loading..." */
     } colors;
 
+    float highlight_transparency; /**< Transparency of highlighted rectangles */
+    bool render_loading; /**< Show "Loading..." until a page has been rendered */
+    bool upload_pages; /**< Keep copies of rendered pages on the display server */
+
     GtkWidget *page_widget_alignment;
-    GtkWidget *page_widget; /**< Widget that contains all rendered pages */
+    GtkWidget *page_widget; /**< Widget that contains the page widgets around the view */
+
+    struct
+    {
+      zathura_page_layout_t* pages; /**< Positions of the pages */
+      bool attached; /**< Page widgets are attached to page_widget */
+      unsigned int first; /**< First attached page */
+      unsigned int last; /**< Last attached page */
+
+      struct
+      {
+        bool valid; /**< Some pages might be visible */
+        unsigned int first; /**< First page that might be visible */
+        unsigned int last; /**< Last page that might be visible */
+      } visible;
+    } layout;
     GtkWidget *index; /**< Widget to show the index of the document */
 
     GtkAdjustment *hadjustment; /**< Tracking hadjustment */
     GtkAdjustment *vadjustment; /**< Tracking vadjustment */
+
+    zathura_scroll_t* scroll; /**< Animations of the view (or NULL) */
   } ui;
 
   struct
   {
     render_thread_t* render_thread; /**< The thread responsible for rendering the pages */
+    document_open_job_t* open_job; /**< Document that is opened in the background */
+    search_job_t* search; /**< Search that is running in the background or has finished */
+    guint search_delay; /**< Source that starts a search once typing has paused */
+    export_job_t* export_job; /**< Export of pages that is running in the background */
+    document_index_job_t* index_job; /**< Index that is generated in the background or has been generated */
+    selection_job_t* selection_job; /**< Text of a selection that is extracted in the background */
+    guint page_loader; /**< Source that loads pages in the background */
+    unsigned int next_page_to_load; /**< Next page the page loader looks at */
+    guint stats_log; /**< Source that logs the statistics periodically (0 if disabled) */
   } sync;
 
+  struct
+  {
+    girara_list_t* list; /**< Documents that are open in tabs (zathura_tab_t) */
+    zathura_tab_t* current; /**< The shown tab (NULL if no tabs have been opened) */
+    unsigned int id; /**< Tab of the shown document in the page cache */
+    unsigned int next_id; /**< Identifier of the next tab */
+  } tabs;
+
   struct
   {
     void* manager; /**< Plugin manager */
@@ -96,8 +181,24 @@ struct zathura_s
   {
     bool enabled;
     gchar* editor;
+    zathura_synctex_t* index; /**< SyncTeX index of the document or NULL */
+    gchar* forward; /**< Position that is shown once the document has been opened */
   } synctex;
 
+  struct
+  {
+    size_t limit; /**< Memory limit in bytes (0 for no limit) */
+    int threshold; /**< Memory pressure in percent that releases memory (0 if not watched) */
+    guint source; /**< Source that checks the memory */
+    gint64 last_shed; /**< Time memory has been released last */
+  } memory;
+
+  struct
+  {
+    gchar* file; /**< File of the events to replay once a document is opened */
+    zathura_replay_t* replay; /**< The running replay or NULL */
+  } replay;
+
   struct
   {
     GtkPrintSettings* settings; /**< Print settings */
@@ -126,6 +227,8 @@ struct zathura_s
   {
     gchar* file; /**< bookmarks file */
     girara_list_t* bookmarks; /**< bookmarks */
+    GHashTable* ids; /**< id -> bookmark (NULL until it is needed) */
+    GPtrArray* pages; /**< bookmarks sorted by page (NULL until it is needed) */
   } bookmarks;
 
   struct
@@ -136,6 +239,20 @@ struct zathura_s
     unsigned int max_size;
   } jumplist;
 
+  struct
+  {
+    guint source; /**< Source that queues the prefetched pages */
+    unsigned int current_page; /**< Last known current page */
+    int direction; /**< Sign of the last change of the current page */
+  } prefetch;
+
+  struct
+  {
+    bool active; /**< The current, next and previous slides are kept rendered */
+    gint64 flip_start; /**< Time the slide has been changed at (0 if it has been shown) */
+    unsigned int flip_page; /**< Slide that is shown next */
+  } presentation;
+
   struct
   {
     gchar* file;
@@ -153,16 +270,21 @@ struct zathura_s
     GFile* file; /**< File for file monitor */
     gchar* file_path; /**< Save file path */
     gchar* password; /**< Save password */
+    guint reload_timeout; /**< Pending reload (0 if there is none) */
+    gint64 last_change; /**< Time of the last change of the file */
+    gint64 size; /**< Size of the file after the last change */
+    gint64 mtime; /**< Modification time of the file after the last change */
+    bool reloading; /**< A reload is in progress */
   } file_monitor;
 
-  /**
-   * The page cache
-   */
-  struct {
-    int* cache;
-    unsigned int size;
-    unsigned int num_cached_pages;
-  } page_cache;
+  zathura_page_cache_t* page_cache; /**< Cache of rendered surfaces */
+  zathura_surface_pool_t* surface_pool; /**< Buffers of destroyed surfaces */
+  zathura_text_index_t* text_index; /**< Text index of the document or NULL */
+  zathura_thumbnail_cache_t* thumbnail_cache; /**< Thumbnails of the document on disk or NULL */
+  zathura_render_cache_t* render_cache; /**< Rendered pages of the document on disk or NULL */
+  zathura_stats_t* stats; /**< Render and UI latency statistics */
+  zathura_dir_cache_t* dir_cache; /**< Directories that have been listed for completions or NULL */
+  zathura_server_t* server; /**< Server sharing its state with this session or NULL */
 };
 
 /**
@@ -231,6 +353,33 @@ void zathura_set_plugin_dir(zathura_t* zathura, const char* dir);
  */
 void zathura_set_synctex_editor_command(zathura_t* zathura, const char* command);
 
+/**
+ * Sets the position in the source that is shown once the next document has
+ * been opened (see synctex_view)
+ *
+ * @param zathura The zathura session
+ * @param position The position in the format line:column:input or NULL
+ */
+void zathura_set_synctex_forward(zathura_t* zathura, const char* position);
+
+/**
+ * Sets the file of recorded events that are replayed once the first document
+ * has been opened (see zathura_replay_start)
+ *
+ * @param zathura The zathura session
+ * @param file The file or NULL
+ */
+void zathura_set_replay_file(zathura_t* zathura, const char* file);
+
+/**
+ * Sets the amount of memory zathura should not exceed. It has to be set
+ * before zathura_init is called.
+ *
+ * @param zathura The zathura session
+ * @param limit The limit in MiB (0 for no limit)
+ */
+void zathura_set_memory_limit(zathura_t* zathura, int limit);
+
 /**
  * En/Disable zathuras synctex support
  *
@@ -260,7 +409,9 @@ bool document_open(zathura_t* zathura, const char* path, const char* password,
                    int page_number);
 
 /**
- * Opens a file (idle)
+ * Opens a file (idle). The file type detection, the plugin and the page
+ * metadata are handled in a background thread while the progress is shown in
+ * the statusbar; the page widgets are created in the main loop afterwards.
  *
  * @param zathura The zathura session
  * @param path The path to the file
@@ -289,6 +440,48 @@ bool document_save(zathura_t* zathura, const char* path, bool overwrite);
  */
 bool document_close(zathura_t* zathura, bool keep_monitor);
 
+/**
+ * Closes the current opened document like document_close, but keeps the
+ * document and its surfaces in the page cache, so that it can be shown again
+ * without opening and rendering it again
+ *
+ * @param zathura The zathura session
+ * @return The document or NULL if no document is opened
+ */
+zathura_document_t* document_park(zathura_t* zathura);
+
+/**
+ * Shows a document again that has been closed with document_park. The
+ * document is freed if it cannot be shown.
+ *
+ * @param zathura The zathura session
+ * @param document The document
+ * @param password The password of the document (or NULL)
+ * @return If no error occured true, otherwise false, is returned.
+ */
+bool document_resume(zathura_t* zathura, zathura_document_t* document,
+    const char* password);
+
+/**
+ * Cancels opening a document in the background. This waits for the
+ * background thread to finish and discards the document.
+ *
+ * @param zathura The zathura session
+ */
+void document_open_cancel(zathura_t* zathura);
+
+/**
+ * Reloads the current document from the monitored file. If the number of
+ * pages and their sizes did not change, the page widgets, the view and the
+ * cached surfaces of unchanged pages are kept and only the pages whose content
+ * changed are rendered again. Otherwise the document is closed and opened
+ * again.
+ *
+ * @param zathura The zathura session
+ * @return If no error occured true, otherwise false, is returned.
+ */
+bool document_reload(zathura_t* zathura);
+
 /**
  * Opens the page with the given number
  *
@@ -298,6 +491,16 @@ bool document_close(zathura_t* zathura, bool keep_monitor);
  */
 bool page_set(zathura_t* zathura, unsigned int page_id);
 
+/**
+ * Loads the page with the given number if that has not happened yet and
+ * updates the size of its widget once the real size of the page is known
+ *
+ * @param zathura The zathura session
+ * @param page_id The id of the page
+ * @return true if the page is loaded, otherwise false
+ */
+bool page_load(zathura_t* zathura, unsigned int page_id);
+
 /**
  * Opens the page with the given number (delayed)
  *
@@ -326,6 +529,29 @@ bool position_set_delayed(zathura_t* zathura, double position_x, double position
  */
 void page_widget_set_mode(zathura_t* zathura, unsigned int pages_per_row, unsigned int first_page_column);
 
+/**
+ * Positions the page widgets again after the size of the pages has changed
+ *
+ * @param zathura The zathura session
+ */
+void page_widget_update_layout(zathura_t* zathura);
+
+/**
+ * Computes the size of all pages at the current scale and rotation and
+ * resizes the widgets whose size has changed
+ *
+ * @param zathura The zathura session
+ */
+void page_widget_resize(zathura_t* zathura);
+
+/**
+ * Attaches the widgets of the pages that are close to the visible part of the
+ * document and detaches all others
+ *
+ * @param zathura The zathura session
+ */
+void page_widget_update_view(zathura_t* zathura);
+
 /**
  * Updates the page number in the statusbar. Note that 1 will be added to the
  * displayed number
@@ -400,12 +626,4 @@ void zathura_jumplist_add(zathura_t* zathura);
  */
 void zathura_jumplist_append_jump(zathura_t* zathura);
 
-/**
- * Add a page to the page cache
- *
- * @param zathura The zathura session
- * @param page_index The index of the page to be cached
- */
-void zathura_page_cache_add(zathura_t* zathura, unsigned int page_index);
-
 #endif // ZATHURA_H